@@ -1,4 +1,4 @@
-/** @file ad5324.c 
+/** @file ad5324.c
 *   @brief AD5324 Driver Implementation File
 *   @date 16-Dec-2022
 *   @author Stefan Damkjar, Junqi Zhu
@@ -6,26 +6,157 @@
 */
 
 #include "ad5324.h"
+#include "sys_dma.h"
 
+/* Transfer groups and their first buffers */
+#define AD5324_TG_BURST           (0U)
+#define AD5324_TG_SINGLE          (1U)
+#define AD5324_BUF_BURST          (0U)
+#define AD5324_BUF_SINGLE         (4U)
+
+/* TGCTRL: enable, one shot, pointer reset, trigger event shift, start
+   buffer shift */
+#define AD5324_TGCTRL_TGENA       (0x80000000U)
+#define AD5324_TGCTRL_ONESHOT     (0x40000000U)
+#define AD5324_TGCTRL_PRST        (0x20000000U)
+#define AD5324_TGCTRL_TRGEVT      (20U)
+#define AD5324_TGCTRL_PSTART      (8U)
+
+/* Buffer control: always-send mode, WDELAY after the word, chip select */
+#define AD5324_BUF_CONTROL        ((uint16_t)((4U << 13) | (1U << 10) | \
+                                   (~(1U << AD5324_CS) & 0xFFU)))
+
+/* PC0 functional pins: chip select, CLK and SIMO */
+#define AD5324_PINS               ((1U << AD5324_CS) | (1U << 9) | (1U << 10))
+
+/* FMT0: 16 bit words, clock idles high, data latched on falling edges,
+   MSB first, two VCLK plus WDELAY of nSYNC high between words */
+#define AD5324_FMT0               ((2U << 24) | (1U << 17) | (1U << 16) | 16U)
+
+/* DELAY: nSYNC to SCLK and SCLK to nSYNC, (n + 2) VCLK each */
+#define AD5324_DELAY              ((1U << 24) | (1U << 16))
+
+/* FLG buffer RAM initialisation in progress */
+#define AD5324_FLG_BUFINIT        (0x01000000U)
+
+/* DMA port of peripheral memory */
+#define AD5324_DMA_PORTB          (4U)
+
+/* Burst image copied by DMA, control and data of each buffer */
+static uint32_t AD5324_Image[4];
+
+/* Transfer group 0 control word written by the chained DMA channel */
+static uint32_t AD5324_Start;
+
+/* Control packet of the copy channel, retargeted for each burst length */
+static g_dmaCTRL AD5324_CopyPacket;
+
+/* Set while a DMA started burst has not been seen complete */
+static volatile uint32_t AD5324_Pending = 0U;
+
+/* Input register contents as last written, bit n of AD5324_Known set once
+   channel n has been written */
+static uint16_t AD5324_Shadow[4];
+static uint32_t AD5324_Known = 0U;
+static AD5324_Mode_TypeDef AD5324_ShadowMode = AD5324_ModeEnable;
+
+/* Values staged for the next commit, bit n of AD5324_Staged per channel */
+static uint16_t AD5324_Next[4];
+static uint32_t AD5324_Staged = 0U;
+
+static AD5324_Stats_TypeDef AD5324_Stats;
+
+static uint16_t AD5324_Word(AD5324_Channel_TypeDef channel,
+                            AD5324_Update_TypeDef update,
+                            AD5324_Mode_TypeDef mode,
+                            uint16_t val);
+static AD5324_Err_TypeDef AD5324_Burst(const uint16_t *words,
+                                       uint32_t count,
+                                       AD5324_Trigger_TypeDef trigger);
+static AD5324_Err_TypeDef AD5324_Run(uint32_t group);
+static void AD5324_InitDma(void);
 
 /*******************************************************************************
  **************************   GLOBAL FUNCTIONS   *******************************
  ******************************************************************************/
 
-void AD5324_Init ()
+/***************************************************************************//**
+ * @brief
+ *   Set up MIBSPI3 as master with the two transfer groups and the DMA
+ *   channels of the burst. Expects the pin mux to route CLK, SIMO and the
+ *   nSYNC chip select to MIBSPI3. The shadow starts out unknown, so the
+ *   first commit writes every staged channel.
+ ******************************************************************************/
+void AD5324_Init (void)
 {
-    gioSetDirection(AD5324_SCLK_PORT,(AD5324_SCLK_PORT->DIR)|(0x1<<AD5324_SCLK_PIN));
-    gioSetDirection(AD5324_NSYNC_PORT,(AD5324_NSYNC_PORT->DIR)|(0x1<<AD5324_NSYNC_PIN));
-    gioSetDirection(AD5324_DIN_PORT,(AD5324_DIN_PORT->DIR)|(0x1<<AD5324_DIN_PIN));
-    
+    uint32_t i;
+
+    /* Reset, then master with internal clock */
+    AD5324_SPI->GCR0 = 0U;
+    AD5324_SPI->GCR0 = 1U;
+    AD5324_SPI->GCR1 = 0x3U;
+
+    /* Multi-buffer mode, wait for the buffer RAM to clear */
+    AD5324_SPI->MIBSPIE = 1U;
+    while ( (AD5324_SPI->FLG & AD5324_FLG_BUFINIT) != 0U ) {}
+
+    AD5324_SPI->PC0 = AD5324_PINS;
+    AD5324_SPI->DEF = 0xFFU;
+    AD5324_SPI->DELAY = AD5324_DELAY;
+    AD5324_SPI->INT0 = 0U;
+    AD5324_SPI->TGITENCR = 0xFFFFFFFFU;
+
+    AD5324_SetClock(AD5324_VCLK_HZ);
+
+    for ( i = 0U; i < 5U; i++ )
+    {
+        AD5324_SPI_RAM->tx[i].control = AD5324_BUF_CONTROL;
+        AD5324_SPI_RAM->tx[i].data = 0U;
+    }
+
+    AD5324_Known = 0U;
+    AD5324_Staged = 0U;
+    AD5324_Stats.bursts = 0U;
+    AD5324_Stats.words = 0U;
+    AD5324_Stats.skipped = 0U;
+    AD5324_Stats.errors = 0U;
+
+    AD5324_SPI->TGCTRL[AD5324_TG_BURST] = AD5324_TGCTRL_ONESHOT |
+                   AD5324_TGCTRL_PRST |
+                   ((uint32_t)TRG_ALWAYS << AD5324_TGCTRL_TRGEVT) |
+                   (AD5324_BUF_BURST << AD5324_TGCTRL_PSTART);
+    AD5324_SPI->TGCTRL[AD5324_TG_SINGLE] = AD5324_TGCTRL_ONESHOT |
+                   ((uint32_t)TRG_ALWAYS << AD5324_TGCTRL_TRGEVT) |
+                   (AD5324_BUF_SINGLE << AD5324_TGCTRL_PSTART);
+    AD5324_SPI->TGCTRL[2U] = (AD5324_BUF_SINGLE + 1U) << AD5324_TGCTRL_PSTART;
+    AD5324_SPI->LTGPEND = AD5324_BUF_SINGLE << AD5324_TGCTRL_PSTART;
+
+    AD5324_InitDma();
+
+    /* Release from reset */
+    AD5324_SPI->GCR1 |= 0x01000000U;
 }
 
 /***************************************************************************//**
  * @brief
- *   Set content of DAC5324.
+ *   Set the SCLK prescaler for a new VCLK so SCLK stays at or below
+ *   AD5324_SCLK_HZ. Called by the clock governor.
  *
- * @param[in] spi
- *   Pointer to SPI peripheral register block.
+ * @param[in] vclkHz
+ *   VCLK in Hz.
+ ******************************************************************************/
+void AD5324_SetClock (uint32_t vclkHz)
+{
+    uint32_t prescale = (vclkHz + AD5324_SCLK_HZ - 1U) / AD5324_SCLK_HZ - 1U;
+
+    if ( prescale > 0xFFU ) prescale = 0xFFU;
+
+    AD5324_SPI->FMT0 = AD5324_FMT0 | (prescale << 8);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set content of DAC5324.
  *
  * @param[in] channel
  *   Configure which DAC channel to write to.
@@ -35,7 +166,7 @@ void AD5324_Init ()
  *
  * @param[in] mode
  *   Configure DAC mode (enable or powerdown)
- * 
+ *
  * @param[in] val
  *   Value used when writing to data bits.
  *
@@ -47,41 +178,405 @@ AD5324_Err_TypeDef AD5324_Write (AD5324_Channel_TypeDef channel,
                                 AD5324_Mode_TypeDef mode,
                                 uint16_t val)
 {
-    uint8_t i = 0;
-    uint8_t t = 0;
-
     /* Check if DAC value exceeds limit (must be <= 4095) */
     if ( val > 0xFFF ) return AD5324_Err_ValTooLarge;
 
-    /* Build data word */
-    val = val | ((channel << _AD5324_CHANNEL_SHIFT) |
-                 (update  << _AD5324_UPDATE_SHIFT ) |
-                 (mode    << _AD5324_MODE_SHIFT   ));
+    if ( AD5324_IsBusy() != 0U ) return AD5324_Err_Busy;
 
-    /* Clear and set clock */
-    //gioSetBit(AD5324_SCLK_PORT,AD5324_SCLK_PIN,0);
-    //gioSetBit(AD5324_SCLK_PORT,AD5324_SCLK_PIN,1);
+    AD5324_SPI_RAM->tx[AD5324_BUF_SINGLE].data =
+        AD5324_Word(channel, update, mode, val);
 
-    /* Assert nSync */
-    gioSetBit(AD5324_NSYNC_PORT,AD5324_NSYNC_PIN,0);
+    if ( AD5324_Run(AD5324_TG_SINGLE) != AD5324_Err_NoError )
+    {
+        AD5324_Known &= ~(1UL << channel);
+        AD5324_Stats.errors++;
+        return AD5324_Err_Timeout;
+    }
+
+    AD5324_Shadow[channel] = val;
+    AD5324_Known |= 1UL << channel;
+    AD5324_ShadowMode = mode;
+    AD5324_Stats.words++;
 
-    for(t=0;t<0x80;t++);
+    return AD5324_Err_NoError;
+}
 
-    /* Shift out bits with clock edges */
-    for ( i = 0; i <= 15; i++)
+/***************************************************************************//**
+ * @brief
+ *   Write all four channels in one burst, channel A first.
+ *
+ * @param[in] val
+ *   Values of channels A to D.
+ *
+ * @param[in] update
+ *   Update mode of every word.
+ *
+ * @param[in] mode
+ *   Configure DAC mode (enable or powerdown)
+ *
+ * @param[in] trigger
+ *   AD5324_TriggerCpu waits for the burst, AD5324_TriggerDma returns once
+ *   the DMA is requested; poll AD5324_IsBusy before the next write.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+AD5324_Err_TypeDef AD5324_WriteAll (const uint16_t val[4],
+                                   AD5324_Update_TypeDef update,
+                                   AD5324_Mode_TypeDef mode,
+                                   AD5324_Trigger_TypeDef trigger)
+{
+    uint16_t words[4];
+    uint32_t i;
+
+    for ( i = 0U; i < 4U; i++ )
     {
-        gioSetBit(AD5324_DIN_PORT,AD5324_DIN_PIN, (val & 0x8000) >> 15 );
-        for(t=0;t<0x80;t++);
-        val = val << 1;
-        gioSetBit(AD5324_SCLK_PORT,AD5324_SCLK_PIN,0);
-        for(t=0;t<0x80;t++);
-        gioSetBit(AD5324_SCLK_PORT,AD5324_SCLK_PIN,1);
-        for(t=0;t<0x80;t++);
+        if ( val[i] > 0xFFF ) return AD5324_Err_ValTooLarge;
+
+        words[i] = AD5324_Word((AD5324_Channel_TypeDef)i, update, mode, val[i]);
     }
 
-    /* Reset nSync */
-    gioSetBit(hetPORT1,16,1);
+    if ( AD5324_IsBusy() != 0U ) return AD5324_Err_Busy;
+
+    if ( AD5324_Burst(words, 4U, trigger) != AD5324_Err_NoError )
+    {
+        AD5324_Known = 0U;
+        return AD5324_Err_Timeout;
+    }
+
+    for ( i = 0U; i < 4U; i++ )
+    {
+        AD5324_Shadow[i] = val[i];
+    }
+
+    AD5324_Known = 0xFU;
+    AD5324_ShadowMode = mode;
+
+    return AD5324_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stage a value for the next AD5324_Commit. Staging a channel again
+ *   before the commit replaces its value.
+ *
+ * @param[in] channel
+ *   DAC channel.
+ *
+ * @param[in] val
+ *   Value used when writing to data bits.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+AD5324_Err_TypeDef AD5324_Stage (AD5324_Channel_TypeDef channel,
+                                uint16_t val)
+{
+    if ( val > 0xFFF ) return AD5324_Err_ValTooLarge;
+
+    AD5324_Next[channel & 0x3U] = val;
+    AD5324_Staged |= 1UL << (channel & 0x3U);
 
-    /* Return no error */
     return AD5324_Err_NoError;
 }
+
+/***************************************************************************//**
+ * @brief
+ *   Write the staged channels in one burst and update all outputs together.
+ *
+ * @details
+ *   Channels whose staged value matches the shadow are left out. Every word
+ *   but the last only loads an input register, the last one updates all
+ *   four outputs at once. A change of mode resends every known channel.
+ *   Nothing is sent if no staged channel changed. On a failed transfer the
+ *   channels stay staged and are sent again by the next commit.
+ *
+ * @param[in] mode
+ *   Configure DAC mode (enable or powerdown)
+ *
+ * @param[in] trigger
+ *   AD5324_TriggerCpu waits for the burst, AD5324_TriggerDma returns once
+ *   the DMA is requested.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+AD5324_Err_TypeDef AD5324_Commit (AD5324_Mode_TypeDef mode,
+                                 AD5324_Trigger_TypeDef trigger)
+{
+    uint16_t words[4];
+    uint32_t send = 0U;
+    uint32_t count = 0U;
+    uint32_t i;
+
+    if ( AD5324_IsBusy() != 0U ) return AD5324_Err_Busy;
+
+    for ( i = 0U; i < 4U; i++ )
+    {
+        if ( (AD5324_Staged & (1UL << i)) != 0U )
+        {
+            if ( (AD5324_Known & (1UL << i)) == 0U ||
+                 AD5324_Next[i] != AD5324_Shadow[i] ||
+                 mode != AD5324_ShadowMode )
+            {
+                send |= 1UL << i;
+            }
+            else
+            {
+                AD5324_Stats.skipped++;
+            }
+        }
+        else if ( (AD5324_Known & (1UL << i)) != 0U &&
+                  mode != AD5324_ShadowMode )
+        {
+            AD5324_Next[i] = AD5324_Shadow[i];
+            send |= 1UL << i;
+        }
+    }
+
+    AD5324_Staged = 0U;
+
+    if ( send == 0U ) return AD5324_Err_NoError;
+
+    for ( i = 0U; i < 4U; i++ )
+    {
+        if ( (send & (1UL << i)) != 0U )
+        {
+            words[count++] = AD5324_Word((AD5324_Channel_TypeDef)i,
+                                         AD5324_UpdateDisable,
+                                         mode,
+                                         AD5324_Next[i]);
+        }
+    }
+
+    /* Last word updates all outputs */
+    words[count - 1U] &= (uint16_t)~AD5324_UPDATE;
+
+    if ( AD5324_Burst(words, count, trigger) != AD5324_Err_NoError )
+    {
+        AD5324_Known &= ~send;
+        AD5324_Staged = send;
+        return AD5324_Err_Timeout;
+    }
+
+    for ( i = 0U; i < 4U; i++ )
+    {
+        if ( (send & (1UL << i)) != 0U )
+        {
+            AD5324_Shadow[i] = AD5324_Next[i];
+        }
+    }
+
+    AD5324_Known |= send;
+    AD5324_ShadowMode = mode;
+
+    return AD5324_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the value last written to a channel.
+ *
+ * @param[in] channel
+ *   DAC channel.
+ *
+ * @param[out] val
+ *   Value of the input register.
+ *
+ * @return
+ *   Returns 1 if the channel has been written since AD5324_Init.
+ ******************************************************************************/
+uint32_t AD5324_GetShadow (AD5324_Channel_TypeDef channel, uint16_t *val)
+{
+    *val = AD5324_Shadow[channel & 0x3U];
+
+    return (AD5324_Known >> (channel & 0x3U)) & 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get transfer counters.
+ *
+ * @return
+ *   Returns pointer to the counters.
+ ******************************************************************************/
+const AD5324_Stats_TypeDef *AD5324_GetStats (void)
+{
+    return &AD5324_Stats;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check for a DMA started burst that has not completed.
+ *
+ * @return
+ *   Returns 1 if busy.
+ ******************************************************************************/
+uint32_t AD5324_IsBusy (void)
+{
+    if ( AD5324_Pending != 0U &&
+         (AD5324_SPI->TGINTFLG & (0x10000U << AD5324_TG_BURST)) != 0U )
+    {
+        AD5324_Pending = 0U;
+    }
+
+    return AD5324_Pending;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Build a data word.
+ *
+ * @return
+ *   Returns the 16 bit word as shifted out.
+ ******************************************************************************/
+static uint16_t AD5324_Word(AD5324_Channel_TypeDef channel,
+                            AD5324_Update_TypeDef update,
+                            AD5324_Mode_TypeDef mode,
+                            uint16_t val)
+{
+    return (uint16_t)(val | ((channel << _AD5324_CHANNEL_SHIFT) |
+                             (update  << _AD5324_UPDATE_SHIFT ) |
+                             (mode    << _AD5324_MODE_SHIFT   )));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Send words in one burst. The words go into the last buffers of transfer
+ *   group 0, which starts at the first of them.
+ *
+ * @param[in] words
+ *   Data words in the order sent.
+ *
+ * @param[in] count
+ *   Number of words, 1 to 4.
+ *
+ * @param[in] trigger
+ *   How the burst is started.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+static AD5324_Err_TypeDef AD5324_Burst(const uint16_t *words,
+                                       uint32_t count,
+                                       AD5324_Trigger_TypeDef trigger)
+{
+    uint32_t first = AD5324_BUF_SINGLE - count;
+    uint32_t control = AD5324_TGCTRL_ONESHOT | AD5324_TGCTRL_PRST |
+                       ((uint32_t)TRG_ALWAYS << AD5324_TGCTRL_TRGEVT) |
+                       (first << AD5324_TGCTRL_PSTART);
+    uint32_t i;
+
+    AD5324_Stats.bursts++;
+    AD5324_Stats.words += count;
+
+    if ( trigger == AD5324_TriggerDma )
+    {
+        for ( i = 0U; i < count; i++ )
+        {
+            AD5324_Image[i] = ((uint32_t)AD5324_BUF_CONTROL << 16) | words[i];
+        }
+
+        AD5324_Start = control | AD5324_TGCTRL_TGENA;
+        AD5324_CopyPacket.DADD = (uint32)&AD5324_SPI_RAM->tx[first];
+        AD5324_CopyPacket.ELCNT = count;
+        dmaSetCtrlPacket(AD5324_DMA_COPY, AD5324_CopyPacket);
+
+        AD5324_SPI->TGINTFLG = 0x10000U << AD5324_TG_BURST;
+        AD5324_Pending = 1U;
+        dmaSetChEnable(AD5324_DMA_COPY, (uint32)DMA_SW);
+
+        return AD5324_Err_NoError;
+    }
+
+    for ( i = 0U; i < count; i++ )
+    {
+        AD5324_SPI_RAM->tx[first + i].data = words[i];
+    }
+
+    AD5324_SPI->TGCTRL[AD5324_TG_BURST] = control;
+
+    if ( AD5324_Run(AD5324_TG_BURST) != AD5324_Err_NoError )
+    {
+        AD5324_Stats.errors++;
+        return AD5324_Err_Timeout;
+    }
+
+    return AD5324_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start a transfer group and wait for it to complete.
+ *
+ * @param[in] group
+ *   Transfer group.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+static AD5324_Err_TypeDef AD5324_Run(uint32_t group)
+{
+    uint32_t done = 0x10000U << group;
+    uint32_t t;
+
+    AD5324_SPI->TGINTFLG = done;
+    AD5324_SPI->TGCTRL[group] |= AD5324_TGCTRL_TGENA;
+
+    for ( t = 0U; t < AD5324_TIMEOUT; t++ )
+    {
+        if ( (AD5324_SPI->TGINTFLG & done) != 0U )
+        {
+            AD5324_SPI->TGINTFLG = done;
+            return AD5324_Err_NoError;
+        }
+    }
+
+    return AD5324_Err_Timeout;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set up the burst DMA channels. The copy channel moves the image into the
+ *   burst buffers as one block and triggers the start channel, which writes
+ *   the transfer group control word with TGENA set.
+ ******************************************************************************/
+static void AD5324_InitDma(void)
+{
+    g_dmaCTRL packet;
+
+    packet.SADD      = (uint32)AD5324_Image;
+    packet.DADD      = (uint32)&AD5324_SPI_RAM->tx[AD5324_BUF_BURST];
+    packet.CHCTRL    = AD5324_DMA_START + 1U;
+    packet.FRCNT     = 1U;
+    packet.ELCNT     = 4U;
+    packet.ELDOFFSET = 0U;
+    packet.ELSOFFSET = 0U;
+    packet.FRDOFFSET = 0U;
+    packet.FRSOFFSET = 0U;
+    packet.PORTASGN  = AD5324_DMA_PORTB;
+    packet.RDSIZE    = ACCESS_32_BIT;
+    packet.WRSIZE    = ACCESS_32_BIT;
+    packet.TTYPE     = BLOCK_TRANSFER;
+    packet.ADDMODERD = ADDR_INC1;
+    packet.ADDMODEWR = ADDR_INC1;
+    packet.AUTOINIT  = 0U;
+    packet.COMBO     = 0U;
+
+    dmaEnable();
+    dmaSetCtrlPacket(AD5324_DMA_COPY, packet);
+    AD5324_CopyPacket = packet;
+
+    packet.SADD      = (uint32)&AD5324_Start;
+    packet.DADD      = (uint32)&AD5324_SPI->TGCTRL[AD5324_TG_BURST];
+    packet.CHCTRL    = 0U;
+    packet.ELCNT     = 1U;
+    packet.ADDMODERD = ADDR_FIXED;
+    packet.ADDMODEWR = ADDR_FIXED;
+
+    dmaSetCtrlPacket(AD5324_DMA_START, packet);
+}
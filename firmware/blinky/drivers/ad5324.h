@@ -12,32 +12,60 @@
  *  The AD5324 is a c4-channel 12-bit buffered voltage DAC with a 3-wire serial
  *  interface that is compatible with SPI interface standards.
  *
+ *  The DAC is driven by MIBSPI3 in multi-buffer mode. Transfer group 0 holds
+ *  one buffer per channel and sends all four words in one burst, transfer
+ *  group 1 holds a single buffer for one word. Every word is framed by its
+ *  own nSYNC pulse on the chip select, so the DAC latches each word on the
+ *  rising edge. A burst takes about 4 us at the default SCLK.
+ *
+ *  Setpoints can be staged per channel and committed together. The commit
+ *  sends only channels that differ from a shadow of the input registers;
+ *  every word but the last loads an input register only and the last one
+ *  updates all outputs at once, so the channels change without skew.
+ *
+ *  A burst can also be started by DMA: one channel copies the four words into
+ *  the buffer RAM and is chained to a second channel that writes the transfer
+ *  group trigger, so the CPU only requests the first channel and returns.
+ *
  *	Related Files
  *   - ad5324.h
  *   - ad5324.c
- *   - gio.h
- *   - het.h
+ *   - mibspi.h
+ *   - sys_dma.h
+ *   - stdint.h
  */
 
 #ifndef DRIVERS_AD5324_H_
 #define DRIVERS_AD5324_H_		
 
-#include "gio.h"
-#include "het.h"
 #include "mibspi.h"
+#include "sys_dma.h"
+#include "stdint.h"
 
 /*******************************************************************************
  *******************************   DEFINES   ***********************************
  ******************************************************************************/
 
-#define AD5324_SCLK_PIN     (9U)
-#define AD5324_SCLK_PORT    (mibspiPORT3)
+#define AD5324_SPI          (mibspiREG3)
+#define AD5324_SPI_RAM      (mibspiRAM3)
+
+/** MIBSPI3 chip select wired to nSYNC */
+#define AD5324_CS           (0U)
+
+/** SCLK rate, the AD5324 allows up to 30 MHz */
+#define AD5324_SCLK_HZ      (20000000U)
+
+/** VCLK at reset, used by AD5324_Init */
+#define AD5324_VCLK_HZ      (80000000U)
 
-#define AD5324_NSYNC_PIN    (16U)
-#define AD5324_NSYNC_PORT   (hetPORT1)
+/** Status polls before a transfer counts as failed */
+#define AD5324_TIMEOUT      (10000U)
 
-#define AD5324_DIN_PIN      (10U)
-#define AD5324_DIN_PORT     (mibspiPORT3)
+/** DMA channel copying a burst into the buffer RAM */
+#define AD5324_DMA_COPY     (DMA_CH0)
+
+/** DMA channel chained to AD5324_DMA_COPY, starts the transfer group */
+#define AD5324_DMA_START    (DMA_CH1)
 
 #define AD5324_DATA              (0xFFUL << 0)
 #define _AD5324_DATA_SHIFT       0
@@ -126,21 +154,66 @@ typedef enum
 typedef enum
 {
   AD5324_Err_NoError     = 0, /**< No error*/
-  AD5324_Err_ValTooLarge = 1  /**< DAC value too large (must be <=4095)*/
+  AD5324_Err_ValTooLarge = 1, /**< DAC value too large (must be <=4095)*/
+  AD5324_Err_Busy        = 2, /**< A burst is still shifting out*/
+  AD5324_Err_Timeout     = 3  /**< Transfer did not complete*/
 } AD5324_Err_TypeDef;
 
+/** @enum AD5324_Trigger_TypeDef
+*   @brief Alias names for the ways a burst is started.
+*/
+
+typedef enum
+{
+  AD5324_TriggerCpu = 0U,   /**< CPU fills the buffers, starts the group and
+                                 waits for completion (default)*/
+  AD5324_TriggerDma = 1U    /**< DMA fills the buffers and starts the group,
+                                 returns at once*/
+} AD5324_Trigger_TypeDef;
+
 
 /*******************************************************************************
  *****************************   PROTOTYPES   **********************************
  ******************************************************************************/
 
-void AD5324_Init ();
+/** @struct AD5324_Stats_TypeDef
+*   @brief Transfer counters since AD5324_Init.
+*/
+
+typedef struct
+{
+  uint32_t bursts;          /**< Bursts sent*/
+  uint32_t words;           /**< Words sent, bursts and single writes*/
+  uint32_t skipped;         /**< Staged channels left out as unchanged*/
+  uint32_t errors;          /**< Transfers that timed out*/
+} AD5324_Stats_TypeDef;
+
+void AD5324_Init (void);
+
+void AD5324_SetClock (uint32_t vclkHz);
 
 AD5324_Err_TypeDef AD5324_Write (AD5324_Channel_TypeDef channel,
                                 AD5324_Update_TypeDef update,
                                 AD5324_Mode_TypeDef mode,
                                 uint16_t val);
 
+AD5324_Err_TypeDef AD5324_WriteAll (const uint16_t val[4],
+                                   AD5324_Update_TypeDef update,
+                                   AD5324_Mode_TypeDef mode,
+                                   AD5324_Trigger_TypeDef trigger);
+
+AD5324_Err_TypeDef AD5324_Stage (AD5324_Channel_TypeDef channel,
+                                uint16_t val);
+
+AD5324_Err_TypeDef AD5324_Commit (AD5324_Mode_TypeDef mode,
+                                 AD5324_Trigger_TypeDef trigger);
+
+uint32_t AD5324_GetShadow (AD5324_Channel_TypeDef channel, uint16_t *val);
+
+const AD5324_Stats_TypeDef *AD5324_GetStats (void);
+
+uint32_t AD5324_IsBusy (void);
+
 /**@}*/
 
 #endif /* DRIVERS_AD5324_H_ */
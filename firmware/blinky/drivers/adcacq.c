@@ -0,0 +1,585 @@
+/** @file adcacq.c
+*   @brief ADC Acquisition Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "adcacq.h"
+#include "adc.h"
+#include "sys_dma.h"
+#include "scheduler.h"
+#include "idle.h"
+#include "print.h"
+#include "stdint.h"
+
+/* ADIN pins of MibADC1 and values of a 5 bit channel id */
+#define ADCACQ_NUM_PINS           (24U)
+#define ADCACQ_NUM_IDS            (32U)
+#define ADCACQ_NO_CHANNEL         (0xFFU)
+
+/* CLOCKCR: ADCLK of VCLK / 8, 10 MHz at 80 MHz */
+#define ADCACQ_CLOCK_DIV          (7U)
+
+/* Sample window of (n + 2) ADCLK, 2.5 us for the source impedance of a
+   divider */
+#define ADCACQ_SAMPLE_WINDOW      (23U)
+
+/* GxMODECR: hardware trigger, channel id in the results */
+#define ADCACQ_MODE_HW_TRIGGER    (0x00000008U)
+#define ADCACQ_MODE_CHID          (0x00000020U)
+
+/* G1SRC: trigger on the rising edge */
+#define ADCACQ_SRC_RISING         (0x00000008U)
+
+/* G1DMACR: DMA request once per G1_BLOCKS results */
+#define ADCACQ_DMACR_ENABLE       (0x00000001U)
+#define ADCACQ_DMACR_BLOCK        (0x00000004U)
+#define ADCACQ_DMACR_BLOCKS_SHIFT (16U)
+
+/* GxINTFLG: results lost to a full FIFO */
+#define ADCACQ_INTFLG_OVERRUN     (0x00000002U)
+
+/* Result RAM in pairs of words: 4 words for the event group, 16 for group
+   1, the rest of the 64 for group 2 */
+#define ADCACQ_BND_EVENT          (2U)
+#define ADCACQ_BND_GROUP1         (8U)
+#define ADCACQ_BNDEND_64          (2U)
+#define ADCACQ_BNDEND_INIT        (0xFFFF0000U)
+
+/* OPMODECR: enable, as the HALCoGen driver sets it */
+#define ADCACQ_OPMODE_ENABLE      (0x00140001U)
+
+/* Result word in 12 bit mode */
+#define ADCACQ_RESULT_DATA_MASK   (0xFFFU)
+#define ADCACQ_RESULT_ID_SHIFT    (16U)
+#define ADCACQ_RESULT_ID_MASK     (0x1FU)
+
+/* DMA request line of MibADC1 group 1 and port of peripheral memory */
+#define ADCACQ_DMA_REQUEST        (10U)
+#define ADCACQ_DMA_PORTB          (4U)
+
+const ADCACQ_Params_TypeDef ADCACQ_DefaultParams =
+{
+  1U,
+  {
+    /* pin                 decimation  scale                  low    high   hysteresis */
+    { ADCACQ_BATTERY_PIN,  4U,         ADCACQ_BATTERY_SCALE,  6000U, 8500U, 200U }
+  }
+};
+
+/* Group conversions as written by the DMA, numChannels words each */
+static volatile uint32_t ADCACQ_Ring[ADCACQ_RING_SETS * ADCACQ_MAX_CHANNELS];
+
+static ADCACQ_Params_TypeDef ADCACQ_Params;
+static ADCACQ_Threshold_TypeDef ADCACQ_Threshold = 0;
+
+/* Channel of each channel id */
+static uint8_t ADCACQ_Index[ADCACQ_NUM_IDS];
+
+/* mV per summed count of each channel in 16.16 fixed point, nominal and
+   with the correction gain */
+static uint32_t ADCACQ_Factor[ADCACQ_MAX_CHANNELS];
+static uint32_t ADCACQ_Mul[ADCACQ_MAX_CHANNELS];
+
+/* mV added to each output for the correction offset, 16.16 fixed point */
+static int32_t ADCACQ_Add[ADCACQ_MAX_CHANNELS];
+
+/* Samples summed towards the next output */
+static uint32_t ADCACQ_Sum[ADCACQ_MAX_CHANNELS];
+static uint32_t ADCACQ_Count[ADCACQ_MAX_CHANNELS];
+
+/* Bit set for each channel near or below its low threshold */
+static uint32_t ADCACQ_NearLow = 0U;
+
+static uint32_t ADCACQ_Read = 0U;                 /* Next set of the ring */
+static uint32_t ADCACQ_LastTick = 0U;
+
+static ADCACQ_State_TypeDef ADCACQ_State;
+
+static void ADCACQ_InitDma(void);
+static void ADCACQ_Sample(uint32_t channel, uint32_t counts);
+static void ADCACQ_Compare(uint32_t channel, uint32_t value);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Set up MibADC1 group 1 and its DMA channel and start sampling.
+ *
+ * @details
+ *   Call before SCHEDULER_Start; conversions begin with the first tick.
+ *   Run ADCACQ_Update every ADCACQ_PERIOD.
+ *
+ * @param[in] params
+ *   Channel table, or 0 for ADCACQ_DefaultParams.
+ *
+ * @param[in] Threshold
+ *   Called on every threshold crossing, or 0 for none.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+ADCACQ_Err_TypeDef ADCACQ_Init(const ADCACQ_Params_TypeDef *params,
+                               ADCACQ_Threshold_TypeDef Threshold)
+{
+  const ADCACQ_Channel_TypeDef *c;
+  uint32_t pins = 0U;
+  uint32_t divisor;
+  uint32_t i;
+
+  if ( params == 0 )
+  {
+    params = &ADCACQ_DefaultParams;
+  }
+
+  if ( params->numChannels == 0U || params->numChannels > ADCACQ_MAX_CHANNELS )
+  {
+    return ADCACQ_Err_Invalid;
+  }
+
+  for ( i = 0U; i < params->numChannels; i++ )
+  {
+    c = &params->channel[i];
+    if ( c->pin >= ADCACQ_NUM_PINS || (pins & (1UL << c->pin)) != 0U
+         || c->decimation == 0U || c->decimation > ADCACQ_MAX_DECIMATION
+         || c->scale == 0U )
+    {
+      return ADCACQ_Err_Invalid;
+    }
+    pins |= 1UL << c->pin;
+  }
+
+  ADCACQ_Params = *params;
+  ADCACQ_Threshold = Threshold;
+  ADCACQ_NearLow = 0U;
+  IDLE_Unlock(IDLE_Lock_Adc);
+
+  for ( i = 0U; i < ADCACQ_NUM_IDS; i++ )
+  {
+    ADCACQ_Index[i] = ADCACQ_NO_CHANNEL;
+  }
+
+  for ( i = 0U; i < ADCACQ_MAX_CHANNELS; i++ )
+  {
+    ADCACQ_Sum[i] = 0U;
+    ADCACQ_Count[i] = 0U;
+    ADCACQ_State.output[i].value = 0U;
+    ADCACQ_State.output[i].level = ADCACQ_Level_Normal;
+
+    if ( i < params->numChannels )
+    {
+      c = &params->channel[i];
+      divisor = ADCACQ_FULL_SCALE * c->decimation;
+      ADCACQ_Index[c->pin] = (uint8_t)i;
+      ADCACQ_Factor[i] = (uint32_t)((((uint64_t)c->scale << 16U) + divisor / 2U) / divisor);
+      ADCACQ_Mul[i] = ADCACQ_Factor[i];
+      ADCACQ_Add[i] = 0;
+    }
+  }
+
+  ADCACQ_ResetStats();
+
+  /* Reset, 12 bit mode, clock and result RAM */
+  ADCACQ_ADC->RSTCR = 1U;
+  ADCACQ_ADC->RSTCR = 0U;
+  ADCACQ_ADC->OPMODECR = ADC_12_BIT_MODE;
+  ADCACQ_ADC->CLOCKCR = ADCACQ_CLOCK_DIV;
+  ADCACQ_ADC->BNDCR = (ADCACQ_BND_EVENT << 16U) | (ADCACQ_BND_EVENT + ADCACQ_BND_GROUP1);
+  ADCACQ_ADC->BNDEND = ADCACQ_BNDEND_64;
+
+  /* Group 1 on the trigger, one DMA request per group conversion */
+  ADCACQ_ADC->GxMODECR[1U] = (uint32_t)ADC_12_BIT | ADCACQ_MODE_HW_TRIGGER | ADCACQ_MODE_CHID;
+  ADCACQ_ADC->G1SRC = ADCACQ_SRC_RISING | (uint32_t)ADCACQ_TRIGGER;
+  ADCACQ_ADC->G1SAMP = ADCACQ_SAMPLE_WINDOW;
+  ADCACQ_ADC->G1SAMPDISEN = 0U;
+  ADCACQ_ADC->GxINTENA[1U] = 0U;
+  ADCACQ_ADC->G1DMACR = (params->numChannels << ADCACQ_DMACR_BLOCKS_SHIFT)
+                        | ADCACQ_DMACR_BLOCK | ADCACQ_DMACR_ENABLE;
+
+  ADCACQ_ADC->OPMODECR |= ADCACQ_OPMODE_ENABLE;
+  while ( (ADCACQ_ADC->BNDEND & ADCACQ_BNDEND_INIT) != 0U ) {}
+
+  ADCACQ_InitDma();
+
+  /* Selecting the pins arms the group for the trigger */
+  ADCACQ_Read = 0U;
+  ADCACQ_LastTick = SCHEDULER_GetTicks();
+  ADCACQ_ADC->GxSEL[1U] = pins;
+
+  return ADCACQ_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Take the group conversions the DMA has written since the last run, and
+ *   keep the deep idle modes off while a channel is near its low
+ *   threshold. Run as a scheduler task every ADCACQ_PERIOD.
+ ******************************************************************************/
+void ADCACQ_Update(void)
+{
+  uint32_t n = ADCACQ_Params.numChannels;
+  uint32_t now = SCHEDULER_GetTicks();
+  uint32_t elapsed = now - ADCACQ_LastTick;
+  uint32_t head;
+  uint32_t pending;
+  uint32_t word;
+  uint32_t index;
+  uint32_t i;
+
+  if ( n == 0U )
+  {
+    return;
+  }
+
+  if ( (ADCACQ_ADC->GxINTFLG[1U] & ADCACQ_INTFLG_OVERRUN) != 0U )
+  {
+    ADCACQ_State.overruns++;
+    ADCACQ_ADC->GxFIFORESETCR[1U] = 1U;
+  }
+
+  /* The frames left count down to 0 at the end of the ring and reload on
+   * the next request; the working packet is written back after each frame */
+  head = ADCACQ_RING_SETS - (dmaRAMREG->WCP[ADCACQ_DMA].CTCOUNT >> 16U);
+  if ( head >= ADCACQ_RING_SETS )
+  {
+    head = 0U;
+  }
+  pending = (head + ADCACQ_RING_SETS - ADCACQ_Read) % ADCACQ_RING_SETS;
+  ADCACQ_LastTick = now;
+
+  /* One set per tick; after a ring of ticks the sets not yet taken have
+   * been written over */
+  if ( elapsed >= ADCACQ_RING_SETS )
+  {
+    ADCACQ_State.lost += elapsed - pending;
+    ADCACQ_Read = head;
+    return;
+  }
+
+  for ( ; pending > 0U; pending-- )
+  {
+    for ( i = 0U; i < n; i++ )
+    {
+      word = ADCACQ_Ring[ADCACQ_Read * n + i];
+      index = ADCACQ_Index[(word >> ADCACQ_RESULT_ID_SHIFT) & ADCACQ_RESULT_ID_MASK];
+
+      if ( index == ADCACQ_NO_CHANNEL )
+      {
+        ADCACQ_State.unknown++;
+        continue;
+      }
+
+      ADCACQ_Sample(index, word & ADCACQ_RESULT_DATA_MASK);
+    }
+
+    ADCACQ_Read = (ADCACQ_Read + 1U) % ADCACQ_RING_SETS;
+    ADCACQ_State.sets++;
+  }
+
+  if ( ADCACQ_NearLow != 0U )
+  {
+    IDLE_Lock(IDLE_Lock_Adc);
+  }
+  else
+  {
+    IDLE_Unlock(IDLE_Lock_Adc);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the last output of a channel.
+ *
+ * @param[in] channel
+ *   Index in the channel table.
+ *
+ * @return
+ *   Returns the value in mV, 0 before the first output or if there is no
+ *   such channel.
+ ******************************************************************************/
+uint32_t ADCACQ_GetValue(uint32_t channel)
+{
+  return (channel < ADCACQ_Params.numChannels) ? ADCACQ_State.output[channel].value : 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the correction of a channel. Samples become gain times the sum of
+ *   counts and offset from the next output on.
+ *
+ * @param[in] channel
+ *   Index in the channel table.
+ *
+ * @param[in] offset
+ *   Counts added to each sample, 16.16 fixed point.
+ *
+ * @param[in] gain
+ *   Gain, 16.16 fixed point, ADCACQ_GAIN_ONE for none.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+ADCACQ_Err_TypeDef ADCACQ_SetCorrection(uint32_t channel,
+                                        int32_t offset,
+                                        uint32_t gain)
+{
+  uint32_t mul;
+
+  if ( channel >= ADCACQ_Params.numChannels )
+  {
+    return ADCACQ_Err_Invalid;
+  }
+
+  mul = (uint32_t)(((uint64_t)ADCACQ_Factor[channel] * gain + 0x8000U) >> 16U);
+
+  ADCACQ_Mul[channel] = mul;
+  ADCACQ_Add[channel] = (int32_t)(((int64_t)offset * ADCACQ_Params.channel[channel].decimation
+                                   * (int64_t)mul) / 0x10000);
+
+  return ADCACQ_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the channel table in use.
+ *
+ * @return
+ *   Returns pointer to the parameters passed to ADCACQ_Init.
+ ******************************************************************************/
+const ADCACQ_Params_TypeDef *ADCACQ_GetParams(void)
+{
+  return &ADCACQ_Params;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the counters and the extremes, keeping values and levels.
+ ******************************************************************************/
+void ADCACQ_ResetStats(void)
+{
+  uint32_t i;
+
+  ADCACQ_State.sets = 0U;
+  ADCACQ_State.lost = 0U;
+  ADCACQ_State.unknown = 0U;
+  ADCACQ_State.overruns = 0U;
+
+  for ( i = 0U; i < ADCACQ_MAX_CHANNELS; i++ )
+  {
+    ADCACQ_State.output[i].min = 0xFFFFFFFFU;
+    ADCACQ_State.output[i].max = 0U;
+    ADCACQ_State.output[i].outputs = 0U;
+    ADCACQ_State.output[i].crossings = 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the statistics.
+ *
+ * @return
+ *   Returns pointer to the statistics.
+ ******************************************************************************/
+const ADCACQ_State_TypeDef *ADCACQ_GetState(void)
+{
+  return &ADCACQ_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the counters and every channel: pin, last, lowest and highest
+ *   output in mV, outputs, crossings and level.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef ADCACQ_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static const char *levels[] = { "NORMAL", "LOW", "HIGH" };
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const ADCACQ_State_TypeDef *s = &ADCACQ_State;
+  const ADCACQ_Output_TypeDef *o;
+  PRINT_Err_TypeDef ret;
+  uint32_t i;
+
+  PRINT_PrintString(uart,"ADC SETS=");
+  PRINT_FormatUInt(buf,s->sets);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," LOST=");
+  PRINT_FormatUInt(buf,s->lost);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," UNKNOWN=");
+  PRINT_FormatUInt(buf,s->unknown);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," OVERRUNS=");
+  PRINT_FormatUInt(buf,s->overruns);
+  ret = PRINT_PrintStringln(uart,buf);
+
+  for ( i = 0U; i < ADCACQ_Params.numChannels && ret == PRINT_Err_NoError; i++ )
+  {
+    o = &s->output[i];
+
+    PRINT_PrintString(uart,"PIN=");
+    PRINT_FormatUInt(buf,ADCACQ_Params.channel[i].pin);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MV=");
+    PRINT_FormatUInt(buf,o->value);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MIN=");
+    PRINT_FormatUInt(buf,(o->outputs != 0U) ? o->min : 0U);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MAX=");
+    PRINT_FormatUInt(buf,o->max);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," OUTPUTS=");
+    PRINT_FormatUInt(buf,o->outputs);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," CROSSINGS=");
+    PRINT_FormatUInt(buf,o->crossings);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," ");
+    ret = PRINT_PrintStringln(uart,(char *)levels[o->level]);
+  }
+
+  return ret;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Set up the DMA channel: on each request of group 1 one frame of a
+ *   result per channel from the FIFO into the next set of the ring,
+ *   starting over at the first set after the last.
+ ******************************************************************************/
+static void ADCACQ_InitDma(void)
+{
+  g_dmaCTRL packet;
+
+  packet.SADD      = (uint32)&ADCACQ_ADC->GxBUF[1U].BUF0;
+  packet.DADD      = (uint32)ADCACQ_Ring;
+  packet.CHCTRL    = 0U;
+  packet.FRCNT     = ADCACQ_RING_SETS;
+  packet.ELCNT     = ADCACQ_Params.numChannels;
+  packet.ELDOFFSET = 0U;
+  packet.ELSOFFSET = 0U;
+  packet.FRDOFFSET = 0U;
+  packet.FRSOFFSET = 0U;
+  packet.PORTASGN  = ADCACQ_DMA_PORTB;
+  packet.RDSIZE    = ACCESS_32_BIT;
+  packet.WRSIZE    = ACCESS_32_BIT;
+  packet.TTYPE     = FRAME_TRANSFER;
+  packet.ADDMODERD = ADDR_FIXED;
+  packet.ADDMODEWR = ADDR_INC1;
+  packet.AUTOINIT  = AUTOINIT_ON;
+  packet.COMBO     = 0U;
+
+  dmaEnable();
+  dmaReqAssign(ADCACQ_DMA, ADCACQ_DMA_REQUEST);
+  dmaSetCtrlPacket(ADCACQ_DMA, packet);
+
+  /* Read as the start of the ring until the first frame is written back */
+  dmaRAMREG->WCP[ADCACQ_DMA].CTCOUNT = 0U;
+
+  dmaSetChEnable(ADCACQ_DMA, (uint32)DMA_HW);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add a conversion to the output of its channel, completing the output
+ *   after decimation samples.
+ ******************************************************************************/
+static void ADCACQ_Sample(uint32_t channel, uint32_t counts)
+{
+  ADCACQ_Output_TypeDef *o = &ADCACQ_State.output[channel];
+  int64_t acc;
+  uint32_t value;
+
+  ADCACQ_Sum[channel] += counts;
+  if ( ++ADCACQ_Count[channel] < ADCACQ_Params.channel[channel].decimation )
+  {
+    return;
+  }
+
+  /* Scale and correction in one multiply-add, clipped at 0 mV */
+  acc = (int64_t)ADCACQ_Sum[channel] * ADCACQ_Mul[channel] + ADCACQ_Add[channel] + 0x8000;
+  value = (acc > 0) ? (uint32_t)(acc >> 16U) : 0U;
+  ADCACQ_Sum[channel] = 0U;
+  ADCACQ_Count[channel] = 0U;
+
+  o->value = value;
+  o->outputs++;
+  if ( value < o->min )
+  {
+    o->min = value;
+  }
+  if ( value > o->max )
+  {
+    o->max = value;
+  }
+
+  ADCACQ_Compare(channel, value);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Move a channel between levels and report the crossing, and note
+ *   whether it is near its low threshold.
+ ******************************************************************************/
+static void ADCACQ_Compare(uint32_t channel, uint32_t value)
+{
+  const ADCACQ_Channel_TypeDef *c = &ADCACQ_Params.channel[channel];
+  ADCACQ_Output_TypeDef *o = &ADCACQ_State.output[channel];
+  ADCACQ_Level_TypeDef level = o->level;
+
+  if ( c->low != 0U && value < (uint32_t)c->low + c->hysteresis )
+  {
+    ADCACQ_NearLow |= 1UL << channel;
+  }
+  else
+  {
+    ADCACQ_NearLow &= ~(1UL << channel);
+  }
+
+  if ( level == ADCACQ_Level_Low && value >= (uint32_t)c->low + c->hysteresis )
+  {
+    level = ADCACQ_Level_Normal;
+  }
+  else if ( level == ADCACQ_Level_High && value + c->hysteresis <= c->high )
+  {
+    level = ADCACQ_Level_Normal;
+  }
+
+  if ( level == ADCACQ_Level_Normal )
+  {
+    if ( c->low != 0U && value < c->low )
+    {
+      level = ADCACQ_Level_Low;
+    }
+    else if ( c->high != 0U && value > c->high )
+    {
+      level = ADCACQ_Level_High;
+    }
+  }
+
+  if ( level == o->level )
+  {
+    return;
+  }
+
+  o->level = level;
+  o->crossings++;
+
+  if ( ADCACQ_Threshold != 0 )
+  {
+    ADCACQ_Threshold(channel, level, value);
+  }
+}
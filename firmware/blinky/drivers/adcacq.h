@@ -0,0 +1,206 @@
+/** @file adcacq.h
+*   @brief ADC Acquisition Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup ADCACQ ADCACQ
+ *  @brief Continuous MibADC sampling of the battery and other analog inputs.
+ *
+ *  Group 1 of MibADC1 converts the pins of the channel table on a hardware
+ *  trigger, RTI compare 0, which is the scheduler tick: one conversion of
+ *  every pin each ms, a thousand times the rate the battery is read over
+ *  I2C. Compare 0 keeps matching while ticks are suspended, so sampling
+ *  goes on through WFI; doze and snooze stop VCLK and the converter with
+ *  it. While a channel is below its low threshold, or less than the
+ *  hysteresis above it, ADCACQ_Update holds IDLE_Lock_Adc, so the deep
+ *  modes are ruled out and the crossing is sampled without gaps.
+ *
+ *  Each group conversion raises a block DMA request; ADCACQ_DMA moves the
+ *  results, channel id included, into a RAM ring of ADCACQ_RING_SETS
+ *  conversions and starts over at its end without the CPU. ADCACQ_Update
+ *  finds how far the DMA has got from the remaining frame count of the
+ *  channel and takes the new conversions: every channel averages its own
+ *  number of samples into one output, scaled to mV, and compares it with
+ *  a low and a high threshold. A crossing calls the threshold function
+ *  passed to ADCACQ_Init; the level returns to normal once the value is
+ *  back past the threshold by the hysteresis. A crossing is seen within
+ *  decimation samples plus ADCACQ_PERIOD. The period is a third of the
+ *  ring, so a run held up behind the telemetry sweep loses nothing.
+ *
+ *  The samples of a channel are corrected for the offset and gain set by
+ *  ADCACQ_SetCorrection, gain times counts plus offset. Both are folded
+ *  into the scale, so an output costs one fixed point multiply-add on the
+ *  sum of its samples whatever the decimation.
+ *
+ *  Conversions the task did not take before the ring came round again are
+ *  counted as lost and skipped. Results whose channel id belongs to no
+ *  channel, e.g. after a FIFO overrun, are counted and dropped.
+ *
+ *	Related Files
+ *   - adcacq.h
+ *   - adcacq.c
+ *   - adc.h
+ *   - sys_dma.h
+ *   - scheduler.h
+ *   - idle.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_ADCACQ_H_
+#define DRIVERS_ADCACQ_H_
+
+#include "adc.h"
+#include "sys_dma.h"
+#include "scheduler.h"
+#include "idle.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Period of the acquisition task in ticks */
+#define ADCACQ_PERIOD             (SCHEDULER_MS(20))
+
+#define ADCACQ_ADC                (adcREG1)
+
+/** Group 1 trigger, the scheduler tick */
+#define ADCACQ_TRIGGER            (ADC1_RTI_COMP0)
+
+/** DMA channel moving group 1 results, after those of AD5324 */
+#define ADCACQ_DMA                (DMA_CH2)
+
+/** Largest channel table */
+#define ADCACQ_MAX_CHANNELS       (4U)
+
+/** Group conversions held by the ring, ms at one per tick */
+#define ADCACQ_RING_SETS          (64U)
+
+/** Most samples averaged into one output */
+#define ADCACQ_MAX_DECIMATION     (64U)
+
+/** Counts at full scale of a 12 bit conversion */
+#define ADCACQ_FULL_SCALE         (4095U)
+
+/** Correction gain of 1 in 16.16 fixed point */
+#define ADCACQ_GAIN_ONE           (0x10000UL)
+
+/** Pin of the battery pack divider */
+#define ADCACQ_BATTERY_PIN        (2U)
+
+/** Pack mV at full scale, VCCAD of 3300 mV times the divider ratio of 3 */
+#define ADCACQ_BATTERY_SCALE      (9900U)
+
+/**
+ *  @addtogroup ADCACQ
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum ADCACQ_Err_TypeDef
+*   @brief Alias names for ADCACQ errors.
+*/
+typedef enum
+{
+  ADCACQ_Err_NoError = 0U,        /**< No error*/
+  ADCACQ_Err_Invalid = 1U         /**< Channel table out of range*/
+} ADCACQ_Err_TypeDef;
+
+/** @enum ADCACQ_Level_TypeDef
+*   @brief Level of a channel against its thresholds.
+*/
+typedef enum
+{
+  ADCACQ_Level_Normal = 0U,       /**< Between the thresholds*/
+  ADCACQ_Level_Low    = 1U,       /**< Below the low threshold*/
+  ADCACQ_Level_High   = 2U        /**< Above the high threshold*/
+} ADCACQ_Level_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct ADCACQ_Channel_TypeDef
+*   @brief Channel parameters.
+*/
+typedef struct
+{
+  uint8_t pin;                    /**< ADIN pin, 0 to 23, each pin once*/
+  uint8_t decimation;             /**< Samples per output, 1 to ADCACQ_MAX_DECIMATION*/
+  uint16_t scale;                 /**< Input mV at ADCACQ_FULL_SCALE*/
+  uint16_t low;                   /**< Low threshold in mV, 0 for none*/
+  uint16_t high;                  /**< High threshold in mV, 0 for none*/
+  uint16_t hysteresis;            /**< Back past a threshold to be normal, in mV*/
+} ADCACQ_Channel_TypeDef;
+
+/** @struct ADCACQ_Params_TypeDef
+*   @brief Acquisition parameters.
+*/
+typedef struct
+{
+  uint32_t numChannels;           /**< 1 to ADCACQ_MAX_CHANNELS*/
+  ADCACQ_Channel_TypeDef channel[ADCACQ_MAX_CHANNELS];
+} ADCACQ_Params_TypeDef;
+
+/** @struct ADCACQ_Output_TypeDef
+*   @brief Decimated output of a channel.
+*/
+typedef struct
+{
+  uint32_t value;                 /**< Last output in mV*/
+  uint32_t min;                   /**< Lowest output in mV*/
+  uint32_t max;                   /**< Highest output in mV*/
+  uint32_t outputs;               /**< Outputs since reset*/
+  uint32_t crossings;             /**< Threshold crossings since reset*/
+  ADCACQ_Level_TypeDef level;     /**< Against the thresholds*/
+} ADCACQ_Output_TypeDef;
+
+/** @struct ADCACQ_State_TypeDef
+*   @brief Statistics.
+*/
+typedef struct
+{
+  uint32_t sets;                  /**< Group conversions taken*/
+  uint32_t lost;                  /**< Group conversions overwritten before taken*/
+  uint32_t unknown;               /**< Results of no channel*/
+  uint32_t overruns;              /**< Group 1 FIFO overruns*/
+  ADCACQ_Output_TypeDef output[ADCACQ_MAX_CHANNELS];
+} ADCACQ_State_TypeDef;
+
+/** Called from ADCACQ_Update when a channel changes level */
+typedef void (*ADCACQ_Threshold_TypeDef)(uint32_t channel,
+                                         ADCACQ_Level_TypeDef level,
+                                         uint32_t value);
+
+extern const ADCACQ_Params_TypeDef ADCACQ_DefaultParams;
+
+ADCACQ_Err_TypeDef ADCACQ_Init(const ADCACQ_Params_TypeDef *params,
+                               ADCACQ_Threshold_TypeDef Threshold);
+
+void ADCACQ_Update(void);
+
+uint32_t ADCACQ_GetValue(uint32_t channel);
+
+ADCACQ_Err_TypeDef ADCACQ_SetCorrection(uint32_t channel,
+                                        int32_t offset,
+                                        uint32_t gain);
+
+const ADCACQ_Params_TypeDef *ADCACQ_GetParams(void);
+
+void ADCACQ_ResetStats(void);
+
+const ADCACQ_State_TypeDef *ADCACQ_GetState(void);
+
+PRINT_Err_TypeDef ADCACQ_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_ADCACQ_H_ */
@@ -0,0 +1,581 @@
+/** @file adccal.c
+*   @brief ADC Calibration Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "adccal.h"
+#include "adcacq.h"
+#include "battery.h"
+#include "scheduler.h"
+#include "rti.h"
+#include "print.h"
+#include "stdint.h"
+
+/* CALCR: calibration mode, conversion start, VREFHI or reference bridge */
+#define ADCCAL_CALCR_ENABLE       (0x00000001U)
+#define ADCCAL_CALCR_HILO         (0x00000100U)
+#define ADCCAL_CALCR_BRIDGE       (0x00000200U)
+#define ADCCAL_CALCR_START        (0x00010000U)
+
+/* CALR: result of a calibration conversion */
+#define ADCCAL_CALR_MASK          (0xFFFU)
+
+/* G1SR: group conversion in progress */
+#define ADCCAL_SR_BUSY            (0x00000004U)
+
+/* Twice the mid scale count, 2047.5, of a 12 bit converter */
+#define ADCCAL_MID_SCALE_X2       (ADCACQ_FULL_SCALE)
+
+/* Calibration conversions: VREFLO, VREFHI, bridge either way round */
+#define ADCCAL_NUM_CONVERSIONS    (4U)
+
+/* Bounds of a gain check against one reference */
+#define ADCCAL_GAIN_MIN           (ADCACQ_GAIN_ONE / 2U)
+#define ADCCAL_GAIN_MAX           (ADCACQ_GAIN_ONE * 2U)
+
+const ADCCAL_Params_TypeDef ADCCAL_DefaultParams =
+{
+  SCHEDULER_MS(1000),             /* period */
+  SCHEDULER_MS(10000),            /* referencePeriod */
+  40U,                            /* tolerance */
+  4U,                             /* offsetDrift */
+  20000U,                         /* gainLimit, 2 % */
+  3000U,                          /* minReference */
+  20U,                            /* maxStep */
+  2U                              /* gainShift */
+};
+
+static ADCCAL_Params_TypeDef ADCCAL_Params;
+static ADCCAL_Reference_TypeDef ADCCAL_Reference = ADCCAL_BatteryReference;
+
+static uint8_t ADCCAL_Calibrated = 0U;            /* Boot offset taken */
+static uint32_t ADCCAL_LastReference = 0U;
+
+/* Output of each channel at the last idle pass, and the last reference with
+   the output taken with it, 0 mV for none */
+static uint32_t ADCCAL_Before[ADCACQ_MAX_CHANNELS];
+static uint32_t ADCCAL_PairMv[ADCACQ_MAX_CHANNELS];
+static uint32_t ADCCAL_PairValue[ADCACQ_MAX_CHANNELS];
+
+static ADCCAL_State_TypeDef ADCCAL_State;
+
+static uint8_t ADCCAL_Calibrate(void);
+static uint8_t ADCCAL_Convert(uint32_t mode, uint16_t *counts);
+static void ADCCAL_TakeReferences(void);
+static void ADCCAL_CheckGain(void);
+static void ADCCAL_Apply(void);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Calibrate the converter and set the correction of every channel.
+ *
+ * @details
+ *   Call after ADCACQ_Init and before SCHEDULER_Start, so group 1 is not
+ *   triggered meanwhile. Install ADCCAL_Idle in the idle hook.
+ *
+ * @param[in] params
+ *   Limits and periods, or 0 for ADCCAL_DefaultParams.
+ *
+ * @param[in] Reference
+ *   Function giving the reference of a channel, or null for
+ *   ADCCAL_BatteryReference.
+ *
+ * @return
+ *   Returns 0 if no error. On a failed self-test the channels keep no
+ *   correction until a calibration passes.
+ ******************************************************************************/
+ADCCAL_Err_TypeDef ADCCAL_Init(const ADCCAL_Params_TypeDef *params,
+                               ADCCAL_Reference_TypeDef Reference)
+{
+  uint32_t i;
+
+  if ( params == 0 )
+  {
+    params = &ADCCAL_DefaultParams;
+  }
+
+  if ( params->period == 0U || params->gainShift > 15U
+       || params->tolerance > ADCACQ_FULL_SCALE / 2U )
+  {
+    return ADCCAL_Err_Invalid;
+  }
+
+  ADCCAL_Params = *params;
+  ADCCAL_Reference = (Reference != 0) ? Reference : ADCCAL_BatteryReference;
+
+  ADCCAL_Calibrated = 0U;
+  ADCCAL_State.offset = 0;
+  ADCCAL_State.bootOffset = 0;
+  ADCCAL_State.flags = 0U;
+
+  for ( i = 0U; i < ADCACQ_MAX_CHANNELS; i++ )
+  {
+    ADCCAL_State.channel[i].gain = ADCACQ_GAIN_ONE;
+    ADCCAL_Before[i] = 0U;
+    ADCCAL_PairMv[i] = 0U;
+  }
+
+  ADCCAL_ResetStats();
+  ADCCAL_LastReference = SCHEDULER_GetTicks();
+
+  return (ADCCAL_Calibrate() != 0U) ? ADCCAL_Err_NoError : ADCCAL_Err_SelfTest;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Calibrate when a period has passed, pair new references with the ADC
+ *   outputs and check the gains when a reference period has passed. Call
+ *   from the scheduler idle hook, with IRQ masked.
+ *
+ * @details
+ *   A calibration is put off to a later idle period while group 1 converts
+ *   or its next trigger is less than ADCCAL_GUARD_COUNTS away.
+ ******************************************************************************/
+void ADCCAL_Idle(void)
+{
+  uint32_t now = SCHEDULER_GetTicks();
+
+  if ( ADCCAL_Params.period == 0U )
+  {
+    return;
+  }
+
+  if ( now - ADCCAL_State.lastTick >= ADCCAL_Params.period )
+  {
+    if ( (ADCACQ_ADC->G1SR & ADCCAL_SR_BUSY) != 0U
+         || rtiREG1->CMP[0U].COMPx - rtiREG1->CNT[0U].FRCx < ADCCAL_GUARD_COUNTS )
+    {
+      ADCCAL_State.skipped++;
+    }
+    else
+    {
+      (void)ADCCAL_Calibrate();
+    }
+  }
+
+  ADCCAL_TakeReferences();
+
+  if ( ADCCAL_Params.referencePeriod != 0U
+       && now - ADCCAL_LastReference >= ADCCAL_Params.referencePeriod )
+  {
+    ADCCAL_LastReference = now;
+    ADCCAL_CheckGain();
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Tell whether the ADCACQ values can be used on their own.
+ *
+ * @return
+ *   Returns 1 if no drift flag is set.
+ ******************************************************************************/
+uint8_t ADCCAL_IsTrusted(void)
+{
+  return (ADCCAL_GetFlags() == 0U) ? 1U : 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the drift flags.
+ *
+ * @return
+ *   Returns the ADCCAL_Flag_TypeDef set, stale included.
+ ******************************************************************************/
+uint32_t ADCCAL_GetFlags(void)
+{
+  uint32_t flags = ADCCAL_State.flags;
+
+  if ( ADCCAL_Calibrated == 0U
+       || SCHEDULER_GetTicks() - ADCCAL_State.lastTick
+          > ADCCAL_Params.period * ADCCAL_STALE_PERIODS )
+  {
+    flags |= ADCCAL_Flag_Stale;
+  }
+
+  return flags;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the counters, keeping the correction and the flags.
+ ******************************************************************************/
+void ADCCAL_ResetStats(void)
+{
+  uint32_t i;
+
+  ADCCAL_State.runs = 0U;
+  ADCCAL_State.skipped = 0U;
+  ADCCAL_State.failures = 0U;
+
+  for ( i = 0U; i < ADCACQ_MAX_CHANNELS; i++ )
+  {
+    ADCCAL_State.channel[i].references = 0U;
+    ADCCAL_State.channel[i].rejected = 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the last calibration and the statistics.
+ *
+ * @return
+ *   Returns pointer to the state.
+ ******************************************************************************/
+const ADCCAL_State_TypeDef *ADCCAL_GetState(void)
+{
+  return &ADCCAL_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the counters, the last self-test conversions, the offset now and
+ *   at boot in counts and the flags, then every channel: pin, gain in ppm,
+ *   gain checks and rejected references.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef ADCCAL_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const ADCCAL_State_TypeDef *s = &ADCCAL_State;
+  const ADCACQ_Params_TypeDef *p = ADCACQ_GetParams();
+  PRINT_Err_TypeDef ret;
+  uint32_t flags = ADCCAL_GetFlags();
+  uint32_t i;
+
+  PRINT_PrintString(uart,"ADCCAL RUNS=");
+  PRINT_FormatUInt(buf,s->runs);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," SKIPPED=");
+  PRINT_FormatUInt(buf,s->skipped);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," FAILURES=");
+  PRINT_FormatUInt(buf,s->failures);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," LO=");
+  PRINT_FormatUInt(buf,s->low);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," HI=");
+  PRINT_FormatUInt(buf,s->high);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," MID=");
+  PRINT_FormatUInt(buf,s->bridge[0]);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart,",");
+  PRINT_FormatUInt(buf,s->bridge[1]);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," OFFSET=");
+  PRINT_FormatFixed(buf,(int32_t)(((int64_t)s->offset * 100) / 0x10000),2U,2U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," BOOT=");
+  PRINT_FormatFixed(buf,(int32_t)(((int64_t)s->bootOffset * 100) / 0x10000),2U,2U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," FLAGS=0x");
+  PRINT_FormatHex(buf,flags,2U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ");
+  ret = PRINT_PrintStringln(uart,(flags == 0U) ? "TRUSTED" : "UNTRUSTED");
+
+  for ( i = 0U; i < p->numChannels && ret == PRINT_Err_NoError; i++ )
+  {
+    PRINT_PrintString(uart,"PIN=");
+    PRINT_FormatUInt(buf,p->channel[i].pin);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," GAIN=");
+    PRINT_FormatUInt(buf,(uint32_t)(((uint64_t)s->channel[i].gain * 1000000U + 0x8000U) >> 16U));
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," REFERENCES=");
+    PRINT_FormatUInt(buf,s->channel[i].references);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," REJECTED=");
+    PRINT_FormatUInt(buf,s->channel[i].rejected);
+    ret = PRINT_PrintStringln(uart,buf);
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Reference of the battery channel: the pack voltage of the last BATTERY
+ *   sample, each sample only once.
+ *
+ * @param[in] channel
+ *   Index in the ADCACQ channel table.
+ *
+ * @param[out] mv
+ *   Pack voltage in mV.
+ *
+ * @return
+ *   Returns 1 if a new reference was written.
+ ******************************************************************************/
+uint8_t ADCCAL_BatteryReference(uint32_t channel, uint32_t *mv)
+{
+  static uint32_t updates = 0U;
+  const BATTERY_State_TypeDef *b = BATTERY_GetState();
+
+  if ( ADCACQ_GetParams()->channel[channel].pin != ADCACQ_BATTERY_PIN
+       || b->valid == 0U || b->voltage <= 0 || b->updates == updates )
+  {
+    return 0U;
+  }
+
+  updates = b->updates;
+  *mv = ((uint32_t)b->voltage + 500U) / 1000U;
+
+  return 1U;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Make the calibration conversions with group 1 disarmed, check them and
+ *   take the offset from the bridge pair.
+ *
+ * @return
+ *   Returns 1 if the self-test passed.
+ ******************************************************************************/
+static uint8_t ADCCAL_Calibrate(void)
+{
+  static const uint32_t modes[ADCCAL_NUM_CONVERSIONS] =
+  {
+    0U, ADCCAL_CALCR_HILO, ADCCAL_CALCR_BRIDGE, ADCCAL_CALCR_BRIDGE | ADCCAL_CALCR_HILO
+  };
+  ADCCAL_State_TypeDef *s = &ADCCAL_State;
+  uint16_t counts[ADCCAL_NUM_CONVERSIONS];
+  uint32_t tolerance = ADCCAL_Params.tolerance;
+  uint32_t pins = ADCACQ_ADC->GxSEL[1U];
+  uint32_t drift;
+  uint8_t ok = 1U;
+  uint32_t i;
+
+  ADCACQ_ADC->GxSEL[1U] = 0U;
+
+  for ( i = 0U; i < ADCCAL_NUM_CONVERSIONS && ok != 0U; i++ )
+  {
+    ok = ADCCAL_Convert(modes[i], &counts[i]);
+  }
+
+  /* Leave no correction in CALR, it is applied in software */
+  ADCACQ_ADC->CALCR = 0U;
+  ADCACQ_ADC->CALR = 0U;
+  ADCACQ_ADC->GxSEL[1U] = pins;
+
+  s->runs++;
+  s->lastTick = SCHEDULER_GetTicks();
+
+  if ( ok != 0U )
+  {
+    s->low = counts[0U];
+    s->high = counts[1U];
+    s->bridge[0U] = counts[2U];
+    s->bridge[1U] = counts[3U];
+
+    /* The ends at the rails and the bridge the same either way round */
+    ok = (s->low <= tolerance && s->high + tolerance >= ADCACQ_FULL_SCALE
+          && (uint32_t)(s->bridge[0U] > s->bridge[1U] ? s->bridge[0U] - s->bridge[1U]
+                                                      : s->bridge[1U] - s->bridge[0U]) <= tolerance)
+         ? 1U : 0U;
+  }
+
+  if ( ok == 0U )
+  {
+    s->failures++;
+    s->flags |= ADCCAL_Flag_SelfTest;
+    return 0U;
+  }
+
+  s->flags &= ~(uint32_t)ADCCAL_Flag_SelfTest;
+
+  /* Mid scale less the mean of the pair, in 16.16 counts */
+  s->offset = (int32_t)((uint32_t)ADCCAL_MID_SCALE_X2 << 15U)
+              - (int32_t)(((uint32_t)s->bridge[0U] + s->bridge[1U]) << 15U);
+
+  if ( ADCCAL_Calibrated == 0U )
+  {
+    ADCCAL_Calibrated = 1U;
+    s->bootOffset = s->offset;
+  }
+
+  drift = (uint32_t)((s->offset > s->bootOffset) ? s->offset - s->bootOffset
+                                                 : s->bootOffset - s->offset);
+  if ( drift > ((uint32_t)ADCCAL_Params.offsetDrift << 16U) )
+  {
+    s->flags |= ADCCAL_Flag_Offset;
+  }
+  else
+  {
+    s->flags &= ~(uint32_t)ADCCAL_Flag_Offset;
+  }
+
+  ADCCAL_Apply();
+
+  return 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Make one calibration conversion, as adcCalibration does.
+ *
+ * @return
+ *   Returns 1 if the conversion completed.
+ ******************************************************************************/
+static uint8_t ADCCAL_Convert(uint32_t mode, uint16_t *counts)
+{
+  uint32_t polls = 0U;
+
+  ADCACQ_ADC->CALCR = mode;
+  ADCACQ_ADC->CALCR |= ADCCAL_CALCR_ENABLE;
+  ADCACQ_ADC->CALCR |= ADCCAL_CALCR_START;
+
+  while ( (ADCACQ_ADC->CALCR & ADCCAL_CALCR_START) != 0U )
+  {
+    if ( ++polls >= ADCCAL_CONVERSION_TIMEOUT )
+    {
+      return 0U;
+    }
+  }
+
+  *counts = (uint16_t)(ADCACQ_ADC->CALR & ADCCAL_CALR_MASK);
+
+  return 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Pair every new reference with the output of its channel.
+ *
+ * @details
+ *   The idle pass after the task that read the reference sees it first, so
+ *   this output and the one of the previous idle pass bracket the reading.
+ *   If they are more than maxStep apart the input moved across it, from a
+ *   load step say, and the reference is dropped rather than compared with
+ *   an output of a different load.
+ ******************************************************************************/
+static void ADCCAL_TakeReferences(void)
+{
+  const ADCACQ_Params_TypeDef *p = ADCACQ_GetParams();
+  uint32_t value;
+  uint32_t step;
+  uint32_t mv;
+  uint32_t i;
+
+  for ( i = 0U; i < p->numChannels; i++ )
+  {
+    value = ADCACQ_GetValue(i);
+
+    if ( value != 0U && ADCCAL_Before[i] != 0U
+         && ADCCAL_Reference(i, &mv) != 0U && mv >= ADCCAL_Params.minReference )
+    {
+      step = (value > ADCCAL_Before[i]) ? value - ADCCAL_Before[i] : ADCCAL_Before[i] - value;
+      if ( step <= ADCCAL_Params.maxStep )
+      {
+        ADCCAL_PairMv[i] = mv;
+        ADCCAL_PairValue[i] = value;
+      }
+      else
+      {
+        ADCCAL_State.channel[i].rejected++;
+      }
+    }
+
+    ADCCAL_Before[i] = value;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Move the gain of every channel with a new reference pair a step towards
+ *   the one that makes the output of the pair match, and flag gains out of
+ *   the limit.
+ *
+ * @details
+ *   The output is already corrected, gain times counts plus offset, so the
+ *   gain matching the reference is the current one times reference over
+ *   output. The gain only changes here, where the pair is used up, so the
+ *   output of a pair was always made with the current gain.
+ ******************************************************************************/
+static void ADCCAL_CheckGain(void)
+{
+  const ADCACQ_Params_TypeDef *p = ADCACQ_GetParams();
+  ADCCAL_Channel_TypeDef *c;
+  uint32_t flagged = 0U;
+  uint32_t value;
+  uint32_t mv;
+  uint32_t target;
+  uint32_t ppm;
+  uint32_t i;
+
+  for ( i = 0U; i < p->numChannels; i++ )
+  {
+    c = &ADCCAL_State.channel[i];
+    value = ADCCAL_PairValue[i];
+    mv = ADCCAL_PairMv[i];
+
+    if ( mv != 0U )
+    {
+      ADCCAL_PairMv[i] = 0U;
+      target = (uint32_t)(((uint64_t)c->gain * mv + value / 2U) / value);
+      if ( target < ADCCAL_GAIN_MIN )
+      {
+        target = ADCCAL_GAIN_MIN;
+      }
+      else if ( target > ADCCAL_GAIN_MAX )
+      {
+        target = ADCCAL_GAIN_MAX;
+      }
+
+      c->gain = (uint32_t)((int32_t)c->gain
+                           + ((int32_t)target - (int32_t)c->gain) / (1 << ADCCAL_Params.gainShift));
+      c->references++;
+      (void)ADCACQ_SetCorrection(i, ADCCAL_State.offset, c->gain);
+    }
+
+    ppm = (uint32_t)((((uint64_t)((c->gain > ADCACQ_GAIN_ONE) ? c->gain - ADCACQ_GAIN_ONE
+                                                               : ADCACQ_GAIN_ONE - c->gain))
+                      * 1000000U) >> 16U);
+    if ( ppm > ADCCAL_Params.gainLimit )
+    {
+      flagged = 1U;
+    }
+  }
+
+  if ( flagged != 0U )
+  {
+    ADCCAL_State.flags |= ADCCAL_Flag_Gain;
+  }
+  else
+  {
+    ADCCAL_State.flags &= ~(uint32_t)ADCCAL_Flag_Gain;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the offset and gain of every channel in ADCACQ.
+ ******************************************************************************/
+static void ADCCAL_Apply(void)
+{
+  const ADCACQ_Params_TypeDef *p = ADCACQ_GetParams();
+  uint32_t i;
+
+  for ( i = 0U; i < p->numChannels; i++ )
+  {
+    ADCCAL_State.channel[i].offset = ADCCAL_State.offset;
+    (void)ADCACQ_SetCorrection(i, ADCCAL_State.offset, ADCCAL_State.channel[i].gain);
+  }
+}
@@ -0,0 +1,179 @@
+/** @file adccal.h
+*   @brief ADC Calibration Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup ADCCAL ADCCAL
+ *  @brief Offset and gain calibration of the ADCACQ channels and a check of
+ *         the converter against its references.
+ *
+ *  The offset comes from the calibration conversions of MibADC1, the same
+ *  four adcCalibration makes: VREFLO, VREFHI and the reference bridge at
+ *  mid scale with either polarity. The bridge pair gives the offset of the
+ *  converter to a fraction of a count, which applies to every channel. The
+ *  ends and the agreement of the pair are the self-test. The result is
+ *  applied in software through ADCACQ_SetCorrection rather than in CALR, so
+ *  the ring keeps raw conversions.
+ *
+ *  The converter has no gain reference of its own. The gain of a channel
+ *  comes from a reference measurement of the same input, for the battery
+ *  the pack voltage read by BATTERY over I2C. ADCCAL_Idle pairs each new
+ *  reference with the ADC output of the same moment, and drops it if the
+ *  outputs on either side of the reading are more than maxStep apart, so a
+ *  load step is not taken for a gain error. Every referencePeriod the gain
+ *  moves 1 / 2^gainShift of the way to the one matching the last pair.
+ *  Between those checks the fast ADC values stand on their own.
+ *
+ *  ADCCAL_Init calibrates at boot, before group 1 sees its first trigger.
+ *  After that ADCCAL_Idle, run from the scheduler idle hook, calibrates
+ *  again every period when group 1 is not converting and the next trigger
+ *  is at least ADCCAL_GUARD_COUNTS away; a calibration takes four
+ *  conversions, about 15 us.
+ *
+ *  Drift is flagged when the offset moves more than offsetDrift counts from
+ *  its boot value, the gain of a channel leaves unity by more than
+ *  gainLimit, a self-test fails or no calibration has run for
+ *  ADCCAL_STALE_PERIODS periods. ADCCAL_IsTrusted is false while any flag
+ *  is set; threshold decisions on ADCACQ values, undervoltage included,
+ *  should fall back to the I2C monitors then.
+ *
+ *	Related Files
+ *   - adccal.h
+ *   - adccal.c
+ *   - adcacq.h
+ *   - battery.h
+ *   - scheduler.h
+ *   - rti.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_ADCCAL_H_
+#define DRIVERS_ADCCAL_H_
+
+#include "adcacq.h"
+#include "battery.h"
+#include "scheduler.h"
+#include "rti.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Least RTI counts to the next group 1 trigger to start a calibration */
+#define ADCCAL_GUARD_COUNTS       (1000U)
+
+/** Periods without a calibration before the correction is stale */
+#define ADCCAL_STALE_PERIODS      (4U)
+
+/** Polls of a calibration conversion before it counts as failed */
+#define ADCCAL_CONVERSION_TIMEOUT (1000U)
+
+/**
+ *  @addtogroup ADCCAL
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum ADCCAL_Err_TypeDef
+*   @brief Alias names for ADCCAL errors.
+*/
+typedef enum
+{
+  ADCCAL_Err_NoError  = 0U,       /**< No error*/
+  ADCCAL_Err_Invalid  = 1U,       /**< Parameters out of range*/
+  ADCCAL_Err_SelfTest = 2U        /**< Boot calibration out of tolerance*/
+} ADCCAL_Err_TypeDef;
+
+/** @enum ADCCAL_Flag_TypeDef
+*   @brief Drift flags, or-ed together.
+*/
+typedef enum
+{
+  ADCCAL_Flag_SelfTest = 0x01U,   /**< Last self-test out of tolerance*/
+  ADCCAL_Flag_Offset   = 0x02U,   /**< Offset moved from its boot value*/
+  ADCCAL_Flag_Gain     = 0x04U,   /**< Gain of a channel away from unity*/
+  ADCCAL_Flag_Stale    = 0x08U    /**< No recent calibration*/
+} ADCCAL_Flag_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct ADCCAL_Params_TypeDef
+*   @brief Calibration parameters.
+*/
+typedef struct
+{
+  uint32_t period;                /**< Ticks between calibrations*/
+  uint32_t referencePeriod;       /**< Ticks between gain checks, 0 for none*/
+  uint16_t tolerance;             /**< Counts the self-test conversions may be off*/
+  uint16_t offsetDrift;           /**< Counts the offset may move from boot*/
+  uint32_t gainLimit;             /**< ppm the gain may differ from unity*/
+  uint16_t minReference;          /**< Least reference in mV used for the gain*/
+  uint16_t maxStep;               /**< mV the output may move across a reference*/
+  uint8_t gainShift;              /**< Gain moves by 1 / 2^gainShift of a check*/
+} ADCCAL_Params_TypeDef;
+
+/** @struct ADCCAL_Channel_TypeDef
+*   @brief Correction of a channel.
+*/
+typedef struct
+{
+  int32_t offset;                 /**< Counts added, 16.16 fixed point*/
+  uint32_t gain;                  /**< Gain, 16.16 fixed point*/
+  uint32_t references;            /**< Gain checks taken*/
+  uint32_t rejected;              /**< References dropped, the input moved*/
+} ADCCAL_Channel_TypeDef;
+
+/** @struct ADCCAL_State_TypeDef
+*   @brief Last calibration and statistics.
+*/
+typedef struct
+{
+  uint32_t runs;                  /**< Calibrations made*/
+  uint32_t skipped;               /**< Calibrations put off by group 1*/
+  uint32_t failures;              /**< Self-tests out of tolerance*/
+  uint32_t lastTick;              /**< Tick of the last calibration*/
+  uint16_t low;                   /**< VREFLO conversion*/
+  uint16_t high;                  /**< VREFHI conversion*/
+  uint16_t bridge[2];             /**< Mid scale conversions*/
+  int32_t bootOffset;             /**< Offset at boot, 16.16 fixed point*/
+  int32_t offset;                 /**< Last offset, 16.16 fixed point*/
+  uint32_t flags;                 /**< ADCCAL_Flag_TypeDef*/
+  ADCCAL_Channel_TypeDef channel[ADCACQ_MAX_CHANNELS];
+} ADCCAL_State_TypeDef;
+
+/** Get the reference of a channel in mV, returns 0 if none is available */
+typedef uint8_t (*ADCCAL_Reference_TypeDef)(uint32_t channel, uint32_t *mv);
+
+extern const ADCCAL_Params_TypeDef ADCCAL_DefaultParams;
+
+ADCCAL_Err_TypeDef ADCCAL_Init(const ADCCAL_Params_TypeDef *params,
+                               ADCCAL_Reference_TypeDef Reference);
+
+void ADCCAL_Idle(void);
+
+uint8_t ADCCAL_IsTrusted(void);
+
+uint32_t ADCCAL_GetFlags(void);
+
+void ADCCAL_ResetStats(void);
+
+const ADCCAL_State_TypeDef *ADCCAL_GetState(void);
+
+PRINT_Err_TypeDef ADCCAL_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+uint8_t ADCCAL_BatteryReference(uint32_t channel, uint32_t *mv);
+
+/**@}*/
+
+#endif /* DRIVERS_ADCCAL_H_ */
@@ -1,4 +1,4 @@
-/** @file battery.h 
+/** @file battery.c
 *   @brief Battery Board Implementation File
 *   @date 20-Dec-2022
 *   @author Stefan Damkjar, Junqi Zhu
@@ -6,9 +6,566 @@
 */
 
 #include "battery.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "print.h"
+#include "profile.h"
 #include "ina226.h"
 #include "stdint.h"
+#include <string.h>
+#include <math.h>
+
+/* Variance floor that keeps the covariance positive definite */
+#define BATTERY_MIN_VARIANCE      (1.0e-12f)
+
+/* Initial polarization variance in V^2 */
+#define BATTERY_V1_VARIANCE0      (1.0e-4f)
+
+/* Lowest capacity and highest resistance scale applied when cold */
+#define BATTERY_MIN_CAPACITY      (0.5f)
+#define BATTERY_MAX_RESISTANCE    (4.0f)
+
+/* Typical datasheet values, to be replaced by characterisation of the
+ * flight cells. The voltage noise is not the sensor noise but the error of
+ * the one RC model, which is slow and correlated from sample to sample;
+ * sized so that three sigma covers the replay error */
+const BATTERY_Cell_TypeDef BATTERY_Cells[BATTERY_NUM_CHEMISTRIES] =
+{
+  {
+    "NMC",
+    3.35f,
+    { 3.30f, 3.55f, 3.62f, 3.67f, 3.72f, 3.78f, 3.86f, 3.95f, 4.03f, 4.10f, 4.19f },
+    0.045f,
+    0.020f,
+    1500.0f,
+    0.015f,
+    0.006f,
+    0.995f,
+    1.0e-8f,
+    1.0e-6f,
+    1.0e-1f,
+    0.10f
+  },
+  {
+    "LFP",
+    1.10f,
+    { 2.80f, 3.18f, 3.24f, 3.27f, 3.29f, 3.30f, 3.31f, 3.32f, 3.33f, 3.35f, 3.45f },
+    0.015f,
+    0.010f,
+    3000.0f,
+    0.015f,
+    0.004f,
+    0.998f,
+    1.0e-8f,
+    1.0e-6f,
+    1.0e-1f,
+    0.10f
+  }
+};
+
+static BATTERY_Measure_TypeDef BATTERY_Measure = BATTERY_MeasureSensor;
+static const BATTERY_Cell_TypeDef *BATTERY_Cell = &BATTERY_Cells[BATTERY_Chemistry_NMC];
+static BATTERY_State_TypeDef BATTERY_State;
+static int32_t BATTERY_Temperature = BATTERY_DEFAULT_TEMP;
+static uint32_t BATTERY_LastSequence;
+
+/* Filter state of one cell: state of charge, RC voltage and covariance */
+static float BATTERY_Soc;
+static float BATTERY_V1;
+static float BATTERY_P00;
+static float BATTERY_P01;
+static float BATTERY_P11;
+static float BATTERY_SocCoulomb;
+static float BATTERY_ChargeIn;
+static float BATTERY_ChargeOut;
+static uint32_t BATTERY_LastTimestamp;
+
+static float BATTERY_Ocv(float soc, float *slope);
+static float BATTERY_SocFromOcv(float ocv);
+static float BATTERY_Clamp(float val, float min, float max);
+static uint32_t BATTERY_Permille(float val);
 
 /*******************************************************************************
  **************************   GLOBAL FUNCTIONS   *******************************
  ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Select the cell and clear the estimate. The first sample starts the
+ *   filter from the open circuit voltage.
+ *
+ * @details
+ *   With the default function this must be called after TELEMETRY_Init.
+ *   Run BATTERY_Update every BATTERY_PERIOD, after the telemetry sweep.
+ *
+ * @param[in] chemistry
+ *   Entry of the chemistry table.
+ *
+ * @param[in] Measure
+ *   Function used to read a sample, or null for BATTERY_MeasureSensor.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+BATTERY_Err_TypeDef BATTERY_Init(BATTERY_Chemistry_TypeDef chemistry,
+                                 BATTERY_Measure_TypeDef Measure)
+{
+  if ( (uint32_t)chemistry >= BATTERY_NUM_CHEMISTRIES )
+  {
+    return BATTERY_Err_Invalid;
+  }
+
+  BATTERY_Cell = &BATTERY_Cells[chemistry];
+  BATTERY_Measure = (Measure != 0) ? Measure : BATTERY_MeasureSensor;
+  BATTERY_LastSequence = TELEMETRY_GetSnapshot()->sequence;
+
+  BATTERY_Reset();
+  BATTERY_State.chemistry = chemistry;
+
+  return BATTERY_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read one sample and update the estimate. Run as a scheduler task every
+ *   BATTERY_PERIOD.
+ ******************************************************************************/
+void BATTERY_Update(void)
+{
+  BATTERY_Sample_TypeDef sample;
+  BATTERY_Err_TypeDef err;
+
+  err = BATTERY_Measure(&sample);
+  if ( err == BATTERY_Err_NoError )
+  {
+    PROFILE_BEGIN(PROFILE_Scope_BatteryStep);
+    err = BATTERY_Step(&sample);
+    PROFILE_END(PROFILE_Scope_BatteryStep);
+  }
+
+  /* A slower acquisition profile leaves the snapshot unchanged for a few
+   * releases, that is not an error */
+  if ( err != BATTERY_Err_NoError && err != BATTERY_Err_Stale )
+  {
+    BATTERY_State.errors++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Update the estimate with one sample.
+ *
+ * @details
+ *   Predicts the state of charge by coulomb counting and the RC voltage by
+ *   its time constant over the time since the last sample, then corrects
+ *   both with the terminal voltage. The RC pair is discretised with the
+ *   backward Euler step tau / (tau + dt), which needs no exponential and
+ *   stays stable for any interval. Intervals above BATTERY_MAX_DT_MS are
+ *   cut to it, the current is assumed constant over the interval.
+ *
+ * @param[in] sample
+ *   Pack sample. Its timestamp must advance.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+BATTERY_Err_TypeDef BATTERY_Step(const BATTERY_Sample_TypeDef *sample)
+{
+  const BATTERY_Cell_TypeDef *cell = BATTERY_Cell;
+  BATTERY_State_TypeDef *s = &BATTERY_State;
+  float voltage;
+  float current;
+  float cold;
+  float scale;
+  float r0;
+  float r1;
+  float capacity;
+  float dt;
+  float a;
+  float dSoc;
+  float ocv;
+  float slope;
+  float hp0;
+  float hp1;
+  float var;
+  float k0;
+  float k1;
+  float e;
+  uint32_t ms;
+
+  if ( sample == 0 || sample->voltage <= 0 )
+  {
+    return BATTERY_Err_Invalid;
+  }
+
+  voltage = (float)sample->voltage * 1.0e-6f / (float)BATTERY_CELLS_SERIES;
+  current = (float)sample->current * 1.0e-6f / (float)BATTERY_CELLS_PARALLEL;
+
+  /* Resistances rise and capacity falls below 25 C */
+  cold = BATTERY_Clamp(25.0f - (float)sample->temperature * 1.0e-3f, 0.0f, 100.0f);
+  scale = BATTERY_Clamp(1.0f + cell->resistanceTc * cold, 1.0f, BATTERY_MAX_RESISTANCE);
+  r0 = cell->r0 * scale;
+  r1 = cell->r1 * scale;
+  capacity = cell->capacity * 3600.0f
+           * BATTERY_Clamp(1.0f - cell->capacityTc * cold, BATTERY_MIN_CAPACITY, 1.0f);
+
+  s->voltage = sample->voltage;
+  s->current = sample->current;
+  s->temperature = sample->temperature;
+
+  if ( !s->valid )
+  {
+    /* Start from the open circuit voltage with the series drop removed, the
+     * RC voltage is unknown and taken as zero */
+    BATTERY_Soc = BATTERY_SocFromOcv(voltage - r0 * current);
+    BATTERY_V1 = 0.0f;
+    BATTERY_P00 = cell->socSigma0 * cell->socSigma0;
+    BATTERY_P01 = 0.0f;
+    BATTERY_P11 = BATTERY_V1_VARIANCE0;
+    BATTERY_SocCoulomb = BATTERY_Soc;
+    BATTERY_LastTimestamp = sample->timestamp;
+    s->valid = 1U;
+    s->updates++;
+    s->residual = 0;
+    s->ocv = (int32_t)(BATTERY_Ocv(BATTERY_Soc, &slope) * 1.0e6f * (float)BATTERY_CELLS_SERIES);
+    s->polarization = 0;
+    s->soc = BATTERY_Permille(BATTERY_Soc);
+    s->socCoulomb = s->soc;
+    s->socSigma = BATTERY_Permille(cell->socSigma0);
+    return BATTERY_Err_NoError;
+  }
+
+  ms = sample->timestamp - BATTERY_LastTimestamp;
+  if ( ms == 0U || ms > 0x80000000UL )
+  {
+    return BATTERY_Err_Stale;
+  }
+  BATTERY_LastTimestamp = sample->timestamp;
+
+  if ( ms > BATTERY_MAX_DT_MS )
+  {
+    ms = BATTERY_MAX_DT_MS;
+    s->gaps++;
+  }
+  dt = (float)ms * 1.0e-3f;
+
+  /* Predict: coulomb counting and RC relaxation */
+  dSoc = current * dt / capacity;
+  if ( current > 0.0f )
+  {
+    dSoc *= cell->efficiency;
+    BATTERY_ChargeIn += current * dt * (float)BATTERY_CELLS_PARALLEL;
+  }
+  else
+  {
+    BATTERY_ChargeOut -= current * dt * (float)BATTERY_CELLS_PARALLEL;
+  }
+  BATTERY_Soc += dSoc;
+  BATTERY_SocCoulomb += dSoc;
+
+  a = r1 * cell->c1;
+  a = a / (a + dt);
+  BATTERY_V1 = a * BATTERY_V1 + (1.0f - a) * r1 * current;
+
+  /* P = F P F' + Q with F = diag(1, a) */
+  BATTERY_P00 += cell->socNoise * dt;
+  BATTERY_P01 *= a;
+  BATTERY_P11 = a * a * BATTERY_P11 + cell->v1Noise * dt;
+
+  /* Correct with the terminal voltage, H = [dOCV/dSoC, 1] */
+  ocv = BATTERY_Ocv(BATTERY_Soc, &slope);
+  e = voltage - (ocv + BATTERY_V1 + r0 * current);
+
+  hp0 = slope * BATTERY_P00 + BATTERY_P01;
+  hp1 = slope * BATTERY_P01 + BATTERY_P11;
+  var = slope * hp0 + hp1 + cell->vNoise;
+
+  if ( e * e > BATTERY_GATE_SIGMA * BATTERY_GATE_SIGMA * var )
+  {
+    s->rejected++;
+  }
+  else
+  {
+    k0 = hp0 / var;
+    k1 = hp1 / var;
+
+    BATTERY_Soc += k0 * e;
+    BATTERY_V1 += k1 * e;
+
+    /* P = P - K S K' */
+    BATTERY_P00 -= k0 * hp0;
+    BATTERY_P01 -= k0 * hp1;
+    BATTERY_P11 -= k1 * hp1;
+  }
+
+  BATTERY_Soc = BATTERY_Clamp(BATTERY_Soc, 0.0f, 1.0f);
+  BATTERY_SocCoulomb = BATTERY_Clamp(BATTERY_SocCoulomb, 0.0f, 1.0f);
+  if ( BATTERY_P00 < BATTERY_MIN_VARIANCE )
+  {
+    BATTERY_P00 = BATTERY_MIN_VARIANCE;
+  }
+  if ( BATTERY_P11 < BATTERY_MIN_VARIANCE )
+  {
+    BATTERY_P11 = BATTERY_MIN_VARIANCE;
+  }
+  if ( BATTERY_P01 * BATTERY_P01 > BATTERY_P00 * BATTERY_P11 )
+  {
+    BATTERY_P01 = 0.0f;
+  }
+
+  ocv = BATTERY_Ocv(BATTERY_Soc, &slope);
+
+  s->updates++;
+  s->soc = BATTERY_Permille(BATTERY_Soc);
+  s->socCoulomb = BATTERY_Permille(BATTERY_SocCoulomb);
+  s->socSigma = BATTERY_Permille(sqrtf(BATTERY_P00));
+  s->ocv = (int32_t)(ocv * 1.0e6f * (float)BATTERY_CELLS_SERIES);
+  s->polarization = (int32_t)(BATTERY_V1 * 1.0e6f * (float)BATTERY_CELLS_SERIES);
+  s->residual = (int32_t)(e * 1.0e6f * (float)BATTERY_CELLS_SERIES);
+  s->chargeIn = (uint32_t)(BATTERY_ChargeIn / 3.6f);
+  s->chargeOut = (uint32_t)(BATTERY_ChargeOut / 3.6f);
+
+  return BATTERY_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the estimate and statistics. The next sample restarts the filter
+ *   from the open circuit voltage.
+ ******************************************************************************/
+void BATTERY_Reset(void)
+{
+  BATTERY_Chemistry_TypeDef chemistry = BATTERY_State.chemistry;
+
+  memset(&BATTERY_State, 0, sizeof(BATTERY_State));
+  BATTERY_State.chemistry = chemistry;
+  BATTERY_ChargeIn = 0.0f;
+  BATTERY_ChargeOut = 0.0f;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the cell temperature used by BATTERY_MeasureSensor.
+ *
+ * @param[in] temperature
+ *   Temperature in mC.
+ ******************************************************************************/
+void BATTERY_SetTemperature(int32_t temperature)
+{
+  BATTERY_Temperature = temperature;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the estimate.
+ *
+ * @return
+ *   Returns pointer to the state.
+ ******************************************************************************/
+const BATTERY_State_TypeDef *BATTERY_GetState(void)
+{
+  return &BATTERY_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the estimate and statistics on one line.
+ *
+ * @param[in] uart
+ *   Pointer to UART register struct.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef BATTERY_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const BATTERY_State_TypeDef *s = &BATTERY_State;
+
+  PRINT_PrintString(uart,(char*)BATTERY_Cells[s->chemistry].name);
+  if ( !s->valid )
+  {
+    return PRINT_PrintStringln(uart," NO SAMPLE");
+  }
+
+  PRINT_PrintString(uart," SOC=");
+  PRINT_FormatFixed(buf,(int32_t)s->soc,1U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart,"% SIGMA=");
+  PRINT_FormatFixed(buf,(int32_t)s->socSigma,1U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart,"% CC=");
+  PRINT_FormatFixed(buf,(int32_t)s->socCoulomb,1U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart,"% V=");
+  PRINT_FormatEng(buf,s->voltage,PRINT_Unit_mV,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," I=");
+  PRINT_FormatEng(buf,s->current,PRINT_Unit_mA,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," T=");
+  PRINT_FormatFixed(buf,s->temperature,3U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," C OCV=");
+  PRINT_FormatEng(buf,s->ocv,PRINT_Unit_mV,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," VRC=");
+  PRINT_FormatEng(buf,s->polarization,PRINT_Unit_mV,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," RES=");
+  PRINT_FormatEng(buf,s->residual,PRINT_Unit_mV,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," IN=");
+  PRINT_FormatUInt(buf,s->chargeIn);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," mAh OUT=");
+  PRINT_FormatUInt(buf,s->chargeOut);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," mAh UPDATES=");
+  PRINT_FormatUInt(buf,s->updates);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," REJECTED=");
+  PRINT_FormatUInt(buf,s->rejected);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," GAPS=");
+  PRINT_FormatUInt(buf,s->gaps);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ERRORS=");
+  PRINT_FormatUInt(buf,s->errors);
+
+  return PRINT_PrintStringln(uart,buf);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read the battery bus power monitor from the latest telemetry snapshot.
+ *
+ * @details
+ *   The temperature is the one set with BATTERY_SetTemperature. Each
+ *   snapshot is used once.
+ *
+ * @param[out] sample
+ *   Pack sample.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+BATTERY_Err_TypeDef BATTERY_MeasureSensor(BATTERY_Sample_TypeDef *sample)
+{
+  const TELEMETRY_Snapshot_TypeDef *snap = TELEMETRY_GetSnapshot();
+
+  if ( snap->sequence == BATTERY_LastSequence )
+  {
+    return BATTERY_Err_Stale;
+  }
+  BATTERY_LastSequence = snap->sequence;
+
+  if ( (snap->errors & (1UL << TELEMETRY_Channel_BATBUS)) != 0U )
+  {
+    return BATTERY_Err_Measure;
+  }
+
+  sample->timestamp = snap->timestamp * (SCHEDULER_TICK_US / 1000U);
+  sample->voltage = snap->meas[TELEMETRY_Channel_BATBUS].voltage;
+  sample->current = BATTERY_CURRENT_SIGN * snap->meas[TELEMETRY_Channel_BATBUS].current;
+  sample->temperature = BATTERY_Temperature;
+
+  return BATTERY_Err_NoError;
+}
+
+/*******************************************************************************
+ ***************************   LOCAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Open circuit voltage of one cell, linear between the table points and
+ *   extrapolated from the end segments.
+ *
+ * @param[in] soc
+ *   State of charge, 0 to 1.
+ *
+ * @param[out] slope
+ *   Derivative of the open circuit voltage in V per unit state of charge.
+ *
+ * @return
+ *   Returns the open circuit voltage in V.
+ ******************************************************************************/
+static float BATTERY_Ocv(float soc, float *slope)
+{
+  const float *ocv = BATTERY_Cell->ocv;
+  float x = soc * (float)(BATTERY_OCV_POINTS - 1U);
+  int32_t i = (int32_t)x;
+
+  if ( i < 0 )
+  {
+    i = 0;
+  }
+  else if ( i > (int32_t)BATTERY_OCV_POINTS - 2 )
+  {
+    i = (int32_t)BATTERY_OCV_POINTS - 2;
+  }
+
+  *slope = (ocv[i + 1] - ocv[i]) * (float)(BATTERY_OCV_POINTS - 1U);
+
+  return ocv[i] + (x - (float)i) * (ocv[i + 1] - ocv[i]);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   State of charge of one cell at an open circuit voltage. Only used to
+ *   start the filter.
+ *
+ * @param[in] ocv
+ *   Open circuit voltage in V.
+ *
+ * @return
+ *   Returns the state of charge, 0 to 1.
+ ******************************************************************************/
+static float BATTERY_SocFromOcv(float ocv)
+{
+  const float *table = BATTERY_Cell->ocv;
+  uint32_t i;
+
+  if ( ocv <= table[0] )
+  {
+    return 0.0f;
+  }
+
+  for ( i = 1U; i < BATTERY_OCV_POINTS; i++ )
+  {
+    if ( ocv < table[i] )
+    {
+      return ((float)(i - 1U) + (ocv - table[i - 1U]) / (table[i] - table[i - 1U]))
+             / (float)(BATTERY_OCV_POINTS - 1U);
+    }
+  }
+
+  return 1.0f;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Limit a value to a range.
+ ******************************************************************************/
+static float BATTERY_Clamp(float val, float min, float max)
+{
+  if ( val < min )
+  {
+    return min;
+  }
+  if ( val > max )
+  {
+    return max;
+  }
+  return val;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert a fraction to rounded permille.
+ ******************************************************************************/
+static uint32_t BATTERY_Permille(float val)
+{
+  return (val > 0.0f) ? (uint32_t)(val * 1000.0f + 0.5f) : 0U;
+}
@@ -1,17 +1,44 @@
-/** @file battery.h 
+/** @file battery.h
 *   @brief Battery Board Definition File
 *   @date 20-Dec-2022
 *   @author Stefan Damkjar, Junqi Zhu
 *
 */
 
-/** 
+/**
  *  @defgroup BATTERY BATTERY
- *  @brief Portable I2C Driver Wrapper Module for TI HAL libraries.
+ *  @brief Battery state of charge estimation.
+ *
+ *  The state of charge is estimated with an extended Kalman filter over a
+ *  first order equivalent circuit of one cell: the open circuit voltage as
+ *  a function of state of charge, a series resistance R0 and one RC pair
+ *  R1 C1 for the polarization. The prediction step is coulomb counting of
+ *  the battery bus current, the correction step compares the modelled
+ *  terminal voltage with the measured one. Coulomb counting alone drifts
+ *  with the current offset and an unknown start point, the voltage alone is
+ *  wrong under load; the filter weighs the two by their uncertainty.
+ *
+ *  Pack values are divided down to one cell with BATTERY_CELLS_SERIES and
+ *  BATTERY_CELLS_PARALLEL. The cell is described by an entry of the
+ *  chemistry table: capacity, open circuit voltage at BATTERY_OCV_POINTS
+ *  evenly spaced states of charge, the circuit elements at 25 C with linear
+ *  temperature coefficients below 25 C, coulombic efficiency and the filter
+ *  noise.
+ *
+ *  Single precision only, which the Cortex-R4F does in hardware. An update
+ *  is straight line code apart from one table lookup without a search, so
+ *  its cost does not depend on the data.
+ *
+ *  Samples go through a function pointer passed to BATTERY_Init, the
+ *  default reads the battery bus power monitor from the TELEMETRY snapshot,
+ *  so the same code can replay recorded data.
  *
  *	Related Files
  *   - battery.h
  *   - battery.c
+ *   - telemetry.h
+ *   - scheduler.h
+ *   - print.h
  *   - stdint.h
  *   - ina226.h
  */
@@ -19,6 +46,9 @@
 #ifndef DRIVERS_BATTERY_H_
 #define DRIVERS_BATTERY_H_
 
+#include "telemetry.h"
+#include "scheduler.h"
+#include "print.h"
 #include "ina226.h"
 #include "stdint.h"
 
@@ -43,9 +73,37 @@
 
 #define BATTERY_SENSERESISTOR_TEMP      (5)
 #define BATTERY_SENSERESISTOR_CURR1     (5)
-#define BATTERY_SENSERESISTOR_CURR1     (5)
+#define BATTERY_SENSERESISTOR_CURR2     (5)
 
-/** 
+/*****************************************/
+//  Pack and estimator
+/*****************************************/
+
+/**
+ * @todo Confirm pack configuration and current direction for final version
+ */
+#define BATTERY_CELLS_SERIES      (2U)
+#define BATTERY_CELLS_PARALLEL    (2U)
+
+/** +1 if charge current reads positive on the battery bus monitor, else -1 */
+#define BATTERY_CURRENT_SIGN      (1)
+
+/** Temperature used until a battery temperature sensor is read, in mC */
+#define BATTERY_DEFAULT_TEMP      (20000)
+
+/** Update period of the estimator task, in ticks */
+#define BATTERY_PERIOD            (SCHEDULER_MS(1000))
+
+/** Open circuit voltage points of the chemistry table, 0 to 100 % */
+#define BATTERY_OCV_POINTS        (11U)
+
+/** Longest time between samples that is integrated, in ms */
+#define BATTERY_MAX_DT_MS         (10000U)
+
+/** Innovations beyond this many standard deviations are rejected */
+#define BATTERY_GATE_SIGMA        (5.0f)
+
+/**
  *  @addtogroup BATTERY
  *  @{
  */
@@ -54,11 +112,107 @@
  ********************************   ENUMS   ************************************
  ******************************************************************************/
 
+/** @enum BATTERY_Err_TypeDef
+*   @brief Alias names for BATTERY errors.
+*/
+typedef enum
+{
+  BATTERY_Err_NoError = 0U,       /**< No error*/
+  BATTERY_Err_Measure = 1U,       /**< Battery bus could not be read*/
+  BATTERY_Err_Stale   = 2U,       /**< No new sample since the last update*/
+  BATTERY_Err_Invalid = 3U        /**< Chemistry or sample out of range*/
+} BATTERY_Err_TypeDef;
+
+/** @enum BATTERY_Chemistry_TypeDef
+*   @brief Entries of the chemistry table.
+*/
+typedef enum
+{
+  BATTERY_Chemistry_NMC = 0,      /**< NMC 18650, 3.35 Ah*/
+  BATTERY_Chemistry_LFP = 1,      /**< LFP 18650, 1.1 Ah*/
+  BATTERY_NUM_CHEMISTRIES         /**< Number of chemistries (not a chemistry)*/
+} BATTERY_Chemistry_TypeDef;
 
 /*******************************************************************************
  *****************************   PROTOTYPES   **********************************
  ******************************************************************************/
 
+/** @struct BATTERY_Cell_TypeDef
+*   @brief Equivalent circuit and filter parameters of one cell.
+*/
+typedef struct
+{
+  const char *name;                 /**< Short name for the console*/
+  float capacity;                   /**< Capacity at 25 C in Ah*/
+  float ocv[BATTERY_OCV_POINTS];    /**< Open circuit voltage in V at 0, 10 .. 100 %*/
+  float r0;                         /**< Series resistance at 25 C in Ohm*/
+  float r1;                         /**< Polarization resistance at 25 C in Ohm*/
+  float c1;                         /**< Polarization capacitance in F*/
+  float resistanceTc;               /**< Resistance increase per K below 25 C*/
+  float capacityTc;                 /**< Capacity loss per K below 25 C*/
+  float efficiency;                 /**< Coulombic efficiency while charging*/
+  float socNoise;                   /**< State of charge process noise per s*/
+  float v1Noise;                    /**< Polarization process noise in V^2 per s*/
+  float vNoise;                     /**< Terminal voltage model noise in V^2*/
+  float socSigma0;                  /**< Initial state of charge standard deviation*/
+} BATTERY_Cell_TypeDef;
+
+/** @struct BATTERY_Sample_TypeDef
+*   @brief Battery bus sample, pack values.
+*/
+typedef struct
+{
+  uint32_t timestamp;               /**< Sample time in ms*/
+  int32_t voltage;                  /**< Pack voltage in uV*/
+  int32_t current;                  /**< Pack current in uA, positive charging*/
+  int32_t temperature;              /**< Cell temperature in mC*/
+} BATTERY_Sample_TypeDef;
+
+/** @struct BATTERY_State_TypeDef
+*   @brief Estimate and statistics, pack values.
+*/
+typedef struct
+{
+  uint8_t valid;                    /**< Set after the first sample*/
+  BATTERY_Chemistry_TypeDef chemistry; /**< Cell in use*/
+  uint32_t soc;                     /**< State of charge, permille*/
+  uint32_t socSigma;                /**< State of charge standard deviation, permille*/
+  uint32_t socCoulomb;              /**< Coulomb count alone from the same start, permille*/
+  int32_t voltage;                  /**< Last pack voltage in uV*/
+  int32_t current;                  /**< Last pack current in uA*/
+  int32_t temperature;              /**< Last temperature in mC*/
+  int32_t ocv;                      /**< Estimated open circuit voltage in uV*/
+  int32_t polarization;             /**< Estimated RC voltage in uV*/
+  int32_t residual;                 /**< Last innovation in uV*/
+  uint32_t chargeIn;                /**< Charge into the pack in mAh*/
+  uint32_t chargeOut;               /**< Charge out of the pack in mAh*/
+  uint32_t updates;                 /**< Samples processed*/
+  uint32_t rejected;                /**< Voltage corrections gated out*/
+  uint32_t gaps;                    /**< Sample intervals above BATTERY_MAX_DT_MS*/
+  uint32_t errors;                  /**< Failed or stale samples*/
+} BATTERY_State_TypeDef;
+
+/** Read one battery bus sample */
+typedef BATTERY_Err_TypeDef (*BATTERY_Measure_TypeDef)(BATTERY_Sample_TypeDef *sample);
+
+extern const BATTERY_Cell_TypeDef BATTERY_Cells[BATTERY_NUM_CHEMISTRIES];
+
+BATTERY_Err_TypeDef BATTERY_Init(BATTERY_Chemistry_TypeDef chemistry,
+                                 BATTERY_Measure_TypeDef Measure);
+
+void BATTERY_Update(void);
+
+BATTERY_Err_TypeDef BATTERY_Step(const BATTERY_Sample_TypeDef *sample);
+
+void BATTERY_Reset(void);
+
+void BATTERY_SetTemperature(int32_t temperature);
+
+const BATTERY_State_TypeDef *BATTERY_GetState(void);
+
+PRINT_Err_TypeDef BATTERY_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+BATTERY_Err_TypeDef BATTERY_MeasureSensor(BATTERY_Sample_TypeDef *sample);
 
 /**@}*/
 
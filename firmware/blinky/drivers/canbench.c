@@ -0,0 +1,305 @@
+/** @file canbench.c
+*   @brief CAN Loopback Benchmark Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "canbench.h"
+#include "csp.h"
+#include "port_can.h"
+#include "histogram.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/* Counter counts per us */
+#define CANBENCH_COUNTS_US        (SCHEDULER_FRC_HZ / 1000000U)
+
+const uint16_t CANBENCH_Sizes[CANBENCH_NUM_SIZES] =
+{
+  CSP_BEGIN_DATA,                                   /* One frame */
+  CSP_BEGIN_DATA + 3U * PORT_CAN_DLC,               /* Four frames */
+  CSP_BEGIN_DATA + 15U * PORT_CAN_DLC,              /* Sixteen frames */
+  CSP_MTU                                           /* Largest packet */
+};
+
+static CANBENCH_Result_TypeDef CANBENCH_Results[CANBENCH_NUM_SIZES];
+static uint8_t CANBENCH_Payload[CSP_MTU];
+
+static uint32_t CANBENCH_Task;                      /* Scheduler task of the update */
+static uint8_t CANBENCH_Active = 0U;
+static uint32_t CANBENCH_Packets;                   /* Round trips per size */
+static uint32_t CANBENCH_Size;                      /* Index of the size being run */
+static uint8_t CANBENCH_Waiting = 0U;               /* Packet in flight */
+static uint8_t CANBENCH_Sequence;                   /* Of the packet in flight */
+static uint32_t CANBENCH_Sent;                      /* Counter when it was queued */
+static uint32_t CANBENCH_SentTick;
+static uint32_t CANBENCH_SizeStart;                 /* Counter at the first packet of the size */
+static uint32_t CANBENCH_SizeFrames;                /* CSP frames sent before it */
+
+static void CANBENCH_Receive(uint8_t src,
+                             uint8_t sport,
+                             const uint8_t *data,
+                             uint16_t length);
+static void CANBENCH_Fill(uint8_t sequence, uint16_t size);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Bind the port of the benchmark.
+ *
+ * @details
+ *   Call after CSP_Init.
+ *
+ * @param[in] task
+ *   Index in the task table of the task running CANBENCH_Update, with
+ *   period 0.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+CANBENCH_Err_TypeDef CANBENCH_Init(uint32_t task)
+{
+  uint32_t i;
+
+  CANBENCH_Task = task;
+
+  for ( i = 0U; i < CANBENCH_NUM_SIZES; i++ )
+  {
+    CANBENCH_Results[i].size = CANBENCH_Sizes[i];
+    HISTOGRAM_Init(&CANBENCH_Results[i].latency);
+  }
+
+  return (CSP_Bind(CANBENCH_PORT, CANBENCH_Receive) == CSP_Err_NoError)
+         ? CANBENCH_Err_NoError : CANBENCH_Err_Busy;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Enter loopback and start a run, clearing the results of the last.
+ *
+ * @param[in] packets
+ *   Round trips per size, 0 stops a run.
+ ******************************************************************************/
+void CANBENCH_Start(uint32_t packets)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < CANBENCH_NUM_SIZES; i++ )
+  {
+    CANBENCH_Results[i].packets = 0U;
+    CANBENCH_Results[i].failures = 0U;
+    CANBENCH_Results[i].frames = 0U;
+    CANBENCH_Results[i].elapsed = 0U;
+    HISTOGRAM_Init(&CANBENCH_Results[i].latency);
+  }
+
+  CANBENCH_Packets = packets;
+  CANBENCH_Size = 0U;
+  CANBENCH_Waiting = 0U;
+  CANBENCH_Active = (packets != 0U) ? 1U : 0U;
+  CANBENCH_SizeStart = SCHEDULER_GetCounter();
+  CANBENCH_SizeFrames = CSP_GetState()->txFrames;
+
+  PORT_CAN_SetLoopback(CANBENCH_Active);
+
+  if ( CANBENCH_Active )
+  {
+    (void)SCHEDULER_Release(CANBENCH_Task, 0U);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Send the next packet once the last has come back. Run as a scheduler
+ *   task with period 0, released by CANBENCH_Start; it releases itself
+ *   every CANBENCH_PERIOD while the run lasts.
+ ******************************************************************************/
+void CANBENCH_Update(void)
+{
+  CANBENCH_Result_TypeDef *r = &CANBENCH_Results[CANBENCH_Size];
+  uint16_t size;
+
+  if ( !CANBENCH_Active )
+  {
+    return;
+  }
+
+  if ( CANBENCH_Waiting )
+  {
+    if ( SCHEDULER_GetTicks() - CANBENCH_SentTick < SCHEDULER_MS(CANBENCH_TIMEOUT) )
+    {
+      (void)SCHEDULER_Release(CANBENCH_Task, CANBENCH_PERIOD);
+      return;
+    }
+    r->failures++;
+    CANBENCH_Waiting = 0U;
+  }
+
+  if ( r->packets + r->failures >= CANBENCH_Packets )
+  {
+    r->elapsed = (SCHEDULER_GetCounter() - CANBENCH_SizeStart) / CANBENCH_COUNTS_US;
+    r->frames = CSP_GetState()->txFrames - CANBENCH_SizeFrames;
+
+    if ( ++CANBENCH_Size == CANBENCH_NUM_SIZES )
+    {
+      CANBENCH_Size = CANBENCH_NUM_SIZES - 1U;
+      CANBENCH_Active = 0U;
+      PORT_CAN_SetLoopback(0U);
+      return;
+    }
+
+    r = &CANBENCH_Results[CANBENCH_Size];
+    CANBENCH_SizeStart = SCHEDULER_GetCounter();
+    CANBENCH_SizeFrames = CSP_GetState()->txFrames;
+  }
+
+  /* Back for the reply, or to retry a packet CSP had no room for */
+  (void)SCHEDULER_Release(CANBENCH_Task, CANBENCH_PERIOD);
+
+  size = r->size;
+  CANBENCH_Fill((uint8_t)(CANBENCH_Sequence + 1U), size);
+
+  if ( CSP_SendPacket(CSP_Prio_Norm, CSP_GetAddress(), CSP_Port_Ping,
+                      CANBENCH_PORT, CANBENCH_Payload, size) != CSP_Err_NoError )
+  {
+    return;
+  }
+
+  CANBENCH_Sequence++;
+  CANBENCH_Sent = SCHEDULER_GetCounter();
+  CANBENCH_SentTick = SCHEDULER_GetTicks();
+  CANBENCH_Waiting = 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check whether a run is in progress.
+ ******************************************************************************/
+uint8_t CANBENCH_Running(void)
+{
+  return CANBENCH_Active;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the results of a size.
+ *
+ * @param[in] size
+ *   Index in CANBENCH_Sizes.
+ *
+ * @return
+ *   Returns the results, null if there is no such size.
+ ******************************************************************************/
+const CANBENCH_Result_TypeDef *CANBENCH_GetResult(uint32_t size)
+{
+  return (size < CANBENCH_NUM_SIZES) ? &CANBENCH_Results[size] : 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the results of every size: round trips, failures, frame rate,
+ *   payload rate both ways and the round trip in us.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef CANBENCH_Print(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const CANBENCH_Result_TypeDef *r;
+  PRINT_Err_TypeDef ret;
+  uint32_t i;
+
+  ret = PRINT_PrintStringln(uart,CANBENCH_Active ? "BENCH RUNNING" : "BENCH DONE");
+
+  for ( i = 0U; i < CANBENCH_NUM_SIZES && ret == PRINT_Err_NoError; i++ )
+  {
+    r = &CANBENCH_Results[i];
+
+    PRINT_PrintString(uart,"SIZE=");
+    PRINT_FormatUInt(buf,r->size);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," PACKETS=");
+    PRINT_FormatUInt(buf,r->packets);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," FAILURES=");
+    PRINT_FormatUInt(buf,r->failures);
+    PRINT_PrintString(uart,buf);
+
+    if ( r->elapsed != 0U )
+    {
+      PRINT_PrintString(uart," FRAMES/S=");
+      PRINT_FormatUInt(buf,(uint32_t)((uint64_t)r->frames * 1000000U / r->elapsed));
+      PRINT_PrintString(uart,buf);
+      PRINT_PrintString(uart," BYTES/S=");
+      PRINT_FormatUInt(buf,(uint32_t)((uint64_t)r->packets * 2U * r->size * 1000000U / r->elapsed));
+      PRINT_PrintString(uart,buf);
+    }
+
+    PRINT_PrintStringln(uart,"");
+    ret = HISTOGRAM_Print(uart,"  RTT(US)",&r->latency);
+  }
+
+  return ret;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Take a reply of the ping service. Handler of CANBENCH_PORT.
+ ******************************************************************************/
+static void CANBENCH_Receive(uint8_t src,
+                             uint8_t sport,
+                             const uint8_t *data,
+                             uint16_t length)
+{
+  CANBENCH_Result_TypeDef *r = &CANBENCH_Results[CANBENCH_Size];
+  uint32_t i;
+
+  if ( !CANBENCH_Active || !CANBENCH_Waiting
+       || src != CSP_GetAddress() || sport != CSP_Port_Ping )
+  {
+    return;
+  }
+
+  /* A stale reply of a packet given up on has another pattern; a corrupted
+   * one is left to time out */
+  CANBENCH_Fill(CANBENCH_Sequence, r->size);
+  for ( i = 0U; i < length && data[i] == CANBENCH_Payload[i]; i++ )
+  {
+  }
+
+  if ( length != r->size || i != length )
+  {
+    return;
+  }
+
+  CANBENCH_Waiting = 0U;
+  HISTOGRAM_Add(&r->latency, (SCHEDULER_GetCounter() - CANBENCH_Sent) / CANBENCH_COUNTS_US);
+  r->packets++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Fill the payload with a pattern that differs between packets.
+ ******************************************************************************/
+static void CANBENCH_Fill(uint8_t sequence, uint16_t size)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < size; i++ )
+  {
+    CANBENCH_Payload[i] = (uint8_t)(sequence * 31U + i);
+  }
+}
@@ -0,0 +1,122 @@
+/** @file canbench.h
+*   @brief CAN Loopback Benchmark Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup CANBENCH CANBENCH
+ *  @brief Round trips of CSP packets through the controller in loopback.
+ *
+ *  A run puts the controller in silent internal loopback and pings this
+ *  node through CSP: each request is fragmented, looped back, reassembled
+ *  in the CAN interrupt, answered by the ping service and the reply comes
+ *  back the same way to the port of the benchmark. One packet is in
+ *  flight at a time, CANBENCH_Sizes in turn, so the round trip is the
+ *  latency of the whole stack, task periods included, and the frames sent
+ *  over the time of a size its frame rate. The CANPUB frames keep going
+ *  into the message objects and are looped back as well.
+ *
+ *  The time spent reading and reassembling each frame is in the CAN_ISR
+ *  scope of PROFILE. testing/host/can_bench.c runs the same benchmark on a
+ *  virtual bus and guards the results against regressions.
+ *
+ *  Nothing reaches the bus during a run; telemetry frames and replies to
+ *  other nodes are lost.
+ *
+ *  The task of CANBENCH_Update has period 0 in the task table: it is
+ *  released by CANBENCH_Start and releases itself every CANBENCH_PERIOD
+ *  until the run ends, so between runs it costs no wakeups.
+ *
+ *	Related Files
+ *   - canbench.h
+ *   - canbench.c
+ *   - csp.h
+ *   - port_can.h
+ *   - histogram.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_CANBENCH_H_
+#define DRIVERS_CANBENCH_H_
+
+#include "csp.h"
+#include "histogram.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Period of the benchmark task during a run, in ticks */
+#define CANBENCH_PERIOD           (SCHEDULER_MS(10))
+
+/** Port replies come back to */
+#define CANBENCH_PORT             (CSP_Port_User)
+
+/** Payload sizes run, one to a full packet of frames */
+#define CANBENCH_NUM_SIZES        (4U)
+
+/** Round trips per size of WRITE(CAN,BENCH) */
+#define CANBENCH_DEFAULT_PACKETS  (50U)
+
+/** Round trip after which a packet counts as lost, in ms */
+#define CANBENCH_TIMEOUT          (2000U)
+
+/**
+ *  @addtogroup CANBENCH
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum CANBENCH_Err_TypeDef
+*   @brief Alias names for CANBENCH errors.
+*/
+typedef enum
+{
+  CANBENCH_Err_NoError = 0U,      /**< No error*/
+  CANBENCH_Err_Busy    = 1U       /**< Port could not be bound*/
+} CANBENCH_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct CANBENCH_Result_TypeDef
+*   @brief Results of one payload size.
+*/
+typedef struct
+{
+  uint16_t size;                  /**< Payload bytes*/
+  uint32_t packets;               /**< Round trips completed*/
+  uint32_t failures;              /**< Packets lost or corrupted*/
+  uint32_t frames;                /**< Frames sent, requests and replies*/
+  uint32_t elapsed;               /**< Time of the size in us*/
+  HISTOGRAM_TypeDef latency;      /**< Round trip in us*/
+} CANBENCH_Result_TypeDef;
+
+extern const uint16_t CANBENCH_Sizes[CANBENCH_NUM_SIZES];
+
+CANBENCH_Err_TypeDef CANBENCH_Init(uint32_t task);
+
+void CANBENCH_Start(uint32_t packets);
+
+void CANBENCH_Update(void);
+
+uint8_t CANBENCH_Running(void);
+
+const CANBENCH_Result_TypeDef *CANBENCH_GetResult(uint32_t size);
+
+PRINT_Err_TypeDef CANBENCH_Print(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_CANBENCH_H_ */
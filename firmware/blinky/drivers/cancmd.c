@@ -0,0 +1,444 @@
+/** @file cancmd.c
+*   @brief CAN Command Endpoint Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "cancmd.h"
+#include "port_can.h"
+#include "eps.h"
+#include "histogram.h"
+#include "scheduler.h"
+#include "print.h"
+#include "system.h"
+#include "stdint.h"
+
+/* Counter counts per us */
+#define CANCMD_COUNTS_US          (SCHEDULER_FRC_HZ / 1000000U)
+
+/** @enum CANCMD_Phase_TypeDef
+*   @brief Progress of the request being handled.
+*/
+typedef enum
+{
+  CANCMD_Phase_Idle       = 0U,   /* Waiting for a first segment */
+  CANCMD_Phase_Receiving  = 1U,   /* Reassembling, in the CAN interrupt */
+  CANCMD_Phase_Ready      = 2U,   /* Complete, waiting for CANCMD_Execute */
+  CANCMD_Phase_Responding = 3U    /* Response being sent by CANCMD_Update */
+} CANCMD_Phase_TypeDef;
+
+const CANCMD_Params_TypeDef CANCMD_DefaultParams =
+{
+  0x10E50000U,                    /* requestId, above the telemetry */
+  0x10E60000U                     /* responseId */
+};
+
+static CANCMD_Params_TypeDef CANCMD_Params;
+static CANCMD_Dispatch_TypeDef CANCMD_Dispatch;
+static uint32_t CANCMD_Task;                        /* Scheduler task of the update */
+static volatile CANCMD_Phase_TypeDef CANCMD_Phase = CANCMD_Phase_Idle;
+
+static char CANCMD_Request[CANCMD_REQUEST_SIZE];
+static uint32_t CANCMD_RequestLength;
+static uint8_t CANCMD_NextIndex;                    /* Index of the next segment */
+static uint8_t CANCMD_Source;                       /* Sender address */
+static uint32_t CANCMD_LastSegment;                 /* Tick of the last request segment */
+static uint32_t CANCMD_Start;                       /* Counter at the complete request */
+
+static char CANCMD_Response[CANCMD_RESPONSE_SIZE];
+static uint32_t CANCMD_ResponseLength;
+static uint32_t CANCMD_Queued;                      /* Response bytes placed in message objects */
+static uint8_t CANCMD_Segment;                      /* Index of the next response segment */
+static uint8_t CANCMD_Last;                         /* Last response segment queued */
+static PORT_CAN_Pool_TypeDef CANCMD_Pool;
+static uint32_t CANCMD_Progress;                    /* Tick of the last response progress */
+
+static CANCMD_State_TypeDef CANCMD_State;
+
+static void CANCMD_Receive(uint32_t id, const uint8_t *data);
+static void CANCMD_Raise(void);
+static void CANCMD_Reap(uint32_t now);
+static void CANCMD_Send(void);
+static PRINT_Err_TypeDef CANCMD_PrintTimes(PORT_UART_Reg_TypeDef *uart,
+                                           char *name,
+                                           const HISTOGRAM_TypeDef *hist);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Start the controller and accept requests.
+ *
+ * @details
+ *   CANCMD_Update runs in a task with period 0, released by
+ *   CANCMD_Execute.
+ *
+ * @param[in] params
+ *   Parameters, or null for CANCMD_DefaultParams.
+ *
+ * @param[in] Dispatch
+ *   Called from the CAN interrupt when a request is complete, to get
+ *   CANCMD_Execute run at the priority of console commands. Null raises
+ *   system software interrupt CANCMD_SSI.
+ *
+ * @param[in] task
+ *   Index in the task table of the task running CANCMD_Update.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+CANCMD_Err_TypeDef CANCMD_Init(const CANCMD_Params_TypeDef *params,
+                               CANCMD_Dispatch_TypeDef Dispatch,
+                               uint32_t task)
+{
+  if ( params == 0 )
+  {
+    params = &CANCMD_DefaultParams;
+  }
+
+  if ( (params->requestId | CANCMD_ADDRESS_MASK) > PORT_CAN_MAX_ID
+       || (params->responseId | CANCMD_ADDRESS_MASK) > PORT_CAN_MAX_ID )
+  {
+    return CANCMD_Err_Invalid;
+  }
+
+  CANCMD_Params = *params;
+  CANCMD_Dispatch = (Dispatch != 0) ? Dispatch : CANCMD_Raise;
+  CANCMD_Task = task;
+  CANCMD_Phase = CANCMD_Phase_Idle;
+  PORT_CAN_PoolInit(&CANCMD_Pool, CANCMD_FIRST_BOX, CANCMD_NUM_BOXES, 1U);
+  CANCMD_ResetStats();
+
+  PORT_CAN_Init();
+  PORT_CAN_SetFilter(CANCMD_FILTER,
+                     CANCMD_Params.requestId & ~CANCMD_ADDRESS_MASK,
+                     PORT_CAN_MAX_ID & ~CANCMD_ADDRESS_MASK,
+                     CANCMD_Receive);
+
+  return CANCMD_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the complete request and capture its output as the response.
+ *
+ * @details
+ *   Call from the context console commands run in, so the two never
+ *   overlap; does nothing unless a request is waiting. Releases the task
+ *   of CANCMD_Update to send the response.
+ ******************************************************************************/
+void CANCMD_Execute(void)
+{
+  uint32_t start;
+  uint32_t length;
+
+  if ( CANCMD_Phase != CANCMD_Phase_Ready )
+  {
+    return;
+  }
+
+  start = SCHEDULER_GetCounter();
+
+  PRINT_CaptureStart(CANCMD_Response, CANCMD_RESPONSE_SIZE);
+  EPS_runCommandString(PRINT_CAPTURE, CANCMD_Request);
+  length = PRINT_CaptureEnd();
+
+  HISTOGRAM_Add(&CANCMD_State.execution,
+                (SCHEDULER_GetCounter() - start) / CANCMD_COUNTS_US);
+
+  if ( length > CANCMD_RESPONSE_SIZE )
+  {
+    CANCMD_State.truncated++;
+    length = CANCMD_RESPONSE_SIZE;
+  }
+
+  CANCMD_ResponseLength = length;
+  CANCMD_Queued = 0U;
+  CANCMD_Segment = 0U;
+  CANCMD_Last = 0U;
+  CANCMD_Progress = SCHEDULER_GetTicks();
+  CANCMD_Phase = CANCMD_Phase_Responding;
+
+  (void)SCHEDULER_Release(CANCMD_Task, 0U);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Send the next segments of the response, and release the next run
+ *   CANCMD_PERIOD later until it is done.
+ *
+ * @details
+ *   The latency recorded includes up to CANCMD_PERIOD between the last
+ *   acknowledgement and the run that sees it.
+ ******************************************************************************/
+void CANCMD_Update(void)
+{
+  uint32_t now = SCHEDULER_GetTicks();
+
+  CANCMD_Reap(now);
+
+  if ( CANCMD_Phase != CANCMD_Phase_Responding )
+  {
+    return;
+  }
+
+  if ( CANCMD_Pool.inFlight == 0U && CANCMD_Last )
+  {
+    HISTOGRAM_Add(&CANCMD_State.latency,
+                  (SCHEDULER_GetCounter() - CANCMD_Start) / CANCMD_COUNTS_US);
+    CANCMD_State.responses++;
+    CANCMD_Phase = CANCMD_Phase_Idle;
+    return;
+  }
+
+  if ( now - CANCMD_Progress >= SCHEDULER_MS(CANCMD_TIMEOUT) )
+  {
+    PORT_CAN_PoolCancel(&CANCMD_Pool);
+    CANCMD_State.timeouts++;
+    CANCMD_Phase = CANCMD_Phase_Idle;
+    return;
+  }
+
+  CANCMD_Send();
+
+  (void)SCHEDULER_Release(CANCMD_Task, CANCMD_PERIOD);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the counters and the histograms.
+ ******************************************************************************/
+void CANCMD_ResetStats(void)
+{
+  CANCMD_State.requests = 0U;
+  CANCMD_State.responses = 0U;
+  CANCMD_State.rejected = 0U;
+  CANCMD_State.errors = 0U;
+  CANCMD_State.timeouts = 0U;
+  CANCMD_State.truncated = 0U;
+  HISTOGRAM_Init(&CANCMD_State.latency);
+  HISTOGRAM_Init(&CANCMD_State.execution);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the statistics.
+ ******************************************************************************/
+const CANCMD_State_TypeDef *CANCMD_GetState(void)
+{
+  return &CANCMD_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the counters, latency and execution time.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef CANCMD_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const CANCMD_State_TypeDef *s = &CANCMD_State;
+
+  PRINT_PrintString(uart,"REQUESTS=");
+  PRINT_FormatUInt(buf,s->requests);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," RESPONSES=");
+  PRINT_FormatUInt(buf,s->responses);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," REJECTED=");
+  PRINT_FormatUInt(buf,s->rejected);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ERRORS=");
+  PRINT_FormatUInt(buf,s->errors);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TIMEOUTS=");
+  PRINT_FormatUInt(buf,s->timeouts);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TRUNCATED=");
+  PRINT_FormatUInt(buf,s->truncated);
+  PRINT_PrintStringln(uart,buf);
+
+  CANCMD_PrintTimes(uart,"LATENCY",&s->latency);
+  return CANCMD_PrintTimes(uart,"EXEC",&s->execution);
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Add a request segment. Handler of the request filter, called from the
+ *   CAN interrupt.
+ *
+ * @param[in] id
+ *   Identifier, the sender address in the low byte.
+ *
+ * @param[in] data
+ *   PORT_CAN_DLC data bytes.
+ ******************************************************************************/
+static void CANCMD_Receive(uint32_t id, const uint8_t *data)
+{
+  uint8_t source = (uint8_t)(id & CANCMD_ADDRESS_MASK);
+  uint8_t index = data[0] & CANCMD_INDEX_MASK;
+  uint32_t now = SCHEDULER_GetTicks();
+  uint32_t i;
+
+  if ( CANCMD_Phase == CANCMD_Phase_Ready || CANCMD_Phase == CANCMD_Phase_Responding )
+  {
+    CANCMD_State.rejected++;
+    return;
+  }
+
+  /* Give up on a sender that went quiet */
+  if ( CANCMD_Phase == CANCMD_Phase_Receiving
+       && now - CANCMD_LastSegment >= SCHEDULER_MS(CANCMD_TIMEOUT) )
+  {
+    CANCMD_State.timeouts++;
+    CANCMD_Phase = CANCMD_Phase_Idle;
+  }
+
+  if ( CANCMD_Phase == CANCMD_Phase_Receiving && source != CANCMD_Source )
+  {
+    CANCMD_State.rejected++;
+    return;
+  }
+
+  if ( index == 0U )
+  {
+    CANCMD_RequestLength = 0U;
+    CANCMD_NextIndex = 0U;
+    CANCMD_Source = source;
+    CANCMD_Phase = CANCMD_Phase_Receiving;
+  }
+  else if ( CANCMD_Phase != CANCMD_Phase_Receiving || index != CANCMD_NextIndex )
+  {
+    CANCMD_State.errors++;
+    CANCMD_Phase = CANCMD_Phase_Idle;
+    return;
+  }
+
+  for ( i = 1U; i < PORT_CAN_DLC && data[i] != 0U; i++ )
+  {
+    if ( CANCMD_RequestLength >= CANCMD_REQUEST_SIZE - 1U )
+    {
+      CANCMD_State.errors++;
+      CANCMD_Phase = CANCMD_Phase_Idle;
+      return;
+    }
+
+    CANCMD_Request[CANCMD_RequestLength++] = EPS_UPPER((char)data[i]);
+  }
+
+  CANCMD_NextIndex = (uint8_t)((index + 1U) & CANCMD_INDEX_MASK);
+  CANCMD_LastSegment = now;
+
+  if ( (data[0] & CANCMD_FLAG_LAST) != 0U )
+  {
+    CANCMD_Request[CANCMD_RequestLength] = '\0';
+    CANCMD_Start = SCHEDULER_GetCounter();
+    CANCMD_State.requests++;
+    CANCMD_Phase = CANCMD_Phase_Ready;
+    CANCMD_Dispatch();
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Raise the system software interrupt that runs CANCMD_Execute.
+ ******************************************************************************/
+static void CANCMD_Raise(void)
+{
+  systemREG1->SSISR2 = 0x7500U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Free the message objects whose segment was acknowledged.
+ *
+ * @param[in] now
+ *   Scheduler tick.
+ ******************************************************************************/
+static void CANCMD_Reap(uint32_t now)
+{
+  if ( PORT_CAN_PoolReap(&CANCMD_Pool) != 0U )
+  {
+    CANCMD_Progress = now;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Queue the next response segments in the message objects the ordered
+ *   pool has free.
+ ******************************************************************************/
+static void CANCMD_Send(void)
+{
+  uint8_t data[PORT_CAN_DLC];
+  uint32_t id = (CANCMD_Params.responseId & ~CANCMD_ADDRESS_MASK) | CANCMD_Source;
+  uint32_t i;
+
+  while ( !CANCMD_Last )
+  {
+    for ( i = 1U; i < PORT_CAN_DLC; i++ )
+    {
+      data[i] = (CANCMD_Queued + i - 1U < CANCMD_ResponseLength)
+                ? (uint8_t)CANCMD_Response[CANCMD_Queued + i - 1U] : 0U;
+    }
+
+    data[0] = CANCMD_Segment & CANCMD_INDEX_MASK;
+    if ( CANCMD_Queued + CANCMD_SEGMENT_DATA >= CANCMD_ResponseLength )
+    {
+      data[0] |= CANCMD_FLAG_LAST;
+    }
+
+    if ( PORT_CAN_PoolSend(&CANCMD_Pool, id, data) != PORT_CAN_Err_NoError )
+    {
+      return;
+    }
+
+    CANCMD_Queued += CANCMD_SEGMENT_DATA;
+    CANCMD_Segment++;
+    CANCMD_Last = (data[0] & CANCMD_FLAG_LAST) != 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print minimum, median, 99th percentile and maximum of a histogram of
+ *   times in us.
+ ******************************************************************************/
+static PRINT_Err_TypeDef CANCMD_PrintTimes(PORT_UART_Reg_TypeDef *uart,
+                                           char *name,
+                                           const HISTOGRAM_TypeDef *hist)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+
+  PRINT_PrintString(uart,name);
+  if ( hist->count == 0U )
+  {
+    return PRINT_PrintStringln(uart," NONE");
+  }
+
+  PRINT_PrintString(uart," MIN=");
+  PRINT_FormatUInt(buf,hist->min);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," P50=");
+  PRINT_FormatUInt(buf,HISTOGRAM_Percentile(hist,500U));
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," P99=");
+  PRINT_FormatUInt(buf,HISTOGRAM_Percentile(hist,990U));
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," MAX=");
+  PRINT_FormatUInt(buf,hist->max);
+  PRINT_PrintString(uart,buf);
+  return PRINT_PrintStringln(uart," us");
+}
@@ -0,0 +1,169 @@
+/** @file cancmd.h
+*   @brief CAN Command Endpoint Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup CANCMD CANCMD
+ *  @brief Console commands over CAN.
+ *
+ *  A request carries a console command string, e.g. READ(SCHED), and is
+ *  run by the console dispatcher, EPS_runCommandString; everything the
+ *  command prints is captured and sent back as the response. Commands so
+ *  behave the same on both interfaces.
+ *
+ *  Requests are accepted in hardware: one receive filter of PORT_CAN
+ *  matches the request identifier with the low byte, the address of the
+ *  sender, masked out, so no other traffic reaches the CPU. Segments are
+ *  reassembled in the CAN interrupt; the complete request is run in the
+ *  system software interrupt also used by the console, so console and CAN
+ *  commands never run at the same time. One request is handled at a
+ *  time, segments of another arriving meanwhile are dropped.
+ *
+ *  Request and response are split in segments of one frame:
+ *
+ *    byte  field
+ *    0     segment index modulo 128, CANCMD_FLAG_LAST on the last segment
+ *    1-7   CANCMD_SEGMENT_DATA bytes of text, the last segment padded
+ *          with zeros
+ *
+ *  A response goes to the response identifier with the sender address in
+ *  the low byte. Its segments are queued in an ordered PORT_CAN pool of
+ *  the CANCMD_NUM_BOXES lowest transmit message objects, so they leave in
+ *  order, at most CANCMD_NUM_BOXES * CANCMD_SEGMENT_DATA bytes per
+ *  CANCMD_PERIOD.
+ *
+ *  The task has period 0: CANCMD_Execute releases it, and it releases
+ *  itself every CANCMD_PERIOD until the response is acknowledged or
+ *  abandoned, so between requests it costs no wakeups. A response
+ *  abandoned after CANCMD_TIMEOUT has its queued segments withdrawn from
+ *  the message objects, so none go out after a later response started.
+ *
+ *  Latency is measured from the last request segment to the task run that
+ *  finds the last response segment acknowledged, and execution time over
+ *  the dispatcher alone, both in us.
+ *
+ *	Related Files
+ *   - cancmd.h
+ *   - cancmd.c
+ *   - port_can.h
+ *   - eps.h
+ *   - histogram.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_CANCMD_H_
+#define DRIVERS_CANCMD_H_
+
+#include "port_can.h"
+#include "histogram.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Interval of the response task runs while responding, in ticks */
+#define CANCMD_PERIOD             (SCHEDULER_MS(10))
+
+/** Transmit message objects of the responses, the first of all */
+#define CANCMD_FIRST_BOX          (PORT_CAN_FIRST_TX_BOX)
+#define CANCMD_NUM_BOXES          (4U)
+
+/** Receive filter of the requests */
+#define CANCMD_FILTER             (0U)
+
+/** Sender address bits of the identifiers */
+#define CANCMD_ADDRESS_MASK       (0xFFU)
+
+/** Longest request, as long as a console command, with terminator */
+#define CANCMD_REQUEST_SIZE       (PRINT_BUFFER_SIZE + 1U)
+
+/** Longest response, longer output is cut */
+#define CANCMD_RESPONSE_SIZE      (2048U)
+
+#define CANCMD_SEGMENT_DATA       (PORT_CAN_DLC - 1U)
+#define CANCMD_FLAG_LAST          (0x80U)
+#define CANCMD_INDEX_MASK         (0x7FU)
+
+/** Gap between request segments, or time without response progress, after
+ *  which a transfer is abandoned, in ms */
+#define CANCMD_TIMEOUT            (1000U)
+
+/** System software interrupt running the requests, the console uses 1 */
+#define CANCMD_SSI                (2U)
+
+/**
+ *  @addtogroup CANCMD
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum CANCMD_Err_TypeDef
+*   @brief Alias names for CANCMD errors.
+*/
+typedef enum
+{
+  CANCMD_Err_NoError = 0U,        /**< No error*/
+  CANCMD_Err_Invalid = 1U         /**< Identifier out of range*/
+} CANCMD_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct CANCMD_Params_TypeDef
+*   @brief Endpoint parameters.
+*/
+typedef struct
+{
+  uint32_t requestId;             /**< Identifier of requests, low byte ignored*/
+  uint32_t responseId;            /**< Identifier of responses, low byte ignored*/
+} CANCMD_Params_TypeDef;
+
+/** @struct CANCMD_State_TypeDef
+*   @brief Statistics.
+*/
+typedef struct
+{
+  uint32_t requests;              /**< Requests received complete*/
+  uint32_t responses;             /**< Responses acknowledged complete*/
+  uint32_t rejected;              /**< Segments dropped while busy*/
+  uint32_t errors;                /**< Requests dropped for a missing segment or too long*/
+  uint32_t timeouts;              /**< Transfers abandoned*/
+  uint32_t truncated;             /**< Responses cut to CANCMD_RESPONSE_SIZE*/
+  HISTOGRAM_TypeDef latency;      /**< Request to response in us*/
+  HISTOGRAM_TypeDef execution;    /**< Dispatcher run time in us*/
+} CANCMD_State_TypeDef;
+
+/** Run CANCMD_Execute outside the CAN interrupt */
+typedef void (*CANCMD_Dispatch_TypeDef)(void);
+
+extern const CANCMD_Params_TypeDef CANCMD_DefaultParams;
+
+CANCMD_Err_TypeDef CANCMD_Init(const CANCMD_Params_TypeDef *params,
+                               CANCMD_Dispatch_TypeDef Dispatch,
+                               uint32_t task);
+
+void CANCMD_Execute(void);
+
+void CANCMD_Update(void);
+
+void CANCMD_ResetStats(void);
+
+const CANCMD_State_TypeDef *CANCMD_GetState(void);
+
+PRINT_Err_TypeDef CANCMD_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_CANCMD_H_ */
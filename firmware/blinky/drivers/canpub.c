@@ -0,0 +1,609 @@
+/** @file canpub.c
+*   @brief CAN Telemetry Publisher Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "canpub.h"
+#include "port_can.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/* Voltage and current of two channels in mV and mA */
+#define CANPUB_PAIR(id, a, b, period, offset) \
+  { id, period, offset, 4U, { { CANPUB_Source_Voltage, a, 2U, 1000 }, { CANPUB_Source_Current, a, 2U, 1000 }, \
+                              { CANPUB_Source_Voltage, b, 2U, 1000 }, { CANPUB_Source_Current, b, 2U, 1000 } } }
+
+const CANPUB_Frame_TypeDef CANPUB_DefaultFrames[] =
+{
+  /* Sequence, failed channels, failed temperature sensors and ADC drift */
+  { 0x00U, 1000U, 100U, 4U, { { CANPUB_Source_Sequence,   0U, 2U, 1 },
+                              { CANPUB_Source_Errors,     0U, 4U, 1 },
+                              { CANPUB_Source_TempErrors, 0U, 1U, 1 },
+                              { CANPUB_Source_AdcFlags,   0U, 1U, 1 } } },
+  /* RTC time in s and scheduler tick of the sweep */
+  { 0x01U, 1000U, 110U, 2U, { { CANPUB_Source_Time,       0U, 4U, 1 },
+                              { CANPUB_Source_Timestamp,  0U, 4U, 1 } } },
+  /* Temperatures in 0.01 C */
+  { 0x02U, 1000U, 120U, 4U, { { CANPUB_Source_Temp, TELEMETRY_Temp_TEMP1, 2U, 10 },
+                              { CANPUB_Source_Temp, TELEMETRY_Temp_TEMP2, 2U, 10 },
+                              { CANPUB_Source_Temp, TELEMETRY_Temp_TEMP3, 2U, 10 },
+                              { CANPUB_Source_Temp, TELEMETRY_Temp_TEMP4, 2U, 10 } } },
+  /* Panel power in mW */
+  { 0x03U, 1000U, 130U, 4U, { { CANPUB_Source_Power, TELEMETRY_Channel_MPPT1, 2U, 1000 },
+                              { CANPUB_Source_Power, TELEMETRY_Channel_MPPT2, 2U, 1000 },
+                              { CANPUB_Source_Power, TELEMETRY_Channel_MPPT3, 2U, 1000 },
+                              { CANPUB_Source_Power, TELEMETRY_Channel_MPPT4, 2U, 1000 } } },
+  /* Panels and buses every sweep, outputs every other */
+  CANPUB_PAIR(0x10U, TELEMETRY_Channel_MPPT1,    TELEMETRY_Channel_MPPT2,    1000U, 140U),
+  CANPUB_PAIR(0x11U, TELEMETRY_Channel_MPPT3,    TELEMETRY_Channel_MPPT4,    1000U, 140U),
+  CANPUB_PAIR(0x12U, TELEMETRY_Channel_EPS3V3,   TELEMETRY_Channel_EPS1V2,   1000U, 150U),
+  CANPUB_PAIR(0x13U, TELEMETRY_Channel_PV3V3,    TELEMETRY_Channel_3V3BUS,   1000U, 150U),
+  CANPUB_PAIR(0x14U, TELEMETRY_Channel_1V2BUS,   TELEMETRY_Channel_5V0BUS,   1000U, 160U),
+  CANPUB_PAIR(0x15U, TELEMETRY_Channel_BATBUS,   TELEMETRY_Channel_OUTPUT01, 1000U, 160U),
+  CANPUB_PAIR(0x16U, TELEMETRY_Channel_OUTPUT02, TELEMETRY_Channel_OUTPUT03, 2000U, 170U),
+  CANPUB_PAIR(0x17U, TELEMETRY_Channel_OUTPUT04, TELEMETRY_Channel_OUTPUT05, 2000U, 170U),
+  CANPUB_PAIR(0x18U, TELEMETRY_Channel_OUTPUT06, TELEMETRY_Channel_OUTPUT07, 2000U, 180U),
+  CANPUB_PAIR(0x19U, TELEMETRY_Channel_OUTPUT08, TELEMETRY_Channel_OUTPUT09, 2000U, 180U),
+  CANPUB_PAIR(0x1AU, TELEMETRY_Channel_OUTPUT10, TELEMETRY_Channel_OUTPUT11, 2000U, 1170U),
+  CANPUB_PAIR(0x1BU, TELEMETRY_Channel_OUTPUT12, TELEMETRY_Channel_OUTPUT13, 2000U, 1170U),
+  CANPUB_PAIR(0x1CU, TELEMETRY_Channel_OUTPUT14, TELEMETRY_Channel_OUTPUT15, 2000U, 1180U),
+  CANPUB_PAIR(0x1DU, TELEMETRY_Channel_OUTPUT16, TELEMETRY_Channel_OUTPUT17, 2000U, 1180U),
+  { 0x1EU, 2000U, 1190U, 2U, { { CANPUB_Source_Voltage, TELEMETRY_Channel_OUTPUT18, 2U, 1000 },
+                               { CANPUB_Source_Current, TELEMETRY_Channel_OUTPUT18, 2U, 1000 } } }
+};
+
+const uint32_t CANPUB_NumDefaultFrames = sizeof(CANPUB_DefaultFrames) / sizeof(CANPUB_DefaultFrames[0]);
+
+const CANPUB_Params_TypeDef CANPUB_DefaultParams =
+{
+  0x1E500000U,                    /* baseId, low priority */
+  CANPUB_MAX_BOXES                /* numBoxes */
+};
+
+static const CANPUB_Frame_TypeDef *CANPUB_Frames = CANPUB_DefaultFrames;
+static uint32_t CANPUB_NumFrames = 0U;
+static CANPUB_Params_TypeDef CANPUB_Params;
+
+static uint32_t CANPUB_Period[CANPUB_MAX_FRAMES];   /* Ticks, 0 for off */
+static uint32_t CANPUB_Next[CANPUB_MAX_FRAMES];     /* Tick the frame is next due */
+static uint32_t CANPUB_Due;                         /* Bit set for each frame waiting */
+static uint32_t CANPUB_Cursor;                      /* Frame served first on the next run */
+static PORT_CAN_Pool_TypeDef CANPUB_Pool;
+static uint32_t CANPUB_Task;                         /* Scheduler task of the update */
+static uint32_t CANPUB_WindowStart;
+static uint32_t CANPUB_WindowFrames;
+static CANPUB_State_TypeDef CANPUB_State;
+
+static void CANPUB_Reap(void);
+static void CANPUB_Schedule(uint32_t now);
+static void CANPUB_Send(void);
+static void CANPUB_Monitor(uint32_t now);
+static void CANPUB_Rearm(uint32_t now);
+static void CANPUB_Encode(const CANPUB_Frame_TypeDef *frame,
+                          const TELEMETRY_Snapshot_TypeDef *snap,
+                          uint8_t *data);
+static int64_t CANPUB_Value(const CANPUB_Field_TypeDef *field,
+                            const TELEMETRY_Snapshot_TypeDef *snap);
+static CANPUB_Err_TypeDef CANPUB_Check(const CANPUB_Frame_TypeDef *frame,
+                                       uint32_t baseId);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Load a frame table and start the controller.
+ *
+ * @details
+ *   Must be called after TELEMETRY_Init. CANPUB_Update runs in a task
+ *   with period 0 and releases itself; the first run is released here.
+ *
+ * @param[in] frames
+ *   Frame table, or null for CANPUB_DefaultFrames.
+ *
+ * @param[in] numFrames
+ *   Frames in the table, at most CANPUB_MAX_FRAMES.
+ *
+ * @param[in] params
+ *   Parameters, or null for CANPUB_DefaultParams.
+ *
+ * @param[in] task
+ *   Index in the task table of the task running CANPUB_Update.
+ *
+ * @return
+ *   Returns 0 if no error, CANPUB_Err_Invalid if a frame does not fit or
+ *   names a channel that does not exist.
+ ******************************************************************************/
+CANPUB_Err_TypeDef CANPUB_Init(const CANPUB_Frame_TypeDef *frames,
+                               uint32_t numFrames,
+                               const CANPUB_Params_TypeDef *params,
+                               uint32_t task)
+{
+  uint32_t now = SCHEDULER_GetTicks();
+  uint32_t i;
+
+  if ( frames == 0 )
+  {
+    frames = CANPUB_DefaultFrames;
+    numFrames = CANPUB_NumDefaultFrames;
+  }
+
+  if ( params == 0 )
+  {
+    params = &CANPUB_DefaultParams;
+  }
+
+  if ( numFrames > CANPUB_MAX_FRAMES
+       || params->numBoxes == 0U || params->numBoxes > CANPUB_MAX_BOXES )
+  {
+    return CANPUB_Err_Invalid;
+  }
+
+  for ( i = 0U; i < numFrames; i++ )
+  {
+    if ( CANPUB_Check(&frames[i], params->baseId) != CANPUB_Err_NoError )
+    {
+      return CANPUB_Err_Invalid;
+    }
+  }
+
+  CANPUB_Frames = frames;
+  CANPUB_NumFrames = numFrames;
+  CANPUB_Params = *params;
+  CANPUB_Task = task;
+
+  for ( i = 0U; i < numFrames; i++ )
+  {
+    CANPUB_Period[i] = SCHEDULER_MS(frames[i].period);
+    CANPUB_Next[i] = now + SCHEDULER_MS(frames[i].offset);
+  }
+
+  CANPUB_Due = 0U;
+  CANPUB_Cursor = 0U;
+  PORT_CAN_PoolInit(&CANPUB_Pool, CANPUB_FIRST_BOX, params->numBoxes, 0U);
+  CANPUB_ResetStats();
+
+  PORT_CAN_Init();
+  CANPUB_Rearm(now);
+
+  return CANPUB_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Count acknowledged frames, queue due frames, sample the bus state and
+ *   release the next run.
+ ******************************************************************************/
+void CANPUB_Update(void)
+{
+  uint32_t now = SCHEDULER_GetTicks();
+
+  CANPUB_Reap();
+  CANPUB_Schedule(now);
+  CANPUB_Send();
+  CANPUB_Monitor(now);
+  CANPUB_Rearm(now);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Change the period of a frame until the next init.
+ *
+ * @param[in] frame
+ *   Index in the frame table.
+ *
+ * @param[in] period
+ *   Period in ms, 0 to stop the frame.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+CANPUB_Err_TypeDef CANPUB_SetPeriod(uint32_t frame, uint16_t period)
+{
+  if ( frame >= CANPUB_NumFrames )
+  {
+    return CANPUB_Err_Invalid;
+  }
+
+  CANPUB_Period[frame] = SCHEDULER_MS(period);
+  CANPUB_Next[frame] = SCHEDULER_GetTicks() + CANPUB_Period[frame];
+  CANPUB_Due &= ~(1UL << frame);
+  CANPUB_Rearm(SCHEDULER_GetTicks());
+
+  return CANPUB_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the counters and the peaks.
+ ******************************************************************************/
+void CANPUB_ResetStats(void)
+{
+  CANPUB_State.queued = 0U;
+  CANPUB_State.sent = 0U;
+  CANPUB_State.deferred = 0U;
+  CANPUB_State.overruns = 0U;
+  CANPUB_State.load = 0U;
+  CANPUB_State.peakLoad = 0U;
+  CANPUB_State.peakTxErrors = 0U;
+  CANPUB_State.lastError = 0U;
+  CANPUB_State.busOffs = 0U;
+
+  CANPUB_WindowStart = SCHEDULER_GetTicks();
+  CANPUB_WindowFrames = 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the statistics and bus state.
+ ******************************************************************************/
+const CANPUB_State_TypeDef *CANPUB_GetState(void)
+{
+  return &CANPUB_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the statistics, bus state and frame periods.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef CANPUB_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const CANPUB_State_TypeDef *s = &CANPUB_State;
+  uint32_t i;
+
+  PRINT_PrintString(uart,"QUEUED=");
+  PRINT_FormatUInt(buf,s->queued);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," SENT=");
+  PRINT_FormatUInt(buf,s->sent);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," DEFERRED=");
+  PRINT_FormatUInt(buf,s->deferred);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," OVERRUNS=");
+  PRINT_FormatUInt(buf,s->overruns);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," LOAD=");
+  PRINT_FormatFixed(buf,(int32_t)s->load,1U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart,"% PEAK=");
+  PRINT_FormatFixed(buf,(int32_t)s->peakLoad,1U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintStringln(uart,"%");
+
+  PRINT_PrintString(uart,"TEC=");
+  PRINT_FormatUInt(buf,s->txErrors);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," REC=");
+  PRINT_FormatUInt(buf,s->rxErrors);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," PEAKTEC=");
+  PRINT_FormatUInt(buf,s->peakTxErrors);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," LEC=");
+  PRINT_FormatUInt(buf,s->lastError);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," BUSOFFS=");
+  PRINT_FormatUInt(buf,s->busOffs);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintStringln(uart,s->busOff ? " BUS OFF" : (s->passive ? " PASSIVE" : " ACTIVE"));
+
+  for ( i = 0U; i < CANPUB_NumFrames; i++ )
+  {
+    buf[0] = '0';
+    buf[1] = 'x';
+    PRINT_FormatHex(&buf[2],CANPUB_Params.baseId + CANPUB_Frames[i].id,8U);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintChar(uart,'/');
+    PRINT_FormatUInt(buf,CANPUB_Period[i] * SCHEDULER_TICK_US / 1000U);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintChar(uart,' ');
+  }
+
+  return PRINT_PrintStringln(uart,"");
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Free the message objects whose frame was acknowledged.
+ ******************************************************************************/
+static void CANPUB_Reap(void)
+{
+  uint32_t acked = PORT_CAN_PoolReap(&CANPUB_Pool);
+
+  CANPUB_State.sent += acked;
+  CANPUB_WindowFrames += acked;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Mark the frames whose period has elapsed as due.
+ *
+ * @param[in] now
+ *   Scheduler tick.
+ ******************************************************************************/
+static void CANPUB_Schedule(uint32_t now)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < CANPUB_NumFrames; i++ )
+  {
+    if ( CANPUB_Period[i] == 0U || (int32_t)(now - CANPUB_Next[i]) < 0 )
+    {
+      continue;
+    }
+
+    if ( (CANPUB_Due & (1UL << i)) != 0U )
+    {
+      CANPUB_State.overruns++;
+    }
+    CANPUB_Due |= 1UL << i;
+
+    /* Keep the phase, but do not catch up on periods missed altogether */
+    CANPUB_Next[i] += CANPUB_Period[i];
+    if ( (int32_t)(now - CANPUB_Next[i]) >= 0 )
+    {
+      CANPUB_Next[i] = now + CANPUB_Period[i];
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Place due frames in free message objects, in turn from where the last
+ *   run stopped.
+ ******************************************************************************/
+static void CANPUB_Send(void)
+{
+  const TELEMETRY_Snapshot_TypeDef *snap = TELEMETRY_GetSnapshot();
+  uint8_t data[PORT_CAN_DLC];
+  uint32_t n;
+  uint32_t f;
+
+  for ( n = 0U; n < CANPUB_NumFrames && CANPUB_Due != 0U; n++ )
+  {
+    f = (CANPUB_Cursor + n) % CANPUB_NumFrames;
+    if ( (CANPUB_Due & (1UL << f)) == 0U )
+    {
+      continue;
+    }
+
+    CANPUB_Encode(&CANPUB_Frames[f], snap, data);
+
+    if ( PORT_CAN_PoolSend(&CANPUB_Pool,
+                           CANPUB_Params.baseId + CANPUB_Frames[f].id,
+                           data) != PORT_CAN_Err_NoError )
+    {
+      CANPUB_State.deferred++;
+      CANPUB_Cursor = f;
+      return;
+    }
+
+    CANPUB_Due &= ~(1UL << f);
+    CANPUB_State.queued++;
+  }
+
+  CANPUB_Cursor = 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Sample the error counters, recover from bus off and update the bus
+ *   load at the end of each window.
+ *
+ * @param[in] now
+ *   Scheduler tick.
+ ******************************************************************************/
+static void CANPUB_Monitor(uint32_t now)
+{
+  PORT_CAN_Status_TypeDef status;
+  uint32_t elapsed = now - CANPUB_WindowStart;
+  uint64_t load;
+
+  PORT_CAN_GetStatus(&status);
+
+  if ( status.busOff && !CANPUB_State.busOff )
+  {
+    CANPUB_State.busOffs++;
+  }
+
+  CANPUB_State.txErrors = status.txErrors;
+  CANPUB_State.rxErrors = status.rxErrors;
+  CANPUB_State.passive = status.passive;
+  CANPUB_State.busOff = status.busOff;
+
+  if ( status.txErrors > CANPUB_State.peakTxErrors )
+  {
+    CANPUB_State.peakTxErrors = status.txErrors;
+  }
+
+  if ( status.lastError != 0U )
+  {
+    CANPUB_State.lastError = status.lastError;
+  }
+
+  if ( status.busOff )
+  {
+    PORT_CAN_Recover();
+  }
+
+  if ( elapsed < CANPUB_LOAD_WINDOW )
+  {
+    return;
+  }
+
+  /* Bits sent over bits the bus could carry, in 0.1 % */
+  load = (uint64_t)CANPUB_WindowFrames * PORT_CAN_FRAME_BITS * 1000U * 1000000U
+         / ((uint64_t)elapsed * SCHEDULER_TICK_US * PORT_CAN_BITRATE);
+
+  CANPUB_State.load = (uint16_t)((load > 1000U) ? 1000U : load);
+  if ( CANPUB_State.load > CANPUB_State.peakLoad )
+  {
+    CANPUB_State.peakLoad = CANPUB_State.load;
+  }
+
+  CANPUB_WindowStart = now;
+  CANPUB_WindowFrames = 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Release the next run for the earliest frame due, the retry of frames
+ *   waiting for a message object or the end of the load window.
+ *
+ * @param[in] now
+ *   Scheduler tick.
+ ******************************************************************************/
+static void CANPUB_Rearm(uint32_t now)
+{
+  uint32_t delay = CANPUB_WindowStart + CANPUB_LOAD_WINDOW - now;
+  uint32_t i;
+
+  if ( (int32_t)delay < 1 )
+  {
+    delay = 1U;
+  }
+
+  if ( CANPUB_Due != 0U && delay > CANPUB_PERIOD )
+  {
+    delay = CANPUB_PERIOD;
+  }
+
+  for ( i = 0U; i < CANPUB_NumFrames; i++ )
+  {
+    if ( CANPUB_Period[i] != 0U && (int32_t)(CANPUB_Next[i] - now) < (int32_t)delay )
+    {
+      delay = ((int32_t)(CANPUB_Next[i] - now) > 0) ? CANPUB_Next[i] - now : 1U;
+    }
+  }
+
+  (void)SCHEDULER_Release(CANPUB_Task, delay);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Pack the fields of a frame, most significant byte first, and clear the
+ *   bytes that follow.
+ *
+ * @param[in] frame
+ *   Frame.
+ *
+ * @param[in] snap
+ *   Telemetry snapshot.
+ *
+ * @param[out] data
+ *   PORT_CAN_DLC data bytes.
+ ******************************************************************************/
+static void CANPUB_Encode(const CANPUB_Frame_TypeDef *frame,
+                          const TELEMETRY_Snapshot_TypeDef *snap,
+                          uint8_t *data)
+{
+  const CANPUB_Field_TypeDef *field;
+  uint32_t pos = 0U;
+  uint32_t i;
+  uint32_t k;
+  int64_t value;
+  int64_t limit;
+
+  for ( i = 0U; i < frame->numFields; i++ )
+  {
+    field = &frame->field[i];
+    value = CANPUB_Value(field, snap) / field->divisor;
+
+    /* Measurements saturate, counters and bit sets wrap */
+    if ( field->source >= CANPUB_Source_Voltage && field->size < 4U )
+    {
+      limit = (int64_t)1 << (8U * field->size - 1U);
+      value = (value >= limit) ? limit - 1 : ((value < -limit) ? -limit : value);
+    }
+    else if ( field->source >= CANPUB_Source_Voltage )
+    {
+      value = (value > INT32_MAX) ? INT32_MAX : ((value < INT32_MIN) ? INT32_MIN : value);
+    }
+
+    for ( k = field->size; k > 0U; k-- )
+    {
+      data[pos++] = (uint8_t)((uint64_t)value >> (8U * (k - 1U)));
+    }
+  }
+
+  while ( pos < PORT_CAN_DLC )
+  {
+    data[pos++] = 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the value of a field in source units.
+ ******************************************************************************/
+static int64_t CANPUB_Value(const CANPUB_Field_TypeDef *field,
+                            const TELEMETRY_Snapshot_TypeDef *snap)
+{
+  const TELEMETRY_Measurement_TypeDef *meas = &snap->meas[field->index];
+
+  switch ( field->source )
+  {
+    case CANPUB_Source_Sequence:   return snap->sequence;
+    case CANPUB_Source_Timestamp:  return snap->timestamp;
+    case CANPUB_Source_Time:       return (int64_t)(snap->time / 1000000U);
+    case CANPUB_Source_Errors:     return snap->errors;
+    case CANPUB_Source_TempErrors: return snap->tempErrors;
+    case CANPUB_Source_AdcFlags:   return snap->adcFlags;
+    case CANPUB_Source_Voltage:    return meas->voltage;
+    case CANPUB_Source_Current:    return meas->current;
+    case CANPUB_Source_Power:      return (int64_t)meas->voltage * meas->current / 1000000;
+    case CANPUB_Source_Temp:       return snap->temp[field->index];
+    default:                       return 0;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check that a frame fits and names existing channels.
+ ******************************************************************************/
+static CANPUB_Err_TypeDef CANPUB_Check(const CANPUB_Frame_TypeDef *frame,
+                                       uint32_t baseId)
+{
+  const CANPUB_Field_TypeDef *field;
+  uint32_t bytes = 0U;
+  uint32_t i;
+
+  if ( frame->numFields > CANPUB_MAX_FIELDS || baseId + frame->id > PORT_CAN_MAX_ID )
+  {
+    return CANPUB_Err_Invalid;
+  }
+
+  for ( i = 0U; i < frame->numFields; i++ )
+  {
+    field = &frame->field[i];
+    bytes += field->size;
+
+    if ( (field->size != 1U && field->size != 2U && field->size != 4U)
+         || field->divisor <= 0
+         || field->source > CANPUB_Source_Temp
+         || (field->source == CANPUB_Source_Temp && field->index >= TELEMETRY_NUM_TEMPS)
+         || (field->source >= CANPUB_Source_Voltage && field->index >= TELEMETRY_NUM_CHANNELS) )
+    {
+      return CANPUB_Err_Invalid;
+    }
+  }
+
+  return (bytes <= PORT_CAN_DLC) ? CANPUB_Err_NoError : CANPUB_Err_Invalid;
+}
@@ -0,0 +1,193 @@
+/** @file canpub.h
+*   @brief CAN Telemetry Publisher Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup CANPUB CANPUB
+ *  @brief Periodic CAN frames built from the telemetry snapshot.
+ *
+ *  A frame table maps fields of TELEMETRY_Snapshot_TypeDef to CAN frames,
+ *  each with its own period and offset, so the flight computer receives
+ *  the whole telemetry without polling. A frame is built from the latest
+ *  snapshot when it is sent.
+ *
+ *  Due frames are placed in the transmit message objects of an unordered
+ *  PORT_CAN pool, the next free one after the last used, so several frames are queued in the
+ *  controller at a time and the bus is never left idle between task runs.
+ *  A frame that finds every message object busy stays due and is retried
+ *  on the next run; one that comes due again before it was sent counts as
+ *  an overrun.
+ *
+ *  The task has no period: each run releases the next one for when the
+ *  earliest frame comes due, CANPUB_PERIOD later while a frame waits for
+ *  a message object, and at least once every CANPUB_LOAD_WINDOW. With the
+ *  default table that is about ten runs a second, where polling every
+ *  CANPUB_PERIOD took a hundred.
+ *
+ *  Bus load is the bits of the frames acknowledged over CANPUB_LOAD_WINDOW
+ *  at PORT_CAN_FRAME_BITS per frame, an upper bound on what this node puts
+ *  on the bus. The controller error counters are sampled every run and
+ *  bus off is recovered from here.
+ *
+ *  Frame identifier is the base identifier of the parameters plus the
+ *  frame id. Fields are packed in order, most significant byte first, each
+ *  the source value divided by the field divisor. Measurements saturate
+ *  at the range of the field size, counters are truncated.
+ *
+ *	Related Files
+ *   - canpub.h
+ *   - canpub.c
+ *   - port_can.h
+ *   - telemetry.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_CANPUB_H_
+#define DRIVERS_CANPUB_H_
+
+#include "port_can.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Retry interval of frames waiting for a message object in ticks */
+#define CANPUB_PERIOD             (SCHEDULER_MS(10))
+
+/** Frames in a table */
+#define CANPUB_MAX_FRAMES         (32U)
+
+/** Fields in a frame */
+#define CANPUB_MAX_FIELDS         (4U)
+
+/** First transmit message object, after those of CANCMD */
+#define CANPUB_FIRST_BOX          (PORT_CAN_FIRST_TX_BOX + 4U)
+
+/** Transmit message objects available */
+#define CANPUB_MAX_BOXES          (8U)
+
+/** Bus load averaging window in ticks */
+#define CANPUB_LOAD_WINDOW        (SCHEDULER_MS(1000))
+
+/**
+ *  @addtogroup CANPUB
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum CANPUB_Source_TypeDef
+*   @brief Snapshot values a field can carry.
+*/
+typedef enum
+{
+  CANPUB_Source_Sequence   = 0U,  /**< Sweep sequence number*/
+  CANPUB_Source_Timestamp  = 1U,  /**< Scheduler tick of the sweep*/
+  CANPUB_Source_Time       = 2U,  /**< RTC time of the sweep in s since 2000*/
+  CANPUB_Source_Errors     = 3U,  /**< Failed channel bits*/
+  CANPUB_Source_TempErrors = 4U,  /**< Failed temperature sensor bits*/
+  CANPUB_Source_AdcFlags   = 5U,  /**< ADCCAL drift flag bits*/
+  CANPUB_Source_Voltage    = 6U,  /**< Bus voltage of a channel in uV*/
+  CANPUB_Source_Current    = 7U,  /**< Current of a channel in uA*/
+  CANPUB_Source_Power      = 8U,  /**< Product of the two in uW*/
+  CANPUB_Source_Temp       = 9U   /**< Temperature of a sensor in mC*/
+} CANPUB_Source_TypeDef;
+
+/** @enum CANPUB_Err_TypeDef
+*   @brief Alias names for CANPUB errors.
+*/
+typedef enum
+{
+  CANPUB_Err_NoError = 0U,        /**< No error*/
+  CANPUB_Err_Invalid = 1U         /**< Bad frame table, frame or period*/
+} CANPUB_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct CANPUB_Field_TypeDef
+*   @brief One value of a frame.
+*/
+typedef struct
+{
+  CANPUB_Source_TypeDef source;   /**< Snapshot value*/
+  uint8_t index;                  /**< Channel or sensor of measurements*/
+  uint8_t size;                   /**< Bytes, 1, 2 or 4*/
+  int32_t divisor;                /**< Source units per count, positive*/
+} CANPUB_Field_TypeDef;
+
+/** @struct CANPUB_Frame_TypeDef
+*   @brief One periodic frame.
+*/
+typedef struct
+{
+  uint16_t id;                    /**< Added to the base identifier*/
+  uint16_t period;                /**< Period in ms, 0 for off*/
+  uint16_t offset;                /**< Delay of the first frame after init in ms*/
+  uint8_t numFields;              /**< Fields used*/
+  CANPUB_Field_TypeDef field[CANPUB_MAX_FIELDS]; /**< Fields, at most PORT_CAN_DLC bytes in all*/
+} CANPUB_Frame_TypeDef;
+
+/** @struct CANPUB_Params_TypeDef
+*   @brief Publisher parameters.
+*/
+typedef struct
+{
+  uint32_t baseId;                /**< Identifier of frame id 0*/
+  uint8_t numBoxes;               /**< Transmit message objects used, 1 to CANPUB_MAX_BOXES*/
+} CANPUB_Params_TypeDef;
+
+/** @struct CANPUB_State_TypeDef
+*   @brief Statistics and bus state.
+*/
+typedef struct
+{
+  uint32_t queued;                /**< Frames placed in a message object*/
+  uint32_t sent;                  /**< Frames acknowledged*/
+  uint32_t deferred;              /**< Runs that found every message object busy*/
+  uint32_t overruns;              /**< Frames due again before they were sent*/
+  uint16_t load;                  /**< Bus load of the last window in 0.1 %*/
+  uint16_t peakLoad;              /**< Highest load since reset in 0.1 %*/
+  uint8_t txErrors;               /**< Transmit error counter*/
+  uint8_t rxErrors;               /**< Receive error counter*/
+  uint8_t peakTxErrors;           /**< Highest transmit error counter since reset*/
+  uint8_t passive;                /**< Error passive*/
+  uint8_t busOff;                 /**< Bus off*/
+  uint8_t lastError;              /**< Last error code other than none*/
+  uint32_t busOffs;               /**< Bus off events*/
+} CANPUB_State_TypeDef;
+
+extern const CANPUB_Frame_TypeDef CANPUB_DefaultFrames[];
+extern const uint32_t CANPUB_NumDefaultFrames;
+extern const CANPUB_Params_TypeDef CANPUB_DefaultParams;
+
+CANPUB_Err_TypeDef CANPUB_Init(const CANPUB_Frame_TypeDef *frames,
+                               uint32_t numFrames,
+                               const CANPUB_Params_TypeDef *params,
+                               uint32_t task);
+
+void CANPUB_Update(void);
+
+CANPUB_Err_TypeDef CANPUB_SetPeriod(uint32_t frame, uint16_t period);
+
+void CANPUB_ResetStats(void);
+
+const CANPUB_State_TypeDef *CANPUB_GetState(void);
+
+PRINT_Err_TypeDef CANPUB_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_CANPUB_H_ */
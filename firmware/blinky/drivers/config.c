@@ -0,0 +1,747 @@
+/** @file config.c
+*   @brief Persistent Configuration Store Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "config.h"
+#include "port_fee.h"
+#include "print.h"
+#include "profile.h"
+#include "stdint.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Calls of the FEE main function per task run while a job is pending */
+#define CONFIG_MAIN_CALLS         (16U)
+
+/* Record bytes after the header */
+#define CONFIG_PAYLOAD_SIZE       (CONFIG_BLOCK_SIZE - CONFIG_HEADER_SIZE)
+
+/* State of a commit */
+#define CONFIG_COMMIT_IDLE        (0U)
+#define CONFIG_COMMIT_QUEUED      (1U)
+#define CONFIG_COMMIT_WRITING     (2U)
+
+#define CONFIG_MEMBER_SIZE(member) (sizeof(((CONFIG_Data_TypeDef *)0)->member))
+
+/* A scalar field, or every element of an array field */
+#define CONFIG_FIELD(name, member, min, max) \
+  { name, offsetof(CONFIG_Data_TypeDef, member), CONFIG_MEMBER_SIZE(member), 1U, min, max }
+#define CONFIG_ARRAY(name, member, min, max) \
+  { name, offsetof(CONFIG_Data_TypeDef, member), CONFIG_MEMBER_SIZE(member[0]), \
+    CONFIG_MEMBER_SIZE(member) / CONFIG_MEMBER_SIZE(member[0]), min, max }
+
+typedef struct
+{
+  const char *name;
+  uint16_t offset;
+  uint8_t size;
+  uint8_t count;
+  int32_t min;
+  int32_t max;
+} CONFIG_Field_TypeDef;
+
+/* Console names and limits; a negative minimum marks a signed field */
+static const CONFIG_Field_TypeDef CONFIG_Fields[] =
+{
+  CONFIG_ARRAY("RSENSE",        senseResistor,       0,   1000000),
+  CONFIG_FIELD("MPPT_ALGO",     mppt.algorithm,      0,   1),
+  CONFIG_FIELD("MPPT_STEP",     mppt.step,           1,   4095),
+  CONFIG_FIELD("MPPT_DITHER",   mppt.dither,         1,   4095),
+  CONFIG_FIELD("MPPT_POLARITY", mppt.polarity,       -1,  1),
+  CONFIG_FIELD("MPPT_MIN",      mppt.minCode,        0,   4095),
+  CONFIG_FIELD("MPPT_MAX",      mppt.maxCode,        0,   4095),
+  CONFIG_FIELD("MPPT_START",    mppt.startCode,      0,   4095),
+  CONFIG_FIELD("MPPT_SETTLE",   mppt.settleCount,    0,   1000),
+  CONFIG_FIELD("MPPT_DISTURB",  mppt.disturb,        0,   1000),
+  CONFIG_FIELD("MPPT_DEADBAND", mppt.deadband,       0,   1000),
+  CONFIG_FIELD("MPPT_MINPOWER", mppt.minPower,       0,   0x7FFFFFFF),
+  CONFIG_FIELD("GOV_UP",        governor.upLoad,     0,   1000),
+  CONFIG_FIELD("GOV_TARGET",    governor.targetLoad, 0,   1000),
+  CONFIG_FIELD("GOV_HOLD",      governor.downHold,   0,   100000),
+  CONFIG_FIELD("GOV_MIN",       governor.minLevel,   0,   GOVERNOR_NUM_LEVELS - 1),
+  CONFIG_FIELD("GOV_MAX",       governor.maxLevel,   0,   GOVERNOR_NUM_LEVELS - 1),
+  CONFIG_FIELD("BAT_CHEM",      chemistry,           0,   BATTERY_NUM_CHEMISTRIES - 1),
+  CONFIG_ARRAY("RULE_THRESH",   threshold,           -0x7FFFFFFF, 0x7FFFFFFF),
+  CONFIG_ARRAY("RULE_HYST",     hysteresis,          0,   0x7FFFFFFF),
+  CONFIG_ARRAY("PROFILE_DIV",   profileDivider,      1,   255),
+  CONFIG_ARRAY("OUT_PRIO",      outputPriority,      0,   POLICY_NUM_PRIORITIES - 1)
+};
+
+#define CONFIG_NUM_FIELDS         (sizeof(CONFIG_Fields) / sizeof(CONFIG_Fields[0]))
+
+/* Loaded at boot, used by the modules */
+static CONFIG_Data_TypeDef CONFIG_Active;
+
+/* Edited by the console, written by a commit */
+static CONFIG_Data_TypeDef CONFIG_Staged;
+
+/* Policy rule table with the thresholds of the loaded configuration */
+static POLICY_Rule_TypeDef CONFIG_Rules[POLICY_MAX_RULES];
+
+/* One block image per copy, the write source and the read back */
+static uint8_t CONFIG_Image[CONFIG_NUM_COPIES][CONFIG_BLOCK_SIZE];
+
+static CONFIG_State_TypeDef CONFIG_State;
+static uint8_t CONFIG_CommitState = CONFIG_COMMIT_IDLE;
+static uint8_t CONFIG_Target;
+static uint8_t CONFIG_Attempts;
+
+static CONFIG_Err_TypeDef CONFIG_ReadCopy(uint8_t copy, uint16_t *version, uint32_t *sequence);
+static CONFIG_Err_TypeDef CONFIG_Load(const uint8_t *image, uint16_t version);
+static void CONFIG_Migrate(uint16_t version, CONFIG_Data_TypeDef *data);
+static void CONFIG_Check(CONFIG_Data_TypeDef *data);
+static void CONFIG_Build(uint8_t *image, const CONFIG_Data_TypeDef *data, uint32_t sequence);
+static void CONFIG_Fail(void);
+static const CONFIG_Field_TypeDef *CONFIG_Find(const char *name);
+static int32_t CONFIG_GetField(const CONFIG_Data_TypeDef *data, const CONFIG_Field_TypeDef *field, uint32_t index);
+static void CONFIG_SetField(CONFIG_Data_TypeDef *data, const CONFIG_Field_TypeDef *field, uint32_t index, int32_t value);
+static uint32_t CONFIG_Crc32(uint32_t crc, const uint8_t *data, uint32_t length);
+static uint32_t CONFIG_Get16(const uint8_t *buf);
+static uint32_t CONFIG_Get32(const uint8_t *buf);
+static void CONFIG_Put16(uint8_t *buf, uint32_t val);
+static void CONFIG_Put32(uint8_t *buf, uint32_t val);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the FEE driver and load the newest valid record, or the
+ *   defaults if there is none.
+ *
+ * @details
+ *   Call first, before the modules that take their parameters from
+ *   CONFIG_Get. Reads the header and data of both copies, about 1 kB, and
+ *   checks their CRC; the time taken is recorded in the CONFIG_LOAD
+ *   profile scope.
+ *
+ * @return
+ *   Returns 0 if a record was loaded, CONFIG_Err_Empty if the defaults
+ *   are in use.
+ ******************************************************************************/
+CONFIG_Err_TypeDef CONFIG_Init(void)
+{
+  uint16_t version[CONFIG_NUM_COPIES];
+  uint32_t sequence[CONFIG_NUM_COPIES];
+  CONFIG_Err_TypeDef err = CONFIG_Err_Empty;
+  uint8_t order[CONFIG_NUM_COPIES] = { 0U, 1U };
+  uint32_t i;
+
+  PROFILE_BEGIN(PROFILE_Scope_ConfigLoad);
+
+  memset(&CONFIG_State, 0, sizeof(CONFIG_State));
+  CONFIG_CommitState = CONFIG_COMMIT_IDLE;
+  CONFIG_Defaults(&CONFIG_Active);
+
+  if ( sizeof(CONFIG_Data_TypeDef) <= CONFIG_PAYLOAD_SIZE
+    && PORT_FEE_Init() == PORT_FEE_Err_NoError )
+  {
+    CONFIG_State.flash = 1U;
+
+    for ( i = 0U; i < CONFIG_NUM_COPIES; i++ )
+    {
+      if ( CONFIG_ReadCopy((uint8_t)i, &version[i], &sequence[i]) == CONFIG_Err_NoError )
+      {
+        CONFIG_State.valid |= (uint8_t)(1U << i);
+      }
+    }
+
+    /* Newest first; sequences are compared so that they may wrap */
+    if ( CONFIG_State.valid == 0x02U
+      || (CONFIG_State.valid == 0x03U && (int32_t)(sequence[1] - sequence[0]) > 0) )
+    {
+      order[0] = 1U;
+      order[1] = 0U;
+    }
+
+    for ( i = 0U; i < CONFIG_NUM_COPIES && err != CONFIG_Err_NoError; i++ )
+    {
+      if ( (CONFIG_State.valid & (1U << order[i]))
+        && CONFIG_Load(CONFIG_Image[order[i]], version[order[i]]) == CONFIG_Err_NoError )
+      {
+        CONFIG_State.copy = order[i];
+        CONFIG_State.version = version[order[i]];
+        err = CONFIG_Err_NoError;
+      }
+    }
+
+    /* A commit keeps the record loaded, or else the newest, and numbers
+     * after the newest even if that was not usable */
+    if ( CONFIG_State.valid )
+    {
+      CONFIG_State.sequence = sequence[order[0]];
+      if ( err != CONFIG_Err_NoError )
+      {
+        CONFIG_State.copy = order[0];
+      }
+    }
+  }
+
+  CONFIG_Staged = CONFIG_Active;
+
+  memcpy(CONFIG_Rules, POLICY_DefaultRules, POLICY_NumDefaultRules * sizeof(POLICY_Rule_TypeDef));
+  for ( i = 0U; i < POLICY_NumDefaultRules; i++ )
+  {
+    CONFIG_Rules[i].threshold = CONFIG_Active.threshold[i];
+    CONFIG_Rules[i].hysteresis = CONFIG_Active.hysteresis[i];
+  }
+
+  PROFILE_END(PROFILE_Scope_ConfigLoad);
+
+  return err;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the configuration loaded at boot.
+ ******************************************************************************/
+const CONFIG_Data_TypeDef *CONFIG_Get(void)
+{
+  return &CONFIG_Active;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Fill in the build time defaults of every field.
+ *
+ * @param[out] data
+ *   Configuration to fill in, padding included.
+ ******************************************************************************/
+void CONFIG_Defaults(CONFIG_Data_TypeDef *data)
+{
+  uint32_t i;
+
+  memset(data, 0, sizeof(*data));
+
+  data->mppt = MPPT_DefaultParams;
+  data->governor = GOVERNOR_DefaultParams;
+  data->chemistry = (uint32_t)BATTERY_Chemistry_NMC;
+
+  for ( i = 0U; i < POLICY_NumDefaultRules; i++ )
+  {
+    data->threshold[i] = POLICY_DefaultRules[i].threshold;
+    data->hysteresis[i] = POLICY_DefaultRules[i].hysteresis;
+  }
+
+  memcpy(data->profileDivider, POLICY_DefaultProfileDivider, sizeof(data->profileDivider));
+  memcpy(data->outputPriority, POLICY_DefaultOutputPriority, sizeof(data->outputPriority));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Change a field of the staged configuration.
+ *
+ * @param[in] name
+ *   Field name, as listed by CONFIG_PrintStats.
+ *
+ * @param[in] index
+ *   Element of an array field, 0 for a scalar.
+ *
+ * @param[in] value
+ *   New value.
+ *
+ * @return
+ *   Returns 0 if no error, CONFIG_Err_Invalid for an unknown field, an
+ *   index out of range or a value out of limits.
+ ******************************************************************************/
+CONFIG_Err_TypeDef CONFIG_Set(const char *name, uint32_t index, int32_t value)
+{
+  const CONFIG_Field_TypeDef *field = CONFIG_Find(name);
+
+  if ( field == 0 || index >= field->count || value < field->min || value > field->max )
+  {
+    return CONFIG_Err_Invalid;
+  }
+
+  CONFIG_SetField(&CONFIG_Staged, field, index, value);
+
+  return CONFIG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read a field of the staged configuration.
+ *
+ * @param[in] name
+ *   Field name.
+ *
+ * @param[in] index
+ *   Element of an array field, 0 for a scalar.
+ *
+ * @param[out] value
+ *   Value.
+ *
+ * @return
+ *   Returns 0 if no error, CONFIG_Err_Invalid for an unknown field or an
+ *   index out of range.
+ ******************************************************************************/
+CONFIG_Err_TypeDef CONFIG_GetStaged(const char *name, uint32_t index, int32_t *value)
+{
+  const CONFIG_Field_TypeDef *field = CONFIG_Find(name);
+
+  if ( field == 0 || index >= field->count )
+  {
+    return CONFIG_Err_Invalid;
+  }
+
+  *value = CONFIG_GetField(&CONFIG_Staged, field, index);
+
+  return CONFIG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stage the build time defaults. Commit to make them persistent.
+ ******************************************************************************/
+void CONFIG_Reset(void)
+{
+  CONFIG_Defaults(&CONFIG_Staged);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start writing the staged configuration to the copy not holding the
+ *   newest record. CONFIG_Update completes the commit.
+ *
+ * @return
+ *   Returns 0 if the commit was started, CONFIG_Err_Busy if one is in
+ *   progress, CONFIG_Err_Flash if there is no data flash to write to.
+ ******************************************************************************/
+CONFIG_Err_TypeDef CONFIG_Commit(void)
+{
+  if ( !CONFIG_State.flash )
+  {
+    return CONFIG_Err_Flash;
+  }
+
+  if ( CONFIG_State.busy )
+  {
+    return CONFIG_Err_Busy;
+  }
+
+  CONFIG_Target = CONFIG_State.valid ? (uint8_t)(CONFIG_State.copy ^ 1U) : 0U;
+  CONFIG_Build(CONFIG_Image[CONFIG_Target], &CONFIG_Staged, CONFIG_State.sequence + 1U);
+
+  CONFIG_Attempts = 0U;
+  CONFIG_CommitState = CONFIG_COMMIT_QUEUED;
+  CONFIG_State.busy = 1U;
+
+  return CONFIG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Progress a commit: write the record, then read it back. Run as a
+ *   scheduler task every CONFIG_PERIOD.
+ ******************************************************************************/
+void CONFIG_Update(void)
+{
+  const uint8_t *image = CONFIG_Image[CONFIG_Target];
+  uint8_t *check = CONFIG_Image[CONFIG_Target ^ 1U];
+  uint16_t length = (uint16_t)(CONFIG_HEADER_SIZE + sizeof(CONFIG_Data_TypeDef));
+  PORT_FEE_Err_TypeDef err;
+  uint32_t i;
+
+  if ( CONFIG_CommitState == CONFIG_COMMIT_IDLE )
+  {
+    return;
+  }
+
+  for ( i = 0U; i < CONFIG_MAIN_CALLS && PORT_FEE_Busy(); i++ )
+  {
+    PORT_FEE_MainFunction();
+  }
+
+  if ( PORT_FEE_Busy() )
+  {
+    return;
+  }
+
+  if ( CONFIG_CommitState == CONFIG_COMMIT_QUEUED )
+  {
+    err = PORT_FEE_WriteAsync((uint16_t)(CONFIG_FIRST_BLOCK + CONFIG_Target), (uint8_t *)image);
+    if ( err == PORT_FEE_Err_NoError )
+    {
+      CONFIG_CommitState = CONFIG_COMMIT_WRITING;
+    }
+    else if ( err != PORT_FEE_Err_Busy )
+    {
+      CONFIG_Fail();
+    }
+    return;
+  }
+
+  /* The job result may belong to a log write that ran since, so the
+   * record is read back instead */
+  err = PORT_FEE_Read((uint16_t)(CONFIG_FIRST_BLOCK + CONFIG_Target), 0U, check, length);
+  if ( err == PORT_FEE_Err_Busy )
+  {
+    return;
+  }
+  if ( err != PORT_FEE_Err_NoError || memcmp(check, image, length) )
+  {
+    CONFIG_Fail();
+    return;
+  }
+
+  CONFIG_State.copy = CONFIG_Target;
+  CONFIG_State.valid |= (uint8_t)(1U << CONFIG_Target);
+  CONFIG_State.sequence++;
+  CONFIG_State.commits++;
+  CONFIG_State.pending = memcmp(&CONFIG_Staged, &CONFIG_Active, sizeof(CONFIG_Active)) ? 1U : 0U;
+  CONFIG_State.busy = 0U;
+  CONFIG_CommitState = CONFIG_COMMIT_IDLE;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the store position and statistics.
+ ******************************************************************************/
+const CONFIG_State_TypeDef *CONFIG_GetState(void)
+{
+  return &CONFIG_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the store state and the field names.
+ *
+ * @param[in] uart
+ *   UART to print on.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef CONFIG_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static const char * const sources[] = { "DEFAULTS", "FLASH", "MIGRATED" };
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const CONFIG_State_TypeDef *s = &CONFIG_State;
+  uint32_t i;
+
+  PRINT_PrintString(uart,"SOURCE=");
+  PRINT_PrintString(uart,(char*)sources[s->source]);
+  PRINT_PrintString(uart," VERSION=");
+  PRINT_FormatUInt(buf,s->version);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," SEQ=");
+  PRINT_FormatUInt(buf,s->sequence);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," COPY=");
+  PRINT_FormatUInt(buf,s->copy);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," VALID=");
+  PRINT_FormatUInt(buf,s->valid);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," COMMITS=");
+  PRINT_FormatUInt(buf,s->commits);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ERRORS=");
+  PRINT_FormatUInt(buf,s->errors);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart,s->flash ? "" : " NO FLASH");
+  PRINT_PrintString(uart,s->busy ? " BUSY" : "");
+  PRINT_PrintStringln(uart,s->pending ? " RESET PENDING" : "");
+
+  for ( i = 0U; i < CONFIG_NUM_FIELDS; i++ )
+  {
+    PRINT_PrintString(uart,(char*)CONFIG_Fields[i].name);
+    if ( CONFIG_Fields[i].count > 1U )
+    {
+      PRINT_PrintString(uart,"[");
+      PRINT_FormatUInt(buf,CONFIG_Fields[i].count);
+      PRINT_PrintString(uart,buf);
+      PRINT_PrintString(uart,"]");
+    }
+    PRINT_PrintChar(uart,' ');
+  }
+
+  return PRINT_PrintStringln(uart,"");
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the default policy rules with the limits of the loaded
+ *   configuration, POLICY_NumDefaultRules of them.
+ ******************************************************************************/
+const POLICY_Rule_TypeDef *CONFIG_GetRules(void)
+{
+  return CONFIG_Rules;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Read a copy into its image and check header and CRC.
+ ******************************************************************************/
+static CONFIG_Err_TypeDef CONFIG_ReadCopy(uint8_t copy, uint16_t *version, uint32_t *sequence)
+{
+  uint8_t *image = CONFIG_Image[copy];
+  uint32_t length;
+
+  if ( PORT_FEE_Read((uint16_t)(CONFIG_FIRST_BLOCK + copy), 0U, image, CONFIG_HEADER_SIZE) != PORT_FEE_Err_NoError
+    || CONFIG_Get16(&image[0]) != CONFIG_MAGIC )
+  {
+    return CONFIG_Err_Empty;
+  }
+
+  length = CONFIG_Get16(&image[4]);
+  if ( length > CONFIG_PAYLOAD_SIZE
+    || PORT_FEE_Read((uint16_t)(CONFIG_FIRST_BLOCK + copy), CONFIG_HEADER_SIZE,
+                     &image[CONFIG_HEADER_SIZE], (uint16_t)length) != PORT_FEE_Err_NoError )
+  {
+    return CONFIG_Err_Empty;
+  }
+
+  if ( CONFIG_Crc32(CONFIG_Crc32(0xFFFFFFFFU, image, 12U), &image[CONFIG_HEADER_SIZE], length) != CONFIG_Get32(&image[12]) )
+  {
+    return CONFIG_Err_Empty;
+  }
+
+  *version = (uint16_t)CONFIG_Get16(&image[2]);
+  *sequence = CONFIG_Get32(&image[8]);
+
+  return CONFIG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Take the data of a checked record into the loaded configuration,
+ *   converting an older schema.
+ ******************************************************************************/
+static CONFIG_Err_TypeDef CONFIG_Load(const uint8_t *image, uint16_t version)
+{
+  uint32_t length = CONFIG_Get16(&image[4]);
+
+  if ( version > CONFIG_VERSION
+    || (version == CONFIG_VERSION && length != sizeof(CONFIG_Data_TypeDef))
+    || length > sizeof(CONFIG_Data_TypeDef) )
+  {
+    return CONFIG_Err_Invalid;
+  }
+
+  /* Fields added since the record was written keep their defaults */
+  CONFIG_Defaults(&CONFIG_Active);
+  memcpy(&CONFIG_Active, &image[CONFIG_HEADER_SIZE], length);
+
+  if ( version < CONFIG_VERSION )
+  {
+    CONFIG_Migrate(version, &CONFIG_Active);
+    CONFIG_State.source = CONFIG_Source_Migrated;
+  }
+  else
+  {
+    CONFIG_State.source = CONFIG_Source_Flash;
+  }
+
+  CONFIG_Check(&CONFIG_Active);
+
+  return CONFIG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert fields whose meaning changed, one schema version at a time.
+ *
+ * @details
+ *   Add a case for version n when schema n + 1 changes the unit or range
+ *   of an existing field; cases fall through to the current version.
+ ******************************************************************************/
+static void CONFIG_Migrate(uint16_t version, CONFIG_Data_TypeDef *data)
+{
+  (void)data;
+
+  switch ( version )
+  {
+    default:
+      break;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Put every field outside its limits back to its default.
+ ******************************************************************************/
+static void CONFIG_Check(CONFIG_Data_TypeDef *data)
+{
+  const CONFIG_Field_TypeDef *field;
+  int32_t value;
+  uint32_t i, j;
+
+  /* The staged copy is overwritten after the load anyway */
+  CONFIG_Defaults(&CONFIG_Staged);
+
+  for ( i = 0U; i < CONFIG_NUM_FIELDS; i++ )
+  {
+    field = &CONFIG_Fields[i];
+    for ( j = 0U; j < field->count; j++ )
+    {
+      value = CONFIG_GetField(data, field, j);
+      if ( value < field->min || value > field->max )
+      {
+        CONFIG_SetField(data, field, j, CONFIG_GetField(&CONFIG_Staged, field, j));
+      }
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Build a block image of a configuration.
+ ******************************************************************************/
+static void CONFIG_Build(uint8_t *image, const CONFIG_Data_TypeDef *data, uint32_t sequence)
+{
+  memset(image, 0xFF, CONFIG_BLOCK_SIZE);
+
+  CONFIG_Put16(&image[0], CONFIG_MAGIC);
+  CONFIG_Put16(&image[2], CONFIG_VERSION);
+  CONFIG_Put16(&image[4], sizeof(CONFIG_Data_TypeDef));
+  CONFIG_Put16(&image[6], 0U);
+  CONFIG_Put32(&image[8], sequence);
+  memcpy(&image[CONFIG_HEADER_SIZE], data, sizeof(CONFIG_Data_TypeDef));
+
+  CONFIG_Put32(&image[12], CONFIG_Crc32(CONFIG_Crc32(0xFFFFFFFFU, image, 12U),
+                                        &image[CONFIG_HEADER_SIZE], sizeof(CONFIG_Data_TypeDef)));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Count a failed attempt and retry, or give the commit up.
+ ******************************************************************************/
+static void CONFIG_Fail(void)
+{
+  CONFIG_State.errors++;
+
+  if ( ++CONFIG_Attempts < CONFIG_RETRIES )
+  {
+    CONFIG_CommitState = CONFIG_COMMIT_QUEUED;
+    return;
+  }
+
+  CONFIG_State.busy = 0U;
+  CONFIG_CommitState = CONFIG_COMMIT_IDLE;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Look up a field by name.
+ ******************************************************************************/
+static const CONFIG_Field_TypeDef *CONFIG_Find(const char *name)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < CONFIG_NUM_FIELDS; i++ )
+  {
+    if ( !strcmp(name, CONFIG_Fields[i].name) )
+    {
+      return &CONFIG_Fields[i];
+    }
+  }
+
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read an element of a field, sign extended if its minimum is negative.
+ ******************************************************************************/
+static int32_t CONFIG_GetField(const CONFIG_Data_TypeDef *data, const CONFIG_Field_TypeDef *field, uint32_t index)
+{
+  const uint8_t *p = (const uint8_t *)data + field->offset + index * field->size;
+  uint8_t u8;
+  uint16_t u16;
+  uint32_t u32;
+
+  switch ( field->size )
+  {
+    case 1U:
+      memcpy(&u8, p, 1U);
+      return (field->min < 0) ? (int32_t)(int8_t)u8 : (int32_t)u8;
+    case 2U:
+      memcpy(&u16, p, 2U);
+      return (field->min < 0) ? (int32_t)(int16_t)u16 : (int32_t)u16;
+    default:
+      memcpy(&u32, p, 4U);
+      return (int32_t)u32;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write an element of a field.
+ ******************************************************************************/
+static void CONFIG_SetField(CONFIG_Data_TypeDef *data, const CONFIG_Field_TypeDef *field, uint32_t index, int32_t value)
+{
+  uint8_t *p = (uint8_t *)data + field->offset + index * field->size;
+  uint8_t u8 = (uint8_t)value;
+  uint16_t u16 = (uint16_t)value;
+  uint32_t u32 = (uint32_t)value;
+
+  switch ( field->size )
+  {
+    case 1U:
+      memcpy(p, &u8, 1U);
+      break;
+    case 2U:
+      memcpy(p, &u16, 2U);
+      break;
+    default:
+      memcpy(p, &u32, 4U);
+      break;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Update a CRC-32 (IEEE 802.3 polynomial, reflected) with a block of
+ *   data, a nibble at a time. Start with 0xFFFFFFFF.
+ ******************************************************************************/
+static uint32_t CONFIG_Crc32(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  static const uint32_t table[16] =
+  {
+    0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+    0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+    0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+    0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+  };
+  uint32_t i;
+
+  for ( i = 0U; i < length; i++ )
+  {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ table[crc & 0x0FU];
+    crc = (crc >> 4) ^ table[crc & 0x0FU];
+  }
+
+  return crc;
+}
+
+static uint32_t CONFIG_Get16(const uint8_t *buf)
+{
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8);
+}
+
+static uint32_t CONFIG_Get32(const uint8_t *buf)
+{
+  return CONFIG_Get16(buf) | (CONFIG_Get16(&buf[2]) << 16);
+}
+
+static void CONFIG_Put16(uint8_t *buf, uint32_t val)
+{
+  buf[0] = (uint8_t)val;
+  buf[1] = (uint8_t)(val >> 8);
+}
+
+static void CONFIG_Put32(uint8_t *buf, uint32_t val)
+{
+  CONFIG_Put16(buf, val);
+  CONFIG_Put16(&buf[2], val >> 16);
+}
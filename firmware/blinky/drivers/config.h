@@ -0,0 +1,201 @@
+/** @file config.h
+*   @brief Persistent Configuration Store Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup CONFIG CONFIG
+ *  @brief Versioned, CRC protected configuration in data flash.
+ *
+ *  The settings that used to be fixed at build time, sense resistors,
+ *  tracking and clock governor parameters, the battery chemistry, the
+ *  power policy limits and the acquisition profile rates, live in one
+ *  CONFIG_Data_TypeDef. At boot CONFIG_Init loads it from data flash into
+ *  RAM and the modules are initialized from that copy, so nothing on a
+ *  hot path reads flash or checks a CRC.
+ *
+ *  The record is kept in two FEE blocks. Each copy carries a commit
+ *  sequence number and a CRC-32 over header and data. A commit always
+ *  writes the copy not holding the newest record and reads it back, so a
+ *  reset or a failed write in the middle of a commit leaves the previous
+ *  record intact, and the load takes the valid copy with the higher
+ *  sequence.
+ *
+ *  Changes are made to a staged copy with CONFIG_Set, committed with
+ *  CONFIG_Commit and take effect at the next boot; the loaded copy never
+ *  changes while running.
+ *
+ *  Schema: CONFIG_VERSION is raised whenever CONFIG_Data_TypeDef changes.
+ *  Fields are only ever added at the end. A record of an older version is
+ *  loaded over the defaults, so added fields start at their default, and
+ *  a case in CONFIG_Migrate converts fields whose meaning changed. A
+ *  record of a newer version, or of this version but another length, is
+ *  not used.
+ *
+ *  The copies are the last two blocks of the HALCoGen FEE block
+ *  configuration, after the flash log ring (see port_fee.h). Without a
+ *  usable FEE the defaults are loaded, CONFIG_Commit refuses to start and
+ *  CONFIG_PrintStats says NO FLASH, so staged changes are never taken for
+ *  saved.
+ *
+ *	Related Files
+ *   - config.h
+ *   - config.c
+ *   - port_fee.h
+ *   - flashlog.h
+ *   - telemetry.h
+ *   - mppt.h
+ *   - governor.h
+ *   - battery.h
+ *   - policy.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_CONFIG_H_
+#define DRIVERS_CONFIG_H_
+
+#include "port_fee.h"
+#include "flashlog.h"
+#include "telemetry.h"
+#include "mppt.h"
+#include "governor.h"
+#include "battery.h"
+#include "policy.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/*****************************************/
+//  Storage
+/*****************************************/
+
+/** First of the two FEE blocks, after the flash log ring */
+#define CONFIG_FIRST_BLOCK        (FLASHLOG_FIRST_BLOCK + FLASHLOG_NUM_BLOCKS)
+
+/** Number of copies */
+#define CONFIG_NUM_COPIES         (2U)
+
+/** Size of one FEE block in bytes */
+#define CONFIG_BLOCK_SIZE         (PORT_FEE_BLOCK_SIZE)
+
+#if CONFIG_FIRST_BLOCK + CONFIG_NUM_COPIES - 1U > PORT_FEE_NUM_BLOCKS
+#error "CONFIG blocks are not in the HALCoGen FEE block configuration"
+#endif
+
+/** Size of the record header in bytes */
+#define CONFIG_HEADER_SIZE        (16U)
+
+#define CONFIG_MAGIC              (0x4346U)   /* "CF" */
+
+/** Schema version of CONFIG_Data_TypeDef */
+#define CONFIG_VERSION            (2U)
+
+/*****************************************/
+//  Task
+/*****************************************/
+
+/** Period of the commit task in ticks */
+#define CONFIG_PERIOD             (SCHEDULER_MS(100))
+
+/** Commit attempts before giving up */
+#define CONFIG_RETRIES            (3U)
+
+/**
+ *  @addtogroup CONFIG
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum CONFIG_Err_TypeDef
+*   @brief Alias names for CONFIG errors.
+*/
+typedef enum
+{
+  CONFIG_Err_NoError = 0U,        /**< No error*/
+  CONFIG_Err_Busy    = 1U,        /**< Commit in progress*/
+  CONFIG_Err_Flash   = 2U,        /**< Flash access failed*/
+  CONFIG_Err_Invalid = 3U,        /**< Unknown field, index out of range or value out of limits*/
+  CONFIG_Err_Empty   = 4U         /**< No valid record, defaults in use*/
+} CONFIG_Err_TypeDef;
+
+/** @enum CONFIG_Source_TypeDef
+*   @brief Where the loaded configuration came from.
+*/
+typedef enum
+{
+  CONFIG_Source_Defaults = 0U,    /**< No valid record*/
+  CONFIG_Source_Flash    = 1U,    /**< Record of this version*/
+  CONFIG_Source_Migrated = 2U     /**< Record of an older version, converted*/
+} CONFIG_Source_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct CONFIG_Data_TypeDef
+*   @brief Configuration, schema CONFIG_VERSION. Only add fields at the end.
+*/
+typedef struct
+{
+  uint32_t senseResistor[TELEMETRY_NUM_CHANNELS]; /**< Sense resistor of each power monitor in mOhm, 0 for the eps.h value*/
+  MPPT_Params_TypeDef mppt;                 /**< Tracking parameters*/
+  GOVERNOR_Params_TypeDef governor;         /**< Clock governor parameters*/
+  uint32_t chemistry;                       /**< BATTERY_Chemistry_TypeDef of the pack*/
+  int32_t threshold[POLICY_MAX_RULES];      /**< Threshold of each default policy rule*/
+  int32_t hysteresis[POLICY_MAX_RULES];     /**< Hysteresis of each default policy rule*/
+  uint8_t profileDivider[POLICY_NUM_PROFILES]; /**< Sweep divider of each acquisition profile*/
+  uint8_t outputPriority[POLICY_NUM_OUTPUTS]; /**< Shed priority of each output, since version 2*/
+} CONFIG_Data_TypeDef;
+
+/** @struct CONFIG_State_TypeDef
+*   @brief Store position and statistics.
+*/
+typedef struct
+{
+  CONFIG_Source_TypeDef source;   /**< Origin of the loaded configuration*/
+  uint16_t version;               /**< Schema version of the record loaded*/
+  uint8_t copy;                   /**< Copy holding the newest record*/
+  uint8_t valid;                  /**< Bit set for each valid copy at boot*/
+  uint32_t sequence;              /**< Commit sequence of the newest record*/
+  uint8_t busy;                   /**< Commit in progress*/
+  uint8_t pending;                /**< Committed changes wait for a reset*/
+  uint8_t flash;                  /**< Data flash usable, commits are possible*/
+  uint32_t commits;               /**< Records committed since boot*/
+  uint32_t errors;                /**< Failed or unverified writes*/
+} CONFIG_State_TypeDef;
+
+CONFIG_Err_TypeDef CONFIG_Init(void);
+
+const CONFIG_Data_TypeDef *CONFIG_Get(void);
+
+void CONFIG_Defaults(CONFIG_Data_TypeDef *data);
+
+CONFIG_Err_TypeDef CONFIG_Set(const char *name, uint32_t index, int32_t value);
+
+CONFIG_Err_TypeDef CONFIG_GetStaged(const char *name, uint32_t index, int32_t *value);
+
+void CONFIG_Reset(void);
+
+CONFIG_Err_TypeDef CONFIG_Commit(void);
+
+void CONFIG_Update(void);
+
+const CONFIG_State_TypeDef *CONFIG_GetState(void);
+
+PRINT_Err_TypeDef CONFIG_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+const POLICY_Rule_TypeDef *CONFIG_GetRules(void);
+
+/**@}*/
+
+#endif /* DRIVERS_CONFIG_H_ */
@@ -0,0 +1,990 @@
+/** @file csp.c
+*   @brief CSP Style Transport over CAN Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "csp.h"
+#include "port_can.h"
+#include "eps.h"
+#include "telemetry.h"
+#include "flashlog.h"
+#include "governor.h"
+#include "scheduler.h"
+#include "print.h"
+#include "system.h"
+#include "stdint.h"
+
+/* Longest command, as long as a console command */
+#define CSP_COMMAND_SIZE          (PRINT_BUFFER_SIZE)
+
+/** @enum CSP_Slot_TypeDef
+*   @brief States of a packet buffer.
+*/
+typedef enum
+{
+  CSP_Slot_Free      = 0U,        /* Unused */
+  CSP_Slot_Receiving = 1U,        /* Reassembling, in the CAN interrupt */
+  CSP_Slot_Complete  = 2U,        /* Received, waiting for its service */
+  CSP_Slot_Command   = 3U,        /* Waiting for CSP_Execute */
+  CSP_Slot_Ready     = 4U,        /* Reply waiting to be sent */
+  CSP_Slot_Sending   = 5U         /* Reply in the message objects */
+} CSP_Slot_TypeDef;
+
+/** @struct CSP_Packet_TypeDef
+*   @brief Packet buffer.
+*/
+typedef struct
+{
+  volatile CSP_Slot_TypeDef state;
+  uint8_t prio;                   /* CSP_Prio_TypeDef */
+  uint8_t peer;                   /* Source, or destination of a reply */
+  uint8_t ident;                  /* Packet identifier */
+  uint8_t dport;                  /* Destination port */
+  uint8_t sport;                  /* Source port */
+  uint8_t remain;                 /* Frame counter expected next */
+  uint16_t length;                /* Payload bytes */
+  uint16_t pos;                   /* Payload bytes received */
+  uint32_t last;                  /* Tick of the last frame received */
+  uint8_t data[CSP_MTU];
+} CSP_Packet_TypeDef;
+
+const CSP_Params_TypeDef CSP_DefaultParams =
+{
+  2U,                             /* address */
+  CSP_MAX_BOXES                   /* numBoxes */
+};
+
+static CSP_Params_TypeDef CSP_Params;
+static CSP_Dispatch_TypeDef CSP_Dispatch;
+static uint32_t CSP_Task;                           /* Scheduler task of the update */
+
+static CSP_Packet_TypeDef CSP_Rx[CSP_NUM_RX_BUFFERS];
+static CSP_Packet_TypeDef CSP_Tx[CSP_NUM_TX_BUFFERS];
+static CSP_Packet_TypeDef * volatile CSP_Command = 0;  /* Request for CSP_Execute */
+static char CSP_CommandString[CSP_COMMAND_SIZE + 1U];
+
+static CSP_Packet_TypeDef *CSP_Current = 0;         /* Reply being sent */
+static uint32_t CSP_Frame;                          /* Next frame of the reply */
+static uint8_t CSP_Ident;                           /* Identifier of the next reply */
+static PORT_CAN_Pool_TypeDef CSP_Pool;
+static uint32_t CSP_Progress;                       /* Tick of the last frame acknowledged */
+
+static uint8_t CSP_Block[FLASHLOG_BLOCK_SIZE];
+
+static uint8_t CSP_BoundPort[CSP_MAX_BINDINGS];
+static CSP_Handler_TypeDef CSP_BoundHandler[CSP_MAX_BINDINGS];
+
+static CSP_State_TypeDef CSP_State;
+
+static void CSP_Receive(uint32_t id, const uint8_t *data);
+static CSP_Packet_TypeDef *CSP_FindRx(uint8_t src, uint8_t ident);
+static CSP_Packet_TypeDef *CSP_AllocRx(uint32_t now);
+static void CSP_Raise(void);
+static void CSP_Reap(uint32_t now);
+static void CSP_Serve(void);
+static uint8_t CSP_Waiting(void);
+static void CSP_Route(CSP_Packet_TypeDef *rx);
+static void CSP_Telemetry(CSP_Packet_TypeDef *tx);
+static void CSP_Log(const CSP_Packet_TypeDef *rx, CSP_Packet_TypeDef *tx);
+static void CSP_Reply(const CSP_Packet_TypeDef *rx, CSP_Packet_TypeDef *tx);
+static CSP_Packet_TypeDef *CSP_AllocTx(void);
+static void CSP_Send(uint32_t now);
+static void CSP_Done(CSP_Packet_TypeDef *tx);
+static uint32_t CSP_Put(uint8_t *data, uint32_t pos, uint32_t value, uint32_t size);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Start the controller and accept packets addressed to this node.
+ *
+ * @details
+ *   CSP_Update runs in a task with period 0, released by the module.
+ *
+ * @param[in] params
+ *   Parameters, or null for CSP_DefaultParams.
+ *
+ * @param[in] Dispatch
+ *   Called from CSP_Update when a command is waiting, to get CSP_Execute
+ *   run at the priority of console commands. Null raises system software
+ *   interrupt CSP_SSI.
+ *
+ * @param[in] task
+ *   Index in the task table of the task running CSP_Update.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+CSP_Err_TypeDef CSP_Init(const CSP_Params_TypeDef *params,
+                         CSP_Dispatch_TypeDef Dispatch,
+                         uint32_t task)
+{
+  uint32_t i;
+
+  if ( params == 0 )
+  {
+    params = &CSP_DefaultParams;
+  }
+
+  if ( params->address >= CSP_ID_ADDRESS_MASK
+       || params->numBoxes == 0U || params->numBoxes > CSP_MAX_BOXES )
+  {
+    return CSP_Err_Invalid;
+  }
+
+  CSP_Params = *params;
+  CSP_Dispatch = (Dispatch != 0) ? Dispatch : CSP_Raise;
+  CSP_Task = task;
+
+  for ( i = 0U; i < CSP_NUM_RX_BUFFERS; i++ )
+  {
+    CSP_Rx[i].state = CSP_Slot_Free;
+  }
+  for ( i = 0U; i < CSP_NUM_TX_BUFFERS; i++ )
+  {
+    CSP_Tx[i].state = CSP_Slot_Free;
+  }
+  for ( i = 0U; i < CSP_MAX_BINDINGS; i++ )
+  {
+    CSP_BoundHandler[i] = 0;
+  }
+  CSP_Command = 0;
+  CSP_Current = 0;
+  PORT_CAN_PoolInit(&CSP_Pool, CSP_FIRST_BOX, CSP_Params.numBoxes, 1U);
+  CSP_ResetStats();
+
+  PORT_CAN_Init();
+  PORT_CAN_SetFilter(CSP_FILTER,
+                     (uint32_t)CSP_Params.address << CSP_ID_DST_SHIFT,
+                     (uint32_t)CSP_ID_ADDRESS_MASK << CSP_ID_DST_SHIFT,
+                     CSP_Receive);
+
+  return CSP_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Serve complete packets and send the replies, and release the next run
+ *   CSP_PERIOD later while either is left.
+ ******************************************************************************/
+void CSP_Update(void)
+{
+  uint32_t now = SCHEDULER_GetTicks();
+
+  CSP_Reap(now);
+  CSP_Serve();
+  CSP_Send(now);
+
+  if ( CSP_Current != 0 || CSP_Waiting() )
+  {
+    (void)SCHEDULER_Release(CSP_Task, CSP_PERIOD);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the waiting command and queue its output as the reply.
+ *
+ * @details
+ *   Call from the context console commands run in, so the two never
+ *   overlap; does nothing unless a command is waiting.
+ ******************************************************************************/
+void CSP_Execute(void)
+{
+  CSP_Packet_TypeDef *rx = CSP_Command;
+  CSP_Packet_TypeDef *tx = &CSP_Tx[0];
+  uint32_t length;
+  uint32_t i;
+
+  if ( rx == 0 )
+  {
+    return;
+  }
+
+  /* Up to the first null */
+  for ( i = 0U; i < rx->length && i < CSP_COMMAND_SIZE && rx->data[i] != 0U; i++ )
+  {
+    CSP_CommandString[i] = EPS_UPPER((char)rx->data[i]);
+  }
+  CSP_CommandString[i] = '\0';
+
+  PRINT_CaptureStart((char *)tx->data, CSP_MTU);
+  if ( i == CSP_COMMAND_SIZE && i < rx->length && rx->data[i] != 0U )
+  {
+    PRINT_PrintStringln(PRINT_CAPTURE,"ERROR: Command too long");
+  }
+  else
+  {
+    EPS_runCommandString(PRINT_CAPTURE, CSP_CommandString);
+  }
+  length = PRINT_CaptureEnd();
+
+  if ( length > CSP_MTU )
+  {
+    CSP_State.truncated++;
+    length = CSP_MTU;
+  }
+
+  tx->length = (uint16_t)length;
+  CSP_Reply(rx, tx);
+
+  rx->state = CSP_Slot_Free;
+  CSP_Command = 0;
+
+  (void)SCHEDULER_Release(CSP_Task, 0U);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the counters.
+ ******************************************************************************/
+void CSP_ResetStats(void)
+{
+  CSP_State.rxFrames = 0U;
+  CSP_State.rxPackets = 0U;
+  CSP_State.txFrames = 0U;
+  CSP_State.txPackets = 0U;
+  CSP_State.noBuffer = 0U;
+  CSP_State.errors = 0U;
+  CSP_State.timeouts = 0U;
+  CSP_State.unrouted = 0U;
+  CSP_State.truncated = 0U;
+  CSP_State.peakBuffers = 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the address of this node.
+ ******************************************************************************/
+uint8_t CSP_GetAddress(void)
+{
+  return CSP_Params.address;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the statistics.
+ ******************************************************************************/
+const CSP_State_TypeDef *CSP_GetState(void)
+{
+  return &CSP_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the statistics.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef CSP_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const CSP_State_TypeDef *s = &CSP_State;
+
+  PRINT_PrintString(uart,"CSP RXFRAMES=");
+  PRINT_FormatUInt(buf,s->rxFrames);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," RXPACKETS=");
+  PRINT_FormatUInt(buf,s->rxPackets);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TXFRAMES=");
+  PRINT_FormatUInt(buf,s->txFrames);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TXPACKETS=");
+  PRINT_FormatUInt(buf,s->txPackets);
+  PRINT_PrintStringln(uart,buf);
+
+  PRINT_PrintString(uart,"NOBUFFER=");
+  PRINT_FormatUInt(buf,s->noBuffer);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ERRORS=");
+  PRINT_FormatUInt(buf,s->errors);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TIMEOUTS=");
+  PRINT_FormatUInt(buf,s->timeouts);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," UNROUTED=");
+  PRINT_FormatUInt(buf,s->unrouted);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TRUNCATED=");
+  PRINT_FormatUInt(buf,s->truncated);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," PEAKBUFFERS=");
+  PRINT_FormatUInt(buf,s->peakBuffers);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintChar(uart,'/');
+  PRINT_FormatUInt(buf,CSP_NUM_RX_BUFFERS);
+  return PRINT_PrintStringln(uart,buf);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Serve a port with a handler of another module.
+ *
+ * @param[in] port
+ *   Port, from CSP_Port_User on.
+ *
+ * @param[in] handler
+ *   Service, or null to unbind the port.
+ *
+ * @return
+ *   Returns 0 if no error, CSP_Err_Busy if every binding is in use.
+ ******************************************************************************/
+CSP_Err_TypeDef CSP_Bind(uint8_t port, CSP_Handler_TypeDef handler)
+{
+  uint32_t i;
+  uint32_t free = CSP_MAX_BINDINGS;
+
+  if ( port < CSP_Port_User )
+  {
+    return CSP_Err_Invalid;
+  }
+
+  for ( i = 0U; i < CSP_MAX_BINDINGS; i++ )
+  {
+    if ( CSP_BoundHandler[i] != 0 && CSP_BoundPort[i] == port )
+    {
+      CSP_BoundHandler[i] = handler;
+      return CSP_Err_NoError;
+    }
+    if ( CSP_BoundHandler[i] == 0 && free == CSP_MAX_BINDINGS )
+    {
+      free = i;
+    }
+  }
+
+  if ( handler == 0 )
+  {
+    return CSP_Err_NoError;
+  }
+  if ( free == CSP_MAX_BINDINGS )
+  {
+    return CSP_Err_Busy;
+  }
+
+  CSP_BoundPort[free] = port;
+  CSP_BoundHandler[free] = handler;
+
+  return CSP_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Queue a packet.
+ *
+ * @details
+ *   Call from task context only. The packet is copied and sent once no
+ *   more urgent packet is waiting.
+ *
+ * @param[in] prio
+ *   Priority.
+ *
+ * @param[in] dst
+ *   Destination address, this node's own in loopback.
+ *
+ * @param[in] dport
+ *   Destination port.
+ *
+ * @param[in] sport
+ *   Source port, where the reply is expected.
+ *
+ * @param[in] data
+ *   Payload.
+ *
+ * @param[in] length
+ *   Payload bytes, at most CSP_MTU.
+ *
+ * @return
+ *   Returns 0 if queued, CSP_Err_Busy if no buffer is free.
+ ******************************************************************************/
+CSP_Err_TypeDef CSP_SendPacket(CSP_Prio_TypeDef prio,
+                               uint8_t dst,
+                               uint8_t dport,
+                               uint8_t sport,
+                               const uint8_t *data,
+                               uint16_t length)
+{
+  CSP_Packet_TypeDef *tx;
+  uint32_t i;
+
+  if ( prio > CSP_Prio_Low || dst > CSP_ID_ADDRESS_MASK || length > CSP_MTU )
+  {
+    return CSP_Err_Invalid;
+  }
+
+  tx = CSP_AllocTx();
+  if ( tx == 0 )
+  {
+    return CSP_Err_Busy;
+  }
+
+  for ( i = 0U; i < length; i++ )
+  {
+    tx->data[i] = data[i];
+  }
+
+  tx->length = length;
+  tx->prio = (uint8_t)prio;
+  tx->peer = dst;
+  tx->dport = dport;
+  tx->sport = sport;
+  tx->state = CSP_Slot_Ready;
+
+  (void)SCHEDULER_Release(CSP_Task, 0U);
+
+  return CSP_Err_NoError;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Add a frame to its packet. Handler of the receive filter, called from
+ *   the CAN interrupt.
+ *
+ * @details
+ *   A frame of a packet that was dropped or never begun is ignored.
+ *
+ * @param[in] id
+ *   Identifier.
+ *
+ * @param[in] data
+ *   PORT_CAN_DLC data bytes.
+ ******************************************************************************/
+static void CSP_Receive(uint32_t id, const uint8_t *data)
+{
+  uint8_t src = (uint8_t)((id >> CSP_ID_SRC_SHIFT) & CSP_ID_ADDRESS_MASK);
+  uint8_t ident = (uint8_t)(id & CSP_ID_IDENT_MASK);
+  uint8_t remain = (uint8_t)((id >> CSP_ID_REMAIN_SHIFT) & CSP_ID_REMAIN_MASK);
+  uint32_t now = SCHEDULER_GetTicks();
+  CSP_Packet_TypeDef *p = CSP_FindRx(src, ident);
+  uint32_t n;
+  uint32_t i;
+
+  CSP_State.rxFrames++;
+
+  if ( (id & CSP_ID_BEGIN) != 0U )
+  {
+    /* A repeated first frame restarts the packet */
+    if ( p == 0 )
+    {
+      p = CSP_AllocRx(now);
+    }
+    if ( p == 0 )
+    {
+      CSP_State.noBuffer++;
+      return;
+    }
+
+    p->prio = (uint8_t)((id >> CSP_ID_PRIO_SHIFT) & CSP_ID_PRIO_MASK);
+    p->peer = src;
+    p->ident = ident;
+    p->dport = data[0];
+    p->sport = data[1];
+    p->length = (uint16_t)(((uint16_t)data[2] << 8U) | data[3]);
+    p->pos = 0U;
+
+    if ( p->length > CSP_MTU || CSP_FRAMES(p->length) != remain + 1U )
+    {
+      CSP_State.errors++;
+      p->state = CSP_Slot_Free;
+      return;
+    }
+
+    data += CSP_BEGIN_HEADER;
+    n = CSP_BEGIN_DATA;
+  }
+  else
+  {
+    if ( p == 0 )
+    {
+      return;
+    }
+
+    if ( remain != p->remain )
+    {
+      CSP_State.errors++;
+      p->state = CSP_Slot_Free;
+      return;
+    }
+
+    n = PORT_CAN_DLC;
+  }
+
+  for ( i = 0U; i < n && p->pos < p->length; i++ )
+  {
+    p->data[p->pos++] = data[i];
+  }
+
+  p->last = now;
+
+  if ( remain != 0U )
+  {
+    p->remain = remain - 1U;
+    p->state = CSP_Slot_Receiving;
+    return;
+  }
+
+  CSP_State.rxPackets++;
+  p->state = CSP_Slot_Complete;
+  (void)SCHEDULER_Release(CSP_Task, 0U);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Find the buffer reassembling a packet.
+ ******************************************************************************/
+static CSP_Packet_TypeDef *CSP_FindRx(uint8_t src, uint8_t ident)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < CSP_NUM_RX_BUFFERS; i++ )
+  {
+    if ( CSP_Rx[i].state == CSP_Slot_Receiving
+         && CSP_Rx[i].peer == src && CSP_Rx[i].ident == ident )
+    {
+      return &CSP_Rx[i];
+    }
+  }
+
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Take a free buffer, or one whose packet has waited CSP_TIMEOUT for its
+ *   next frame.
+ *
+ * @param[in] now
+ *   Scheduler tick.
+ *
+ * @return
+ *   Returns the buffer, null if none.
+ ******************************************************************************/
+static CSP_Packet_TypeDef *CSP_AllocRx(uint32_t now)
+{
+  CSP_Packet_TypeDef *p = 0;
+  uint8_t used = 1U;
+  uint32_t i;
+
+  for ( i = 0U; i < CSP_NUM_RX_BUFFERS; i++ )
+  {
+    if ( CSP_Rx[i].state == CSP_Slot_Free && p == 0 )
+    {
+      p = &CSP_Rx[i];
+    }
+    else if ( CSP_Rx[i].state != CSP_Slot_Free )
+    {
+      used++;
+    }
+  }
+
+  if ( p == 0 )
+  {
+    for ( i = 0U; i < CSP_NUM_RX_BUFFERS; i++ )
+    {
+      if ( CSP_Rx[i].state == CSP_Slot_Receiving
+           && now - CSP_Rx[i].last >= SCHEDULER_MS(CSP_TIMEOUT) )
+      {
+        CSP_State.timeouts++;
+        return &CSP_Rx[i];
+      }
+    }
+    return 0;
+  }
+
+  if ( used > CSP_State.peakBuffers )
+  {
+    CSP_State.peakBuffers = used;
+  }
+
+  return p;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Raise the system software interrupt that runs CSP_Execute.
+ ******************************************************************************/
+static void CSP_Raise(void)
+{
+  systemREG1->SSISR3 = 0x7500U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Free the message objects whose frame was acknowledged.
+ *
+ * @param[in] now
+ *   Scheduler tick.
+ ******************************************************************************/
+static void CSP_Reap(uint32_t now)
+{
+  uint32_t acked = PORT_CAN_PoolReap(&CSP_Pool);
+
+  if ( acked != 0U )
+  {
+    CSP_State.txFrames += acked;
+    CSP_Progress = now;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Route complete packets, most urgent first. A packet whose service has
+ *   no reply buffer free waits for the next run.
+ ******************************************************************************/
+static void CSP_Serve(void)
+{
+  uint32_t prio;
+  uint32_t i;
+
+  for ( prio = CSP_Prio_Critical; prio <= CSP_Prio_Low; prio++ )
+  {
+    for ( i = 0U; i < CSP_NUM_RX_BUFFERS; i++ )
+    {
+      if ( CSP_Rx[i].state == CSP_Slot_Complete && CSP_Rx[i].prio == prio )
+      {
+        CSP_Route(&CSP_Rx[i]);
+      }
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check for a complete packet still waiting for its service.
+ ******************************************************************************/
+static uint8_t CSP_Waiting(void)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < CSP_NUM_RX_BUFFERS; i++ )
+  {
+    if ( CSP_Rx[i].state == CSP_Slot_Complete )
+    {
+      return 1U;
+    }
+  }
+
+  return 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Hand a packet to the service of its destination port.
+ ******************************************************************************/
+static void CSP_Route(CSP_Packet_TypeDef *rx)
+{
+  CSP_Packet_TypeDef *tx = 0;
+  uint32_t i;
+
+  if ( rx->dport == CSP_Port_Command )
+  {
+    /* One command at a time, its reply has the first buffer */
+    if ( CSP_Command == 0 && CSP_Tx[0].state == CSP_Slot_Free )
+    {
+      rx->state = CSP_Slot_Command;
+      CSP_Command = rx;
+      CSP_Dispatch();
+    }
+    return;
+  }
+
+  if ( rx->dport != CSP_Port_Ping && rx->dport != CSP_Port_Telemetry
+       && rx->dport != CSP_Port_Log )
+  {
+    for ( i = 0U; i < CSP_MAX_BINDINGS; i++ )
+    {
+      if ( CSP_BoundHandler[i] != 0 && CSP_BoundPort[i] == rx->dport )
+      {
+        CSP_BoundHandler[i](rx->peer, rx->sport, rx->data, rx->length);
+        rx->state = CSP_Slot_Free;
+        return;
+      }
+    }
+
+    CSP_State.unrouted++;
+    rx->state = CSP_Slot_Free;
+    return;
+  }
+
+  tx = CSP_AllocTx();
+  if ( tx == 0 )
+  {
+    return;
+  }
+
+  switch ( rx->dport )
+  {
+    case CSP_Port_Ping:
+      for ( i = 0U; i < rx->length; i++ )
+      {
+        tx->data[i] = rx->data[i];
+      }
+      tx->length = rx->length;
+      break;
+
+    case CSP_Port_Telemetry:
+      CSP_Telemetry(tx);
+      break;
+
+    default:
+      /* Held until the reply is sent, a download is a run of these */
+      (void)GOVERNOR_Request(GOVERNOR_Client_Download, GOVERNOR_Level_Max);
+      CSP_Log(rx, tx);
+      break;
+  }
+
+  CSP_Reply(rx, tx);
+  rx->state = CSP_Slot_Free;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Build the telemetry reply from the latest snapshot.
+ ******************************************************************************/
+static void CSP_Telemetry(CSP_Packet_TypeDef *tx)
+{
+  const TELEMETRY_Snapshot_TypeDef *snap = TELEMETRY_GetSnapshot();
+  uint32_t pos = 0U;
+  uint32_t i;
+
+  pos = CSP_Put(tx->data, pos, snap->sequence, 4U);
+  pos = CSP_Put(tx->data, pos, snap->timestamp, 4U);
+  pos = CSP_Put(tx->data, pos, (uint32_t)(snap->time >> 32U), 4U);
+  pos = CSP_Put(tx->data, pos, (uint32_t)snap->time, 4U);
+  pos = CSP_Put(tx->data, pos, snap->errors, 4U);
+  pos = CSP_Put(tx->data, pos, snap->tempErrors, 4U);
+
+  for ( i = 0U; i < TELEMETRY_NUM_CHANNELS; i++ )
+  {
+    pos = CSP_Put(tx->data, pos, (uint32_t)snap->meas[i].voltage, 4U);
+    pos = CSP_Put(tx->data, pos, (uint32_t)snap->meas[i].current, 4U);
+  }
+
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    pos = CSP_Put(tx->data, pos, (uint32_t)snap->temp[i], 4U);
+  }
+
+  tx->length = (uint16_t)pos;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Build the log reply: the ring bounds, or part of a block.
+ ******************************************************************************/
+static void CSP_Log(const CSP_Packet_TypeDef *rx, CSP_Packet_TypeDef *tx)
+{
+  const FLASHLOG_State_TypeDef *log = FLASHLOG_GetState();
+  uint32_t ringSeq;
+  uint32_t offset;
+  uint32_t pos;
+  uint32_t i;
+  FLASHLOG_Err_TypeDef err;
+
+  if ( rx->length == 0U )
+  {
+    pos = CSP_Put(tx->data, 0U, CSP_LOG_OK, 1U);
+    pos = CSP_Put(tx->data, pos, log->tail, 4U);
+    tx->length = (uint16_t)CSP_Put(tx->data, pos, log->head, 4U);
+    return;
+  }
+
+  ringSeq = ((uint32_t)rx->data[0] << 24U) | ((uint32_t)rx->data[1] << 16U)
+            | ((uint32_t)rx->data[2] << 8U) | rx->data[3];
+  offset = (rx->length >= 6U) ? (((uint32_t)rx->data[4] << 8U) | rx->data[5]) : FLASHLOG_BLOCK_SIZE;
+
+  pos = CSP_Put(tx->data, 1U, ringSeq, 4U);
+  pos = CSP_Put(tx->data, pos, offset, 2U);
+
+  err = (offset < FLASHLOG_BLOCK_SIZE) ? FLASHLOG_ReadBlock(ringSeq, CSP_Block) : FLASHLOG_Err_Invalid;
+
+  if ( err != FLASHLOG_Err_NoError )
+  {
+    tx->data[0] = (err == FLASHLOG_Err_Busy) ? CSP_LOG_BUSY : CSP_LOG_INVALID;
+    tx->length = (uint16_t)pos;
+    return;
+  }
+
+  tx->data[0] = CSP_LOG_OK;
+  for ( i = offset; i < FLASHLOG_BLOCK_SIZE && pos < CSP_MTU; i++ )
+  {
+    tx->data[pos++] = CSP_Block[i];
+  }
+  tx->length = (uint16_t)pos;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Address a reply to the sender of a request and queue it.
+ ******************************************************************************/
+static void CSP_Reply(const CSP_Packet_TypeDef *rx, CSP_Packet_TypeDef *tx)
+{
+  tx->prio = rx->prio;
+  tx->peer = rx->peer;
+  tx->dport = rx->sport;
+  tx->sport = rx->dport;
+  tx->state = CSP_Slot_Ready;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Take a free transmit buffer other than the one kept for commands.
+ ******************************************************************************/
+static CSP_Packet_TypeDef *CSP_AllocTx(void)
+{
+  uint32_t i;
+
+  for ( i = 1U; i < CSP_NUM_TX_BUFFERS; i++ )
+  {
+    if ( CSP_Tx[i].state == CSP_Slot_Free )
+    {
+      return &CSP_Tx[i];
+    }
+  }
+
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Queue the next frames of the reply being sent, or start the most
+ *   urgent reply waiting.
+ *
+ * @details
+ *   A reply that makes no progress for CSP_TIMEOUT, e.g. at bus off, is
+ *   dropped and its frames withdrawn from the message objects.
+ *
+ * @param[in] now
+ *   Scheduler tick.
+ ******************************************************************************/
+static void CSP_Send(uint32_t now)
+{
+  CSP_Packet_TypeDef *p = CSP_Current;
+  uint8_t data[PORT_CAN_DLC];
+  uint32_t frames;
+  uint32_t id;
+  uint32_t pos;
+  uint32_t i;
+
+  if ( p != 0 && now - CSP_Progress >= SCHEDULER_MS(CSP_TIMEOUT) )
+  {
+    PORT_CAN_PoolCancel(&CSP_Pool);
+    CSP_State.timeouts++;
+    CSP_Done(p);
+    p = 0;
+  }
+
+  if ( p != 0 && CSP_Pool.inFlight == 0U && CSP_Frame == CSP_FRAMES(p->length) )
+  {
+    CSP_State.txPackets++;
+    CSP_Done(p);
+    p = 0;
+  }
+
+  if ( p == 0 )
+  {
+    for ( i = 0U; i < CSP_NUM_TX_BUFFERS; i++ )
+    {
+      if ( CSP_Tx[i].state == CSP_Slot_Ready && (p == 0 || CSP_Tx[i].prio < p->prio) )
+      {
+        p = &CSP_Tx[i];
+      }
+    }
+
+    CSP_Current = p;
+    if ( p == 0 )
+    {
+      return;
+    }
+
+    p->state = CSP_Slot_Sending;
+    p->ident = CSP_Ident++;
+    CSP_Frame = 0U;
+    CSP_Progress = now;
+  }
+
+  frames = CSP_FRAMES(p->length);
+
+  while ( CSP_Frame < frames )
+  {
+    id = ((uint32_t)p->prio << CSP_ID_PRIO_SHIFT)
+         | ((uint32_t)CSP_Params.address << CSP_ID_SRC_SHIFT)
+         | ((uint32_t)p->peer << CSP_ID_DST_SHIFT)
+         | ((frames - 1U - CSP_Frame) << CSP_ID_REMAIN_SHIFT)
+         | p->ident;
+
+    i = 0U;
+    pos = CSP_BEGIN_DATA + (CSP_Frame - 1U) * PORT_CAN_DLC;
+    if ( CSP_Frame == 0U )
+    {
+      id |= CSP_ID_BEGIN;
+      data[0] = p->dport;
+      data[1] = p->sport;
+      data[2] = (uint8_t)(p->length >> 8U);
+      data[3] = (uint8_t)p->length;
+      i = CSP_BEGIN_HEADER;
+      pos = 0U;
+    }
+
+    for ( ; i < PORT_CAN_DLC; i++, pos++ )
+    {
+      data[i] = (pos < p->length) ? p->data[pos] : 0U;
+    }
+
+    if ( PORT_CAN_PoolSend(&CSP_Pool, id, data) != PORT_CAN_Err_NoError )
+    {
+      return;
+    }
+
+    CSP_Frame++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Free the buffer of a reply sent or dropped, and drop the clock request
+ *   of a log reply.
+ ******************************************************************************/
+static void CSP_Done(CSP_Packet_TypeDef *tx)
+{
+  if ( tx->sport == CSP_Port_Log )
+  {
+    (void)GOVERNOR_Release(GOVERNOR_Client_Download);
+  }
+
+  tx->state = CSP_Slot_Free;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Store a value most significant byte first.
+ *
+ * @return
+ *   Returns the position after the value, unchanged if it does not fit.
+ ******************************************************************************/
+static uint32_t CSP_Put(uint8_t *data, uint32_t pos, uint32_t value, uint32_t size)
+{
+  if ( pos + size > CSP_MTU )
+  {
+    return pos;
+  }
+
+  for ( ; size > 0U; size-- )
+  {
+    data[pos++] = (uint8_t)(value >> (8U * (size - 1U)));
+  }
+
+  return pos;
+}
@@ -0,0 +1,260 @@
+/** @file csp.h
+*   @brief CSP Style Transport over CAN Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup CSP CSP
+ *  @brief Packets of up to CSP_MTU bytes over CAN, routed to EPS services.
+ *
+ *  Follows the CAN fragmentation of the CubeSat Space Protocol, with the
+ *  packet priority moved into the identifier so urgent packets also win
+ *  bus arbitration:
+ *
+ *    bits   field
+ *    28-27  priority, CSP_Prio_TypeDef, 0 most urgent
+ *    26-22  source address
+ *    21-17  destination address
+ *    16     set on the first frame of a packet
+ *    15-8   frames of the packet still to follow
+ *    7-0    packet identifier, counted per sender
+ *
+ *  The first frame carries destination port, source port, the payload
+ *  length most significant byte first and the first CSP_BEGIN_DATA
+ *  payload bytes; each following frame PORT_CAN_DLC more.
+ *
+ *  One receive filter of PORT_CAN accepts every frame addressed to this
+ *  node, so the address must not make the identifiers of CANCMD and
+ *  CANPUB match (8, 18 and 19 with their defaults). Packets are reassembled
+ *  in the CAN interrupt into CSP_NUM_RX_BUFFERS buffers of a static pool,
+ *  one per packet in progress; a first frame that finds none free is
+ *  dropped, unless a buffer has waited CSP_TIMEOUT for its next frame.
+ *
+ *  Complete packets are served by CSP_Update, most urgent first, by the
+ *  service of their destination port. Replies go back to the source port
+ *  at the priority of the request and are queued in CSP_NUM_TX_BUFFERS
+ *  buffers, the first kept for commands. Commands run through the console
+ *  dispatcher in the system software interrupt CSP_SSI, like console and
+ *  CANCMD commands, with the output captured as the reply. From a log
+ *  request until its reply is sent the clock governor is held at its top
+ *  level, so a download runs at full speed.
+ *
+ *  Other modules may bind a port of their own and send packets, e.g. the
+ *  CAN benchmark of canbench.h.
+ *
+ *  Frames of one packet at a time are placed in an ordered PORT_CAN pool of
+ *  numBoxes transmit message objects after those of CANPUB, so at most
+ *  numBoxes per CSP_PERIOD, which bounds the bandwidth taken by replies.
+ *
+ *  The task has period 0: a complete packet, CSP_SendPacket and
+ *  CSP_Execute release it, and it releases itself every CSP_PERIOD while
+ *  a packet waits to be served or a reply to be sent, so an idle link
+ *  costs no wakeups.
+ *
+ *	Related Files
+ *   - csp.h
+ *   - csp.c
+ *   - port_can.h
+ *   - canpub.h
+ *   - eps.h
+ *   - telemetry.h
+ *   - flashlog.h
+ *   - governor.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_CSP_H_
+#define DRIVERS_CSP_H_
+
+#include "port_can.h"
+#include "canpub.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Interval between task runs while sending, in ticks */
+#define CSP_PERIOD                (SCHEDULER_MS(10))
+
+/** Largest payload of a packet in bytes */
+#define CSP_MTU                   (512U)
+
+/** Packets reassembled at the same time */
+#define CSP_NUM_RX_BUFFERS        (4U)
+
+/** Packets queued for sending, the first for command replies */
+#define CSP_NUM_TX_BUFFERS        (3U)
+
+/** Transmit message objects, after those of CANPUB */
+#define CSP_FIRST_BOX             (CANPUB_FIRST_BOX + CANPUB_MAX_BOXES)
+#define CSP_MAX_BOXES             (4U)
+
+/** Receive filter */
+#define CSP_FILTER                (1U)
+
+/** Time a packet may wait for its next frame, or for its next frame to be
+ *  sent, in ms */
+#define CSP_TIMEOUT               (1000U)
+
+/** System software interrupt running commands */
+#define CSP_SSI                   (3U)
+
+/** Ports other modules can bind */
+#define CSP_MAX_BINDINGS          (2U)
+
+/** Identifier fields */
+#define CSP_ID_PRIO_SHIFT         (27U)
+#define CSP_ID_SRC_SHIFT          (22U)
+#define CSP_ID_DST_SHIFT          (17U)
+#define CSP_ID_BEGIN              (1UL << 16U)
+#define CSP_ID_REMAIN_SHIFT       (8U)
+#define CSP_ID_PRIO_MASK          (0x3U)
+#define CSP_ID_ADDRESS_MASK       (0x1FU)
+#define CSP_ID_REMAIN_MASK        (0xFFU)
+#define CSP_ID_IDENT_MASK         (0xFFU)
+
+/** Header and payload bytes of the first frame */
+#define CSP_BEGIN_HEADER          (4U)
+#define CSP_BEGIN_DATA            (PORT_CAN_DLC - CSP_BEGIN_HEADER)
+
+/** Frames of a packet */
+#define CSP_FRAMES(length)        (1U + (((length) > CSP_BEGIN_DATA) \
+                                         ? ((length) - CSP_BEGIN_DATA + PORT_CAN_DLC - 1U) / PORT_CAN_DLC : 0U))
+
+#if CSP_FRAMES(CSP_MTU) - 1U > CSP_ID_REMAIN_MASK
+#error "CSP_MTU does not fit the frame counter"
+#endif
+
+/** Status byte leading log service replies */
+#define CSP_LOG_OK                (0U)
+#define CSP_LOG_BUSY              (1U)
+#define CSP_LOG_INVALID           (2U)
+
+/**
+ *  @addtogroup CSP
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum CSP_Prio_TypeDef
+*   @brief Packet priorities.
+*/
+typedef enum
+{
+  CSP_Prio_Critical = 0U,         /**< Critical*/
+  CSP_Prio_High     = 1U,         /**< High*/
+  CSP_Prio_Norm     = 2U,         /**< Normal*/
+  CSP_Prio_Low      = 3U          /**< Low*/
+} CSP_Prio_TypeDef;
+
+/** @enum CSP_Port_TypeDef
+*   @brief Services by destination port.
+*
+*   Ping echoes the payload. Telemetry replies with the latest snapshot:
+*   sequence, timestamp, time, errors and temperature errors, then voltage
+*   and current of every channel and every temperature, all 32 bit except
+*   the 64 bit time, most significant byte first. Command runs the payload
+*   as a console command and replies with its output. Log takes a ring
+*   sequence and offset, 32 and 16 bit, and replies with a status byte,
+*   both and the block bytes that follow, up to CSP_MTU in all; an empty
+*   request gets the status, tail and head of the ring. Ports from
+*   CSP_Port_User on are free for CSP_Bind.
+*/
+typedef enum
+{
+  CSP_Port_Ping      = 1U,        /**< Echo*/
+  CSP_Port_Telemetry = 10U,       /**< Telemetry snapshot*/
+  CSP_Port_Command   = 11U,       /**< Console command*/
+  CSP_Port_Log       = 12U,       /**< Flash log blocks*/
+  CSP_Port_User      = 16U        /**< First port for CSP_Bind*/
+} CSP_Port_TypeDef;
+
+/** @enum CSP_Err_TypeDef
+*   @brief Alias names for CSP errors.
+*/
+typedef enum
+{
+  CSP_Err_NoError = 0U,           /**< No error*/
+  CSP_Err_Invalid = 1U,           /**< Address, port, length or number of message objects out of range*/
+  CSP_Err_Busy    = 2U            /**< No buffer free, try again*/
+} CSP_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct CSP_Params_TypeDef
+*   @brief Transport parameters.
+*/
+typedef struct
+{
+  uint8_t address;                /**< Node address, 0 to 30*/
+  uint8_t numBoxes;               /**< Frames sent per run, 1 to CSP_MAX_BOXES*/
+} CSP_Params_TypeDef;
+
+/** @struct CSP_State_TypeDef
+*   @brief Statistics.
+*/
+typedef struct
+{
+  uint32_t rxFrames;              /**< Frames received*/
+  uint32_t rxPackets;             /**< Packets reassembled*/
+  uint32_t txFrames;              /**< Frames acknowledged*/
+  uint32_t txPackets;             /**< Packets sent complete*/
+  uint32_t noBuffer;              /**< Packets dropped for want of a buffer*/
+  uint32_t errors;                /**< Packets dropped for a missing frame or bad length*/
+  uint32_t timeouts;              /**< Packets abandoned*/
+  uint32_t unrouted;              /**< Packets to a port without a service*/
+  uint32_t truncated;             /**< Replies cut to CSP_MTU*/
+  uint8_t peakBuffers;            /**< Most receive buffers in use at once*/
+} CSP_State_TypeDef;
+
+/** Run CSP_Execute outside the task */
+typedef void (*CSP_Dispatch_TypeDef)(void);
+
+/** Service of a bound port, called from CSP_Update */
+typedef void (*CSP_Handler_TypeDef)(uint8_t src,
+                                    uint8_t sport,
+                                    const uint8_t *data,
+                                    uint16_t length);
+
+extern const CSP_Params_TypeDef CSP_DefaultParams;
+
+CSP_Err_TypeDef CSP_Init(const CSP_Params_TypeDef *params,
+                         CSP_Dispatch_TypeDef Dispatch,
+                         uint32_t task);
+
+void CSP_Update(void);
+
+void CSP_Execute(void);
+
+CSP_Err_TypeDef CSP_Bind(uint8_t port, CSP_Handler_TypeDef handler);
+
+CSP_Err_TypeDef CSP_SendPacket(CSP_Prio_TypeDef prio,
+                               uint8_t dst,
+                               uint8_t dport,
+                               uint8_t sport,
+                               const uint8_t *data,
+                               uint16_t length);
+
+void CSP_ResetStats(void);
+
+uint8_t CSP_GetAddress(void);
+
+const CSP_State_TypeDef *CSP_GetState(void);
+
+PRINT_Err_TypeDef CSP_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_CSP_H_ */
@@ -7,7 +7,7 @@
 
 #include "eps.h"
 #include <string.h>
-#include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include "adc.h"
 #include "system.h"
@@ -17,6 +17,25 @@
 #include "rti.h"
 #include "het.h"
 #include "gio.h"
+#include "scheduler.h"
+#include "profile.h"
+#include "idle.h"
+#include "governor.h"
+#include "mppt.h"
+#include "ivsweep.h"
+#include "battery.h"
+#include "policy.h"
+#include "rv3032c7.h"
+#include "telemetry.h"
+#include "flashlog.h"
+#include "history.h"
+#include "config.h"
+#include "canpub.h"
+#include "cancmd.h"
+#include "csp.h"
+#include "canbench.h"
+#include "adcacq.h"
+#include "adccal.h"
 
 
 static char  StringBuf[PRINT_BUFFER_SIZE+1];
@@ -34,14 +53,37 @@ char* EPS_Arg0[] = {
     "MPPT2",
     "MPPT3",
     "MPPT4",
+    "SCHED",
+    "PROFILE",
+    "HIST",
+    "IDLE",
+    "CLOCK",
+    "SWEEP",
+    "BATTERY",
+    "POLICY",
+    "RTC",
+    "TEMP",
+    "LOG",
+    "CONFIG",
+    "CAN",
+    "ADC",
 };
 
 char* EPS_Arg1[] = {
     "OFF",
-    "ON"
+    "ON",
     "VOLT",
     "CURR",
-    "POWER"
+    "POWER",
+    "CACHE",
+    "BRANCH",
+    "BENCH",
+    "PO",
+    "INC",
+    "SWEEP",
+    "FLUSH",
+    "TEMP",
+    "SAVE"
 };
 
 typedef enum
@@ -59,6 +101,20 @@ typedef enum
   EPS_Arg0_mppt2 = 3,
   EPS_Arg0_mppt3 = 4,
   EPS_Arg0_mppt4 = 5,
+  EPS_Arg0_sched = 6,
+  EPS_Arg0_profile = 7,
+  EPS_Arg0_hist = 8,
+  EPS_Arg0_idle = 9,
+  EPS_Arg0_clock = 10,
+  EPS_Arg0_sweep = 11,
+  EPS_Arg0_battery = 12,
+  EPS_Arg0_policy = 13,
+  EPS_Arg0_rtc = 14,
+  EPS_Arg0_temp = 15,
+  EPS_Arg0_log = 16,
+  EPS_Arg0_config = 17,
+  EPS_Arg0_can = 18,
+  EPS_Arg0_adc = 19,
 } EPS_Args_read_arg0_TypeDef;
 
 typedef enum
@@ -67,77 +123,563 @@ typedef enum
   EPS_Arg1_on = 1,
   EPS_Arg1_volt = 2,
   EPS_Arg1_curr = 3,
-  EPS_Arg1_power = 4
+  EPS_Arg1_power = 4,
+  EPS_Arg1_cache = 5,
+  EPS_Arg1_branch = 6,
+  EPS_Arg1_bench = 7,
+  EPS_Arg1_po = 8,
+  EPS_Arg1_inc = 9,
+  EPS_Arg1_sweep = 10,
+  EPS_Arg1_flush = 11,
+  EPS_Arg1_temp = 12,
+  EPS_Arg1_save = 13
 
 } EPS_Args_read_arg1_TypeDef;
 
 
 void printBusVoltage(uint32_t address);
 void printBusCurrent(uint32_t address, uint32_t senseResistor );
+static int32_t EPS_MpptChannel(char *arg);
 
 /*******************************************************************************
  **************************   GLOBAL FUNCTIONS   *******************************
  ******************************************************************************/
 
-EPS_Err_TypeDef EPS_runCommand(char * command,
+/***************************************************************************//**
+ * @brief
+ *   Split a command string of the form COMMAND(ARG0,ARG1,...) and run it.
+ *
+ * @details
+ *   Used by the console and by CANCMD, so commands behave the same on
+ *   every interface. The string is modified.
+ *
+ * @param[in] uart
+ *   Port the output goes to, PRINT_CAPTURE to capture it.
+ *
+ * @param[in] command
+ *   Null terminated command string, upper case.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+EPS_Err_TypeDef EPS_runCommandString(PORT_UART_Reg_TypeDef *uart,
+                                     char * command)
+{
+    static char * function;
+    static char * arg[EPS_MAX_ARGS];
+    static uint8_t i = 0;
+
+    /* Extract function name from command string */
+    function = strtok(command,"(");
+
+    /* Extract arguments from command string */
+    for(i = 0; i<EPS_MAX_ARGS; i++)
+    {
+        arg[i] = strtok(NULL,",");
+        if (arg[i] == NULL) break;
+    }
+
+    if (function == NULL || i == 0)
+    {
+        PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad command...\033[0m");
+        return EPS_Err_Syntax;
+    }
+
+    i = i - 1;
+    arg[i] = strtok(arg[i],")");
+
+    /* Split argument strings into individual arguments */
+    for(i = 0; i<EPS_MAX_ARGS && arg[i]!=NULL; i++)
+    {
+        arg[i] = strtok(arg[i]," ");
+    }
+
+    return EPS_runCommand(uart,function,arg,i);
+}
+
+EPS_Err_TypeDef EPS_runCommand(PORT_UART_Reg_TypeDef *uart,
+                            char * command,
                             char * arg[EPS_MAX_ARGS],
                             uint8_t numArgs)
 {
     static uint8_t i = 0;
-    PRINT_PrintString( PORT_UART_UART0,"ECHO: ");
-    PRINT_PrintString( PORT_UART_UART0,command );
-    PRINT_PrintChar(PORT_UART_UART0,'(');
+    PRINT_PrintString( uart,"ECHO: ");
+    PRINT_PrintString( uart,command );
+    PRINT_PrintChar(uart,'(');
     for (i = 0; i< numArgs; i++)
     {
-        PRINT_PrintString( PORT_UART_UART0,arg[i] );
-        PRINT_PrintChar(PORT_UART_UART0,',');
+        PRINT_PrintString( uart,arg[i] );
+        PRINT_PrintChar(uart,',');
     }
-    PRINT_Print(PORT_UART_UART0,4,"\b)\r\n");
+    PRINT_Print(uart,4,"\b)\r\n");
 
     if(!strcmp(command,EPS_Command[EPS_Command_read]))
     {
         if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_idn]))
         {
-            sprintf(StringBuf,
-                "0x%08X",
-                DEVICE_ID_REV);
-            PRINT_PrintStringln(scilinREG,StringBuf);
+            StringBuf[0] = '0';
+            StringBuf[1] = 'x';
+            PRINT_FormatHex(&StringBuf[2],DEVICE_ID_REV,8U);
+            PRINT_PrintStringln(uart,StringBuf);
         }
         else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_time]))
         {
-            sprintf(StringBuf,
-                "%d",
-                rtiGetCurrentTick(rtiCOMPARE1));
-            PRINT_PrintStringln(scilinREG,StringBuf);
+            PRINT_FormatUInt(StringBuf,rtiGetCurrentTick(rtiCOMPARE1));
+            PRINT_PrintStringln(uart,StringBuf);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_sched]))
+        {
+            SCHEDULER_PrintStats(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_profile]))
+        {
+            PROFILE_Print(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_hist]))
+        {
+            PROFILE_HistPrint(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_idle]))
+        {
+            IDLE_PrintStats(uart);
+        }
+        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_idle])
+                && !strcmp(arg[1],EPS_Arg1[EPS_Arg1_bench]))
+        {
+            IDLE_BenchPrint(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_clock]))
+        {
+            GOVERNOR_PrintStats(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_sweep]))
+        {
+            IVSWEEP_PrintCurve(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_battery]))
+        {
+            BATTERY_PrintStats(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_policy]))
+        {
+            POLICY_PrintStats(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_rtc]))
+        {
+            RV3032C7_PrintStats(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_log]))
+        {
+            FLASHLOG_PrintStats(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_config]))
+        {
+            CONFIG_PrintStats(uart);
+        }
+        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_can])
+                && !strcmp(arg[1],EPS_Arg1[EPS_Arg1_bench]))
+        {
+            CANBENCH_Print(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_can]))
+        {
+            CANPUB_PrintStats(uart);
+            CANCMD_PrintStats(uart);
+            CSP_PrintStats(uart);
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_adc]))
+        {
+            ADCACQ_PrintStats(uart);
+            ADCCAL_PrintStats(uart);
+        }
+        else if((numArgs == 2 || numArgs == 3) && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_config]))
+        {
+            /* Staged value of a field, the element given for an array */
+            int32_t value;
+
+            if(CONFIG_GetStaged(arg[1],(numArgs == 3) ? (uint32_t)strtoul(arg[2],0,0) : 0U,&value) != CONFIG_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+            PRINT_FormatInt(StringBuf,value);
+            PRINT_PrintStringln(uart,StringBuf);
+        }
+        else if(numArgs == 5 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_log]))
+        {
+            /* Stream a quantity of one channel between two times, in seconds
+               since 2000, as KISS frames on this port */
+            HISTORY_Quantity_TypeDef quantity;
+            int32_t channel = EPS_MpptChannel(arg[1]);
+            HISTORY_Err_TypeDef err;
+
+            if(channel < 0)
+                channel = (int32_t)strtoul(arg[1],0,0);
+
+            if(uart == PRINT_CAPTURE)
+            {
+                /* The stream outlives the command, it needs a real port */
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Stream only available on the console\033[0m");
+                return EPS_Err_Syntax;
+            }
+
+            if(channel > 255)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+
+            if(!strcmp(arg[2],EPS_Arg1[EPS_Arg1_volt]))
+                quantity = HISTORY_Quantity_Voltage;
+            else if(!strcmp(arg[2],EPS_Arg1[EPS_Arg1_curr]))
+                quantity = HISTORY_Quantity_Current;
+            else if(!strcmp(arg[2],EPS_Arg1[EPS_Arg1_power]))
+                quantity = HISTORY_Quantity_Power;
+            else if(!strcmp(arg[2],EPS_Arg1[EPS_Arg1_temp]))
+                quantity = HISTORY_Quantity_Temp;
+            else
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+
+            err = HISTORY_Start(uart,(uint8_t)channel,quantity,
+                                (uint64_t)strtoul(arg[3],0,10) * 1000000ULL,
+                                (uint64_t)strtoul(arg[4],0,10) * 1000000ULL);
+
+            if(err == HISTORY_Err_Busy)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Query in progress, try again\033[0m");
+                return EPS_Err_Syntax;
+            }
+            else if(err == HISTORY_Err_Empty)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: No records in range\033[0m");
+                return EPS_Err_Syntax;
+            }
+            else if(err != HISTORY_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_temp]))
+        {
+            /* Temperatures of the last sweep in C, ERR for a failed sensor */
+            const TELEMETRY_Snapshot_TypeDef *snap = TELEMETRY_GetSnapshot();
+
+            for (i = 0; i < TELEMETRY_NUM_TEMPS; i++)
+            {
+                if(snap->tempErrors & (1UL << i))
+                {
+                    PRINT_PrintString(uart,"ERR ");
+                    continue;
+                }
+                PRINT_FormatFixed(StringBuf,snap->temp[i],3U,2U);
+                PRINT_PrintString(uart,StringBuf);
+                PRINT_PrintChar(uart,' ');
+            }
+            PRINT_PrintStringln(uart,"C");
+        }
+        else if(numArgs == 1 && EPS_MpptChannel(arg[0]) >= 0)
+        {
+            MPPT_PrintStats(uart,(MPPT_Channel_TypeDef)EPS_MpptChannel(arg[0]));
         }
-        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_mppt1]))
+        else if(numArgs == 2 && EPS_MpptChannel(arg[0]) >= 0)
         {
+            const MPPT_State_TypeDef *mppt = MPPT_GetState((MPPT_Channel_TypeDef)EPS_MpptChannel(arg[0]));
+
             if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_volt]))
-                PRINT_PrintStringln(PORT_UART_UART0,"EPS_Arg1_volt");
+                PRINT_FormatEng(StringBuf,mppt->voltage,PRINT_Unit_mV,1U);
             else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_curr]))
-                PRINT_PrintStringln(PORT_UART_UART0,"EPS_Arg1_volt");
+                PRINT_FormatEng(StringBuf,mppt->current,PRINT_Unit_mA,1U);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_power]))
+                PRINT_FormatEng(StringBuf,mppt->power,PRINT_Unit_mW,1U);
             else
             {
-                PRINT_PrintStringln(PORT_UART_UART0,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
                 return EPS_Err_Syntax;
             }
+            PRINT_PrintStringln(uart,StringBuf);
         }
         else
         {
-            PRINT_PrintStringln(PORT_UART_UART0,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+            PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+            return EPS_Err_Syntax;
+        }
+    }
+    else if (!strcmp(command,EPS_Command[EPS_Command_reset]))
+    {
+        if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_sched]))
+        {
+            SCHEDULER_ResetStats();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_profile]))
+        {
+            PROFILE_Reset();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_hist]))
+        {
+            PROFILE_HistReset();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_idle]))
+        {
+            IDLE_ResetStats();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_clock]))
+        {
+            GOVERNOR_ResetStats();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_sweep]))
+        {
+            IVSWEEP_Abort();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_battery]))
+        {
+            BATTERY_Reset();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_policy]))
+        {
+            POLICY_Reset();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_log]))
+        {
+            FLASHLOG_ResetStats();
+            HISTORY_Abort();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_config]))
+        {
+            /* Stage the defaults, WRITE CONFIG SAVE makes them persistent */
+            CONFIG_Reset();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_can]))
+        {
+            CANPUB_ResetStats();
+            CANCMD_ResetStats();
+            CSP_ResetStats();
+        }
+        else if(numArgs == 1 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_adc]))
+        {
+            ADCACQ_ResetStats();
+            ADCCAL_ResetStats();
+        }
+        else if(numArgs == 1 && EPS_MpptChannel(arg[0]) >= 0)
+        {
+            MPPT_Restart((MPPT_Channel_TypeDef)EPS_MpptChannel(arg[0]));
+        }
+        else
+        {
+            PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
             return EPS_Err_Syntax;
         }
     }
     else if (!strcmp(command,EPS_Command[EPS_Command_write]))
     {
+        if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_profile]))
+        {
+            if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_cache]))
+                PROFILE_SelectEvents(PROFILE_Events_Cache);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_branch]))
+                PROFILE_SelectEvents(PROFILE_Events_Branch);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_off]))
+                PROFILE_SelectEvents(PROFILE_Events_None);
+            else
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_idle]))
+        {
+            /* ON allows doze and snooze, OFF limits idle to WFI */
+            if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_on]))
+                IDLE_Unlock(IDLE_Lock_User);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_off]))
+                IDLE_Lock(IDLE_Lock_User);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_bench]))
+                IDLE_BenchStart(IDLE_BENCH_DEFAULT);
+            else
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_clock]))
+        {
+            /* ON holds full speed, OFF leaves the clock to the governor */
+            if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_on]))
+                GOVERNOR_Request(GOVERNOR_Client_User, GOVERNOR_Level_Max);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_off]))
+                GOVERNOR_Release(GOVERNOR_Client_User);
+            else
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_log])
+                && !strcmp(arg[1],EPS_Arg1[EPS_Arg1_flush]))
+        {
+            /* Checkpoint the block being filled, e.g. before a planned reset */
+            if(FLASHLOG_Flush() != FLASHLOG_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Log write busy, try again\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_config])
+                && !strcmp(arg[1],EPS_Arg1[EPS_Arg1_save]))
+        {
+            /* Commit the staged configuration, used from the next reset */
+            CONFIG_Err_TypeDef err = CONFIG_Commit();
 
+            if(err == CONFIG_Err_Flash)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: No data flash, config not saved\033[0m");
+                return EPS_Err_Syntax;
+            }
+            else if(err != CONFIG_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Config commit in progress, try again\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if((numArgs == 3 || numArgs == 4) && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_config]))
+        {
+            /* Stage a field, or an element of an array field */
+            uint32_t index = (numArgs == 4) ? (uint32_t)strtoul(arg[2],0,0) : 0U;
+
+            if(CONFIG_Set(arg[1],index,(int32_t)strtol(arg[numArgs - 1],0,0)) != CONFIG_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Unknown field or value out of limits\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 2 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_can])
+                && !strcmp(arg[1],EPS_Arg1[EPS_Arg1_bench]))
+        {
+            /* Loopback round trips, the bus is left meanwhile */
+            CANBENCH_Start(CANBENCH_DEFAULT_PACKETS);
+        }
+        else if(numArgs == 3 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_can]))
+        {
+            /* Period in ms of a frame of the publisher table, 0 stops it */
+            uint32_t period = (uint32_t)strtoul(arg[2],0,0);
+
+            if(period > 0xFFFFU
+               || CANPUB_SetPeriod((uint32_t)strtoul(arg[1],0,0),(uint16_t)period) != CANPUB_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Unknown frame or period out of range\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 7 && !strcmp(arg[0],EPS_Arg0[EPS_Arg0_rtc]))
+        {
+            /* Year, month, date, hour, minute and second */
+            RV3032C7_DateTime_TypeDef time;
+            uint32_t year = (uint32_t)strtoul(arg[1],0,10);
+
+            time.year = (uint8_t)((year >= 2000U) ? year - 2000U : 100U);
+            time.month = (uint8_t)strtoul(arg[2],0,10);
+            time.date = (uint8_t)strtoul(arg[3],0,10);
+            time.hour = (uint8_t)strtoul(arg[4],0,10);
+            time.minute = (uint8_t)strtoul(arg[5],0,10);
+            time.second = (uint8_t)strtoul(arg[6],0,10);
+            time.hundredths = 0U;
+            time.weekday = 0U;
+
+            if(time.year < 100U && time.month >= 1U && time.month <= 12U)
+            {
+                /* Weekday from the date */
+                RV3032C7_DateTime_TypeDef day;
+                RV3032C7_FromSeconds(RV3032C7_ToSeconds(&time),&day);
+                time.weekday = day.weekday;
+            }
+
+            if(RV3032C7_SetTime(&time) != RV3032C7_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: RTC not set, bad time or no response\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if((numArgs == 2 || numArgs == 6) && EPS_MpptChannel(arg[0]) >= 0
+                && !strcmp(arg[1],EPS_Arg1[EPS_Arg1_sweep]))
+        {
+            /* Default ramp, or start, stop and step codes and dwell in us */
+            IVSWEEP_Ramp_TypeDef ramp = IVSWEEP_DefaultRamp;
+
+            if(numArgs == 6)
+            {
+                ramp.start = (uint16_t)strtoul(arg[2],0,0);
+                ramp.stop = (uint16_t)strtoul(arg[3],0,0);
+                ramp.step = (uint16_t)strtoul(arg[4],0,0);
+                ramp.dwell = (uint32_t)strtoul(arg[5],0,0);
+            }
+
+            if(IVSWEEP_Start((MPPT_Channel_TypeDef)EPS_MpptChannel(arg[0]),&ramp) != IVSWEEP_Err_NoError)
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Sweep busy or bad ramp\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else if(numArgs == 2 && EPS_MpptChannel(arg[0]) >= 0)
+        {
+            /* ON tracks, OFF holds the setpoint, PO and INC pick the algorithm of all panels */
+            MPPT_Channel_TypeDef channel = (MPPT_Channel_TypeDef)EPS_MpptChannel(arg[0]);
+
+            if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_on]))
+                MPPT_Enable(channel,1U);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_off]))
+                MPPT_Enable(channel,0U);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_po]))
+                MPPT_SetAlgorithm(MPPT_Algorithm_PerturbObserve);
+            else if(!strcmp(arg[1],EPS_Arg1[EPS_Arg1_inc]))
+                MPPT_SetAlgorithm(MPPT_Algorithm_IncCond);
+            else
+            {
+                PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+                return EPS_Err_Syntax;
+            }
+        }
+        else
+        {
+            PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad arguments...\033[0m");
+            return EPS_Err_Syntax;
+        }
     }
     else
     {
-        PRINT_PrintStringln(PORT_UART_UART0,"\033[0;31mERROR: Invalid syntax! Bad command...\033[0m");
+        PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid syntax! Bad command...\033[0m");
         return EPS_Err_Syntax;
     }
 
     return EPS_Err_NoError;
 }
 
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Map an MPPT1 to MPPT4 argument to its MPPT channel.
+ *
+ * @param[in] arg
+ *   Command argument.
+ *
+ * @return
+ *   Returns the channel, or -1 if the argument is not an MPPT input.
+ ******************************************************************************/
+static int32_t EPS_MpptChannel(char *arg)
+{
+    int32_t i;
+
+    for (i = 0; i < (int32_t)MPPT_NUM_CHANNELS; i++)
+    {
+        if(!strcmp(arg,EPS_Arg0[EPS_Arg0_mppt1 + i]))
+            return i;
+    }
+
+    return -1;
+}
@@ -23,6 +23,8 @@
 #include "stdint.h"
 #include "ina226.h"
 #include "tca9548a.h"
+#include "rv3032c7.h"
+#include "tmp117.h"
 
 /*******************************************************************************
  *******************************   DEFINES   ***********************************
@@ -30,6 +32,9 @@
 
 #define EPS_MAX_ARGS (10)
 
+/* Commands are upper case, whether from the console, CANCMD or CSP */
+#define EPS_UPPER(c) (((c) >= 'a' && (c) <= 'z') ? (char)((c) - 'a' + 'A') : (c))
+
 #define EPS_COMMAND_READ 
 
 /*****************************************/
@@ -66,7 +71,7 @@
 #define EPS_BATBUS_I2CADDR (INA226_Addr44) 
 #define EPS_BATBUS_MUXCHAN (TCA9548A_Channel_0)
 
-#define EPS_RTC_I2CADDR    (RV3032_Addr51)
+#define EPS_RTC_I2CADDR    (RV3032C7_Addr51)
 #define EPS_RTC_MUXCHAN    (TCA9548A_Channel_0)
 
 #define EPS_TEMP1_I2CADDR  (TMP117_Addr48)
@@ -183,7 +188,11 @@ typedef enum
  *****************************   PROTOTYPES   **********************************
  ******************************************************************************/
 
-EPS_Err_TypeDef EPS_runCommand(char * function,
+EPS_Err_TypeDef EPS_runCommandString(PORT_UART_Reg_TypeDef *uart,
+                                     char * command);
+
+EPS_Err_TypeDef EPS_runCommand(PORT_UART_Reg_TypeDef *uart,
+                            char * function,
                             char * arg[EPS_MAX_ARGS],
                             uint8_t numArgs);
 
@@ -0,0 +1,1142 @@
+/** @file flashlog.c
+*   @brief Telemetry Flash Log Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "flashlog.h"
+#include "port_fee.h"
+#include "telemetry.h"
+#include "print.h"
+#include "profile.h"
+#include "stdint.h"
+#include <string.h>
+
+/* Calls of the FEE main function per task run while a job is pending */
+#define FLASHLOG_MAIN_CALLS       (16U)
+
+/* Position of each snapshot field among the record values */
+#define FLASHLOG_VOLTAGE(i)       (i)
+#define FLASHLOG_CURRENT(i)       (TELEMETRY_NUM_CHANNELS + (i))
+#define FLASHLOG_TEMP(i)          (2U * TELEMETRY_NUM_CHANNELS + (i))
+#define FLASHLOG_ERRORS           (2U * TELEMETRY_NUM_CHANNELS + TELEMETRY_NUM_TEMPS)
+#define FLASHLOG_TEMP_ERRORS      (FLASHLOG_ERRORS + 1U)
+
+/* Largest time step coded in a record, in time units; beyond it a new
+ * block starts with the absolute time in its header */
+#define FLASHLOG_MAX_STEP         (0x0FFFFFFF)
+
+/* State of the write buffer */
+#define FLASHLOG_WRITE_FREE       (0U)
+#define FLASHLOG_WRITE_QUEUED     (1U)
+#define FLASHLOG_WRITE_BUSY       (2U)
+
+static uint8_t FLASHLOG_Active[FLASHLOG_BLOCK_SIZE];
+static uint8_t FLASHLOG_Pending[FLASHLOG_BLOCK_SIZE];
+static uint8_t FLASHLOG_Record[FLASHLOG_RECORD_MAX];
+
+/* Encoder, the cursor after the last record of the active block */
+static FLASHLOG_Cursor_TypeDef FLASHLOG_Writer;
+
+/* Last logged value of each field, the reference of the deadband */
+static int32_t FLASHLOG_Held[FLASHLOG_NUM_VALUES];
+
+/* First record of every block, by ring position */
+static FLASHLOG_Index_TypeDef FLASHLOG_Index[FLASHLOG_NUM_BLOCKS];
+
+/* Replay of a checkpoint at boot */
+static FLASHLOG_Cursor_TypeDef FLASHLOG_Probe;
+static TELEMETRY_Snapshot_TypeDef FLASHLOG_Scratch;
+static FLASHLOG_State_TypeDef FLASHLOG_State;
+
+static uint8_t FLASHLOG_Ready = 0U;
+static uint8_t FLASHLOG_WriteState = FLASHLOG_WRITE_FREE;
+static uint16_t FLASHLOG_WriteBlock;
+static uint32_t FLASHLOG_WriteSeq;
+static uint32_t FLASHLOG_SinceCheckpoint;
+static uint32_t FLASHLOG_LastTimestamp;
+static uint32_t FLASHLOG_LastSequence;
+
+static void FLASHLOG_StartBlock(uint32_t ringSeq, uint64_t time, uint32_t sequence);
+static FLASHLOG_Err_TypeDef FLASHLOG_Queue(uint8_t flags);
+static void FLASHLOG_Service(void);
+static void FLASHLOG_Advance(uint32_t head);
+static void FLASHLOG_Quantize(const TELEMETRY_Snapshot_TypeDef *snap, int32_t *value);
+static int32_t FLASHLOG_Hold(int32_t raw, int32_t lsb, int32_t deadband, int32_t held);
+static uint16_t FLASHLOG_Encode(const FLASHLOG_Cursor_TypeDef *cursor,
+                                uint64_t time,
+                                uint32_t sequence,
+                                const int32_t *value,
+                                uint8_t *buf);
+static void FLASHLOG_PutHeader(uint8_t *data, const FLASHLOG_Header_TypeDef *header);
+static FLASHLOG_Err_TypeDef FLASHLOG_GetHeader(const uint8_t *data, FLASHLOG_Header_TypeDef *header);
+static uint16_t FLASHLOG_PutVarint(uint8_t *buf, uint32_t val);
+static FLASHLOG_Err_TypeDef FLASHLOG_GetVarint(FLASHLOG_Cursor_TypeDef *cursor, uint32_t *val);
+static uint32_t FLASHLOG_Zigzag(int32_t val);
+static int32_t FLASHLOG_Unzigzag(uint32_t val);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the FEE driver, find the head of the ring and restore the
+ *   encoder from its last checkpoint.
+ *
+ * @details
+ *   Call after TELEMETRY_Init. Takes a read of every block header and, if
+ *   the head block is a checkpoint, one decode of that block. A checkpoint
+ *   that does not decode to the end is cut at the last good record.
+ *
+ * @return
+ *   Returns 0 if no error. Nothing is logged if the FEE did not start.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_Init(void)
+{
+  FLASHLOG_Header_TypeDef header;
+  uint8_t raw[FLASHLOG_HEADER_SIZE];
+  uint32_t ringSeq[FLASHLOG_NUM_BLOCKS];
+  uint32_t valid = 0U;
+  uint32_t head = 0U;
+  uint32_t i;
+
+  memset(&FLASHLOG_State, 0, sizeof(FLASHLOG_State));
+  memset(FLASHLOG_Index, 0, sizeof(FLASHLOG_Index));
+  FLASHLOG_Ready = 0U;
+  FLASHLOG_WriteState = FLASHLOG_WRITE_FREE;
+  FLASHLOG_SinceCheckpoint = 0U;
+
+  if ( PORT_FEE_Init() != PORT_FEE_Err_NoError )
+  {
+    return FLASHLOG_Err_Flash;
+  }
+
+  /* A block counts if its header is sound and it sits at its ring position */
+  for ( i = 0U; i < FLASHLOG_NUM_BLOCKS; i++ )
+  {
+    if ( PORT_FEE_Read((uint16_t)(FLASHLOG_FIRST_BLOCK + i), 0U, raw, FLASHLOG_HEADER_SIZE) != PORT_FEE_Err_NoError
+      || FLASHLOG_GetHeader(raw, &header) != FLASHLOG_Err_NoError
+      || (header.ringSeq % FLASHLOG_NUM_BLOCKS) != i )
+    {
+      continue;
+    }
+
+    ringSeq[i] = header.ringSeq;
+    FLASHLOG_Index[i].ringSeq = header.ringSeq;
+    FLASHLOG_Index[i].sequence = header.sequence;
+    FLASHLOG_Index[i].time = header.time;
+    FLASHLOG_Index[i].records = header.records;
+
+    if ( !valid || header.ringSeq > head )
+    {
+      head = header.ringSeq;
+    }
+    valid |= 1UL << i;
+  }
+
+  if ( !valid )
+  {
+    FLASHLOG_StartBlock(0U, 0U, 0U);
+  }
+  else if ( PORT_FEE_Read((uint16_t)(FLASHLOG_FIRST_BLOCK + head % FLASHLOG_NUM_BLOCKS), 0U,
+                          FLASHLOG_Active, FLASHLOG_BLOCK_SIZE) == PORT_FEE_Err_NoError
+         && FLASHLOG_GetHeader(FLASHLOG_Active, &header) == FLASHLOG_Err_NoError
+         && (header.flags & FLASHLOG_FLAG_PARTIAL) )
+  {
+    /* Replay the checkpoint to restore the previous record and the deadband */
+    (void)FLASHLOG_CursorInit(&FLASHLOG_Probe, FLASHLOG_Active);
+    FLASHLOG_Writer = FLASHLOG_Probe;
+    while ( FLASHLOG_CursorNext(&FLASHLOG_Probe, &FLASHLOG_Scratch) == FLASHLOG_Err_NoError )
+    {
+      FLASHLOG_Writer = FLASHLOG_Probe;
+    }
+
+    FLASHLOG_Writer.header.records = FLASHLOG_Writer.index;
+    FLASHLOG_Writer.header.length = (uint16_t)(FLASHLOG_Writer.pos - FLASHLOG_HEADER_SIZE);
+    memset(&FLASHLOG_Active[FLASHLOG_Writer.pos], 0, FLASHLOG_BLOCK_SIZE - FLASHLOG_Writer.pos);
+    memcpy(FLASHLOG_Held, FLASHLOG_Writer.value, sizeof(FLASHLOG_Held));
+
+    FLASHLOG_Index[head % FLASHLOG_NUM_BLOCKS].records = FLASHLOG_Writer.index;
+
+    FLASHLOG_State.resumed = FLASHLOG_Writer.index;
+    FLASHLOG_State.lastSequence = FLASHLOG_Writer.sequence;
+  }
+  else
+  {
+    FLASHLOG_StartBlock(head + 1U, 0U, 0U);
+  }
+
+  FLASHLOG_State.head = FLASHLOG_Writer.header.ringSeq;
+  FLASHLOG_State.tail = FLASHLOG_State.head;
+  for ( i = 0U; i < FLASHLOG_NUM_BLOCKS; i++ )
+  {
+    if ( (valid & (1UL << i)) && ringSeq[i] < FLASHLOG_State.tail
+      && FLASHLOG_State.head - ringSeq[i] < FLASHLOG_NUM_BLOCKS )
+    {
+      FLASHLOG_State.tail = ringSeq[i];
+    }
+  }
+
+  FLASHLOG_LastTimestamp = TELEMETRY_GetSnapshot()->timestamp;
+  FLASHLOG_LastSequence = TELEMETRY_GetSnapshot()->sequence;
+  FLASHLOG_Ready = 1U;
+
+  return FLASHLOG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Log the latest telemetry snapshot if it is new and progress the flash
+ *   write. Call every FLASHLOG_PERIOD from a task.
+ ******************************************************************************/
+void FLASHLOG_Update(void)
+{
+  const TELEMETRY_Snapshot_TypeDef *snap = TELEMETRY_GetSnapshot();
+
+  if ( FLASHLOG_Ready
+    && (snap->timestamp != FLASHLOG_LastTimestamp || snap->sequence != FLASHLOG_LastSequence) )
+  {
+    FLASHLOG_LastTimestamp = snap->timestamp;
+    FLASHLOG_LastSequence = snap->sequence;
+    (void)FLASHLOG_Append(snap);
+  }
+
+  FLASHLOG_Service();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Append a snapshot to the active block.
+ *
+ * @details
+ *   A record that does not fit seals the block: it is queued for writing
+ *   and a new block starts with this record. If the previous block is still
+ *   being written the record is dropped and counted, the block seals on
+ *   the next append.
+ *
+ * @param[in] snap
+ *   Snapshot to log. Its RTC time is stored, the scheduler tick is not.
+ *
+ * @return
+ *   Returns 0 if the record was logged.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_Append(const TELEMETRY_Snapshot_TypeDef *snap)
+{
+  FLASHLOG_Cursor_TypeDef *w = &FLASHLOG_Writer;
+  FLASHLOG_Err_TypeDef ret = FLASHLOG_Err_NoError;
+  int32_t value[FLASHLOG_NUM_VALUES];
+  uint64_t time = snap->time / FLASHLOG_TIME_UNIT;
+  uint16_t length;
+
+  if ( !FLASHLOG_Ready )
+  {
+    return FLASHLOG_Err_Invalid;
+  }
+
+  PROFILE_BEGIN(PROFILE_Scope_LogAppend);
+
+  FLASHLOG_Quantize(snap, value);
+
+  /* The first record of a block takes its time and sequence from the header */
+  if ( w->index == 0U )
+  {
+    FLASHLOG_StartBlock(w->header.ringSeq, time, snap->sequence);
+  }
+
+  length = FLASHLOG_Encode(w, time, snap->sequence, value, FLASHLOG_Record);
+
+  if ( length == 0U || w->pos + length > FLASHLOG_BLOCK_SIZE )
+  {
+    if ( FLASHLOG_Queue(0U) != FLASHLOG_Err_NoError )
+    {
+      FLASHLOG_State.dropped++;
+      ret = FLASHLOG_Err_Busy;
+    }
+    else
+    {
+      FLASHLOG_State.blocks++;
+      FLASHLOG_SinceCheckpoint = 0U;
+      FLASHLOG_Advance(w->header.ringSeq + 1U);
+      FLASHLOG_StartBlock(w->header.ringSeq + 1U, time, snap->sequence);
+      length = FLASHLOG_Encode(w, time, snap->sequence, value, FLASHLOG_Record);
+    }
+  }
+
+  if ( ret == FLASHLOG_Err_NoError )
+  {
+    /* Commit, the cursor now stands after this record */
+    memcpy(&FLASHLOG_Active[w->pos], FLASHLOG_Record, length);
+    w->pos += length;
+    w->index++;
+    w->time = time;
+    w->sequence = snap->sequence;
+    memcpy(w->value, value, sizeof(w->value));
+    w->header.records = w->index;
+    w->header.length = (uint16_t)(w->pos - FLASHLOG_HEADER_SIZE);
+    FLASHLOG_Index[w->header.ringSeq % FLASHLOG_NUM_BLOCKS].records = w->index;
+
+    FLASHLOG_State.records++;
+    FLASHLOG_State.bytes += length;
+    FLASHLOG_State.lastSequence = snap->sequence;
+
+    if ( ++FLASHLOG_SinceCheckpoint >= FLASHLOG_CHECKPOINT )
+    {
+      (void)FLASHLOG_Flush();
+    }
+  }
+
+  PROFILE_END(PROFILE_Scope_LogAppend);
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Queue a checkpoint of the active block.
+ *
+ * @details
+ *   The block is written flagged partial and rewritten in place at the next
+ *   checkpoint or when it seals. Call before a planned reset.
+ *
+ * @return
+ *   Returns 0 if queued or nothing to write, FLASHLOG_Err_Busy if another
+ *   block is being written.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_Flush(void)
+{
+  FLASHLOG_Err_TypeDef ret;
+
+  if ( !FLASHLOG_Ready || FLASHLOG_Writer.index == 0U )
+  {
+    return FLASHLOG_Err_NoError;
+  }
+
+  ret = FLASHLOG_Queue(FLASHLOG_FLAG_PARTIAL);
+  if ( ret == FLASHLOG_Err_NoError )
+  {
+    FLASHLOG_State.checkpoints++;
+    FLASHLOG_SinceCheckpoint = 0U;
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy a block of the ring, header included.
+ *
+ * @details
+ *   The head block comes from RAM with the records logged so far, a block
+ *   waiting for its write from the write buffer, others from flash.
+ *
+ * @param[in] ringSeq
+ *   Ring sequence number, from the tail to the head of FLASHLOG_GetState.
+ *
+ * @param[out] data
+ *   Buffer of FLASHLOG_BLOCK_SIZE bytes.
+ *
+ * @return
+ *   Returns 0 if no error, FLASHLOG_Err_Busy if the flash is busy.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_ReadBlock(uint32_t ringSeq, uint8_t *data)
+{
+  FLASHLOG_Header_TypeDef header;
+  PORT_FEE_Err_TypeDef err;
+
+  if ( !FLASHLOG_Ready || ringSeq < FLASHLOG_State.tail || ringSeq > FLASHLOG_State.head )
+  {
+    return FLASHLOG_Err_Invalid;
+  }
+
+  if ( ringSeq == FLASHLOG_State.head )
+  {
+    header = FLASHLOG_Writer.header;
+    header.flags |= FLASHLOG_FLAG_PARTIAL;
+    memcpy(data, FLASHLOG_Active, FLASHLOG_BLOCK_SIZE);
+    FLASHLOG_PutHeader(data, &header);
+    return (header.records > 0U) ? FLASHLOG_Err_NoError : FLASHLOG_Err_Invalid;
+  }
+
+  if ( FLASHLOG_WriteState != FLASHLOG_WRITE_FREE && FLASHLOG_WriteSeq == ringSeq )
+  {
+    memcpy(data, FLASHLOG_Pending, FLASHLOG_BLOCK_SIZE);
+    return FLASHLOG_Err_NoError;
+  }
+
+  err = PORT_FEE_Read((uint16_t)(FLASHLOG_FIRST_BLOCK + ringSeq % FLASHLOG_NUM_BLOCKS), 0U,
+                      data, FLASHLOG_BLOCK_SIZE);
+  if ( err == PORT_FEE_Err_Busy )
+  {
+    return FLASHLOG_Err_Busy;
+  }
+  if ( err != PORT_FEE_Err_NoError )
+  {
+    return FLASHLOG_Err_Flash;
+  }
+
+  if ( FLASHLOG_GetHeader(data, &header) != FLASHLOG_Err_NoError || header.ringSeq != ringSeq )
+  {
+    return FLASHLOG_Err_Invalid;
+  }
+
+  return FLASHLOG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Position a cursor on the first record of a block.
+ *
+ * @param[out] cursor
+ *   Cursor to set up.
+ *
+ * @param[in] data
+ *   Block as returned by FLASHLOG_ReadBlock. Must stay valid while the
+ *   cursor is used.
+ *
+ * @return
+ *   Returns 0 if no error, FLASHLOG_Err_Invalid if the header is not sound.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_CursorInit(FLASHLOG_Cursor_TypeDef *cursor,
+                                         const uint8_t *data)
+{
+  FLASHLOG_Err_TypeDef ret;
+
+  ret = FLASHLOG_GetHeader(data, &cursor->header);
+
+  cursor->data = data;
+  cursor->pos = FLASHLOG_HEADER_SIZE;
+  cursor->index = 0U;
+  cursor->time = cursor->header.time - FLASHLOG_INTERVAL;
+  cursor->sequence = cursor->header.sequence - 1U;
+  memset(cursor->value, 0, sizeof(cursor->value));
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode the next record of a block.
+ *
+ * @details
+ *   Values come back at the log LSB: within the deadband plus half an LSB
+ *   of what was logged. The snapshot timestamp is zero.
+ *
+ * @param[in,out] cursor
+ *   Cursor from FLASHLOG_CursorInit.
+ *
+ * @param[out] snap
+ *   Decoded record.
+ *
+ * @return
+ *   Returns 0 if a record was decoded, FLASHLOG_Err_End after the last one.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_CursorNext(FLASHLOG_Cursor_TypeDef *cursor,
+                                         TELEMETRY_Snapshot_TypeDef *snap)
+{
+  uint32_t token;
+  uint32_t step = 1U;
+  uint32_t k = 0U;
+  int32_t dt;
+  uint32_t i;
+
+  if ( cursor->index >= cursor->header.records )
+  {
+    return FLASHLOG_Err_End;
+  }
+
+  /* Time step less the interval, then the sequence step if it is not one */
+  if ( FLASHLOG_GetVarint(cursor, &token) != FLASHLOG_Err_NoError )
+  {
+    return FLASHLOG_Err_Corrupt;
+  }
+  dt = FLASHLOG_Unzigzag(token >> 1);
+  if ( (token & 1U) && FLASHLOG_GetVarint(cursor, &step) != FLASHLOG_Err_NoError )
+  {
+    return FLASHLOG_Err_Corrupt;
+  }
+  if ( token & 1U )
+  {
+    step = (uint32_t)FLASHLOG_Unzigzag(step);
+  }
+
+  /* Changes and runs of unchanged values */
+  while ( k < FLASHLOG_NUM_VALUES )
+  {
+    if ( FLASHLOG_GetVarint(cursor, &token) != FLASHLOG_Err_NoError )
+    {
+      return FLASHLOG_Err_Corrupt;
+    }
+
+    if ( token & 1U )
+    {
+      if ( (token >> 1) == 0U || (token >> 1) > FLASHLOG_NUM_VALUES - k )
+      {
+        return FLASHLOG_Err_Corrupt;
+      }
+      k += token >> 1;
+    }
+    else
+    {
+      cursor->value[k++] += FLASHLOG_Unzigzag(token >> 1);
+    }
+  }
+
+  cursor->time += (uint64_t)((int64_t)dt + FLASHLOG_INTERVAL);
+  cursor->sequence += step;
+  cursor->index++;
+
+  snap->timestamp = 0U;
+  snap->time = cursor->time * FLASHLOG_TIME_UNIT;
+  snap->sequence = cursor->sequence;
+  snap->errors = (uint32_t)cursor->value[FLASHLOG_ERRORS];
+  snap->tempErrors = (uint32_t)cursor->value[FLASHLOG_TEMP_ERRORS];
+  snap->adcFlags = 0U;                              /* Not logged */
+  for ( i = 0U; i < TELEMETRY_NUM_CHANNELS; i++ )
+  {
+    snap->meas[i].voltage = cursor->value[FLASHLOG_VOLTAGE(i)] * FLASHLOG_LSB_VOLTAGE;
+    snap->meas[i].current = cursor->value[FLASHLOG_CURRENT(i)] * FLASHLOG_LSB_CURRENT;
+  }
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    snap->temp[i] = cursor->value[FLASHLOG_TEMP(i)] * FLASHLOG_LSB_TEMP;
+  }
+
+  return FLASHLOG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the index entry of a block.
+ *
+ * @param[in] ringSeq
+ *   Ring sequence number.
+ *
+ * @return
+ *   Returns the entry, 0 if the block is not in the ring or holds no
+ *   records.
+ ******************************************************************************/
+const FLASHLOG_Index_TypeDef *FLASHLOG_GetIndex(uint32_t ringSeq)
+{
+  const FLASHLOG_Index_TypeDef *entry = &FLASHLOG_Index[ringSeq % FLASHLOG_NUM_BLOCKS];
+
+  if ( !FLASHLOG_Ready || ringSeq < FLASHLOG_State.tail || ringSeq > FLASHLOG_State.head
+    || entry->ringSeq != ringSeq || entry->records == 0U )
+  {
+    return 0;
+  }
+
+  return entry;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Find the block that holds a time.
+ *
+ * @details
+ *   The newest block whose first record is not later than the time. The
+ *   ring is short, so the index is scanned from the head rather than
+ *   searched, which also steps over blocks lost to a failed write.
+ *
+ * @param[in] time
+ *   Time in us since 2000.
+ *
+ * @param[out] ringSeq
+ *   Ring sequence number of the block, the oldest block if the time is
+ *   before the log.
+ *
+ * @return
+ *   Returns 0 if no error, FLASHLOG_Err_Invalid if the log is empty.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_FindBlock(uint64_t time, uint32_t *ringSeq)
+{
+  const FLASHLOG_Index_TypeDef *entry;
+  uint64_t t = time / FLASHLOG_TIME_UNIT;
+  uint8_t found = 0U;
+  uint32_t r;
+
+  if ( !FLASHLOG_Ready )
+  {
+    return FLASHLOG_Err_Invalid;
+  }
+
+  for ( r = FLASHLOG_State.head + 1U; r-- > FLASHLOG_State.tail; )
+  {
+    entry = FLASHLOG_GetIndex(r);
+    if ( entry == 0 )
+    {
+      continue;
+    }
+
+    *ringSeq = r;
+    found = 1U;
+    if ( entry->time <= t )
+    {
+      break;
+    }
+  }
+
+  return found ? FLASHLOG_Err_NoError : FLASHLOG_Err_Invalid;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start a time range query.
+ *
+ * @param[out] query
+ *   Query to set up.
+ *
+ * @param[in] from
+ *   Start of the range in us since 2000.
+ *
+ * @param[in] to
+ *   End of the range in us since 2000, inclusive.
+ *
+ * @return
+ *   Returns 0 if no error, FLASHLOG_Err_Invalid if the log is empty.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_QueryStart(FLASHLOG_Query_TypeDef *query,
+                                         uint64_t from,
+                                         uint64_t to)
+{
+  query->from = from;
+  query->to = to;
+  query->open = 0U;
+  query->blocks = 0U;
+  query->records = 0U;
+
+  return FLASHLOG_FindBlock(from, &query->ringSeq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the next record of a time range query.
+ *
+ * @details
+ *   Reads a block from flash only when the previous one is used up, and
+ *   stops at the first block that starts after the range. Records before
+ *   the range in the first block are decoded and skipped. Blocks that
+ *   cannot be read or decoded are skipped.
+ *
+ * @param[in,out] query
+ *   Query from FLASHLOG_QueryStart.
+ *
+ * @param[out] snap
+ *   Next record in the range.
+ *
+ * @return
+ *   Returns 0 if a record was decoded, FLASHLOG_Err_End after the last one,
+ *   FLASHLOG_Err_Busy if the flash is busy; call again later.
+ ******************************************************************************/
+FLASHLOG_Err_TypeDef FLASHLOG_QueryNext(FLASHLOG_Query_TypeDef *query,
+                                        TELEMETRY_Snapshot_TypeDef *snap)
+{
+  const FLASHLOG_Index_TypeDef *entry;
+  FLASHLOG_Err_TypeDef err;
+
+  while ( 1 )
+  {
+    if ( !query->open )
+    {
+      /* The ring may have moved on while the query waited */
+      if ( query->ringSeq < FLASHLOG_State.tail )
+      {
+        query->ringSeq = FLASHLOG_State.tail;
+      }
+      if ( !FLASHLOG_Ready || query->ringSeq > FLASHLOG_State.head )
+      {
+        return FLASHLOG_Err_End;
+      }
+
+      entry = FLASHLOG_GetIndex(query->ringSeq);
+      if ( entry == 0 )
+      {
+        query->ringSeq++;
+        continue;
+      }
+      if ( entry->time * FLASHLOG_TIME_UNIT > query->to )
+      {
+        return FLASHLOG_Err_End;
+      }
+
+      err = FLASHLOG_ReadBlock(query->ringSeq, query->data);
+      if ( err == FLASHLOG_Err_Busy )
+      {
+        return err;
+      }
+      if ( err != FLASHLOG_Err_NoError
+        || FLASHLOG_CursorInit(&query->cursor, query->data) != FLASHLOG_Err_NoError )
+      {
+        query->ringSeq++;
+        continue;
+      }
+
+      query->open = 1U;
+      query->blocks++;
+    }
+
+    if ( FLASHLOG_CursorNext(&query->cursor, snap) != FLASHLOG_Err_NoError )
+    {
+      query->open = 0U;
+      query->ringSeq++;
+      continue;
+    }
+
+    if ( snap->time > query->to )
+    {
+      return FLASHLOG_Err_End;
+    }
+    if ( snap->time >= query->from )
+    {
+      query->records++;
+      return FLASHLOG_Err_NoError;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the ring position and statistics.
+ ******************************************************************************/
+const FLASHLOG_State_TypeDef *FLASHLOG_GetState(void)
+{
+  return &FLASHLOG_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the statistics. The log itself is kept.
+ ******************************************************************************/
+void FLASHLOG_ResetStats(void)
+{
+  FLASHLOG_State.records = 0U;
+  FLASHLOG_State.bytes = 0U;
+  FLASHLOG_State.blocks = 0U;
+  FLASHLOG_State.checkpoints = 0U;
+  FLASHLOG_State.writeErrors = 0U;
+  FLASHLOG_State.dropped = 0U;
+  FLASHLOG_State.resumed = 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the ring position, the bytes per record and the history the ring
+ *   holds at that density.
+ *
+ * @param[in] uart
+ *   UART to print to.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef FLASHLOG_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const FLASHLOG_State_TypeDef *s = &FLASHLOG_State;
+  uint64_t retention = 0U;
+  uint64_t perRing;
+
+  if ( !FLASHLOG_Ready )
+  {
+    return PRINT_PrintStringln(uart,"NO FLASH");
+  }
+
+  /* Minutes of records the full blocks of the ring hold */
+  if ( s->bytes > 0U )
+  {
+    perRing = (uint64_t)(FLASHLOG_NUM_BLOCKS - 1U) * FLASHLOG_PAYLOAD_SIZE * s->records / s->bytes;
+    retention = perRing * FLASHLOG_INTERVAL * FLASHLOG_TIME_UNIT / 60000000U;
+  }
+
+  PRINT_PrintString(uart,"HEAD=");
+  PRINT_FormatUInt(buf,s->head);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TAIL=");
+  PRINT_FormatUInt(buf,s->tail);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," FILL=");
+  PRINT_FormatUInt(buf,FLASHLOG_Writer.header.length);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," RECORDS=");
+  PRINT_FormatUInt(buf,s->records);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," B/REC=");
+  PRINT_FormatFixed(buf,(s->records > 0U) ? (int32_t)((uint64_t)s->bytes * 100U / s->records) : 0,2U,2U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," RETENTION=");
+  PRINT_FormatUInt(buf,(uint32_t)retention);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," min BLOCKS=");
+  PRINT_FormatUInt(buf,s->blocks);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," CHECKPOINTS=");
+  PRINT_FormatUInt(buf,s->checkpoints);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," RESUMED=");
+  PRINT_FormatUInt(buf,s->resumed);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," DROPPED=");
+  PRINT_FormatUInt(buf,s->dropped);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," WRITE_ERRORS=");
+  PRINT_FormatUInt(buf,s->writeErrors);
+
+  return PRINT_PrintStringln(uart,buf);
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Empty the active block and set up the encoder for its first record.
+ ******************************************************************************/
+static void FLASHLOG_StartBlock(uint32_t ringSeq, uint64_t time, uint32_t sequence)
+{
+  FLASHLOG_Cursor_TypeDef *w = &FLASHLOG_Writer;
+
+  memset(FLASHLOG_Active, 0, sizeof(FLASHLOG_Active));
+
+  w->header.magic = FLASHLOG_MAGIC;
+  w->header.version = FLASHLOG_VERSION;
+  w->header.flags = 0U;
+  w->header.ringSeq = ringSeq;
+  w->header.sequence = sequence;
+  w->header.time = time;
+  w->header.records = 0U;
+  w->header.length = 0U;
+
+  FLASHLOG_Index[ringSeq % FLASHLOG_NUM_BLOCKS].ringSeq = ringSeq;
+  FLASHLOG_Index[ringSeq % FLASHLOG_NUM_BLOCKS].sequence = sequence;
+  FLASHLOG_Index[ringSeq % FLASHLOG_NUM_BLOCKS].time = time;
+  FLASHLOG_Index[ringSeq % FLASHLOG_NUM_BLOCKS].records = 0U;
+
+  w->data = FLASHLOG_Active;
+  w->pos = FLASHLOG_HEADER_SIZE;
+  w->index = 0U;
+  w->time = time - FLASHLOG_INTERVAL;
+  w->sequence = sequence - 1U;
+  memset(w->value, 0, sizeof(w->value));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy the active block to the write buffer and queue its write.
+ *
+ * @details
+ *   A checkpoint of the same block still waiting for the flash is
+ *   replaced.
+ ******************************************************************************/
+static FLASHLOG_Err_TypeDef FLASHLOG_Queue(uint8_t flags)
+{
+  FLASHLOG_Cursor_TypeDef *w = &FLASHLOG_Writer;
+
+  if ( FLASHLOG_WriteState == FLASHLOG_WRITE_BUSY
+    || (FLASHLOG_WriteState == FLASHLOG_WRITE_QUEUED && FLASHLOG_WriteSeq != w->header.ringSeq) )
+  {
+    return FLASHLOG_Err_Busy;
+  }
+
+  w->header.flags = flags;
+  FLASHLOG_PutHeader(FLASHLOG_Active, &w->header);
+  memcpy(FLASHLOG_Pending, FLASHLOG_Active, FLASHLOG_BLOCK_SIZE);
+
+  FLASHLOG_WriteBlock = (uint16_t)(FLASHLOG_FIRST_BLOCK + w->header.ringSeq % FLASHLOG_NUM_BLOCKS);
+  FLASHLOG_WriteSeq = w->header.ringSeq;
+  FLASHLOG_WriteState = FLASHLOG_WRITE_QUEUED;
+
+  return FLASHLOG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Progress the FEE, start a queued write when it is idle and collect the
+ *   result of a finished one.
+ ******************************************************************************/
+static void FLASHLOG_Service(void)
+{
+  PORT_FEE_Err_TypeDef err;
+  uint32_t i;
+
+  for ( i = 0U; i < FLASHLOG_MAIN_CALLS && PORT_FEE_Busy(); i++ )
+  {
+    PORT_FEE_MainFunction();
+  }
+
+  if ( PORT_FEE_Busy() )
+  {
+    return;
+  }
+
+  if ( FLASHLOG_WriteState == FLASHLOG_WRITE_BUSY )
+  {
+    if ( PORT_FEE_GetResult() != PORT_FEE_Err_NoError )
+    {
+      FLASHLOG_State.writeErrors++;
+    }
+    FLASHLOG_WriteState = FLASHLOG_WRITE_FREE;
+  }
+  else if ( FLASHLOG_WriteState == FLASHLOG_WRITE_QUEUED )
+  {
+    err = PORT_FEE_WriteAsync(FLASHLOG_WriteBlock, FLASHLOG_Pending);
+    if ( err == PORT_FEE_Err_NoError )
+    {
+      FLASHLOG_WriteState = FLASHLOG_WRITE_BUSY;
+    }
+    else if ( err != PORT_FEE_Err_Busy )
+    {
+      FLASHLOG_State.writeErrors++;
+      FLASHLOG_WriteState = FLASHLOG_WRITE_FREE;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Move the head of the ring, the oldest block goes once its slot is
+ *   reused.
+ ******************************************************************************/
+static void FLASHLOG_Advance(uint32_t head)
+{
+  FLASHLOG_State.head = head;
+  if ( head - FLASHLOG_State.tail >= FLASHLOG_NUM_BLOCKS )
+  {
+    FLASHLOG_State.tail = head - FLASHLOG_NUM_BLOCKS + 1U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Quantize every field of a snapshot to its log LSB.
+ ******************************************************************************/
+static void FLASHLOG_Quantize(const TELEMETRY_Snapshot_TypeDef *snap, int32_t *value)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < TELEMETRY_NUM_CHANNELS; i++ )
+  {
+    value[FLASHLOG_VOLTAGE(i)] = FLASHLOG_Hold(snap->meas[i].voltage, FLASHLOG_LSB_VOLTAGE,
+                                               FLASHLOG_DEADBAND_VOLTAGE, FLASHLOG_Held[FLASHLOG_VOLTAGE(i)]);
+    value[FLASHLOG_CURRENT(i)] = FLASHLOG_Hold(snap->meas[i].current, FLASHLOG_LSB_CURRENT,
+                                               FLASHLOG_DEADBAND_CURRENT, FLASHLOG_Held[FLASHLOG_CURRENT(i)]);
+  }
+
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    value[FLASHLOG_TEMP(i)] = FLASHLOG_Hold(snap->temp[i], FLASHLOG_LSB_TEMP,
+                                            FLASHLOG_DEADBAND_TEMP, FLASHLOG_Held[FLASHLOG_TEMP(i)]);
+  }
+
+  value[FLASHLOG_ERRORS] = (int32_t)(snap->errors & ((1UL << TELEMETRY_NUM_CHANNELS) - 1U));
+  value[FLASHLOG_TEMP_ERRORS] = (int32_t)(snap->tempErrors & ((1UL << TELEMETRY_NUM_TEMPS) - 1U));
+
+  memcpy(FLASHLOG_Held, value, sizeof(FLASHLOG_Held));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Round a reading to the log LSB, keeping the last logged value while the
+ *   reading stays within the deadband of it.
+ ******************************************************************************/
+static int32_t FLASHLOG_Hold(int32_t raw, int32_t lsb, int32_t deadband, int32_t held)
+{
+  int64_t q = ((int64_t)raw + ((raw >= 0) ? lsb / 2 : -(lsb / 2))) / lsb;
+
+  if ( q > FLASHLOG_VALUE_MAX )
+  {
+    q = FLASHLOG_VALUE_MAX;
+  }
+  else if ( q < -FLASHLOG_VALUE_MAX )
+  {
+    q = -FLASHLOG_VALUE_MAX;
+  }
+
+  if ( q - held <= deadband && held - q <= deadband )
+  {
+    return held;
+  }
+
+  return (int32_t)q;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Encode a record against the one the cursor stands after.
+ *
+ * @return
+ *   Returns the record length, 0 if the time step is too large for a
+ *   record.
+ ******************************************************************************/
+static uint16_t FLASHLOG_Encode(const FLASHLOG_Cursor_TypeDef *cursor,
+                                uint64_t time,
+                                uint32_t sequence,
+                                const int32_t *value,
+                                uint8_t *buf)
+{
+  int64_t dt = (int64_t)(time - cursor->time) - FLASHLOG_INTERVAL;
+  uint32_t step = sequence - cursor->sequence;
+  uint32_t run = 0U;
+  uint16_t n = 0U;
+  int32_t delta;
+  uint32_t k;
+
+  if ( dt > FLASHLOG_MAX_STEP || dt < -FLASHLOG_MAX_STEP )
+  {
+    return 0U;
+  }
+
+  n += FLASHLOG_PutVarint(&buf[n], (FLASHLOG_Zigzag((int32_t)dt) << 1) | ((step != 1U) ? 1U : 0U));
+  if ( step != 1U )
+  {
+    n += FLASHLOG_PutVarint(&buf[n], FLASHLOG_Zigzag((int32_t)step));
+  }
+
+  for ( k = 0U; k < FLASHLOG_NUM_VALUES; k++ )
+  {
+    delta = value[k] - cursor->value[k];
+
+    if ( delta == 0 )
+    {
+      run++;
+      continue;
+    }
+
+    if ( run > 0U )
+    {
+      n += FLASHLOG_PutVarint(&buf[n], (run << 1) | 1U);
+      run = 0U;
+    }
+    n += FLASHLOG_PutVarint(&buf[n], FLASHLOG_Zigzag(delta) << 1);
+  }
+
+  if ( run > 0U )
+  {
+    n += FLASHLOG_PutVarint(&buf[n], (run << 1) | 1U);
+  }
+
+  return n;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Store a block header, little endian.
+ ******************************************************************************/
+static void FLASHLOG_PutHeader(uint8_t *data, const FLASHLOG_Header_TypeDef *header)
+{
+  uint32_t i;
+
+  data[0] = (uint8_t)header->magic;
+  data[1] = (uint8_t)(header->magic >> 8);
+  data[2] = header->version;
+  data[3] = header->flags;
+  for ( i = 0U; i < 4U; i++ )
+  {
+    data[4U + i] = (uint8_t)(header->ringSeq >> (8U * i));
+    data[8U + i] = (uint8_t)(header->sequence >> (8U * i));
+  }
+  for ( i = 0U; i < 8U; i++ )
+  {
+    data[12U + i] = (uint8_t)(header->time >> (8U * i));
+  }
+  data[20] = (uint8_t)header->records;
+  data[21] = (uint8_t)(header->records >> 8);
+  data[22] = (uint8_t)header->length;
+  data[23] = (uint8_t)(header->length >> 8);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Load and check a block header.
+ ******************************************************************************/
+static FLASHLOG_Err_TypeDef FLASHLOG_GetHeader(const uint8_t *data, FLASHLOG_Header_TypeDef *header)
+{
+  uint32_t i;
+
+  header->magic = (uint16_t)(data[0] | ((uint16_t)data[1] << 8));
+  header->version = data[2];
+  header->flags = data[3];
+  header->ringSeq = 0U;
+  header->sequence = 0U;
+  header->time = 0U;
+  for ( i = 0U; i < 4U; i++ )
+  {
+    header->ringSeq |= (uint32_t)data[4U + i] << (8U * i);
+    header->sequence |= (uint32_t)data[8U + i] << (8U * i);
+  }
+  for ( i = 0U; i < 8U; i++ )
+  {
+    header->time |= (uint64_t)data[12U + i] << (8U * i);
+  }
+  header->records = (uint16_t)(data[20] | ((uint16_t)data[21] << 8));
+  header->length = (uint16_t)(data[22] | ((uint16_t)data[23] << 8));
+
+  if ( header->magic != FLASHLOG_MAGIC || header->version != FLASHLOG_VERSION
+    || header->length > FLASHLOG_PAYLOAD_SIZE || header->records > header->length )
+  {
+    return FLASHLOG_Err_Invalid;
+  }
+
+  return FLASHLOG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Store an unsigned varint, 7 bits per byte, low bits first.
+ *
+ * @return
+ *   Returns the number of bytes, 1 to 5.
+ ******************************************************************************/
+static uint16_t FLASHLOG_PutVarint(uint8_t *buf, uint32_t val)
+{
+  uint16_t n = 0U;
+
+  while ( val >= 0x80U )
+  {
+    buf[n++] = (uint8_t)(val | 0x80U);
+    val >>= 7;
+  }
+  buf[n++] = (uint8_t)val;
+
+  return n;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Load an unsigned varint at the cursor and step over it.
+ ******************************************************************************/
+static FLASHLOG_Err_TypeDef FLASHLOG_GetVarint(FLASHLOG_Cursor_TypeDef *cursor, uint32_t *val)
+{
+  uint16_t end = (uint16_t)(FLASHLOG_HEADER_SIZE + cursor->header.length);
+  uint32_t shift = 0U;
+  uint8_t byte;
+
+  *val = 0U;
+  do
+  {
+    if ( cursor->pos >= end || shift > 28U )
+    {
+      return FLASHLOG_Err_Corrupt;
+    }
+    byte = cursor->data[cursor->pos++];
+    *val |= (uint32_t)(byte & 0x7FU) << shift;
+    shift += 7U;
+  } while ( byte & 0x80U );
+
+  return FLASHLOG_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Map signed to unsigned so small magnitudes of either sign stay small.
+ ******************************************************************************/
+static uint32_t FLASHLOG_Zigzag(int32_t val)
+{
+  return ((uint32_t)val << 1) ^ (uint32_t)(val >> 31);
+}
+
+static int32_t FLASHLOG_Unzigzag(uint32_t val)
+{
+  return (int32_t)(val >> 1) ^ -(int32_t)(val & 1U);
+}
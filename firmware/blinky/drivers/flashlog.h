@@ -0,0 +1,270 @@
+/** @file flashlog.h
+*   @brief Telemetry Flash Log Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup FLASHLOG FLASHLOG
+ *  @brief Compressed ring log of telemetry snapshots in data flash.
+ *
+ *  Snapshots are appended to a RAM block of FLASHLOG_BLOCK_SIZE bytes. A
+ *  full block is sealed, copied to a second buffer and written to the next
+ *  FEE block of the ring in the background, so a sweep never waits for
+ *  flash. Blocks carry a ring sequence number that only increases; the
+ *  block written last is the one with the highest number, and the ring
+ *  position of a block is its number modulo FLASHLOG_NUM_BLOCKS.
+ *
+ *  Every value of the snapshot, bus voltage and current of each power
+ *  monitor, each temperature and the error masks, is quantized to a log
+ *  LSB with a deadband around the last logged value, then stored as the
+ *  difference to the previous record: zigzag varints for changes and a
+ *  single varint for a run of unchanged values. A record starts with the
+ *  time since the previous record, less the nominal interval, and the
+ *  sequence step if it is not one. Quiet channels cost a fraction of a
+ *  byte per record.
+ *
+ *  The first record of a block is coded against zero and against the
+ *  time and sequence in the block header, so every block decodes on its
+ *  own and a lost block costs only its own records.
+ *
+ *  The active block is also written as a checkpoint, flagged partial,
+ *  every FLASHLOG_CHECKPOINT records. At boot the ring is scanned, a
+ *  partial head block is decoded to restore the encoder and logging
+ *  continues in it, so a reset loses at most the records since the last
+ *  checkpoint.
+ *
+ *  A sparse index in RAM holds the time and sequence of the first record
+ *  of every block of the ring. It is rebuilt at boot from the block
+ *  headers alone, one short read per block, and kept up to date as blocks
+ *  are filled. A time range query looks up its first block in the index
+ *  and decodes only the blocks that overlap the range. Blocks are in time
+ *  order as long as the RTC is not set back; after that a query sees the
+ *  records from the block that the index search finds onwards.
+ *
+ *  The ring is the blocks FLASHLOG_FIRST_BLOCK onwards, FLASHLOG_NUM_BLOCKS
+ *  of them, of the HALCoGen FEE block configuration (see port_fee.h); the
+ *  last two blocks hold CONFIG.
+ *
+ *	Related Files
+ *   - flashlog.h
+ *   - flashlog.c
+ *   - port_fee.h
+ *   - telemetry.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_FLASHLOG_H_
+#define DRIVERS_FLASHLOG_H_
+
+#include "port_fee.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/*****************************************/
+//  Storage
+/*****************************************/
+
+/** First FEE block of the ring */
+#define FLASHLOG_FIRST_BLOCK      (1U)
+
+/** Number of FEE blocks in the ring */
+#define FLASHLOG_NUM_BLOCKS       (14U)
+
+/** Size of one FEE block in bytes */
+#define FLASHLOG_BLOCK_SIZE       (PORT_FEE_BLOCK_SIZE)
+
+/** Size of the block header in bytes */
+#define FLASHLOG_HEADER_SIZE      (24U)
+
+/** Record bytes per block */
+#define FLASHLOG_PAYLOAD_SIZE     (FLASHLOG_BLOCK_SIZE - FLASHLOG_HEADER_SIZE)
+
+#define FLASHLOG_MAGIC            (0x544CU)   /* "TL" */
+#define FLASHLOG_VERSION          (1U)
+
+/** Header flag of a checkpoint of a block still being filled */
+#define FLASHLOG_FLAG_PARTIAL     (0x01U)
+
+/*****************************************/
+//  Encoding
+/*****************************************/
+
+/** Time resolution of the log in us */
+#define FLASHLOG_TIME_UNIT        (10000U)
+
+/** Nominal time between records in time units */
+#define FLASHLOG_INTERVAL         (100U)
+
+/** Log LSB of the bus voltage in uV, current in uA and temperature in mC */
+#define FLASHLOG_LSB_VOLTAGE      (10000)
+#define FLASHLOG_LSB_CURRENT      (1000)
+#define FLASHLOG_LSB_TEMP         (100)
+
+/** Changes up to this many LSB from the last logged value are not logged */
+#define FLASHLOG_DEADBAND_VOLTAGE (1)
+#define FLASHLOG_DEADBAND_CURRENT (1)
+#define FLASHLOG_DEADBAND_TEMP    (1)
+
+/** Largest magnitude of a quantized value */
+#define FLASHLOG_VALUE_MAX        (0x0FFFFFFF)
+
+/** Values per record: voltages, currents, temperatures and two error masks */
+#define FLASHLOG_NUM_VALUES       (2U * TELEMETRY_NUM_CHANNELS + TELEMETRY_NUM_TEMPS + 2U)
+
+/** Longest encoded record in bytes */
+#define FLASHLOG_RECORD_MAX       (10U + 5U * FLASHLOG_NUM_VALUES)
+
+/*****************************************/
+//  Task
+/*****************************************/
+
+/** Period of the log task, which also progresses flash writes, in ticks */
+#define FLASHLOG_PERIOD           (SCHEDULER_MS(100))
+
+/** Records between checkpoints of the active block */
+#define FLASHLOG_CHECKPOINT       (600U)
+
+/**
+ *  @addtogroup FLASHLOG
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum FLASHLOG_Err_TypeDef
+*   @brief Alias names for FLASHLOG errors.
+*/
+typedef enum
+{
+  FLASHLOG_Err_NoError = 0U,      /**< No error*/
+  FLASHLOG_Err_Busy    = 1U,      /**< Write buffer or flash busy, try again*/
+  FLASHLOG_Err_Flash   = 2U,      /**< Flash access failed*/
+  FLASHLOG_Err_Invalid = 3U,      /**< Block not in the ring or header invalid*/
+  FLASHLOG_Err_Corrupt = 4U,      /**< Record does not decode*/
+  FLASHLOG_Err_End     = 5U       /**< No more records in the block*/
+} FLASHLOG_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct FLASHLOG_Header_TypeDef
+*   @brief Block header, stored little endian ahead of the records.
+*/
+typedef struct
+{
+  uint16_t magic;                 /**< FLASHLOG_MAGIC*/
+  uint8_t version;                /**< FLASHLOG_VERSION*/
+  uint8_t flags;                  /**< FLASHLOG_FLAG_PARTIAL*/
+  uint32_t ringSeq;               /**< Ring sequence number of the block*/
+  uint32_t sequence;              /**< Snapshot sequence of the first record*/
+  uint64_t time;                  /**< Time of the first record in time units*/
+  uint16_t records;               /**< Records in the block*/
+  uint16_t length;                /**< Record bytes in the block*/
+} FLASHLOG_Header_TypeDef;
+
+/** @struct FLASHLOG_Cursor_TypeDef
+*   @brief Position in a block and the values of the record before it.
+*/
+typedef struct
+{
+  const uint8_t *data;            /**< Block, header included*/
+  FLASHLOG_Header_TypeDef header; /**< Header of the block*/
+  uint16_t pos;                   /**< Offset of the next record*/
+  uint16_t index;                 /**< Index of the next record*/
+  uint64_t time;                  /**< Time of the last record in time units*/
+  uint32_t sequence;              /**< Sequence of the last record*/
+  int32_t value[FLASHLOG_NUM_VALUES]; /**< Quantized values of the last record*/
+} FLASHLOG_Cursor_TypeDef;
+
+/** @struct FLASHLOG_Index_TypeDef
+*   @brief Index entry of one block of the ring.
+*/
+typedef struct
+{
+  uint32_t ringSeq;               /**< Ring sequence number of the block*/
+  uint32_t sequence;              /**< Snapshot sequence of the first record*/
+  uint64_t time;                  /**< Time of the first record in time units*/
+  uint16_t records;               /**< Records in the block, 0 if empty*/
+} FLASHLOG_Index_TypeDef;
+
+/** @struct FLASHLOG_Query_TypeDef
+*   @brief Time range query, decoding one block at a time.
+*/
+typedef struct
+{
+  uint64_t from;                  /**< Start of the range in us since 2000*/
+  uint64_t to;                    /**< End of the range in us since 2000, inclusive*/
+  uint32_t ringSeq;               /**< Block being decoded or next to read*/
+  uint8_t open;                   /**< Set while the cursor is on a block*/
+  uint32_t blocks;                /**< Blocks decoded*/
+  uint32_t records;               /**< Records returned*/
+  FLASHLOG_Cursor_TypeDef cursor; /**< Position in the block*/
+  uint8_t data[FLASHLOG_BLOCK_SIZE]; /**< Copy of the block*/
+} FLASHLOG_Query_TypeDef;
+
+/** @struct FLASHLOG_State_TypeDef
+*   @brief Ring position and statistics.
+*/
+typedef struct
+{
+  uint32_t head;                  /**< Ring sequence of the block being filled*/
+  uint32_t tail;                  /**< Ring sequence of the oldest block kept*/
+  uint32_t records;               /**< Records logged since the statistics reset*/
+  uint32_t bytes;                 /**< Record bytes logged since the statistics reset*/
+  uint32_t blocks;                /**< Blocks sealed*/
+  uint32_t checkpoints;           /**< Partial block writes*/
+  uint32_t writeErrors;           /**< Flash writes that failed*/
+  uint32_t dropped;               /**< Records lost to a busy write buffer*/
+  uint32_t resumed;               /**< Records restored from a checkpoint at boot*/
+  uint32_t lastSequence;          /**< Snapshot sequence of the last record*/
+} FLASHLOG_State_TypeDef;
+
+FLASHLOG_Err_TypeDef FLASHLOG_Init(void);
+
+void FLASHLOG_Update(void);
+
+FLASHLOG_Err_TypeDef FLASHLOG_Append(const TELEMETRY_Snapshot_TypeDef *snap);
+
+FLASHLOG_Err_TypeDef FLASHLOG_Flush(void);
+
+FLASHLOG_Err_TypeDef FLASHLOG_ReadBlock(uint32_t ringSeq, uint8_t *data);
+
+FLASHLOG_Err_TypeDef FLASHLOG_CursorInit(FLASHLOG_Cursor_TypeDef *cursor,
+                                         const uint8_t *data);
+
+FLASHLOG_Err_TypeDef FLASHLOG_CursorNext(FLASHLOG_Cursor_TypeDef *cursor,
+                                         TELEMETRY_Snapshot_TypeDef *snap);
+
+const FLASHLOG_Index_TypeDef *FLASHLOG_GetIndex(uint32_t ringSeq);
+
+FLASHLOG_Err_TypeDef FLASHLOG_FindBlock(uint64_t time, uint32_t *ringSeq);
+
+FLASHLOG_Err_TypeDef FLASHLOG_QueryStart(FLASHLOG_Query_TypeDef *query,
+                                         uint64_t from,
+                                         uint64_t to);
+
+FLASHLOG_Err_TypeDef FLASHLOG_QueryNext(FLASHLOG_Query_TypeDef *query,
+                                        TELEMETRY_Snapshot_TypeDef *snap);
+
+const FLASHLOG_State_TypeDef *FLASHLOG_GetState(void);
+
+void FLASHLOG_ResetStats(void);
+
+PRINT_Err_TypeDef FLASHLOG_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_FLASHLOG_H_ */
@@ -0,0 +1,674 @@
+/** @file governor.c
+*   @brief Clock Governor Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "governor.h"
+#include "scheduler.h"
+#include "system.h"
+#include "sys_core.h"
+#include "sys_pmu.h"
+#include "rti.h"
+#include "sci.h"
+#include "i2c.h"
+#include "ad5324.h"
+#include "port_can.h"
+#include "print.h"
+#include "stdint.h"
+
+/* PLLCTL1 PLLDIV field */
+#define GOVERNOR_PLLDIV_MASK      (0x1F000000U)
+#define GOVERNOR_PLLDIV_SHIFT     (24U)
+
+/* CLKCNTL VCLKR and VCLK2R fields, CLK2CNTL VCLK3R field */
+#define GOVERNOR_VCLKR_MASK       (0x000F0000U)
+#define GOVERNOR_VCLKR_SHIFT      (16U)
+#define GOVERNOR_VCLK2R_MASK      (0x0F000000U)
+#define GOVERNOR_VCLK2R_SHIFT     (24U)
+#define GOVERNOR_VCLK3R_MASK      (0x00000F00U)
+#define GOVERNOR_VCLK3R_SHIFT     (8U)
+
+/* SCI transmitter empty and receiver busy flags */
+#define GOVERNOR_SCI_TX_EMPTY     (0x00000800U)
+#define GOVERNOR_SCI_RX_BUSY      (0x00000008U)
+
+/* RTI GCTRL counter enable bits of both blocks */
+#define GOVERNOR_RTI_COUNTERS     (0x00000003U)
+
+/* I2C module clock HALCoGen aims for, must stay within 6.7 to 13.3 MHz */
+#define GOVERNOR_I2C_MODULE_HZ    (8000000U)
+
+/** @struct GOVERNOR_Clock_TypeDef
+*   @brief Divider settings of a level. VCLK must divide 80 MHz by a power
+*          of two so the RTI prescalers stay integer.
+*/
+typedef struct
+{
+  uint32_t pllDiv;    /**< PLLCTL1 PLLDIV, HCLK = GOVERNOR_PLL_HZ / (pllDiv + 1)*/
+  uint32_t vclkDiv;   /**< VCLKR, VCLK = HCLK / (vclkDiv + 1)*/
+  uint32_t hclkHz;
+  uint32_t vclkHz;
+} GOVERNOR_Clock_TypeDef;
+
+static const GOVERNOR_Clock_TypeDef GOVERNOR_Clocks[GOVERNOR_NUM_LEVELS] =
+{
+  { 7U, 0U, GOVERNOR_PLL_HZ / 8U, GOVERNOR_PLL_HZ / 8U },
+  { 3U, 0U, GOVERNOR_PLL_HZ / 4U, GOVERNOR_PLL_HZ / 4U },
+  { 1U, 0U, GOVERNOR_PLL_HZ / 2U, GOVERNOR_PLL_HZ / 2U },
+  { 0U, 1U, GOVERNOR_PLL_HZ,      GOVERNOR_PLL_HZ / 2U }
+};
+
+const GOVERNOR_Params_TypeDef GOVERNOR_DefaultParams =
+{
+  800U,
+  500U,
+  10U,
+  GOVERNOR_Level_Min,
+  GOVERNOR_Level_Max
+};
+
+static const char * const GOVERNOR_LevelNames[GOVERNOR_NUM_LEVELS] =
+{
+  "MIN", "LOW", "MID", "MAX"
+};
+
+static GOVERNOR_Params_TypeDef GOVERNOR_Params;
+static GOVERNOR_Stats_TypeDef GOVERNOR_Stats;
+
+static volatile GOVERNOR_Level_TypeDef GOVERNOR_Level = GOVERNOR_Level_Max;
+static volatile uint8_t GOVERNOR_Floor[GOVERNOR_NUM_CLIENTS];
+
+static uint32_t GOVERNOR_Hold = 0U;
+static uint32_t GOVERNOR_LastCounter = 0U;
+static uint32_t GOVERNOR_LastBusy = 0U;
+static uint32_t GOVERNOR_LevelStart = 0U;
+
+static GOVERNOR_Level_TypeDef GOVERNOR_GetFloor(void);
+static GOVERNOR_Err_TypeDef GOVERNOR_Apply(GOVERNOR_Level_TypeDef level);
+static uint32_t GOVERNOR_IsBusy(void);
+static void GOVERNOR_SetClocks(const GOVERNOR_Clock_TypeDef *to, uint32_t raise);
+static void GOVERNOR_SetVclkDiv(uint32_t div);
+static void GOVERNOR_ScaleRti(uint32_t fromHz, uint32_t toHz);
+static void GOVERNOR_SetSciBaud(uint32_t vclkHz);
+static void GOVERNOR_SetI2cBaud(uint32_t vclkHz);
+static void GOVERNOR_Account(void);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the governor.
+ *
+ * @details
+ *   The clocks must still be as set up by systemInit, which is
+ *   GOVERNOR_Level_Max. Call after rtiInit, i2cInit and sciInit and after
+ *   anything that calibrates against the CPU clock (IDLE_Init), then run
+ *   GOVERNOR_Update every GOVERNOR_PERIOD.
+ *
+ * @param[in] params
+ *   Scaling policy, or null for GOVERNOR_DefaultParams.
+ ******************************************************************************/
+void GOVERNOR_Init(const GOVERNOR_Params_TypeDef *params)
+{
+  uint32_t i;
+
+  GOVERNOR_Params = (params != 0) ? *params : GOVERNOR_DefaultParams;
+  GOVERNOR_Level = GOVERNOR_Level_Max;
+  GOVERNOR_Hold = 0U;
+
+  for ( i = 0U; i < GOVERNOR_NUM_CLIENTS; i++ )
+  {
+    GOVERNOR_Floor[i] = (uint8_t)GOVERNOR_Level_Min;
+  }
+
+  GOVERNOR_LastCounter = SCHEDULER_GetCounter();
+  GOVERNOR_LastBusy = SCHEDULER_GetBusyCounts();
+  GOVERNOR_ResetStats();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Sample the load and change level if needed. Run as a scheduler task
+ *   every GOVERNOR_PERIOD.
+ *
+ * @details
+ *   Above the upper threshold the clock goes straight to the top level.
+ *   Otherwise the slowest level is chosen whose projected load, assuming the
+ *   work scales with HCLK, stays under the target. Lowering only happens
+ *   once that has held for the hold time. Client requests set a floor.
+ ******************************************************************************/
+void GOVERNOR_Update(void)
+{
+  uint32_t now = SCHEDULER_GetCounter();
+  uint32_t busy = SCHEDULER_GetBusyCounts();
+  uint32_t window = now - GOVERNOR_LastCounter;
+  uint32_t hclk = GOVERNOR_Clocks[GOVERNOR_Level].hclkHz;
+  GOVERNOR_Level_TypeDef floor = GOVERNOR_GetFloor();
+  uint32_t target;
+  uint32_t load = 0U;
+
+  if ( window != 0U )
+  {
+    load = (uint32_t)(((uint64_t)(busy - GOVERNOR_LastBusy) * 1000U) / window);
+  }
+
+  GOVERNOR_LastCounter = now;
+  GOVERNOR_LastBusy = busy;
+  GOVERNOR_Stats.load = (load > 1000U) ? 1000U : load;
+  GOVERNOR_Account();
+
+  if ( load > GOVERNOR_Params.upLoad )
+  {
+    target = (uint32_t)GOVERNOR_Params.maxLevel;
+  }
+  else
+  {
+    for ( target = (uint32_t)GOVERNOR_Params.minLevel;
+          target < (uint32_t)GOVERNOR_Params.maxLevel;
+          target++ )
+    {
+      if ( ((uint64_t)load * hclk) / GOVERNOR_Clocks[target].hclkHz
+           <= GOVERNOR_Params.targetLoad )
+      {
+        break;
+      }
+    }
+  }
+
+  if ( target < (uint32_t)floor )
+  {
+    target = (uint32_t)floor;
+  }
+
+  if ( target > (uint32_t)GOVERNOR_Params.maxLevel )
+  {
+    target = (uint32_t)GOVERNOR_Params.maxLevel;
+  }
+
+  if ( target > (uint32_t)GOVERNOR_Level )
+  {
+    GOVERNOR_Hold = 0U;
+    (void)GOVERNOR_Apply((GOVERNOR_Level_TypeDef)target);
+  }
+  else if ( target < (uint32_t)GOVERNOR_Level )
+  {
+    if ( ++GOVERNOR_Hold >= GOVERNOR_Params.downHold &&
+         GOVERNOR_Apply((GOVERNOR_Level_TypeDef)target) == GOVERNOR_Err_NoError )
+    {
+      GOVERNOR_Hold = 0U;
+    }
+  }
+  else
+  {
+    GOVERNOR_Hold = 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Request a minimum level for a client. A raise is applied immediately
+ *   unless a transfer is in progress, then it is retried by GOVERNOR_Update.
+ *   Safe to call from interrupts.
+ *
+ * @param[in] client
+ *   Requesting client.
+ *
+ * @param[in] level
+ *   Minimum level until released.
+ *
+ * @return
+ *   Returns 0 if the level is in effect.
+ ******************************************************************************/
+GOVERNOR_Err_TypeDef GOVERNOR_Request(GOVERNOR_Client_TypeDef client,
+                                      GOVERNOR_Level_TypeDef level)
+{
+  if ( (uint32_t)client >= GOVERNOR_NUM_CLIENTS ||
+       (uint32_t)level >= GOVERNOR_NUM_LEVELS )
+  {
+    return GOVERNOR_Err_Invalid;
+  }
+
+  GOVERNOR_Floor[client] = (uint8_t)level;
+
+  if ( level > GOVERNOR_Params.maxLevel )
+  {
+    level = GOVERNOR_Params.maxLevel;
+  }
+
+  if ( level > GOVERNOR_Level )
+  {
+    return GOVERNOR_Apply(level);
+  }
+
+  return GOVERNOR_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Drop the request of a client. The clock is lowered by GOVERNOR_Update
+ *   after the hold time.
+ *
+ * @param[in] client
+ *   Requesting client.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+GOVERNOR_Err_TypeDef GOVERNOR_Release(GOVERNOR_Client_TypeDef client)
+{
+  return GOVERNOR_Request(client, GOVERNOR_Level_Min);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get current level.
+ *
+ * @return
+ *   Returns level.
+ ******************************************************************************/
+GOVERNOR_Level_TypeDef GOVERNOR_GetLevel(void)
+{
+  return GOVERNOR_Level;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get current CPU clock.
+ *
+ * @return
+ *   Returns HCLK in Hz.
+ ******************************************************************************/
+uint32_t GOVERNOR_GetHclkHz(void)
+{
+  return GOVERNOR_Clocks[GOVERNOR_Level].hclkHz;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get current peripheral clock.
+ *
+ * @return
+ *   Returns VCLK in Hz.
+ ******************************************************************************/
+uint32_t GOVERNOR_GetVclkHz(void)
+{
+  return GOVERNOR_Clocks[GOVERNOR_Level].vclkHz;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get accumulated measurements.
+ *
+ * @return
+ *   Returns pointer to statistics.
+ ******************************************************************************/
+const GOVERNOR_Stats_TypeDef *GOVERNOR_GetStats(void)
+{
+  GOVERNOR_Account();
+
+  return &GOVERNOR_Stats;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear accumulated measurements.
+ ******************************************************************************/
+void GOVERNOR_ResetStats(void)
+{
+  uint32_t i;
+
+  GOVERNOR_Stats.switches = 0U;
+  GOVERNOR_Stats.deferred = 0U;
+  GOVERNOR_Stats.load = 0U;
+
+  for ( i = 0U; i < GOVERNOR_NUM_LEVELS; i++ )
+  {
+    GOVERNOR_Stats.time[i] = 0U;
+  }
+
+  GOVERNOR_LevelStart = SCHEDULER_GetCounter();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print current clocks and load on one line, then the residency of each
+ *   level in percent.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef GOVERNOR_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  PRINT_Err_TypeDef ret;
+  uint64_t elapsed = 0U;
+  uint32_t i;
+
+  GOVERNOR_Account();
+
+  for ( i = 0U; i < GOVERNOR_NUM_LEVELS; i++ )
+  {
+    elapsed += GOVERNOR_Stats.time[i];
+  }
+
+  if ( elapsed == 0U )
+  {
+    elapsed = 1U;
+  }
+
+  PRINT_PrintString(uart,"LEVEL=");
+  PRINT_PrintString(uart,(char*)GOVERNOR_LevelNames[GOVERNOR_Level]);
+  PRINT_PrintString(uart," HCLK=");
+  PRINT_FormatUInt(buf,GOVERNOR_GetHclkHz());
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," VCLK=");
+  PRINT_FormatUInt(buf,GOVERNOR_GetVclkHz());
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," LOAD=");
+  PRINT_FormatFixed(buf,(int32_t)GOVERNOR_Stats.load,1U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," SWITCHES=");
+  PRINT_FormatUInt(buf,GOVERNOR_Stats.switches);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," DEFERRED=");
+  PRINT_FormatUInt(buf,GOVERNOR_Stats.deferred);
+  ret = PRINT_PrintStringln(uart,buf);
+
+  for ( i = 0U; i < GOVERNOR_NUM_LEVELS && ret == PRINT_Err_NoError; i++ )
+  {
+    PRINT_PrintString(uart,(char*)GOVERNOR_LevelNames[i]);
+    PRINT_PrintString(uart," RES=");
+    PRINT_FormatFixed(buf,(int32_t)((GOVERNOR_Stats.time[i] * 1000U) / elapsed),1U,1U);
+    ret = PRINT_PrintStringln(uart,buf);
+  }
+
+  return ret;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Get the highest level requested by any client.
+ *
+ * @return
+ *   Returns level.
+ ******************************************************************************/
+static GOVERNOR_Level_TypeDef GOVERNOR_GetFloor(void)
+{
+  uint32_t floor = (uint32_t)GOVERNOR_Params.minLevel;
+  uint32_t i;
+
+  for ( i = 0U; i < GOVERNOR_NUM_CLIENTS; i++ )
+  {
+    if ( GOVERNOR_Floor[i] > floor )
+    {
+      floor = GOVERNOR_Floor[i];
+    }
+  }
+
+  return (GOVERNOR_Level_TypeDef)floor;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Switch to a level.
+ *
+ * @details
+ *   Runs with IRQ masked and RTI counters stopped. The time the counters
+ *   were stopped is measured with the PMU cycle counter and added back to
+ *   counter 0, but never past an enabled compare since compares only match
+ *   on equality.
+ *
+ * @param[in] level
+ *   New level.
+ *
+ * @return
+ *   Returns 0 if switched, GOVERNOR_Err_Busy if a transfer is in progress.
+ ******************************************************************************/
+static GOVERNOR_Err_TypeDef GOVERNOR_Apply(GOVERNOR_Level_TypeDef level)
+{
+  const GOVERNOR_Clock_TypeDef *from;
+  const GOVERNOR_Clock_TypeDef *to = &GOVERNOR_Clocks[level];
+  uint32_t irq = _disable_IRQ();
+  uint32_t running;
+  uint32_t start;
+  uint32_t before;
+  uint32_t after;
+  uint32_t lost;
+  uint32_t frc;
+  uint32_t dist;
+  uint32_t i;
+
+  from = &GOVERNOR_Clocks[GOVERNOR_Level];
+
+  if ( level == GOVERNOR_Level )
+  {
+    _restore_interrupts(irq);
+    return GOVERNOR_Err_NoError;
+  }
+
+  if ( GOVERNOR_IsBusy() != 0U )
+  {
+    GOVERNOR_Stats.deferred++;
+    _restore_interrupts(irq);
+    return GOVERNOR_Err_Busy;
+  }
+
+  GOVERNOR_Account();
+
+  start = _pmuGetCycleCount_();
+  running = rtiREG1->GCTRL & GOVERNOR_RTI_COUNTERS;
+  rtiREG1->GCTRL &= ~GOVERNOR_RTI_COUNTERS;
+  before = _pmuGetCycleCount_() - start;
+
+  GOVERNOR_SetClocks(to, (to->hclkHz > from->hclkHz) ? 1U : 0U);
+
+  start = _pmuGetCycleCount_();
+
+  if ( to->vclkHz != from->vclkHz )
+  {
+    GOVERNOR_ScaleRti(from->vclkHz, to->vclkHz);
+    GOVERNOR_SetSciBaud(to->vclkHz);
+    GOVERNOR_SetI2cBaud(to->vclkHz);
+    AD5324_SetClock(to->vclkHz);
+    PORT_CAN_SetClock(to->vclkHz);
+  }
+
+  frc = rtiREG1->CNT[0U].FRCx;
+  after = _pmuGetCycleCount_() - start;
+
+  lost = (uint32_t)(((uint64_t)before * SCHEDULER_FRC_HZ) / from->hclkHz
+                  + ((uint64_t)after * SCHEDULER_FRC_HZ) / to->hclkHz);
+
+  for ( i = 0U; i < 2U; i++ )
+  {
+    if ( rtiREG1->SETINTENA & (1UL << i) )
+    {
+      dist = rtiREG1->CMP[i].COMPx - frc;
+
+      if ( dist <= lost )
+      {
+        lost = dist - 1U;
+      }
+    }
+  }
+
+  rtiREG1->CNT[0U].FRCx = frc + lost;
+  rtiREG1->GCTRL |= running;
+
+  GOVERNOR_Level = level;
+  GOVERNOR_Stats.switches++;
+
+  _restore_interrupts(irq);
+
+  return GOVERNOR_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check for console, I2C, DAC or CAN transfers a clock change would
+ *   corrupt.
+ *
+ * @return
+ *   Returns 1 if busy.
+ ******************************************************************************/
+static uint32_t GOVERNOR_IsBusy(void)
+{
+  uint32_t flr = PORT_UART_UART0->FLR;
+
+  if ( (flr & GOVERNOR_SCI_TX_EMPTY) == 0U ||
+       (flr & GOVERNOR_SCI_RX_BUSY) != 0U ||
+       (PORT_I2C->STR & (uint32)I2C_BUSBUSY) != 0U ||
+       (PORT_I2C->MDR & (uint32)I2C_MASTER) != 0U ||
+       AD5324_IsBusy() != 0U ||
+       PORT_CAN_IsBusy() != 0U )
+  {
+    return 1U;
+  }
+
+  return 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Program the PLL output and VCLK dividers. When raising, the VCLK
+ *   dividers are set first and when lowering the PLL divider is, so VCLK
+ *   never runs faster than at either level.
+ *
+ * @param[in] to
+ *   New divider settings.
+ *
+ * @param[in] raise
+ *   Nonzero if HCLK increases.
+ ******************************************************************************/
+static void GOVERNOR_SetClocks(const GOVERNOR_Clock_TypeDef *to, uint32_t raise)
+{
+  if ( raise != 0U )
+  {
+    GOVERNOR_SetVclkDiv(to->vclkDiv);
+  }
+
+  systemREG1->PLLCTL1 = (systemREG1->PLLCTL1 & ~GOVERNOR_PLLDIV_MASK)
+                      | (to->pllDiv << GOVERNOR_PLLDIV_SHIFT);
+
+  if ( raise == 0U )
+  {
+    GOVERNOR_SetVclkDiv(to->vclkDiv);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set VCLK, VCLK2 and VCLK3 to the same divider of HCLK. VCLK2 is changed
+ *   in the order that keeps it at least as fast as VCLK.
+ *
+ * @param[in] div
+ *   Divider minus one.
+ ******************************************************************************/
+static void GOVERNOR_SetVclkDiv(uint32_t div)
+{
+  uint32_t old = (systemREG1->CLKCNTL & GOVERNOR_VCLKR_MASK) >> GOVERNOR_VCLKR_SHIFT;
+
+  if ( div > old )
+  {
+    systemREG1->CLKCNTL = (systemREG1->CLKCNTL & ~GOVERNOR_VCLKR_MASK)
+                        | (div << GOVERNOR_VCLKR_SHIFT);
+    systemREG1->CLKCNTL = (systemREG1->CLKCNTL & ~GOVERNOR_VCLK2R_MASK)
+                        | (div << GOVERNOR_VCLK2R_SHIFT);
+  }
+  else
+  {
+    systemREG1->CLKCNTL = (systemREG1->CLKCNTL & ~GOVERNOR_VCLK2R_MASK)
+                        | (div << GOVERNOR_VCLK2R_SHIFT);
+    systemREG1->CLKCNTL = (systemREG1->CLKCNTL & ~GOVERNOR_VCLKR_MASK)
+                        | (div << GOVERNOR_VCLKR_SHIFT);
+  }
+
+  systemREG2->CLK2CNTL = (systemREG2->CLK2CNTL & ~GOVERNOR_VCLK3R_MASK)
+                       | (div << GOVERNOR_VCLK3R_SHIFT);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Rescale both RTI prescalers and their current counts so the counters
+ *   keep their rate. The counters must be stopped.
+ *
+ * @param[in] fromHz
+ *   Old RTICLK (VCLK) in Hz.
+ *
+ * @param[in] toHz
+ *   New RTICLK (VCLK) in Hz.
+ ******************************************************************************/
+static void GOVERNOR_ScaleRti(uint32_t fromHz, uint32_t toHz)
+{
+  uint32_t i;
+  uint32_t prescale;
+  uint32_t scaled;
+
+  for ( i = 0U; i < 2U; i++ )
+  {
+    prescale = rtiREG1->CNT[i].CPUCx + 1U;
+    scaled = (uint32_t)(((uint64_t)prescale * toHz) / fromHz);
+
+    rtiREG1->CNT[i].UCx = (rtiREG1->CNT[i].UCx * scaled) / prescale;
+    rtiREG1->CNT[i].CPUCx = scaled - 1U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Recompute the console baud rate divider, rounded like sciSetBaudrate.
+ *
+ * @param[in] vclkHz
+ *   New VCLK in Hz.
+ ******************************************************************************/
+static void GOVERNOR_SetSciBaud(uint32_t vclkHz)
+{
+  uint32_t f = ((PORT_UART_UART0->GCR1 & 2U) == 2U) ? 16U : 1U;
+  uint32_t bit = f * GOVERNOR_SCI_BAUD;
+
+  PORT_UART_UART0->BRS = ((vclkHz + bit / 2U) / bit - 1U) & 0x00FFFFFFU;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Recompute the I2C prescaler and clock dividers like i2cSetBaudrate,
+ *   with the module held in reset meanwhile.
+ *
+ * @param[in] vclkHz
+ *   New VCLK in Hz.
+ ******************************************************************************/
+static void GOVERNOR_SetI2cBaud(uint32_t vclkHz)
+{
+  uint32_t prescale = vclkHz / GOVERNOR_I2C_MODULE_HZ - 1U;
+  uint32_t d = (prescale >= 2U) ? 5U : ((prescale != 0U) ? 6U : 7U);
+  uint32_t ck = vclkHz / (2U * GOVERNOR_I2C_KHZ * 1000U * (prescale + 1U)) - d;
+
+  PORT_I2C->MDR &= ~(uint32)I2C_RESET_OUT;
+  PORT_I2C->PSC = prescale;
+  PORT_I2C->CKH = ck;
+  PORT_I2C->CKL = ck;
+  PORT_I2C->MDR |= (uint32)I2C_RESET_OUT;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add the time since the last call to the current level.
+ ******************************************************************************/
+static void GOVERNOR_Account(void)
+{
+  uint32_t now = SCHEDULER_GetCounter();
+
+  GOVERNOR_Stats.time[GOVERNOR_Level] += now - GOVERNOR_LevelStart;
+  GOVERNOR_LevelStart = now;
+}
@@ -0,0 +1,165 @@
+/** @file governor.h
+*   @brief Clock Governor Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup GOVERNOR GOVERNOR
+ *  @brief Scales HCLK and VCLK with the workload.
+ *
+ *  The PLL stays locked at 160 MHz and the clock is scaled with the PLL
+ *  output divider and the VCLK dividers, so a change takes effect at once
+ *  without a relock. The load of the scheduler tasks is sampled every
+ *  update period; the governor raises the clock as soon as the load crosses
+ *  the upper threshold and lowers it to the slowest level that keeps the
+ *  projected load under the target after a hold time. Clients such as the
+ *  command handler, an IV sweep or a log download request a minimum level
+ *  for a burst of work, a raise takes effect immediately.
+ *
+ *  The RTI counter prescalers, the console SCI baud rate, the I2C clock
+ *  dividers, the DAC SPI prescaler and the CAN bit timing are recomputed
+ *  on every VCLK change so the scheduler time base and the buses keep their
+ *  rates. A change is deferred while the console, I2C, a DAC burst or CAN
+ *  is transferring (see PORT_CAN_IsBusy, which stops waiting for frames
+ *  nobody acknowledges once the controller is error passive). RTI
+ *  counter 0 is stopped during the change and corrected for the time it
+ *  was stopped, counter 1 is not corrected.
+ *
+ *  CPU cycle figures (PROFILE, IDLE exit cycles) scale with the level.
+ *
+ *	Related Files
+ *   - governor.h
+ *   - governor.c
+ *   - scheduler.h
+ *   - port_uart.h
+ *   - port_i2c.h
+ *   - ad5324.h
+ *   - port_can.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_GOVERNOR_H_
+#define DRIVERS_GOVERNOR_H_
+
+#include "scheduler.h"
+#include "port_uart.h"
+#include "port_i2c.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** PLL output before the output divider, in Hz */
+#define GOVERNOR_PLL_HZ           (160000000U)
+
+/** Console baud rate kept across clock changes */
+#define GOVERNOR_SCI_BAUD         (115200U)
+
+/** I2C clock kept across clock changes, in kHz */
+#define GOVERNOR_I2C_KHZ          (100U)
+
+/** Update period of the governor task, in ticks */
+#define GOVERNOR_PERIOD           (SCHEDULER_MS(100))
+
+/**
+ *  @addtogroup GOVERNOR
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum GOVERNOR_Err_TypeDef
+*   @brief Alias names for GOVERNOR errors.
+*/
+typedef enum
+{
+  GOVERNOR_Err_NoError  = 0U,   /**< No error*/
+  GOVERNOR_Err_Busy     = 1U,   /**< Console or I2C transfer in progress*/
+  GOVERNOR_Err_Invalid  = 2U    /**< Level or client out of range*/
+} GOVERNOR_Err_TypeDef;
+
+/** @enum GOVERNOR_Level_TypeDef
+*   @brief Clock levels, from slowest to fastest.
+*/
+typedef enum
+{
+  GOVERNOR_Level_Min = 0,   /**< HCLK 20 MHz, VCLK 20 MHz*/
+  GOVERNOR_Level_Low = 1,   /**< HCLK 40 MHz, VCLK 40 MHz*/
+  GOVERNOR_Level_Mid = 2,   /**< HCLK 80 MHz, VCLK 80 MHz*/
+  GOVERNOR_Level_Max = 3,   /**< HCLK 160 MHz, VCLK 80 MHz (reset setup)*/
+  GOVERNOR_NUM_LEVELS       /**< Number of levels (not a level)*/
+} GOVERNOR_Level_TypeDef;
+
+/** @enum GOVERNOR_Client_TypeDef
+*   @brief Users that can request a minimum level.
+*/
+typedef enum
+{
+  GOVERNOR_Client_User    = 0,  /**< Console WRITE(CLOCK,...)*/
+  GOVERNOR_Client_Command = 1,  /**< Console command processing*/
+  GOVERNOR_Client_Mppt    = 2,  /**< IV sweep of a panel*/
+  GOVERNOR_Client_Dump    = 3,  /**< HISTORY telemetry stream*/
+  GOVERNOR_Client_Download = 4, /**< CSP log download*/
+  GOVERNOR_NUM_CLIENTS          /**< Number of clients (not a client)*/
+} GOVERNOR_Client_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct GOVERNOR_Params_TypeDef
+*   @brief Scaling policy. Loads are in permille of the update period.
+*/
+typedef struct
+{
+  uint32_t upLoad;                    /**< Raise to the top level above this load*/
+  uint32_t targetLoad;                /**< Lowest level keeping the load under this*/
+  uint32_t downHold;                  /**< Update periods before lowering*/
+  GOVERNOR_Level_TypeDef minLevel;    /**< Never go below this level*/
+  GOVERNOR_Level_TypeDef maxLevel;    /**< Never go above this level*/
+} GOVERNOR_Params_TypeDef;
+
+/** @struct GOVERNOR_Stats_TypeDef
+*   @brief Accumulated measurements. Times are in RTI counts.
+*/
+typedef struct
+{
+  uint32_t switches;                      /**< Level changes*/
+  uint32_t deferred;                      /**< Changes put off by a transfer*/
+  uint32_t load;                          /**< Load of the last period, permille*/
+  uint64_t time[GOVERNOR_NUM_LEVELS];     /**< Time spent at each level*/
+} GOVERNOR_Stats_TypeDef;
+
+extern const GOVERNOR_Params_TypeDef GOVERNOR_DefaultParams;
+
+void GOVERNOR_Init(const GOVERNOR_Params_TypeDef *params);
+
+void GOVERNOR_Update(void);
+
+GOVERNOR_Err_TypeDef GOVERNOR_Request(GOVERNOR_Client_TypeDef client,
+                                      GOVERNOR_Level_TypeDef level);
+
+GOVERNOR_Err_TypeDef GOVERNOR_Release(GOVERNOR_Client_TypeDef client);
+
+GOVERNOR_Level_TypeDef GOVERNOR_GetLevel(void);
+
+uint32_t GOVERNOR_GetHclkHz(void);
+
+uint32_t GOVERNOR_GetVclkHz(void);
+
+const GOVERNOR_Stats_TypeDef *GOVERNOR_GetStats(void);
+
+void GOVERNOR_ResetStats(void);
+
+PRINT_Err_TypeDef GOVERNOR_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_GOVERNOR_H_ */
@@ -0,0 +1,306 @@
+/** @file histogram.c
+*   @brief Logarithmic Bucket Histogram Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "histogram.h"
+#include "print.h"
+#include "stdint.h"
+
+static uint32_t HISTOGRAM_PutWord(uint8_t *buf, uint32_t val);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Clear a histogram.
+ *
+ * @param[out] hist
+ *   Pointer to histogram.
+ ******************************************************************************/
+void HISTOGRAM_Init(HISTOGRAM_TypeDef *hist)
+{
+  uint32_t i;
+
+  hist->count = 0U;
+  hist->min = 0xFFFFFFFFU;
+  hist->max = 0U;
+
+  for ( i = 0U; i < HISTOGRAM_NUM_BUCKETS; i++ )
+  {
+    hist->bucket[i] = 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add a sample. Not reentrant for the same histogram.
+ *
+ * @param[in] hist
+ *   Pointer to histogram.
+ *
+ * @param[in] val
+ *   Sample value.
+ ******************************************************************************/
+void HISTOGRAM_Add(HISTOGRAM_TypeDef *hist, uint32_t val)
+{
+  uint32_t idx = 32U - HISTOGRAM_CLZ(val);
+
+  if ( idx >= HISTOGRAM_NUM_BUCKETS )
+  {
+    idx = HISTOGRAM_NUM_BUCKETS - 1U;
+  }
+
+  hist->bucket[idx]++;
+  hist->count++;
+
+  if ( val < hist->min )
+  {
+    hist->min = val;
+  }
+
+  if ( val > hist->max )
+  {
+    hist->max = val;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the smallest value counted by a bucket.
+ *
+ * @param[in] bucket
+ *   Bucket index.
+ *
+ * @return
+ *   Returns lower bound of bucket.
+ ******************************************************************************/
+uint32_t HISTOGRAM_BucketLow(uint32_t bucket)
+{
+  return (bucket == 0U) ? 0U : (1UL << (bucket - 1U));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the largest value counted by a bucket.
+ *
+ * @param[in] bucket
+ *   Bucket index.
+ *
+ * @return
+ *   Returns upper bound of bucket (inclusive).
+ ******************************************************************************/
+uint32_t HISTOGRAM_BucketHigh(uint32_t bucket)
+{
+  if ( bucket >= HISTOGRAM_NUM_BUCKETS - 1U )
+  {
+    return 0xFFFFFFFFU;
+  }
+
+  return (1UL << bucket) - 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Estimate a percentile as the upper bound of the bucket that contains it,
+ *   clamped to the largest sample seen.
+ *
+ * @param[in] hist
+ *   Pointer to histogram.
+ *
+ * @param[in] permille
+ *   Percentile in tenths of a percent, e.g. 990 for the 99th percentile.
+ *
+ * @return
+ *   Returns percentile estimate, 0 if the histogram is empty.
+ ******************************************************************************/
+uint32_t HISTOGRAM_Percentile(const HISTOGRAM_TypeDef *hist,
+                              uint32_t permille)
+{
+  uint64_t target;
+  uint64_t seen = 0U;
+  uint32_t high;
+  uint32_t i;
+
+  if ( hist->count == 0U )
+  {
+    return 0U;
+  }
+
+  /* Rank of the sample, rounded up so 1000 selects the largest */
+  target = ((uint64_t)hist->count * permille + 999U) / 1000U;
+
+  if ( target == 0U )
+  {
+    target = 1U;
+  }
+
+  for ( i = 0U; i < HISTOGRAM_NUM_BUCKETS; i++ )
+  {
+    seen += hist->bucket[i];
+    if ( seen >= target )
+    {
+      break;
+    }
+  }
+
+  high = HISTOGRAM_BucketHigh(i);
+
+  return (high < hist->max) ? high : hist->max;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Serialize a histogram for binary telemetry.
+ *
+ * @details
+ *   All words are big endian. The layout is a bucket mask with bit k set for
+ *   every non-empty bucket k, then count, min and max, then the count of each
+ *   non-empty bucket in ascending order.
+ *
+ * @param[in] hist
+ *   Pointer to histogram.
+ *
+ * @param[out] buf
+ *   Destination buffer.
+ *
+ * @param[in] size
+ *   Size of destination buffer, HISTOGRAM_SERIALIZED_MAX always suffices.
+ *
+ * @return
+ *   Returns number of bytes written, 0 if the buffer is too small.
+ ******************************************************************************/
+uint32_t HISTOGRAM_Serialize(const HISTOGRAM_TypeDef *hist,
+                             uint8_t *buf,
+                             uint32_t size)
+{
+  uint32_t mask = 0U;
+  uint32_t used = 0U;
+  uint32_t len = 0U;
+  uint32_t i;
+
+  for ( i = 0U; i < HISTOGRAM_NUM_BUCKETS; i++ )
+  {
+    if ( hist->bucket[i] != 0U )
+    {
+      mask |= 1UL << i;
+      used++;
+    }
+  }
+
+  if ( size < 4U * (4U + used) )
+  {
+    return 0U;
+  }
+
+  len += HISTOGRAM_PutWord(&buf[len], mask);
+  len += HISTOGRAM_PutWord(&buf[len], hist->count);
+  len += HISTOGRAM_PutWord(&buf[len], hist->min);
+  len += HISTOGRAM_PutWord(&buf[len], hist->max);
+
+  for ( i = 0U; i < HISTOGRAM_NUM_BUCKETS; i++ )
+  {
+    if ( mask & (1UL << i) )
+    {
+      len += HISTOGRAM_PutWord(&buf[len], hist->bucket[i]);
+    }
+  }
+
+  return len;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print summary and non-empty buckets of a histogram.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @param[in] name
+ *   Name printed on the summary line.
+ *
+ * @param[in] hist
+ *   Pointer to histogram.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef HISTOGRAM_Print(PORT_UART_Reg_TypeDef *uart,
+                                  const char *name,
+                                  const HISTOGRAM_TypeDef *hist)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  PRINT_Err_TypeDef ret;
+  uint32_t i;
+
+  PRINT_PrintString(uart,(char*)name);
+  PRINT_PrintString(uart," N=");
+  PRINT_FormatUInt(buf,hist->count);
+  PRINT_PrintString(uart,buf);
+
+  if ( hist->count != 0U )
+  {
+    PRINT_PrintString(uart," MIN=");
+    PRINT_FormatUInt(buf,hist->min);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," P99=");
+    PRINT_FormatUInt(buf,HISTOGRAM_Percentile(hist,990U));
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MAX=");
+    PRINT_FormatUInt(buf,hist->max);
+    PRINT_PrintString(uart,buf);
+  }
+
+  ret = PRINT_PrintStringln(uart,"");
+
+  for ( i = 0U; i < HISTOGRAM_NUM_BUCKETS && ret == PRINT_Err_NoError; i++ )
+  {
+    if ( hist->bucket[i] == 0U )
+    {
+      continue;
+    }
+
+    PRINT_PrintString(uart,"  ");
+    PRINT_FormatUInt(buf,HISTOGRAM_BucketLow(i));
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintChar(uart,'-');
+    PRINT_FormatUInt(buf,HISTOGRAM_BucketHigh(i));
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart,": ");
+    PRINT_FormatUInt(buf,hist->bucket[i]);
+    ret = PRINT_PrintStringln(uart,buf);
+  }
+
+  return ret;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Write a word in big endian byte order.
+ *
+ * @param[out] buf
+ *   Destination for 4 bytes.
+ *
+ * @param[in] val
+ *   Word to write.
+ *
+ * @return
+ *   Returns number of bytes written.
+ ******************************************************************************/
+static uint32_t HISTOGRAM_PutWord(uint8_t *buf, uint32_t val)
+{
+  buf[0] = (uint8_t)(val >> 24);
+  buf[1] = (uint8_t)(val >> 16);
+  buf[2] = (uint8_t)(val >> 8);
+  buf[3] = (uint8_t)val;
+
+  return 4U;
+}
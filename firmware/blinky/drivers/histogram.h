@@ -0,0 +1,88 @@
+/** @file histogram.h
+*   @brief Logarithmic Bucket Histogram Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup HISTOGRAM HISTOGRAM
+ *  @brief Fixed size power-of-two bucket histograms for timing data.
+ *
+ *  Bucket 0 counts zero, bucket k counts values in [2^(k-1), 2^k) and the
+ *  last bucket also collects everything above it. Adding a sample is a
+ *  count-leading-zeros and a few increments, so histograms can be updated
+ *  from ISRs.
+ *
+ *	Related Files
+ *   - histogram.h
+ *   - histogram.c
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_HISTOGRAM_H_
+#define DRIVERS_HISTOGRAM_H_
+
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+#define HISTOGRAM_NUM_BUCKETS     (32U)
+
+/** Largest buffer HISTOGRAM_Serialize can produce: bucket mask, count, min,
+ *  max and one word per bucket. */
+#define HISTOGRAM_SERIALIZED_MAX  (4U * (4U + HISTOGRAM_NUM_BUCKETS))
+
+/* Count leading zeros, 32 for a zero argument */
+#if defined(__TI_ARM__)
+#define HISTOGRAM_CLZ(x)          ((uint32_t)_norm(x))
+#else
+#define HISTOGRAM_CLZ(x)          ((x) ? (uint32_t)__builtin_clz(x) : 32U)
+#endif
+
+/**
+ *  @addtogroup HISTOGRAM
+ *  @{
+ */
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct HISTOGRAM_TypeDef
+*   @brief Histogram storage.
+*/
+typedef struct
+{
+  uint32_t count;                           /**< Number of samples*/
+  uint32_t min;                             /**< Smallest sample*/
+  uint32_t max;                             /**< Largest sample*/
+  uint32_t bucket[HISTOGRAM_NUM_BUCKETS];   /**< Samples per bucket*/
+} HISTOGRAM_TypeDef;
+
+void HISTOGRAM_Init(HISTOGRAM_TypeDef *hist);
+
+void HISTOGRAM_Add(HISTOGRAM_TypeDef *hist, uint32_t val);
+
+uint32_t HISTOGRAM_BucketLow(uint32_t bucket);
+
+uint32_t HISTOGRAM_BucketHigh(uint32_t bucket);
+
+uint32_t HISTOGRAM_Percentile(const HISTOGRAM_TypeDef *hist,
+                              uint32_t permille);
+
+uint32_t HISTOGRAM_Serialize(const HISTOGRAM_TypeDef *hist,
+                             uint8_t *buf,
+                             uint32_t size);
+
+PRINT_Err_TypeDef HISTOGRAM_Print(PORT_UART_Reg_TypeDef *uart,
+                                  const char *name,
+                                  const HISTOGRAM_TypeDef *hist);
+
+/**@}*/
+
+#endif /* DRIVERS_HISTOGRAM_H_ */
@@ -0,0 +1,226 @@
+/** @file history.c
+*   @brief Telemetry History Retrieval Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "history.h"
+#include "flashlog.h"
+#include "kiss.h"
+#include "telemetry.h"
+#include "governor.h"
+#include "stdint.h"
+
+static FLASHLOG_Query_TypeDef HISTORY_Query;
+static TELEMETRY_Snapshot_TypeDef HISTORY_Snapshot;
+static HISTORY_State_TypeDef HISTORY_State;
+static PORT_UART_Reg_TypeDef *HISTORY_Uart;
+
+static uint8_t HISTORY_Frame[HISTORY_HEADER_SIZE + HISTORY_FRAME_POINTS * HISTORY_POINT_SIZE];
+static uint8_t HISTORY_Count;
+
+static uint8_t HISTORY_Value(const TELEMETRY_Snapshot_TypeDef *snap, int32_t *value);
+static void HISTORY_Send(uint8_t flags);
+static void HISTORY_Put(uint8_t *buf, uint64_t val, uint8_t size);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Start streaming a quantity over a time range.
+ *
+ * @param[in] uart
+ *   UART the frames are sent on.
+ *
+ * @param[in] channel
+ *   TELEMETRY_Channel_TypeDef, or TELEMETRY_Temp_TypeDef for a temperature.
+ *
+ * @param[in] quantity
+ *   Quantity to stream.
+ *
+ * @param[in] from
+ *   Start of the range in us since 2000.
+ *
+ * @param[in] to
+ *   End of the range in us since 2000, inclusive.
+ *
+ * @return
+ *   Returns 0 if the stream started.
+ ******************************************************************************/
+HISTORY_Err_TypeDef HISTORY_Start(PORT_UART_Reg_TypeDef *uart,
+                                  uint8_t channel,
+                                  HISTORY_Quantity_TypeDef quantity,
+                                  uint64_t from,
+                                  uint64_t to)
+{
+  if ( HISTORY_State.active )
+  {
+    return HISTORY_Err_Busy;
+  }
+
+  if ( to < from || quantity > HISTORY_Quantity_Temp
+    || channel >= ((quantity == HISTORY_Quantity_Temp) ? TELEMETRY_NUM_TEMPS : TELEMETRY_NUM_CHANNELS) )
+  {
+    return HISTORY_Err_Invalid;
+  }
+
+  if ( FLASHLOG_QueryStart(&HISTORY_Query, from, to) != FLASHLOG_Err_NoError )
+  {
+    return HISTORY_Err_Empty;
+  }
+
+  HISTORY_Uart = uart;
+  HISTORY_State.channel = channel;
+  HISTORY_State.quantity = quantity;
+  HISTORY_State.points = 0U;
+  HISTORY_State.frames = 0U;
+  HISTORY_State.blocks = 0U;
+  HISTORY_State.waits = 0U;
+  HISTORY_Count = 0U;
+  HISTORY_State.active = 1U;
+  (void)GOVERNOR_Request(GOVERNOR_Client_Dump, GOVERNOR_Level_Max);
+
+  return HISTORY_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode up to a frame of points and send it. Call every HISTORY_PERIOD
+ *   from a task.
+ ******************************************************************************/
+void HISTORY_Update(void)
+{
+  FLASHLOG_Err_TypeDef err;
+  int32_t value;
+
+  if ( !HISTORY_State.active )
+  {
+    return;
+  }
+
+  while ( HISTORY_Count < HISTORY_FRAME_POINTS )
+  {
+    err = FLASHLOG_QueryNext(&HISTORY_Query, &HISTORY_Snapshot);
+    HISTORY_State.blocks = HISTORY_Query.blocks;
+
+    if ( err == FLASHLOG_Err_Busy )
+    {
+      /* A log write holds the flash, carry on next run */
+      HISTORY_State.waits++;
+      return;
+    }
+
+    if ( err != FLASHLOG_Err_NoError )
+    {
+      HISTORY_Send(HISTORY_FLAG_LAST);
+      HISTORY_State.active = 0U;
+      (void)GOVERNOR_Release(GOVERNOR_Client_Dump);
+      return;
+    }
+
+    if ( HISTORY_Value(&HISTORY_Snapshot, &value) )
+    {
+      HISTORY_Put(&HISTORY_Frame[HISTORY_HEADER_SIZE + HISTORY_Count * HISTORY_POINT_SIZE],
+                  HISTORY_Snapshot.time, 8U);
+      HISTORY_Put(&HISTORY_Frame[HISTORY_HEADER_SIZE + HISTORY_Count * HISTORY_POINT_SIZE + 8U],
+                  (uint32_t)value, 4U);
+      HISTORY_Count++;
+    }
+  }
+
+  HISTORY_Send(0U);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stop the stream without a final frame.
+ ******************************************************************************/
+void HISTORY_Abort(void)
+{
+  HISTORY_State.active = 0U;
+  (void)GOVERNOR_Release(GOVERNOR_Client_Dump);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the progress of the current or last stream.
+ ******************************************************************************/
+const HISTORY_State_TypeDef *HISTORY_GetState(void)
+{
+  return &HISTORY_State;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Extract the requested quantity from a decoded record.
+ *
+ * @return
+ *   Returns 1 if the channel was read in that record, else 0.
+ ******************************************************************************/
+static uint8_t HISTORY_Value(const TELEMETRY_Snapshot_TypeDef *snap, int32_t *value)
+{
+  const TELEMETRY_Measurement_TypeDef *meas = &snap->meas[HISTORY_State.channel];
+
+  if ( HISTORY_State.quantity == HISTORY_Quantity_Temp )
+  {
+    *value = snap->temp[HISTORY_State.channel];
+    return (snap->tempErrors & (1UL << HISTORY_State.channel)) ? 0U : 1U;
+  }
+
+  switch ( HISTORY_State.quantity )
+  {
+    case HISTORY_Quantity_Voltage:
+      *value = meas->voltage;
+      break;
+    case HISTORY_Quantity_Current:
+      *value = meas->current;
+      break;
+    default:
+      *value = (int32_t)(((int64_t)meas->voltage * meas->current) / 1000000);
+      break;
+  }
+
+  return (snap->errors & (1UL << HISTORY_State.channel)) ? 0U : 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Fill in the frame header and send the points collected so far.
+ ******************************************************************************/
+static void HISTORY_Send(uint8_t flags)
+{
+  HISTORY_Frame[0] = HISTORY_TYPE_SERIES;
+  HISTORY_Frame[1] = flags;
+  HISTORY_Frame[2] = HISTORY_State.channel;
+  HISTORY_Frame[3] = (uint8_t)HISTORY_State.quantity;
+  HISTORY_Put(&HISTORY_Frame[4], HISTORY_State.frames, 2U);
+  HISTORY_Frame[6] = HISTORY_Count;
+
+  (void)KISS_Send(HISTORY_Uart, HISTORY_KISS_PORT, HISTORY_Frame,
+                  (uint16_t)(HISTORY_HEADER_SIZE + HISTORY_Count * HISTORY_POINT_SIZE));
+
+  HISTORY_State.points += HISTORY_Count;
+  HISTORY_State.frames++;
+  HISTORY_Count = 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Store a value most significant byte first.
+ ******************************************************************************/
+static void HISTORY_Put(uint8_t *buf, uint64_t val, uint8_t size)
+{
+  while ( size > 0U )
+  {
+    size--;
+    buf[size] = (uint8_t)val;
+    val >>= 8;
+  }
+}
@@ -0,0 +1,135 @@
+/** @file history.h
+*   @brief Telemetry History Retrieval Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup HISTORY HISTORY
+ *  @brief Streams one quantity of the flash log over a time range.
+ *
+ *  A request names a power monitor channel and its voltage, current or
+ *  power, or a temperature sensor, and a time range. The range is looked
+ *  up in the FLASHLOG index and only the blocks that overlap it are read
+ *  and decoded. Points are sent as KISS frames, HISTORY_FRAME_POINTS to a
+ *  frame and at most one frame per task run, so a long range never holds
+ *  up the scheduler and a flash write in progress only delays the stream.
+ *  The clock governor is held at its top level while a stream runs.
+ *
+ *  Frame payload, multi-byte fields most significant byte first:
+ *
+ *    offset  size  field
+ *    0       1     HISTORY_TYPE_SERIES
+ *    1       1     flags, HISTORY_FLAG_LAST on the final frame
+ *    2       1     channel or temperature sensor
+ *    3       1     quantity, HISTORY_Quantity_TypeDef
+ *    4       2     frame number from 0
+ *    6       1     number of points that follow
+ *    7       12n   points: time in us since 2000 (8), value (4, signed)
+ *
+ *  Values are in uV, uA, uW or mC at the resolution of the log. Records
+ *  where the channel failed are left out. The final frame may hold no
+ *  points.
+ *
+ *	Related Files
+ *   - history.h
+ *   - history.c
+ *   - flashlog.h
+ *   - kiss.h
+ *   - governor.h
+ *   - scheduler.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_HISTORY_H_
+#define DRIVERS_HISTORY_H_
+
+#include "flashlog.h"
+#include "kiss.h"
+#include "scheduler.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Period of the streaming task, in ticks */
+#define HISTORY_PERIOD            (SCHEDULER_MS(20))
+
+/** Points per frame */
+#define HISTORY_FRAME_POINTS      (16U)
+
+/** KISS port of the frames */
+#define HISTORY_KISS_PORT         (1U)
+
+#define HISTORY_TYPE_SERIES       (0x10U)
+#define HISTORY_FLAG_LAST         (0x01U)
+
+#define HISTORY_HEADER_SIZE       (7U)
+#define HISTORY_POINT_SIZE        (12U)
+
+/**
+ *  @addtogroup HISTORY
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum HISTORY_Quantity_TypeDef
+*   @brief Quantities that can be retrieved.
+*/
+typedef enum
+{
+  HISTORY_Quantity_Voltage = 0U,  /**< Bus voltage of a power monitor in uV*/
+  HISTORY_Quantity_Current = 1U,  /**< Current of a power monitor in uA*/
+  HISTORY_Quantity_Power   = 2U,  /**< Product of the two in uW*/
+  HISTORY_Quantity_Temp    = 3U   /**< Temperature of a sensor in mC*/
+} HISTORY_Quantity_TypeDef;
+
+/** @enum HISTORY_Err_TypeDef
+*   @brief Alias names for HISTORY errors.
+*/
+typedef enum
+{
+  HISTORY_Err_NoError = 0U,       /**< No error*/
+  HISTORY_Err_Busy    = 1U,       /**< A stream is already running*/
+  HISTORY_Err_Invalid = 2U,       /**< Bad channel, quantity or range*/
+  HISTORY_Err_Empty   = 3U        /**< Nothing logged*/
+} HISTORY_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct HISTORY_State_TypeDef
+*   @brief Progress of the current or last stream.
+*/
+typedef struct
+{
+  uint8_t active;                 /**< Set while streaming*/
+  uint8_t channel;                /**< Channel or sensor*/
+  HISTORY_Quantity_TypeDef quantity; /**< Quantity*/
+  uint32_t points;                /**< Points sent*/
+  uint32_t frames;                /**< Frames sent*/
+  uint32_t blocks;                /**< Log blocks decoded*/
+  uint32_t waits;                 /**< Task runs that found the flash busy*/
+} HISTORY_State_TypeDef;
+
+HISTORY_Err_TypeDef HISTORY_Start(PORT_UART_Reg_TypeDef *uart,
+                                  uint8_t channel,
+                                  HISTORY_Quantity_TypeDef quantity,
+                                  uint64_t from,
+                                  uint64_t to);
+
+void HISTORY_Update(void);
+
+void HISTORY_Abort(void);
+
+const HISTORY_State_TypeDef *HISTORY_GetState(void);
+
+/**@}*/
+
+#endif /* DRIVERS_HISTORY_H_ */
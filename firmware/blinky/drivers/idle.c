@@ -0,0 +1,902 @@
+/** @file idle.c
+*   @brief Tickless Idle Manager Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "idle.h"
+#include "low_power_mode.h"
+#include "scheduler.h"
+#include "sys_core.h"
+#include "sys_pmu.h"
+#include "sys_vim.h"
+#include "rti.h"
+#include "ad5324.h"
+#include "port_can.h"
+#include "histogram.h"
+#include "print.h"
+#include "stdint.h"
+
+/* Modes that stop peripheral clocks */
+#define IDLE_DEEP_MASK        ((1UL << IDLE_Mode_Doze) | (1UL << IDLE_Mode_Snooze))
+
+/* SCI transmitter empty flag, the last stop bit has left the pin */
+#define IDLE_SCI_TX_EMPTY     (0x00000800U)
+
+/* SCI receiver busy and wakeup flags, low power mode */
+#define IDLE_SCI_RX_BUSY      (0x00000008U)
+#define IDLE_SCI_WAKEUP       (0x00000002U)
+#define IDLE_SCI_POWERDOWN    (0x00000001U)
+
+/* RTI GCTRL counter enable bits of both blocks */
+#define IDLE_RTI_COUNTERS     (0x00000003U)
+
+/* CPU clock during LPO calibration and LF LPO counts to measure */
+#define IDLE_CAL_HCLK_HZ      (160000000U)
+#define IDLE_CAL_COUNTS       (50U)
+
+const IDLE_Params_TypeDef IDLE_DefaultParams =
+{
+  /* Run, WFI, Doze, Snooze */
+  { 0U, 1U, SCHEDULER_MS(5), SCHEDULER_MS(20) },
+  { 0U, 200U, 10000U, 20000U },
+  SCHEDULER_MS(10000),
+  0U
+};
+
+static const char * const IDLE_ModeNames[IDLE_NUM_MODES] =
+{
+  "RUN", "WFI", "DOZE", "SNOOZE"
+};
+
+static const char * const IDLE_HistNames[IDLE_NUM_HISTS] =
+{
+  "ENTRY", "EXIT", "EXITCYC", "WAKEERR"
+};
+
+static IDLE_Params_TypeDef IDLE_Params;
+static IDLE_Stats_TypeDef IDLE_Stats[IDLE_NUM_MODES];
+static IDLE_Record_TypeDef IDLE_Record;
+
+/* No histograms for IDLE_Mode_Run */
+static HISTOGRAM_TypeDef IDLE_Hists[IDLE_NUM_MODES - 1U][IDLE_NUM_HISTS];
+
+/* Idle periods left in a benchmark run, the mode cycles with the count */
+static volatile uint32_t IDLE_BenchLeft = 0U;
+
+static volatile uint32_t IDLE_Locks = 0U;
+static volatile uint32_t IDLE_HoldUntil = 0U;
+static uint32_t IDLE_StatsTicks = 0U;
+
+static uint32_t IDLE_CalibrateLpo(void);
+static uint32_t IDLE_GetLockMask(void);
+static IDLE_Mode_TypeDef IDLE_BenchMode(uint32_t gap);
+static uint32_t IDLE_GetMargin(IDLE_Mode_TypeDef mode);
+static uint32_t IDLE_ArmWakeup(uint32_t target);
+static uint32_t IDLE_DisarmWakeup(void);
+static uint32_t IDLE_SleepWfi(IDLE_Record_TypeDef *rec);
+static uint32_t IDLE_SleepDeep(IDLE_Record_TypeDef *rec);
+static void IDLE_Account(const IDLE_Record_TypeDef *rec, uint32_t early);
+static uint32_t IDLE_ToCounter(uint32_t counts, uint32_t hz);
+
+void IDLE_WakeupInterrupt(void);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the idle manager.
+ *
+ * @details
+ *   Maps the RTI compare 1 interrupt used for wakeup. If no LF LPO frequency
+ *   is given it is measured against the CPU cycle counter, which takes about
+ *   5 ms. Call after rtiInit and PROFILE_Init but before SCHEDULER_Start,
+ *   then install IDLE_Enter with SCHEDULER_SetIdleHook.
+ *
+ * @param[in] params
+ *   Mode selection parameters, or null for IDLE_DefaultParams.
+ ******************************************************************************/
+void IDLE_Init(const IDLE_Params_TypeDef *params)
+{
+  IDLE_Params = (params != 0) ? *params : IDLE_DefaultParams;
+
+  if ( IDLE_Params.lpoHz == 0U )
+  {
+    IDLE_Params.lpoHz = IDLE_CalibrateLpo();
+  }
+
+  rtiREG1->CLEARINTENA = rtiNOTIFICATION_COMPARE1;
+  rtiREG1->CMP[1U].UDCPx = 0U;
+  rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE1;
+
+  vimChannelMap(IDLE_VIM_CHANNEL, IDLE_VIM_CHANNEL, &IDLE_WakeupInterrupt);
+  vimEnableInterrupt(IDLE_VIM_CHANNEL, SYS_IRQ);
+
+  IDLE_Locks = 0U;
+  IDLE_Hold(IDLE_CONSOLE_HOLD);
+  IDLE_ResetStats();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Sleep until shortly before the next task release or any interrupt.
+ *
+ * @details
+ *   Scheduler idle hook, called with IRQ masked and no task pending.
+ ******************************************************************************/
+void IDLE_Enter(void)
+{
+  IDLE_Record_TypeDef *rec = &IDLE_Record;
+  uint32_t entry = rtiREG1->CNT[0U].FRCx;
+  uint32_t gap = SCHEDULER_GetIdleTicks();
+  uint32_t early;
+  IDLE_Mode_TypeDef mode;
+  IDLE_Mode_TypeDef bench = IDLE_Mode_Run;
+
+  if ( gap > IDLE_Params.maxTicks )
+  {
+    gap = IDLE_Params.maxTicks;
+  }
+
+  if ( IDLE_BenchLeft != 0U )
+  {
+    bench = IDLE_BenchMode(gap);
+  }
+
+  mode = (bench != IDLE_Mode_Run) ? bench
+                                  : IDLE_SelectMode(&IDLE_Params, gap,
+                                                    IDLE_GetLockMask());
+
+  if ( mode == IDLE_Mode_Run )
+  {
+    return;
+  }
+
+  rec->mode = mode;
+  rec->gap = gap;
+  rec->entry = entry;
+
+  if ( mode == IDLE_Mode_Wfi )
+  {
+    early = IDLE_SleepWfi(rec);
+  }
+  else
+  {
+    early = IDLE_SleepDeep(rec);
+
+    /* Wake margin grew past the gap, settle for WFI */
+    if ( rec->mode == IDLE_Mode_Run )
+    {
+      rec->mode = IDLE_Mode_Wfi;
+      early = IDLE_SleepWfi(rec);
+    }
+  }
+
+  IDLE_Account(rec, early);
+
+  if ( bench != IDLE_Mode_Run && rec->mode == bench )
+  {
+    IDLE_BenchLeft--;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Select the deepest mode allowed for a gap.
+ *
+ * @param[in] params
+ *   Mode selection parameters.
+ *
+ * @param[in] gap
+ *   Ticks until the next task release, 0 if a task is pending.
+ *
+ * @param[in] lockMask
+ *   Modes ruled out, bit n for IDLE_Mode_TypeDef n.
+ *
+ * @return
+ *   Returns mode to enter.
+ ******************************************************************************/
+IDLE_Mode_TypeDef IDLE_SelectMode(const IDLE_Params_TypeDef *params,
+                                  uint32_t gap,
+                                  uint32_t lockMask)
+{
+  uint32_t mode;
+
+  for ( mode = IDLE_NUM_MODES - 1U; mode > (uint32_t)IDLE_Mode_Run; mode-- )
+  {
+    if ( (lockMask & (1UL << mode)) == 0U &&
+         params->minTicks[mode] != 0U &&
+         gap >= params->minTicks[mode] )
+    {
+      break;
+    }
+  }
+
+  return (IDLE_Mode_TypeDef)mode;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Keep peripheral clocks running until the lock is released.
+ *
+ * @param[in] lock
+ *   Lock reason.
+ ******************************************************************************/
+void IDLE_Lock(IDLE_Lock_TypeDef lock)
+{
+  uint32_t irq = _disable_IRQ();
+
+  IDLE_Locks |= 1UL << lock;
+
+  _restore_interrupts(irq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Release a lock taken with IDLE_Lock.
+ *
+ * @param[in] lock
+ *   Lock reason.
+ ******************************************************************************/
+void IDLE_Unlock(IDLE_Lock_TypeDef lock)
+{
+  uint32_t irq = _disable_IRQ();
+
+  IDLE_Locks &= ~(1UL << lock);
+
+  _restore_interrupts(irq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Keep peripheral clocks running for a while, e.g. after console activity.
+ *   A later call replaces the hold time.
+ *
+ * @param[in] ticks
+ *   Number of scheduler ticks from now.
+ ******************************************************************************/
+void IDLE_Hold(uint32_t ticks)
+{
+  IDLE_HoldUntil = SCHEDULER_GetTicks() + ticks;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get accumulated measurements of a mode.
+ *
+ * @param[in] mode
+ *   Idle mode.
+ *
+ * @return
+ *   Returns pointer to statistics, or null if mode is out of range.
+ ******************************************************************************/
+const IDLE_Stats_TypeDef *IDLE_GetStats(IDLE_Mode_TypeDef mode)
+{
+  if ( (uint32_t)mode >= IDLE_NUM_MODES )
+  {
+    return 0;
+  }
+
+  return &IDLE_Stats[mode];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get timestamps of the last idle period.
+ *
+ * @return
+ *   Returns pointer to record.
+ ******************************************************************************/
+const IDLE_Record_TypeDef *IDLE_GetRecord(void)
+{
+  return &IDLE_Record;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear accumulated measurements of all modes.
+ ******************************************************************************/
+void IDLE_ResetStats(void)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < IDLE_NUM_MODES; i++ )
+  {
+    IDLE_Stats[i].entries = 0U;
+    IDLE_Stats[i].early = 0U;
+    IDLE_Stats[i].time = 0U;
+    IDLE_Stats[i].entryMax = 0U;
+    IDLE_Stats[i].exitLast = 0U;
+    IDLE_Stats[i].exitMax = 0U;
+    IDLE_Stats[i].late = 0U;
+    IDLE_Stats[i].console = 0U;
+  }
+
+  for ( i = 0U; i < (IDLE_NUM_MODES - 1U) * IDLE_NUM_HISTS; i++ )
+  {
+    HISTOGRAM_Init(&IDLE_Hists[0][0] + i);
+  }
+
+  IDLE_StatsTicks = SCHEDULER_GetTicks();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print measurements, one line per mode. Residency is the share of time
+ *   since the last reset spent in a mode, latencies are maxima in us.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef IDLE_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  PRINT_Err_TypeDef ret = PRINT_Err_NoError;
+  const IDLE_Stats_TypeDef *stats;
+  uint64_t elapsed;
+  uint64_t asleep = 0U;
+  uint32_t i;
+
+  elapsed = (uint64_t)(SCHEDULER_GetTicks() - IDLE_StatsTicks)
+          * SCHEDULER_TICK_COUNTS;
+
+  if ( elapsed == 0U )
+  {
+    elapsed = 1U;
+  }
+
+  for ( i = (uint32_t)IDLE_Mode_Wfi; i < IDLE_NUM_MODES; i++ )
+  {
+    asleep += IDLE_Stats[i].time;
+  }
+
+  PRINT_PrintString(uart,"RUN RES=");
+  PRINT_FormatFixed(buf,(int32_t)(((elapsed - asleep) * 1000U) / elapsed),1U,1U);
+  ret = PRINT_PrintStringln(uart,buf);
+
+  for ( i = (uint32_t)IDLE_Mode_Wfi; i < IDLE_NUM_MODES && ret == PRINT_Err_NoError; i++ )
+  {
+    stats = &IDLE_Stats[i];
+
+    PRINT_PrintString(uart,(char*)IDLE_ModeNames[i]);
+    PRINT_PrintString(uart," N=");
+    PRINT_FormatUInt(buf,stats->entries);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," EARLY=");
+    PRINT_FormatUInt(buf,stats->early);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," LATE=");
+    PRINT_FormatUInt(buf,stats->late);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," RES=");
+    PRINT_FormatFixed(buf,(int32_t)((stats->time * 1000U) / elapsed),1U,1U);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," ENTRY=");
+    PRINT_FormatFixed(buf,(int32_t)stats->entryMax,1U,1U);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," EXIT=");
+    PRINT_FormatFixed(buf,(int32_t)stats->exitMax,1U,1U);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," CONSOLE=");
+    PRINT_FormatUInt(buf,stats->console);
+    ret = PRINT_PrintStringln(uart,buf);
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get a timing distribution.
+ *
+ * @param[in] mode
+ *   Idle mode other than IDLE_Mode_Run.
+ *
+ * @param[in] hist
+ *   Histogram.
+ *
+ * @return
+ *   Returns pointer to histogram, or null if out of range.
+ ******************************************************************************/
+const HISTOGRAM_TypeDef *IDLE_GetHist(IDLE_Mode_TypeDef mode,
+                                      IDLE_Hist_TypeDef hist)
+{
+  if ( mode == IDLE_Mode_Run || (uint32_t)mode >= IDLE_NUM_MODES ||
+       (uint32_t)hist >= IDLE_NUM_HISTS )
+  {
+    return 0;
+  }
+
+  return &IDLE_Hists[mode - 1U][hist];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start a benchmark run.
+ *
+ * @details
+ *   Statistics and histograms are cleared, then the next idle periods cycle
+ *   through WFI, doze and snooze until each mode has been entered the given
+ *   number of times. Locks and the console hold are ignored meanwhile, only a
+ *   transmission still in progress defers a deep mode. Gaps of a single tick
+ *   are left to the normal selection.
+ *
+ * @param[in] periods
+ *   Idle periods per mode, 0 stops a run.
+ ******************************************************************************/
+void IDLE_BenchStart(uint32_t periods)
+{
+  uint32_t irq = _disable_IRQ();
+
+  IDLE_ResetStats();
+  IDLE_BenchLeft = periods * (IDLE_NUM_MODES - 1U);
+
+  _restore_interrupts(irq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get number of idle periods left in the benchmark run.
+ *
+ * @return
+ *   Returns 0 once the run has completed.
+ ******************************************************************************/
+uint32_t IDLE_BenchRemaining(void)
+{
+  return IDLE_BenchLeft;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the timing distributions of all modes. RTI counts are 0.1 us.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef IDLE_BenchPrint(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  PRINT_Err_TypeDef ret;
+  uint32_t mode;
+  uint32_t hist;
+
+  PRINT_PrintString(uart,"BENCH LEFT=");
+  PRINT_FormatUInt(buf,IDLE_BenchLeft);
+  ret = PRINT_PrintStringln(uart,buf);
+
+  for ( mode = (uint32_t)IDLE_Mode_Wfi; mode < IDLE_NUM_MODES && ret == PRINT_Err_NoError; mode++ )
+  {
+    ret = PRINT_PrintStringln(uart,(char*)IDLE_ModeNames[mode]);
+
+    for ( hist = 0U; hist < IDLE_NUM_HISTS && ret == PRINT_Err_NoError; hist++ )
+    {
+      ret = HISTOGRAM_Print(uart, IDLE_HistNames[hist],
+                            &IDLE_Hists[mode - 1U][hist]);
+    }
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   RTI compare 1 interrupt. The wakeup is normally disarmed before IRQ is
+ *   unmasked, this only catches a match that lands in between.
+ ******************************************************************************/
+#pragma CODE_STATE(IDLE_WakeupInterrupt, 32)
+#pragma INTERRUPT(IDLE_WakeupInterrupt, IRQ)
+void IDLE_WakeupInterrupt(void)
+{
+  rtiREG1->CLEARINTENA = rtiNOTIFICATION_COMPARE1;
+  rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE1;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Measure the LF LPO with RTI counter 0 against the CPU cycle counter.
+ *   The RTI counters must not be in use yet.
+ *
+ * @return
+ *   Returns LF LPO frequency in Hz.
+ ******************************************************************************/
+static uint32_t IDLE_CalibrateLpo(void)
+{
+  LOW_POWER_Context_TypeDef ctx;
+  uint32_t running = rtiREG1->GCTRL & IDLE_RTI_COUNTERS;
+  uint32_t prescale = rtiREG1->CNT[0U].CPUCx + 1U;
+  uint32_t start;
+  uint32_t cycles;
+  uint32_t frc;
+
+  rtiREG1->GCTRL &= ~IDLE_RTI_COUNTERS;
+  LOW_POWER_SelectRtiClock(LOW_POWER_Mode_Snooze, &ctx);
+  rtiREG1->GCTRL |= 1U;
+
+  /* Align to a counter edge */
+  frc = rtiREG1->CNT[0U].FRCx;
+  while ( rtiREG1->CNT[0U].FRCx == frc )
+  {
+  }
+
+  frc = rtiREG1->CNT[0U].FRCx;
+  start = _pmuGetCycleCount_();
+
+  while ( rtiREG1->CNT[0U].FRCx - frc < IDLE_CAL_COUNTS )
+  {
+  }
+
+  cycles = _pmuGetCycleCount_() - start;
+
+  rtiREG1->GCTRL &= ~IDLE_RTI_COUNTERS;
+  LOW_POWER_RestoreRtiClock(&ctx);
+  rtiREG1->GCTRL |= running;
+
+  return (uint32_t)(((uint64_t)IDLE_CAL_COUNTS * prescale * IDLE_CAL_HCLK_HZ)
+                    / cycles);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get modes currently ruled out by locks, console activity, a console
+ *   character still shifting in or out, a DAC burst in flight or CAN
+ *   traffic, see PORT_CAN_IsBusy.
+ *
+ * @return
+ *   Returns mode mask, bit n for IDLE_Mode_TypeDef n.
+ ******************************************************************************/
+static uint32_t IDLE_GetLockMask(void)
+{
+  if ( IDLE_Locks != 0U ||
+       (int32_t)(IDLE_HoldUntil - SCHEDULER_GetTicks()) > 0 ||
+       (PORT_UART_UART0->FLR & IDLE_SCI_TX_EMPTY) == 0U ||
+       (PORT_UART_UART0->FLR & IDLE_SCI_RX_BUSY) != 0U ||
+       AD5324_IsBusy() != 0U ||
+       PORT_CAN_IsBusy() != 0U )
+  {
+    return IDLE_DEEP_MASK;
+  }
+
+  return 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the mode the benchmark run wants for this idle period.
+ *
+ * @param[in] gap
+ *   Ticks until the next task release.
+ *
+ * @return
+ *   Returns mode, or IDLE_Mode_Run to use the normal selection.
+ ******************************************************************************/
+static IDLE_Mode_TypeDef IDLE_BenchMode(uint32_t gap)
+{
+  IDLE_Mode_TypeDef mode = (IDLE_Mode_TypeDef)((uint32_t)IDLE_Mode_Wfi
+                         + IDLE_BenchLeft % (IDLE_NUM_MODES - 1U));
+
+  if ( gap < 2U )
+  {
+    return IDLE_Mode_Run;
+  }
+
+  if ( mode != IDLE_Mode_Wfi &&
+       (PORT_UART_UART0->FLR & IDLE_SCI_TX_EMPTY) == 0U )
+  {
+    return IDLE_Mode_Run;
+  }
+
+  return mode;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get how long before a release to wake up: the configured margin, or the
+ *   longest wakeup delay plus exit latency seen if that is larger. The wakeup
+ *   delay covers oscillator start-up after snooze.
+ *
+ * @param[in] mode
+ *   Idle mode.
+ *
+ * @return
+ *   Returns margin in RTI counts.
+ ******************************************************************************/
+static uint32_t IDLE_GetMargin(IDLE_Mode_TypeDef mode)
+{
+  uint32_t margin = IDLE_Stats[mode].exitMax + IDLE_MIN_LEAD;
+
+  if ( mode != IDLE_Mode_Run )
+  {
+    margin += IDLE_Hists[mode - 1U][IDLE_Hist_WakeError].max;
+  }
+
+  return (IDLE_Params.wakeMargin[mode] > margin) ? IDLE_Params.wakeMargin[mode]
+                                                 : margin;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Program compare 1 as a one shot wakeup on a running counter.
+ *
+ * @param[in] target
+ *   Counter 0 value to wake at.
+ *
+ * @return
+ *   Returns 1 if armed, 0 if the target is too close.
+ ******************************************************************************/
+static uint32_t IDLE_ArmWakeup(uint32_t target)
+{
+  rtiREG1->CMP[1U].COMPx = target;
+  rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE1;
+
+  if ( (int32_t)(target - rtiREG1->CNT[0U].FRCx) < (int32_t)IDLE_MIN_LEAD )
+  {
+    return 0U;
+  }
+
+  rtiREG1->SETINTENA = rtiNOTIFICATION_COMPARE1;
+
+  return 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Disable and clear the compare 1 wakeup.
+ *
+ * @return
+ *   Returns 1 if compare 1 had matched.
+ ******************************************************************************/
+static uint32_t IDLE_DisarmWakeup(void)
+{
+  uint32_t matched = rtiREG1->INTFLAG & rtiNOTIFICATION_COMPARE1;
+
+  rtiREG1->CLEARINTENA = rtiNOTIFICATION_COMPARE1;
+  rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE1;
+
+  return (matched != 0U) ? 1U : 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Sleep in WFI with the tick suspended. A gap of one tick sleeps with the
+ *   tick running since the next tick is the release.
+ *
+ * @param[in,out] rec
+ *   Record with mode, gap and entry filled in.
+ *
+ * @return
+ *   Returns 1 if woken early by another interrupt.
+ ******************************************************************************/
+static uint32_t IDLE_SleepWfi(IDLE_Record_TypeDef *rec)
+{
+  uint32_t base = SCHEDULER_SuspendTick();
+  uint32_t armed = 0U;
+  uint32_t matched;
+  uint32_t cycles;
+
+  rec->release = base + (rec->gap - 1U) * SCHEDULER_TICK_COUNTS;
+  rec->target = rec->release - IDLE_GetMargin(IDLE_Mode_Wfi);
+
+  if ( rec->gap > 1U )
+  {
+    armed = IDLE_ArmWakeup(rec->target);
+  }
+
+  if ( armed == 0U )
+  {
+    SCHEDULER_ResumeTick();
+
+    /* Woken by the releasing tick itself */
+    rec->target = base;
+    rec->release = base;
+  }
+
+  rec->wfi = rtiREG1->CNT[0U].FRCx;
+  _gotoCPUIdle_();
+  rec->wake = rtiREG1->CNT[0U].FRCx;
+  cycles = _pmuGetCycleCount_();
+
+  matched = IDLE_DisarmWakeup();
+
+  if ( armed != 0U )
+  {
+    SCHEDULER_ResumeTick();
+  }
+
+  rec->ready = rtiREG1->CNT[0U].FRCx;
+  rec->exitCycles = _pmuGetCycleCount_() - cycles;
+
+  return (armed != 0U && matched == 0U) ? 1U : 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Sleep in doze or snooze.
+ *
+ * @details
+ *   The counters are stopped while the RTI changes clock. Counter 0 runs on
+ *   the sleep clock from its current value and is rewritten with the elapsed
+ *   time converted back to SCHEDULER_FRC_HZ before the tick is realigned.
+ *   The elapsed time includes the prescaler count, otherwise up to a whole
+ *   slow count would be lost on every wakeup. Counter 1 is not corrected.
+ *
+ * @param[in,out] rec
+ *   Record with mode, gap and entry filled in. The mode is set to
+ *   IDLE_Mode_Run if the gap turned out too short.
+ *
+ * @return
+ *   Returns 1 if woken early by another interrupt.
+ ******************************************************************************/
+static uint32_t IDLE_SleepDeep(IDLE_Record_TypeDef *rec)
+{
+  LOW_POWER_Context_TypeDef ctx;
+  LOW_POWER_Mode_TypeDef lp = (rec->mode == IDLE_Mode_Doze) ? LOW_POWER_Mode_Doze
+                                                            : LOW_POWER_Mode_Snooze;
+  uint32_t srcHz = (lp == LOW_POWER_Mode_Doze) ? LOW_POWER_RtiSourceHz(lp)
+                                               : IDLE_Params.lpoHz;
+  uint32_t prescale = rtiREG1->CNT[0U].CPUCx + 1U;
+  uint32_t sleepHz = srcHz / prescale;
+  uint32_t running = rtiREG1->GCTRL & IDLE_RTI_COUNTERS;
+  uint32_t base = SCHEDULER_SuspendTick();
+  uint32_t start;
+  uint32_t uc;
+  uint32_t wake;
+  uint32_t lead;
+  uint32_t slow;
+  uint32_t matched;
+  uint32_t cycles;
+
+  rec->release = base + (rec->gap - 1U) * SCHEDULER_TICK_COUNTS;
+  rec->target = rec->release - IDLE_GetMargin(rec->mode);
+
+  rtiREG1->GCTRL &= ~IDLE_RTI_COUNTERS;
+
+  start = rtiREG1->CNT[0U].FRCx;
+  uc = rtiREG1->CNT[0U].UCx;
+  lead = rec->target - start;
+  slow = (uint32_t)(((uint64_t)lead * sleepHz) / SCHEDULER_FRC_HZ);
+
+  if ( (int32_t)lead < (int32_t)IDLE_MIN_LEAD || slow < 2U )
+  {
+    rtiREG1->GCTRL |= running;
+    SCHEDULER_ResumeTick();
+    rec->mode = IDLE_Mode_Run;
+    return 0U;
+  }
+
+  LOW_POWER_SelectRtiClock(lp, &ctx);
+
+  rtiREG1->CMP[1U].COMPx = start + slow;
+  rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE1;
+  rtiREG1->SETINTENA = rtiNOTIFICATION_COMPARE1;
+
+  rec->wfi = start;
+  rtiREG1->GCTRL |= running;
+
+  /* A start bit on the console wakes the core while the SCI is unclocked */
+  PORT_UART_UART0->FLR = IDLE_SCI_WAKEUP;
+  PORT_UART_UART0->SETINT = (uint32)SCI_WAKE_INT;
+  PORT_UART_UART0->GCR2 |= IDLE_SCI_POWERDOWN;
+
+  LOW_POWER_Enter(lp, &ctx);
+
+  wake = rtiREG1->CNT[0U].FRCx;
+  cycles = _pmuGetCycleCount_();
+
+  LOW_POWER_RestoreClocks(&ctx);
+
+  PORT_UART_UART0->GCR2 &= ~IDLE_SCI_POWERDOWN;
+  PORT_UART_UART0->CLEARINT = (uint32)SCI_WAKE_INT;
+
+  if ( (PORT_UART_UART0->FLR & IDLE_SCI_WAKEUP) != 0U )
+  {
+    PORT_UART_UART0->FLR = IDLE_SCI_WAKEUP;
+    IDLE_Stats[rec->mode].console++;
+    IDLE_Hold(IDLE_CONSOLE_HOLD);
+  }
+
+  rtiREG1->GCTRL &= ~IDLE_RTI_COUNTERS;
+
+  /* Counter 0 moved on when the prescaler wrapped, uc cycles early */
+  rec->wake = start + IDLE_ToCounter((wake - start) * prescale - uc, srcHz);
+  rec->ready = start + IDLE_ToCounter((rtiREG1->CNT[0U].FRCx - start) * prescale
+                                     + rtiREG1->CNT[0U].UCx - uc, srcHz);
+
+  LOW_POWER_RestoreRtiClock(&ctx);
+
+  rtiREG1->CNT[0U].FRCx = rec->ready;
+  rtiREG1->CNT[0U].UCx = 0U;
+
+  matched = IDLE_DisarmWakeup();
+  SCHEDULER_RealignTick();
+
+  rtiREG1->GCTRL |= running;
+  SCHEDULER_ResumeTick();
+
+  rec->exitCycles = _pmuGetCycleCount_() - cycles;
+
+  return (matched == 0U) ? 1U : 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add an idle period to the statistics of its mode.
+ *
+ * @param[in] rec
+ *   Completed record.
+ *
+ * @param[in] early
+ *   Nonzero if woken by another interrupt than the planned wakeup.
+ ******************************************************************************/
+static void IDLE_Account(const IDLE_Record_TypeDef *rec, uint32_t early)
+{
+  IDLE_Stats_TypeDef *stats = &IDLE_Stats[rec->mode];
+  HISTOGRAM_TypeDef *hists = IDLE_Hists[rec->mode - 1U];
+  uint32_t entry = rec->wfi - rec->entry;
+  uint32_t exit = rec->ready - rec->wake;
+  int32_t error = (int32_t)(rec->wake - rec->target);
+
+  stats->entries++;
+  stats->time += rec->wake - rec->wfi;
+  stats->exitLast = exit;
+
+  HISTOGRAM_Add(&hists[IDLE_Hist_Entry], entry);
+  HISTOGRAM_Add(&hists[IDLE_Hist_Exit], exit);
+  HISTOGRAM_Add(&hists[IDLE_Hist_ExitCycles], rec->exitCycles);
+
+  if ( early != 0U )
+  {
+    stats->early++;
+  }
+  else
+  {
+    HISTOGRAM_Add(&hists[IDLE_Hist_WakeError],
+                  (uint32_t)((error < 0) ? -error : error));
+  }
+
+  if ( rec->target != rec->release &&
+       (int32_t)(rec->ready - rec->release) > 0 )
+  {
+    stats->late++;
+  }
+
+  if ( entry > stats->entryMax )
+  {
+    stats->entryMax = entry;
+  }
+
+  if ( exit > stats->exitMax )
+  {
+    stats->exitMax = exit;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert sleep clock cycles to SCHEDULER_FRC_HZ counts.
+ *
+ * @param[in] counts
+ *   RTICLK cycles at the sleep clock, before the prescaler.
+ *
+ * @param[in] hz
+ *   RTICLK frequency while asleep.
+ *
+ * @return
+ *   Returns counts at SCHEDULER_FRC_HZ.
+ ******************************************************************************/
+static uint32_t IDLE_ToCounter(uint32_t counts, uint32_t hz)
+{
+  return (uint32_t)(((uint64_t)counts * SCHEDULER_FRC_HZ) / hz);
+}
@@ -0,0 +1,198 @@
+/** @file idle.h
+*   @brief Tickless Idle Manager Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup IDLE IDLE
+ *  @brief Picks the deepest safe sleep mode for the gap to the next task
+ *         release.
+ *
+ *  Installed as the scheduler idle hook. The scheduler tick is suspended,
+ *  RTI compare 1 is programmed to fire a wake margin before the next release
+ *  and the core sleeps in WFI, doze or snooze. On wakeup the clocks are
+ *  restored, the RTI counter is corrected for time spent on the slow clock
+ *  and the skipped ticks are accounted by the scheduler.
+ *
+ *  Doze and snooze switch off the peripheral clocks, so they are only used
+ *  when no lock is held, no console character is being shifted in or out,
+ *  the console has been quiet for the hold time and CAN has no traffic
+ *  (see PORT_CAN_IsBusy). While they last the
+ *  console SCI is in low power mode with its wakeup interrupt enabled: the
+ *  start bit of a character wakes the core at once and starts the hold, so
+ *  the rest of the input is received on running clocks. Only the character
+ *  that woke the board is lost; it is counted per mode.
+ *  Entries, time asleep and entry/exit latency are accounted per mode. The
+ *  exit latency measured is also used to widen the wake margin.
+ *
+ *  Every idle period is timestamped at entry, WFI, wakeup and clocks ready
+ *  with the RTI counter, and the restore path is also timed in CPU cycles.
+ *  The distributions are kept in log2 histograms per mode. A benchmark run
+ *  cycles WFI, doze and snooze through the real idle periods regardless of
+ *  locks, so all modes are characterised under the normal task load.
+ *
+ *	Related Files
+ *   - idle.h
+ *   - idle.c
+ *   - low_power_mode.h
+ *   - scheduler.h
+ *   - histogram.h
+ *   - port_can.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_IDLE_H_
+#define DRIVERS_IDLE_H_
+
+#include "low_power_mode.h"
+#include "scheduler.h"
+#include "histogram.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** VIM channel of RTI compare 1 */
+#define IDLE_VIM_CHANNEL          (3U)
+
+/** Shortest time between arming compare 1 and its match, in RTI counts */
+#define IDLE_MIN_LEAD             (100U)
+
+/** Console quiet time before deep modes are used again, in ticks */
+#define IDLE_CONSOLE_HOLD         (SCHEDULER_MS(2000))
+
+/** Default number of idle periods per mode in a benchmark run */
+#define IDLE_BENCH_DEFAULT        (100U)
+
+/**
+ *  @addtogroup IDLE
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum IDLE_Mode_TypeDef
+*   @brief Idle modes, from shallowest to deepest.
+*/
+typedef enum
+{
+  IDLE_Mode_Run    = 0,   /**< Do not sleep*/
+  IDLE_Mode_Wfi    = 1,   /**< Core clock gated, tick suspended*/
+  IDLE_Mode_Doze   = 2,   /**< Main oscillator only*/
+  IDLE_Mode_Snooze = 3,   /**< LF LPO only*/
+  IDLE_NUM_MODES          /**< Number of modes (not a mode)*/
+} IDLE_Mode_TypeDef;
+
+/** @enum IDLE_Lock_TypeDef
+*   @brief Reasons to keep peripheral clocks running. Any lock held rules
+*          out doze and snooze.
+*/
+typedef enum
+{
+  IDLE_Lock_User    = 0,  /**< Deep modes disabled by command*/
+  IDLE_Lock_Console = 1,  /**< Console transfer in progress*/
+  IDLE_Lock_Adc     = 2   /**< ADCACQ channel near its low threshold*/
+} IDLE_Lock_TypeDef;
+
+/** @enum IDLE_Hist_TypeDef
+*   @brief Timing distributions kept per mode.
+*/
+typedef enum
+{
+  IDLE_Hist_Entry = 0,    /**< Idle entry to WFI, RTI counts*/
+  IDLE_Hist_Exit,         /**< Wakeup to clocks ready, RTI counts*/
+  IDLE_Hist_ExitCycles,   /**< Wakeup to clocks ready, CPU cycles*/
+  IDLE_Hist_WakeError,    /**< Distance of wakeup from planned, RTI counts*/
+  IDLE_NUM_HISTS          /**< Number of histograms (not a histogram)*/
+} IDLE_Hist_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct IDLE_Params_TypeDef
+*   @brief Mode selection parameters.
+*/
+typedef struct
+{
+  uint32_t minTicks[IDLE_NUM_MODES];    /**< Shortest gap for a mode in ticks, 0 disables it*/
+  uint32_t wakeMargin[IDLE_NUM_MODES];  /**< Wake this long before the release, in RTI counts*/
+  uint32_t maxTicks;                    /**< Longest single sleep in ticks*/
+  uint32_t lpoHz;                       /**< LF LPO frequency in Hz*/
+} IDLE_Params_TypeDef;
+
+/** @struct IDLE_Stats_TypeDef
+*   @brief Accumulated measurements of a mode. Times are in RTI counts.
+*/
+typedef struct
+{
+  uint32_t entries;       /**< Number of times the mode was entered*/
+  uint32_t early;         /**< Wakeups by an interrupt other than compare 1*/
+  uint32_t late;          /**< Clocks ready after the release, a late task start*/
+  uint64_t time;          /**< Total time from WFI to wakeup*/
+  uint32_t entryMax;      /**< Longest idle entry to WFI*/
+  uint32_t exitLast;      /**< Last wakeup to clocks restored*/
+  uint32_t exitMax;       /**< Longest wakeup to clocks restored*/
+  uint32_t console;       /**< Wakeups by a console start bit*/
+} IDLE_Stats_TypeDef;
+
+/** @struct IDLE_Record_TypeDef
+*   @brief Timestamps of one idle period in RTI counts, corrected for the
+*          slow clock.
+*/
+typedef struct
+{
+  IDLE_Mode_TypeDef mode;   /**< Mode entered*/
+  uint32_t gap;             /**< Ticks to the next release*/
+  uint32_t entry;           /**< Idle hook called*/
+  uint32_t wfi;             /**< Clocks switched, about to sleep*/
+  uint32_t wake;            /**< First instruction after WFI*/
+  uint32_t ready;           /**< Clocks and tick restored*/
+  uint32_t target;          /**< Planned wakeup*/
+  uint32_t release;         /**< Next task release*/
+  uint32_t exitCycles;      /**< CPU cycles from wakeup to clocks ready*/
+} IDLE_Record_TypeDef;
+
+extern const IDLE_Params_TypeDef IDLE_DefaultParams;
+
+void IDLE_Init(const IDLE_Params_TypeDef *params);
+
+void IDLE_Enter(void);
+
+IDLE_Mode_TypeDef IDLE_SelectMode(const IDLE_Params_TypeDef *params,
+                                  uint32_t gap,
+                                  uint32_t lockMask);
+
+void IDLE_Lock(IDLE_Lock_TypeDef lock);
+
+void IDLE_Unlock(IDLE_Lock_TypeDef lock);
+
+void IDLE_Hold(uint32_t ticks);
+
+const IDLE_Stats_TypeDef *IDLE_GetStats(IDLE_Mode_TypeDef mode);
+
+const IDLE_Record_TypeDef *IDLE_GetRecord(void);
+
+void IDLE_ResetStats(void);
+
+PRINT_Err_TypeDef IDLE_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+const HISTOGRAM_TypeDef *IDLE_GetHist(IDLE_Mode_TypeDef mode,
+                                      IDLE_Hist_TypeDef hist);
+
+void IDLE_BenchStart(uint32_t periods);
+
+uint32_t IDLE_BenchRemaining(void);
+
+PRINT_Err_TypeDef IDLE_BenchPrint(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_IDLE_H_ */
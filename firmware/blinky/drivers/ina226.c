@@ -179,12 +179,8 @@ INA226_Err_TypeDef INA226_ReadShuntVoltage(INA226_TypeDef* const ina226,
     return ret;
   }
 
-  /* Convert two's complement if number is negative */
-  if(tmp >> 15)
-  {
-  	*val = -(tmp & 0x7FFF);
-  }
-  else *val = tmp;
+  /* Register is two's complement */
+  *val = (int16_t)tmp;
 
   return(ret);
 
@@ -272,11 +268,8 @@ INA226_Err_TypeDef INA226_ReadCurr(INA226_TypeDef* const ina226,
     return ret;
   }
 
-  if(tmp >> 15)
-  {
-  	*val = -(tmp & 0x7FFF);
-  }
-  else *val = tmp;
+  /* Register is two's complement */
+  *val = (int16_t)tmp;
 
   return(ret);
 
@@ -369,6 +362,6 @@ int INA226_BusVoltageToUV(int val)
 int INA226_ShuntVoltageToUA(int val, uint32_t senseResistor )
 {
   /* Divide Shunt Voltage Register (with LSB equal to 2.5uV) by sense resistor
-   * in mOhm to get current in uA */
-  return val * INA226_SHUNTVOLTAGELSB / senseResistor;
+   * in mOhm to get current in uA, signed so reverse current stays negative */
+  return val * INA226_SHUNTVOLTAGELSB / (int)senseResistor;
 }
@@ -0,0 +1,404 @@
+/** @file ivsweep.c
+*   @brief Panel IV Sweep Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "ivsweep.h"
+#include "mppt.h"
+#include "telemetry.h"
+#include "tca9548a.h"
+#include "ina226.h"
+#include "ad5324.h"
+#include "eps.h"
+#include "governor.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/* RTI counter counts per us */
+#define IVSWEEP_COUNTS_PER_US     (SCHEDULER_FRC_HZ / 1000000U)
+
+/* INA226 configuration during a sweep: no averaging, 140 us conversions of
+ * shunt and bus, continuous */
+#define IVSWEEP_INA226_CONFIG     ((uint16_t)(INA226_CONFIG_AVG_1SAMPLE   | \
+                                              INA226_CONFIG_VBUSCT_140US  | \
+                                              INA226_CONFIG_VSHCT_140US   | \
+                                              INA226_CONFIG_MODE_SBCONT))
+
+/* Open circuit to below the knee of one XTJ cell on the LTC3119 MPPC input,
+ * 64 points */
+const IVSWEEP_Ramp_TypeDef IVSWEEP_DefaultRamp =
+{
+  MPPT_MV_TO_CODE(0U),
+  MPPT_MV_TO_CODE(1512U),
+  MPPT_MV_TO_CODE(24U),
+  500U
+};
+
+static IVSWEEP_Point_TypeDef IVSWEEP_Points[IVSWEEP_MAX_POINTS];
+static IVSWEEP_Result_TypeDef IVSWEEP_Result;
+
+static INA226_TypeDef *IVSWEEP_Sensor = 0;
+static uint16_t IVSWEEP_SavedConfig;
+static uint16_t IVSWEEP_SavedCode;
+static uint8_t IVSWEEP_WasEnabled;
+static uint32_t IVSWEEP_StartCount;
+
+static IVSWEEP_Err_TypeDef IVSWEEP_Point(uint32_t index);
+static void IVSWEEP_Finish(IVSWEEP_State_TypeDef state, IVSWEEP_Err_TypeDef err);
+static void IVSWEEP_Wait(uint32_t us);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the result. Call after MPPT_Init, run IVSWEEP_Update every
+ *   IVSWEEP_PERIOD.
+ ******************************************************************************/
+void IVSWEEP_Init(void)
+{
+  IVSWEEP_Result.state = IVSWEEP_State_Idle;
+  IVSWEEP_Result.error = IVSWEEP_Err_NoError;
+  IVSWEEP_Result.points = 0U;
+  IVSWEEP_Result.total = 0U;
+  IVSWEEP_Sensor = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Take points of a running sweep until the slice is used up. Run as a
+ *   scheduler task every IVSWEEP_PERIOD.
+ ******************************************************************************/
+void IVSWEEP_Update(void)
+{
+  uint32_t start = SCHEDULER_GetCounter();
+  uint32_t point;
+  IVSWEEP_Err_TypeDef err;
+
+  if ( IVSWEEP_Result.state != IVSWEEP_State_Running )
+  {
+    return;
+  }
+
+  /* Point cost: dwell, conversions and about 1 ms of I2C */
+  point = (IVSWEEP_Result.ramp.dwell + IVSWEEP_CONV_US + 1000U) * IVSWEEP_COUNTS_PER_US;
+
+  /* Other tasks may have moved the mux since the last slice */
+  if ( TCA9548A_RegisterSet(IVSWEEP_Sensor->i2c, EPS_MUX1_I2CADDR,
+                            IVSWEEP_Sensor->muxChan) != TCA9548A_Err_NoError )
+  {
+    IVSWEEP_Finish(IVSWEEP_State_Failed, IVSWEEP_Err_Measure);
+    return;
+  }
+
+  do
+  {
+    err = IVSWEEP_Point(IVSWEEP_Result.points);
+
+    if ( err != IVSWEEP_Err_NoError )
+    {
+      IVSWEEP_Finish(IVSWEEP_State_Failed, err);
+      return;
+    }
+
+    if ( ++IVSWEEP_Result.points >= IVSWEEP_Result.total )
+    {
+      IVSWEEP_Finish(IVSWEEP_State_Done, IVSWEEP_Err_NoError);
+      return;
+    }
+  } while ( SCHEDULER_GetCounter() - start + point
+            <= IVSWEEP_SLICE_US * IVSWEEP_COUNTS_PER_US );
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start a sweep of one panel. Its controller is disabled until the sweep
+ *   ends and the previous curve is discarded.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @param[in] ramp
+ *   Ramp of codes, or null for IVSWEEP_DefaultRamp.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+IVSWEEP_Err_TypeDef IVSWEEP_Start(MPPT_Channel_TypeDef channel,
+                                  const IVSWEEP_Ramp_TypeDef *ramp)
+{
+  const MPPT_State_TypeDef *s = MPPT_GetState(channel);
+  INA226_TypeDef *sensor;
+  uint32_t span;
+
+  if ( IVSWEEP_Result.state == IVSWEEP_State_Running )
+  {
+    return IVSWEEP_Err_Busy;
+  }
+
+  if ( ramp == 0 )
+  {
+    ramp = &IVSWEEP_DefaultRamp;
+  }
+
+  sensor = TELEMETRY_GetSensor((TELEMETRY_Channel_TypeDef)(TELEMETRY_Channel_MPPT1 + channel));
+  span = (ramp->stop > ramp->start) ? (uint32_t)(ramp->stop - ramp->start)
+                                    : (uint32_t)(ramp->start - ramp->stop);
+
+  if ( s == 0 || sensor == 0 || ramp->step == 0U ||
+       ramp->start > 0xFFFU || ramp->stop > 0xFFFU ||
+       span / ramp->step + 1U > IVSWEEP_MAX_POINTS )
+  {
+    return IVSWEEP_Err_Invalid;
+  }
+
+  if ( TCA9548A_RegisterSet(sensor->i2c, EPS_MUX1_I2CADDR, sensor->muxChan)
+       != TCA9548A_Err_NoError
+       || sensor->RegisterGet(sensor, INA226_RegConfig, &IVSWEEP_SavedConfig)
+       != INA226_Err_NoError
+       || sensor->RegisterSet(sensor, INA226_RegConfig, IVSWEEP_INA226_CONFIG)
+       != INA226_Err_NoError )
+  {
+    return IVSWEEP_Err_Measure;
+  }
+
+  IVSWEEP_Sensor = sensor;
+  IVSWEEP_SavedCode = s->code;
+  IVSWEEP_WasEnabled = s->enabled;
+  (void)MPPT_Enable(channel, 0U);
+
+  IVSWEEP_Result.state = IVSWEEP_State_Running;
+  IVSWEEP_Result.error = IVSWEEP_Err_NoError;
+  IVSWEEP_Result.channel = channel;
+  IVSWEEP_Result.ramp = *ramp;
+  IVSWEEP_Result.points = 0U;
+  IVSWEEP_Result.total = span / ramp->step + 1U;
+  IVSWEEP_Result.mpp = 0U;
+  IVSWEEP_Result.peakPower = 0;
+  IVSWEEP_Result.duration = 0U;
+
+  /* The sweep busy waits, which would raise the clock part way through
+   * the curve; take the top level for all of it */
+  (void)GOVERNOR_Request(GOVERNOR_Client_Mppt, GOVERNOR_Level_Max);
+  IVSWEEP_StartCount = SCHEDULER_GetCounter();
+
+  return IVSWEEP_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stop a running sweep and hand the panel back to its controller. The
+ *   points taken so far are kept.
+ ******************************************************************************/
+void IVSWEEP_Abort(void)
+{
+  if ( IVSWEEP_Result.state == IVSWEEP_State_Running )
+  {
+    IVSWEEP_Finish(IVSWEEP_State_Failed, IVSWEEP_Err_NoError);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the summary of the last sweep.
+ *
+ * @return
+ *   Returns pointer to the result.
+ ******************************************************************************/
+const IVSWEEP_Result_TypeDef *IVSWEEP_GetResult(void)
+{
+  return &IVSWEEP_Result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the points of the last sweep, IVSWEEP_GetResult()->points of them.
+ *
+ * @return
+ *   Returns pointer to the first point.
+ ******************************************************************************/
+const IVSWEEP_Point_TypeDef *IVSWEEP_GetPoints(void)
+{
+  return IVSWEEP_Points;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print a summary line and the points of the last sweep, one
+ *   "code,uV,uA" line each.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef IVSWEEP_PrintCurve(PORT_UART_Reg_TypeDef *uart)
+{
+  static const char * const states[] = { "IDLE", "RUNNING", "DONE", "FAILED" };
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const IVSWEEP_Result_TypeDef *r = &IVSWEEP_Result;
+  const IVSWEEP_Point_TypeDef *p;
+  uint32_t i;
+
+  PRINT_PrintString(uart,(char*)states[r->state]);
+  PRINT_PrintString(uart," MPPT");
+  PRINT_FormatUInt(buf,(uint32_t)r->channel + 1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," POINTS=");
+  PRINT_FormatUInt(buf,r->points);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintChar(uart,'/');
+  PRINT_FormatUInt(buf,r->total);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," PMAX=");
+  PRINT_FormatEng(buf,r->peakPower,PRINT_Unit_mW,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," AT CODE=");
+  PRINT_FormatUInt(buf,(r->points > 0U) ? IVSWEEP_Points[r->mpp].code : 0U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," TIME=");
+  PRINT_FormatUInt(buf,r->duration / IVSWEEP_COUNTS_PER_US);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," us ERR=");
+  PRINT_FormatUInt(buf,r->error);
+  PRINT_PrintStringln(uart,buf);
+
+  for ( i = 0U; i < r->points; i++ )
+  {
+    p = &IVSWEEP_Points[i];
+
+    PRINT_FormatUInt(buf,p->code);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintChar(uart,',');
+    PRINT_FormatInt(buf,p->voltage);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintChar(uart,',');
+    PRINT_FormatInt(buf,p->current);
+    PRINT_PrintStringln(uart,buf);
+  }
+
+  return PRINT_Err_NoError;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Set the code of a point, wait for the panel and a fresh conversion, then
+ *   read and store voltage and current.
+ *
+ * @param[in] index
+ *   Point index.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+static IVSWEEP_Err_TypeDef IVSWEEP_Point(uint32_t index)
+{
+  const IVSWEEP_Ramp_TypeDef *ramp = &IVSWEEP_Result.ramp;
+  IVSWEEP_Point_TypeDef *p = &IVSWEEP_Points[index];
+  uint16_t busV;
+  uint16_t shuntV;
+  int32_t power;
+
+  p->code = (ramp->stop > ramp->start)
+          ? (uint16_t)(ramp->start + index * ramp->step)
+          : (uint16_t)(ramp->start - index * ramp->step);
+
+  if ( AD5324_Write((AD5324_Channel_TypeDef)((uint32_t)AD5324_ChannelA + IVSWEEP_Result.channel),
+                    AD5324_UpdateEnable,
+                    AD5324_ModeEnable,
+                    p->code) != AD5324_Err_NoError )
+  {
+    return IVSWEEP_Err_SetPoint;
+  }
+
+  IVSWEEP_Wait(ramp->dwell + IVSWEEP_CONV_US);
+
+  if ( IVSWEEP_Sensor->RegisterGet(IVSWEEP_Sensor, INA226_RegBusV, &busV)
+       != INA226_Err_NoError
+       || IVSWEEP_Sensor->RegisterGet(IVSWEEP_Sensor, INA226_RegShuntV, &shuntV)
+       != INA226_Err_NoError )
+  {
+    return IVSWEEP_Err_Measure;
+  }
+
+  p->voltage = INA226_BusVoltageToUV(busV);
+  p->current = INA226_ShuntVoltageToUA((int16_t)shuntV, IVSWEEP_Sensor->senseResistor);
+
+  power = (p->voltage > 0 && p->current > 0)
+          ? (int32_t)(((int64_t)p->voltage * p->current) / 1000000)
+          : 0;
+
+  if ( index == 0U || power > IVSWEEP_Result.peakPower )
+  {
+    IVSWEEP_Result.peakPower = power;
+    IVSWEEP_Result.mpp = index;
+  }
+
+  return IVSWEEP_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   End the sweep, restore the power monitor configuration and the DAC code
+ *   and hand the panel back to its controller.
+ *
+ * @param[in] state
+ *   Final state.
+ *
+ * @param[in] err
+ *   Error that ended the sweep.
+ ******************************************************************************/
+static void IVSWEEP_Finish(IVSWEEP_State_TypeDef state, IVSWEEP_Err_TypeDef err)
+{
+  MPPT_Channel_TypeDef channel = IVSWEEP_Result.channel;
+
+  IVSWEEP_Result.duration = SCHEDULER_GetCounter() - IVSWEEP_StartCount;
+  IVSWEEP_Result.state = state;
+  IVSWEEP_Result.error = err;
+
+  (void)TCA9548A_RegisterSet(IVSWEEP_Sensor->i2c, EPS_MUX1_I2CADDR,
+                             IVSWEEP_Sensor->muxChan);
+  (void)IVSWEEP_Sensor->RegisterSet(IVSWEEP_Sensor, INA226_RegConfig,
+                                    IVSWEEP_SavedConfig);
+
+  (void)AD5324_Write((AD5324_Channel_TypeDef)((uint32_t)AD5324_ChannelA + channel),
+                     AD5324_UpdateEnable,
+                     AD5324_ModeEnable,
+                     IVSWEEP_SavedCode);
+
+  /* The tracker resumes in the light the sweep saw, measure it there */
+  if ( IVSWEEP_WasEnabled )
+  {
+    (void)MPPT_Enable(channel, 1U);
+    if ( state == IVSWEEP_State_Done && IVSWEEP_Result.peakPower > 0 )
+    {
+      (void)MPPT_SetReference(channel, (uint32_t)IVSWEEP_Result.peakPower);
+    }
+  }
+
+  (void)GOVERNOR_Release(GOVERNOR_Client_Mppt);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Busy wait on the RTI free running counter.
+ *
+ * @param[in] us
+ *   Time in us.
+ ******************************************************************************/
+static void IVSWEEP_Wait(uint32_t us)
+{
+  uint32_t start = SCHEDULER_GetCounter();
+  uint32_t counts = us * IVSWEEP_COUNTS_PER_US;
+
+  while ( SCHEDULER_GetCounter() - start < counts ) {}
+}
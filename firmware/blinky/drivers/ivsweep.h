@@ -0,0 +1,162 @@
+/** @file ivsweep.h
+*   @brief Panel IV Sweep Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup IVSWEEP IVSWEEP
+ *  @brief Traces the IV curve of a solar panel in flight.
+ *
+ *  A sweep takes one panel away from its MPPT controller and drives its
+ *  AD5324 channel through a ramp of codes. At every point it waits the
+ *  dwell time for the LTC3119 input to settle, then for a fresh conversion
+ *  of the panel's INA226, and stores the code, voltage and current. The
+ *  INA226 runs with the shortest conversion time during the sweep and gets
+ *  its configuration back afterwards; the controller is re-enabled and
+ *  restarts tracking, and measures its tracking efficiency against the
+ *  maximum power the sweep found.
+ *
+ *  Points are timed with the RTI free running counter. The sweep runs in
+ *  slices of up to IVSWEEP_SLICE_US from its lowest priority task, so the
+ *  other tasks are held up by one slice at most and keep their deadlines. A
+ *  point costs the dwell, two conversions and two register reads over I2C,
+ *  about 2 ms at 100 kHz; the default 65 point curve takes around 200 ms,
+ *  against seconds per point on the bench. The clock governor is held at
+ *  its top level for the sweep, so no clock change lands inside a curve.
+ *
+ *  The last curve stays in a buffer until the next sweep starts and can be
+ *  downloaded with IVSWEEP_PrintCurve.
+ *
+ *	Related Files
+ *   - ivsweep.h
+ *   - ivsweep.c
+ *   - mppt.h
+ *   - telemetry.h
+ *   - ad5324.h
+ *   - governor.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_IVSWEEP_H_
+#define DRIVERS_IVSWEEP_H_
+
+#include "mppt.h"
+#include "telemetry.h"
+#include "ad5324.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Points of the curve buffer */
+#define IVSWEEP_MAX_POINTS        (256U)
+
+/** Release period of the sweep task, in ticks */
+#define IVSWEEP_PERIOD            (SCHEDULER_MS(10))
+
+/** Longest run of one task release, in us */
+#define IVSWEEP_SLICE_US          (8000U)
+
+/** Wait for a fresh shunt and bus conversion at 140 us each, in us */
+#define IVSWEEP_CONV_US           (2U * 2U * 140U)
+
+/**
+ *  @addtogroup IVSWEEP
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum IVSWEEP_Err_TypeDef
+*   @brief Alias names for IVSWEEP errors.
+*/
+typedef enum
+{
+  IVSWEEP_Err_NoError  = 0U,    /**< No error*/
+  IVSWEEP_Err_Busy     = 1U,    /**< A sweep is running*/
+  IVSWEEP_Err_Invalid  = 2U,    /**< Channel or ramp out of range*/
+  IVSWEEP_Err_Measure  = 3U,    /**< Power monitor could not be read*/
+  IVSWEEP_Err_SetPoint = 4U     /**< DAC write failed*/
+} IVSWEEP_Err_TypeDef;
+
+/** @enum IVSWEEP_State_TypeDef
+*   @brief Sweep states.
+*/
+typedef enum
+{
+  IVSWEEP_State_Idle    = 0,    /**< No curve taken since reset*/
+  IVSWEEP_State_Running = 1,    /**< Sweep in progress*/
+  IVSWEEP_State_Done    = 2,    /**< Curve complete*/
+  IVSWEEP_State_Failed  = 3     /**< Stopped by an error or abort, curve partial*/
+} IVSWEEP_State_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct IVSWEEP_Ramp_TypeDef
+*   @brief Ramp of DAC codes. The step sign follows from start and stop.
+*/
+typedef struct
+{
+  uint16_t start;                   /**< First code*/
+  uint16_t stop;                    /**< Last code, included if on a step*/
+  uint16_t step;                    /**< Code increment, non-zero*/
+  uint32_t dwell;                   /**< Settling time per point in us*/
+} IVSWEEP_Ramp_TypeDef;
+
+/** @struct IVSWEEP_Point_TypeDef
+*   @brief One point of the curve.
+*/
+typedef struct
+{
+  uint16_t code;                    /**< DAC code*/
+  int32_t voltage;                  /**< Panel voltage in uV*/
+  int32_t current;                  /**< Panel current in uA*/
+} IVSWEEP_Point_TypeDef;
+
+/** @struct IVSWEEP_Result_TypeDef
+*   @brief Summary of the last sweep.
+*/
+typedef struct
+{
+  IVSWEEP_State_TypeDef state;      /**< State of the sweep*/
+  IVSWEEP_Err_TypeDef error;        /**< Error that stopped it*/
+  MPPT_Channel_TypeDef channel;     /**< Panel swept*/
+  IVSWEEP_Ramp_TypeDef ramp;        /**< Ramp used*/
+  uint32_t points;                  /**< Points taken*/
+  uint32_t total;                   /**< Points of the ramp*/
+  uint32_t mpp;                     /**< Index of the highest power point*/
+  int32_t peakPower;                /**< Highest power in uW*/
+  uint32_t duration;                /**< Start to end in RTI counter counts*/
+} IVSWEEP_Result_TypeDef;
+
+extern const IVSWEEP_Ramp_TypeDef IVSWEEP_DefaultRamp;
+
+void IVSWEEP_Init(void);
+
+void IVSWEEP_Update(void);
+
+IVSWEEP_Err_TypeDef IVSWEEP_Start(MPPT_Channel_TypeDef channel,
+                                  const IVSWEEP_Ramp_TypeDef *ramp);
+
+void IVSWEEP_Abort(void);
+
+const IVSWEEP_Result_TypeDef *IVSWEEP_GetResult(void);
+
+const IVSWEEP_Point_TypeDef *IVSWEEP_GetPoints(void);
+
+PRINT_Err_TypeDef IVSWEEP_PrintCurve(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_IVSWEEP_H_ */
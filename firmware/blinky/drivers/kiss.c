@@ -0,0 +1,139 @@
+/** @file kiss.c
+*   @brief KISS Framing Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "kiss.h"
+#include "port_uart.h"
+#include "stdint.h"
+
+/* Worst case frame: every byte escaped, plus command, CRC and two FEND */
+static uint8_t KISS_Buffer[2U * (KISS_MAX_LENGTH + 3U) + 2U];
+
+static uint16_t KISS_Escape(uint8_t *out, uint8_t byte);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Send one data frame.
+ *
+ * @details
+ *   The frame is built in a static buffer and sent with a single UART
+ *   transfer. Not reentrant.
+ *
+ * @param[in] uart
+ *   UART to send on.
+ *
+ * @param[in] port
+ *   KISS port, 0 to 15.
+ *
+ * @param[in] data
+ *   Payload.
+ *
+ * @param[in] length
+ *   Payload length in bytes.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+KISS_Err_TypeDef KISS_Send(PORT_UART_Reg_TypeDef *uart,
+                           uint8_t port,
+                           const uint8_t *data,
+                           uint16_t length)
+{
+  uint16_t crc;
+  uint16_t n = 0U;
+  uint16_t i;
+
+  if ( length > KISS_MAX_LENGTH )
+  {
+    return KISS_Err_Length;
+  }
+
+  crc = KISS_Crc16(0xFFFFU, data, length);
+
+  KISS_Buffer[n++] = KISS_FEND;
+  n += KISS_Escape(&KISS_Buffer[n], (uint8_t)(((port & 0x0FU) << 4) | KISS_CMD_DATA));
+  for ( i = 0U; i < length; i++ )
+  {
+    n += KISS_Escape(&KISS_Buffer[n], data[i]);
+  }
+  n += KISS_Escape(&KISS_Buffer[n], (uint8_t)(crc >> 8));
+  n += KISS_Escape(&KISS_Buffer[n], (uint8_t)crc);
+  KISS_Buffer[n++] = KISS_FEND;
+
+  if ( PORT_UART_Send(uart, n, (char *)KISS_Buffer) != PORT_UART_Err_NoError )
+  {
+    return KISS_Err_UART;
+  }
+
+  return KISS_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Update a CRC-16/CCITT with a block of data.
+ *
+ * @param[in] crc
+ *   CRC so far, 0xFFFF to start.
+ *
+ * @param[in] data
+ *   Data.
+ *
+ * @param[in] length
+ *   Length in bytes.
+ *
+ * @return
+ *   Returns the updated CRC.
+ ******************************************************************************/
+uint16_t KISS_Crc16(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+  uint16_t i;
+  uint8_t bit;
+
+  for ( i = 0U; i < length; i++ )
+  {
+    crc ^= (uint16_t)data[i] << 8;
+    for ( bit = 0U; bit < 8U; bit++ )
+    {
+      crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Write one byte, escaped if needed.
+ *
+ * @return
+ *   Returns the number of bytes written, 1 or 2.
+ ******************************************************************************/
+static uint16_t KISS_Escape(uint8_t *out, uint8_t byte)
+{
+  if ( byte == KISS_FEND )
+  {
+    out[0] = KISS_FESC;
+    out[1] = KISS_TFEND;
+    return 2U;
+  }
+  if ( byte == KISS_FESC )
+  {
+    out[0] = KISS_FESC;
+    out[1] = KISS_TFESC;
+    return 2U;
+  }
+
+  out[0] = byte;
+  return 1U;
+}
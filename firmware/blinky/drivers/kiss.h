@@ -0,0 +1,81 @@
+/** @file kiss.h
+*   @brief KISS Framing Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup KISS KISS
+ *  @brief Binary frames on a UART, KISS framed as used by CSP and TNCs.
+ *
+ *  A frame is FEND, a command byte with the port in the high nibble and
+ *  0 (data) in the low nibble, the payload followed by its CRC-16, and
+ *  FEND. FEND and FESC inside the frame are escaped, so a receiver
+ *  resynchronises on the next FEND and binary frames can share the
+ *  console UART with text.
+ *
+ *  The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial value
+ *  0xFFFF), sent most significant byte first.
+ *
+ *	Related Files
+ *   - kiss.h
+ *   - kiss.c
+ *   - port_uart.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_KISS_H_
+#define DRIVERS_KISS_H_
+
+#include "port_uart.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+#define KISS_FEND                 (0xC0U)
+#define KISS_FESC                 (0xDBU)
+#define KISS_TFEND                (0xDCU)
+#define KISS_TFESC                (0xDDU)
+
+/** Command nibble of a data frame */
+#define KISS_CMD_DATA             (0x00U)
+
+/** Longest payload, CRC excluded */
+#define KISS_MAX_LENGTH           (256U)
+
+/**
+ *  @addtogroup KISS
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum KISS_Err_TypeDef
+*   @brief Alias names for KISS errors.
+*/
+typedef enum
+{
+  KISS_Err_NoError = 0U,          /**< No error*/
+  KISS_Err_Length  = 1U,          /**< Payload longer than KISS_MAX_LENGTH*/
+  KISS_Err_UART    = 2U           /**< UART reported an error*/
+} KISS_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+KISS_Err_TypeDef KISS_Send(PORT_UART_Reg_TypeDef *uart,
+                           uint8_t port,
+                           const uint8_t *data,
+                           uint16_t length);
+
+uint16_t KISS_Crc16(uint16_t crc, const uint8_t *data, uint16_t length);
+
+/**@}*/
+
+#endif /* DRIVERS_KISS_H_ */
@@ -1,150 +1,175 @@
+/** @file low_power_mode.c
+*   @brief Low Power Mode Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "low_power_mode.h"
 #include "sys_common.h"
-#include "rti.h"
-#include "sys_mpu.h"
+#include "sys_core.h"
 #include "reg_flash.h"
 #include "system.h"
+#include "stdint.h"
 
-/***********************************************
- * Enter the doze mode:
- * - All the interrupts, besides main OSC, are disabled
- * - All the clock domains, besides RTICLK, are turned off
- * - Flash module is set to sleep mode
- *
- **********************************************/
-void enter_doze(void)
-{
-    /* Set up flash pump active grace period as 7 HCLK/16 cycles */
-    flashWREG->FPAC2 = 0x7;
+/* Clock sources left running in each mode, all others are disabled */
+#define LOW_POWER_CSDIS_DOZE      (0xFEU)   /* Main oscillator only */
+#define LOW_POWER_CSDIS_SNOOZE    (0xEFU)   /* LF LPO only */
 
-    /* Set flash bank fallback modes to "sleep" */
-    flashWREG->FBFALLBACK = (uint32)((uint32)SYS_SLEEP << 14U) /* BANK 7 */
-                          | (uint32)((uint32)SYS_SLEEP << 2U)  /* BANK 1 */
-                          | (uint32)((uint32)SYS_SLEEP << 0U); /* BANK 0 */
+/* All clock domains except RTICLK */
+#define LOW_POWER_CDDIS_SLEEP     (0xFFBFU)
 
-    /* Disable oscillator monitoring to prevent detection of oscillator failure */
-    systemREG1->CLKTEST = 0x010A0000;
+/* CLKTEST bit that disables oscillator failure detection */
+#define LOW_POWER_CLKTEST_RANGEDET (0x01000000U)
 
-    /* Clock RTI using LF LPO, the 80KHz clock source */
-    systemREG1->RCLKSRC |= 0x4;
+/* RCLKSRC RTI1SRC and RTI1DIV fields */
+#define LOW_POWER_RCLKSRC_MASK    (0x0000030FU)
 
-    /** - Setup RTI compare 1 value. This value is compared with the selected free running counter. */
-    rtiREG1->CMP[1U].COMPx = 400000U;
+/* PLLCTL1 PLLDIV field, programmed to its maximum while the PLL locks */
+#define LOW_POWER_PLLDIV_MASK     (0x1F000000U)
 
-    /** - Setup RTI compare 1 update value. This value is added to the compare 1 value on each compare match. */
-    rtiREG1->CMP[1U].UDCPx = 400000U;
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
 
-    /** - Clear all pending interrupts */
-    rtiREG1->INTFLAG = 0x0007000FU;
-
-    /** - Disable all interrupts */
-    rtiREG1->CLEARINTENA = 0x00070F0FU;
+/***************************************************************************//**
+ * @brief
+ *   Get nominal frequency of the RTI clock while in a low power mode.
+ *
+ * @param[in] mode
+ *   Low power mode.
+ *
+ * @return
+ *   Returns RTICLK in Hz, before the counter prescaler.
+ ******************************************************************************/
+uint32_t LOW_POWER_RtiSourceHz(LOW_POWER_Mode_TypeDef mode)
+{
+  return (mode == LOW_POWER_Mode_Doze) ? LOW_POWER_OSC_HZ : LOW_POWER_LPO_LF_HZ;
+}
 
-    /** - Enable RTI Compare 1 Interrupt **/
-    rtiREG1->SETINTENA = rtiNOTIFICATION_COMPARE1;
+/***************************************************************************//**
+ * @brief
+ *   Clock the RTI from the source that survives a low power mode.
+ *
+ * @details
+ *   The RTI counters must be stopped while the source is changed.
+ *
+ * @param[in] mode
+ *   Low power mode about to be entered.
+ *
+ * @param[out] ctx
+ *   Context the current RTI clock selection is saved to.
+ ******************************************************************************/
+void LOW_POWER_SelectRtiClock(LOW_POWER_Mode_TypeDef mode,
+                              LOW_POWER_Context_TypeDef *ctx)
+{
+  uint32_t src = (mode == LOW_POWER_Mode_Doze) ? (uint32_t)SYS_OSC
+                                                : (uint32_t)SYS_LPO_LOW;
 
-    /* Turn off all clock sources except LF LPO */
-    systemREG1->CSDISSET = 0xFE;
+  ctx->rclksrc = systemREG1->RCLKSRC;
 
-    /* Turn off all clock domains except RTICLK */
-    systemREG1->CDDISSET = 0xFFBF;
+  /* Undivided, the divider only applies to non-VCLK sources */
+  systemREG1->RCLKSRC = (ctx->rclksrc & ~LOW_POWER_RCLKSRC_MASK) | src;
+}
 
-    asm(" WFI");
-    asm(" nop");
-    asm(" nop");
-    asm(" nop");
-    asm(" nop");
+/***************************************************************************//**
+ * @brief
+ *   Restore the RTI clock selection saved by LOW_POWER_SelectRtiClock.
+ *
+ * @details
+ *   The RTI counters must be stopped while the source is changed.
+ *
+ * @param[in] ctx
+ *   Saved context.
+ ******************************************************************************/
+void LOW_POWER_RestoreRtiClock(const LOW_POWER_Context_TypeDef *ctx)
+{
+  systemREG1->RCLKSRC = ctx->rclksrc;
 }
 
-/***********************************************
- * Enter the snooze mode:
- * - All the interrupts, besides RTI, are disabled
- * - All the clock domains, besides RTICLK, are turned off
- * - Flash module is set to sleep mode
+/***************************************************************************//**
+ * @brief
+ *   Enter doze or snooze and wait for a wakeup interrupt.
+ *
+ * @details
+ *   Must be called with IRQ masked. The core still wakes on a pending
+ *   interrupt and returns from this function running on the oscillator (or
+ *   the wakeup source selected in GHVSRC); LOW_POWER_RestoreClocks must be
+ *   called before anything timing sensitive runs.
+ *
+ * @param[in] mode
+ *   Low power mode.
  *
- **********************************************/
-void enter_snooze(void)
+ * @param[out] ctx
+ *   Context the clock and flash configuration is saved to.
+ ******************************************************************************/
+void LOW_POWER_Enter(LOW_POWER_Mode_TypeDef mode,
+                     LOW_POWER_Context_TypeDef *ctx)
 {
-    /* Set up flash pump active grace period as 7 HCLK/16 cycles */
-    flashWREG->FPAC2 = 0x7;
+  ctx->csdis = systemREG1->CSDIS;
+  ctx->cddis = systemREG1->CDDIS;
+  ctx->ghvsrc = systemREG1->GHVSRC;
+  ctx->pllctl1 = systemREG1->PLLCTL1;
+  ctx->clktest = systemREG1->CLKTEST;
+  ctx->fbfallback = flashWREG->FBFALLBACK;
+  ctx->fpac2 = flashWREG->FPAC2;
 
-    /* Set flash bank fallback modes to "sleep" */
-    flashWREG->FBFALLBACK = (uint32)((uint32)SYS_SLEEP << 14U) /* BANK 7 */
-                          | (uint32)((uint32)SYS_SLEEP << 2U)  /* BANK 1 */
-                          | (uint32)((uint32)SYS_SLEEP << 0U); /* BANK 0 */
+  /* Set up flash pump active grace period as 7 HCLK/16 cycles */
+  flashWREG->FPAC2 = 0x7U;
 
-    /* Disable oscillator monitoring to prevent detection of oscillator failure */
-    systemREG1->CLKTEST = 0x010A0000;
+  /* Set flash bank fallback modes to "sleep" */
+  flashWREG->FBFALLBACK = (uint32)((uint32)SYS_SLEEP << 14U) /* BANK 7 */
+                        | (uint32)((uint32)SYS_SLEEP << 2U)  /* BANK 1 */
+                        | (uint32)((uint32)SYS_SLEEP << 0U); /* BANK 0 */
 
-    /* Clock RTI using LF LPO, the 80KHz clock source */
-    systemREG1->RCLKSRC |= 0x4;
+  /* Disable oscillator monitoring to prevent detection of oscillator failure */
+  systemREG1->CLKTEST = ctx->clktest | LOW_POWER_CLKTEST_RANGEDET;
 
-    /** - Setup RTI compare 1 value. This value is compared with the selected free running counter. */
-    rtiREG1->CMP[1U].COMPx = 400000U;
+  /* Turn off all clock sources except the one clocking the RTI */
+  systemREG1->CSDISSET = (mode == LOW_POWER_Mode_Doze) ? LOW_POWER_CSDIS_DOZE
+                                                       : LOW_POWER_CSDIS_SNOOZE;
 
-    /** - Setup RTI compare 1 update value. This value is added to the compare 1 value on each compare match. */
-    rtiREG1->CMP[1U].UDCPx = 400000U;
+  /* Turn off all clock domains except RTICLK */
+  systemREG1->CDDISSET = LOW_POWER_CDDIS_SLEEP;
 
-    /** - Clear all pending interrupts */
-    rtiREG1->INTFLAG = 0x0007000FU;
+  _gotoCPUIdle_();
+}
 
-    /** - Disable all interrupts */
-    rtiREG1->CLEARINTENA = 0x00070F0FU;
+/***************************************************************************//**
+ * @brief
+ *   Restore clock sources, domains and flash after a wakeup.
+ *
+ * @details
+ *   The PLL output divider is raised to its maximum while the PLL relocks
+ *   and put back once all sources are valid, like setupPLL does at reset,
+ *   so the supply does not see a full speed current step.
+ *
+ * @param[in] ctx
+ *   Context saved by LOW_POWER_Enter.
+ ******************************************************************************/
+void LOW_POWER_RestoreClocks(const LOW_POWER_Context_TypeDef *ctx)
+{
+  uint32_t valid = (~ctx->csdis) & 0xFFU;
 
-    /** - Enable RTI Compare 1 Interrupt **/
-    rtiREG1->SETINTENA = rtiNOTIFICATION_COMPARE1;
+  systemREG1->PLLCTL1 = ctx->pllctl1 | LOW_POWER_PLLDIV_MASK;
 
-    /* Turn off all clock sources except LF LPO */
-    systemREG1->CSDISSET = 0xEF;
+  /* Restart the clock sources that were running before */
+  systemREG1->CSDIS = ctx->csdis;
 
-    /* Turn off all clock domains except RTICLK */
-    systemREG1->CDDISSET = 0xFFBF;
+  while ( (systemREG1->CSVSTAT & valid) != valid )
+  {
+  }
 
-    asm(" WFI");
-    asm(" nop");
-    asm(" nop");
-    asm(" nop");
-    asm(" nop");
-}
+  systemREG1->PLLCTL1 = ctx->pllctl1;
 
-/***********************************************
- * Wake the system up from snooze mode:
- * - Restore clock sources and domains
- * - Restore Flash module
- * - Restore interrupts
- *
- **********************************************/
-void post_wakeup(void)
-{
-    /* Restart main oscillator, LF LPO, and HF LPO */
-    systemREG1->CSDISCLR = 0x31;
-
-    /* Configure PLLs based on original configuration */
-    systemREG1->PLLCTL1 =  (uint32)0x00000000U
-                        | (uint32)0x20000000U
-                        | (uint32)((uint32)0x1FU << 24U)
-                        | (uint32)0x00000000U
-                        | (uint32)((uint32)(6U - 1U) << 16U)
-                        | (uint32)((uint32)(165U - 1U) << 8U);
-
-    systemREG1->PLLCTL2 = (uint32)((uint32)255U << 22U)
-                        | (uint32)((uint32)7U << 12U)
-                        | (uint32)((uint32)(2U - 1U) << 9U)
-                        | (uint32)61U;
-
-    /* Restart all other clock sources. All clock domains are enabled automatically. */
-    systemREG1->CSDISCLR = 0xFF;
-
-    /* Restore flash bank fallback modes to "active" */
-    flashWREG->FBFALLBACK = (uint32)((uint32)SYS_ACTIVE << 14U) /* BANK 7 */
-                          | (uint32)((uint32)SYS_ACTIVE << 2U)  /* BANK 1 */
-                          | (uint32)((uint32)SYS_ACTIVE << 0U); /* BANK 0 */
-
-    /* Restore clock source/domain bindings */
-    mapClocks();
-
-    /* Enable oscillator monitoring */
-    systemREG1->CLKTEST = 0x000A0000;
-
-    /* Enable RTI Compare 0 Interrupt */
-    rtiREG1->SETINTENA = rtiNOTIFICATION_COMPARE0;
+  /* Restore flash bank fallback modes and pump grace period */
+  flashWREG->FBFALLBACK = ctx->fbfallback;
+  flashWREG->FPAC2 = ctx->fpac2;
+
+  /* Restore clock source/domain bindings */
+  systemREG1->GHVSRC = ctx->ghvsrc;
+  systemREG1->CDDIS = ctx->cddis;
+
+  /* Enable oscillator monitoring */
+  systemREG1->CLKTEST = ctx->clktest;
 }
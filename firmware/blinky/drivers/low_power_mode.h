@@ -1,10 +1,95 @@
+/** @file low_power_mode.h
+*   @brief Low Power Mode Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
 
+/**
+ *  @defgroup LOW_POWER LOW_POWER
+ *  @brief Doze and snooze entry and clock restore for the TMS570LS07.
+ *
+ *  In doze the main oscillator keeps running and clocks the RTI, in snooze
+ *  only the low frequency LPO runs. All other clock sources and domains are
+ *  switched off and the flash banks are put to sleep. The clock registers
+ *  touched on entry are saved in a context so the configuration in force
+ *  before sleeping is restored exactly, including any PLL divider changes
+ *  made at run time.
+ *
+ *  The RTI clock is switched separately because the counter must be stopped
+ *  around the change. See IDLE for the complete sequence.
+ *
+ *	Related Files
+ *   - low_power_mode.h
+ *   - low_power_mode.c
+ *   - system.h
+ *   - reg_flash.h
+ *   - stdint.h
+ */
 
-#ifndef INCLUDE_CUSTOM_LOW_POWER_MODE_H_
-#define INCLUDE_CUSTOM_LOW_POWER_MODE_H_
+#ifndef DRIVERS_LOW_POWER_MODE_H_
+#define DRIVERS_LOW_POWER_MODE_H_
 
-void enter_doze(void);
-void enter_snooze(void);
-void post_wakeup(void);
+#include "system.h"
+#include "stdint.h"
 
-#endif /* INCLUDE_CUSTOM_LOW_POWER_MODE_H_ */
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Nominal RTI source frequencies while sleeping, in Hz */
+#define LOW_POWER_OSC_HZ        (16000000U)
+#define LOW_POWER_LPO_LF_HZ     (80000U)
+
+/**
+ *  @addtogroup LOW_POWER
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum LOW_POWER_Mode_TypeDef
+*   @brief Low power modes.
+*/
+typedef enum
+{
+  LOW_POWER_Mode_Doze   = 0,  /**< Main oscillator and RTI running*/
+  LOW_POWER_Mode_Snooze = 1   /**< LF LPO and RTI running*/
+} LOW_POWER_Mode_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct LOW_POWER_Context_TypeDef
+*   @brief Clock and flash configuration saved on entry.
+*/
+typedef struct
+{
+  uint32_t csdis;
+  uint32_t cddis;
+  uint32_t ghvsrc;
+  uint32_t rclksrc;
+  uint32_t pllctl1;
+  uint32_t clktest;
+  uint32_t fbfallback;
+  uint32_t fpac2;
+} LOW_POWER_Context_TypeDef;
+
+uint32_t LOW_POWER_RtiSourceHz(LOW_POWER_Mode_TypeDef mode);
+
+void LOW_POWER_SelectRtiClock(LOW_POWER_Mode_TypeDef mode,
+                              LOW_POWER_Context_TypeDef *ctx);
+
+void LOW_POWER_RestoreRtiClock(const LOW_POWER_Context_TypeDef *ctx);
+
+void LOW_POWER_Enter(LOW_POWER_Mode_TypeDef mode,
+                     LOW_POWER_Context_TypeDef *ctx);
+
+void LOW_POWER_RestoreClocks(const LOW_POWER_Context_TypeDef *ctx);
+
+/**@}*/
+
+#endif /* DRIVERS_LOW_POWER_MODE_H_ */
@@ -0,0 +1,769 @@
+/** @file mppt.c
+*   @brief Maximum Power Point Tracking Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "mppt.h"
+#include "telemetry.h"
+#include "tca9548a.h"
+#include "ad5324.h"
+#include "eps.h"
+#include "print.h"
+#include "stdint.h"
+
+/* Longest run between reversals that still counts towards settling, a
+ * controller at the maximum power point reverses every one or two steps */
+#define MPPT_SETTLE_RUN           (2U)
+
+/* Run in one direction that ends the settled state */
+#define MPPT_UNSETTLE_RUN         (2U * MPPT_SETTLE_RUN)
+
+const MPPT_Params_TypeDef MPPT_DefaultParams =
+{
+  MPPT_Algorithm_PerturbObserve,
+  16U,
+  2U,
+  -1,
+  MPPT_MV_TO_CODE(400U),
+  MPPT_MV_TO_CODE(1500U),
+  MPPT_MV_TO_CODE(400U),
+  3U,
+  100U,
+  100U,
+  10000U
+};
+
+static const char * const MPPT_AlgorithmNames[] =
+{
+  "PO", "INC"
+};
+
+static MPPT_Params_TypeDef MPPT_Params;
+static MPPT_State_TypeDef MPPT_States[MPPT_NUM_CHANNELS];
+
+static MPPT_Measure_TypeDef MPPT_Measure = MPPT_MeasureSensor;
+static MPPT_SetPoint_TypeDef MPPT_SetPoint = MPPT_SetDac;
+static MPPT_Commit_TypeDef MPPT_Commit = MPPT_CommitDac;
+
+static MPPT_Err_TypeDef MPPT_Track(MPPT_Channel_TypeDef channel);
+static int8_t MPPT_Decide(const MPPT_State_TypeDef *s,
+                          int32_t voltage,
+                          int32_t current,
+                          int32_t power);
+static void MPPT_Unsettle(MPPT_State_TypeDef *s);
+static void MPPT_Account(MPPT_State_TypeDef *s);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize all controllers and set every DAC channel to the start code.
+ *
+ * @details
+ *   With the default functions this must be called after TELEMETRY_Init and
+ *   AD5324_Init. Controllers start enabled, run MPPT_Update every
+ *   MPPT_PERIOD.
+ *
+ * @param[in] params
+ *   Tracking parameters, or null for MPPT_DefaultParams.
+ *
+ * @param[in] Measure
+ *   Function used to read a panel, or null for MPPT_MeasureSensor.
+ *
+ * @param[in] SetPoint
+ *   Function used to stage a DAC code, or null for MPPT_SetDac.
+ *
+ * @param[in] Commit
+ *   Function used to apply the staged codes, or null for MPPT_CommitDac.
+ ******************************************************************************/
+void MPPT_Init(const MPPT_Params_TypeDef *params,
+               MPPT_Measure_TypeDef Measure,
+               MPPT_SetPoint_TypeDef SetPoint,
+               MPPT_Commit_TypeDef Commit)
+{
+  uint32_t i;
+
+  MPPT_Params = (params != 0) ? *params : MPPT_DefaultParams;
+  MPPT_Measure = (Measure != 0) ? Measure : MPPT_MeasureSensor;
+  MPPT_SetPoint = (SetPoint != 0) ? SetPoint : MPPT_SetDac;
+  MPPT_Commit = (Commit != 0) ? Commit : MPPT_CommitDac;
+
+  for ( i = 0U; i < MPPT_NUM_CHANNELS; i++ )
+  {
+    MPPT_States[i].enabled = 1U;
+    (void)MPPT_Restart((MPPT_Channel_TypeDef)i);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Step every enabled controller once and apply the new codes of all
+ *   panels together. Run as a scheduler task every MPPT_PERIOD.
+ ******************************************************************************/
+void MPPT_Update(void)
+{
+  uint32_t staged = 0U;
+  uint32_t i;
+
+  for ( i = 0U; i < MPPT_NUM_CHANNELS; i++ )
+  {
+    if ( MPPT_Track((MPPT_Channel_TypeDef)i) == MPPT_Err_NoError &&
+         MPPT_States[i].enabled )
+    {
+      staged |= 1UL << i;
+    }
+  }
+
+  if ( staged != 0U && MPPT_Commit() != MPPT_Err_NoError )
+  {
+    for ( i = 0U; i < MPPT_NUM_CHANNELS; i++ )
+    {
+      if ( (staged & (1UL << i)) != 0U )
+      {
+        MPPT_States[i].errors++;
+      }
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Step one controller and apply its new code.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_Step(MPPT_Channel_TypeDef channel)
+{
+  MPPT_Err_TypeDef err = MPPT_Track(channel);
+
+  if ( err != MPPT_Err_NoError || !MPPT_States[channel].enabled )
+  {
+    return err;
+  }
+
+  if ( MPPT_Commit() != MPPT_Err_NoError )
+  {
+    MPPT_States[channel].errors++;
+    return MPPT_Err_SetPoint;
+  }
+
+  return MPPT_Err_NoError;
+}
+/***************************************************************************//**
+ * @brief
+ *   Enable or disable a controller. A disabled controller keeps its code.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @param[in] enable
+ *   Non-zero to enable.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_Enable(MPPT_Channel_TypeDef channel, uint8_t enable)
+{
+  if ( (uint32_t)channel >= MPPT_NUM_CHANNELS )
+  {
+    return MPPT_Err_Invalid;
+  }
+
+  if ( enable && !MPPT_States[channel].enabled )
+  {
+    MPPT_States[channel].enabled = 1U;
+    return MPPT_Restart(channel);
+  }
+
+  MPPT_States[channel].enabled = (enable != 0U);
+
+  return MPPT_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Restart tracking of a controller from the start code and clear its
+ *   measurements.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_Restart(MPPT_Channel_TypeDef channel)
+{
+  MPPT_State_TypeDef *s;
+
+  if ( (uint32_t)channel >= MPPT_NUM_CHANNELS )
+  {
+    return MPPT_Err_Invalid;
+  }
+
+  s = &MPPT_States[channel];
+
+  /* Start walking down from the open circuit end */
+  s->settled = 0U;
+  s->direction = (int8_t)-MPPT_Params.polarity;
+  s->code = MPPT_Params.startCode;
+  s->voltage = 0;
+  s->current = 0;
+  s->power = 0;
+  s->run = 0U;
+  s->reversals = 0U;
+  s->steps = 0U;
+  s->errors = 0U;
+  s->convergeStart = 0U;
+  s->convergeSteps = 0U;
+  s->efficiency = 0U;
+  s->reference = 0U;
+  s->peakPower = 0U;
+  s->windowSum = 0U;
+  s->windowPeak = 0U;
+  s->windowCount = 0U;
+
+  if ( MPPT_SetPoint(channel, s->code) != MPPT_Err_NoError ||
+       MPPT_Commit() != MPPT_Err_NoError )
+  {
+    s->errors++;
+    return MPPT_Err_SetPoint;
+  }
+
+  return MPPT_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Change the algorithm of all controllers and restart tracking.
+ *
+ * @param[in] algorithm
+ *   New algorithm.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_SetAlgorithm(MPPT_Algorithm_TypeDef algorithm)
+{
+  uint32_t i;
+
+  if ( algorithm != MPPT_Algorithm_PerturbObserve &&
+       algorithm != MPPT_Algorithm_IncCond )
+  {
+    return MPPT_Err_Invalid;
+  }
+
+  MPPT_Params.algorithm = algorithm;
+
+  for ( i = 0U; i < MPPT_NUM_CHANNELS; i++ )
+  {
+    if ( MPPT_States[i].enabled )
+    {
+      (void)MPPT_Restart((MPPT_Channel_TypeDef)i);
+    }
+  }
+
+  return MPPT_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Measure the tracking efficiency of a controller against the maximum
+ *   power of an IV sweep of its panel just taken.
+ *
+ * @details
+ *   The first full window once the controller has settled again gives the
+ *   efficiency, as its mean power over the sweep's.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @param[in] power
+ *   Maximum power the sweep found in uW, 0 to measure nothing.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_SetReference(MPPT_Channel_TypeDef channel, uint32_t power)
+{
+  MPPT_State_TypeDef *s;
+
+  if ( (uint32_t)channel >= MPPT_NUM_CHANNELS )
+  {
+    return MPPT_Err_Invalid;
+  }
+
+  s = &MPPT_States[channel];
+  s->reference = power;
+  s->windowSum = 0U;
+  s->windowPeak = 0U;
+  s->windowCount = 0U;
+
+  return MPPT_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get tracking parameters in use.
+ *
+ * @return
+ *   Returns pointer to parameters.
+ ******************************************************************************/
+const MPPT_Params_TypeDef *MPPT_GetParams(void)
+{
+  return &MPPT_Params;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get state of a controller.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @return
+ *   Returns pointer to state, or null if channel is out of range.
+ ******************************************************************************/
+const MPPT_State_TypeDef *MPPT_GetState(MPPT_Channel_TypeDef channel)
+{
+  if ( (uint32_t)channel >= MPPT_NUM_CHANNELS )
+  {
+    return 0;
+  }
+
+  return &MPPT_States[channel];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print operating point, tracking efficiency and convergence time of a
+ *   controller on one line.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef MPPT_PrintStats(PORT_UART_Reg_TypeDef *uart,
+                                  MPPT_Channel_TypeDef channel)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const MPPT_State_TypeDef *s = MPPT_GetState(channel);
+
+  if ( s == 0 )
+  {
+    return PRINT_PrintStringln(uart,"\033[0;31mERROR: Invalid MPPT channel\033[0m");
+  }
+
+  PRINT_PrintString(uart,s->enabled ? "ON ALG=" : "OFF ALG=");
+  PRINT_PrintString(uart,(char*)MPPT_AlgorithmNames[MPPT_Params.algorithm]);
+  PRINT_PrintString(uart," CODE=");
+  PRINT_FormatUInt(buf,s->code);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," V=");
+  PRINT_FormatEng(buf,s->voltage,PRINT_Unit_mV,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," I=");
+  PRINT_FormatEng(buf,s->current,PRINT_Unit_mA,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," P=");
+  PRINT_FormatEng(buf,s->power,PRINT_Unit_mW,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," EFF=");
+  PRINT_FormatFixed(buf,(int32_t)s->efficiency,1U,1U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart,s->settled ? " SETTLED CONV=" : " TRACKING CONV=");
+  PRINT_FormatUInt(buf,s->convergeSteps * (MPPT_PERIOD * SCHEDULER_TICK_US / 1000U));
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ms STEPS=");
+  PRINT_FormatUInt(buf,s->steps);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ERRORS=");
+  PRINT_FormatUInt(buf,s->errors);
+
+  return PRINT_PrintStringln(uart,buf);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read panel voltage and current from the MPPT power monitor of a channel.
+ *
+ * @details
+ *   Selects the mux channel of the monitor first, the telemetry sweep leaves
+ *   the mux on its last group.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @param[out] voltage
+ *   Panel voltage in uV.
+ *
+ * @param[out] current
+ *   Panel current in uA.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_MeasureSensor(MPPT_Channel_TypeDef channel,
+                                    int32_t *voltage,
+                                    int32_t *current)
+{
+  INA226_TypeDef *sensor =
+      TELEMETRY_GetSensor((TELEMETRY_Channel_TypeDef)(TELEMETRY_Channel_MPPT1 + channel));
+  int busV;
+  int shuntV;
+
+  if ( sensor == 0 || (uint32_t)channel >= MPPT_NUM_CHANNELS )
+  {
+    return MPPT_Err_Invalid;
+  }
+
+  if ( TCA9548A_RegisterSet(sensor->i2c, EPS_MUX1_I2CADDR, sensor->muxChan)
+       != TCA9548A_Err_NoError
+       || INA226_ReadBusVoltage(sensor, &busV) != INA226_Err_NoError
+       || INA226_ReadShuntVoltage(sensor, &shuntV) != INA226_Err_NoError )
+  {
+    return MPPT_Err_Measure;
+  }
+
+  *voltage = INA226_BusVoltageToUV(busV);
+  *current = INA226_ShuntVoltageToUA(shuntV, sensor->senseResistor);
+
+  return MPPT_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stage the LTC3119 MPPC setpoint of a channel for the next
+ *   MPPT_CommitDac.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @param[in] code
+ *   DAC code.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_SetDac(MPPT_Channel_TypeDef channel,
+                             uint16_t code)
+{
+  if ( (uint32_t)channel >= MPPT_NUM_CHANNELS )
+  {
+    return MPPT_Err_Invalid;
+  }
+
+  if ( AD5324_Stage((AD5324_Channel_TypeDef)((uint32_t)AD5324_ChannelA + channel),
+                    code) != AD5324_Err_NoError )
+  {
+    return MPPT_Err_SetPoint;
+  }
+
+  return MPPT_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write the staged setpoints in one DAC burst and update the outputs of
+ *   all panels at once. Unchanged channels are not sent.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+MPPT_Err_TypeDef MPPT_CommitDac(void)
+{
+  if ( AD5324_Commit(AD5324_ModeEnable, AD5324_TriggerCpu) != AD5324_Err_NoError )
+  {
+    return MPPT_Err_SetPoint;
+  }
+
+  return MPPT_Err_NoError;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Measure the operating point set by the previous step and stage the next
+ *   DAC code of one controller.
+ *
+ * @details
+ *   On a failed measurement the code is left as it is.
+ *
+ * @param[in] channel
+ *   Panel input.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+static MPPT_Err_TypeDef MPPT_Track(MPPT_Channel_TypeDef channel)
+{
+  MPPT_State_TypeDef *s;
+  int32_t voltage;
+  int32_t current;
+  int32_t power;
+  int32_t code;
+  int32_t delta;
+  int8_t direction;
+
+  if ( (uint32_t)channel >= MPPT_NUM_CHANNELS )
+  {
+    return MPPT_Err_Invalid;
+  }
+
+  s = &MPPT_States[channel];
+
+  if ( !s->enabled )
+  {
+    return MPPT_Err_NoError;
+  }
+
+  if ( MPPT_Measure(channel, &voltage, &current) != MPPT_Err_NoError )
+  {
+    s->errors++;
+    return MPPT_Err_Measure;
+  }
+
+  /* Current flowing back into the panel delivers no power */
+  power = (current > 0 && voltage > 0)
+          ? (int32_t)(((int64_t)voltage * current) / 1000000)
+          : 0;
+
+  if ( s->steps == 0U )
+  {
+    direction = s->direction;
+  }
+  else if ( (uint32_t)power < MPPT_Params.minPower )
+  {
+    /* Nothing to compare, head for more current */
+    direction = (int8_t)-MPPT_Params.polarity;
+    s->run = (direction == s->direction) ? s->run + 1U : 1U;
+    s->reversals = 0U;
+    if ( s->settled )
+    {
+      MPPT_Unsettle(s);
+    }
+  }
+  else
+  {
+    delta = power - s->power;
+
+    if ( s->settled &&
+         (uint64_t)(delta < 0 ? -delta : delta) * 1000U
+         > (uint64_t)MPPT_Params.disturb * (uint32_t)s->power )
+    {
+      MPPT_Unsettle(s);
+    }
+
+    direction = MPPT_Decide(s, voltage, current, power);
+
+    if ( direction != s->direction )
+    {
+      if ( s->run <= MPPT_SETTLE_RUN )
+      {
+        s->reversals++;
+      }
+      else
+      {
+        s->reversals = 0U;
+      }
+      s->run = 1U;
+    }
+    else
+    {
+      s->run++;
+    }
+
+    if ( s->settled && s->run > MPPT_UNSETTLE_RUN )
+    {
+      MPPT_Unsettle(s);
+    }
+    else if ( !s->settled && s->reversals >= MPPT_Params.settleCount )
+    {
+      s->settled = 1U;
+      s->convergeSteps = s->steps - s->convergeStart;
+    }
+  }
+
+  s->voltage = voltage;
+  s->current = current;
+  s->power = power;
+  s->direction = direction;
+  s->steps++;
+  MPPT_Account(s);
+
+  code = (int32_t)s->code
+       + direction * (int32_t)(s->settled ? MPPT_Params.dither : MPPT_Params.step);
+
+  /* Turn around at the ends of the range, the power seen there only
+   * changes with the conditions and would hold the direction */
+  if ( code <= (int32_t)MPPT_Params.minCode )
+  {
+    code = (int32_t)MPPT_Params.minCode;
+    s->direction = 1;
+  }
+  else if ( code >= (int32_t)MPPT_Params.maxCode )
+  {
+    code = (int32_t)MPPT_Params.maxCode;
+    s->direction = -1;
+  }
+
+  s->code = (uint16_t)code;
+
+  if ( MPPT_SetPoint(channel, s->code) != MPPT_Err_NoError )
+  {
+    s->errors++;
+    return MPPT_Err_SetPoint;
+  }
+
+  return MPPT_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Choose the direction of the next code change.
+ *
+ * @details
+ *   Perturb and observe keeps the direction while the power does not drop.
+ *   Incremental conductance compares dI/dV with -I/V, i.e. the sign of
+ *   I*dV + V*dI relative to dV, and reverses inside the deadband so the
+ *   controller dithers at the maximum power point. When the voltage did not
+ *   change it follows the current. The voltage direction is turned into a
+ *   code direction with the polarity parameter.
+ *
+ * @param[in] s
+ *   Controller state holding the previous measurement.
+ *
+ * @param[in] voltage
+ *   Panel voltage in uV.
+ *
+ * @param[in] current
+ *   Panel current in uA.
+ *
+ * @param[in] power
+ *   Panel power in uW.
+ *
+ * @return
+ *   Returns +1 to raise the code, -1 to lower it.
+ ******************************************************************************/
+static int8_t MPPT_Decide(const MPPT_State_TypeDef *s,
+                          int32_t voltage,
+                          int32_t current,
+                          int32_t power)
+{
+  int64_t dV;
+  int64_t dI;
+  int64_t slope;
+  int64_t band;
+
+  if ( MPPT_Params.algorithm == MPPT_Algorithm_PerturbObserve )
+  {
+    return (power >= s->power) ? s->direction : (int8_t)-s->direction;
+  }
+
+  dV = (int64_t)voltage - s->voltage;
+  dI = (int64_t)current - s->current;
+
+  if ( dV == 0 )
+  {
+    if ( dI == 0 )
+    {
+      return (int8_t)-s->direction;
+    }
+    return (int8_t)((dI > 0) ? MPPT_Params.polarity : -MPPT_Params.polarity);
+  }
+
+  /* Change in power in pW, treated as the peak while it is small next to
+   * I*dV, i.e. while dI/dV is within the deadband of -I/V */
+  slope = (int64_t)current * dV + (int64_t)voltage * dI;
+  band = ((int64_t)current * dV / 1000) * MPPT_Params.deadband;
+
+  if ( band < 0 )
+  {
+    band = -band;
+  }
+
+  if ( (slope < 0 ? -slope : slope) <= band )
+  {
+    return (int8_t)-s->direction;
+  }
+
+  return (int8_t)(((slope > 0) == (dV > 0)) ? MPPT_Params.polarity : -MPPT_Params.polarity);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Leave the settled state and start timing a new convergence.
+ *
+ * @param[in] s
+ *   Controller state.
+ ******************************************************************************/
+static void MPPT_Unsettle(MPPT_State_TypeDef *s)
+{
+  s->settled = 0U;
+  s->reversals = 0U;
+  s->convergeStart = s->steps;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add the last power measurement to the efficiency window and close the
+ *   window when it is full, measuring the tracking efficiency if an IV
+ *   sweep started it.
+ *
+ * @param[in] s
+ *   Controller state.
+ ******************************************************************************/
+static void MPPT_Account(MPPT_State_TypeDef *s)
+{
+  /* A sweep restarts tracking, measure once settled again */
+  if ( s->reference != 0U && !s->settled )
+  {
+    s->windowSum = 0U;
+    s->windowPeak = 0U;
+    s->windowCount = 0U;
+    return;
+  }
+
+  s->windowSum += (uint32_t)s->power;
+  s->windowCount++;
+
+  if ( (uint32_t)s->power > s->windowPeak )
+  {
+    s->windowPeak = (uint32_t)s->power;
+  }
+
+  if ( s->windowCount >= MPPT_WINDOW )
+  {
+    if ( s->reference != 0U )
+    {
+      s->efficiency = (uint32_t)((s->windowSum * 1000U)
+                                 / ((uint64_t)s->windowCount * s->reference));
+
+      /* Noise can put the tracker a little above the sweep's best point */
+      if ( s->efficiency > 1000U )
+      {
+        s->efficiency = 1000U;
+      }
+      s->reference = 0U;
+    }
+    s->peakPower = s->windowPeak;
+    s->windowSum = 0U;
+    s->windowPeak = 0U;
+    s->windowCount = 0U;
+  }
+}
@@ -0,0 +1,216 @@
+/** @file mppt.h
+*   @brief Maximum Power Point Tracking Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup MPPT MPPT
+ *  @brief Per panel maximum power point tracking on top of the LTC3119
+ *         MPPC input.
+ *
+ *  Each solar panel input has its own controller. The LTC3119 regulates its
+ *  input to the voltage set by one AD5324 channel. The DAC drives the MPPC
+ *  divider through a resistor, so on the board a higher code lowers the
+ *  panel operating voltage. Every MPPT_PERIOD the controllers measure the
+ *  panel voltage and current of the operating point set in the previous
+ *  step and move the DAC code with either perturb and observe or
+ *  incremental conductance. The new codes of all panels are staged and
+ *  committed in one DAC burst, so the panels move together.
+ *
+ *  A controller moves by the step size while it is tracking. Once the
+ *  direction has reversed after short runs a number of times it is settled
+ *  at the maximum power point and only dithers around it with the smaller
+ *  dither size. A long run in one direction or a jump in power puts it back
+ *  into tracking. Below a minimum power the panel is either in the dead zone
+ *  above open circuit or dark, and the controller walks towards lower panel
+ *  voltage until it finds power. At either end of the code range it turns
+ *  around.
+ *
+ *  Tracking efficiency is the mean power over the first window settled
+ *  after an IV sweep of the panel divided by the maximum power the sweep
+ *  found, so it holds as long as the light has not changed in between;
+ *  IVSWEEP hands it over with MPPT_SetReference. Without a sweep it is not
+ *  measured. Convergence time
+ *  is the number of steps from a start or disturbance until the controller
+ *  settles.
+ *
+ *  Measurement and DAC access go through function pointers passed to
+ *  MPPT_Init, the defaults read the MPPT power monitors of TELEMETRY and
+ *  stage and commit AD5324 setpoints, so the same code can run against a panel model.
+ *
+ *	Related Files
+ *   - mppt.h
+ *   - mppt.c
+ *   - telemetry.h
+ *   - ad5324.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_MPPT_H_
+#define DRIVERS_MPPT_H_
+
+#include "telemetry.h"
+#include "ad5324.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Step period of the MPPT task, in ticks */
+#define MPPT_PERIOD               (SCHEDULER_MS(50))
+
+/** AD5324 reference voltage in mV */
+#define MPPT_DAC_VREF_MV          (3300U)
+
+/** Convert a DAC output voltage in mV to a code */
+#define MPPT_MV_TO_CODE(mv)       ((uint16_t)(((uint32_t)(mv) * 4096U) / MPPT_DAC_VREF_MV))
+
+/** Steps per tracking efficiency window */
+#define MPPT_WINDOW               (32U)
+
+/**
+ *  @addtogroup MPPT
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum MPPT_Err_TypeDef
+*   @brief Alias names for MPPT errors.
+*/
+typedef enum
+{
+  MPPT_Err_NoError  = 0U,   /**< No error*/
+  MPPT_Err_Measure  = 1U,   /**< Panel voltage or current could not be read*/
+  MPPT_Err_SetPoint = 2U,   /**< DAC write failed*/
+  MPPT_Err_Invalid  = 3U    /**< Channel or parameter out of range*/
+} MPPT_Err_TypeDef;
+
+/** @enum MPPT_Channel_TypeDef
+*   @brief Panel inputs, one controller each.
+*/
+typedef enum
+{
+  MPPT_Channel_1 = 0,       /**< MPPT1, DAC channel A*/
+  MPPT_Channel_2 = 1,       /**< MPPT2, DAC channel B*/
+  MPPT_Channel_3 = 2,       /**< MPPT3, DAC channel C*/
+  MPPT_Channel_4 = 3,       /**< MPPT4, DAC channel D*/
+  MPPT_NUM_CHANNELS         /**< Number of channels (not a channel)*/
+} MPPT_Channel_TypeDef;
+
+/** @enum MPPT_Algorithm_TypeDef
+*   @brief Tracking algorithms.
+*/
+typedef enum
+{
+  MPPT_Algorithm_PerturbObserve = 0,  /**< Perturb and observe on power*/
+  MPPT_Algorithm_IncCond        = 1   /**< Incremental conductance*/
+} MPPT_Algorithm_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** Read panel voltage in uV and current in uA of a channel */
+typedef MPPT_Err_TypeDef (*MPPT_Measure_TypeDef)(MPPT_Channel_TypeDef channel,
+                                                 int32_t *voltage,
+                                                 int32_t *current);
+
+/** Stage the DAC code of a channel */
+typedef MPPT_Err_TypeDef (*MPPT_SetPoint_TypeDef)(MPPT_Channel_TypeDef channel,
+                                                  uint16_t code);
+
+/** Apply all staged DAC codes together */
+typedef MPPT_Err_TypeDef (*MPPT_Commit_TypeDef)(void);
+
+/** @struct MPPT_Params_TypeDef
+*   @brief Tracking parameters, shared by all controllers.
+*/
+typedef struct
+{
+  MPPT_Algorithm_TypeDef algorithm; /**< Algorithm used by all controllers*/
+  uint16_t step;                    /**< Code step while tracking*/
+  uint16_t dither;                  /**< Code step once settled*/
+  int8_t polarity;                  /**< +1 if a higher code raises the panel voltage, else -1*/
+  uint16_t minCode;                 /**< Lowest code*/
+  uint16_t maxCode;                 /**< Highest code*/
+  uint16_t startCode;               /**< Code on start and restart, near open circuit*/
+  uint32_t settleCount;             /**< Short run reversals before settled*/
+  uint32_t disturb;                 /**< Power change that restarts tracking, permille*/
+  uint32_t deadband;                /**< Incremental conductance deadband on dI/dV, permille of I/V*/
+  uint32_t minPower;                /**< Below this power in uW the panel counts as unloaded*/
+} MPPT_Params_TypeDef;
+
+/** @struct MPPT_State_TypeDef
+*   @brief Operating point and measurements of a controller.
+*/
+typedef struct
+{
+  uint8_t enabled;                  /**< Controller steps when set*/
+  uint8_t settled;                  /**< Dithering around the maximum power point*/
+  int8_t direction;                 /**< Last code change, +1 or -1*/
+  uint16_t code;                    /**< DAC code in effect*/
+  int32_t voltage;                  /**< Panel voltage in uV*/
+  int32_t current;                  /**< Panel current in uA*/
+  int32_t power;                    /**< Panel power in uW*/
+  uint32_t run;                     /**< Steps since the last reversal*/
+  uint32_t reversals;               /**< Short run reversals counted*/
+  uint32_t steps;                   /**< Steps since start*/
+  uint32_t errors;                  /**< Failed measurements or DAC writes*/
+  uint32_t convergeStart;           /**< Step tracking (re)started*/
+  uint32_t convergeSteps;           /**< Steps of the last convergence*/
+  uint32_t efficiency;              /**< Tracking efficiency at the last IV sweep, permille, 0 if none*/
+  uint32_t reference;               /**< Maximum power of an IV sweep the window runs against in uW, 0 if none*/
+  uint32_t peakPower;               /**< Highest power of the last window in uW*/
+  uint64_t windowSum;               /**< Power accumulated in the window*/
+  uint32_t windowPeak;              /**< Highest power in the window*/
+  uint32_t windowCount;             /**< Steps in the window*/
+} MPPT_State_TypeDef;
+
+extern const MPPT_Params_TypeDef MPPT_DefaultParams;
+
+void MPPT_Init(const MPPT_Params_TypeDef *params,
+               MPPT_Measure_TypeDef Measure,
+               MPPT_SetPoint_TypeDef SetPoint,
+               MPPT_Commit_TypeDef Commit);
+
+void MPPT_Update(void);
+
+MPPT_Err_TypeDef MPPT_Step(MPPT_Channel_TypeDef channel);
+
+MPPT_Err_TypeDef MPPT_Enable(MPPT_Channel_TypeDef channel, uint8_t enable);
+
+MPPT_Err_TypeDef MPPT_Restart(MPPT_Channel_TypeDef channel);
+
+MPPT_Err_TypeDef MPPT_SetAlgorithm(MPPT_Algorithm_TypeDef algorithm);
+
+MPPT_Err_TypeDef MPPT_SetReference(MPPT_Channel_TypeDef channel, uint32_t power);
+
+const MPPT_Params_TypeDef *MPPT_GetParams(void);
+
+const MPPT_State_TypeDef *MPPT_GetState(MPPT_Channel_TypeDef channel);
+
+PRINT_Err_TypeDef MPPT_PrintStats(PORT_UART_Reg_TypeDef *uart,
+                                  MPPT_Channel_TypeDef channel);
+
+MPPT_Err_TypeDef MPPT_MeasureSensor(MPPT_Channel_TypeDef channel,
+                                    int32_t *voltage,
+                                    int32_t *current);
+
+MPPT_Err_TypeDef MPPT_SetDac(MPPT_Channel_TypeDef channel,
+                             uint16_t code);
+
+MPPT_Err_TypeDef MPPT_CommitDac(void);
+
+/**@}*/
+
+#endif /* DRIVERS_MPPT_H_ */
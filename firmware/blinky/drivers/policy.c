@@ -0,0 +1,791 @@
+/** @file policy.c
+*   @brief Power Policy Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "policy.h"
+#include "telemetry.h"
+#include "battery.h"
+#include "mppt.h"
+#include "ivsweep.h"
+#include "adcacq.h"
+#include "adccal.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/* Name of the ADC undervoltage trip on the console */
+#define POLICY_ADC_NAME           "ADC_UV"
+
+/* All outputs switched on */
+#define POLICY_ALL_OUTPUTS        ((1UL << POLICY_NUM_OUTPUTS) - 1UL)
+
+/* Overcurrent trip of one output, latched until reset */
+#define POLICY_OVERCURRENT(name, n) \
+  { name, POLICY_Signal_Current, TELEMETRY_Channel_OUTPUT##n, POLICY_Compare_Above, \
+    2000, 0, 1U, 1U, POLICY_Action_ShedOutput, (uint8_t)(TELEMETRY_Channel_OUTPUT##n - TELEMETRY_Channel_OUTPUT01) }
+
+/* Thresholds for the 2S NMC pack of battery.h */
+const POLICY_Rule_TypeDef POLICY_DefaultRules[] =
+{
+  /* name          signal                     channel                  compare               thresh  hyst   hold latch action                  arg */
+  { "SURV_SOC",    POLICY_Signal_Soc,         TELEMETRY_Channel_BATBUS, POLICY_Compare_Below,   150,    50, 0U, 0U, POLICY_Action_Survival, 0U },
+  { "SURV_VBAT",   POLICY_Signal_Voltage,     TELEMETRY_Channel_BATBUS, POLICY_Compare_Below,  6400,   200, 0U, 0U, POLICY_Action_Survival, 0U },
+  { "SHED_P3",     POLICY_Signal_Soc,         TELEMETRY_Channel_BATBUS, POLICY_Compare_Below,   400,    50, 2U, 0U, POLICY_Action_Shed,     3U },
+  { "SHED_P2",     POLICY_Signal_Soc,         TELEMETRY_Channel_BATBUS, POLICY_Compare_Below,   250,    50, 2U, 0U, POLICY_Action_Shed,     2U },
+  { "ACQ_REDUCED", POLICY_Signal_Soc,         TELEMETRY_Channel_BATBUS, POLICY_Compare_Below,   500,    50, 2U, 0U, POLICY_Action_Profile,  (uint8_t)POLICY_Profile_Reduced },
+  { "CHG_FULL",    POLICY_Signal_Soc,         TELEMETRY_Channel_BATBUS, POLICY_Compare_Above,   980,    30, 0U, 0U, POLICY_Action_Curtail,  0U },
+  { "CHG_OV",      POLICY_Signal_Voltage,     TELEMETRY_Channel_BATBUS, POLICY_Compare_Above,  8350,   100, 0U, 0U, POLICY_Action_Curtail,  0U },
+  { "CHG_COLD",    POLICY_Signal_Temperature, TELEMETRY_Channel_BATBUS, POLICY_Compare_Below,     0,  3000, 0U, 0U, POLICY_Action_Curtail,  0U },
+  { "CHG_HOT",     POLICY_Signal_Temperature, TELEMETRY_Channel_BATBUS, POLICY_Compare_Above, 45000,  5000, 0U, 0U, POLICY_Action_Curtail,  0U },
+  { "BAT_HOT",     POLICY_Signal_Temperature, TELEMETRY_Channel_BATBUS, POLICY_Compare_Above, 55000,  5000, 0U, 0U, POLICY_Action_Shed,     2U },
+  POLICY_OVERCURRENT("OC_OUT01", 01),
+  POLICY_OVERCURRENT("OC_OUT02", 02),
+  POLICY_OVERCURRENT("OC_OUT03", 03),
+  POLICY_OVERCURRENT("OC_OUT04", 04),
+  POLICY_OVERCURRENT("OC_OUT05", 05),
+  POLICY_OVERCURRENT("OC_OUT06", 06),
+  POLICY_OVERCURRENT("OC_OUT07", 07),
+  POLICY_OVERCURRENT("OC_OUT08", 08),
+  POLICY_OVERCURRENT("OC_OUT09", 09),
+  POLICY_OVERCURRENT("OC_OUT10", 10),
+  POLICY_OVERCURRENT("OC_OUT11", 11),
+  POLICY_OVERCURRENT("OC_OUT12", 12),
+  POLICY_OVERCURRENT("OC_OUT13", 13),
+  POLICY_OVERCURRENT("OC_OUT14", 14),
+  POLICY_OVERCURRENT("OC_OUT15", 15),
+  POLICY_OVERCURRENT("OC_OUT16", 16),
+  POLICY_OVERCURRENT("OC_OUT17", 17),
+  POLICY_OVERCURRENT("OC_OUT18", 18)
+};
+
+const uint32_t POLICY_NumDefaultRules = sizeof(POLICY_DefaultRules) / sizeof(POLICY_DefaultRules[0]);
+
+/* Shed priority of each output until the payload allocation is known, set
+ * per mission with POLICY_SetOutputPriorities */
+const uint8_t POLICY_DefaultOutputPriority[POLICY_NUM_OUTPUTS] =
+{
+  0U, 0U, 1U, 1U, 1U, 1U, 2U, 2U, 2U, 2U, 2U, 2U, 3U, 3U, 3U, 3U, 3U, 3U
+};
+
+/* Telemetry sweep divider of each acquisition profile */
+const uint8_t POLICY_DefaultProfileDivider[POLICY_NUM_PROFILES] =
+{
+  1U, 5U, 10U
+};
+
+static const char * const POLICY_ProfileNames[POLICY_NUM_PROFILES] =
+{
+  "FULL", "REDUCED", "SURVIVAL"
+};
+
+static const POLICY_Rule_TypeDef *POLICY_Rules = POLICY_DefaultRules;
+static const uint8_t *POLICY_ProfileDivider = POLICY_DefaultProfileDivider;
+static const uint8_t *POLICY_OutputPriority = POLICY_DefaultOutputPriority;
+static uint32_t POLICY_NumRules = 0U;
+static POLICY_Switch_TypeDef POLICY_Switch = 0;
+
+static uint16_t POLICY_Count[POLICY_MAX_RULES];
+static POLICY_State_TypeDef POLICY_State;
+static POLICY_Event_TypeDef POLICY_Log[POLICY_LOG_SIZE];
+static uint32_t POLICY_LastSequence;
+static uint32_t POLICY_SweepCount;
+
+static uint8_t POLICY_Signal(const POLICY_Rule_TypeDef *rule,
+                             const TELEMETRY_Snapshot_TypeDef *snap,
+                             const BATTERY_State_TypeDef *bat,
+                             int32_t *value);
+static void POLICY_Evaluate(uint32_t index,
+                            const TELEMETRY_Snapshot_TypeDef *snap,
+                            const BATTERY_State_TypeDef *bat);
+static uint8_t POLICY_AdcTrip(uint8_t trip, uint32_t value);
+static void POLICY_Apply(void);
+static void POLICY_Curtail(uint8_t curtail);
+static void POLICY_LogEvent(uint32_t index, uint8_t active, int32_t value);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Load a rule table and switch every output on.
+ *
+ * @details
+ *   Must be called after TELEMETRY_Init, MPPT_Init and BATTERY_Init. Run
+ *   POLICY_Update every POLICY_PERIOD, after the battery estimator.
+ *
+ * @param[in] rules
+ *   Rule table, or null for POLICY_DefaultRules.
+ *
+ * @param[in] numRules
+ *   Rules in the table, at most POLICY_MAX_RULES.
+ *
+ * @param[in] Switch
+ *   Function used to switch an output, or null if the load switches are not
+ *   wired. Without it the outputs are only commanded: POLICY_State keeps
+ *   what the rules ask for and reports it as not driven.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+POLICY_Err_TypeDef POLICY_Init(const POLICY_Rule_TypeDef *rules,
+                               uint32_t numRules,
+                               POLICY_Switch_TypeDef Switch)
+{
+  if ( rules == 0 )
+  {
+    rules = POLICY_DefaultRules;
+    numRules = POLICY_NumDefaultRules;
+  }
+
+  if ( numRules > POLICY_MAX_RULES )
+  {
+    return POLICY_Err_Invalid;
+  }
+
+  POLICY_Rules = rules;
+  POLICY_NumRules = numRules;
+  POLICY_Switch = Switch;
+  POLICY_LastSequence = TELEMETRY_GetSnapshot()->sequence;
+  POLICY_SweepCount = 0U;
+
+  POLICY_State.outputs = 0U;
+  POLICY_State.driven = (Switch != 0) ? 1U : 0U;
+  POLICY_State.curtailed = 0U;
+  POLICY_Reset();
+
+  return POLICY_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Evaluate every rule on a new telemetry snapshot and apply the result.
+ *   Run as a scheduler task every POLICY_PERIOD.
+ ******************************************************************************/
+void POLICY_Update(void)
+{
+  const TELEMETRY_Snapshot_TypeDef *snap = TELEMETRY_GetSnapshot();
+  const BATTERY_State_TypeDef *bat = BATTERY_GetState();
+  const ADCACQ_Params_TypeDef *adc = ADCACQ_GetParams();
+  const ADCACQ_Output_TypeDef *o;
+  uint8_t trip = 0U;
+  uint8_t changed = 0U;
+  uint32_t i;
+
+  /* Take up a crossing the ADC was not trusted for, or drop the trip once
+   * it no longer is */
+  for ( i = 0U; i < adc->numChannels; i++ )
+  {
+    if ( adc->channel[i].pin == ADCACQ_BATTERY_PIN )
+    {
+      o = &ADCACQ_GetState()->output[i];
+      trip = (o->level == ADCACQ_Level_Low && ADCCAL_IsTrusted()) ? 1U : 0U;
+      changed = POLICY_AdcTrip(trip, o->value);
+    }
+  }
+
+  /* Hold counts are in sweeps, a slower acquisition profile does not
+   * count the same reading twice */
+  if ( snap->sequence == POLICY_LastSequence )
+  {
+    if ( changed )
+    {
+      POLICY_Apply();
+    }
+    return;
+  }
+  POLICY_LastSequence = snap->sequence;
+
+  for ( i = 0U; i < POLICY_NumRules; i++ )
+  {
+    POLICY_Evaluate(i, snap, bat);
+  }
+
+  POLICY_Apply();
+  POLICY_State.evaluations++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Release every rule including latched ones, clear the event log and
+ *   restore all outputs and tracking.
+ ******************************************************************************/
+void POLICY_Reset(void)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < POLICY_MAX_RULES; i++ )
+  {
+    POLICY_Count[i] = 0U;
+  }
+
+  POLICY_State.active = 0U;
+  POLICY_State.adcTrip = 0U;
+  POLICY_State.evaluations = 0U;
+  POLICY_State.invalid = 0U;
+  POLICY_State.events = 0U;
+  POLICY_State.errors = 0U;
+
+  POLICY_Apply();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Trip or release survival on a threshold crossing of the ADCACQ battery
+ *   channel. Pass to ADCACQ_Init.
+ *
+ * @details
+ *   Runs in the ADCACQ task. A low crossing is ignored unless
+ *   ADCCAL_IsTrusted, other channels are ignored.
+ *
+ * @param[in] channel
+ *   Index in the ADCACQ channel table.
+ *
+ * @param[in] level
+ *   New level of the channel.
+ *
+ * @param[in] value
+ *   Output in mV.
+ ******************************************************************************/
+void POLICY_Threshold(uint32_t channel,
+                      ADCACQ_Level_TypeDef level,
+                      uint32_t value)
+{
+  const ADCACQ_Params_TypeDef *adc = ADCACQ_GetParams();
+  uint8_t trip;
+
+  if ( channel >= adc->numChannels || adc->channel[channel].pin != ADCACQ_BATTERY_PIN )
+  {
+    return;
+  }
+
+  trip = (level == ADCACQ_Level_Low && ADCCAL_IsTrusted()) ? 1U : 0U;
+  if ( POLICY_AdcTrip(trip, value) )
+  {
+    POLICY_Apply();
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Tell the telemetry task whether to sweep in this release, following the
+ *   acquisition profile.
+ *
+ * @return
+ *   Returns 1 if a sweep is due.
+ ******************************************************************************/
+uint8_t POLICY_SweepDue(void)
+{
+  if ( POLICY_SweepCount == 0U )
+  {
+    POLICY_SweepCount = POLICY_ProfileDivider[POLICY_State.profile];
+  }
+
+  return (--POLICY_SweepCount == 0U);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the telemetry sweep divider of each acquisition profile.
+ *
+ * @param[in] dividers
+ *   POLICY_NUM_PROFILES dividers, none zero, or null for
+ *   POLICY_DefaultProfileDivider. Kept by reference.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+POLICY_Err_TypeDef POLICY_SetProfileDividers(const uint8_t *dividers)
+{
+  uint32_t i;
+
+  if ( dividers == 0 )
+  {
+    dividers = POLICY_DefaultProfileDivider;
+  }
+
+  for ( i = 0U; i < POLICY_NUM_PROFILES; i++ )
+  {
+    if ( dividers[i] == 0U )
+    {
+      return POLICY_Err_Invalid;
+    }
+  }
+
+  POLICY_ProfileDivider = dividers;
+
+  return POLICY_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Select the shed priority of each output. Takes effect at the next
+ *   control period.
+ *
+ * @param[in] priorities
+ *   POLICY_NUM_OUTPUTS priorities below POLICY_NUM_PRIORITIES, 0 is never
+ *   shed, or null for POLICY_DefaultOutputPriority. Must stay valid.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+POLICY_Err_TypeDef POLICY_SetOutputPriorities(const uint8_t *priorities)
+{
+  uint32_t i;
+
+  if ( priorities == 0 )
+  {
+    priorities = POLICY_DefaultOutputPriority;
+  }
+
+  for ( i = 0U; i < POLICY_NUM_OUTPUTS; i++ )
+  {
+    if ( priorities[i] >= POLICY_NUM_PRIORITIES )
+    {
+      return POLICY_Err_Invalid;
+    }
+  }
+
+  POLICY_OutputPriority = priorities;
+
+  return POLICY_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the applied actions and statistics.
+ *
+ * @return
+ *   Returns pointer to the state.
+ ******************************************************************************/
+const POLICY_State_TypeDef *POLICY_GetState(void)
+{
+  return &POLICY_State;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get an entry of the event log.
+ *
+ * @param[in] age
+ *   0 for the newest entry, 1 for the one before and so on.
+ *
+ * @return
+ *   Returns pointer to the entry, or null if the log holds fewer entries.
+ ******************************************************************************/
+const POLICY_Event_TypeDef *POLICY_GetEvent(uint32_t age)
+{
+  uint32_t held = (POLICY_State.events < POLICY_LOG_SIZE) ?
+                  POLICY_State.events : POLICY_LOG_SIZE;
+
+  if ( age >= held )
+  {
+    return 0;
+  }
+
+  return &POLICY_Log[(POLICY_State.events - 1U - age) % POLICY_LOG_SIZE];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the applied actions, the active rules and the event log, newest
+ *   first.
+ *
+ * @param[in] uart
+ *   Pointer to UART register struct.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef POLICY_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const POLICY_State_TypeDef *s = &POLICY_State;
+  const POLICY_Event_TypeDef *e;
+  PRINT_Err_TypeDef ret;
+  uint32_t i;
+
+  PRINT_PrintString(uart,s->survival ? "SURVIVAL SHED=" : "NOMINAL SHED=");
+  if ( s->shedPriority < POLICY_NUM_PRIORITIES )
+  {
+    PRINT_PrintChar(uart,'P');
+    PRINT_FormatUInt(buf,s->shedPriority);
+    PRINT_PrintString(uart,buf);
+  }
+  else
+  {
+    PRINT_PrintString(uart,"NONE");
+  }
+  PRINT_PrintString(uart,s->curtailed ? " CURTAIL=ON PROFILE=" : " CURTAIL=OFF PROFILE=");
+  PRINT_PrintString(uart,(char*)POLICY_ProfileNames[s->profile]);
+  PRINT_PrintString(uart,s->driven ? " OUTPUTS=" : " COMMANDED=");
+  PRINT_FormatHex(buf,s->outputs,5U);
+  PRINT_PrintString(uart,buf);
+  if ( !s->driven )
+  {
+    PRINT_PrintString(uart," (NOT DRIVEN)");
+  }
+  PRINT_PrintString(uart," EVALUATIONS=");
+  PRINT_FormatUInt(buf,s->evaluations);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," INVALID=");
+  PRINT_FormatUInt(buf,s->invalid);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," EVENTS=");
+  PRINT_FormatUInt(buf,s->events);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ERRORS=");
+  PRINT_FormatUInt(buf,s->errors);
+  ret = PRINT_PrintStringln(uart,buf);
+
+  PRINT_PrintString(uart,"ACTIVE:");
+  for ( i = 0U; i < POLICY_NumRules; i++ )
+  {
+    if ( (s->active & (1UL << i)) != 0U )
+    {
+      PRINT_PrintChar(uart,' ');
+      PRINT_PrintString(uart,(char*)POLICY_Rules[i].name);
+    }
+  }
+  if ( s->adcTrip )
+  {
+    PRINT_PrintString(uart," " POLICY_ADC_NAME);
+  }
+  ret = PRINT_PrintStringln(uart,"");
+
+  for ( i = 0U; (e = POLICY_GetEvent(i)) != 0 && ret == PRINT_Err_NoError; i++ )
+  {
+    PRINT_PrintTimeFromMS(uart,e->timestamp * (SCHEDULER_TICK_US / 1000U));
+    PRINT_PrintChar(uart,' ');
+    PRINT_PrintString(uart,(e->rule == POLICY_EVENT_ADC) ? POLICY_ADC_NAME
+                                                         : (char*)POLICY_Rules[e->rule].name);
+    PRINT_PrintString(uart,e->active ? " ON " : " OFF ");
+    PRINT_FormatInt(buf,e->value);
+    ret = PRINT_PrintStringln(uart,buf);
+  }
+
+  return ret;
+}
+
+/*******************************************************************************
+ ***************************   LOCAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Read the signal a rule tests.
+ *
+ * @param[in] rule
+ *   Rule.
+ *
+ * @param[in] snap
+ *   Latest telemetry snapshot.
+ *
+ * @param[in] bat
+ *   Battery estimate.
+ *
+ * @param[out] value
+ *   Signal value in the unit of the signal.
+ *
+ * @return
+ *   Returns 1 if the signal is valid.
+ ******************************************************************************/
+static uint8_t POLICY_Signal(const POLICY_Rule_TypeDef *rule,
+                             const TELEMETRY_Snapshot_TypeDef *snap,
+                             const BATTERY_State_TypeDef *bat,
+                             int32_t *value)
+{
+  switch ( rule->signal )
+  {
+    case POLICY_Signal_Soc:
+      *value = (int32_t)bat->soc;
+      return bat->valid;
+
+    case POLICY_Signal_Temperature:
+      *value = bat->temperature;
+      return bat->valid;
+
+    case POLICY_Signal_Voltage:
+    case POLICY_Signal_Current:
+      if ( (uint32_t)rule->channel >= TELEMETRY_NUM_CHANNELS ||
+           (snap->errors & (1UL << rule->channel)) != 0U )
+      {
+        return 0U;
+      }
+      *value = (rule->signal == POLICY_Signal_Voltage) ?
+               snap->meas[rule->channel].voltage / 1000 :
+               snap->meas[rule->channel].current / 1000;
+      return 1U;
+
+    default:
+      return 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Update the activation of one rule with hold count, hysteresis and latch.
+ *
+ * @details
+ *   A rule whose signal is missing keeps its state.
+ *
+ * @param[in] index
+ *   Index in the rule table.
+ *
+ * @param[in] snap
+ *   Latest telemetry snapshot.
+ *
+ * @param[in] bat
+ *   Battery estimate.
+ ******************************************************************************/
+static void POLICY_Evaluate(uint32_t index,
+                            const TELEMETRY_Snapshot_TypeDef *snap,
+                            const BATTERY_State_TypeDef *bat)
+{
+  const POLICY_Rule_TypeDef *rule = &POLICY_Rules[index];
+  uint32_t bit = 1UL << index;
+  int32_t value;
+  uint8_t past;
+  uint8_t back;
+
+  if ( !POLICY_Signal(rule, snap, bat, &value) )
+  {
+    POLICY_State.invalid++;
+    return;
+  }
+
+  if ( rule->compare == POLICY_Compare_Below )
+  {
+    past = (value < rule->threshold);
+    back = (value >= rule->threshold + rule->hysteresis);
+  }
+  else
+  {
+    past = (value > rule->threshold);
+    back = (value <= rule->threshold - rule->hysteresis);
+  }
+
+  if ( (POLICY_State.active & bit) == 0U )
+  {
+    if ( !past )
+    {
+      POLICY_Count[index] = 0U;
+    }
+    else if ( ++POLICY_Count[index] > rule->hold )
+    {
+      POLICY_State.active |= bit;
+      POLICY_LogEvent(index, 1U, value);
+    }
+  }
+  else if ( back && !rule->latch )
+  {
+    POLICY_State.active &= ~bit;
+    POLICY_Count[index] = 0U;
+    POLICY_LogEvent(index, 0U, value);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the ADC undervoltage trip and log a change.
+ *
+ * @param[in] trip
+ *   1 to trip, 0 to release.
+ *
+ * @param[in] value
+ *   Battery channel output in mV.
+ *
+ * @return
+ *   Returns 1 if the trip changed.
+ ******************************************************************************/
+static uint8_t POLICY_AdcTrip(uint8_t trip, uint32_t value)
+{
+  if ( trip == POLICY_State.adcTrip )
+  {
+    return 0U;
+  }
+
+  POLICY_State.adcTrip = trip;
+  POLICY_LogEvent(POLICY_EVENT_ADC, trip, (int32_t)value);
+
+  return 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Merge the actions of all active rules and apply what changed.
+ *
+ * @details
+ *   Outputs that fail to switch are retried on the next period.
+ ******************************************************************************/
+static void POLICY_Apply(void)
+{
+  uint8_t shedPriority = POLICY_NUM_PRIORITIES;
+  uint32_t shedMask = 0U;
+  uint8_t curtail = 0U;
+  uint8_t survival = 0U;
+  POLICY_Profile_TypeDef profile = POLICY_Profile_Full;
+  const POLICY_Rule_TypeDef *rule;
+  uint32_t desired;
+  uint32_t changed;
+  uint32_t i;
+
+  for ( i = 0U; i < POLICY_NumRules; i++ )
+  {
+    if ( (POLICY_State.active & (1UL << i)) == 0U )
+    {
+      continue;
+    }
+
+    rule = &POLICY_Rules[i];
+    switch ( rule->action )
+    {
+      case POLICY_Action_Shed:
+        if ( rule->arg > 0U && rule->arg < shedPriority )
+        {
+          shedPriority = rule->arg;
+        }
+        break;
+
+      case POLICY_Action_ShedOutput:
+        if ( rule->arg < POLICY_NUM_OUTPUTS )
+        {
+          shedMask |= 1UL << rule->arg;
+        }
+        break;
+
+      case POLICY_Action_Curtail:
+        curtail = 1U;
+        break;
+
+      case POLICY_Action_Profile:
+        if ( rule->arg < POLICY_NUM_PROFILES && rule->arg > (uint8_t)profile )
+        {
+          profile = (POLICY_Profile_TypeDef)rule->arg;
+        }
+        break;
+
+      case POLICY_Action_Survival:
+        survival = 1U;
+        shedPriority = 1U;
+        profile = POLICY_Profile_Survival;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  if ( POLICY_State.adcTrip )
+  {
+    survival = 1U;
+    shedPriority = 1U;
+    profile = POLICY_Profile_Survival;
+  }
+
+  desired = POLICY_ALL_OUTPUTS & ~shedMask;
+  for ( i = 0U; i < POLICY_NUM_OUTPUTS; i++ )
+  {
+    if ( POLICY_OutputPriority[i] >= shedPriority )
+    {
+      desired &= ~(1UL << i);
+    }
+  }
+
+  changed = desired ^ POLICY_State.outputs;
+  for ( i = 0U; changed != 0U; i++ )
+  {
+    if ( (changed & (1UL << i)) == 0U )
+    {
+      continue;
+    }
+    changed &= ~(1UL << i);
+
+    if ( POLICY_Switch == 0
+      || POLICY_Switch(i, (uint8_t)((desired >> i) & 1U)) == POLICY_Err_NoError )
+    {
+      POLICY_State.outputs ^= 1UL << i;
+    }
+    else
+    {
+      POLICY_State.errors++;
+    }
+  }
+
+  if ( curtail != POLICY_State.curtailed )
+  {
+    POLICY_Curtail(curtail);
+  }
+
+  POLICY_State.shedPriority = shedPriority;
+  POLICY_State.survival = survival;
+  POLICY_State.profile = profile;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Hold every panel at the start code near open circuit, or restart
+ *   tracking.
+ *
+ * @details
+ *   A running IV sweep is aborted first, it would re-enable its
+ *   controller when done.
+ *
+ * @param[in] curtail
+ *   Non-zero to curtail.
+ ******************************************************************************/
+static void POLICY_Curtail(uint8_t curtail)
+{
+  uint32_t i;
+
+  if ( curtail )
+  {
+    IVSWEEP_Abort();
+  }
+
+  for ( i = 0U; i < MPPT_NUM_CHANNELS; i++ )
+  {
+    (void)MPPT_Enable((MPPT_Channel_TypeDef)i, (uint8_t)!curtail);
+    if ( curtail )
+    {
+      (void)MPPT_SetDac((MPPT_Channel_TypeDef)i, MPPT_GetParams()->startCode);
+    }
+  }
+
+  if ( curtail && MPPT_CommitDac() != MPPT_Err_NoError )
+  {
+    /* Try again on the next period */
+    POLICY_State.errors++;
+    return;
+  }
+
+  POLICY_State.curtailed = curtail;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Append a rule transition to the event log.
+ *
+ * @param[in] index
+ *   Index in the rule table.
+ *
+ * @param[in] active
+ *   1 on activation, 0 on release.
+ *
+ * @param[in] value
+ *   Signal value.
+ ******************************************************************************/
+static void POLICY_LogEvent(uint32_t index, uint8_t active, int32_t value)
+{
+  POLICY_Event_TypeDef *e = &POLICY_Log[POLICY_State.events % POLICY_LOG_SIZE];
+
+  e->timestamp = SCHEDULER_GetTicks();
+  e->rule = (uint8_t)index;
+  e->active = active;
+  e->value = value;
+
+  POLICY_State.events++;
+}
@@ -0,0 +1,244 @@
+/** @file policy.h
+*   @brief Power Policy Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup POLICY POLICY
+ *  @brief Rule based charge regulation and load shedding.
+ *
+ *  Every control period the engine reads the latest telemetry snapshot and
+ *  battery estimate and evaluates a table of rules. A rule compares one
+ *  signal (state of charge, a bus voltage, a current or the battery
+ *  temperature) with a threshold. It becomes active once the condition has
+ *  held for its hold count of periods and is released once the signal is
+ *  back past the threshold by the hysteresis; a latched rule stays active
+ *  until POLICY_Reset. Every activation and release is written to the
+ *  event log with the tick and the signal value.
+ *
+ *  The actions of all active rules are then merged and applied, only
+ *  changes reach the hardware:
+ *   - Shed: outputs at or above a priority are switched off, restored when
+ *     no rule asks for it any more.
+ *   - Shed output: one output is switched off, used for overcurrent.
+ *   - Curtail: the MPPT controllers stop and the panels are held near open
+ *     circuit, tracking restarts on release.
+ *   - Profile: the telemetry sweep runs at a lower rate.
+ *   - Survival: every output above priority 0 is shed and acquisition drops
+ *     to the survival profile.
+ *
+ *  Rules are evaluated on every new snapshot, so a rule with a hold count
+ *  of zero acts within one control period of the sweep that saw the
+ *  condition. A rule costs a fixed amount of work, the table is limited to
+ *  POLICY_MAX_RULES.
+ *
+ *  The battery channel of ADCACQ trips survival without waiting for a
+ *  sweep: POLICY_Threshold, passed to ADCACQ_Init, applies it as soon as
+ *  the channel crosses its low threshold and releases it when the channel
+ *  is back to normal, logged as rule POLICY_EVENT_ADC. The trip only acts
+ *  while ADCCAL_IsTrusted; every control period it is brought in line with
+ *  the level of the channel and the calibration, so a drifting ADC leaves
+ *  undervoltage to SURV_VBAT on the I2C monitor.
+ *
+ *  Output switching goes through a function pointer passed to POLICY_Init.
+ *  Until the load switch enables are assigned to pins none is passed, the
+ *  outputs are then only commanded and the console reports them as not
+ *  driven. The shed priority of each output is a parameter, set with
+ *  POLICY_SetOutputPriorities.
+ *
+ *	Related Files
+ *   - policy.h
+ *   - policy.c
+ *   - telemetry.h
+ *   - battery.h
+ *   - mppt.h
+ *   - adcacq.h
+ *   - adccal.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_POLICY_H_
+#define DRIVERS_POLICY_H_
+
+#include "telemetry.h"
+#include "battery.h"
+#include "mppt.h"
+#include "adcacq.h"
+#include "scheduler.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Control period of the policy task, in ticks */
+#define POLICY_PERIOD             (SCHEDULER_MS(1000))
+
+/** Largest rule table */
+#define POLICY_MAX_RULES          (32U)
+
+/** Entries of the event log */
+#define POLICY_LOG_SIZE           (32U)
+
+/** Switched outputs, OUTPUT01 to OUTPUT18 */
+#define POLICY_NUM_OUTPUTS        (18U)
+
+/** Output priorities, 0 is never shed */
+#define POLICY_NUM_PRIORITIES     (4U)
+
+/** Rule index logged for the ADC undervoltage trip */
+#define POLICY_EVENT_ADC          (0xFFU)
+
+/**
+ *  @addtogroup POLICY
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum POLICY_Err_TypeDef
+*   @brief Alias names for POLICY errors.
+*/
+typedef enum
+{
+  POLICY_Err_NoError = 0U,        /**< No error*/
+  POLICY_Err_Invalid = 1U,        /**< Rule table or argument out of range*/
+  POLICY_Err_Switch  = 2U         /**< An output could not be switched*/
+} POLICY_Err_TypeDef;
+
+/** @enum POLICY_Signal_TypeDef
+*   @brief Signals a rule can test, with their units.
+*/
+typedef enum
+{
+  POLICY_Signal_Soc         = 0,  /**< Battery state of charge, permille*/
+  POLICY_Signal_Voltage     = 1,  /**< Bus voltage of a telemetry channel, mV*/
+  POLICY_Signal_Current     = 2,  /**< Current of a telemetry channel, mA*/
+  POLICY_Signal_Temperature = 3   /**< Battery temperature, mC*/
+} POLICY_Signal_TypeDef;
+
+/** @enum POLICY_Compare_TypeDef
+*   @brief Direction of a rule condition.
+*/
+typedef enum
+{
+  POLICY_Compare_Below = 0,       /**< Active below the threshold*/
+  POLICY_Compare_Above = 1        /**< Active above the threshold*/
+} POLICY_Compare_TypeDef;
+
+/** @enum POLICY_Action_TypeDef
+*   @brief What an active rule asks for.
+*/
+typedef enum
+{
+  POLICY_Action_Shed       = 0,   /**< Shed outputs of priority arg and above*/
+  POLICY_Action_ShedOutput = 1,   /**< Shed output arg (0 is OUTPUT01)*/
+  POLICY_Action_Curtail    = 2,   /**< Hold all panels near open circuit*/
+  POLICY_Action_Profile    = 3,   /**< Acquisition profile arg or lower*/
+  POLICY_Action_Survival   = 4    /**< Survival mode*/
+} POLICY_Action_TypeDef;
+
+/** @enum POLICY_Profile_TypeDef
+*   @brief Acquisition profiles, from full rate down.
+*/
+typedef enum
+{
+  POLICY_Profile_Full     = 0,    /**< Telemetry sweep every second*/
+  POLICY_Profile_Reduced  = 1,    /**< Every 5 s*/
+  POLICY_Profile_Survival = 2,    /**< Every 10 s*/
+  POLICY_NUM_PROFILES             /**< Number of profiles (not a profile)*/
+} POLICY_Profile_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct POLICY_Rule_TypeDef
+*   @brief One rule of the table.
+*/
+typedef struct
+{
+  const char *name;                 /**< Short name for the console and log*/
+  POLICY_Signal_TypeDef signal;     /**< Signal tested*/
+  TELEMETRY_Channel_TypeDef channel;/**< Telemetry channel of voltage and current signals*/
+  POLICY_Compare_TypeDef compare;   /**< Direction*/
+  int32_t threshold;                /**< Activates past this value*/
+  int32_t hysteresis;               /**< Releases this far back from the threshold*/
+  uint8_t hold;                     /**< Periods the condition must hold first*/
+  uint8_t latch;                    /**< Non-zero to stay active until reset*/
+  POLICY_Action_TypeDef action;     /**< Action while active*/
+  uint8_t arg;                      /**< Priority, output or profile of the action*/
+} POLICY_Rule_TypeDef;
+
+/** @struct POLICY_Event_TypeDef
+*   @brief Entry of the event log.
+*/
+typedef struct
+{
+  uint32_t timestamp;               /**< Scheduler tick*/
+  uint8_t rule;                     /**< Index in the rule table*/
+  uint8_t active;                   /**< 1 on activation, 0 on release*/
+  int32_t value;                    /**< Signal value at the transition*/
+} POLICY_Event_TypeDef;
+
+/** @struct POLICY_State_TypeDef
+*   @brief Applied actions and statistics.
+*/
+typedef struct
+{
+  uint32_t active;                  /**< Bit set for each active rule*/
+  uint32_t outputs;                 /**< Bit set for each output switched on*/
+  uint8_t driven;                   /**< Outputs reach the load switches, 0 if only commanded*/
+  uint8_t shedPriority;             /**< Outputs at or above this are shed, POLICY_NUM_PRIORITIES for none*/
+  uint8_t curtailed;                /**< Panels held near open circuit*/
+  uint8_t survival;                 /**< Survival mode*/
+  uint8_t adcTrip;                  /**< Battery below its ADC low threshold*/
+  POLICY_Profile_TypeDef profile;   /**< Acquisition profile*/
+  uint32_t evaluations;             /**< Control periods evaluated*/
+  uint32_t invalid;                 /**< Rule evaluations skipped for a missing signal*/
+  uint32_t events;                  /**< Events logged since reset, including overwritten*/
+  uint32_t errors;                  /**< Failed output switches*/
+} POLICY_State_TypeDef;
+
+/** Switch an output (0 is OUTPUT01) on or off */
+typedef POLICY_Err_TypeDef (*POLICY_Switch_TypeDef)(uint32_t output, uint8_t on);
+
+extern const POLICY_Rule_TypeDef POLICY_DefaultRules[];
+extern const uint32_t POLICY_NumDefaultRules;
+extern const uint8_t POLICY_DefaultOutputPriority[POLICY_NUM_OUTPUTS];
+extern const uint8_t POLICY_DefaultProfileDivider[POLICY_NUM_PROFILES];
+
+POLICY_Err_TypeDef POLICY_Init(const POLICY_Rule_TypeDef *rules,
+                               uint32_t numRules,
+                               POLICY_Switch_TypeDef Switch);
+
+void POLICY_Update(void);
+
+void POLICY_Reset(void);
+
+void POLICY_Threshold(uint32_t channel,
+                      ADCACQ_Level_TypeDef level,
+                      uint32_t value);
+
+uint8_t POLICY_SweepDue(void);
+
+POLICY_Err_TypeDef POLICY_SetProfileDividers(const uint8_t *dividers);
+
+POLICY_Err_TypeDef POLICY_SetOutputPriorities(const uint8_t *priorities);
+
+const POLICY_State_TypeDef *POLICY_GetState(void);
+
+const POLICY_Event_TypeDef *POLICY_GetEvent(uint32_t age);
+
+PRINT_Err_TypeDef POLICY_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_POLICY_H_ */
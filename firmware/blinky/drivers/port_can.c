@@ -0,0 +1,578 @@
+/** @file port_can.c
+*   @brief Portable frontend for the DCAN Peripheral using TI HAL libraries.
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "port_can.h"
+#include "can.h"
+#include "sys_vim.h"
+#include "scheduler.h"
+#include "profile.h"
+#include "stdint.h"
+
+/* Controller wired to the transceiver */
+#define PORT_CAN_NODE         (canREG1)
+
+/* Interface command: write, mask, arbitration, control, clear interrupt
+ * pending, transmit request or new data, data A and B */
+#define PORT_CAN_CMD_WR       (0x80U)
+#define PORT_CAN_CMD_MASK     (0x40U)
+#define PORT_CAN_CMD_ARB      (0x20U)
+#define PORT_CAN_CMD_CONTROL  (0x10U)
+#define PORT_CAN_CMD_CLRINT   (0x08U)
+#define PORT_CAN_CMD_NEWDAT   (0x04U)
+#define PORT_CAN_CMD_DATA     (0x03U)
+#define PORT_CAN_IF_BUSY      (0x80U)
+
+/* Mask register: use identifier extension and direction for filtering */
+#define PORT_CAN_MSK_MXTD     (0x80000000U)
+#define PORT_CAN_MSK_MDIR     (0x40000000U)
+
+/* Arbitration register: valid, extended identifier, direction transmit */
+#define PORT_CAN_ARB_MSGVAL   (0x80000000U)
+#define PORT_CAN_ARB_XTD      (0x40000000U)
+#define PORT_CAN_ARB_DIR      (0x20000000U)
+
+/* Message control register */
+#define PORT_CAN_MCTL_UMASK   (0x1000U)
+#define PORT_CAN_MCTL_RXIE    (0x0400U)
+#define PORT_CAN_MCTL_TXRQST  (0x0100U)
+#define PORT_CAN_MCTL_EOB     (0x0080U)
+
+/* Error and status register */
+#define PORT_CAN_ES_LEC       (0x07U)
+#define PORT_CAN_ES_EPASS     (0x20U)
+#define PORT_CAN_ES_BOFF      (0x80U)
+
+/* Error counter register */
+#define PORT_CAN_EERC_TEC(x)  ((uint8_t)((x) & 0xFFU))
+#define PORT_CAN_EERC_REC(x)  ((uint8_t)(((x) >> 8U) & 0x7FU))
+#define PORT_CAN_TEC_PASSIVE  (128U)
+
+/* Control register: init, interrupt line 0, configuration change, test
+ * mode and parity off */
+#define PORT_CAN_CTL_INIT     (0x01U)
+#define PORT_CAN_CTL_IE0      (0x02U)
+#define PORT_CAN_CTL_CCE      (0x40U)
+#define PORT_CAN_CTL_TEST     (0x80U)
+#define PORT_CAN_CTL_PMD_OFF  (0x5U << 10U)
+
+/* Test register: loopback and silent */
+#define PORT_CAN_TEST_LBACK   (0x10U)
+#define PORT_CAN_TEST_SILENT  (0x08U)
+
+/* Interrupt register: message object number, or status interrupt */
+#define PORT_CAN_INT_ID       (0xFFFFU)
+#define PORT_CAN_INT_STATUS   (0x8000U)
+
+/* Bit timing: time quanta per bit, segments after the sync quantum and
+ * resynchronisation jump width, sampling at 80 % */
+#define PORT_CAN_TQ_PER_BIT   (10U)
+#define PORT_CAN_TSEG1        (7U)
+#define PORT_CAN_TSEG2        (2U)
+#define PORT_CAN_SJW          (2U)
+
+/* TX and RX pin control: pins used for CAN */
+#define PORT_CAN_IOC_FUNC     (0x08U)
+
+/* Data register index of each byte, as in the HALCoGen CAN driver */
+#if ((__little_endian__ == 1) || (__LITTLE_ENDIAN__ == 1))
+static const uint8_t PORT_CAN_ByteOrder[PORT_CAN_DLC] = { 3U, 2U, 1U, 0U, 7U, 6U, 5U, 4U };
+#else
+static const uint8_t PORT_CAN_ByteOrder[PORT_CAN_DLC] = { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U };
+#endif
+
+static uint8_t PORT_CAN_Ready = 0U;
+static uint32_t PORT_CAN_VclkHz = PORT_CAN_VCLK_HZ;
+static PORT_CAN_Receive_TypeDef PORT_CAN_Handler[PORT_CAN_NUM_FILTERS];
+static volatile uint32_t PORT_CAN_Received = 0U;
+static volatile uint32_t PORT_CAN_ReceivedAt = 0U;
+
+static void PORT_CAN_Configure(uint32_t box,
+                               uint32_t msk,
+                               uint32_t arb,
+                               uint32_t mctl);
+static uint32_t PORT_CAN_Timing(uint32_t vclkHz);
+static uint8_t PORT_CAN_IsPending(uint32_t box);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the controller and set up the transmit message objects.
+ *
+ * @details
+ *   Only the first call initializes the controller, so every user of the
+ *   bus may call it. The message RAM is cleared by the startup code, so
+ *   every message object starts invalid; receive message objects stay so
+ *   until their filter is set.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PORT_CAN_Err_TypeDef PORT_CAN_Init(void)
+{
+  uint32_t box;
+
+  if ( PORT_CAN_Ready )
+  {
+    return PORT_CAN_Err_NoError;
+  }
+
+  /* Stop the controller, all interrupts on line 0 */
+  PORT_CAN_NODE->CTL = PORT_CAN_CTL_PMD_OFF | PORT_CAN_CTL_CCE | PORT_CAN_CTL_INIT;
+  (void)PORT_CAN_NODE->ES;
+  PORT_CAN_NODE->INTMUXx[0U] = 0U;
+  PORT_CAN_NODE->INTMUXx[1U] = 0U;
+  PORT_CAN_NODE->INTMUXx[2U] = 0U;
+  PORT_CAN_NODE->INTMUXx[3U] = 0U;
+  PORT_CAN_NODE->ABOTR = 0U;
+  PORT_CAN_NODE->BTR = PORT_CAN_Timing(PORT_CAN_VclkHz);
+  PORT_CAN_NODE->TIOC = PORT_CAN_IOC_FUNC;
+  PORT_CAN_NODE->RIOC = PORT_CAN_IOC_FUNC;
+
+  for ( box = PORT_CAN_FIRST_TX_BOX; box < PORT_CAN_FIRST_RX_BOX; box++ )
+  {
+    PORT_CAN_Configure(box, 0U,
+                       PORT_CAN_ARB_MSGVAL | PORT_CAN_ARB_XTD | PORT_CAN_ARB_DIR,
+                       PORT_CAN_MCTL_EOB | PORT_CAN_DLC);
+  }
+
+  vimChannelMap(PORT_CAN_VIM_CHANNEL, PORT_CAN_VIM_CHANNEL, &PORT_CAN_Interrupt);
+  vimEnableInterrupt(PORT_CAN_VIM_CHANNEL, SYS_IRQ);
+
+  /* Join the bus after 11 recessive bits */
+  PORT_CAN_NODE->CTL = PORT_CAN_CTL_PMD_OFF | PORT_CAN_CTL_IE0;
+
+  PORT_CAN_Ready = 1U;
+
+  return PORT_CAN_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Send a frame from a transmit message object.
+ *
+ * @details
+ *   Identifier, control and data are written in one interface transfer.
+ *   The frame is queued in the message object and sent by the controller
+ *   when it wins arbitration; PORT_CAN_Pending returns 0 once it has been
+ *   acknowledged.
+ *
+ * @param[in] box
+ *   Transmit message object.
+ *
+ * @param[in] id
+ *   29 bit identifier.
+ *
+ * @param[in] data
+ *   PORT_CAN_DLC data bytes.
+ *
+ * @return
+ *   Returns 0 if the frame was queued.
+ ******************************************************************************/
+PORT_CAN_Err_TypeDef PORT_CAN_Send(uint32_t box,
+                                   uint32_t id,
+                                   const uint8_t *data)
+{
+  uint32_t i;
+
+  if ( box < PORT_CAN_FIRST_TX_BOX || box >= PORT_CAN_FIRST_RX_BOX || id > PORT_CAN_MAX_ID )
+  {
+    return PORT_CAN_Err_Invalid;
+  }
+
+  if ( PORT_CAN_IsPending(box) )
+  {
+    return PORT_CAN_Err_Busy;
+  }
+
+  while ( (PORT_CAN_NODE->IF1STAT & PORT_CAN_IF_BUSY) != 0U )
+  {
+  }
+
+  PORT_CAN_NODE->IF1ARB = PORT_CAN_ARB_MSGVAL | PORT_CAN_ARB_XTD | PORT_CAN_ARB_DIR | id;
+  PORT_CAN_NODE->IF1MCTL = PORT_CAN_MCTL_TXRQST | PORT_CAN_MCTL_EOB | PORT_CAN_DLC;
+
+  for ( i = 0U; i < PORT_CAN_DLC; i++ )
+  {
+    PORT_CAN_NODE->IF1DATx[PORT_CAN_ByteOrder[i]] = data[i];
+  }
+
+  PORT_CAN_NODE->IF1CMD = PORT_CAN_CMD_WR | PORT_CAN_CMD_ARB | PORT_CAN_CMD_CONTROL
+                          | PORT_CAN_CMD_NEWDAT | PORT_CAN_CMD_DATA;
+  PORT_CAN_NODE->IF1NO = (uint8_t)box;
+
+  return PORT_CAN_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check whether a message object still has a frame to send.
+ *
+ * @param[in] box
+ *   Transmit message object.
+ *
+ * @return
+ *   Returns 1 while the frame has not been acknowledged.
+ ******************************************************************************/
+uint8_t PORT_CAN_Pending(uint32_t box)
+{
+  return PORT_CAN_IsPending(box);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Withdraw the frame of a transmit message object.
+ *
+ * @details
+ *   Clears the transmission request; a frame already being sent is
+ *   finished by the controller. For users giving up on a transfer, so
+ *   their frames do not go out after it was abandoned.
+ *
+ * @param[in] box
+ *   Transmit message object.
+ ******************************************************************************/
+void PORT_CAN_Cancel(uint32_t box)
+{
+  if ( box < PORT_CAN_FIRST_TX_BOX || box >= PORT_CAN_FIRST_RX_BOX )
+  {
+    return;
+  }
+
+  while ( (PORT_CAN_NODE->IF1STAT & PORT_CAN_IF_BUSY) != 0U )
+  {
+  }
+
+  PORT_CAN_NODE->IF1MCTL = PORT_CAN_MCTL_EOB | PORT_CAN_DLC;
+  PORT_CAN_NODE->IF1CMD = PORT_CAN_CMD_WR | PORT_CAN_CMD_CONTROL;
+  PORT_CAN_NODE->IF1NO = (uint8_t)box;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check for traffic stopping the controller would cut.
+ *
+ * @details
+ *   Busy while a transmit message object has a frame to send, or for
+ *   PORT_CAN_RX_HOLD ticks after a received frame. Pending frames do not
+ *   count once the controller is error passive or bus off: nobody is
+ *   acknowledging them and they would hold off the caller indefinitely.
+ *
+ * @return
+ *   Returns 1 if busy.
+ ******************************************************************************/
+uint8_t PORT_CAN_IsBusy(void)
+{
+  uint32_t box;
+
+  if ( !PORT_CAN_Ready )
+  {
+    return 0U;
+  }
+
+  /* Error passive from the counter, bus off from init: reading the status
+   * register would clear the error code PORT_CAN_GetStatus reports */
+  if ( PORT_CAN_EERC_TEC(PORT_CAN_NODE->EERC) < PORT_CAN_TEC_PASSIVE
+       && (PORT_CAN_NODE->CTL & PORT_CAN_CTL_INIT) == 0U )
+  {
+    for ( box = PORT_CAN_FIRST_TX_BOX; box < PORT_CAN_FIRST_RX_BOX; box++ )
+    {
+      if ( PORT_CAN_IsPending(box) )
+      {
+        return 1U;
+      }
+    }
+  }
+
+  return (PORT_CAN_Received != 0U
+          && SCHEDULER_GetTicks() - PORT_CAN_ReceivedAt < PORT_CAN_RX_HOLD) ? 1U : 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Accept frames matching an identifier and mask and pass them to a
+ *   handler.
+ *
+ * @details
+ *   A frame is accepted if its identifier equals id in every bit set in
+ *   mask. The handler runs in the CAN interrupt and must not send.
+ *
+ * @param[in] filter
+ *   Filter, below PORT_CAN_NUM_FILTERS.
+ *
+ * @param[in] id
+ *   29 bit identifier.
+ *
+ * @param[in] mask
+ *   Identifier bits that must match.
+ *
+ * @param[in] receive
+ *   Handler, or null to stop receiving.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PORT_CAN_Err_TypeDef PORT_CAN_SetFilter(uint32_t filter,
+                                        uint32_t id,
+                                        uint32_t mask,
+                                        PORT_CAN_Receive_TypeDef receive)
+{
+  uint32_t box = PORT_CAN_FIRST_RX_BOX + filter * PORT_CAN_FILTER_DEPTH;
+  uint32_t i;
+
+  if ( filter >= PORT_CAN_NUM_FILTERS || id > PORT_CAN_MAX_ID )
+  {
+    return PORT_CAN_Err_Invalid;
+  }
+
+  PORT_CAN_Handler[filter] = receive;
+
+  /* FIFO of message objects, end of buffer on the last */
+  for ( i = 0U; i < PORT_CAN_FILTER_DEPTH; i++ )
+  {
+    PORT_CAN_Configure(box + i,
+                       PORT_CAN_MSK_MXTD | PORT_CAN_MSK_MDIR | (mask & PORT_CAN_MAX_ID),
+                       ((receive != 0) ? PORT_CAN_ARB_MSGVAL : 0U) | PORT_CAN_ARB_XTD | id,
+                       PORT_CAN_MCTL_UMASK | PORT_CAN_MCTL_RXIE | PORT_CAN_DLC
+                       | ((i == PORT_CAN_FILTER_DEPTH - 1U) ? PORT_CAN_MCTL_EOB : 0U));
+  }
+
+  return PORT_CAN_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read the error counters and state.
+ *
+ * @details
+ *   Reading the status clears the last error code, so only one user
+ *   should poll it.
+ *
+ * @param[out] status
+ *   Counters and state.
+ ******************************************************************************/
+void PORT_CAN_GetStatus(PORT_CAN_Status_TypeDef *status)
+{
+  uint32_t es = PORT_CAN_NODE->ES;
+  uint32_t eerc = PORT_CAN_NODE->EERC;
+  uint32_t lec = es & PORT_CAN_ES_LEC;
+
+  status->txErrors = PORT_CAN_EERC_TEC(eerc);
+  status->rxErrors = PORT_CAN_EERC_REC(eerc);
+  status->passive = ((es & PORT_CAN_ES_EPASS) != 0U) ? 1U : 0U;
+  status->busOff = ((es & PORT_CAN_ES_BOFF) != 0U) ? 1U : 0U;
+  status->lastError = (uint8_t)((lec == canERROR_NO) ? canERROR_OK : lec);
+  status->received = PORT_CAN_Received;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start the bus off recovery.
+ *
+ * @details
+ *   The controller stops at bus off with the init bit set. Clearing it
+ *   rejoins the bus after 128 occurrences of 11 recessive bits; frames
+ *   queued in the message objects are sent after that.
+ *
+ * @return
+ *   Returns 1 if recovery was started.
+ ******************************************************************************/
+uint8_t PORT_CAN_Recover(void)
+{
+  if ( (PORT_CAN_NODE->ES & PORT_CAN_ES_BOFF) == 0U
+       || (PORT_CAN_NODE->CTL & PORT_CAN_CTL_INIT) == 0U )
+  {
+    return 0U;
+  }
+
+  PORT_CAN_NODE->CTL &= ~PORT_CAN_CTL_INIT;
+
+  return 1U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the bit timing for a new VCLK so the bit rate stays at
+ *   PORT_CAN_BITRATE.
+ *
+ * @details
+ *   The timing can only be written in init, so a frame on the bus at that
+ *   moment is cut: one being sent stays requested and is sent again, one
+ *   being received is lost if another node acknowledged it. Callers wait
+ *   for PORT_CAN_IsBusy to return 0 first. A controller stopped at bus
+ *   off stays stopped. Before PORT_CAN_Init only
+ *   the clock is kept for it.
+ *
+ * @param[in] vclkHz
+ *   VCLK in Hz, a multiple of PORT_CAN_BITRATE * 10.
+ ******************************************************************************/
+void PORT_CAN_SetClock(uint32_t vclkHz)
+{
+  uint32_t ctl;
+
+  PORT_CAN_VclkHz = vclkHz;
+
+  if ( !PORT_CAN_Ready )
+  {
+    return;
+  }
+
+  ctl = PORT_CAN_NODE->CTL;
+  PORT_CAN_NODE->CTL = ctl | PORT_CAN_CTL_CCE | PORT_CAN_CTL_INIT;
+  PORT_CAN_NODE->BTR = PORT_CAN_Timing(vclkHz);
+  PORT_CAN_NODE->CTL = ctl & ~PORT_CAN_CTL_CCE;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Enter or leave silent internal loopback.
+ *
+ * @details
+ *   In loopback every frame sent is acknowledged by the controller itself
+ *   and received through the filters like one from the bus, while the
+ *   transmit pin stays recessive and the bus is not listened to. For test
+ *   benches; publishing and replies go nowhere meanwhile.
+ *
+ * @param[in] enable
+ *   1 to enter, 0 to leave.
+ ******************************************************************************/
+void PORT_CAN_SetLoopback(uint8_t enable)
+{
+  if ( enable )
+  {
+    PORT_CAN_NODE->CTL |= PORT_CAN_CTL_TEST;
+    PORT_CAN_NODE->TEST |= PORT_CAN_TEST_LBACK | PORT_CAN_TEST_SILENT;
+  }
+  else
+  {
+    PORT_CAN_NODE->TEST &= ~(PORT_CAN_TEST_LBACK | PORT_CAN_TEST_SILENT);
+    PORT_CAN_NODE->CTL &= ~PORT_CAN_CTL_TEST;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   CAN1 level 0 interrupt. Reads every frame the filters accepted and
+ *   passes it to the handler of its filter.
+ *
+ * @details
+ *   Only interface register set 2 is used here, set 1 belongs to task
+ *   context. Identifier, data and the new data flag are read and the
+ *   interrupt pending flag cleared in one transfer, until the interrupt
+ *   register shows no more message objects.
+ ******************************************************************************/
+#pragma CODE_STATE(PORT_CAN_Interrupt, 32)
+#pragma INTERRUPT(PORT_CAN_Interrupt, IRQ)
+void PORT_CAN_Interrupt(void)
+{
+  uint8_t data[PORT_CAN_DLC];
+  uint32_t box;
+  uint32_t filter;
+  uint32_t i;
+
+  PROFILE_BEGIN(PROFILE_Scope_CanIsr);
+
+  while ( (box = PORT_CAN_NODE->INT & PORT_CAN_INT_ID) != 0U )
+  {
+    if ( box == PORT_CAN_INT_STATUS )
+    {
+      /* Reading the status clears it */
+      (void)PORT_CAN_NODE->ES;
+      continue;
+    }
+
+    while ( (PORT_CAN_NODE->IF2STAT & PORT_CAN_IF_BUSY) != 0U )
+    {
+    }
+
+    PORT_CAN_NODE->IF2CMD = PORT_CAN_CMD_ARB | PORT_CAN_CMD_CONTROL | PORT_CAN_CMD_CLRINT
+                            | PORT_CAN_CMD_NEWDAT | PORT_CAN_CMD_DATA;
+    PORT_CAN_NODE->IF2NO = (uint8_t)box;
+
+    while ( (PORT_CAN_NODE->IF2STAT & PORT_CAN_IF_BUSY) != 0U )
+    {
+    }
+
+    if ( box < PORT_CAN_FIRST_RX_BOX
+         || box >= PORT_CAN_FIRST_RX_BOX + PORT_CAN_NUM_FILTERS * PORT_CAN_FILTER_DEPTH )
+    {
+      continue;
+    }
+
+    for ( i = 0U; i < PORT_CAN_DLC; i++ )
+    {
+      data[i] = PORT_CAN_NODE->IF2DATx[PORT_CAN_ByteOrder[i]];
+    }
+
+    PORT_CAN_Received++;
+    PORT_CAN_ReceivedAt = SCHEDULER_GetTicks();
+
+    filter = (box - PORT_CAN_FIRST_RX_BOX) / PORT_CAN_FILTER_DEPTH;
+    if ( PORT_CAN_Handler[filter] != 0 )
+    {
+      PORT_CAN_Handler[filter](PORT_CAN_NODE->IF2ARB & PORT_CAN_MAX_ID, data);
+    }
+  }
+
+  PROFILE_END(PROFILE_Scope_CanIsr);
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Write mask, arbitration and control of a message object.
+ ******************************************************************************/
+static void PORT_CAN_Configure(uint32_t box,
+                               uint32_t msk,
+                               uint32_t arb,
+                               uint32_t mctl)
+{
+  while ( (PORT_CAN_NODE->IF1STAT & PORT_CAN_IF_BUSY) != 0U )
+  {
+  }
+
+  PORT_CAN_NODE->IF1MSK = msk;
+  PORT_CAN_NODE->IF1ARB = arb;
+  PORT_CAN_NODE->IF1MCTL = mctl;
+  PORT_CAN_NODE->IF1CMD = PORT_CAN_CMD_WR | PORT_CAN_CMD_MASK | PORT_CAN_CMD_ARB
+                          | PORT_CAN_CMD_CONTROL | PORT_CAN_CMD_CLRINT;
+  PORT_CAN_NODE->IF1NO = (uint8_t)box;
+
+  while ( (PORT_CAN_NODE->IF1STAT & PORT_CAN_IF_BUSY) != 0U )
+  {
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Bit timing register value for PORT_CAN_BITRATE at a VCLK.
+ ******************************************************************************/
+static uint32_t PORT_CAN_Timing(uint32_t vclkHz)
+{
+  uint32_t brp = vclkHz / (PORT_CAN_BITRATE * PORT_CAN_TQ_PER_BIT) - 1U;
+
+  return ((brp >> 6U) << 16U)
+         | ((PORT_CAN_TSEG2 - 1U) << 12U)
+         | ((PORT_CAN_TSEG1 - 1U) << 8U)
+         | ((PORT_CAN_SJW - 1U) << 6U)
+         | (brp & 0x3FU);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check the transmission request of a message object.
+ ******************************************************************************/
+static uint8_t PORT_CAN_IsPending(uint32_t box)
+{
+  uint32_t bit = box - 1U;
+
+  return ((PORT_CAN_NODE->TXRQx[bit >> 5U] & (1UL << (bit & 31U))) != 0U) ? 1U : 0U;
+}
@@ -0,0 +1,211 @@
+/** @file port_can.h
+*   @brief Portable frontend for the DCAN Peripheral.
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup PORT_CAN PORT_CAN
+ *  @brief Portable DCAN Peripheral Frontend Module.
+ *
+ *  Wraps CAN1, wired to the TCAN337 transceiver. All frames use 29 bit
+ *  identifiers and PORT_CAN_DLC data bytes.
+ *
+ *  Message objects PORT_CAN_FIRST_TX_BOX to PORT_CAN_FIRST_TX_BOX +
+ *  PORT_CAN_NUM_TX_BOXES - 1 transmit; the identifier is written with
+ *  every frame, so any of them can carry any frame. The controller sends
+ *  the pending object with the lowest number first, so each user takes
+ *  its own range (see cancmd.h and canpub.h) and the more urgent user the
+ *  lower one.
+ *
+ *  A user keeps its range in a PORT_CAN_Pool_TypeDef: PORT_CAN_PoolSend
+ *  places a frame in a free message object of the range and
+ *  PORT_CAN_PoolReap frees those whose frame was acknowledged. An ordered
+ *  pool only fills message objects above every one still pending, so the
+ *  frames of a transfer leave in the order they were sent; otherwise the
+ *  next free one after the last used is taken, spreading the frames over
+ *  the range.
+ *
+ *  Each of the PORT_CAN_NUM_FILTERS receive filters is an identifier and
+ *  mask set in PORT_CAN_FILTER_DEPTH receive message objects chained as a
+ *  FIFO. The controller drops frames no filter accepts, only accepted
+ *  frames raise the interrupt, in which they are read and passed to the
+ *  handler of the filter.
+ *
+ *  Transmission goes through interface register set 1 and is only used
+ *  from task context; the receive interrupt has set 2 to itself.
+ *
+ *  The controller has no bus idle flag. PORT_CAN_IsBusy reports a frame
+ *  waiting in a transmit message object, or one received in the last
+ *  PORT_CAN_RX_HOLD ticks, since commands and CSP packets come as bursts of
+ *  frames. GOVERNOR defers clock changes, which stop the controller for the
+ *  new bit timing, and IDLE the deep modes, which gate its clock, while it
+ *  returns 1; a frame arriving in a deep mode is not received and not
+ *  acknowledged by this node.
+ *
+ *  CAN1 is not enabled in HALCoGen, so there is no can.c: the controller
+ *  is programmed here from the registers of reg_can.h, as the MibADC and
+ *  MibSPI are by their drivers. The bit timing is derived from VCLK for
+ *  PORT_CAN_BITRATE and set again by GOVERNOR through PORT_CAN_SetClock
+ *  on every VCLK change, and PORT_CAN_Interrupt is mapped to the level 0 VIM
+ *  channel by PORT_CAN_Init, so it replaces the HALCoGen handler that
+ *  would use interface register set 1. The message RAM is initialized by
+ *  the startup code.
+ *
+ *  Host tools provide their own implementation of these functions, except
+ *  for the pools of port_can_pool.c, which only use PORT_CAN_Send,
+ *  PORT_CAN_Pending and PORT_CAN_Cancel.
+ *
+ *	Related Files
+ *   - port_can.h
+ *   - port_can.c
+ *   - port_can_pool.c
+ *   - can.h
+ *   - reg_can.h
+ *   - sys_vim.h
+ *   - scheduler.h
+ *   - profile.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_PORT_CAN_H_
+#define DRIVERS_PORT_CAN_H_
+
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Bit rate, in bit/s */
+#define PORT_CAN_BITRATE        (500000U)
+
+/** VCLK at reset, used by PORT_CAN_Init */
+#define PORT_CAN_VCLK_HZ        (80000000U)
+
+/** VIM channel of the CAN1 level 0 interrupt */
+#define PORT_CAN_VIM_CHANNEL    (16U)
+
+/** Data bytes of every frame */
+#define PORT_CAN_DLC            (8U)
+
+/** First transmit message object */
+#define PORT_CAN_FIRST_TX_BOX   (1U)
+
+/** Number of transmit message objects */
+#define PORT_CAN_NUM_TX_BOXES   (16U)
+
+/** First receive message object */
+#define PORT_CAN_FIRST_RX_BOX   (PORT_CAN_FIRST_TX_BOX + PORT_CAN_NUM_TX_BOXES)
+
+/** Number of receive filters */
+#define PORT_CAN_NUM_FILTERS    (2U)
+
+/** Receive message objects of each filter */
+#define PORT_CAN_FILTER_DEPTH   (4U)
+
+/** Ticks after a received frame during which the bus counts as busy */
+#define PORT_CAN_RX_HOLD        (20U)
+
+/** Largest 29 bit identifier */
+#define PORT_CAN_MAX_ID         (0x1FFFFFFFU)
+
+/** Bits on the bus of one extended frame of PORT_CAN_DLC bytes, with worst
+ *  case stuffing and the interframe space */
+#define PORT_CAN_FRAME_BITS     (67U + 8U * PORT_CAN_DLC + (54U + 8U * PORT_CAN_DLC - 1U) / 4U)
+
+/**
+ *  @addtogroup PORT_CAN
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum PORT_CAN_Err_TypeDef
+*   @brief Alias names for PORT_CAN errors.
+*/
+typedef enum
+{
+  PORT_CAN_Err_NoError = 0U,      /**< No error*/
+  PORT_CAN_Err_Busy    = 1U,      /**< Message object still has a frame to send*/
+  PORT_CAN_Err_Invalid = 2U       /**< Not a transmit message object or filter, or identifier out of range*/
+} PORT_CAN_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct PORT_CAN_Status_TypeDef
+*   @brief Error counters and state of the controller.
+*/
+typedef struct
+{
+  uint8_t txErrors;               /**< Transmit error counter*/
+  uint8_t rxErrors;               /**< Receive error counter*/
+  uint8_t passive;                /**< Error passive*/
+  uint8_t busOff;                 /**< Bus off*/
+  uint8_t lastError;              /**< Error code since the last call, canERROR_*, 0 for none*/
+  uint32_t received;              /**< Frames accepted by the filters*/
+} PORT_CAN_Status_TypeDef;
+
+/** @struct PORT_CAN_Pool_TypeDef
+*   @brief Range of transmit message objects of one user.
+*/
+typedef struct
+{
+  uint8_t first;                  /**< First message object*/
+  uint8_t num;                    /**< Message objects, 1 to 32*/
+  uint8_t ordered;                /**< Frames leave in the order sent*/
+  uint8_t next;                   /**< Message object tried first, from first*/
+  uint32_t inFlight;              /**< Bit set for each message object with a frame*/
+} PORT_CAN_Pool_TypeDef;
+
+/** Handler of a receive filter, called from the CAN interrupt */
+typedef void (*PORT_CAN_Receive_TypeDef)(uint32_t id, const uint8_t *data);
+
+PORT_CAN_Err_TypeDef PORT_CAN_Init(void);
+
+PORT_CAN_Err_TypeDef PORT_CAN_Send(uint32_t box,
+                                   uint32_t id,
+                                   const uint8_t *data);
+
+uint8_t PORT_CAN_Pending(uint32_t box);
+
+void PORT_CAN_Cancel(uint32_t box);
+
+uint8_t PORT_CAN_IsBusy(void);
+
+PORT_CAN_Err_TypeDef PORT_CAN_SetFilter(uint32_t filter,
+                                        uint32_t id,
+                                        uint32_t mask,
+                                        PORT_CAN_Receive_TypeDef receive);
+
+void PORT_CAN_GetStatus(PORT_CAN_Status_TypeDef *status);
+
+uint8_t PORT_CAN_Recover(void);
+
+void PORT_CAN_SetClock(uint32_t vclkHz);
+
+void PORT_CAN_SetLoopback(uint8_t enable);
+
+void PORT_CAN_Interrupt(void);
+
+PORT_CAN_Err_TypeDef PORT_CAN_PoolInit(PORT_CAN_Pool_TypeDef *pool,
+                                       uint32_t first,
+                                       uint32_t num,
+                                       uint8_t ordered);
+
+uint32_t PORT_CAN_PoolReap(PORT_CAN_Pool_TypeDef *pool);
+
+PORT_CAN_Err_TypeDef PORT_CAN_PoolSend(PORT_CAN_Pool_TypeDef *pool,
+                                       uint32_t id,
+                                       const uint8_t *data);
+
+void PORT_CAN_PoolCancel(PORT_CAN_Pool_TypeDef *pool);
+
+/**@}*/
+
+#endif /* DRIVERS_PORT_CAN_H_ */
@@ -0,0 +1,177 @@
+/** @file port_can_pool.c
+*   @brief Transmit message object pools of the DCAN Peripheral frontend.
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "port_can.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Set up a pool over a range of transmit message objects, all free.
+ *
+ * @param[out] pool
+ *   Pool.
+ *
+ * @param[in] first
+ *   First message object.
+ *
+ * @param[in] num
+ *   Message objects, 1 to 32.
+ *
+ * @param[in] ordered
+ *   1 if frames must leave in the order sent.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PORT_CAN_Err_TypeDef PORT_CAN_PoolInit(PORT_CAN_Pool_TypeDef *pool,
+                                       uint32_t first,
+                                       uint32_t num,
+                                       uint8_t ordered)
+{
+  if ( first < PORT_CAN_FIRST_TX_BOX || num == 0U || num > 32U
+       || first + num > PORT_CAN_FIRST_RX_BOX )
+  {
+    return PORT_CAN_Err_Invalid;
+  }
+
+  pool->first = (uint8_t)first;
+  pool->num = (uint8_t)num;
+  pool->ordered = ordered;
+  pool->next = 0U;
+  pool->inFlight = 0U;
+
+  return PORT_CAN_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Free the message objects whose frame was acknowledged.
+ *
+ * @param[in] pool
+ *   Pool.
+ *
+ * @return
+ *   Returns the frames acknowledged since the last call.
+ ******************************************************************************/
+uint32_t PORT_CAN_PoolReap(PORT_CAN_Pool_TypeDef *pool)
+{
+  uint32_t acked = 0U;
+  uint32_t b;
+
+  for ( b = 0U; b < pool->num; b++ )
+  {
+    if ( (pool->inFlight & (1UL << b)) != 0U
+         && !PORT_CAN_Pending(pool->first + b) )
+    {
+      pool->inFlight &= ~(1UL << b);
+      acked++;
+    }
+  }
+
+  return acked;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Send a frame from a free message object of the pool.
+ *
+ * @details
+ *   An ordered pool takes the lowest free message object above every one
+ *   still pending, so it waits for the range to drain before starting
+ *   again from its first. Other pools take the next free message object
+ *   after the last used.
+ *
+ * @param[in] pool
+ *   Pool.
+ *
+ * @param[in] id
+ *   29 bit identifier.
+ *
+ * @param[in] data
+ *   PORT_CAN_DLC data bytes.
+ *
+ * @return
+ *   Returns 0 if the frame was queued, PORT_CAN_Err_Busy if no message
+ *   object can take it now.
+ ******************************************************************************/
+PORT_CAN_Err_TypeDef PORT_CAN_PoolSend(PORT_CAN_Pool_TypeDef *pool,
+                                       uint32_t id,
+                                       const uint8_t *data)
+{
+  PORT_CAN_Err_TypeDef err;
+  uint32_t tried;
+  uint32_t b = 0U;
+
+  if ( pool->ordered )
+  {
+    while ( b < pool->num && (pool->inFlight >> b) != 0U )
+    {
+      b++;
+    }
+    if ( b == pool->num )
+    {
+      return PORT_CAN_Err_Busy;
+    }
+  }
+  else
+  {
+    for ( tried = 0U; tried < pool->num; tried++ )
+    {
+      b = (pool->next + tried) % pool->num;
+      if ( (pool->inFlight & (1UL << b)) == 0U )
+      {
+        break;
+      }
+    }
+    if ( tried == pool->num )
+    {
+      return PORT_CAN_Err_Busy;
+    }
+  }
+
+  /* Still sending, e.g. held at bus off */
+  err = PORT_CAN_Send(pool->first + b, id, data);
+  if ( err != PORT_CAN_Err_NoError )
+  {
+    return err;
+  }
+
+  pool->inFlight |= 1UL << b;
+  pool->next = (uint8_t)((b + 1U) % pool->num);
+
+  return PORT_CAN_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Withdraw every frame of the pool not sent yet and free its message
+ *   objects.
+ *
+ * @details
+ *   A frame being sent at the time is finished by the controller.
+ *
+ * @param[in] pool
+ *   Pool.
+ ******************************************************************************/
+void PORT_CAN_PoolCancel(PORT_CAN_Pool_TypeDef *pool)
+{
+  uint32_t b;
+
+  for ( b = 0U; b < pool->num; b++ )
+  {
+    if ( (pool->inFlight & (1UL << b)) != 0U )
+    {
+      PORT_CAN_Cancel(pool->first + b);
+    }
+  }
+
+  pool->inFlight = 0U;
+}
@@ -0,0 +1,272 @@
+/** @file port_fee.c
+*   @brief Portable frontend for the Flash EEPROM Emulation using TI HAL libraries.
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "port_fee.h"
+#if PORT_FEE_ENABLE
+#include "ti_fee.h"
+#endif
+#include "stdint.h"
+
+#if PORT_FEE_ENABLE
+
+/* FEE instance on the data flash bank */
+#define PORT_FEE_EEP          (0U)
+
+static uint8_t PORT_FEE_Ready = 0U;
+
+static PORT_FEE_Err_TypeDef PORT_FEE_MapResult(TI_FeeJobResultType result);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the FEE driver and wait until it has scanned the virtual
+ *   sectors.
+ *
+ * @details
+ *   Only the first call initializes the driver, so every user of the FEE
+ *   may call it.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PORT_FEE_Err_TypeDef PORT_FEE_Init(void)
+{
+  uint32_t i;
+
+  if ( PORT_FEE_Ready )
+  {
+    return PORT_FEE_Err_NoError;
+  }
+
+  TI_Fee_Init();
+
+  for ( i = 0U; i < PORT_FEE_MAX_POLLS && TI_Fee_GetStatus(PORT_FEE_EEP) != IDLE; i++ )
+  {
+    TI_Fee_MainFunction();
+  }
+
+  if ( TI_Fee_GetStatus(PORT_FEE_EEP) != IDLE )
+  {
+    return PORT_FEE_Err_Busy;
+  }
+
+  PORT_FEE_Ready = 1U;
+
+  return PORT_FEE_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start writing a whole block.
+ *
+ * @details
+ *   The buffer must stay unchanged until PORT_FEE_Busy returns 0.
+ *
+ * @param[in] block
+ *   FEE block number.
+ *
+ * @param[in] data
+ *   Block contents, the configured block size.
+ *
+ * @return
+ *   Returns 0 if the write was started.
+ ******************************************************************************/
+PORT_FEE_Err_TypeDef PORT_FEE_WriteAsync(uint16_t block, uint8_t *data)
+{
+  if ( TI_Fee_GetStatus(PORT_FEE_EEP) != IDLE )
+  {
+    return PORT_FEE_Err_Busy;
+  }
+
+  return (TI_Fee_WriteAsync(block, data) == E_OK) ? PORT_FEE_Err_NoError
+                                                  : PORT_FEE_Err_Failed;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write a whole block and wait for the write to complete.
+ *
+ * @param[in] block
+ *   FEE block number.
+ *
+ * @param[in] data
+ *   Block contents, the configured block size.
+ *
+ * @return
+ *   Returns 0 if the block was written.
+ ******************************************************************************/
+PORT_FEE_Err_TypeDef PORT_FEE_WriteSync(uint16_t block, uint8_t *data)
+{
+  PORT_FEE_Err_TypeDef ret;
+  uint32_t i;
+
+  ret = PORT_FEE_WriteAsync(block, data);
+
+  for ( i = 0U; ret == PORT_FEE_Err_NoError && i < PORT_FEE_MAX_POLLS && PORT_FEE_Busy(); i++ )
+  {
+    TI_Fee_MainFunction();
+  }
+
+  if ( ret != PORT_FEE_Err_NoError )
+  {
+    return ret;
+  }
+
+  return PORT_FEE_Busy() ? PORT_FEE_Err_Busy : PORT_FEE_GetResult();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read part of a block.
+ *
+ * @param[in] block
+ *   FEE block number.
+ *
+ * @param[in] offset
+ *   First byte within the block.
+ *
+ * @param[out] data
+ *   Buffer of length bytes.
+ *
+ * @param[in] length
+ *   Number of bytes.
+ *
+ * @return
+ *   Returns 0 if no error, PORT_FEE_Err_Invalid if the block holds no data.
+ ******************************************************************************/
+PORT_FEE_Err_TypeDef PORT_FEE_Read(uint16_t block,
+                                   uint16_t offset,
+                                   uint8_t *data,
+                                   uint16_t length)
+{
+  if ( TI_Fee_GetStatus(PORT_FEE_EEP) != IDLE )
+  {
+    return PORT_FEE_Err_Busy;
+  }
+
+  if ( TI_Fee_ReadSync(block, offset, data, length) != E_OK )
+  {
+    return PORT_FEE_Err_Invalid;
+  }
+
+  return PORT_FEE_MapResult(TI_Fee_GetJobResult(PORT_FEE_EEP));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the result of the last job.
+ *
+ * @return
+ *   Returns 0 if the job completed.
+ ******************************************************************************/
+PORT_FEE_Err_TypeDef PORT_FEE_GetResult(void)
+{
+  return PORT_FEE_MapResult(TI_Fee_GetJobResult(PORT_FEE_EEP));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check for a job in progress, including internal sector copies.
+ *
+ * @return
+ *   Returns 1 if busy.
+ ******************************************************************************/
+uint8_t PORT_FEE_Busy(void)
+{
+  return (TI_Fee_GetStatus(PORT_FEE_EEP) != IDLE) ? 1U : 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Progress the current job. Call periodically from a task.
+ ******************************************************************************/
+void PORT_FEE_MainFunction(void)
+{
+  TI_Fee_MainFunction();
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Map a TI FEE job result to a PORT_FEE error.
+ ******************************************************************************/
+static PORT_FEE_Err_TypeDef PORT_FEE_MapResult(TI_FeeJobResultType result)
+{
+  switch ( result )
+  {
+    case JOB_OK:
+      return PORT_FEE_Err_NoError;
+    case JOB_PENDING:
+      return PORT_FEE_Err_Busy;
+    case BLOCK_INCONSISTENT:
+    case BLOCK_INVALID:
+      return PORT_FEE_Err_Invalid;
+    default:
+      return PORT_FEE_Err_Failed;
+  }
+}
+
+#else
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/* Built without the FEE driver, every job fails and nothing is ever busy */
+
+PORT_FEE_Err_TypeDef PORT_FEE_Init(void)
+{
+  return PORT_FEE_Err_Disabled;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_WriteAsync(uint16_t block, uint8_t *data)
+{
+  (void)block;
+  (void)data;
+
+  return PORT_FEE_Err_Disabled;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_WriteSync(uint16_t block, uint8_t *data)
+{
+  return PORT_FEE_WriteAsync(block, data);
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_Read(uint16_t block,
+                                   uint16_t offset,
+                                   uint8_t *data,
+                                   uint16_t length)
+{
+  (void)block;
+  (void)offset;
+  (void)data;
+  (void)length;
+
+  return PORT_FEE_Err_Disabled;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_GetResult(void)
+{
+  return PORT_FEE_Err_Disabled;
+}
+
+uint8_t PORT_FEE_Busy(void)
+{
+  return 0U;
+}
+
+void PORT_FEE_MainFunction(void)
+{
+}
+
+#endif /* PORT_FEE_ENABLE */
@@ -0,0 +1,109 @@
+/** @file port_fee.h
+*   @brief Portable frontend for the Flash EEPROM Emulation using TI HAL libraries.
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup PORT_FEE PORT_FEE
+ *  @brief Portable Flash EEPROM Emulation Frontend Module for TI HAL libraries.
+ *
+ *  Wraps the TI FEE driver on the data flash bank (EEP 0) in polling mode:
+ *  writes are started here and progressed by PORT_FEE_MainFunction, called
+ *  from a scheduler task, reads are synchronous. One job runs at a time; a
+ *  user that gets PORT_FEE_Err_Busy tries again on its next run. Blocks are
+ *  numbered as in the HALCoGen FEE block configuration, which must hold
+ *  the blocks the users of this module expect (see flashlog.h and
+ *  config.h).
+ *
+ *  blinky.dil enables FEE with blocks 1 to 16 of 1024 bytes, the most the
+ *  HALCoGen block configuration takes, in two virtual sectors of eight
+ *  4 KB data flash sectors each, so one always has room for a copy of
+ *  every block while the other is erased. The TI FEE sources and a
+ *  ti_fee_cfg.h with these blocks only exist once HALCoGen has generated
+ *  the project. Until they are committed PORT_FEE_ENABLE is 0 and the
+ *  driver is compiled out: every job fails with PORT_FEE_Err_Disabled,
+ *  so FLASHLOG reports a flash error and CONFIG runs on its defaults and
+ *  refuses commits.
+ *  After generating, add the ti_fee*.c sources to the build and set
+ *  PORT_FEE_ENABLE to 1.
+ *
+ *  Host tools provide their own RAM backed implementation of these
+ *  functions.
+ *
+ *	Related Files
+ *   - port_fee.h
+ *   - port_fee.c
+ *   - ti_fee.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_PORT_FEE_H_
+#define DRIVERS_PORT_FEE_H_
+
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Set to 1 once the TI FEE driver is generated by HALCoGen. */
+#ifndef PORT_FEE_ENABLE
+#define PORT_FEE_ENABLE       (0)
+#endif
+
+/** Blocks of the HALCoGen FEE block configuration, numbered from 1 */
+#define PORT_FEE_NUM_BLOCKS   (16U)
+
+/** Size of every block of the HALCoGen FEE block configuration in bytes */
+#define PORT_FEE_BLOCK_SIZE   (1024U)
+
+/** Calls of the main function allowed to finish initialisation or a sync write */
+#define PORT_FEE_MAX_POLLS    (1000000U)
+
+/**
+ *  @addtogroup PORT_FEE
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum PORT_FEE_Err_TypeDef
+*   @brief Alias names for PORT_FEE errors.
+*/
+typedef enum
+{
+  PORT_FEE_Err_NoError = 0U,      /**< No error*/
+  PORT_FEE_Err_Busy    = 1U,      /**< A job is in progress*/
+  PORT_FEE_Err_Failed  = 2U,      /**< Job failed*/
+  PORT_FEE_Err_Invalid = 3U,      /**< Block never written, invalidated or inconsistent*/
+  PORT_FEE_Err_Disabled = 4U      /**< Built without the FEE driver*/
+} PORT_FEE_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+PORT_FEE_Err_TypeDef PORT_FEE_Init(void);
+
+PORT_FEE_Err_TypeDef PORT_FEE_WriteAsync(uint16_t block, uint8_t *data);
+
+PORT_FEE_Err_TypeDef PORT_FEE_WriteSync(uint16_t block, uint8_t *data);
+
+PORT_FEE_Err_TypeDef PORT_FEE_Read(uint16_t block,
+                                   uint16_t offset,
+                                   uint8_t *data,
+                                   uint16_t length);
+
+PORT_FEE_Err_TypeDef PORT_FEE_GetResult(void);
+
+uint8_t PORT_FEE_Busy(void);
+
+void PORT_FEE_MainFunction(void);
+
+/**@}*/
+
+#endif /* DRIVERS_PORT_FEE_H_ */
@@ -7,6 +7,7 @@
 
 #include "port_i2c.h"
 #include "i2c.h"
+#include "profile.h"
 #include "stdint.h"
 
 /*******************************************************************************
@@ -40,6 +41,8 @@ PORT_I2C_Err_TypeDef PORT_I2C_Send(PORT_I2C_Reg_TypeDef *i2c,
 {
 
   uint32_t i = 0;
+  PORT_I2C_Err_TypeDef ret;
+  PROFILE_BEGIN(PROFILE_Scope_I2CSend);
 
   /* Configure address of Slave to talk to */
   i2cSetSlaveAdd(i2c, addr);
@@ -86,7 +89,11 @@ PORT_I2C_Err_TypeDef PORT_I2C_Send(PORT_I2C_Reg_TypeDef *i2c,
     if (i2cIsMasterReady(i2c) == true) break;
   }
 
-  return (PORT_I2C_Err_TypeDef)i2cRxError(i2c);
+  ret = (PORT_I2C_Err_TypeDef)i2cRxError(i2c);
+
+  PROFILE_END(PROFILE_Scope_I2CSend);
+
+  return ret;
 }
 
 /***************************************************************************//**
@@ -115,6 +122,8 @@ PORT_I2C_Err_TypeDef PORT_I2C_Receive(PORT_I2C_Reg_TypeDef *i2c,
 {
 
   uint32_t i = 0;
+  PORT_I2C_Err_TypeDef ret;
+  PROFILE_BEGIN(PROFILE_Scope_I2CReceive);
 
   /* Configure address of Slave to talk to */
   i2cSetSlaveAdd(i2c, addr);
@@ -161,5 +170,9 @@ PORT_I2C_Err_TypeDef PORT_I2C_Receive(PORT_I2C_Reg_TypeDef *i2c,
     if (i2cIsMasterReady(i2c) == true) break;
   }
 
-  return (PORT_I2C_Err_TypeDef)i2cRxError(i2c);
+  ret = (PORT_I2C_Err_TypeDef)i2cRxError(i2c);
+
+  PROFILE_END(PROFILE_Scope_I2CReceive);
+
+  return ret;
 }
@@ -11,6 +11,40 @@
 
 static char  StringBuf[PRINT_BUFFER_SIZE];
 
+/* Never accessed, only its address identifies PRINT_CAPTURE */
+static uint32_t PRINT_CaptureDummy;
+PORT_UART_Reg_TypeDef * const PRINT_CaptureTarget = (PORT_UART_Reg_TypeDef *)&PRINT_CaptureDummy;
+
+static char *PRINT_CaptureBuf = 0;
+static uint32_t PRINT_CaptureSize = 0U;
+static uint32_t PRINT_CaptureLength = 0U;
+
+/* Two ASCII digits per entry so integers are converted 100 at a time */
+static const char PRINT_DigitPairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char PRINT_HexDigits[17] = "0123456789ABCDEF";
+
+static const uint32_t PRINT_Pow10[PRINT_FORMAT_MAX_PRECISION + 1U] =
+{
+  1U, 10U, 100U, 1000U, 10000U, 100000U,
+  1000000U, 10000000U, 100000000U, 1000000000U
+};
+
+static const char* PRINT_UnitSuffix[] =
+{
+  " mV",
+  " mA",
+  " mW"
+};
+
+static uint32_t PRINT_WriteDigits(char *buf, uint32_t val, uint8_t minDigits);
+static void PRINT_CaptureWrite(const char *data, uint32_t length);
+
 
 /*******************************************************************************
  **************************   GLOBAL FUNCTIONS   *******************************
@@ -37,6 +71,12 @@ PRINT_Err_TypeDef PRINT_Print(PORT_UART_Reg_TypeDef *uart,
                                 uint32_t length,
                                 char *data)
 {
+  if ( uart == PRINT_CAPTURE )
+  {
+    PRINT_CaptureWrite(data,length);
+    return PRINT_Err_NoError;
+  }
+
   return (PRINT_Err_TypeDef)PORT_UART_Send(uart,length,data);
 }
 
@@ -56,6 +96,12 @@ PRINT_Err_TypeDef PRINT_Print(PORT_UART_Reg_TypeDef *uart,
 PRINT_Err_TypeDef PRINT_PrintChar(PORT_UART_Reg_TypeDef *uart,
                                   char data)
 {
+  if ( uart == PRINT_CAPTURE )
+  {
+    PRINT_CaptureWrite(&data,1U);
+    return PRINT_Err_NoError;
+  }
+
   return (PRINT_Err_TypeDef)PORT_UART_SendByte(uart,data);
 }
 
@@ -170,4 +216,362 @@ PRINT_Err_TypeDef PRINT_PrintTimeFromMS(PORT_UART_Reg_TypeDef *uart,
   return PRINT_Print(uart,12,StringBuf);
 }
 
+/***************************************************************************//**
+ * @brief
+ *   Format an unsigned integer in decimal.
+ *
+ * @param[out] buf
+ *   Caller buffer of at least PRINT_FORMAT_MAX_LENGTH bytes. The result is
+ *   null terminated.
+ *
+ * @param[in] val
+ *   Value to format.
+ *
+ * @return
+ *   Returns the number of characters written, excluding the terminator.
+ ******************************************************************************/
+uint32_t PRINT_FormatUInt(char *buf,
+                          uint32_t val)
+{
+  uint32_t len = PRINT_WriteDigits(buf,val,1U);
+
+  buf[len] = '\0';
+
+  return len;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Format a signed integer in decimal.
+ *
+ * @param[out] buf
+ *   Caller buffer of at least PRINT_FORMAT_MAX_LENGTH bytes. The result is
+ *   null terminated.
+ *
+ * @param[in] val
+ *   Value to format.
+ *
+ * @return
+ *   Returns the number of characters written, excluding the terminator.
+ ******************************************************************************/
+uint32_t PRINT_FormatInt(char *buf,
+                         int32_t val)
+{
+  uint32_t len = 0U;
+  uint32_t mag = (uint32_t)val;
+
+  if ( val < 0 )
+  {
+    buf[len++] = '-';
+    mag = 0U - mag;
+  }
+
+  len += PRINT_WriteDigits(&buf[len],mag,1U);
+  buf[len] = '\0';
+
+  return len;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Format an unsigned integer as upper case hexadecimal without a prefix.
+ *
+ * @param[out] buf
+ *   Caller buffer of at least PRINT_FORMAT_MAX_LENGTH bytes. The result is
+ *   null terminated.
+ *
+ * @param[in] val
+ *   Value to format.
+ *
+ * @param[in] digits
+ *   Minimum number of digits (1 to 8), zero padded on the left.
+ *
+ * @return
+ *   Returns the number of characters written, excluding the terminator.
+ ******************************************************************************/
+uint32_t PRINT_FormatHex(char *buf,
+                         uint32_t val,
+                         uint8_t digits)
+{
+  uint32_t len = 1U;
+  uint32_t i;
+
+  while ( len < 8U && (val >> (4U * len)) != 0U )
+  {
+    len++;
+  }
+
+  if ( digits > 8U )
+  {
+    digits = 8U;
+  }
+
+  if ( len < digits )
+  {
+    len = digits;
+  }
+
+  for ( i = len; i > 0U; i-- )
+  {
+    buf[i - 1U] = PRINT_HexDigits[val & 0xFU];
+    val >>= 4U;
+  }
+
+  buf[len] = '\0';
+
+  return len;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Format a fixed point value in decimal.
+ *
+ * @details
+ *   The value represents val / 10^scale. It is rounded half away from zero
+ *   to the requested number of fractional digits, or padded with zeros when
+ *   precision exceeds scale. A minus sign is only printed when the rounded
+ *   result is non-zero.
+ *
+ * @param[out] buf
+ *   Caller buffer of at least PRINT_FORMAT_MAX_LENGTH bytes. The result is
+ *   null terminated.
+ *
+ * @param[in] val
+ *   Scaled value to format.
+ *
+ * @param[in] scale
+ *   Number of implied decimal places in val (0 to 9).
+ *
+ * @param[in] precision
+ *   Number of fractional digits to print (0 to 9).
+ *
+ * @return
+ *   Returns the number of characters written, excluding the terminator.
+ ******************************************************************************/
+uint32_t PRINT_FormatFixed(char *buf,
+                           int32_t val,
+                           uint8_t scale,
+                           uint8_t precision)
+{
+  uint32_t len = 0U;
+  uint32_t mag = (uint32_t)val;
+  uint32_t div;
+  uint32_t pad = 0U;
+  uint8_t  fracDigits;
+
+  if ( scale > PRINT_FORMAT_MAX_PRECISION )
+  {
+    scale = PRINT_FORMAT_MAX_PRECISION;
+  }
+
+  if ( precision > PRINT_FORMAT_MAX_PRECISION )
+  {
+    precision = PRINT_FORMAT_MAX_PRECISION;
+  }
+
+  if ( val < 0 )
+  {
+    mag = 0U - mag;
+  }
+
+  if ( precision < scale )
+  {
+    div = PRINT_Pow10[scale - precision];
+    mag = mag / div + ((((mag % div) * 2U) >= div) ? 1U : 0U);
+    fracDigits = precision;
+  }
+  else
+  {
+    pad = precision - scale;
+    fracDigits = scale;
+  }
+
+  if ( val < 0 && mag != 0U )
+  {
+    buf[len++] = '-';
+  }
+
+  len += PRINT_WriteDigits(&buf[len],mag / PRINT_Pow10[fracDigits],1U);
+
+  if ( precision > 0U )
+  {
+    buf[len++] = '.';
+
+    if ( fracDigits > 0U )
+    {
+      len += PRINT_WriteDigits(&buf[len],
+                               mag % PRINT_Pow10[fracDigits],
+                               fracDigits);
+    }
+
+    while ( pad > 0U )
+    {
+      buf[len++] = '0';
+      pad--;
+    }
+  }
+
+  buf[len] = '\0';
+
+  return len;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Format a measurement in milli units with a unit suffix, e.g. "3300.0 mV".
+ *
+ * @param[out] buf
+ *   Caller buffer of at least PRINT_FORMAT_MAX_LENGTH bytes. The result is
+ *   null terminated.
+ *
+ * @param[in] val
+ *   Measurement in micro units (uV, uA or uW).
+ *
+ * @param[in] unit
+ *   Unit of the measurement.
+ *
+ * @param[in] precision
+ *   Number of fractional milli unit digits to print (0 to 3).
+ *
+ * @return
+ *   Returns the number of characters written, excluding the terminator.
+ ******************************************************************************/
+uint32_t PRINT_FormatEng(char *buf,
+                         int32_t val,
+                         PRINT_Unit_TypeDef unit,
+                         uint8_t precision)
+{
+  uint32_t len;
+  const char *suffix = PRINT_UnitSuffix[unit];
+
+  if ( precision > 3U )
+  {
+    precision = 3U;
+  }
+
+  len = PRINT_FormatFixed(buf,val,3U,precision);
+
+  while ( *suffix != '\0' )
+  {
+    buf[len++] = *suffix++;
+  }
+
+  buf[len] = '\0';
+
+  return len;
+}
 
+/***************************************************************************//**
+ * @brief
+ *   Send the output of PRINT calls given PRINT_CAPTURE to a buffer.
+ *
+ * @details
+ *   Output beyond the buffer is dropped. Captures do not nest; the caller
+ *   keeps other users of PRINT_CAPTURE out until PRINT_CaptureEnd.
+ *
+ * @param[out] buf
+ *   Buffer.
+ *
+ * @param[in] size
+ *   Size of the buffer in bytes.
+ ******************************************************************************/
+void PRINT_CaptureStart(char *buf,
+                        uint32_t size)
+{
+  PRINT_CaptureBuf = buf;
+  PRINT_CaptureSize = size;
+  PRINT_CaptureLength = 0U;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   End a capture. Further output to PRINT_CAPTURE is dropped.
+ *
+ * @return
+ *   Returns the number of bytes printed, more than the buffer size if
+ *   output was dropped.
+ ******************************************************************************/
+uint32_t PRINT_CaptureEnd(void)
+{
+  PRINT_CaptureBuf = 0;
+  PRINT_CaptureSize = 0U;
+
+  return PRINT_CaptureLength;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Append to the capture buffer, counting what does not fit.
+ ******************************************************************************/
+static void PRINT_CaptureWrite(const char *data, uint32_t length)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < length; i++, PRINT_CaptureLength++ )
+  {
+    if ( PRINT_CaptureLength < PRINT_CaptureSize )
+    {
+      PRINT_CaptureBuf[PRINT_CaptureLength] = data[i];
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write the decimal digits of an unsigned integer without a terminator.
+ *
+ * @param[out] buf
+ *   Destination for the digits.
+ *
+ * @param[in] val
+ *   Value to write.
+ *
+ * @param[in] minDigits
+ *   Minimum number of digits (up to 10), zero padded on the left.
+ *
+ * @return
+ *   Returns the number of characters written.
+ ******************************************************************************/
+static uint32_t PRINT_WriteDigits(char *buf, uint32_t val, uint8_t minDigits)
+{
+  char     tmp[10];
+  uint32_t len = 0U;
+  uint32_t pair;
+  uint32_t i;
+
+  /* Digits are produced least significant first, two per division */
+  while ( val >= 100U )
+  {
+    pair = (val % 100U) * 2U;
+    val /= 100U;
+    tmp[len++] = PRINT_DigitPairs[pair + 1U];
+    tmp[len++] = PRINT_DigitPairs[pair];
+  }
+
+  if ( val >= 10U )
+  {
+    pair = val * 2U;
+    tmp[len++] = PRINT_DigitPairs[pair + 1U];
+    tmp[len++] = PRINT_DigitPairs[pair];
+  }
+  else
+  {
+    tmp[len++] = (char)('0' + val);
+  }
+
+  while ( len < minDigits && len < sizeof(tmp) )
+  {
+    tmp[len++] = '0';
+  }
+
+  for ( i = 0U; i < len; i++ )
+  {
+    buf[i] = tmp[len - 1U - i];
+  }
+
+  return len;
+}
@@ -30,6 +30,18 @@
 
 #define PRINT_BUFFER_SIZE     (50U)
 
+/** Minimum size of a caller buffer passed to any PRINT_Format function.
+ *  Covers a sign, ten integer digits, a decimal point, nine fractional
+ *  digits, a unit suffix and the null terminator. */
+#define PRINT_FORMAT_MAX_LENGTH (28U)
+
+/** Largest number of fractional digits accepted by PRINT_FormatFixed. */
+#define PRINT_FORMAT_MAX_PRECISION (9U)
+
+/** Passed in place of a UART, PRINT output goes to the buffer given to
+ *  PRINT_CaptureStart instead. Only PRINT functions may be given it. */
+#define PRINT_CAPTURE (PRINT_CaptureTarget)
+
 /** 
  *  @addtogroup PRINT
  *  @{
@@ -51,10 +63,25 @@ typedef enum
     PRINT_Err_PE      =  PORT_UART_Err_PE  /**< Parity error flag*/
 } PRINT_Err_TypeDef;
 
+/** @enum PRINT_Unit_TypeDef
+*   @brief Engineering units for PRINT_FormatEng. Input values are in micro
+*          units (as returned by the INA226 conversion functions) and are
+*          printed in milli units.
+*/
+
+typedef enum
+{
+    PRINT_Unit_mV = 0,           /**< Millivolts, input in uV*/
+    PRINT_Unit_mA = 1,           /**< Milliamps, input in uA*/
+    PRINT_Unit_mW = 2            /**< Milliwatts, input in uW*/
+} PRINT_Unit_TypeDef;
+
 /*******************************************************************************
  *****************************   PROTOTYPES   **********************************
  ******************************************************************************/
 
+extern PORT_UART_Reg_TypeDef * const PRINT_CaptureTarget;
+
 PRINT_Err_TypeDef PRINT_Print(PORT_UART_Reg_TypeDef *uart,
                                 uint32_t length,
                                 char* data);
@@ -71,6 +98,31 @@ PRINT_Err_TypeDef PRINT_PrintStringln(PORT_UART_Reg_TypeDef *uart,
 PRINT_Err_TypeDef PRINT_PrintTimeFromMS(PORT_UART_Reg_TypeDef *uart,
                           uint32_t currentTime);
 
+uint32_t PRINT_FormatUInt(char *buf,
+                          uint32_t val);
+
+uint32_t PRINT_FormatInt(char *buf,
+                         int32_t val);
+
+uint32_t PRINT_FormatHex(char *buf,
+                         uint32_t val,
+                         uint8_t digits);
+
+uint32_t PRINT_FormatFixed(char *buf,
+                           int32_t val,
+                           uint8_t scale,
+                           uint8_t precision);
+
+uint32_t PRINT_FormatEng(char *buf,
+                         int32_t val,
+                         PRINT_Unit_TypeDef unit,
+                         uint8_t precision);
+
+void PRINT_CaptureStart(char *buf,
+                        uint32_t size);
+
+uint32_t PRINT_CaptureEnd(void);
+
 
 
 
@@ -0,0 +1,416 @@
+/** @file profile.c
+*   @brief Cycle Accurate Profiling Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "profile.h"
+#include "sys_pmu.h"
+#include "histogram.h"
+#include "print.h"
+#include "stdint.h"
+
+/* Fails to compile unless a table has exactly one entry per enum value */
+#define PROFILE_CHECK_SIZE(table, size) \
+  typedef char table##_Size[(sizeof(table) / sizeof((table)[0]) == (size)) ? 1 : -1]
+
+static const char* PROFILE_ScopeNames[] =
+{
+  "I2C_SEND",
+  "I2C_RECEIVE",
+  "COMMAND",
+  "RTI_ISR",
+  "UART_ISR",
+  "SSI_ISR",
+  "TLM_SWEEP",
+  "BAT_STEP",
+  "LOG_APPEND",
+  "CONFIG_LOAD",
+  "CAN_ISR"
+};
+PROFILE_CHECK_SIZE(PROFILE_ScopeNames, PROFILE_NUM_SCOPES);
+
+static const char* PROFILE_HistNames[] =
+{
+  "RTI_LATENCY(0.1US)",
+  "RTI_ISR(CYC)",
+  "UART_ISR(CYC)",
+  "SSI_ISR(CYC)",
+  "SCHED_LATENCY(0.1US)"
+};
+PROFILE_CHECK_SIZE(PROFILE_HistNames, PROFILE_NUM_HISTS);
+
+/* Histogram fed by the duration of each scope, PROFILE_NUM_HISTS for none */
+static const uint8_t PROFILE_ScopeHist[] =
+{
+  PROFILE_NUM_HISTS,              /* I2C_SEND */
+  PROFILE_NUM_HISTS,              /* I2C_RECEIVE */
+  PROFILE_NUM_HISTS,              /* COMMAND */
+  PROFILE_Hist_RtiIsr,            /* RTI_ISR */
+  PROFILE_Hist_UartIsr,           /* UART_ISR */
+  PROFILE_Hist_SsiIsr,            /* SSI_ISR */
+  PROFILE_NUM_HISTS,              /* TLM_SWEEP */
+  PROFILE_NUM_HISTS,              /* BAT_STEP */
+  PROFILE_NUM_HISTS,              /* LOG_APPEND */
+  PROFILE_NUM_HISTS,              /* CONFIG_LOAD */
+  PROFILE_NUM_HISTS               /* CAN_ISR */
+};
+PROFILE_CHECK_SIZE(PROFILE_ScopeHist, PROFILE_NUM_SCOPES);
+
+static PROFILE_Stats_TypeDef PROFILE_Stats[PROFILE_NUM_SCOPES];
+
+static HISTOGRAM_TypeDef PROFILE_Hists[PROFILE_NUM_HISTS];
+
+/* Events attached to PMU counters 0 and 1 */
+static uint32_t PROFILE_Event[2] = { PROFILE_EVENT_NONE, PROFILE_EVENT_NONE };
+static uint8_t  PROFILE_EventsOn = 0U;
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the PMU, start the cycle counter and clear all scopes.
+ ******************************************************************************/
+void PROFILE_Init(void)
+{
+  _pmuInit_();
+  _pmuEnableCountersGlobal_();
+  _pmuResetCounters_();
+  _pmuStartCounters_(pmuCYCLE_COUNTER);
+
+  PROFILE_SetEvents(PROFILE_EVENT_NONE, PROFILE_EVENT_NONE);
+  PROFILE_HistReset();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Attach PMU events to event counters 0 and 1. Statistics are cleared since
+ *   accumulated event totals would otherwise mix different events.
+ *
+ * @param[in] event0
+ *   Event for counter 0 (enum pmuEvent), or PROFILE_EVENT_NONE.
+ *
+ * @param[in] event1
+ *   Event for counter 1 (enum pmuEvent), or PROFILE_EVENT_NONE.
+ ******************************************************************************/
+void PROFILE_SetEvents(uint32_t event0, uint32_t event1)
+{
+  _pmuStopCounters_(pmuCOUNTER0 | pmuCOUNTER1);
+
+  PROFILE_Event[0] = event0;
+  PROFILE_Event[1] = event1;
+  PROFILE_EventsOn = (event0 != PROFILE_EVENT_NONE || event1 != PROFILE_EVENT_NONE);
+
+  if ( PROFILE_EventsOn )
+  {
+    _pmuSetCountEvent_(0U, event0);
+    _pmuSetCountEvent_(1U, event1);
+    _pmuResetEventCounters_();
+    _pmuStartCounters_(pmuCOUNTER0 | pmuCOUNTER1);
+  }
+
+  PROFILE_Reset();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Attach a predefined pair of PMU events.
+ *
+ * @param[in] events
+ *   Event pair to count alongside cycles.
+ ******************************************************************************/
+void PROFILE_SelectEvents(PROFILE_Events_TypeDef events)
+{
+  switch ( events )
+  {
+    case PROFILE_Events_Cache:
+      PROFILE_SetEvents(PMU_INST_CACHE_MISS, PMU_DATA_CACHE_MISS);
+      break;
+    case PROFILE_Events_Branch:
+      PROFILE_SetEvents(PMU_BRANCH_MISSPREDICTED, PMU_PREDICTABLE_BRANCHES);
+      break;
+    default:
+      PROFILE_SetEvents(PROFILE_EVENT_NONE, PROFILE_EVENT_NONE);
+      break;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Capture counters at the start of a scope.
+ *
+ * @param[out] token
+ *   Storage for the captured counters, passed to PROFILE_Stop.
+ ******************************************************************************/
+void PROFILE_Start(PROFILE_Token_TypeDef *token)
+{
+  if ( PROFILE_EventsOn )
+  {
+    token->event[0] = _pmuGetEventCount_(0U);
+    token->event[1] = _pmuGetEventCount_(1U);
+  }
+
+  /* Read cycles last so event reads are not part of the measurement */
+  token->cycles = _pmuGetCycleCount_();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Close a scope and accumulate the measurement.
+ *
+ * @details
+ *   May be called from ISRs and thread code for the same scope, IRQs are
+ *   masked while the statistics are updated.
+ *
+ * @param[in] scope
+ *   Scope to accumulate into.
+ *
+ * @param[in] token
+ *   Counters captured by PROFILE_Start.
+ ******************************************************************************/
+void PROFILE_Stop(PROFILE_Scope_TypeDef scope,
+                  const PROFILE_Token_TypeDef *token)
+{
+  uint32_t cycles = _pmuGetCycleCount_() - token->cycles;
+  uint32_t event0 = 0U;
+  uint32_t event1 = 0U;
+  uint32_t irq;
+  PROFILE_Stats_TypeDef *stats = &PROFILE_Stats[scope];
+
+  if ( PROFILE_EventsOn )
+  {
+    event0 = _pmuGetEventCount_(0U) - token->event[0];
+    event1 = _pmuGetEventCount_(1U) - token->event[1];
+  }
+
+  irq = _disable_IRQ();
+
+  stats->count++;
+  stats->total += cycles;
+  stats->eventTotal[0] += event0;
+  stats->eventTotal[1] += event1;
+
+  if ( cycles < stats->min )
+  {
+    stats->min = cycles;
+  }
+
+  if ( cycles > stats->max )
+  {
+    stats->max = cycles;
+  }
+
+  if ( PROFILE_ScopeHist[scope] < PROFILE_NUM_HISTS )
+  {
+    HISTOGRAM_Add(&PROFILE_Hists[PROFILE_ScopeHist[scope]], cycles);
+  }
+
+  _restore_interrupts(irq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get accumulated measurements of a scope.
+ *
+ * @param[in] scope
+ *   Scope to read.
+ *
+ * @return
+ *   Returns pointer to statistics, or null if scope is out of range.
+ ******************************************************************************/
+const PROFILE_Stats_TypeDef *PROFILE_GetStats(PROFILE_Scope_TypeDef scope)
+{
+  if ( scope >= PROFILE_NUM_SCOPES )
+  {
+    return 0;
+  }
+
+  return &PROFILE_Stats[scope];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the measurements of all scopes.
+ ******************************************************************************/
+void PROFILE_Reset(void)
+{
+  uint32_t i;
+  uint32_t irq = _disable_IRQ();
+
+  for ( i = 0U; i < PROFILE_NUM_SCOPES; i++ )
+  {
+    PROFILE_Stats[i].count = 0U;
+    PROFILE_Stats[i].min = 0xFFFFFFFFU;
+    PROFILE_Stats[i].max = 0U;
+    PROFILE_Stats[i].total = 0U;
+    PROFILE_Stats[i].eventTotal[0] = 0U;
+    PROFILE_Stats[i].eventTotal[1] = 0U;
+  }
+
+  _restore_interrupts(irq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the measurements of every scope that has run, one line per scope.
+ *   Cycle counts are CPU cycles, event counts are means per measurement.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef PROFILE_Print(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  PROFILE_Stats_TypeDef stats;
+  PRINT_Err_TypeDef ret = PRINT_Err_NoError;
+  uint32_t irq;
+  uint32_t i;
+
+  for ( i = 0U; i < PROFILE_NUM_SCOPES && ret == PRINT_Err_NoError; i++ )
+  {
+    /* Copy so the line is consistent if an ISR updates the scope */
+    irq = _disable_IRQ();
+    stats = PROFILE_Stats[i];
+    _restore_interrupts(irq);
+
+    if ( stats.count == 0U )
+    {
+      continue;
+    }
+
+    PRINT_PrintString(uart,(char*)PROFILE_ScopeNames[i]);
+    PRINT_PrintString(uart," N=");
+    PRINT_FormatUInt(buf,stats.count);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MIN=");
+    PRINT_FormatUInt(buf,stats.min);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MAX=");
+    PRINT_FormatUInt(buf,stats.max);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MEAN=");
+    PRINT_FormatUInt(buf,(uint32_t)(stats.total / stats.count));
+    PRINT_PrintString(uart,buf);
+
+    if ( PROFILE_EventsOn )
+    {
+      PRINT_PrintString(uart," EV0=");
+      PRINT_FormatUInt(buf,(uint32_t)(stats.eventTotal[0] / stats.count));
+      PRINT_PrintString(uart,buf);
+      PRINT_PrintString(uart," EV1=");
+      PRINT_FormatUInt(buf,(uint32_t)(stats.eventTotal[1] / stats.count));
+      PRINT_PrintString(uart,buf);
+    }
+
+    ret = PRINT_PrintStringln(uart,"");
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add a sample to a timing histogram.
+ *
+ * @param[in] hist
+ *   Histogram to update.
+ *
+ * @param[in] val
+ *   Sample, in the unit of the histogram.
+ ******************************************************************************/
+void PROFILE_HistAdd(PROFILE_Hist_TypeDef hist, uint32_t val)
+{
+  uint32_t irq = _disable_IRQ();
+
+  HISTOGRAM_Add(&PROFILE_Hists[hist], val);
+
+  _restore_interrupts(irq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear all timing histograms.
+ ******************************************************************************/
+void PROFILE_HistReset(void)
+{
+  uint32_t i;
+  uint32_t irq = _disable_IRQ();
+
+  for ( i = 0U; i < PROFILE_NUM_HISTS; i++ )
+  {
+    HISTOGRAM_Init(&PROFILE_Hists[i]);
+  }
+
+  _restore_interrupts(irq);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Serialize a timing histogram for binary telemetry (see
+ *   HISTOGRAM_Serialize for the layout).
+ *
+ * @param[in] hist
+ *   Histogram to serialize.
+ *
+ * @param[out] buf
+ *   Destination buffer.
+ *
+ * @param[in] size
+ *   Size of destination buffer, HISTOGRAM_SERIALIZED_MAX always suffices.
+ *
+ * @return
+ *   Returns number of bytes written, 0 on error.
+ ******************************************************************************/
+uint32_t PROFILE_HistSerialize(PROFILE_Hist_TypeDef hist,
+                               uint8_t *buf,
+                               uint32_t size)
+{
+  HISTOGRAM_TypeDef copy;
+  uint32_t irq;
+
+  if ( hist >= PROFILE_NUM_HISTS )
+  {
+    return 0U;
+  }
+
+  irq = _disable_IRQ();
+  copy = PROFILE_Hists[hist];
+  _restore_interrupts(irq);
+
+  return HISTOGRAM_Serialize(&copy, buf, size);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print all timing histograms.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef PROFILE_HistPrint(PORT_UART_Reg_TypeDef *uart)
+{
+  static HISTOGRAM_TypeDef copy;
+  PRINT_Err_TypeDef ret = PRINT_Err_NoError;
+  uint32_t irq;
+  uint32_t i;
+
+  for ( i = 0U; i < PROFILE_NUM_HISTS && ret == PRINT_Err_NoError; i++ )
+  {
+    irq = _disable_IRQ();
+    copy = PROFILE_Hists[i];
+    _restore_interrupts(irq);
+
+    ret = HISTOGRAM_Print(uart, PROFILE_HistNames[i], &copy);
+  }
+
+  return ret;
+}
@@ -0,0 +1,167 @@
+/** @file profile.h
+*   @brief Cycle Accurate Profiling Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup PROFILE PROFILE
+ *  @brief Lightweight instrumentation using the Cortex-R4 PMU.
+ *
+ *  Named scopes record count, minimum, maximum and mean CPU cycles in a
+ *  static table. Two PMU event counters can optionally be attached to every
+ *  scope, e.g. cache misses or branch mispredictions. Hooks are placed with
+ *  PROFILE_BEGIN and PROFILE_END, which compile to nothing when
+ *  PROFILE_ENABLE is 0.
+ *
+ *  Log2 histograms of ISR entry latency, ISR duration and scheduler start
+ *  latency are kept alongside the scopes for timing budget analysis.
+ *
+ *	Related Files
+ *   - profile.h
+ *   - profile.c
+ *   - histogram.h
+ *   - sys_pmu.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_PROFILE_H_
+#define DRIVERS_PROFILE_H_
+
+#include "sys_pmu.h"
+#include "histogram.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Set to 0 to compile all profiling hooks out of the build. */
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE        (1)
+#endif
+
+/** Event selection that leaves an event counter unused. */
+#define PROFILE_EVENT_NONE    (0U)
+
+#if PROFILE_ENABLE
+#define PROFILE_BEGIN(scope)  PROFILE_Token_TypeDef profileToken_##scope; \
+                              PROFILE_Start(&profileToken_##scope)
+#define PROFILE_END(scope)    PROFILE_Stop((scope), &profileToken_##scope)
+#define PROFILE_HIST(hist, val) PROFILE_HistAdd((hist), (val))
+#else
+#define PROFILE_BEGIN(scope)
+#define PROFILE_END(scope)
+#define PROFILE_HIST(hist, val)
+#endif
+
+/**
+ *  @addtogroup PROFILE
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum PROFILE_Scope_TypeDef
+*   @brief Instrumented code paths.
+*/
+typedef enum
+{
+  PROFILE_Scope_I2CSend = 0,      /**< PORT_I2C_Send transaction*/
+  PROFILE_Scope_I2CReceive,       /**< PORT_I2C_Receive transaction*/
+  PROFILE_Scope_Command,          /**< Console command dispatch*/
+  PROFILE_Scope_RtiIsr,           /**< RTI compare notification*/
+  PROFILE_Scope_UartIsr,          /**< Console UART notification*/
+  PROFILE_Scope_SsiIsr,           /**< Software interrupt (command parser)*/
+  PROFILE_Scope_TelemetrySweep,   /**< Complete power monitor sweep*/
+  PROFILE_Scope_BatteryStep,      /**< State of charge filter update*/
+  PROFILE_Scope_LogAppend,        /**< Flash log record encode*/
+  PROFILE_Scope_ConfigLoad,       /**< Configuration load at boot*/
+  PROFILE_Scope_CanIsr,           /**< CAN frame read and reassembly*/
+  PROFILE_NUM_SCOPES              /**< Number of scopes (not a scope)*/
+} PROFILE_Scope_TypeDef;
+
+/** @enum PROFILE_Hist_TypeDef
+*   @brief Timing histograms. Latencies are in RTI counter counts
+*          (SCHEDULER_FRC_HZ), durations in CPU cycles.
+*/
+typedef enum
+{
+  PROFILE_Hist_RtiLatency = 0,    /**< RTI compare match to tick handler*/
+  PROFILE_Hist_RtiIsr,            /**< RTI notification duration*/
+  PROFILE_Hist_UartIsr,           /**< UART notification duration*/
+  PROFILE_Hist_SsiIsr,            /**< Software interrupt duration*/
+  PROFILE_Hist_SchedLatency,      /**< Task release to start (jitter)*/
+  PROFILE_NUM_HISTS               /**< Number of histograms (not a histogram)*/
+} PROFILE_Hist_TypeDef;
+
+/** @enum PROFILE_Events_TypeDef
+*   @brief Predefined event counter pairs.
+*/
+typedef enum
+{
+  PROFILE_Events_None   = 0,      /**< Cycles only*/
+  PROFILE_Events_Cache  = 1,      /**< Instruction and data cache misses*/
+  PROFILE_Events_Branch = 2       /**< Mispredicted and predictable branches*/
+} PROFILE_Events_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct PROFILE_Token_TypeDef
+*   @brief Counter values captured at the start of a scope.
+*/
+typedef struct
+{
+  uint32_t cycles;
+  uint32_t event[2];
+} PROFILE_Token_TypeDef;
+
+/** @struct PROFILE_Stats_TypeDef
+*   @brief Accumulated measurements of a scope.
+*/
+typedef struct
+{
+  uint32_t count;           /**< Number of completed measurements*/
+  uint32_t min;             /**< Minimum cycles*/
+  uint32_t max;             /**< Maximum cycles*/
+  uint64_t total;           /**< Sum of cycles, for the mean*/
+  uint64_t eventTotal[2];   /**< Sum of event counts*/
+} PROFILE_Stats_TypeDef;
+
+void PROFILE_Init(void);
+
+void PROFILE_SetEvents(uint32_t event0, uint32_t event1);
+
+void PROFILE_SelectEvents(PROFILE_Events_TypeDef events);
+
+void PROFILE_Start(PROFILE_Token_TypeDef *token);
+
+void PROFILE_Stop(PROFILE_Scope_TypeDef scope,
+                  const PROFILE_Token_TypeDef *token);
+
+const PROFILE_Stats_TypeDef *PROFILE_GetStats(PROFILE_Scope_TypeDef scope);
+
+void PROFILE_Reset(void);
+
+PRINT_Err_TypeDef PROFILE_Print(PORT_UART_Reg_TypeDef *uart);
+
+void PROFILE_HistAdd(PROFILE_Hist_TypeDef hist, uint32_t val);
+
+void PROFILE_HistReset(void);
+
+uint32_t PROFILE_HistSerialize(PROFILE_Hist_TypeDef hist,
+                               uint8_t *buf,
+                               uint32_t size);
+
+PRINT_Err_TypeDef PROFILE_HistPrint(PORT_UART_Reg_TypeDef *uart);
+
+/**@}*/
+
+#endif /* DRIVERS_PROFILE_H_ */
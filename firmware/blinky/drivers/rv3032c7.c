@@ -0,0 +1,808 @@
+/** @file rv3032c7.c
+*   @brief RV3032C7 Real-time Clock Driver Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "rv3032c7.h"
+#include "eps.h"
+#include "tca9548a.h"
+#include "scheduler.h"
+#include "port_i2c.h"
+#include "print.h"
+#include "stdint.h"
+
+/* Longest register write, not counting the register address */
+#define RV3032C7_MAX_WRITE      (16U)
+
+/* Marks a byte that is not valid BCD in the decode table */
+#define RV3032C7_BCD_INVALID    (0xFFU)
+
+/* One row of the decode table, tens digit t valid */
+#define RV3032C7_BCD_ROW(t)     (t), (t) + 1U, (t) + 2U, (t) + 3U, (t) + 4U,  \
+                                (t) + 5U, (t) + 6U, (t) + 7U, (t) + 8U, (t) + 9U, \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID
+
+/* One row of the decode table, tens digit above 9 */
+#define RV3032C7_BCD_NONE       RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID,     \
+                                RV3032C7_BCD_INVALID, RV3032C7_BCD_INVALID
+
+/* us per counter count in Q32 */
+#define RV3032C7_SCALE_NOMINAL  ((uint32_t)((4294967296ULL * 1000000ULL \
+                                             + SCHEDULER_FRC_HZ / 2U) / SCHEDULER_FRC_HZ))
+
+/* Sync period in us */
+#define RV3032C7_SYNC_US        ((int64_t)RV3032C7_SYNC_PERIOD * SCHEDULER_TICK_US)
+
+/* BCD byte to binary, RV3032C7_BCD_INVALID for bad digits */
+static const uint8_t RV3032C7_Bcd[256] =
+{
+  RV3032C7_BCD_ROW(0U),  RV3032C7_BCD_ROW(10U), RV3032C7_BCD_ROW(20U),
+  RV3032C7_BCD_ROW(30U), RV3032C7_BCD_ROW(40U), RV3032C7_BCD_ROW(50U),
+  RV3032C7_BCD_ROW(60U), RV3032C7_BCD_ROW(70U), RV3032C7_BCD_ROW(80U),
+  RV3032C7_BCD_ROW(90U),
+  RV3032C7_BCD_NONE, RV3032C7_BCD_NONE, RV3032C7_BCD_NONE,
+  RV3032C7_BCD_NONE, RV3032C7_BCD_NONE, RV3032C7_BCD_NONE
+};
+
+/* Days before the first of each month of a common year, by month 1 to 12 */
+static const uint16_t RV3032C7_MonthDays[13] =
+{
+  0U, 0U, 31U, 59U, 90U, 120U, 151U, 181U, 212U, 243U, 273U, 304U, 334U
+};
+
+static PORT_I2C_Reg_TypeDef *RV3032C7_I2c;
+static RV3032C7_Address_TypeDef RV3032C7_Addr;
+static uint8_t RV3032C7_MuxChan;
+
+static RV3032C7_Clock_TypeDef RV3032C7_Clock;
+
+/* Counter at the last sync, extends the drift baseline past the wrap */
+static uint32_t RV3032C7_LastCount;
+
+/* Drift baseline: counts and RTC time since its start */
+static uint64_t RV3032C7_BaseCounts;
+static uint64_t RV3032C7_BaseTime;
+
+static RV3032C7_Err_TypeDef RV3032C7_Select(void);
+static void RV3032C7_SetScale(void);
+static uint8_t RV3032C7_ToBcd(uint8_t val);
+static uint32_t RV3032C7_FormatDigits(char *buf, uint32_t val, uint32_t digits);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Read consecutive registers in one transfer.
+ *
+ * @param[in] i2c
+ *   I2C port.
+ *
+ * @param[in] addr
+ *   RV3032C7 address.
+ *
+ * @param[in] reg
+ *   First register to read.
+ *
+ * @param[in] length
+ *   Number of registers.
+ *
+ * @param[out] data
+ *   Register contents.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_RegisterGet(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    RV3032C7_Register_TypeDef reg,
+                                    uint32_t length,
+                                    uint8_t *data)
+{
+  uint8_t regid[1];
+  RV3032C7_Err_TypeDef ret;
+
+  regid[0] = (uint8_t)reg;
+
+  ret = (RV3032C7_Err_TypeDef)PORT_I2C_Send(i2c, addr, 1, regid);
+
+  if (ret != RV3032C7_Err_NoError)
+  {
+    return ret;
+  }
+
+  return (RV3032C7_Err_TypeDef)PORT_I2C_Receive(i2c, addr, length, data);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write consecutive registers in one transfer.
+ *
+ * @param[in] i2c
+ *   I2C port.
+ *
+ * @param[in] addr
+ *   RV3032C7 address.
+ *
+ * @param[in] reg
+ *   First register to write.
+ *
+ * @param[in] length
+ *   Number of registers, at most RV3032C7_MAX_WRITE.
+ *
+ * @param[in] data
+ *   Register contents.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_RegisterSet(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    RV3032C7_Register_TypeDef reg,
+                                    uint32_t length,
+                                    const uint8_t *data)
+{
+  uint8_t buf[RV3032C7_MAX_WRITE + 1U];
+  uint32_t i;
+
+  if ( length > RV3032C7_MAX_WRITE )
+  {
+    return RV3032C7_Err_Invalid;
+  }
+
+  buf[0] = (uint8_t)reg;
+  for ( i = 0U; i < length; i++ )
+  {
+    buf[i + 1U] = data[i];
+  }
+
+  return (RV3032C7_Err_TypeDef)PORT_I2C_Send(i2c, addr, length + 1U, buf);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read the time registers from hundredths to year in one burst.
+ *
+ * @details
+ *   The chip holds the time registers for the length of the read, so all
+ *   fields belong to the same instant. That instant is the start of the
+ *   read, the RTI counter is taken right before it.
+ *
+ * @param[in] i2c
+ *   I2C port.
+ *
+ * @param[in] addr
+ *   RV3032C7 address.
+ *
+ * @param[out] time
+ *   Decoded time.
+ *
+ * @param[out] counter
+ *   RTI counter at the read, may be null.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_ReadTime(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    RV3032C7_DateTime_TypeDef *time,
+                                    uint32_t *counter)
+{
+  uint8_t regid[1];
+  uint8_t data[RV3032C7_TIME_LENGTH];
+  RV3032C7_Err_TypeDef ret;
+
+  regid[0] = (uint8_t)RV3032C7_Reg100thSec;
+
+  ret = (RV3032C7_Err_TypeDef)PORT_I2C_Send(i2c, addr, 1, regid);
+
+  if (ret != RV3032C7_Err_NoError)
+  {
+    return ret;
+  }
+
+  if ( counter != 0 )
+  {
+    *counter = SCHEDULER_GetCounter();
+  }
+
+  ret = (RV3032C7_Err_TypeDef)PORT_I2C_Receive(i2c, addr, RV3032C7_TIME_LENGTH, data);
+
+  if (ret != RV3032C7_Err_NoError)
+  {
+    return ret;
+  }
+
+  return RV3032C7_Decode(data, time);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write the time registers from seconds to year in one burst.
+ *
+ * @details
+ *   Writing the seconds clears the hundredths and the prescaler, the new
+ *   second starts at the end of the write.
+ *
+ * @param[in] i2c
+ *   I2C port.
+ *
+ * @param[in] addr
+ *   RV3032C7 address.
+ *
+ * @param[in] time
+ *   Time to set, hundredths are ignored.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_WriteTime(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    const RV3032C7_DateTime_TypeDef *time)
+{
+  uint8_t data[RV3032C7_TIME_LENGTH - 1U];
+
+  if ( time->second > 59U || time->minute > 59U || time->hour > 23U
+       || time->weekday > 6U || time->date < 1U || time->date > 31U
+       || time->month < 1U || time->month > 12U || time->year > 99U )
+  {
+    return RV3032C7_Err_Invalid;
+  }
+
+  data[0] = RV3032C7_ToBcd(time->second);
+  data[1] = RV3032C7_ToBcd(time->minute);
+  data[2] = RV3032C7_ToBcd(time->hour);
+  data[3] = time->weekday;
+  data[4] = RV3032C7_ToBcd(time->date);
+  data[5] = RV3032C7_ToBcd(time->month);
+  data[6] = RV3032C7_ToBcd(time->year);
+
+  return RV3032C7_RegisterSet(i2c, addr, RV3032C7_RegSec, sizeof(data), data);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode the time registers.
+ *
+ * @details
+ *   One table lookup per field, unused bits are masked first.
+ *
+ * @param[in] regs
+ *   RV3032C7_TIME_LENGTH registers from hundredths to year.
+ *
+ * @param[out] time
+ *   Decoded time.
+ *
+ * @return
+ *   Returns 0 if every field is valid BCD and in range.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_Decode(const uint8_t *regs,
+                                    RV3032C7_DateTime_TypeDef *time)
+{
+  time->hundredths = RV3032C7_Bcd[regs[0]];
+  time->second     = RV3032C7_Bcd[regs[1] & (_RV3032C7_SEC_DIG1_MASK | _RV3032C7_SEC_DIG0_MASK)];
+  time->minute     = RV3032C7_Bcd[regs[2] & (_RV3032C7_MIN_DIG1_MASK | _RV3032C7_MIN_DIG0_MASK)];
+  time->hour       = RV3032C7_Bcd[regs[3] & (_RV3032C7_HOUR_DIG1_MASK | _RV3032C7_HOUR_DIG0_MASK)];
+  time->weekday    = regs[4] & _RV3032C7_WEEKDAY_MASK;
+  time->date       = RV3032C7_Bcd[regs[5] & (_RV3032C7_DATE_DIG1_MASK | _RV3032C7_DATE_DIG0_MASK)];
+  time->month      = RV3032C7_Bcd[regs[6] & (_RV3032C7_MONTH_DIG1_MASK | _RV3032C7_MONTH_DIG0_MASK)];
+  time->year       = RV3032C7_Bcd[regs[7]];
+
+  /* Invalid digits decode to 0xFF and fail the range checks */
+  if ( time->hundredths > 99U || time->second > 59U || time->minute > 59U
+       || time->hour > 23U || time->weekday > 6U || time->date < 1U
+       || time->date > 31U || time->month < 1U || time->month > 12U
+       || time->year > 99U )
+  {
+    return RV3032C7_Err_Invalid;
+  }
+
+  return RV3032C7_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert a date and time to seconds since 2000-01-01 00:00:00.
+ *
+ * @param[in] time
+ *   Valid date and time, hundredths are ignored.
+ *
+ * @return
+ *   Returns seconds.
+ ******************************************************************************/
+uint32_t RV3032C7_ToSeconds(const RV3032C7_DateTime_TypeDef *time)
+{
+  uint32_t year = time->year;
+  uint32_t days;
+
+  /* Every fourth year from 2000 is a leap year up to 2099 */
+  days = year * 365U + (year + 3U) / 4U
+         + RV3032C7_MonthDays[time->month] + time->date - 1U;
+
+  if ( time->month > 2U && (year & 3U) == 0U )
+  {
+    days++;
+  }
+
+  return ((days * 24U + time->hour) * 60U + time->minute) * 60U + time->second;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert seconds since 2000-01-01 00:00:00 to a date and time.
+ *
+ * @param[in] seconds
+ *   Seconds, up to the end of 2099.
+ *
+ * @param[out] time
+ *   Date and time, hundredths cleared.
+ ******************************************************************************/
+void RV3032C7_FromSeconds(uint32_t seconds, RV3032C7_DateTime_TypeDef *time)
+{
+  uint32_t days = seconds / 86400U;
+  uint32_t rem = seconds % 86400U;
+  uint32_t year = 0U;
+  uint32_t month = 12U;
+  uint32_t length;
+  uint32_t leap;
+
+  time->hundredths = 0U;
+  time->hour = (uint8_t)(rem / 3600U);
+  time->minute = (uint8_t)((rem / 60U) % 60U);
+  time->second = (uint8_t)(rem % 60U);
+
+  /* 2000-01-01 was a Saturday */
+  time->weekday = (uint8_t)((days + 6U) % 7U);
+
+  for ( ;; )
+  {
+    length = ((year & 3U) == 0U) ? 366U : 365U;
+    if ( days < length )
+    {
+      break;
+    }
+    days -= length;
+    year++;
+  }
+
+  leap = ((year & 3U) == 0U) ? 1U : 0U;
+  while ( month > 1U
+          && days < RV3032C7_MonthDays[month] + ((month > 2U) ? leap : 0U) )
+  {
+    month--;
+  }
+  days -= RV3032C7_MonthDays[month] + ((month > 2U) ? leap : 0U);
+
+  time->year = (uint8_t)year;
+  time->month = (uint8_t)month;
+  time->date = (uint8_t)(days + 1U);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start the clock service and take the first sync.
+ *
+ * @details
+ *   Until the first good sync, times count from 2000-01-01 at the call.
+ *   Must be called after i2cInit, TELEMETRY_Init (releases the mux) and
+ *   with the RTI counter running.
+ *
+ * @param[in] i2c
+ *   I2C port.
+ *
+ * @param[in] addr
+ *   RV3032C7 address.
+ *
+ * @param[in] muxChan
+ *   Mux channel bit of the RV3032C7.
+ *
+ * @return
+ *   Returns 0 if the RTC was read and holds a valid time,
+ *   RV3032C7_Err_NotSet if it lost time since it was last set.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_Init(PORT_I2C_Reg_TypeDef *i2c,
+                                   RV3032C7_Address_TypeDef addr,
+                                   uint8_t muxChan)
+{
+  RV3032C7_Clock_TypeDef *c = &RV3032C7_Clock;
+  RV3032C7_Err_TypeDef ret;
+  uint8_t status = 0U;
+
+  RV3032C7_I2c = i2c;
+  RV3032C7_Addr = addr;
+  RV3032C7_MuxChan = muxChan;
+
+  c->synced = 0U;
+  c->timeLost = 0U;
+  c->anchorCount = SCHEDULER_GetCounter();
+  c->anchorTime = 0U;
+  c->drift = 0;
+  c->slew = 0;
+  c->offset = 0;
+  c->syncs = 0U;
+  c->steps = 0U;
+  c->driftUpdates = 0U;
+  c->errors = 0U;
+  c->lastError = RV3032C7_Err_NoError;
+  RV3032C7_SetScale();
+
+  RV3032C7_LastCount = c->anchorCount;
+  RV3032C7_BaseCounts = 0U;
+  RV3032C7_BaseTime = 0U;
+
+  ret = RV3032C7_Select();
+  if ( ret == RV3032C7_Err_NoError )
+  {
+    ret = RV3032C7_RegisterGet(i2c, addr, RV3032C7_RegStatus, 1U, &status);
+  }
+
+  if ( ret == RV3032C7_Err_NoError
+       && (status & (RV3032C7_STATUS_PORF | RV3032C7_STATUS_VLF)) != 0U )
+  {
+    c->timeLost = 1U;
+  }
+
+  ret = RV3032C7_Sync();
+
+  if ( ret == RV3032C7_Err_NoError && c->timeLost )
+  {
+    return RV3032C7_Err_NotSet;
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read the RTC and correct the counter correlation. Call every
+ *   RV3032C7_SYNC_PERIOD.
+ *
+ * @details
+ *   The anchor moves to the current counter on the current rate, so times
+ *   stay continuous. The offset to the RTC then sets the slew for the next
+ *   periods, offsets beyond RV3032C7_STEP_US are stepped. The drift is
+ *   measured against the RTC over a baseline of at least
+ *   RV3032C7_DRIFT_WINDOW seconds and filtered, the 10 ms resolution of
+ *   the RTC is then below 12 ppm per measurement.
+ *
+ * @return
+ *   Returns 0 if the RTC was read.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_Sync(void)
+{
+  RV3032C7_Clock_TypeDef *c = &RV3032C7_Clock;
+  RV3032C7_DateTime_TypeDef dt;
+  RV3032C7_Err_TypeDef ret;
+  uint32_t counter = 0U;
+  uint64_t rtc;
+  uint64_t elapsed;
+  int64_t offset;
+  int32_t measured;
+
+  ret = RV3032C7_Select();
+  if ( ret == RV3032C7_Err_NoError )
+  {
+    ret = RV3032C7_ReadTime(RV3032C7_I2c, RV3032C7_Addr, &dt, &counter);
+  }
+
+  if ( ret != RV3032C7_Err_NoError )
+  {
+    counter = SCHEDULER_GetCounter();
+  }
+
+  /* Move the anchor in any case, holdover keeps it within the wrap */
+  RV3032C7_BaseCounts += counter - RV3032C7_LastCount;
+  RV3032C7_LastCount = counter;
+  c->anchorTime = RV3032C7_GetTime(counter);
+  c->anchorCount = counter;
+  c->lastError = ret;
+
+  if ( ret != RV3032C7_Err_NoError )
+  {
+    c->errors++;
+    return ret;
+  }
+
+  /* Half a hundredth centres the truncation of the RTC reading */
+  rtc = (uint64_t)RV3032C7_ToSeconds(&dt) * 1000000U
+        + (uint64_t)dt.hundredths * 10000U + 5000U;
+
+  offset = (int64_t)(rtc - c->anchorTime);
+  c->syncs++;
+
+  if ( !c->synced || offset > RV3032C7_STEP_US || offset < -RV3032C7_STEP_US )
+  {
+    c->anchorTime = rtc;
+    c->offset = (int32_t)((offset > INT32_MAX) ? INT32_MAX
+                          : (offset < INT32_MIN) ? INT32_MIN : offset);
+    c->slew = 0;
+    c->steps++;
+    c->synced = 1U;
+    RV3032C7_BaseCounts = 0U;
+    RV3032C7_BaseTime = rtc;
+    RV3032C7_SetScale();
+    return ret;
+  }
+
+  c->offset = (int32_t)offset;
+
+  if ( RV3032C7_BaseCounts >= (uint64_t)RV3032C7_DRIFT_WINDOW * SCHEDULER_FRC_HZ )
+  {
+    elapsed = RV3032C7_BaseCounts * 1000000U / SCHEDULER_FRC_HZ;
+    measured = (int32_t)(((int64_t)(rtc - RV3032C7_BaseTime) - (int64_t)elapsed)
+                         * 1000000000 / (int64_t)elapsed);
+
+    c->drift = (c->driftUpdates == 0U) ? measured
+                                       : c->drift + (measured - c->drift) / 4;
+    c->driftUpdates++;
+
+    RV3032C7_BaseCounts = 0U;
+    RV3032C7_BaseTime = rtc;
+  }
+
+  c->slew = (int32_t)(offset * 1000000000 / (RV3032C7_SYNC_US * RV3032C7_SLEW_PERIODS));
+  RV3032C7_SetScale();
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the RTC and step the clock to it.
+ *
+ * @param[in] time
+ *   Time to set, hundredths are ignored.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+RV3032C7_Err_TypeDef RV3032C7_SetTime(const RV3032C7_DateTime_TypeDef *time)
+{
+  RV3032C7_Err_TypeDef ret;
+  uint8_t status = 0U;
+
+  ret = RV3032C7_Select();
+  if ( ret == RV3032C7_Err_NoError )
+  {
+    ret = RV3032C7_WriteTime(RV3032C7_I2c, RV3032C7_Addr, time);
+  }
+
+  /* Clear the power on and low voltage flags, the time is good again */
+  if ( ret == RV3032C7_Err_NoError )
+  {
+    ret = RV3032C7_RegisterSet(RV3032C7_I2c, RV3032C7_Addr, RV3032C7_RegStatus, 1U, &status);
+  }
+
+  if ( ret != RV3032C7_Err_NoError )
+  {
+    return ret;
+  }
+
+  RV3032C7_Clock.timeLost = 0U;
+  RV3032C7_Clock.synced = 0U;
+
+  return RV3032C7_Sync();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert an RTI counter reading to time.
+ *
+ * @details
+ *   One multiply from the anchor, valid for readings within 214 s of the
+ *   last sync on either side.
+ *
+ * @param[in] counter
+ *   RTI counter value (SCHEDULER_GetCounter).
+ *
+ * @return
+ *   Returns time in us since 2000-01-01 00:00:00.
+ ******************************************************************************/
+uint64_t RV3032C7_GetTime(uint32_t counter)
+{
+  const RV3032C7_Clock_TypeDef *c = &RV3032C7_Clock;
+  int32_t diff = (int32_t)(counter - c->anchorCount);
+
+  if ( diff >= 0 )
+  {
+    return c->anchorTime + (((uint64_t)(uint32_t)diff * c->scale) >> 32);
+  }
+
+  return c->anchorTime - (((uint64_t)(uint32_t)(-diff) * c->scale) >> 32);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the current time.
+ *
+ * @return
+ *   Returns time in us since 2000-01-01 00:00:00.
+ ******************************************************************************/
+uint64_t RV3032C7_Now(void)
+{
+  return RV3032C7_GetTime(SCHEDULER_GetCounter());
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the correlation state and statistics.
+ *
+ * @return
+ *   Returns pointer to the clock state.
+ ******************************************************************************/
+const RV3032C7_Clock_TypeDef *RV3032C7_GetClock(void)
+{
+  return &RV3032C7_Clock;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print a time as YYYY-MM-DDTHH:MM:SS.mmm.
+ *
+ * @param[in] uart
+ *   Port to print to.
+ *
+ * @param[in] time
+ *   Time in us since 2000-01-01 00:00:00.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef RV3032C7_PrintTime(PORT_UART_Reg_TypeDef *uart, uint64_t time)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  RV3032C7_DateTime_TypeDef dt;
+  char *p = buf;
+
+  RV3032C7_FromSeconds((uint32_t)(time / 1000000U), &dt);
+
+  p += RV3032C7_FormatDigits(p, 2000U + dt.year, 4U);
+  *p++ = '-';
+  p += RV3032C7_FormatDigits(p, dt.month, 2U);
+  *p++ = '-';
+  p += RV3032C7_FormatDigits(p, dt.date, 2U);
+  *p++ = 'T';
+  p += RV3032C7_FormatDigits(p, dt.hour, 2U);
+  *p++ = ':';
+  p += RV3032C7_FormatDigits(p, dt.minute, 2U);
+  *p++ = ':';
+  p += RV3032C7_FormatDigits(p, dt.second, 2U);
+  *p++ = '.';
+  p += RV3032C7_FormatDigits(p, (uint32_t)((time / 1000U) % 1000U), 3U);
+  *p = '\0';
+
+  return PRINT_PrintString(uart, buf);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print the current time and the correlation state.
+ *
+ * @param[in] uart
+ *   Port to print to.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef RV3032C7_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  const RV3032C7_Clock_TypeDef *c = &RV3032C7_Clock;
+
+  RV3032C7_PrintTime(uart, RV3032C7_Now());
+  if ( !c->synced )
+  {
+    PRINT_PrintString(uart," NO SYNC");
+  }
+  if ( c->timeLost )
+  {
+    PRINT_PrintString(uart," NOT SET");
+  }
+
+  PRINT_PrintString(uart," DRIFT=");
+  PRINT_FormatFixed(buf,c->drift,3U,3U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ppm SLEW=");
+  PRINT_FormatFixed(buf,c->slew,3U,3U);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ppm OFFSET=");
+  PRINT_FormatInt(buf,c->offset);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," us SYNCS=");
+  PRINT_FormatUInt(buf,c->syncs);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," STEPS=");
+  PRINT_FormatUInt(buf,c->steps);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," DRIFTS=");
+  PRINT_FormatUInt(buf,c->driftUpdates);
+  PRINT_PrintString(uart,buf);
+  PRINT_PrintString(uart," ERRORS=");
+  PRINT_FormatUInt(buf,c->errors);
+
+  return PRINT_PrintStringln(uart,buf);
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Route the I2C bus to the RV3032C7.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+static RV3032C7_Err_TypeDef RV3032C7_Select(void)
+{
+  if ( TCA9548A_RegisterSet(RV3032C7_I2c, EPS_MUX1_I2CADDR, RV3032C7_MuxChan)
+       != TCA9548A_Err_NoError )
+  {
+    return RV3032C7_Err_Mux;
+  }
+
+  return RV3032C7_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Apply drift and slew to the counter scale, within RV3032C7_MAX_PPB.
+ ******************************************************************************/
+static void RV3032C7_SetScale(void)
+{
+  RV3032C7_Clock_TypeDef *c = &RV3032C7_Clock;
+  int64_t ppb = (int64_t)c->drift + c->slew;
+
+  if ( ppb > RV3032C7_MAX_PPB )
+  {
+    ppb = RV3032C7_MAX_PPB;
+  }
+  else if ( ppb < -RV3032C7_MAX_PPB )
+  {
+    ppb = -RV3032C7_MAX_PPB;
+  }
+
+  c->scale = (uint32_t)((int64_t)RV3032C7_SCALE_NOMINAL
+                        + (int64_t)RV3032C7_SCALE_NOMINAL * ppb / 1000000000);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Encode 0 to 99 as BCD.
+ ******************************************************************************/
+static uint8_t RV3032C7_ToBcd(uint8_t val)
+{
+  return (uint8_t)(((val / 10U) << 4) | (val % 10U));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Format an unsigned integer with a fixed number of digits, zero padded.
+ *
+ * @return
+ *   Returns the number of characters written, no terminator.
+ ******************************************************************************/
+static uint32_t RV3032C7_FormatDigits(char *buf, uint32_t val, uint32_t digits)
+{
+  uint32_t i;
+
+  for ( i = digits; i > 0U; i-- )
+  {
+    buf[i - 1U] = (char)('0' + val % 10U);
+    val /= 10U;
+  }
+
+  return digits;
+}
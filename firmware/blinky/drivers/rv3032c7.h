@@ -10,17 +10,44 @@
  *  @brief RV3032C7 Real-time Clock Chip Module.
  *  The RV3032C7 is a low-power real-time clock (RTC) chip with an I2C
  *  interface. It provides accurate timekeeping and calendar functions.
+ *
+ *  The time registers from hundredths to year are read in one burst, the
+ *  chip freezes them for the length of the transfer so the fields are
+ *  consistent, and decoded from BCD by table.
+ *
+ *  The clock service correlates the RTC with the RTI free running counter
+ *  so that a timestamp is one multiply away from a counter reading, no
+ *  per-sample I2C access. RV3032C7_Sync reads the RTC once per
+ *  RV3032C7_SYNC_PERIOD and moves the anchor of the conversion to the
+ *  current counter:
+ *   - The rate of the counter against the RTC (drift, which includes any
+ *     error of the idle sleep compensation) is measured over at least
+ *     RV3032C7_DRIFT_WINDOW seconds and filtered.
+ *   - The remaining offset is slewed out over the next sync periods by a
+ *     bounded rate adjustment, timestamps never step back.
+ *   - Offsets beyond RV3032C7_STEP_US (RTC set, first sync) are stepped.
+ *  If the RTC cannot be read the anchor still moves on the last rate
+ *  (holdover), which keeps the counter difference within its wrap.
+ *
+ *  Time is in microseconds since 2000-01-01 00:00:00, the first year the
+ *  RTC can hold. The RTC keeps 10 ms resolution, the timestamps between
+ *  syncs have the resolution of the counter.
+ *
  *  Related Files
- *  RV3032C7.h
- *  RV3032C7.c
- *  port_i2c.h
- *  stdint.h
+ *   - rv3032c7.h
+ *   - rv3032c7.c
+ *   - port_i2c.h
+ *   - scheduler.h
+ *   - print.h
+ *   - stdint.h
  */
 
 #ifndef DRIVERS_RV3032C7_H_
 #define DRIVERS_RV3032C7_H_
 
 #include "port_i2c.h"
+#include "scheduler.h"
+#include "print.h"
 #include "stdint.h"
 
 /*******************************************************************************
@@ -98,6 +125,33 @@
 #define _RV3032C7_ALARM_HOUR_DIG1_SHIFT 4
 #define _RV3032C7_ALARM_HOUR_DIG1_MASK  0x30UL
 #define RV3032C7_ALARM_HOUR_EN          (0x1UL << 7)
+#define _RV3032C7_ALARM_HOUR_EN_SHIFT   7
+#define _RV3032C7_ALARM_HOUR_EN_MASK    0x80UL
+#define RV3032C7_STATUS_VLF             (0x1UL << 0)
+#define _RV3032C7_STATUS_VLF_SHIFT      0
+#define _RV3032C7_STATUS_VLF_MASK       0x1UL
+#define RV3032C7_STATUS_PORF            (0x1UL << 1)
+#define _RV3032C7_STATUS_PORF_SHIFT     1
+#define _RV3032C7_STATUS_PORF_MASK      0x2UL
+
+/* Registers of the time burst, hundredths to year */
+#define RV3032C7_TIME_LENGTH            (8U)
+
+/* Interval between RTC reads of the clock service, in ticks. Must stay
+   well below half the counter wrap (2^31 / SCHEDULER_FRC_HZ, 214 s) */
+#define RV3032C7_SYNC_PERIOD            (SCHEDULER_MS(60000))
+
+/* Offsets beyond this are stepped instead of slewed, in us */
+#define RV3032C7_STEP_US                (1000000)
+
+/* Shortest interval a drift measurement is taken over, in s */
+#define RV3032C7_DRIFT_WINDOW           (900U)
+
+/* Sync periods an offset is slewed out over */
+#define RV3032C7_SLEW_PERIODS           (2U)
+
+/* Largest rate correction, drift plus slew, in ppb */
+#define RV3032C7_MAX_PPB                (500000)
 
 
 
@@ -181,7 +235,121 @@ typedef enum
     RV3032C7_RegUserEEPROMEnd = 0xEA    /**< User EEPROM end register */
 } RV3032C7_Register_TypeDef;
 
+/**
+ *  @addtogroup RV3032C7
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum RV3032C7_Address_TypeDef
+*   @brief Alias names for RV3032C7 I2C addresses.
+*/
+typedef enum
+{
+  RV3032C7_Addr51 = RV3032C7_ADDR   /**< Fixed address*/
+} RV3032C7_Address_TypeDef;
+
+/** @enum RV3032C7_Err_TypeDef
+*   @brief Alias names for RV3032C7 errors.
+*/
+typedef enum
+{
+  RV3032C7_Err_NoError = 0U,                /**< No error*/
+  RV3032C7_Err_AL      = PORT_I2C_Err_AL,   /**< Arbitration lost*/
+  RV3032C7_Err_NACK    = PORT_I2C_Err_NACK, /**< No acknowledgment*/
+  RV3032C7_Err_Invalid = 4U,                /**< Time registers hold no valid date*/
+  RV3032C7_Err_NotSet  = 5U,                /**< Time lost since the last set (PORF or VLF)*/
+  RV3032C7_Err_Mux     = 6U                 /**< Mux channel select failed*/
+} RV3032C7_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct RV3032C7_DateTime_TypeDef
+*   @brief Decoded time registers.
+*/
+typedef struct
+{
+  uint8_t hundredths;               /**< 0 to 99*/
+  uint8_t second;                   /**< 0 to 59*/
+  uint8_t minute;                   /**< 0 to 59*/
+  uint8_t hour;                     /**< 0 to 23*/
+  uint8_t weekday;                  /**< 0 (Sunday) to 6*/
+  uint8_t date;                     /**< 1 to 31*/
+  uint8_t month;                    /**< 1 to 12*/
+  uint8_t year;                     /**< 0 to 99, from 2000*/
+} RV3032C7_DateTime_TypeDef;
+
+/** @struct RV3032C7_Clock_TypeDef
+*   @brief Correlation of the RTI counter with the RTC, and statistics.
+*/
+typedef struct
+{
+  uint8_t synced;                   /**< Set after the first good RTC read*/
+  uint8_t timeLost;                 /**< RTC lost time since it was last set*/
+  uint32_t anchorCount;             /**< Counter value at the anchor*/
+  uint64_t anchorTime;              /**< Time at the anchor in us*/
+  uint32_t scale;                   /**< us per count, Q32, drift and slew applied*/
+  int32_t drift;                    /**< Counter rate error against the RTC in ppb*/
+  int32_t slew;                     /**< Rate adjustment removing the offset in ppb*/
+  int32_t offset;                   /**< RTC minus counter time at the last sync in us*/
+  uint32_t syncs;                   /**< Good RTC reads*/
+  uint32_t steps;                   /**< Offsets stepped*/
+  uint32_t driftUpdates;            /**< Drift measurements*/
+  uint32_t errors;                  /**< Failed RTC reads*/
+  RV3032C7_Err_TypeDef lastError;   /**< Result of the last sync*/
+} RV3032C7_Clock_TypeDef;
+
+RV3032C7_Err_TypeDef RV3032C7_RegisterGet(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    RV3032C7_Register_TypeDef reg,
+                                    uint32_t length,
+                                    uint8_t *data);
+
+RV3032C7_Err_TypeDef RV3032C7_RegisterSet(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    RV3032C7_Register_TypeDef reg,
+                                    uint32_t length,
+                                    const uint8_t *data);
+
+RV3032C7_Err_TypeDef RV3032C7_ReadTime(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    RV3032C7_DateTime_TypeDef *time,
+                                    uint32_t *counter);
+
+RV3032C7_Err_TypeDef RV3032C7_WriteTime(PORT_I2C_Reg_TypeDef *i2c,
+                                    RV3032C7_Address_TypeDef addr,
+                                    const RV3032C7_DateTime_TypeDef *time);
+
+RV3032C7_Err_TypeDef RV3032C7_Decode(const uint8_t *regs,
+                                    RV3032C7_DateTime_TypeDef *time);
+
+uint32_t RV3032C7_ToSeconds(const RV3032C7_DateTime_TypeDef *time);
+
+void RV3032C7_FromSeconds(uint32_t seconds, RV3032C7_DateTime_TypeDef *time);
+
+RV3032C7_Err_TypeDef RV3032C7_Init(PORT_I2C_Reg_TypeDef *i2c,
+                                   RV3032C7_Address_TypeDef addr,
+                                   uint8_t muxChan);
+
+RV3032C7_Err_TypeDef RV3032C7_Sync(void);
+
+RV3032C7_Err_TypeDef RV3032C7_SetTime(const RV3032C7_DateTime_TypeDef *time);
+
+uint64_t RV3032C7_GetTime(uint32_t counter);
+
+uint64_t RV3032C7_Now(void);
+
+const RV3032C7_Clock_TypeDef *RV3032C7_GetClock(void);
 
+PRINT_Err_TypeDef RV3032C7_PrintTime(PORT_UART_Reg_TypeDef *uart, uint64_t time);
 
+PRINT_Err_TypeDef RV3032C7_PrintStats(PORT_UART_Reg_TypeDef *uart);
 
+/**@}*/
 
+#endif /* DRIVERS_RV3032C7_H_ */
@@ -0,0 +1,637 @@
+/** @file scheduler.c
+*   @brief Cooperative Time-Triggered Scheduler Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "scheduler.h"
+#include "sys_core.h"
+#include "rti.h"
+#include "print.h"
+#include "profile.h"
+#include "stdint.h"
+
+/** @struct SCHEDULER_State_TypeDef
+*   @brief Run time state of a task.
+*/
+typedef struct
+{
+  uint32_t countdown;   /**< Ticks until next release, 0 for none*/
+  uint32_t release;     /**< RTI counter value of the pending release*/
+  SCHEDULER_Stats_TypeDef stats;
+} SCHEDULER_State_TypeDef;
+
+static const SCHEDULER_Task_TypeDef *SCHEDULER_Tasks = 0;
+static uint32_t SCHEDULER_NumTasks = 0U;
+
+static SCHEDULER_State_TypeDef SCHEDULER_State[SCHEDULER_MAX_TASKS];
+
+/* Task indices sorted by priority, highest first */
+static uint8_t SCHEDULER_Order[SCHEDULER_MAX_TASKS];
+
+/* One bit per task. Pending is set by the tick and cleared by the dispatcher,
+ * running is only touched by the dispatcher. */
+static volatile uint32_t SCHEDULER_Pending = 0U;
+static volatile uint32_t SCHEDULER_Running = 0U;
+
+static volatile uint32_t SCHEDULER_TickCount = 0U;
+
+/* Total execution time of all jobs in RTI counts, wraps */
+static uint32_t SCHEDULER_BusyCounts = 0U;
+
+/* Optional replacement for WFI, called with IRQ masked */
+static SCHEDULER_TaskFunc_TypeDef SCHEDULER_IdleHook = 0;
+
+/* RTI counter value of the first tick not yet accounted while suspended */
+static uint32_t SCHEDULER_TickBase = 0U;
+
+static void SCHEDULER_Idle(void);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the scheduler with a static task table.
+ *
+ * @param[in] tasks
+ *   Pointer to task table. The table must remain valid while the scheduler
+ *   runs.
+ *
+ * @param[in] numTasks
+ *   Number of entries in the task table.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+SCHEDULER_Err_TypeDef SCHEDULER_Init(const SCHEDULER_Task_TypeDef *tasks,
+                                     uint32_t numTasks)
+{
+  uint32_t i;
+  uint32_t j;
+  uint8_t  idx;
+
+  if ( numTasks > SCHEDULER_MAX_TASKS )
+  {
+    return SCHEDULER_Err_TooManyTasks;
+  }
+
+  for ( i = 0U; i < numTasks; i++ )
+  {
+    if ( tasks[i].run == 0 )
+    {
+      return SCHEDULER_Err_InvalidTask;
+    }
+  }
+
+  SCHEDULER_Tasks = tasks;
+  SCHEDULER_NumTasks = numTasks;
+  SCHEDULER_Pending = 0U;
+  SCHEDULER_Running = 0U;
+  SCHEDULER_TickCount = 0U;
+  SCHEDULER_BusyCounts = 0U;
+
+  /* Insertion sort by priority, table order breaks ties */
+  for ( i = 0U; i < numTasks; i++ )
+  {
+    idx = (uint8_t)i;
+    for ( j = i; j > 0U &&
+          tasks[SCHEDULER_Order[j - 1U]].priority > tasks[idx].priority; j-- )
+    {
+      SCHEDULER_Order[j] = SCHEDULER_Order[j - 1U];
+    }
+    SCHEDULER_Order[j] = idx;
+
+    /* Tasks without a period wait for SCHEDULER_Release */
+    SCHEDULER_State[i].countdown = (tasks[i].period != 0U) ? tasks[i].offset + 1U : 0U;
+  }
+
+  SCHEDULER_ResetStats();
+
+  return SCHEDULER_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Program RTI compare 0 for the scheduler tick and start counter block 0.
+ *
+ * @details
+ *   Must be called after rtiInit. The period set by HALCoGen for compare 0
+ *   is overridden with SCHEDULER_TICK_COUNTS.
+ ******************************************************************************/
+void SCHEDULER_Start(void)
+{
+  rtiStopCounter(rtiCOUNTER_BLOCK0);
+
+  rtiREG1->CMP[0U].COMPx = rtiREG1->CNT[0U].FRCx + SCHEDULER_TICK_COUNTS;
+  rtiREG1->CMP[0U].UDCPx = SCHEDULER_TICK_COUNTS;
+
+  rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE0;
+  rtiEnableNotification(rtiNOTIFICATION_COMPARE0);
+
+  rtiStartCounter(rtiCOUNTER_BLOCK0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Release tasks whose period has elapsed. Call from the RTI compare 0
+ *   notification.
+ ******************************************************************************/
+void SCHEDULER_Tick(void)
+{
+  /* The compare register has already advanced by one period on match */
+  uint32_t release = rtiREG1->CMP[0U].COMPx - rtiREG1->CMP[0U].UDCPx;
+  uint32_t busy = SCHEDULER_Pending | SCHEDULER_Running;
+  uint32_t ready = 0U;
+  uint32_t bit;
+  uint32_t i;
+  SCHEDULER_State_TypeDef *state;
+
+  SCHEDULER_TickCount++;
+
+  PROFILE_HIST(PROFILE_Hist_RtiLatency, rtiREG1->CNT[0U].FRCx - release);
+
+  for ( i = 0U; i < SCHEDULER_NumTasks; i++ )
+  {
+    state = &SCHEDULER_State[i];
+
+    if ( state->countdown == 0U || --state->countdown != 0U )
+    {
+      continue;
+    }
+
+    state->countdown = SCHEDULER_Tasks[i].period;
+    bit = 1UL << i;
+
+    if ( busy & bit )
+    {
+      state->stats.overruns++;
+    }
+    else
+    {
+      state->release = release;
+      ready |= bit;
+    }
+  }
+
+  SCHEDULER_Pending |= ready;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the highest priority released task to completion, or sleep until the
+ *   next interrupt if no task is ready. Call repeatedly from the main loop.
+ ******************************************************************************/
+void SCHEDULER_Dispatch(void)
+{
+  uint32_t ready = SCHEDULER_Pending;
+  uint32_t bit = 0U;
+  uint32_t i;
+  uint32_t start;
+  uint32_t end;
+  uint32_t latency;
+  uint32_t deadline;
+  uint8_t  idx = 0U;
+  const SCHEDULER_Task_TypeDef *task;
+  SCHEDULER_State_TypeDef *state;
+
+  if ( ready == 0U )
+  {
+    SCHEDULER_Idle();
+    return;
+  }
+
+  for ( i = 0U; i < SCHEDULER_NumTasks; i++ )
+  {
+    idx = SCHEDULER_Order[i];
+    bit = 1UL << idx;
+    if ( ready & bit )
+    {
+      break;
+    }
+  }
+
+  task = &SCHEDULER_Tasks[idx];
+  state = &SCHEDULER_State[idx];
+
+  _disable_IRQ();
+  SCHEDULER_Pending &= ~bit;
+  SCHEDULER_Running |= bit;
+  _enable_IRQ();
+
+  start = rtiREG1->CNT[0U].FRCx;
+  task->run();
+  end = rtiREG1->CNT[0U].FRCx;
+
+  _disable_IRQ();
+  SCHEDULER_Running &= ~bit;
+  _enable_IRQ();
+
+  /* Unsigned differences stay correct across counter wrap */
+  latency = start - state->release;
+  PROFILE_HIST(PROFILE_Hist_SchedLatency, latency);
+  deadline = (task->deadline != 0U) ? task->deadline : task->period;
+
+  state->stats.runs++;
+  state->stats.execLast = end - start;
+  SCHEDULER_BusyCounts += end - start;
+
+  if ( state->stats.execLast > state->stats.execMax )
+  {
+    state->stats.execMax = state->stats.execLast;
+  }
+
+  if ( latency < state->stats.latencyMin )
+  {
+    state->stats.latencyMin = latency;
+  }
+
+  if ( latency > state->stats.latencyMax )
+  {
+    state->stats.latencyMax = latency;
+  }
+
+  if ( deadline != 0U && (end - state->release) > deadline * SCHEDULER_TICK_COUNTS )
+  {
+    state->stats.deadlineMisses++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Release a task without a period once, now or after a delay.
+ *
+ * @details
+ *   For tasks that only run on demand, such as a benchmark started from
+ *   the console, so they add no releases while there is nothing to do. A
+ *   new call replaces a delayed release that has not happened yet. A task
+ *   may release itself again from its body. May be called from an
+ *   interrupt.
+ *
+ * @param[in] task
+ *   Index of task in the task table, a task with period 0.
+ *
+ * @param[in] delay
+ *   Ticks until the release, 0 to release it now.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+SCHEDULER_Err_TypeDef SCHEDULER_Release(uint32_t task, uint32_t delay)
+{
+  uint32_t irq;
+
+  if ( task >= SCHEDULER_NumTasks || SCHEDULER_Tasks[task].period != 0U )
+  {
+    return SCHEDULER_Err_InvalidTask;
+  }
+
+  irq = _disable_IRQ();
+
+  SCHEDULER_State[task].countdown = delay;
+
+  if ( delay == 0U && (SCHEDULER_Pending & (1UL << task)) == 0U )
+  {
+    SCHEDULER_State[task].release = rtiREG1->CNT[0U].FRCx;
+    SCHEDULER_Pending |= 1UL << task;
+  }
+
+  _restore_interrupts(irq);
+
+  return SCHEDULER_Err_NoError;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get number of scheduler ticks since SCHEDULER_Init.
+ *
+ * @return
+ *   Returns tick count.
+ ******************************************************************************/
+uint32_t SCHEDULER_GetTicks(void)
+{
+  return SCHEDULER_TickCount;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get current value of the RTI free running counter used for timing.
+ *
+ * @return
+ *   Returns counter value (SCHEDULER_FRC_HZ counts per second).
+ ******************************************************************************/
+uint32_t SCHEDULER_GetCounter(void)
+{
+  return rtiREG1->CNT[0U].FRCx;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get total execution time of all tasks since SCHEDULER_Init. The
+ *   difference of two readings over a window gives the CPU load.
+ *
+ * @return
+ *   Returns busy time in RTI counter counts, wrapping.
+ ******************************************************************************/
+uint32_t SCHEDULER_GetBusyCounts(void)
+{
+  return SCHEDULER_BusyCounts;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get run time statistics of a task.
+ *
+ * @param[in] task
+ *   Index of task in the task table.
+ *
+ * @return
+ *   Returns pointer to statistics, or null if index is out of range.
+ ******************************************************************************/
+const SCHEDULER_Stats_TypeDef *SCHEDULER_GetStats(uint32_t task)
+{
+  if ( task >= SCHEDULER_NumTasks )
+  {
+    return 0;
+  }
+
+  return &SCHEDULER_State[task].stats;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear run time statistics of all tasks.
+ ******************************************************************************/
+void SCHEDULER_ResetStats(void)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < SCHEDULER_NumTasks; i++ )
+  {
+    SCHEDULER_State[i].stats.runs = 0U;
+    SCHEDULER_State[i].stats.overruns = 0U;
+    SCHEDULER_State[i].stats.deadlineMisses = 0U;
+    SCHEDULER_State[i].stats.latencyMin = 0xFFFFFFFFU;
+    SCHEDULER_State[i].stats.latencyMax = 0U;
+    SCHEDULER_State[i].stats.execLast = 0U;
+    SCHEDULER_State[i].stats.execMax = 0U;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Print run time statistics of all tasks, one line per task. Jitter is the
+ *   spread between minimum and maximum start latency. Times are in us.
+ *
+ * @param[in] uart
+ *   Pointer to UART peripheral register block.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+PRINT_Err_TypeDef SCHEDULER_PrintStats(PORT_UART_Reg_TypeDef *uart)
+{
+  static char buf[PRINT_FORMAT_MAX_LENGTH];
+  PRINT_Err_TypeDef ret = PRINT_Err_NoError;
+  const SCHEDULER_Stats_TypeDef *stats;
+  uint32_t jitter;
+  uint32_t i;
+
+  for ( i = 0U; i < SCHEDULER_NumTasks && ret == PRINT_Err_NoError; i++ )
+  {
+    stats = &SCHEDULER_State[i].stats;
+    jitter = (stats->runs != 0U) ? stats->latencyMax - stats->latencyMin : 0U;
+
+    PRINT_PrintString(uart,(char*)SCHEDULER_Tasks[i].name);
+    PRINT_PrintString(uart," RUNS=");
+    PRINT_FormatUInt(buf,stats->runs);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," OVR=");
+    PRINT_FormatUInt(buf,stats->overruns);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," MISS=");
+    PRINT_FormatUInt(buf,stats->deadlineMisses);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," JIT=");
+    PRINT_FormatFixed(buf,(int32_t)jitter,1U,1U);
+    PRINT_PrintString(uart,buf);
+    PRINT_PrintString(uart," EXEC=");
+    PRINT_FormatFixed(buf,(int32_t)stats->execMax,1U,1U);
+    ret = PRINT_PrintStringln(uart,buf);
+  }
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Replace the WFI executed when no task is ready.
+ *
+ * @details
+ *   The hook is called with IRQ masked and no task pending. It must return
+ *   with IRQ still masked; a pending interrupt is taken right after.
+ *
+ * @param[in] hook
+ *   Idle function, or null for plain WFI.
+ ******************************************************************************/
+void SCHEDULER_SetIdleHook(SCHEDULER_TaskFunc_TypeDef hook)
+{
+  SCHEDULER_IdleHook = hook;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get number of ticks until the next task release. Call with IRQ masked.
+ *
+ * @return
+ *   Returns 0 if a task is pending, 1 if the next tick releases a task, and
+ *   0xFFFFFFFF if no release is due.
+ ******************************************************************************/
+uint32_t SCHEDULER_GetIdleTicks(void)
+{
+  uint32_t gap = 0xFFFFFFFFU;
+  uint32_t i;
+
+  if ( SCHEDULER_Pending != 0U )
+  {
+    return 0U;
+  }
+
+  for ( i = 0U; i < SCHEDULER_NumTasks; i++ )
+  {
+    if ( SCHEDULER_State[i].countdown != 0U && SCHEDULER_State[i].countdown < gap )
+    {
+      gap = SCHEDULER_State[i].countdown;
+    }
+  }
+
+  return gap;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stop tick notifications. Call with IRQ masked.
+ *
+ * @details
+ *   Compare 0 keeps matching and advancing in hardware; ticks are accounted
+ *   by SCHEDULER_ResumeTick from the compare value. A match that is flagged
+ *   but not yet handled is included.
+ *
+ * @return
+ *   Returns RTI counter value of the next tick, i.e. the tick that
+ *   SCHEDULER_GetIdleTicks counts as 1.
+ ******************************************************************************/
+uint32_t SCHEDULER_SuspendTick(void)
+{
+  uint32_t base = rtiREG1->CMP[0U].COMPx;
+  uint32_t flagged = rtiREG1->INTFLAG & rtiNOTIFICATION_COMPARE0;
+
+  rtiDisableNotification(rtiNOTIFICATION_COMPARE0);
+
+  /* A match between the two reads is counted on resume. Otherwise a set
+   * flag is an earlier match whose handler has not run yet. */
+  if ( rtiREG1->CMP[0U].COMPx == base && flagged != 0U )
+  {
+    base -= rtiREG1->CMP[0U].UDCPx;
+  }
+
+  SCHEDULER_TickBase = base;
+
+  return base;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Move compare 0 to the first tick after the current counter value.
+ *
+ * @details
+ *   Needed after the counter has been rewritten or run from another clock.
+ *   Counter block 0 must be stopped.
+ ******************************************************************************/
+void SCHEDULER_RealignTick(void)
+{
+  uint32_t now = rtiREG1->CNT[0U].FRCx;
+  uint32_t next = SCHEDULER_TickBase;
+
+  if ( (int32_t)(now - next) >= 0 )
+  {
+    next += ((now - next) / SCHEDULER_TICK_COUNTS + 1U) * SCHEDULER_TICK_COUNTS;
+  }
+
+  rtiREG1->CMP[0U].COMPx = next;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Account ticks that passed while suspended and restart tick
+ *   notifications. Call with IRQ masked.
+ *
+ * @details
+ *   Tasks whose release tick was passed are released immediately with the
+ *   release time of that tick, so the lateness shows up as start latency.
+ *
+ * @return
+ *   Returns number of ticks skipped.
+ ******************************************************************************/
+uint32_t SCHEDULER_ResumeTick(void)
+{
+  uint32_t cmp = rtiREG1->CMP[0U].COMPx;
+  uint32_t cmp2;
+  uint32_t skipped;
+  uint32_t late;
+  uint32_t period;
+  uint32_t ready = 0U;
+  uint32_t i;
+  SCHEDULER_State_TypeDef *state;
+
+  /* Clear the flag without losing a match that lands in between, matches
+   * are one tick apart so the second clear cannot hide a new one */
+  rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE0;
+  cmp2 = rtiREG1->CMP[0U].COMPx;
+
+  if ( cmp2 != cmp )
+  {
+    rtiREG1->INTFLAG = rtiNOTIFICATION_COMPARE0;
+  }
+
+  skipped = (cmp2 - SCHEDULER_TickBase) / SCHEDULER_TICK_COUNTS;
+
+  for ( i = 0U; i < SCHEDULER_NumTasks; i++ )
+  {
+    state = &SCHEDULER_State[i];
+    period = SCHEDULER_Tasks[i].period;
+
+    if ( state->countdown == 0U )
+    {
+      continue;
+    }
+
+    if ( state->countdown > skipped )
+    {
+      state->countdown -= skipped;
+      continue;
+    }
+
+    /* Ticks since the first passed release, further passed releases are
+     * overruns; a release of a task without a period is not repeated */
+    late = skipped - state->countdown;
+    state->release = SCHEDULER_TickBase
+                   + (state->countdown - 1U) * SCHEDULER_TICK_COUNTS;
+    if ( period != 0U )
+    {
+      state->stats.overruns += late / period;
+      state->countdown = period - (late % period);
+    }
+    else
+    {
+      state->countdown = 0U;
+    }
+
+    if ( (SCHEDULER_Pending | SCHEDULER_Running) & (1UL << i) )
+    {
+      state->stats.overruns++;
+    }
+    else
+    {
+      ready |= 1UL << i;
+    }
+  }
+
+  SCHEDULER_TickCount += skipped;
+  SCHEDULER_Pending |= ready;
+
+  /* Not rtiEnableNotification, which would clear a match flagged since */
+  rtiREG1->SETINTENA = rtiNOTIFICATION_COMPARE0;
+
+  return skipped;
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Sleep until the next interrupt. Interrupts are masked while checking for
+ *   work so a release between the check and WFI still wakes the core.
+ ******************************************************************************/
+static void SCHEDULER_Idle(void)
+{
+  _disable_IRQ();
+
+  if ( SCHEDULER_Pending == 0U )
+  {
+    if ( SCHEDULER_IdleHook != 0 )
+    {
+      SCHEDULER_IdleHook();
+    }
+    else
+    {
+      _gotoCPUIdle_();
+    }
+  }
+
+  _enable_IRQ();
+}
@@ -0,0 +1,147 @@
+/** @file scheduler.h
+*   @brief Cooperative Time-Triggered Scheduler Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup SCHEDULER SCHEDULER
+ *  @brief Static, table configured cooperative scheduler driven by the RTI.
+ *
+ *  RTI compare 0 generates the scheduler tick. Each tick releases the tasks
+ *  whose period has elapsed and the main loop runs released tasks to
+ *  completion in priority order, sleeping in WFI when nothing is ready.
+ *  An idle hook can replace the plain WFI; it may suspend the tick until the
+ *  next release and account the skipped ticks when it resumes (tickless
+ *  idle).
+ *  Tasks with period 0 are only run when released with SCHEDULER_Release,
+ *  once, so an on demand task costs no wakeups while it is not needed.
+ *  Release times are taken from the RTI free running counter so start
+ *  latency (jitter), execution time, overruns and deadline misses can be
+ *  tracked per task.
+ *
+ *	Related Files
+ *   - scheduler.h
+ *   - scheduler.c
+ *   - rti.h
+ *   - print.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_SCHEDULER_H_
+#define DRIVERS_SCHEDULER_H_
+
+#include "rti.h"
+#include "print.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Frequency of RTI free running counter 0 in Hz: RTICLK (80 MHz) divided by
+ *  CPUC0 + 1 (8). */
+#define SCHEDULER_FRC_HZ        (10000000U)
+
+/** Scheduler tick period in us. */
+#define SCHEDULER_TICK_US       (1000U)
+
+/** Scheduler tick period in RTI free running counter counts. */
+#define SCHEDULER_TICK_COUNTS   (SCHEDULER_FRC_HZ / 1000000U * SCHEDULER_TICK_US)
+
+/** Convert a time in ms to scheduler ticks. */
+#define SCHEDULER_MS(ms)        ((uint32_t)(ms) * 1000U / SCHEDULER_TICK_US)
+
+/** Maximum number of tasks in the task table (one bit each in a word). */
+#define SCHEDULER_MAX_TASKS     (32U)
+
+/**
+ *  @addtogroup SCHEDULER
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum SCHEDULER_Err_TypeDef
+*   @brief Alias names for SCHEDULER errors.
+*/
+typedef enum
+{
+  SCHEDULER_Err_NoError      = 0U,  /**< No error*/
+  SCHEDULER_Err_TooManyTasks = 1U,  /**< Task table exceeds SCHEDULER_MAX_TASKS*/
+  SCHEDULER_Err_InvalidTask  = 2U   /**< Task has no function or bad index*/
+} SCHEDULER_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+typedef void (*SCHEDULER_TaskFunc_TypeDef)(void);
+
+/** @struct SCHEDULER_Task_TypeDef
+*   @brief Static task configuration. All times are in scheduler ticks.
+*/
+typedef struct
+{
+  const char *name;                 /**< Name used in statistics output*/
+  SCHEDULER_TaskFunc_TypeDef run;   /**< Task body, must run to completion*/
+  uint32_t period;                  /**< Release period, 0 for SCHEDULER_Release only*/
+  uint32_t offset;                  /**< Tick of the first release*/
+  uint8_t  priority;                /**< 0 is the highest priority*/
+  uint32_t deadline;                /**< Relative deadline, 0 uses period (none if 0)*/
+} SCHEDULER_Task_TypeDef;
+
+/** @struct SCHEDULER_Stats_TypeDef
+*   @brief Run time statistics of a task. Times are in RTI counter counts.
+*/
+typedef struct
+{
+  uint32_t runs;            /**< Completed runs*/
+  uint32_t overruns;        /**< Releases dropped because the previous job
+                                 had not finished*/
+  uint32_t deadlineMisses;  /**< Jobs that finished after their deadline*/
+  uint32_t latencyMin;      /**< Minimum release to start latency*/
+  uint32_t latencyMax;      /**< Maximum release to start latency*/
+  uint32_t execLast;        /**< Execution time of the last job*/
+  uint32_t execMax;         /**< Maximum execution time*/
+} SCHEDULER_Stats_TypeDef;
+
+SCHEDULER_Err_TypeDef SCHEDULER_Init(const SCHEDULER_Task_TypeDef *tasks,
+                                     uint32_t numTasks);
+
+void SCHEDULER_Start(void);
+
+void SCHEDULER_Tick(void);
+
+void SCHEDULER_Dispatch(void);
+
+SCHEDULER_Err_TypeDef SCHEDULER_Release(uint32_t task, uint32_t delay);
+
+uint32_t SCHEDULER_GetTicks(void);
+
+uint32_t SCHEDULER_GetCounter(void);
+
+uint32_t SCHEDULER_GetBusyCounts(void);
+
+const SCHEDULER_Stats_TypeDef *SCHEDULER_GetStats(uint32_t task);
+
+void SCHEDULER_ResetStats(void);
+
+PRINT_Err_TypeDef SCHEDULER_PrintStats(PORT_UART_Reg_TypeDef *uart);
+
+void SCHEDULER_SetIdleHook(SCHEDULER_TaskFunc_TypeDef hook);
+
+uint32_t SCHEDULER_GetIdleTicks(void);
+
+uint32_t SCHEDULER_SuspendTick(void);
+
+void SCHEDULER_RealignTick(void);
+
+uint32_t SCHEDULER_ResumeTick(void);
+
+/**@}*/
+
+#endif /* DRIVERS_SCHEDULER_H_ */
@@ -0,0 +1,114 @@
+/** @file tasks.h
+*   @brief Scheduler Task Table Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup TASKS TASKS
+ *  @brief The one task table of the firmware.
+ *
+ *  TASKS_TABLE lists every scheduler task with its run function, period,
+ *  offset, priority and deadline, in the order of the table. sys_main.c
+ *  expands it into the table passed to SCHEDULER_Init and defines the run
+ *  functions; testing/host/idle_model.cpp expands the same list with
+ *  simulated run functions, so the host model cannot drift from the
+ *  firmware.
+ *
+ *  TASKS_Id_TypeDef gives the index of each task, which modules releasing
+ *  their own task with SCHEDULER_Release are passed at init.
+ *
+ *	Related Files
+ *   - tasks.h
+ *   - scheduler.h
+ *   - governor.h
+ *   - mppt.h
+ *   - ivsweep.h
+ *   - battery.h
+ *   - policy.h
+ *   - rv3032c7.h
+ *   - flashlog.h
+ *   - history.h
+ *   - config.h
+ *   - canpub.h
+ *   - cancmd.h
+ *   - csp.h
+ *   - adcacq.h
+ */
+
+#ifndef DRIVERS_TASKS_H_
+#define DRIVERS_TASKS_H_
+
+#include "scheduler.h"
+#include "governor.h"
+#include "mppt.h"
+#include "ivsweep.h"
+#include "battery.h"
+#include "policy.h"
+#include "rv3032c7.h"
+#include "flashlog.h"
+#include "history.h"
+#include "config.h"
+#include "canpub.h"
+#include "cancmd.h"
+#include "csp.h"
+#include "adcacq.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Every task as TASK(name, run, period, offset, prio, deadline); period 0
+ *  for tasks only released by SCHEDULER_Release */
+#define TASKS_TABLE(TASK) \
+  /*   name          run               period                offset              prio  deadline */          \
+  TASK(HOUSEKEEPING, housekeepingTask, SCHEDULER_MS(100),    0U,                 1U,   0U)                \
+  TASK(TELEMETRY,    telemetryTask,    SCHEDULER_MS(1000),   SCHEDULER_MS(5),    2U,   SCHEDULER_MS(100)) \
+  TASK(GOVERNOR,     governorTask,     GOVERNOR_PERIOD,      SCHEDULER_MS(50),   3U,   0U)                \
+  TASK(MPPT,         mpptTask,         MPPT_PERIOD,          SCHEDULER_MS(20),   1U,   0U)                \
+  TASK(IVSWEEP,      ivsweepTask,      IVSWEEP_PERIOD,       SCHEDULER_MS(3),    4U,   0U)                \
+  TASK(BATTERY,      batteryTask,      BATTERY_PERIOD,       SCHEDULER_MS(150),  3U,   0U)                \
+  TASK(POLICY,       policyTask,       POLICY_PERIOD,        SCHEDULER_MS(200),  2U,   SCHEDULER_MS(50))  \
+  TASK(RTC,          rtcTask,          RV3032C7_SYNC_PERIOD, SCHEDULER_MS(250),  1U,   0U)                \
+  TASK(FLASHLOG,     flashlogTask,     FLASHLOG_PERIOD,      SCHEDULER_MS(60),   1U,   0U)                \
+  TASK(HISTORY,      historyTask,      HISTORY_PERIOD,       SCHEDULER_MS(7),    1U,   0U)                \
+  TASK(CONFIG,       configTask,       CONFIG_PERIOD,        SCHEDULER_MS(70),   1U,   0U)                \
+  TASK(CANPUB,       canpubTask,       0U,                   0U,                 1U,   0U)                \
+  TASK(CANCMD,       cancmdTask,       0U,                   0U,                 1U,   0U)                \
+  TASK(CSP,          cspTask,          0U,                   0U,                 1U,   0U)                \
+  TASK(ADCACQ,       adcacqTask,       ADCACQ_PERIOD,        SCHEDULER_MS(2),    0U,   0U)                \
+  TASK(CANBENCH,     canbenchTask,     0U,                   0U,                 1U,   0U)
+
+/** Expand TASKS_TABLE into the entries of a SCHEDULER_Task_TypeDef table */
+#define TASKS_ENTRY(name, run, period, offset, prio, deadline) \
+  { #name, run, period, offset, prio, deadline },
+
+/** Expand TASKS_TABLE into prototypes of the run functions */
+#define TASKS_PROTOTYPE(name, run, period, offset, prio, deadline) \
+  static void run(void);
+
+#define TASKS_ID(name, run, period, offset, prio, deadline) \
+  TASKS_Id_##name,
+
+/**
+ *  @addtogroup TASKS
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum TASKS_Id_TypeDef
+*   @brief Index of each task in the table.
+*/
+typedef enum
+{
+  TASKS_TABLE(TASKS_ID)
+  TASKS_NUM_TASKS                 /**< Tasks in the table*/
+} TASKS_Id_TypeDef;
+
+/**@}*/
+
+#endif /* DRIVERS_TASKS_H_ */
@@ -0,0 +1,389 @@
+/** @file telemetry.c
+*   @brief EPS Telemetry Sweep Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "telemetry.h"
+#include "scheduler.h"
+#include "port_i2c.h"
+#include "rv3032c7.h"
+#include "profile.h"
+#include "adccal.h"
+#include "het.h"
+#include "gio.h"
+#include "stdint.h"
+
+/** @struct TELEMETRY_Config_TypeDef
+*   @brief Board configuration of one power monitor.
+*/
+typedef struct
+{
+  INA226_Address_TypeDef addr;
+  uint8_t muxChan;
+  uint32_t senseResistor;
+} TELEMETRY_Config_TypeDef;
+
+/* Must stay in TELEMETRY_Channel_TypeDef order, grouped by mux channel */
+static const TELEMETRY_Config_TypeDef TELEMETRY_Config[TELEMETRY_NUM_CHANNELS] =
+{
+  { EPS_MPPT1_I2CADDR,    EPS_MPPT1_MUXCHAN,    EPS_MPPT1_SENSERESISTOR    },
+  { EPS_MPPT2_I2CADDR,    EPS_MPPT2_MUXCHAN,    EPS_MPPT2_SENSERESISTOR    },
+  { EPS_MPPT3_I2CADDR,    EPS_MPPT3_MUXCHAN,    EPS_MPPT3_SENSERESISTOR    },
+  { EPS_MPPT4_I2CADDR,    EPS_MPPT4_MUXCHAN,    EPS_MPPT4_SENSERESISTOR    },
+  { EPS_EPS3V3_I2CADDR,   EPS_EPS3V3_MUXCHAN,   EPS_EPS3V3_SENSERESISTOR   },
+  { EPS_EPS1V2_I2CADDR,   EPS_EPS1V2_MUXCHAN,   EPS_EPS1V2_SENSERESISTOR   },
+  { EPS_PV3V3_I2CADDR,    EPS_PV3V3_MUXCHAN,    EPS_PV3V3_SENSERESISTOR    },
+  { EPS_3V3BUS_I2CADDR,   EPS_3V3BUS_MUXCHAN,   EPS_3V3BUS_SENSERESISTOR   },
+  { EPS_1V2BUS_I2CADDR,   EPS_1V2BUS_MUXCHAN,   EPS_1V2BUS_SENSERESISTOR   },
+  { EPS_5V0BUS_I2CADDR,   EPS_5V0BUS_MUXCHAN,   EPS_5V0BUS_SENSERESISTOR   },
+  { EPS_BATBUS_I2CADDR,   EPS_BATBUS_MUXCHAN,   EPS_BATBUS_SENSERESISTOR   },
+  { EPS_OUTPUT01_I2CADDR, EPS_OUTPUT01_MUXCHAN, EPS_OUTPUT01_SENSERESISTOR },
+  { EPS_OUTPUT02_I2CADDR, EPS_OUTPUT02_MUXCHAN, EPS_OUTPUT02_SENSERESISTOR },
+  { EPS_OUTPUT03_I2CADDR, EPS_OUTPUT03_MUXCHAN, EPS_OUTPUT03_SENSERESISTOR },
+  { EPS_OUTPUT04_I2CADDR, EPS_OUTPUT04_MUXCHAN, EPS_OUTPUT04_SENSERESISTOR },
+  { EPS_OUTPUT05_I2CADDR, EPS_OUTPUT05_MUXCHAN, EPS_OUTPUT05_SENSERESISTOR },
+  { EPS_OUTPUT06_I2CADDR, EPS_OUTPUT06_MUXCHAN, EPS_OUTPUT06_SENSERESISTOR },
+  { EPS_OUTPUT07_I2CADDR, EPS_OUTPUT07_MUXCHAN, EPS_OUTPUT07_SENSERESISTOR },
+  { EPS_OUTPUT08_I2CADDR, EPS_OUTPUT08_MUXCHAN, EPS_OUTPUT08_SENSERESISTOR },
+  { EPS_OUTPUT09_I2CADDR, EPS_OUTPUT09_MUXCHAN, EPS_OUTPUT09_SENSERESISTOR },
+  { EPS_OUTPUT10_I2CADDR, EPS_OUTPUT10_MUXCHAN, EPS_OUTPUT10_SENSERESISTOR },
+  { EPS_OUTPUT11_I2CADDR, EPS_OUTPUT11_MUXCHAN, EPS_OUTPUT11_SENSERESISTOR },
+  { EPS_OUTPUT12_I2CADDR, EPS_OUTPUT12_MUXCHAN, EPS_OUTPUT12_SENSERESISTOR },
+  { EPS_OUTPUT13_I2CADDR, EPS_OUTPUT13_MUXCHAN, EPS_OUTPUT13_SENSERESISTOR },
+  { EPS_OUTPUT14_I2CADDR, EPS_OUTPUT14_MUXCHAN, EPS_OUTPUT14_SENSERESISTOR },
+  { EPS_OUTPUT15_I2CADDR, EPS_OUTPUT15_MUXCHAN, EPS_OUTPUT15_SENSERESISTOR },
+  { EPS_OUTPUT16_I2CADDR, EPS_OUTPUT16_MUXCHAN, EPS_OUTPUT16_SENSERESISTOR },
+  { EPS_OUTPUT17_I2CADDR, EPS_OUTPUT17_MUXCHAN, EPS_OUTPUT17_SENSERESISTOR },
+  { EPS_OUTPUT18_I2CADDR, EPS_OUTPUT18_MUXCHAN, EPS_OUTPUT18_SENSERESISTOR }
+};
+
+/** @struct TELEMETRY_TempConfig_TypeDef
+*   @brief Board configuration of one temperature sensor.
+*/
+typedef struct
+{
+  TMP117_Address_TypeDef addr;
+  uint8_t muxChan;
+} TELEMETRY_TempConfig_TypeDef;
+
+/* Must stay in TELEMETRY_Temp_TypeDef order */
+static const TELEMETRY_TempConfig_TypeDef TELEMETRY_TempConfig[TELEMETRY_NUM_TEMPS] =
+{
+  { EPS_TEMP1_I2CADDR, EPS_TEMP1_MUXCHAN },
+  { EPS_TEMP2_I2CADDR, EPS_TEMP2_MUXCHAN },
+  { EPS_TEMP3_I2CADDR, EPS_TEMP3_MUXCHAN },
+  { EPS_TEMP4_I2CADDR, EPS_TEMP4_MUXCHAN }
+};
+
+static INA226_TypeDef TELEMETRY_Sensors[TELEMETRY_NUM_CHANNELS];
+static TMP117_TypeDef TELEMETRY_TempSensors[TELEMETRY_NUM_TEMPS];
+
+/* Double buffered so readers always see a complete sweep */
+static TELEMETRY_Snapshot_TypeDef TELEMETRY_Snapshots[2];
+static volatile uint32_t TELEMETRY_Published = 0U;
+static uint32_t TELEMETRY_Sequence = 0U;
+
+static uint8_t TELEMETRY_SelectMux(PORT_I2C_Reg_TypeDef *i2c,
+                                   uint8_t muxChan,
+                                   int32_t *current,
+                                   uint8_t *ok);
+static TMP117_Err_TypeDef TELEMETRY_ReadTemp(TMP117_TypeDef *sensor, int *val);
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize power monitor and temperature sensor objects, release the I2C
+ *   mux from reset and configure the temperature sensors.
+ *
+ * @details
+ *   Must be called after i2cInit and with the mux reset pin configured as an
+ *   output. A temperature sensor that does not respond here keeps its power
+ *   on defaults (continuous, 1 s, 8 averages) and is flagged by the sweep.
+ *
+ * @param[in] senseResistors
+ *   Sense resistor of each channel in mOhm, 0 for the eps.h value, or null
+ *   to use eps.h for all.
+ ******************************************************************************/
+void TELEMETRY_Init(const uint32_t *senseResistors)
+{
+  TMP117_TypeDef *temp;
+  int32_t muxChan = -1;
+  uint8_t muxOk = 0U;
+  uint32_t i;
+
+  for ( i = 0U; i < TELEMETRY_NUM_CHANNELS; i++ )
+  {
+    INA226_Init(&TELEMETRY_Sensors[i],
+                PORT_I2C,
+                TELEMETRY_Config[i].addr,
+                TELEMETRY_Config[i].muxChan,
+                (senseResistors != 0 && senseResistors[i] != 0U) ? senseResistors[i]
+                                                                 : TELEMETRY_Config[i].senseResistor,
+                INA226_RegisterGet,
+                INA226_RegisterSet);
+  }
+
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    TMP117_Init(&TELEMETRY_TempSensors[i],
+                PORT_I2C,
+                TELEMETRY_TempConfig[i].addr,
+                TELEMETRY_TempConfig[i].muxChan,
+                TMP117_RegisterGet,
+                TMP117_RegisterSet);
+  }
+
+  /* Set HET1_26 (I2C_MUX_nRESET) high to release the mux */
+  gioSetBit(EPS_GPIO_I2CMUXRESET_PORT, EPS_GPIO_I2CMUXRESET_PIN, 1);
+
+  /* One-shot sensors start the conversion the first sweep collects */
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    temp = &TELEMETRY_TempSensors[i];
+
+    if ( !TELEMETRY_SelectMux(temp->i2c, temp->muxChan, &muxChan, &muxOk) )
+    {
+      continue;
+    }
+
+    if ( TELEMETRY_TEMP_ONESHOT )
+    {
+      (void)TMP117_StartOneShot(temp, TELEMETRY_TEMP_AVG);
+    }
+    else
+    {
+      (void)TMP117_Configure(temp, TMP117_ModeContinuous,
+                             TELEMETRY_TEMP_CONV, TELEMETRY_TEMP_AVG);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read every temperature sensor and the bus voltage and current of every
+ *   power monitor and publish the result as a new snapshot.
+ *
+ * @details
+ *   Channels that fail are flagged in the snapshot error masks and keep a
+ *   reading of zero. The temperature sensors are read first, on the mux
+ *   channel of the first power monitors. The mux is left on the last
+ *   channel visited.
+ *
+ * @return
+ *   Returns 0 if every channel was read.
+ ******************************************************************************/
+TELEMETRY_Err_TypeDef TELEMETRY_Sweep(void)
+{
+  TELEMETRY_Snapshot_TypeDef *snap = &TELEMETRY_Snapshots[TELEMETRY_Published ^ 1U];
+  TELEMETRY_Err_TypeDef ret = TELEMETRY_Err_NoError;
+  INA226_TypeDef *sensor;
+  TMP117_TypeDef *temp;
+  int32_t muxChan = -1;
+  uint8_t muxOk = 0U;
+  int busV;
+  int shuntV;
+  int raw;
+  uint32_t i;
+  PROFILE_BEGIN(PROFILE_Scope_TelemetrySweep);
+
+  snap->timestamp = SCHEDULER_GetTicks();
+  snap->time = RV3032C7_GetTime(SCHEDULER_GetCounter());
+  snap->sequence = TELEMETRY_Sequence++;
+  snap->errors = 0U;
+  snap->tempErrors = 0U;
+  snap->adcFlags = ADCCAL_GetFlags();
+
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    temp = &TELEMETRY_TempSensors[i];
+
+    snap->temp[i] = 0;
+
+    /* Only switch the mux when entering a new group */
+    if ( !TELEMETRY_SelectMux(temp->i2c, temp->muxChan, &muxChan, &muxOk) )
+    {
+      ret = TELEMETRY_Err_Mux;
+    }
+
+    if ( !muxOk || TELEMETRY_ReadTemp(temp, &raw) != TMP117_Err_NoError )
+    {
+      snap->tempErrors |= 1UL << i;
+      if ( ret == TELEMETRY_Err_NoError )
+      {
+        ret = TELEMETRY_Err_Sensor;
+      }
+      continue;
+    }
+
+    snap->temp[i] = TMP117_TempToMC(raw);
+  }
+
+  for ( i = 0U; i < TELEMETRY_NUM_CHANNELS; i++ )
+  {
+    sensor = &TELEMETRY_Sensors[i];
+
+    snap->meas[i].voltage = 0;
+    snap->meas[i].current = 0;
+
+    /* Only switch the mux when entering a new group */
+    if ( !TELEMETRY_SelectMux(sensor->i2c, sensor->muxChan, &muxChan, &muxOk) )
+    {
+      ret = TELEMETRY_Err_Mux;
+    }
+
+    if ( !muxOk
+         || INA226_ReadBusVoltage(sensor, &busV) != INA226_Err_NoError
+         || INA226_ReadShuntVoltage(sensor, &shuntV) != INA226_Err_NoError )
+    {
+      snap->errors |= 1UL << i;
+      if ( ret == TELEMETRY_Err_NoError )
+      {
+        ret = TELEMETRY_Err_Sensor;
+      }
+      continue;
+    }
+
+    snap->meas[i].voltage = INA226_BusVoltageToUV(busV);
+    snap->meas[i].current = INA226_ShuntVoltageToUA(shuntV, sensor->senseResistor);
+  }
+
+  TELEMETRY_Published ^= 1U;
+
+  PROFILE_END(PROFILE_Scope_TelemetrySweep);
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the most recent complete snapshot.
+ *
+ * @return
+ *   Returns pointer to snapshot. It stays valid until the next sweep
+ *   completes.
+ ******************************************************************************/
+const TELEMETRY_Snapshot_TypeDef *TELEMETRY_GetSnapshot(void)
+{
+  return &TELEMETRY_Snapshots[TELEMETRY_Published];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the power monitor object of a channel.
+ *
+ * @param[in] channel
+ *   Telemetry channel.
+ *
+ * @return
+ *   Returns pointer to INA226 object, or null if channel is out of range.
+ ******************************************************************************/
+INA226_TypeDef *TELEMETRY_GetSensor(TELEMETRY_Channel_TypeDef channel)
+{
+  if ( channel >= TELEMETRY_NUM_CHANNELS )
+  {
+    return 0;
+  }
+
+  return &TELEMETRY_Sensors[channel];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the temperature sensor object of a sensor.
+ *
+ * @param[in] temp
+ *   Temperature sensor.
+ *
+ * @return
+ *   Returns pointer to TMP117 object, or null if temp is out of range.
+ ******************************************************************************/
+TMP117_TypeDef *TELEMETRY_GetTempSensor(TELEMETRY_Temp_TypeDef temp)
+{
+  if ( temp >= TELEMETRY_NUM_TEMPS )
+  {
+    return 0;
+  }
+
+  return &TELEMETRY_TempSensors[temp];
+}
+
+/*******************************************************************************
+ **************************   LOCAL FUNCTIONS   ********************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Select a mux channel unless it is the current one.
+ *
+ * @param[in] i2c
+ *   I2C port.
+ *
+ * @param[in] muxChan
+ *   Mux channel bit wanted.
+ *
+ * @param[in,out] current
+ *   Channel selected last, -1 for none. Updated on a switch.
+ *
+ * @param[in,out] ok
+ *   Result of the last switch. Updated on a switch.
+ *
+ * @return
+ *   Returns 0 if a switch was needed and failed.
+ ******************************************************************************/
+static uint8_t TELEMETRY_SelectMux(PORT_I2C_Reg_TypeDef *i2c,
+                                   uint8_t muxChan,
+                                   int32_t *current,
+                                   uint8_t *ok)
+{
+  if ( *current == (int32_t)muxChan )
+  {
+    return 1U;
+  }
+
+  *current = (int32_t)muxChan;
+  *ok = (TCA9548A_RegisterSet(i2c, EPS_MUX1_I2CADDR, muxChan)
+         == TCA9548A_Err_NoError);
+
+  return *ok;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read one temperature sensor in the configured mode.
+ *
+ * @details
+ *   In one-shot mode the result of the conversion started by the previous
+ *   sweep is collected and the next conversion is started.
+ *
+ * @param[in] sensor
+ *   Temperature sensor.
+ *
+ * @param[out] val
+ *   Temperature register value.
+ *
+ * @return
+ *   Returns 0 if a result was read.
+ ******************************************************************************/
+static TMP117_Err_TypeDef TELEMETRY_ReadTemp(TMP117_TypeDef *sensor, int *val)
+{
+  TMP117_Err_TypeDef ret;
+
+  if ( !TELEMETRY_TEMP_ONESHOT )
+  {
+    return TMP117_ReadTemp(sensor, val);
+  }
+
+  ret = TMP117_ReadTempIfReady(sensor, val);
+
+  if ( ret == TMP117_Err_NoError || ret == TMP117_Err_NotReady )
+  {
+    (void)TMP117_StartOneShot(sensor, TELEMETRY_TEMP_AVG);
+  }
+
+  return ret;
+}
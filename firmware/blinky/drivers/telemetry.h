@@ -0,0 +1,168 @@
+/** @file telemetry.h
+*   @brief EPS Telemetry Sweep Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup TELEMETRY TELEMETRY
+ *  @brief Batched sweep of all EPS power monitors into a snapshot.
+ *
+ *  Monitors are visited in mux channel order so each TCA9548A channel is
+ *  selected once per sweep. Completed sweeps are published as a consistent
+ *  snapshot with a timestamp and sequence number.
+ *
+ *  The board temperature sensors are read in the same pass, on the mux
+ *  channel they share with the first power monitors. In continuous mode
+ *  they convert on their own and the sweep reads the latest result. In
+ *  one-shot mode the sweep collects the result started by the previous
+ *  sweep and starts the next one, so the sensors sleep between sweeps and
+ *  the sweep never waits for a conversion.
+ *
+ *  Each snapshot also carries the ADCCAL drift flags, so whoever reads the
+ *  telemetry knows whether the fast ADC values and the undervoltage trip
+ *  on them can be relied on.
+ *
+ *	Related Files
+ *   - telemetry.h
+ *   - telemetry.c
+ *   - eps.h
+ *   - ina226.h
+ *   - tmp117.h
+ *   - tca9548a.h
+ *   - adccal.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_TELEMETRY_H_
+#define DRIVERS_TELEMETRY_H_
+
+#include "eps.h"
+#include "ina226.h"
+#include "tmp117.h"
+#include "tca9548a.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Non-zero to sample the temperature sensors one-shot, once per sweep */
+#define TELEMETRY_TEMP_ONESHOT    (0U)
+
+/** Conversions averaged per temperature result */
+#define TELEMETRY_TEMP_AVG        (TMP117_AVG8)
+
+/** Conversion cycle of the temperature sensors in continuous mode */
+#define TELEMETRY_TEMP_CONV       (TMP117_Conv1s)
+
+/**
+ *  @addtogroup TELEMETRY
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum TELEMETRY_Channel_TypeDef
+*   @brief Power monitor channels, in sweep order.
+*/
+typedef enum
+{
+  TELEMETRY_Channel_MPPT1 = 0,
+  TELEMETRY_Channel_MPPT2,
+  TELEMETRY_Channel_MPPT3,
+  TELEMETRY_Channel_MPPT4,
+  TELEMETRY_Channel_EPS3V3,
+  TELEMETRY_Channel_EPS1V2,
+  TELEMETRY_Channel_PV3V3,
+  TELEMETRY_Channel_3V3BUS,
+  TELEMETRY_Channel_1V2BUS,
+  TELEMETRY_Channel_5V0BUS,
+  TELEMETRY_Channel_BATBUS,
+  TELEMETRY_Channel_OUTPUT01,
+  TELEMETRY_Channel_OUTPUT02,
+  TELEMETRY_Channel_OUTPUT03,
+  TELEMETRY_Channel_OUTPUT04,
+  TELEMETRY_Channel_OUTPUT05,
+  TELEMETRY_Channel_OUTPUT06,
+  TELEMETRY_Channel_OUTPUT07,
+  TELEMETRY_Channel_OUTPUT08,
+  TELEMETRY_Channel_OUTPUT09,
+  TELEMETRY_Channel_OUTPUT10,
+  TELEMETRY_Channel_OUTPUT11,
+  TELEMETRY_Channel_OUTPUT12,
+  TELEMETRY_Channel_OUTPUT13,
+  TELEMETRY_Channel_OUTPUT14,
+  TELEMETRY_Channel_OUTPUT15,
+  TELEMETRY_Channel_OUTPUT16,
+  TELEMETRY_Channel_OUTPUT17,
+  TELEMETRY_Channel_OUTPUT18,
+  TELEMETRY_NUM_CHANNELS          /**< Number of channels (not a channel)*/
+} TELEMETRY_Channel_TypeDef;
+
+/** @enum TELEMETRY_Temp_TypeDef
+*   @brief Temperature sensors, in sweep order.
+*/
+typedef enum
+{
+  TELEMETRY_Temp_TEMP1 = 0,
+  TELEMETRY_Temp_TEMP2,
+  TELEMETRY_Temp_TEMP3,
+  TELEMETRY_Temp_TEMP4,
+  TELEMETRY_NUM_TEMPS             /**< Number of sensors (not a sensor)*/
+} TELEMETRY_Temp_TypeDef;
+
+/** @enum TELEMETRY_Err_TypeDef
+*   @brief Alias names for TELEMETRY errors.
+*/
+typedef enum
+{
+  TELEMETRY_Err_NoError = 0U,     /**< No error*/
+  TELEMETRY_Err_Mux     = 1U,     /**< Mux channel select failed*/
+  TELEMETRY_Err_Sensor  = 2U      /**< One or more monitors did not respond*/
+} TELEMETRY_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+/** @struct TELEMETRY_Measurement_TypeDef
+*   @brief Converted reading of one power monitor.
+*/
+typedef struct
+{
+  int32_t voltage;                /**< Bus voltage in uV*/
+  int32_t current;                /**< Current in uA*/
+} TELEMETRY_Measurement_TypeDef;
+
+/** @struct TELEMETRY_Snapshot_TypeDef
+*   @brief Result of one complete sweep.
+*/
+typedef struct
+{
+  uint32_t timestamp;             /**< Scheduler tick at start of sweep*/
+  uint64_t time;                  /**< RTC time at start of sweep in us since 2000*/
+  uint32_t sequence;              /**< Incremented on every sweep*/
+  uint32_t errors;                /**< Bit set for each channel that failed*/
+  uint32_t tempErrors;            /**< Bit set for each temperature sensor that failed*/
+  uint32_t adcFlags;              /**< ADCCAL drift flags at the sweep, 0 if the ADC is trusted*/
+  TELEMETRY_Measurement_TypeDef meas[TELEMETRY_NUM_CHANNELS];
+  int32_t temp[TELEMETRY_NUM_TEMPS]; /**< Temperature in mC*/
+} TELEMETRY_Snapshot_TypeDef;
+
+void TELEMETRY_Init(const uint32_t *senseResistors);
+
+TELEMETRY_Err_TypeDef TELEMETRY_Sweep(void);
+
+const TELEMETRY_Snapshot_TypeDef *TELEMETRY_GetSnapshot(void);
+
+INA226_TypeDef *TELEMETRY_GetSensor(TELEMETRY_Channel_TypeDef channel);
+
+TMP117_TypeDef *TELEMETRY_GetTempSensor(TELEMETRY_Temp_TypeDef temp);
+
+/**@}*/
+
+#endif /* DRIVERS_TELEMETRY_H_ */
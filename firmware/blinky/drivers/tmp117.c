@@ -0,0 +1,339 @@
+/** @file tmp117.c
+*   @brief TMP117 Driver Implementation File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+#include "tmp117.h"
+#include "port_i2c.h"
+#include "stdint.h"
+
+
+/*******************************************************************************
+ **************************   GLOBAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+void TMP117_Init(TMP117_TypeDef* const tmp117,
+              PORT_I2C_Reg_TypeDef *i2c,
+              TMP117_Address_TypeDef addr,
+              uint8_t muxChan,
+              TMP117_Err_TypeDef (*RegisterGet)(TMP117_TypeDef* const tmp117,
+                                                TMP117_Register_TypeDef reg,
+                                                uint16_t *val),
+              TMP117_Err_TypeDef (*RegisterSet)(TMP117_TypeDef* const tmp117,
+                                                TMP117_Register_TypeDef reg,
+                                                uint16_t val))
+{
+  /* initialize attributes */
+  tmp117->i2c = i2c;
+  tmp117->addr = addr;
+  tmp117->muxChan = muxChan;
+
+  /* initialize function pointers */
+  tmp117->RegisterGet = RegisterGet;
+  tmp117->RegisterSet = RegisterSet;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set content of a register.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[in] reg
+ *   Register to write.
+ *
+ * @param[in] val
+ *   Value written to the register.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_RegisterSet(TMP117_TypeDef* const tmp117,
+                         TMP117_Register_TypeDef reg,
+                         uint16_t val)
+{
+  uint8_t data[3];
+
+  data[0] = ((uint8_t)reg);
+  data[1] = (uint8_t)(val >> 8);
+  data[2] = (uint8_t)val;
+
+  return (TMP117_Err_TypeDef)PORT_I2C_Send(tmp117->i2c, tmp117->addr, 3, data);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get current content of a register.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[in] reg
+ *   Register to read.
+ *
+ * @param[out] val
+ *   Reference to place register read.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_RegisterGet(TMP117_TypeDef* const tmp117,
+                         TMP117_Register_TypeDef reg,
+                         uint16_t *val)
+{
+  uint8_t regid[1];
+  uint8_t data[2];
+
+  regid[0] = ((uint8_t)reg);
+
+  TMP117_Err_TypeDef ret = TMP117_Err_NoError;
+
+  /*****************************************/
+  //  Send address of register to be read
+  /*****************************************/
+
+  ret = (TMP117_Err_TypeDef)PORT_I2C_Send(tmp117->i2c, tmp117->addr, 1, regid);
+
+  if (ret != TMP117_Err_NoError)
+  {
+    return ret;
+  }
+
+  /*****************************************/
+  //  Start receving the data From Slave
+  /*****************************************/
+
+  ret = (TMP117_Err_TypeDef)PORT_I2C_Receive(tmp117->i2c, tmp117->addr, 2, data);
+
+  if (ret != TMP117_Err_NoError)
+  {
+    return ret;
+  }
+
+  /* Save result */
+  *val = (((uint16_t)(data[0])) << 8) | data[1];
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set conversion mode, cycle time and averaging.
+ *
+ * @details
+ *   - The alert pin is left as a data ready output, active low.
+ *   - The cycle time only applies to continuous mode. A result takes the
+ *     longer of the cycle time and the averaging time.
+ *   - Writing one-shot mode starts a conversion; the sensor shuts down when
+ *     it completes.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[in] mode
+ *   Conversion mode.
+ *
+ * @param[in] conv
+ *   Conversion cycle time.
+ *
+ * @param[in] avg
+ *   Conversions averaged per result.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_Configure(TMP117_TypeDef* const tmp117,
+                         TMP117_Mode_TypeDef mode,
+                         TMP117_Conv_TypeDef conv,
+                         TMP117_AVG_TypeDef avg)
+{
+  uint16_t config;
+
+  config = (uint16_t)((((uint32_t)mode << _TMP117_CONFIG_MOD_SHIFT) & _TMP117_CONFIG_MOD_MASK)
+                    | (((uint32_t)conv << _TMP117_CONFIG_CONV_SHIFT) & _TMP117_CONFIG_CONV_MASK)
+                    | (((uint32_t)avg << _TMP117_CONFIG_AVG_SHIFT) & _TMP117_CONFIG_AVG_MASK)
+                    | TMP117_CONFIG_DRALERT);
+
+  return tmp117->RegisterSet(tmp117,TMP117_RegConfig,config);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start a one-shot conversion.
+ *
+ * @details
+ *   The sensor draws its active current only for the averaging time and
+ *   shuts down afterwards. Poll TMP117_DataReady or read with
+ *   TMP117_ReadTempIfReady once the averaging time has passed.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[in] avg
+ *   Conversions averaged for the result.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_StartOneShot(TMP117_TypeDef* const tmp117,
+                         TMP117_AVG_TypeDef avg)
+{
+  return TMP117_Configure(tmp117,TMP117_ModeOneShot,TMP117_Conv1s,avg);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Poll the data ready flag.
+ *
+ * @details
+ *   Reading the configuration register clears the flag, a set flag must be
+ *   followed by a result read before the next poll.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[out] ready
+ *   Set to 1 if a new result is available, else 0.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_DataReady(TMP117_TypeDef* const tmp117,
+                         uint8_t *ready)
+{
+  TMP117_Err_TypeDef ret = TMP117_Err_NoError;
+  uint16_t tmp = 0;
+
+  ret = tmp117->RegisterGet(tmp117,TMP117_RegConfig,&tmp);
+
+  if (ret != TMP117_Err_NoError)
+  {
+    return ret;
+  }
+
+  *ready = (tmp & TMP117_CONFIG_DATAREADY) ? 1U : 0U;
+
+  return(ret);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read Temperature Result Register.
+ *
+ * @details
+ *   - Negative numbers are represented in two's complement format.
+ *   - If averaging is enabled, this register displays the averaged value.
+ *   - Full-scale range: -256 C (0x8000) to +255.99 C (0x7FFF).
+ *   - LSB represents 7.8125 mC.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[out] val
+ *   Reference to place register read.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_ReadTemp(TMP117_TypeDef* const tmp117,
+                         int *val)
+{
+  TMP117_Err_TypeDef ret = TMP117_Err_NoError;
+  uint16_t tmp = 0;
+
+  ret = tmp117->RegisterGet(tmp117,TMP117_RegTemp,&tmp);
+
+  if (ret != TMP117_Err_NoError)
+  {
+    return ret;
+  }
+
+  /* Register is two's complement */
+  *val = (int16_t)tmp;
+
+  return(ret);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read the Temperature Result Register if a new result is available.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[out] val
+ *   Reference to place register read, unchanged if not ready.
+ *
+ * @return
+ *   Returns 0 if a new result was read, TMP117_Err_NotReady if the
+ *   conversion has not completed.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_ReadTempIfReady(TMP117_TypeDef* const tmp117,
+                         int *val)
+{
+  TMP117_Err_TypeDef ret = TMP117_Err_NoError;
+  uint8_t ready = 0U;
+
+  ret = TMP117_DataReady(tmp117,&ready);
+
+  if (ret != TMP117_Err_NoError)
+  {
+    return ret;
+  }
+
+  if (!ready)
+  {
+    return TMP117_Err_NotReady;
+  }
+
+  return TMP117_ReadTemp(tmp117,val);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read Device ID Register.
+ *
+ * @param[in] tmp117
+ *  Pointer to TMP117 object.
+ *
+ * @param[out] val
+ *   Device ID, TMP117_DEVICEID for a TMP117.
+ *
+ * @return
+ *   Returns 0 if no error.
+ ******************************************************************************/
+TMP117_Err_TypeDef TMP117_ReadDeviceID(TMP117_TypeDef* const tmp117,
+                         int *val)
+{
+  TMP117_Err_TypeDef ret = TMP117_Err_NoError;
+  uint16_t tmp = 0;
+
+  ret = tmp117->RegisterGet(tmp117,TMP117_RegDeviceID,&tmp);
+
+  if (ret != TMP117_Err_NoError)
+  {
+    return ret;
+  }
+
+  *val = tmp & _TMP117_DEVICEID_DID_MASK;
+
+  return(ret);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert a temperature register value to millidegrees.
+ *
+ * @param[in] val
+ *   Temperature register value, sign extended.
+ *
+ * @return
+ *   Returns temperature in mC, truncated toward zero.
+ ******************************************************************************/
+int TMP117_TempToMC(int val)
+{
+  return (val * TMP117_TEMPLSB_NUM) / TMP117_TEMPLSB_DEN;
+}
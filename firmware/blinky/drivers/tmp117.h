@@ -0,0 +1,254 @@
+/** @file tmp117.h
+*   @brief TMP117 Driver Definition File
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*/
+
+/**
+ *  @defgroup TMP117 TMP117
+ *  @brief TMP117 Digital Temperature Sensor Module.
+ *
+ *  The TMP117 is a +/-0.1 C digital temperature sensor with an I2C
+ *  interface. It converts continuously, once per conversion cycle, or once
+ *  on request (one-shot) and shuts down in between. Each result can be the
+ *  average of 8, 32 or 64 conversions.
+ *
+ *  The data ready flag of the configuration register is set when a result
+ *  is available and cleared when the configuration or the result register
+ *  is read, so it can be polled without an alert pin.
+ *
+ *	Related Files
+ *   - tmp117.h
+ *   - tmp117.c
+ *   - port_i2c.h
+ *   - stdint.h
+ */
+
+#ifndef DRIVERS_TMP117_H_
+#define DRIVERS_TMP117_H_
+
+#include "port_i2c.h"
+#include "stdint.h"
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+#define TMP117_TEMPLSB_NUM  (125)   /* Temperature LSB is 125/16 mC (7.8125 mC) */
+#define TMP117_TEMPLSB_DEN  (16)
+
+#define TMP117_DEVICEID     (0x0117U) /* Device ID register, revision masked */
+
+ /* 7-bit I2C address of the TMP117 */
+                                   /* 	ADD0	*/
+                                   /* ------- */
+#define TMP117_ADDR48     (0x48U)  /* 	GND 	*/
+#define TMP117_ADDR49     (0x49U)  /* 	V+  	*/
+#define TMP117_ADDR4A     (0x4AU)  /* 	SDA 	*/
+#define TMP117_ADDR4B     (0x4BU)  /* 	SCL 	*/
+
+#define TMP117_CONFIG_SOFTRESET          (0x1UL << 1)
+#define _TMP117_CONFIG_SOFTRESET_SHIFT   1
+#define _TMP117_CONFIG_SOFTRESET_MASK    0x2UL
+#define TMP117_CONFIG_DRALERT            (0x1UL << 2)
+#define _TMP117_CONFIG_DRALERT_SHIFT     2
+#define _TMP117_CONFIG_DRALERT_MASK      0x4UL
+#define TMP117_CONFIG_POL                (0x1UL << 3)
+#define _TMP117_CONFIG_POL_SHIFT         3
+#define _TMP117_CONFIG_POL_MASK          0x8UL
+#define TMP117_CONFIG_TNA                (0x1UL << 4)
+#define _TMP117_CONFIG_TNA_SHIFT         4
+#define _TMP117_CONFIG_TNA_MASK          0x10UL
+#define TMP117_CONFIG_AVG                (0x3UL << 5)
+#define _TMP117_CONFIG_AVG_SHIFT         5
+#define _TMP117_CONFIG_AVG_MASK          0x60UL
+#define _TMP117_CONFIG_AVG_1SAMPLE       0x0UL
+#define _TMP117_CONFIG_AVG_8SAMPLES      0x1UL
+#define _TMP117_CONFIG_AVG_32SAMPLES     0x2UL
+#define _TMP117_CONFIG_AVG_64SAMPLES     0x3UL
+#define _TMP117_CONFIG_AVG_DEFAULT       (_TMP117_CONFIG_AVG_8SAMPLES)
+#define TMP117_CONFIG_AVG_1SAMPLE        (_TMP117_CONFIG_AVG_1SAMPLE << 5)
+#define TMP117_CONFIG_AVG_8SAMPLES       (_TMP117_CONFIG_AVG_8SAMPLES << 5)
+#define TMP117_CONFIG_AVG_32SAMPLES      (_TMP117_CONFIG_AVG_32SAMPLES << 5)
+#define TMP117_CONFIG_AVG_64SAMPLES      (_TMP117_CONFIG_AVG_64SAMPLES << 5)
+#define TMP117_CONFIG_AVG_DEFAULT        (_TMP117_CONFIG_AVG_DEFAULT << 5)
+#define TMP117_CONFIG_CONV               (0x7UL << 7)
+#define _TMP117_CONFIG_CONV_SHIFT        7
+#define _TMP117_CONFIG_CONV_MASK         0x380UL
+#define _TMP117_CONFIG_CONV_DEFAULT      0x4UL
+#define TMP117_CONFIG_CONV_DEFAULT       (_TMP117_CONFIG_CONV_DEFAULT << 7)
+#define TMP117_CONFIG_MOD                (0x3UL << 10)
+#define _TMP117_CONFIG_MOD_SHIFT         10
+#define _TMP117_CONFIG_MOD_MASK          0xC00UL
+#define _TMP117_CONFIG_MOD_CC            0x0UL
+#define _TMP117_CONFIG_MOD_SD            0x1UL
+#define _TMP117_CONFIG_MOD_OS            0x3UL
+#define _TMP117_CONFIG_MOD_DEFAULT       (_TMP117_CONFIG_MOD_CC)
+#define TMP117_CONFIG_MOD_CC             (_TMP117_CONFIG_MOD_CC << 10)
+#define TMP117_CONFIG_MOD_SD             (_TMP117_CONFIG_MOD_SD << 10)
+#define TMP117_CONFIG_MOD_OS             (_TMP117_CONFIG_MOD_OS << 10)
+#define TMP117_CONFIG_MOD_DEFAULT        (_TMP117_CONFIG_MOD_DEFAULT << 10)
+#define TMP117_CONFIG_EEPROMBUSY         (0x1UL << 12)
+#define _TMP117_CONFIG_EEPROMBUSY_SHIFT  12
+#define _TMP117_CONFIG_EEPROMBUSY_MASK   0x1000UL
+#define TMP117_CONFIG_DATAREADY          (0x1UL << 13)
+#define _TMP117_CONFIG_DATAREADY_SHIFT   13
+#define _TMP117_CONFIG_DATAREADY_MASK    0x2000UL
+#define TMP117_CONFIG_LOWALERT           (0x1UL << 14)
+#define _TMP117_CONFIG_LOWALERT_SHIFT    14
+#define _TMP117_CONFIG_LOWALERT_MASK     0x4000UL
+#define TMP117_CONFIG_HIGHALERT          (0x1UL << 15)
+#define _TMP117_CONFIG_HIGHALERT_SHIFT   15
+#define _TMP117_CONFIG_HIGHALERT_MASK    0x8000UL
+#define TMP117_DEVICEID_DID              (0xFFFUL << 0)
+#define _TMP117_DEVICEID_DID_SHIFT       0
+#define _TMP117_DEVICEID_DID_MASK        0xFFFUL
+
+/**
+ *  @addtogroup TMP117
+ *  @{
+ */
+
+/*******************************************************************************
+ ********************************   ENUMS   ************************************
+ ******************************************************************************/
+
+/** @enum TMP117_Address_TypeDef
+*   @brief Alias names for TMP117 I2C addresses.
+*/
+typedef enum
+{
+  TMP117_Addr48  =  TMP117_ADDR48, /**< ADD0=GND	*/
+  TMP117_Addr49  =  TMP117_ADDR49, /**< ADD0=V+	*/
+  TMP117_Addr4A  =  TMP117_ADDR4A, /**< ADD0=SDA	*/
+  TMP117_Addr4B  =  TMP117_ADDR4B  /**< ADD0=SCL	*/
+} TMP117_Address_TypeDef;
+
+/** @enum TMP117_Register_TypeDef
+*   @brief Alias names for TMP117 registers.
+*/
+typedef enum
+{
+  TMP117_RegTemp      =   0x00,  /**< Temperature result register (read-only)  */
+  TMP117_RegConfig    =   0x01,  /**< Configuration register                   */
+  TMP117_RegTHigh     =   0x02,  /**< High limit register                      */
+  TMP117_RegTLow      =   0x03,  /**< Low limit register                       */
+  TMP117_RegEEUnlock  =   0x04,  /**< EEPROM unlock register                   */
+  TMP117_RegEEPROM1   =   0x05,  /**< EEPROM 1 register                        */
+  TMP117_RegEEPROM2   =   0x06,  /**< EEPROM 2 register                        */
+  TMP117_RegOffset    =   0x07,  /**< Temperature offset register              */
+  TMP117_RegEEPROM3   =   0x08,  /**< EEPROM 3 register                        */
+  TMP117_RegDeviceID  =   0x0F   /**< Device ID register (read-only)           */
+} TMP117_Register_TypeDef;
+
+/** @enum TMP117_Mode_TypeDef
+*   @brief Alias names for TMP117 conversion modes.
+*/
+typedef enum
+{
+  TMP117_ModeContinuous =   _TMP117_CONFIG_MOD_CC,  /**< Continuous conversion (default) */
+  TMP117_ModeShutdown   =   _TMP117_CONFIG_MOD_SD,  /**< Shutdown                        */
+  TMP117_ModeOneShot    =   _TMP117_CONFIG_MOD_OS   /**< One conversion, then shutdown   */
+} TMP117_Mode_TypeDef;
+
+/** @enum TMP117_AVG_TypeDef
+*   @brief Alias names for TMP117 conversions averaged per result. A result
+*          takes 15.5 ms per conversion averaged.
+*/
+typedef enum
+{
+  TMP117_AVG1   =  _TMP117_CONFIG_AVG_1SAMPLE,    /**< 15.5 ms                     */
+  TMP117_AVG8   =  _TMP117_CONFIG_AVG_8SAMPLES,   /**< 125 ms (default)            */
+  TMP117_AVG32  =  _TMP117_CONFIG_AVG_32SAMPLES,  /**< 500 ms                      */
+  TMP117_AVG64  =  _TMP117_CONFIG_AVG_64SAMPLES   /**< 1 s                         */
+} TMP117_AVG_TypeDef;
+
+/** @enum TMP117_Conv_TypeDef
+*   @brief Alias names for TMP117 conversion cycle times in continuous mode.
+*          The cycle is never shorter than the averaging time.
+*/
+typedef enum
+{
+  TMP117_Conv15ms   =  0,
+  TMP117_Conv125ms  =  1,
+  TMP117_Conv250ms  =  2,
+  TMP117_Conv500ms  =  3,
+  TMP117_Conv1s     =  4,   /**< (default) */
+  TMP117_Conv4s     =  5,
+  TMP117_Conv8s     =  6,
+  TMP117_Conv16s    =  7
+} TMP117_Conv_TypeDef;
+
+/** @enum TMP117_Err_TypeDef
+*   @brief Alias names for TMP117 errors.
+*/
+typedef enum
+{
+  TMP117_Err_NoError   = 0U,                /**< No error*/
+  TMP117_Err_AL        = PORT_I2C_Err_AL,   /**< Arbitration lost*/
+  TMP117_Err_NACK      = PORT_I2C_Err_NACK, /**< No acknowledgment */
+  TMP117_Err_NotReady  = 4U                 /**< No new result since the last read*/
+} TMP117_Err_TypeDef;
+
+/*******************************************************************************
+ *****************************   PROTOTYPES   **********************************
+ ******************************************************************************/
+
+typedef struct TMP117 TMP117_TypeDef;
+struct TMP117 {
+  PORT_I2C_Reg_TypeDef *i2c;
+  TMP117_Address_TypeDef addr;
+  uint8_t muxChan;
+  TMP117_Err_TypeDef (*RegisterSet)(TMP117_TypeDef *const tmp117,
+                                    TMP117_Register_TypeDef reg,
+                                    uint16_t val);
+  TMP117_Err_TypeDef (*RegisterGet)(TMP117_TypeDef *const tmp117,
+                                    TMP117_Register_TypeDef reg,
+                                    uint16_t *val);
+};
+
+void TMP117_Init(TMP117_TypeDef* const tmp117,
+              PORT_I2C_Reg_TypeDef *i2c,
+              TMP117_Address_TypeDef addr,
+              uint8_t muxChan,
+              TMP117_Err_TypeDef (*RegisterGet)(TMP117_TypeDef* const tmp117,
+                                                TMP117_Register_TypeDef reg,
+                                                uint16_t *val),
+              TMP117_Err_TypeDef (*RegisterSet)(TMP117_TypeDef* const tmp117,
+                                                TMP117_Register_TypeDef reg,
+                                                uint16_t val));
+
+TMP117_Err_TypeDef TMP117_RegisterGet(TMP117_TypeDef *const tmp117,
+                         TMP117_Register_TypeDef reg,
+                         uint16_t *val);
+
+TMP117_Err_TypeDef TMP117_RegisterSet(TMP117_TypeDef *const tmp117,
+                         TMP117_Register_TypeDef reg,
+                         uint16_t val);
+
+TMP117_Err_TypeDef TMP117_Configure(TMP117_TypeDef *const tmp117,
+                         TMP117_Mode_TypeDef mode,
+                         TMP117_Conv_TypeDef conv,
+                         TMP117_AVG_TypeDef avg);
+
+TMP117_Err_TypeDef TMP117_StartOneShot(TMP117_TypeDef *const tmp117,
+                         TMP117_AVG_TypeDef avg);
+
+TMP117_Err_TypeDef TMP117_DataReady(TMP117_TypeDef *const tmp117,
+                         uint8_t *ready);
+
+TMP117_Err_TypeDef TMP117_ReadTemp(TMP117_TypeDef *const tmp117,
+                         int *val);
+
+TMP117_Err_TypeDef TMP117_ReadTempIfReady(TMP117_TypeDef *const tmp117,
+                         int *val);
+
+TMP117_Err_TypeDef TMP117_ReadDeviceID(TMP117_TypeDef *const tmp117,
+                         int *val);
+
+int TMP117_TempToMC(int val);
+
+/**@}*/
+
+#endif /* DRIVERS_TMP117_H_ */
@@ -62,6 +62,27 @@
 #include "tca9548a.h"
 #include "ina226.h"
 #include "low_power_mode.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "profile.h"
+#include "idle.h"
+#include "governor.h"
+#include "ad5324.h"
+#include "mppt.h"
+#include "ivsweep.h"
+#include "battery.h"
+#include "policy.h"
+#include "rv3032c7.h"
+#include "flashlog.h"
+#include "history.h"
+#include "config.h"
+#include "canpub.h"
+#include "cancmd.h"
+#include "csp.h"
+#include "canbench.h"
+#include "adcacq.h"
+#include "adccal.h"
+#include "tasks.h"
 /* USER CODE END */
 
 /** @fn void main(void)
@@ -84,6 +105,15 @@ void rtiNotification(uint32_t notification);
 void ssiInterrupt(void);
 void PORT_UART_ISR(PORT_UART_Reg_TypeDef *uart, uint32_t flags);
 
+TASKS_TABLE(TASKS_PROTOTYPE)
+static void idleHook(void);
+
+/* Scheduler task table, see tasks.h */
+static const SCHEDULER_Task_TypeDef taskTable[TASKS_NUM_TASKS] =
+{
+    TASKS_TABLE(TASKS_ENTRY)
+};
+
 /* USER CODE END */
 
 int main(void)
@@ -92,13 +122,6 @@ int main(void)
 
     /* Initialize necessary peripherals and configurations */
 
-    INA226_TypeDef *battery_bus_sensor;
-    
-    battery_bus_sensor = INA226_Create(i2cREG1,
-                                    EPS_BATBUS_I2CADDR,
-                                    EPS_BATBUS_MUXCHAN,
-                                    EPS_BATBUS_SENSERESISTOR);
-
     rtiInit();
     i2cInit();
 
@@ -111,29 +134,75 @@ int main(void)
     /* Set direction for I2C_MUX_nRESET and LED pins */
     gioSetDirection(EPS_GPIO_LED_PORT, (1<<EPS_GPIO_LED_PIN) | (1<<EPS_GPIO_I2CMUXRESET_PIN));
 
-    /* Enable RTI Compare 0 interrupt notification and start RTI counters */
-    rtiEnableNotification(rtiNOTIFICATION_COMPARE0);
-    rtiStartCounter(rtiCOUNTER_BLOCK0);
+    /* Start PMU cycle counter for profiling hooks */
+    PROFILE_Init();
+
+    /* Load the task table first, modules release their on demand tasks
+     * from init */
+    SCHEDULER_Init(taskTable, TASKS_NUM_TASKS);
+    SCHEDULER_SetIdleHook(idleHook);
+
+    /* Load limits, calibration and parameters from data flash */
+    CONFIG_Init();
+
+    /* Set up power monitors and release I2C mux from reset */
+    TELEMETRY_Init(CONFIG_Get()->senseResistor);
+
+    /* Correlate the RTC with the RTI counter for telemetry timestamps */
+    RV3032C7_Init(PORT_I2C, EPS_RTC_I2CADDR, EPS_RTC_MUXCHAN);
+
+    /* Find the head of the telemetry log and resume its last checkpoint */
+    FLASHLOG_Init();
+
+    /* Start tracking on every panel input from the open circuit end */
+    AD5324_Init();
+    MPPT_Init(&CONFIG_Get()->mppt, 0, 0, 0);
+    IVSWEEP_Init();
+
+    /* Estimate battery state of charge from the battery bus monitor */
+    BATTERY_Init((BATTERY_Chemistry_TypeDef)CONFIG_Get()->chemistry, 0);
+
+    /* Sample the pack voltage with MibADC1 on every tick, a low crossing
+     * trips survival in the policy at once */
+    ADCACQ_Init(0, POLICY_Threshold);
+
+    /* Correct its offset and gain, self-tested again while idle */
+    ADCCAL_Init(0, 0);
+
+    /* Command every output on and start the power policy rules, no load
+     * switch is wired yet so the outputs are not driven */
+    POLICY_Init(CONFIG_GetRules(), POLICY_NumDefaultRules, 0);
+    POLICY_SetProfileDividers(CONFIG_Get()->profileDivider);
+    POLICY_SetOutputPriorities(CONFIG_Get()->outputPriority);
+
+    /* Publish the telemetry snapshot on CAN */
+    CANPUB_Init(0, 0, 0, TASKS_Id_CANPUB);
+
+    /* Accept console commands over CAN */
+    CANCMD_Init(0, 0, TASKS_Id_CANCMD);
+
+    /* Serve CSP packets over CAN */
+    CSP_Init(0, 0, TASKS_Id_CSP);
+    CANBENCH_Init(TASKS_Id_CANBENCH);
+
+    /* Calibrate LF LPO and map the RTI Compare 1 wakeup */
+    IDLE_Init(0);
+
+    /* Scale clocks with the load from here on, starting at full speed */
+    GOVERNOR_Init(&CONFIG_Get()->governor);
+
+    /* Start scheduler tick on RTI Compare 0 and start RTI counter 1 */
+    SCHEDULER_Start();
     rtiStartCounter(rtiCOUNTER_BLOCK1);
 
     _enable_IRQ();
 
-    // Set HET1_26 (I2C_MUX_nRESET) to high
-    gioSetBit(EPS_GPIO_I2CMUXRESET_PORT, EPS_GPIO_I2CMUXRESET_PIN, 1);
-    TCA9548A_RegisterSet(i2cREG1, EPS_MUX1_I2CADDR, EPS_BATBUS_MUXCHAN);
-    uint16_t voltage = 0;
-    uint16_t shunt_voltage = 0;
-    battery_bus_sensor->RegisterGet(battery_bus_sensor, INA226_RegBusV, &voltage);
-    battery_bus_sensor->RegisterGet(battery_bus_sensor, INA226_RegShuntV, &shunt_voltage);
-    // Clear HET1_26 (I2C_MUX_nRESET) to low
-    gioSetBit(EPS_GPIO_I2CMUXRESET_PORT, EPS_GPIO_I2CMUXRESET_PIN, 0);
-
     PORT_UART_Receive(PORT_UART_UART0,1,&uartRxData);
 
-    /* Run forever */
+    /* Run released tasks forever, sleeping until the next release */
     while (1)
     {
-        /* Do nothing...*/
+        SCHEDULER_Dispatch();
     }
 
 /* USER CODE END */
@@ -146,56 +215,150 @@ int main(void)
 
 void rtiNotification(uint32_t notification)
 {
+    PROFILE_BEGIN(PROFILE_Scope_RtiIsr);
+
     if(notification == rtiNOTIFICATION_COMPARE0)
     {
-        /* Toggle HET1_16 (LED) */
-        gioSetPort(EPS_GPIO_LED_PORT, gioGetPort(EPS_GPIO_LED_PORT) ^ (1<<EPS_GPIO_LED_PIN));
+        SCHEDULER_Tick();
+    }
+
+    PROFILE_END(PROFILE_Scope_RtiIsr);
+}
+
+static void housekeepingTask(void)
+{
+    /* Toggle HET1_16 (LED) */
+    gioSetPort(EPS_GPIO_LED_PORT, gioGetPort(EPS_GPIO_LED_PORT) ^ (1<<EPS_GPIO_LED_PIN));
+}
 
+static void telemetryTask(void)
+{
+    /* The acquisition profile of the power policy sets the sweep rate */
+    if (POLICY_SweepDue())
+    {
+        TELEMETRY_Sweep();
     }
 }
 
+static void governorTask(void)
+{
+    GOVERNOR_Update();
+}
+
+static void mpptTask(void)
+{
+    MPPT_Update();
+}
+
+static void ivsweepTask(void)
+{
+    IVSWEEP_Update();
+}
+
+static void batteryTask(void)
+{
+    BATTERY_Update();
+}
+
+static void policyTask(void)
+{
+    POLICY_Update();
+}
+
+static void rtcTask(void)
+{
+    RV3032C7_Sync();
+}
+
+static void flashlogTask(void)
+{
+    FLASHLOG_Update();
+}
+
+static void historyTask(void)
+{
+    HISTORY_Update();
+}
+
+static void configTask(void)
+{
+    CONFIG_Update();
+}
+
+static void canpubTask(void)
+{
+    CANPUB_Update();
+}
+
+static void cancmdTask(void)
+{
+    CANCMD_Update();
+}
+
+static void cspTask(void)
+{
+    CSP_Update();
+}
+
+static void canbenchTask(void)
+{
+    CANBENCH_Update();
+}
+
+static void adcacqTask(void)
+{
+    ADCACQ_Update();
+}
+
+static void idleHook(void)
+{
+    /* Recalibrate the ADC before the gap to the next release is slept */
+    ADCCAL_Idle();
+    IDLE_Enter();
+}
+
 #pragma INTERRUPT(ssiInterrupt, IRQ)
 void ssiInterrupt(void)
 {
 
-    static char * function;
-    static char * arg[EPS_MAX_ARGS];
-    static uint8_t i = 0;
+    uint32_t vector = systemREG1->SSIVEC & 0xFFU;
+    PROFILE_BEGIN(PROFILE_Scope_SsiIsr);
 
-    if (systemREG1->SSIVEC & 0x1U )
+    /* Console, CANCMD and CSP commands share this interrupt so they never overlap */
+    if (vector == 1U || vector == CANCMD_SSI || vector == CSP_SSI)
     {
-        /* Extract function name from command string */
-        function = strtok(CommandString,"(");
-
-        /* Extract arguments from command string */
-        for(i = 0; i<EPS_MAX_ARGS; i++)
+        PROFILE_BEGIN(PROFILE_Scope_Command);
+        GOVERNOR_Request(GOVERNOR_Client_Command, GOVERNOR_Level_Max);
+        if (vector == 1U)
         {
-            arg[i] = strtok(NULL,",");
-            if (arg[i] == NULL) break;
+            EPS_runCommandString(PORT_UART_UART0, CommandString);
         }
-        i = i - 1;
-        arg[i] = strtok(arg[i],")");
-
-        /* Split argument strings into individual arguments */
-        for(i = 0; arg[i]!=NULL && i<EPS_MAX_ARGS; i++)
+        else if (vector == CANCMD_SSI)
         {
-            arg[i] = strtok(arg[i]," ");
-
+            CANCMD_Execute();
         }
-
-        /* Call the EPS_runCommand function with the parsed command */
-        EPS_runCommand(function,arg,i);
-
+        else
+        {
+            CSP_Execute();
+        }
+        GOVERNOR_Release(GOVERNOR_Client_Command);
+        PROFILE_END(PROFILE_Scope_Command);
     }
+
+    PROFILE_END(PROFILE_Scope_SsiIsr);
 }
 
 void PORT_UART_ISR(PORT_UART_Reg_TypeDef *uart, uint32_t flags)
 {
     static uint8_t i = 0;
     static bool commandReceived = false;
+    PROFILE_BEGIN(PROFILE_Scope_UartIsr);
 
     if(flags & PORT_UART_Flags_RX)
     {
+        /* Stay out of doze and snooze while the console is in use */
+        IDLE_Hold(IDLE_CONSOLE_HOLD);
+
         if (uartRxData == '\r' || uartRxData == '\n')
         {
             if (commandReceived)
@@ -219,10 +382,7 @@ void PORT_UART_ISR(PORT_UART_Reg_TypeDef *uart, uint32_t flags)
         else if (!receiveBuffer->isFull(receiveBuffer))
         {
             /* Convert lowercase characters to uppercase */
-            if (uartRxData >= 'a' && uartRxData <= 'z')
-            {
-                uartRxData = uartRxData - 0x20;
-            }
+            uartRxData = EPS_UPPER(uartRxData);
 
             /* Insert received character into the receive buffer */
             receiveBuffer->insert(receiveBuffer, uartRxData);
@@ -234,6 +394,8 @@ void PORT_UART_ISR(PORT_UART_Reg_TypeDef *uart, uint32_t flags)
         /* Receive next character */
         PORT_UART_Receive(uart,1,&uartRxData);
     }
+
+    PROFILE_END(PROFILE_Scope_UartIsr);
 }
 
 /* USER CODE END */
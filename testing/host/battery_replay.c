@@ -0,0 +1,563 @@
+/** @file battery_replay.c
+*   @brief Host replay of the battery state of charge estimator
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*   Runs the firmware battery.c and print.c unmodified through
+*   BATTERY_Step, with samples either read from a recorded log or generated
+*   by a reference cell model, and compares the estimate with the reference
+*   state of charge.
+*
+*   Log format, one sample per line, pack values, a header line is skipped:
+*
+*     time_s,voltage_V,current_A,temp_C[,soc]
+*
+*   Current is positive charging. The optional soc column (0 to 1) is the
+*   reference, e.g. from a cycler's coulomb count started at full charge;
+*   without it the estimate is only printed.
+*
+*   Reference model: the cell of the chemistry table with the errors the
+*   filter has to live with, a capacity 5 % low, R0 10 % high, a second RC
+*   pair of 600 s next to one of 20 s, a 5 mV open circuit voltage offset
+*   and charge/discharge hysteresis. The pack follows a 95 min LEO orbit, 60 min
+*   of sunlight charging at 0.3 C with a constant voltage limit and 35 min
+*   of eclipse at 0.2 C with 0.6 C pulses. The battery bus INA226 is
+*   modelled with its bus and shunt LSB, noise and a 2 mA current offset,
+*   one sample per second with 1 % of the samples lost.
+*
+*   Build and run from this directory:
+*
+*     gcc -O2 -Wall -DPROFILE_ENABLE=0
+*         -I../../firmware/blinky/include
+*         -I../../firmware/blinky/drivers
+*         battery_replay.c ../../firmware/blinky/drivers/battery.c
+*         ../../firmware/blinky/drivers/print.c
+*         -lm -o battery_replay && ./battery_replay
+*
+*   Options:
+*     -f <file>   Replay a recorded log instead of the model scenarios
+*     -c <name>   Chemistry of the log, NMC or LFP (default NMC)
+*     -w <file>   Write the first model scenario as a log
+*     -t <file>   Write a per sample trace of every run as CSV
+*
+*   Exits with a non-zero status if the estimate misses its error limit
+*   once settled, or if fewer than SIM_MIN_WITHIN of the settled errors are
+*   within three of the reported sigma.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "battery.h"
+#include "telemetry.h"
+#include "print.h"
+
+#define SIM_PI              (3.14159265358979)
+
+/* INA226 on the battery bus */
+#define SIM_SENSE_OHM       (0.005)
+#define SIM_BUS_LSB         (1.25e-3)
+#define SIM_CURR_LSB        (2.5e-6 / SIM_SENSE_OHM)
+#define SIM_BUS_NOISE       (0.5)             /* LSB rms */
+#define SIM_CURR_NOISE      (1.0)             /* LSB rms */
+#define SIM_CURR_OFFSET     (0.002)           /* A */
+
+/* Orbit */
+#define SIM_ORBIT           (95.0 * 60.0)     /* s */
+#define SIM_SUNLIT          (60.0 * 60.0)     /* s */
+#define SIM_CHARGE_C        (0.3)
+#define SIM_ECLIPSE_C       (0.2)
+#define SIM_PULSE_C         (0.6)
+#define SIM_PULSE_PERIOD    (300.0)           /* s */
+#define SIM_PULSE_LENGTH    (10.0)            /* s */
+#define SIM_LOSS            (0.01)            /* Fraction of samples lost */
+#define SIM_MIN_WITHIN      (0.95)            /* Least fraction within 3 sigma */
+
+/* Reference cell against the chemistry table */
+#define SIM_CAPACITY_SCALE  (0.95)
+#define SIM_R0_SCALE        (1.1)
+#define SIM_R2_SCALE        (0.5)
+#define SIM_OCV_OFFSET      (0.005)           /* V */
+
+/* Estimate of a log is checked after this long */
+#define SIM_SETTLE          (SIM_ORBIT)
+
+typedef struct
+{
+  const char *name;
+  BATTERY_Chemistry_TypeDef chemistry;
+  double soc0;                      /* Reference start state of charge */
+  double v0;                        /* Start polarization per cell in V */
+  double temp;                      /* Mean temperature in C */
+  double tempSwing;                 /* Orbit temperature amplitude in C */
+  double vMax;                      /* Charge voltage limit per cell */
+  double hysteresis;                /* Open circuit hysteresis in V */
+  uint32_t orbits;
+  uint32_t settle;                  /* Orbits before the error is checked*/
+  double limit;                     /* Largest error once settled */
+} SimScenario;
+
+static const SimScenario SimScenarios[] =
+{
+  { "NMC 15 C, from 55 %",          BATTERY_Chemistry_NMC, 0.55,  0.000, 15.0, 10.0, 4.15, 0.010, 12U, 1U, 0.030 },
+  { "NMC 0 C, from 85 %",           BATTERY_Chemistry_NMC, 0.85,  0.000,  0.0,  5.0, 4.15, 0.010, 12U, 1U, 0.030 },
+  { "NMC 20 C, polarized at 30 %",  BATTERY_Chemistry_NMC, 0.30, -0.060, 20.0,  5.0, 4.15, 0.010, 12U, 1U, 0.030 },
+  /* The LFP plateau hides the start error until the first charge reaches
+   * the knee at the top */
+  { "LFP 15 C, from 50 %",          BATTERY_Chemistry_LFP, 0.50,  0.000, 15.0, 10.0, 3.55, 0.015, 12U, 2U, 0.030 }
+};
+
+#define SIM_NUM_SCENARIOS   (sizeof(SimScenarios) / sizeof(SimScenarios[0]))
+
+typedef struct
+{
+  double soc;
+  double v1;
+  double v2;
+  double h;
+} SimCell;
+
+static TELEMETRY_Snapshot_TypeDef SimSnapshot;
+static uint64_t SimRandom = 0x9E3779B97F4A7C15ULL;
+static FILE *SimTrace = 0;
+
+/*******************************************************************************
+ ****************************   FIRMWARE STUBS   *******************************
+ ******************************************************************************/
+
+const TELEMETRY_Snapshot_TypeDef *TELEMETRY_GetSnapshot(void)
+{
+  return &SimSnapshot;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_SendByte(PORT_UART_Reg_TypeDef *uart,
+                                         char data)
+{
+  (void)uart;
+  putchar(data);
+  return PORT_UART_Err_NoError;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_Send(PORT_UART_Reg_TypeDef *uart,
+                                     uint32_t length,
+                                     char *data)
+{
+  (void)uart;
+  fwrite(data, 1U, length, stdout);
+  return PORT_UART_Err_NoError;
+}
+
+/*******************************************************************************
+ ******************************   CELL MODEL   *********************************
+ ******************************************************************************/
+
+static double SimUniform(void)
+{
+  SimRandom ^= SimRandom << 13;
+  SimRandom ^= SimRandom >> 7;
+  SimRandom ^= SimRandom << 17;
+  return (double)(SimRandom >> 11) / 9007199254740992.0;
+}
+
+static double SimGauss(void)
+{
+  double u1 = SimUniform();
+  double u2 = SimUniform();
+
+  if ( u1 < 1e-300 )
+  {
+    u1 = 1e-300;
+  }
+
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * SIM_PI * u2);
+}
+
+static double SimOcv(const BATTERY_Cell_TypeDef *cell, double soc)
+{
+  double x = soc * (BATTERY_OCV_POINTS - 1U);
+  int i = (int)x;
+
+  if ( i < 0 )
+  {
+    i = 0;
+  }
+  if ( i > (int)BATTERY_OCV_POINTS - 2 )
+  {
+    i = (int)BATTERY_OCV_POINTS - 2;
+  }
+
+  return cell->ocv[i] + (x - i) * (cell->ocv[i + 1] - cell->ocv[i]) + SIM_OCV_OFFSET;
+}
+
+/* Terminal voltage of one cell at a current */
+static double SimTerminal(const BATTERY_Cell_TypeDef *cell, const SimCell *c,
+                          double i, double temp)
+{
+  double cold = (temp < 25.0) ? 25.0 - temp : 0.0;
+  double r0 = SIM_R0_SCALE * cell->r0 * (1.0 + cell->resistanceTc * cold);
+
+  return SimOcv(cell, c->soc) + c->h + c->v1 + c->v2 + r0 * i;
+}
+
+/* Advance one cell by dt at a constant current */
+static void SimAdvance(const BATTERY_Cell_TypeDef *cell, const SimScenario *sc,
+                       SimCell *c, double i, double temp, double dt)
+{
+  double cold = (temp < 25.0) ? 25.0 - temp : 0.0;
+  double scale = 1.0 + cell->resistanceTc * cold;
+  double q = SIM_CAPACITY_SCALE * cell->capacity * 3600.0 * (1.0 - cell->capacityTc * cold);
+  double r1 = cell->r1 * scale;
+  double r2 = SIM_R2_SCALE * cell->r1 * scale;
+  double a1 = exp(-dt / 20.0);
+  double a2 = exp(-dt / 600.0);
+  double target = (i > 0.0) ? sc->hysteresis : ((i < 0.0) ? -sc->hysteresis : c->h);
+
+  c->soc += ((i > 0.0) ? 0.99 : 1.0) * i * dt / q;
+  c->v1 = a1 * c->v1 + (1.0 - a1) * r1 * i;
+  c->v2 = a2 * c->v2 + (1.0 - a2) * r2 * i;
+  /* Hysteresis moves over about 5 % of charge throughput */
+  c->h += (target - c->h) * (1.0 - exp(-fabs(i) * dt / (0.05 * q)));
+
+  if ( c->soc < 0.0 )
+  {
+    c->soc = 0.0;
+  }
+  if ( c->soc > 1.0 )
+  {
+    c->soc = 1.0;
+  }
+}
+
+/* Orbit current per cell at time t, constant voltage limited while charging */
+static double SimCurrent(const BATTERY_Cell_TypeDef *cell, const SimScenario *sc,
+                         const SimCell *c, double t, double temp)
+{
+  double phase = fmod(t, SIM_ORBIT);
+  double cold = (temp < 25.0) ? 25.0 - temp : 0.0;
+  double r0 = SIM_R0_SCALE * cell->r0 * (1.0 + cell->resistanceTc * cold);
+  double i;
+  double limit;
+
+  if ( phase < SIM_SUNLIT )
+  {
+    i = SIM_CHARGE_C * cell->capacity;
+    limit = (sc->vMax - SimTerminal(cell, c, 0.0, temp)) / r0;
+    if ( limit < i )
+    {
+      i = (limit > 0.0) ? limit : 0.0;
+    }
+    return i;
+  }
+
+  i = -SIM_ECLIPSE_C * cell->capacity;
+  if ( fmod(phase - SIM_SUNLIT, SIM_PULSE_PERIOD) < SIM_PULSE_LENGTH )
+  {
+    i -= SIM_PULSE_C * cell->capacity;
+  }
+
+  return i;
+}
+
+static int32_t SimQuantise(double val, double lsb, double noise)
+{
+  return (int32_t)lround(val / lsb + noise * SimGauss());
+}
+
+/*******************************************************************************
+ ********************************   RUNS   *************************************
+ ******************************************************************************/
+
+typedef struct
+{
+  uint32_t samples;
+  uint32_t checked;
+  double maxErr;
+  double sumSq;
+  double maxCc;
+  double sumSqCc;
+  uint32_t within;
+  double finalErr;
+  double cpuNs;
+} SimStats;
+
+static double SimNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Feed one sample and account the error against a reference, if any */
+static void SimFeed(SimStats *st, const char *name, const BATTERY_Sample_TypeDef *sample,
+                    double t, double ref, int check)
+{
+  const BATTERY_State_TypeDef *s = BATTERY_GetState();
+  double t0;
+  double ns;
+  double err;
+  double errCc;
+
+  t0 = SimNow();
+  (void)BATTERY_Step(sample);
+  ns = SimNow() - t0;
+  st->cpuNs += ns;
+  st->samples++;
+
+  if ( SimTrace != 0 )
+  {
+    fprintf(SimTrace, "\"%s\",%.0f,%.4f,%.4f,%.3f,%.4f,%.3f,%.3f,%.3f\n",
+            name, t, sample->voltage * 1e-6, sample->current * 1e-6,
+            sample->temperature * 1e-3, ref, s->soc * 1e-3,
+            s->socSigma * 1e-3, s->socCoulomb * 1e-3);
+  }
+
+  if ( ref < 0.0 || !check )
+  {
+    return;
+  }
+
+  err = fabs(s->soc * 1e-3 - ref);
+  errCc = fabs(s->socCoulomb * 1e-3 - ref);
+
+  st->checked++;
+  st->sumSq += err * err;
+  st->sumSqCc += errCc * errCc;
+  st->finalErr = s->soc * 1e-3 - ref;
+  if ( err > st->maxErr )
+  {
+    st->maxErr = err;
+  }
+  if ( errCc > st->maxCc )
+  {
+    st->maxCc = errCc;
+  }
+  if ( err <= 3.0 * s->socSigma * 1e-3 + 0.001 )
+  {
+    st->within++;
+  }
+}
+
+static void SimReport(const SimStats *st)
+{
+  printf("  %u samples, %.0f ns per update on this host\n",
+         st->samples, st->cpuNs / st->samples);
+  if ( st->checked == 0U )
+  {
+    return;
+  }
+  printf("  EKF   max %5.2f %%  rms %5.2f %%  final %+5.2f %%  within 3 sigma %5.1f %%\n",
+         100.0 * st->maxErr, 100.0 * sqrt(st->sumSq / st->checked),
+         100.0 * st->finalErr, 100.0 * st->within / st->checked);
+  printf("  CC    max %5.2f %%  rms %5.2f %%\n",
+         100.0 * st->maxCc, 100.0 * sqrt(st->sumSqCc / st->checked));
+}
+
+static int RunScenario(const SimScenario *sc, FILE *log)
+{
+  const BATTERY_Cell_TypeDef *cell = &BATTERY_Cells[sc->chemistry];
+  BATTERY_Sample_TypeDef sample;
+  SimStats st;
+  SimCell c;
+  double duration = sc->orbits * SIM_ORBIT;
+  double t;
+  double temp;
+  double i;
+  double v;
+  int fail;
+
+  memset(&st, 0, sizeof(st));
+  memset(&c, 0, sizeof(c));
+  c.soc = sc->soc0;
+  c.v1 = sc->v0;
+  c.v2 = sc->v0;
+
+  (void)BATTERY_Init(sc->chemistry, 0);
+
+  if ( log != 0 )
+  {
+    fprintf(log, "time_s,voltage_V,current_A,temp_C,soc\n");
+  }
+
+  for ( t = 0.0; t < duration; t += 1.0 )
+  {
+    temp = sc->temp + sc->tempSwing * sin(2.0 * SIM_PI * t / SIM_ORBIT);
+    i = SimCurrent(cell, sc, &c, t, temp);
+    v = SimTerminal(cell, &c, i, temp);
+
+    if ( t > 0.0 && SimUniform() < SIM_LOSS )
+    {
+      SimAdvance(cell, sc, &c, i, temp, 1.0);
+      continue;
+    }
+
+    sample.timestamp = (uint32_t)(t * 1000.0);
+    sample.voltage = (int32_t)(SimQuantise(v * BATTERY_CELLS_SERIES, SIM_BUS_LSB, SIM_BUS_NOISE)
+                               * SIM_BUS_LSB * 1e6);
+    sample.current = (int32_t)(SimQuantise(i * BATTERY_CELLS_PARALLEL + SIM_CURR_OFFSET,
+                                           SIM_CURR_LSB, SIM_CURR_NOISE) * SIM_CURR_LSB * 1e6);
+    sample.temperature = (int32_t)(temp * 1000.0);
+
+    if ( log != 0 )
+    {
+      fprintf(log, "%.0f,%.6f,%.6f,%.3f,%.5f\n", t, sample.voltage * 1e-6,
+              sample.current * 1e-6, temp, c.soc);
+    }
+
+    SimFeed(&st, sc->name, &sample, t, c.soc, t >= sc->settle * SIM_ORBIT);
+    SimAdvance(cell, sc, &c, i, temp, 1.0);
+  }
+
+  fail = (st.maxErr > sc->limit)
+      || (st.checked > 0U && st.within < SIM_MIN_WITHIN * st.checked);
+
+  printf("%s, %u orbits, checked from orbit %u: %s\n",
+         sc->name, sc->orbits, sc->settle + 1U, fail ? "FAIL" : "ok");
+  SimReport(&st);
+  printf("  ");
+  BATTERY_PrintStats(PORT_UART_UART0);
+
+  return fail;
+}
+
+static int RunLog(const char *path, BATTERY_Chemistry_TypeDef chemistry)
+{
+  BATTERY_Sample_TypeDef sample;
+  SimStats st;
+  char line[256];
+  double t;
+  double v;
+  double i;
+  double temp;
+  double ref;
+  double t0 = -1.0;
+  int n;
+  FILE *f = fopen(path, "r");
+
+  if ( f == 0 )
+  {
+    printf("cannot open %s\n", path);
+    return 2;
+  }
+
+  memset(&st, 0, sizeof(st));
+  (void)BATTERY_Init(chemistry, 0);
+
+  while ( fgets(line, sizeof(line), f) != 0 )
+  {
+    ref = -1.0;
+    n = sscanf(line, "%lf,%lf,%lf,%lf,%lf", &t, &v, &i, &temp, &ref);
+    if ( n < 4 )
+    {
+      continue;
+    }
+    if ( t0 < 0.0 )
+    {
+      t0 = t;
+    }
+
+    sample.timestamp = (uint32_t)((t - t0) * 1000.0);
+    sample.voltage = (int32_t)(v * 1e6);
+    sample.current = (int32_t)(i * 1e6);
+    sample.temperature = (int32_t)(temp * 1000.0);
+
+    SimFeed(&st, path, &sample, t - t0, (n == 5) ? ref : -1.0, t - t0 >= SIM_SETTLE);
+  }
+
+  fclose(f);
+
+  printf("%s, %s:\n", path, BATTERY_Cells[chemistry].name);
+  SimReport(&st);
+  printf("  ");
+  BATTERY_PrintStats(PORT_UART_UART0);
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  BATTERY_Chemistry_TypeDef chemistry = BATTERY_Chemistry_NMC;
+  const char *replay = 0;
+  FILE *log = 0;
+  int failures = 0;
+  uint32_t s;
+  int a;
+
+  for ( a = 1; a < argc; a++ )
+  {
+    if ( !strcmp(argv[a], "-f") && a + 1 < argc )
+    {
+      replay = argv[++a];
+    }
+    else if ( !strcmp(argv[a], "-c") && a + 1 < argc )
+    {
+      a++;
+      for ( s = 0U; s < BATTERY_NUM_CHEMISTRIES; s++ )
+      {
+        if ( !strcmp(argv[a], BATTERY_Cells[s].name) )
+        {
+          chemistry = (BATTERY_Chemistry_TypeDef)s;
+          break;
+        }
+      }
+      if ( s == BATTERY_NUM_CHEMISTRIES )
+      {
+        printf("unknown chemistry %s\n", argv[a]);
+        return 2;
+      }
+    }
+    else if ( !strcmp(argv[a], "-w") && a + 1 < argc )
+    {
+      log = fopen(argv[++a], "w");
+      if ( log == 0 )
+      {
+        printf("cannot open %s\n", argv[a]);
+        return 2;
+      }
+    }
+    else if ( !strcmp(argv[a], "-t") && a + 1 < argc )
+    {
+      SimTrace = fopen(argv[++a], "w");
+      if ( SimTrace == 0 )
+      {
+        printf("cannot open %s\n", argv[a]);
+        return 2;
+      }
+      fprintf(SimTrace, "run,t,v,i,temp,ref,soc,sigma,cc\n");
+    }
+    else
+    {
+      printf("usage: %s [-f log.csv [-c NMC|LFP]] [-w log.csv] [-t trace.csv]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  printf("%u S %u P pack, 1 s samples\n", BATTERY_CELLS_SERIES, BATTERY_CELLS_PARALLEL);
+
+  if ( replay != 0 )
+  {
+    failures = RunLog(replay, chemistry);
+  }
+  else
+  {
+    for ( s = 0U; s < SIM_NUM_SCENARIOS; s++ )
+    {
+      failures += RunScenario(&SimScenarios[s], (s == 0U) ? log : 0);
+    }
+  }
+
+  if ( log != 0 )
+  {
+    fclose(log);
+  }
+  if ( SimTrace != 0 )
+  {
+    fclose(SimTrace);
+  }
+
+  printf("%s\n", failures ? "FAIL" : "PASS");
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,1060 @@
+/** @file can_bench.c
+*   @brief Host benchmark and regression guard of the CAN stack
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*   Runs the firmware canpub.c, cancmd.c, csp.c, canbench.c, histogram.c
+*   and print.c unmodified on a virtual bus in the manner of Linux vcan:
+*   a PORT_CAN stand-in with the 16 transmit message objects (lowest
+*   number sent first), the receive filters and silent internal loopback
+*   of the DCAN, and a second node for the flight computer that queues
+*   frames like a socketcan socket. Frames are arbitrated by identifier
+*   and take PORT_CAN_FRAME_BITS at PORT_CAN_BITRATE; the tasks run every
+*   1 ms tick at the periods and offsets of tasks.h, the on demand ones
+*   when they have been released with SCHEDULER_Release, commands as soon
+*   as the CAN interrupt that completed them returns, like the software
+*   interrupt.
+*
+*   Scenarios, with CANPUB publishing its default table throughout:
+*     quiet     no traffic for 10 s: runs per second of the CAN tasks, the
+*               wakeups they cost an idle board, against GuardIdle
+*     loopback  CANBENCH on its own, as WRITE(CAN,BENCH) on the target
+*     csp       the flight computer pings the EPS over the bus with the
+*               CANBENCH_Sizes payloads, one packet in flight
+*     cancmd    the flight computer sends a short and a long command
+*
+*   Reported per case are frames per second, not counting CANPUB, payload
+*   bytes per second both ways,
+*   round trip percentiles in simulated time and the host time spent in
+*   the receive handlers per frame, the reassembly overhead. Round trips
+*   are exact, from all samples, not from the firmware histograms.
+*
+*   The simulated figures are deterministic, so each is checked against
+*   the limit in Guard below; a change to the CAN stack that loses
+*   packets, slows a round trip or drops the frame rate past its limit
+*   fails the run. The handler time depends on the host and only has a
+*   loose limit that catches an order of magnitude. Update the limits
+*   when a change is meant to move them.
+*
+*   Build and run from this directory:
+*
+*     gcc -O2 -Wall -DPROFILE_ENABLE=0
+*         -I../../firmware/blinky/include
+*         -I../../firmware/blinky/drivers
+*         can_bench.c ../../firmware/blinky/drivers/canpub.c
+*         ../../firmware/blinky/drivers/cancmd.c
+*         ../../firmware/blinky/drivers/csp.c
+*         ../../firmware/blinky/drivers/port_can_pool.c
+*         ../../firmware/blinky/drivers/canbench.c
+*         ../../firmware/blinky/drivers/histogram.c
+*         ../../firmware/blinky/drivers/print.c
+*         -o can_bench && ./can_bench
+*
+*   Options:
+*     -n <packets>  Round trips per case (default 50)
+*     -v            Print the firmware statistics after each scenario
+*
+*   Exits with a non-zero status if a result is past its limit.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "port_can.h"
+#include "canpub.h"
+#include "cancmd.h"
+#include "csp.h"
+#include "canbench.h"
+#include "tasks.h"
+#include "eps.h"
+#include "flashlog.h"
+#include "telemetry.h"
+#include "histogram.h"
+#include "print.h"
+
+/* Bus time of one frame in us */
+#define SIM_FRAME_US        ((PORT_CAN_FRAME_BITS * 1000000U + PORT_CAN_BITRATE - 1U) / PORT_CAN_BITRATE)
+
+/* Address of the flight computer, for CSP and CANCMD */
+#define SIM_GROUND          (10U)
+
+/* Frames the flight computer can have queued */
+#define SIM_QUEUE           (1024U)
+
+/* Longest round trip kept, before a case gives up, in us */
+#define SIM_TIMEOUT         (2000000U)
+
+#define SIM_MAX_PACKETS     (1000U)
+
+/** @struct Sim_Frame_TypeDef
+*   @brief Frame on the virtual bus.
+*/
+typedef struct
+{
+  uint32_t id;
+  uint8_t data[PORT_CAN_DLC];
+} Sim_Frame_TypeDef;
+
+/** @struct Sim_Result_TypeDef
+*   @brief Results of one case.
+*/
+typedef struct
+{
+  const char *name;
+  uint32_t size;                  /* Request payload bytes */
+  uint32_t packets;               /* Round trips completed */
+  uint32_t failures;              /* Lost or wrong */
+  uint32_t frames;                /* Frames of the case, both ways */
+  uint64_t elapsed;               /* us */
+  uint64_t bytes;                 /* Payload bytes both ways */
+  uint32_t p50;                   /* Round trip in us */
+  uint32_t p99;
+  uint32_t max;
+  double handlerNs;               /* Host time per received frame */
+} Sim_Result_TypeDef;
+
+/** @struct Sim_Guard_TypeDef
+*   @brief Limits of one case.
+*/
+typedef struct
+{
+  const char *name;
+  uint32_t size;
+  uint32_t maxP99;                /* us */
+  uint32_t minFramesPerSec;
+} Sim_Guard_TypeDef;
+
+/* Limits, about 25 % off the results of the commit that added them */
+static const Sim_Guard_TypeDef Guard[] =
+{
+  { "loopback", 4U,    26000U,  50U  },
+  { "loopback", 28U,   26000U,  200U },
+  { "loopback", 124U,  100000U, 270U },
+  { "loopback", 512U,  425000U, 280U },
+  { "csp",      4U,    12500U,  150U },
+  { "csp",      28U,   14000U,  600U },
+  { "csp",      124U,  50000U,  600U },
+  { "csp",      512U,  240000U, 510U },
+  { "cancmd",   9U,    25000U,  175U },
+  { "cancmd",   11U,   240000U, 285U }
+};
+
+/* Host time per received frame, ns */
+#define GUARD_HANDLER_NS    (5000.0)
+
+/** @struct Sim_GuardIdle_TypeDef
+*   @brief Runs a second of a CAN task on a quiet bus, the wakeups it costs.
+*/
+typedef struct
+{
+  uint32_t task;
+  uint32_t maxRunsPerSec;
+} Sim_GuardIdle_TypeDef;
+
+static const Sim_GuardIdle_TypeDef GuardIdle[] =
+{
+  { TASKS_Id_CANPUB, 12U },
+  { TASKS_Id_CANCMD, 0U  },
+  { TASKS_Id_CSP,    0U  }
+};
+
+/* Length of the quiet bus case in us */
+#define SIM_QUIET_US        (10000000U)
+
+/* Virtual controller of the EPS */
+static Sim_Frame_TypeDef SimBox[PORT_CAN_FIRST_RX_BOX];
+static uint8_t SimPending[PORT_CAN_FIRST_RX_BOX];
+static uint32_t SimFilterId[PORT_CAN_NUM_FILTERS];
+static uint32_t SimFilterMask[PORT_CAN_NUM_FILTERS];
+static PORT_CAN_Receive_TypeDef SimFilterHandler[PORT_CAN_NUM_FILTERS];
+static uint8_t SimLoopback = 0U;
+static uint32_t SimReceived = 0U;
+static uint8_t SimCancmdPending = 0U;
+static uint8_t SimCspPending = 0U;
+
+/* Flight computer socket queue */
+static Sim_Frame_TypeDef SimQueue[SIM_QUEUE];
+static uint32_t SimQueueHead = 0U;
+static uint32_t SimQueueTail = 0U;
+
+/* Frame on the bus and on the loopback path: source box, 0 for the
+ * flight computer, and end time */
+typedef struct
+{
+  uint8_t active;
+  uint32_t box;
+  uint64_t end;
+  Sim_Frame_TypeDef frame;
+} Sim_Channel_TypeDef;
+
+static Sim_Channel_TypeDef SimBus;
+static Sim_Channel_TypeDef SimLoop;
+
+static uint64_t SimNow = 0U;      /* us */
+static uint64_t SimFrames = 0U;   /* Frames on either path, but CANPUB's */
+static uint64_t SimHandlerNs = 0U;
+static uint64_t SimHandlerFrames = 0U;
+
+/* Name, period and offset of each task in ticks */
+#define SIM_NAME(name, run, period, offset, prio, deadline) #name,
+#define SIM_TIMING(name, run, period, offset, prio, deadline) { period, offset },
+static const uint32_t SimTiming[TASKS_NUM_TASKS][2] = { TASKS_TABLE(SIM_TIMING) };
+
+/* Releases of the on demand tasks and runs of every task */
+static uint8_t SimArmed[TASKS_NUM_TASKS];
+static uint32_t SimDue[TASKS_NUM_TASKS];   /* Tick */
+static uint32_t SimRuns[TASKS_NUM_TASKS];
+
+/* Flight computer reassembly of CSP packets and CANCMD responses */
+static uint8_t SimRx[CSP_MTU];
+static uint32_t SimRxLength;
+static uint32_t SimRxPos;
+static uint8_t SimRxDone;
+static uint8_t SimRxPort;
+static char SimResponse[CANCMD_RESPONSE_SIZE + 1U];
+static uint32_t SimResponseLength;
+static uint8_t SimResponseDone;
+
+static TELEMETRY_Snapshot_TypeDef SimSnapshot;
+static FLASHLOG_State_TypeDef SimLogState;
+
+static uint32_t SimSamples[SIM_MAX_PACKETS];
+static uint8_t SimVerbose = 0U;
+
+/*******************************************************************************
+ ****************************   FIRMWARE STUBS   *******************************
+ ******************************************************************************/
+
+PORT_CAN_Err_TypeDef PORT_CAN_Init(void)
+{
+  return PORT_CAN_Err_NoError;
+}
+
+PORT_CAN_Err_TypeDef PORT_CAN_Send(uint32_t box, uint32_t id, const uint8_t *data)
+{
+  if ( box < PORT_CAN_FIRST_TX_BOX || box >= PORT_CAN_FIRST_RX_BOX || id > PORT_CAN_MAX_ID )
+  {
+    return PORT_CAN_Err_Invalid;
+  }
+  if ( SimPending[box] )
+  {
+    return PORT_CAN_Err_Busy;
+  }
+
+  SimBox[box].id = id;
+  memcpy(SimBox[box].data, data, PORT_CAN_DLC);
+  SimPending[box] = 1U;
+
+  return PORT_CAN_Err_NoError;
+}
+
+uint8_t PORT_CAN_Pending(uint32_t box)
+{
+  return (box < PORT_CAN_FIRST_RX_BOX) ? SimPending[box] : 0U;
+}
+
+/* A frame already on the bus or the loopback path is finished */
+void PORT_CAN_Cancel(uint32_t box)
+{
+  if ( box < PORT_CAN_FIRST_TX_BOX || box >= PORT_CAN_FIRST_RX_BOX
+       || (SimBus.active && SimBus.box == box) || (SimLoop.active && SimLoop.box == box) )
+  {
+    return;
+  }
+
+  SimPending[box] = 0U;
+}
+
+PORT_CAN_Err_TypeDef PORT_CAN_SetFilter(uint32_t filter,
+                                        uint32_t id,
+                                        uint32_t mask,
+                                        PORT_CAN_Receive_TypeDef receive)
+{
+  if ( filter >= PORT_CAN_NUM_FILTERS || id > PORT_CAN_MAX_ID )
+  {
+    return PORT_CAN_Err_Invalid;
+  }
+
+  SimFilterId[filter] = id;
+  SimFilterMask[filter] = mask;
+  SimFilterHandler[filter] = receive;
+
+  return PORT_CAN_Err_NoError;
+}
+
+void PORT_CAN_GetStatus(PORT_CAN_Status_TypeDef *status)
+{
+  memset(status, 0, sizeof(*status));
+  status->received = SimReceived;
+}
+
+uint8_t PORT_CAN_Recover(void)
+{
+  return 0U;
+}
+
+void PORT_CAN_SetLoopback(uint8_t enable)
+{
+  SimLoopback = enable;
+}
+
+uint32_t SCHEDULER_GetTicks(void)
+{
+  return (uint32_t)(SimNow * 1000U / SCHEDULER_TICK_US / 1000U);
+}
+
+uint32_t SCHEDULER_GetCounter(void)
+{
+  return (uint32_t)(SimNow * (SCHEDULER_FRC_HZ / 1000000U));
+}
+
+SCHEDULER_Err_TypeDef SCHEDULER_Release(uint32_t task, uint32_t delay)
+{
+  if ( task >= TASKS_NUM_TASKS )
+  {
+    return SCHEDULER_Err_InvalidTask;
+  }
+
+  SimArmed[task] = 1U;
+  SimDue[task] = SCHEDULER_GetTicks() + delay;
+  return SCHEDULER_Err_NoError;
+}
+
+GOVERNOR_Err_TypeDef GOVERNOR_Request(GOVERNOR_Client_TypeDef client,
+                                      GOVERNOR_Level_TypeDef level)
+{
+  (void)client;
+  (void)level;
+  return GOVERNOR_Err_NoError;
+}
+
+GOVERNOR_Err_TypeDef GOVERNOR_Release(GOVERNOR_Client_TypeDef client)
+{
+  (void)client;
+  return GOVERNOR_Err_NoError;
+}
+
+const TELEMETRY_Snapshot_TypeDef *TELEMETRY_GetSnapshot(void)
+{
+  return &SimSnapshot;
+}
+
+const FLASHLOG_State_TypeDef *FLASHLOG_GetState(void)
+{
+  return &SimLogState;
+}
+
+FLASHLOG_Err_TypeDef FLASHLOG_ReadBlock(uint32_t ringSeq, uint8_t *data)
+{
+  (void)ringSeq;
+  (void)data;
+  return FLASHLOG_Err_Invalid;
+}
+
+/* A short answer and a listing several hundred bytes long */
+EPS_Err_TypeDef EPS_runCommandString(PORT_UART_Reg_TypeDef *uart, char *command)
+{
+  uint32_t i;
+
+  if ( !strcmp(command, "READ(IDN)") )
+  {
+    PRINT_PrintStringln(uart, "openEPS TMS570LS0714 blinky");
+    return EPS_Err_NoError;
+  }
+
+  if ( !strcmp(command, "READ(SCHED)") )
+  {
+    for ( i = 0U; i < 14U; i++ )
+    {
+      PRINT_PrintStringln(uart, "TASK RUNS=000000 LATE=0 MAX=0000 US");
+    }
+    return EPS_Err_NoError;
+  }
+
+  PRINT_PrintStringln(uart, "ERROR: Invalid syntax!");
+  return EPS_Err_Syntax;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_SendByte(PORT_UART_Reg_TypeDef *uart, char data)
+{
+  (void)uart;
+  if ( SimVerbose )
+  {
+    putchar(data);
+  }
+  return PORT_UART_Err_NoError;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_Send(PORT_UART_Reg_TypeDef *uart, uint32_t length, char *data)
+{
+  (void)uart;
+  if ( SimVerbose )
+  {
+    fwrite(data, 1U, length, stdout);
+  }
+  return PORT_UART_Err_NoError;
+}
+
+/*******************************************************************************
+ ******************************   VIRTUAL BUS   ********************************
+ ******************************************************************************/
+
+/* Commands requested from the interrupt or a task, run once it returns
+ * like the software interrupt */
+static void SimSoftware(void)
+{
+  if ( SimCancmdPending )
+  {
+    SimCancmdPending = 0U;
+    CANCMD_Execute();
+  }
+  if ( SimCspPending )
+  {
+    SimCspPending = 0U;
+    CSP_Execute();
+  }
+}
+
+static uint64_t SimHostNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+/* Frame reaching the EPS, through the first filter that accepts it, in
+ * the CAN interrupt, then the commands it completed */
+static void SimEpsReceive(const Sim_Frame_TypeDef *f)
+{
+  uint64_t start;
+  uint32_t i;
+
+  for ( i = 0U; i < PORT_CAN_NUM_FILTERS; i++ )
+  {
+    if ( SimFilterHandler[i] != 0
+         && (f->id & SimFilterMask[i]) == (SimFilterId[i] & SimFilterMask[i]) )
+    {
+      SimReceived++;
+      start = SimHostNs();
+      SimFilterHandler[i](f->id, f->data);
+      SimHandlerNs += SimHostNs() - start;
+      SimHandlerFrames++;
+      break;
+    }
+  }
+
+  SimSoftware();
+}
+
+/* Frame reaching the flight computer */
+static void SimGroundReceive(const Sim_Frame_TypeDef *f)
+{
+  uint32_t i;
+  uint32_t n;
+  uint32_t remain;
+
+  if ( (f->id & ~(uint32_t)CANCMD_ADDRESS_MASK) == CANCMD_DefaultParams.responseId
+       && (f->id & CANCMD_ADDRESS_MASK) == SIM_GROUND )
+  {
+    for ( i = 1U; i < PORT_CAN_DLC && f->data[i] != 0U && SimResponseLength < CANCMD_RESPONSE_SIZE; i++ )
+    {
+      SimResponse[SimResponseLength++] = (char)f->data[i];
+    }
+    if ( (f->data[0] & CANCMD_FLAG_LAST) != 0U )
+    {
+      SimResponse[SimResponseLength] = '\0';
+      SimResponseDone = 1U;
+    }
+    return;
+  }
+
+  if ( ((f->id >> CSP_ID_DST_SHIFT) & CSP_ID_ADDRESS_MASK) != SIM_GROUND )
+  {
+    return;
+  }
+
+  remain = (f->id >> CSP_ID_REMAIN_SHIFT) & CSP_ID_REMAIN_MASK;
+  i = 0U;
+  n = PORT_CAN_DLC;
+  if ( (f->id & CSP_ID_BEGIN) != 0U )
+  {
+    SimRxPort = f->data[1];
+    SimRxLength = ((uint32_t)f->data[2] << 8U) | f->data[3];
+    SimRxPos = 0U;
+    i = CSP_BEGIN_HEADER;
+  }
+
+  for ( ; i < n && SimRxPos < SimRxLength && SimRxPos < CSP_MTU; i++ )
+  {
+    SimRx[SimRxPos++] = f->data[i];
+  }
+
+  if ( remain == 0U )
+  {
+    SimRxDone = 1U;
+  }
+}
+
+/* Lowest numbered pending message object of the EPS, 0 if none */
+static uint32_t SimEpsNext(void)
+{
+  uint32_t box;
+
+  for ( box = PORT_CAN_FIRST_TX_BOX; box < PORT_CAN_FIRST_RX_BOX; box++ )
+  {
+    if ( SimPending[box] )
+    {
+      return box;
+    }
+  }
+
+  return 0U;
+}
+
+/* Start the next frame on an idle path */
+static void SimStart(Sim_Channel_TypeDef *ch, uint8_t loop)
+{
+  uint32_t box = SimEpsNext();
+  uint8_t ground = (!loop && SimQueueHead != SimQueueTail) ? 1U : 0U;
+
+  /* In loopback the EPS is off the bus */
+  if ( box != 0U && (SimLoopback != loop) )
+  {
+    box = 0U;
+  }
+
+  if ( box == 0U && !ground )
+  {
+    return;
+  }
+
+  /* Arbitration, lowest identifier wins */
+  if ( box != 0U && (!ground || SimBox[box].id < SimQueue[SimQueueTail % SIM_QUEUE].id) )
+  {
+    ch->box = box;
+    ch->frame = SimBox[box];
+  }
+  else
+  {
+    ch->box = 0U;
+    ch->frame = SimQueue[SimQueueTail++ % SIM_QUEUE];
+  }
+
+  ch->active = 1U;
+  ch->end = SimNow + SIM_FRAME_US;
+}
+
+/* End of a frame: acknowledge and deliver */
+static void SimEnd(Sim_Channel_TypeDef *ch, uint8_t loop)
+{
+  ch->active = 0U;
+  if ( ch->box < CANPUB_FIRST_BOX || ch->box >= CANPUB_FIRST_BOX + CANPUB_MAX_BOXES )
+  {
+    SimFrames++;
+  }
+
+  if ( ch->box != 0U )
+  {
+    SimPending[ch->box] = 0U;
+    if ( loop )
+    {
+      SimEpsReceive(&ch->frame);
+    }
+    else
+    {
+      SimGroundReceive(&ch->frame);
+    }
+  }
+  else if ( !SimLoopback )
+  {
+    SimEpsReceive(&ch->frame);
+  }
+}
+
+/* Run the bus and the loopback path up to a time */
+static void SimRun(uint64_t until)
+{
+  Sim_Channel_TypeDef *ch;
+  uint8_t loop;
+
+  for ( ;; )
+  {
+    /* Earliest frame end first */
+    ch = 0;
+    if ( SimBus.active && SimBus.end <= until )
+    {
+      ch = &SimBus;
+    }
+    if ( SimLoop.active && SimLoop.end <= until && (ch == 0 || SimLoop.end < ch->end) )
+    {
+      ch = &SimLoop;
+    }
+
+    if ( ch != 0 )
+    {
+      loop = (ch == &SimLoop) ? 1U : 0U;
+      SimNow = ch->end;
+      SimEnd(ch, loop);
+      SimStart(ch, loop);
+      continue;
+    }
+
+    if ( !SimBus.active )
+    {
+      SimStart(&SimBus, 0U);
+    }
+    if ( !SimLoop.active )
+    {
+      SimStart(&SimLoop, 1U);
+    }
+
+    if ( (!SimBus.active || SimBus.end > until) && (!SimLoop.active || SimLoop.end > until) )
+    {
+      break;
+    }
+  }
+
+  SimNow = until;
+}
+
+static void SimQueueFrame(uint32_t id, const uint8_t *data)
+{
+  SimQueue[SimQueueHead % SIM_QUEUE].id = id;
+  memcpy(SimQueue[SimQueueHead % SIM_QUEUE].data, data, PORT_CAN_DLC);
+  SimQueueHead++;
+}
+
+/*******************************************************************************
+ ********************************   FIRMWARE   *********************************
+ ******************************************************************************/
+
+static void SimCancmdDispatch(void)
+{
+  SimCancmdPending = 1U;
+}
+
+static void SimCspDispatch(void)
+{
+  SimCspPending = 1U;
+}
+
+/* Task released in this tick, periodic or on demand, as in tasks.h */
+static uint8_t SimReleased(uint32_t task, uint32_t tick)
+{
+  if ( SimTiming[task][0] != 0U )
+  {
+    if ( tick % SimTiming[task][0] != SimTiming[task][1] )
+    {
+      return 0U;
+    }
+  }
+  else if ( !SimArmed[task] || (int32_t)(tick - SimDue[task]) < 0 )
+  {
+    return 0U;
+  }
+
+  SimArmed[task] = 0U;
+  SimRuns[task]++;
+  return 1U;
+}
+
+/* One 1 ms tick: the tasks due, then the bus until the next tick */
+static void SimTick(void)
+{
+  uint32_t tick = SCHEDULER_GetTicks();
+
+  if ( SimReleased(TASKS_Id_CANPUB, tick) )
+  {
+    CANPUB_Update();
+  }
+  if ( SimReleased(TASKS_Id_CANCMD, tick) )
+  {
+    CANCMD_Update();
+  }
+  if ( SimReleased(TASKS_Id_CSP, tick) )
+  {
+    CSP_Update();
+  }
+  if ( SimReleased(TASKS_Id_CANBENCH, tick) )
+  {
+    CANBENCH_Update();
+  }
+
+  SimSoftware();
+  SimRun(SimNow + SCHEDULER_TICK_US);
+}
+
+static void SimReset(void)
+{
+  memset(SimPending, 0, sizeof(SimPending));
+  memset(&SimBus, 0, sizeof(SimBus));
+  memset(&SimLoop, 0, sizeof(SimLoop));
+  SimQueueHead = SimQueueTail = 0U;
+  SimLoopback = 0U;
+  SimNow = 0U;
+
+  memset(SimArmed, 0, sizeof(SimArmed));
+  CANPUB_Init(0, 0U, 0, TASKS_Id_CANPUB);
+  CANCMD_Init(0, SimCancmdDispatch, TASKS_Id_CANCMD);
+  CSP_Init(0, SimCspDispatch, TASKS_Id_CSP);
+  CANBENCH_Init(TASKS_Id_CANBENCH);
+
+  /* Let the publisher settle into its phases */
+  while ( SimNow < 3000000U )
+  {
+    SimTick();
+  }
+}
+
+/*******************************************************************************
+ ********************************   SCENARIOS   ********************************
+ ******************************************************************************/
+
+static int SimCompare(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+/* Percentiles of the round trips and the rates of a case */
+static void SimFinish(Sim_Result_TypeDef *r, uint64_t start, uint64_t frames,
+                      uint64_t handlerNs, uint64_t handlerFrames)
+{
+  r->elapsed = SimNow - start;
+  r->frames = (uint32_t)(SimFrames - frames);
+  r->handlerNs = (SimHandlerFrames > handlerFrames)
+                 ? (double)(SimHandlerNs - handlerNs) / (double)(SimHandlerFrames - handlerFrames) : 0.0;
+
+  if ( r->packets == 0U )
+  {
+    return;
+  }
+
+  qsort(SimSamples, r->packets, sizeof(SimSamples[0]), SimCompare);
+  r->p50 = SimSamples[(r->packets - 1U) / 2U];
+  r->p99 = SimSamples[(r->packets * 99U + 99U) / 100U - 1U];
+  r->max = SimSamples[r->packets - 1U];
+}
+
+/* WRITE(CAN,BENCH) on the virtual controller */
+static uint32_t SimLoopbackCases(uint32_t packets, Sim_Result_TypeDef *r)
+{
+  const CANBENCH_Result_TypeDef *b;
+  uint64_t start = SimNow;
+  uint64_t handlerNs = SimHandlerNs;
+  uint64_t handlerFrames = SimHandlerFrames;
+  uint32_t i;
+
+  CANBENCH_Start(packets);
+  while ( CANBENCH_Running() && SimNow - start < (uint64_t)packets * CANBENCH_NUM_SIZES * SIM_TIMEOUT )
+  {
+    SimTick();
+  }
+
+  for ( i = 0U; i < CANBENCH_NUM_SIZES; i++ )
+  {
+    b = CANBENCH_GetResult(i);
+    r[i].name = "loopback";
+    r[i].size = b->size;
+    r[i].packets = b->packets;
+    r[i].failures = b->failures + (CANBENCH_Running() ? 1U : 0U);
+    r[i].frames = b->frames;
+    r[i].elapsed = b->elapsed;
+    r[i].bytes = (uint64_t)b->packets * 2U * b->size;
+    r[i].p50 = HISTOGRAM_Percentile(&b->latency, 500U);
+    r[i].p99 = HISTOGRAM_Percentile(&b->latency, 990U);
+    r[i].max = b->latency.max;
+    r[i].handlerNs = (SimHandlerFrames > handlerFrames)
+                     ? (double)(SimHandlerNs - handlerNs) / (double)(SimHandlerFrames - handlerFrames) : 0.0;
+  }
+
+  if ( SimVerbose )
+  {
+    CANBENCH_Print(PORT_UART_UART0);
+  }
+
+  return CANBENCH_NUM_SIZES;
+}
+
+/* Flight computer pings the EPS through CSP */
+static void SimCspCase(uint32_t size, uint32_t packets, Sim_Result_TypeDef *r)
+{
+  static uint8_t payload[CSP_MTU];
+  static uint8_t ident = 0U;
+  uint64_t start = SimNow;
+  uint64_t frames = SimFrames;
+  uint64_t handlerNs = SimHandlerNs;
+  uint64_t handlerFrames = SimHandlerFrames;
+  uint64_t sent;
+  uint32_t count = CSP_FRAMES(size);
+  uint32_t p, f, i, pos;
+  uint8_t data[PORT_CAN_DLC];
+
+  memset(r, 0, sizeof(*r));
+  r->name = "csp";
+  r->size = size;
+
+  for ( p = 0U; p < packets; p++ )
+  {
+    for ( i = 0U; i < size; i++ )
+    {
+      payload[i] = (uint8_t)(p * 7U + i);
+    }
+
+    pos = 0U;
+    for ( f = 0U; f < count; f++ )
+    {
+      memset(data, 0, sizeof(data));
+      i = 0U;
+      if ( f == 0U )
+      {
+        data[0] = CSP_Port_Ping;
+        data[1] = CSP_Port_User;
+        data[2] = (uint8_t)(size >> 8U);
+        data[3] = (uint8_t)size;
+        i = CSP_BEGIN_HEADER;
+      }
+      for ( ; i < PORT_CAN_DLC && pos < size; i++ )
+      {
+        data[i] = payload[pos++];
+      }
+
+      SimQueueFrame(((uint32_t)CSP_Prio_Norm << CSP_ID_PRIO_SHIFT)
+                    | ((uint32_t)SIM_GROUND << CSP_ID_SRC_SHIFT)
+                    | ((uint32_t)CSP_DefaultParams.address << CSP_ID_DST_SHIFT)
+                    | ((f == 0U) ? CSP_ID_BEGIN : 0U)
+                    | ((count - 1U - f) << CSP_ID_REMAIN_SHIFT)
+                    | ident,
+                    data);
+    }
+    ident++;
+
+    sent = SimNow;
+    SimRxDone = 0U;
+    while ( !SimRxDone && SimNow - sent < SIM_TIMEOUT )
+    {
+      SimTick();
+    }
+
+    if ( !SimRxDone || SimRxPort != CSP_Port_Ping || SimRxLength != size
+         || memcmp(SimRx, payload, size) != 0 )
+    {
+      r->failures++;
+      continue;
+    }
+
+    SimSamples[r->packets++] = (uint32_t)(SimNow - sent);
+    r->bytes += 2U * size;
+  }
+
+  SimFinish(r, start, frames, handlerNs, handlerFrames);
+}
+
+/* Flight computer sends a console command through CANCMD */
+static void SimCancmdCase(const char *command, uint32_t packets, Sim_Result_TypeDef *r)
+{
+  uint32_t length = (uint32_t)strlen(command);
+  uint64_t start = SimNow;
+  uint64_t frames = SimFrames;
+  uint64_t handlerNs = SimHandlerNs;
+  uint64_t handlerFrames = SimHandlerFrames;
+  uint64_t sent;
+  uint32_t p, pos, i, index;
+  uint8_t data[PORT_CAN_DLC];
+
+  memset(r, 0, sizeof(*r));
+  r->name = "cancmd";
+  r->size = length;
+
+  for ( p = 0U; p < packets; p++ )
+  {
+    for ( pos = 0U, index = 0U; pos < length; index++ )
+    {
+      memset(data, 0, sizeof(data));
+      for ( i = 1U; i < PORT_CAN_DLC && pos < length; i++ )
+      {
+        data[i] = (uint8_t)command[pos++];
+      }
+      data[0] = (uint8_t)((index & CANCMD_INDEX_MASK) | ((pos == length) ? CANCMD_FLAG_LAST : 0U));
+      SimQueueFrame(CANCMD_DefaultParams.requestId | SIM_GROUND, data);
+    }
+
+    sent = SimNow;
+    SimResponseLength = 0U;
+    SimResponseDone = 0U;
+    while ( !SimResponseDone && SimNow - sent < SIM_TIMEOUT )
+    {
+      SimTick();
+    }
+
+    if ( !SimResponseDone || strncmp(SimResponse, "ERROR", 5U) == 0 )
+    {
+      r->failures++;
+      continue;
+    }
+
+    SimSamples[r->packets++] = (uint32_t)(SimNow - sent);
+    r->bytes += length + SimResponseLength;
+
+    /* The endpoint takes requests again once its next run has seen the
+     * last segment acknowledged */
+    for ( i = 0U; i < CANCMD_PERIOD; i++ )
+    {
+      SimTick();
+    }
+  }
+
+  SimFinish(r, start, frames, handlerNs, handlerFrames);
+}
+
+/*******************************************************************************
+ **********************************   MAIN   ***********************************
+ ******************************************************************************/
+
+/* No traffic but CANPUB's: runs of the CAN tasks, and the publisher must
+ * keep every frame on time */
+static uint32_t SimQuietCase(void)
+{
+  static const char * const names[TASKS_NUM_TASKS] = { TASKS_TABLE(SIM_NAME) };
+  uint32_t runs[TASKS_NUM_TASKS];
+  uint64_t start;
+  uint32_t failures = 0U;
+  uint32_t overruns;
+  uint32_t perSec;
+  uint32_t i;
+
+  SimReset();
+  memcpy(runs, SimRuns, sizeof(runs));
+  overruns = CANPUB_GetState()->overruns;
+  start = SimNow;
+  while ( SimNow - start < SIM_QUIET_US )
+  {
+    SimTick();
+  }
+
+  printf("quiet bus, runs per second:");
+  for ( i = 0U; i < sizeof(GuardIdle) / sizeof(GuardIdle[0]); i++ )
+  {
+    perSec = (uint32_t)((uint64_t)(SimRuns[GuardIdle[i].task] - runs[GuardIdle[i].task])
+                        * 1000000U / SIM_QUIET_US);
+    printf(" %s %u", names[GuardIdle[i].task], perSec);
+    if ( perSec > GuardIdle[i].maxRunsPerSec )
+    {
+      printf(" (limit %u)", GuardIdle[i].maxRunsPerSec);
+      failures++;
+    }
+  }
+
+  if ( CANPUB_GetState()->overruns != overruns )
+  {
+    printf(", CANPUB overruns %u", CANPUB_GetState()->overruns - overruns);
+    failures++;
+  }
+
+  printf("%s\n\n", failures ? "  <-- past limit" : "");
+  return failures;
+}
+
+static uint32_t SimCheck(const Sim_Result_TypeDef *r)
+{
+  uint32_t fps = (r->elapsed != 0U) ? (uint32_t)((uint64_t)r->frames * 1000000U / r->elapsed) : 0U;
+  uint32_t bps = (r->elapsed != 0U) ? (uint32_t)(r->bytes * 1000000U / r->elapsed) : 0U;
+  uint32_t failures = 0U;
+  uint32_t i;
+
+  printf("%-9s %4u %7u %7u %6u %8u %8u %8u %8.0f",
+         r->name, r->size, r->packets, r->failures, fps, bps, r->p50, r->p99, r->handlerNs);
+
+  if ( r->failures != 0U || r->packets == 0U )
+  {
+    failures++;
+  }
+
+  for ( i = 0U; i < sizeof(Guard) / sizeof(Guard[0]); i++ )
+  {
+    if ( !strcmp(Guard[i].name, r->name) && Guard[i].size == r->size )
+    {
+      if ( r->p99 > Guard[i].maxP99 || fps < Guard[i].minFramesPerSec )
+      {
+        failures++;
+      }
+    }
+  }
+
+  if ( r->handlerNs > GUARD_HANDLER_NS )
+  {
+    failures++;
+  }
+
+  printf("%s\n", failures ? "  <-- past limit" : "");
+  return failures;
+}
+
+int main(int argc, char **argv)
+{
+  static Sim_Result_TypeDef results[CANBENCH_NUM_SIZES * 2U + 2U];
+  uint32_t packets = 50U;
+  uint32_t num = 0U;
+  uint32_t failures = 0U;
+  uint32_t i;
+  int a;
+
+  for ( a = 1; a < argc; a++ )
+  {
+    if ( !strcmp(argv[a], "-n") && a + 1 < argc )
+    {
+      packets = (uint32_t)atoi(argv[++a]);
+    }
+    else if ( !strcmp(argv[a], "-v") )
+    {
+      SimVerbose = 1U;
+    }
+    else
+    {
+      printf("usage: %s [-n packets] [-v]\n", argv[0]);
+      return 2;
+    }
+  }
+  if ( packets == 0U || packets > SIM_MAX_PACKETS )
+  {
+    packets = 50U;
+  }
+
+  printf("Bus %u bit/s, %u us per frame, %u round trips per case\n\n",
+         PORT_CAN_BITRATE, SIM_FRAME_US, packets);
+
+  failures += SimQuietCase();
+
+  SimReset();
+  num += SimLoopbackCases(packets, &results[num]);
+
+  SimReset();
+  for ( i = 0U; i < CANBENCH_NUM_SIZES; i++ )
+  {
+    SimCspCase(CANBENCH_Sizes[i], packets, &results[num++]);
+  }
+  SimCancmdCase("READ(IDN)", packets, &results[num++]);
+  SimCancmdCase("read(sched)", packets, &results[num++]);
+
+  if ( SimVerbose )
+  {
+    CANPUB_PrintStats(PORT_UART_UART0);
+    CANCMD_PrintStats(PORT_UART_UART0);
+    CSP_PrintStats(PORT_UART_UART0);
+    printf("\n");
+  }
+
+  printf("%-9s %4s %7s %7s %6s %8s %8s %8s %8s\n",
+         "case", "size", "packets", "failed", "fps", "bytes/s", "p50 us", "p99 us", "ns/frame");
+  for ( i = 0U; i < num; i++ )
+  {
+    failures += SimCheck(&results[i]);
+  }
+
+  printf("\n%s\n", failures ? "FAIL" : "PASS");
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
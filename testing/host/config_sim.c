@@ -0,0 +1,450 @@
+/** @file config_sim.c
+*   @brief Host simulation of the persistent configuration store
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*   Runs the firmware config.c and print.c unmodified on a RAM backed
+*   PORT_FEE that completes a write after a number of main function calls
+*   and can be made busy or failing.
+*
+*   Checks, each followed by a simulated reset (CONFIG_Init):
+*     - blank flash boots on the defaults
+*     - commits alternate between the copies and survive a reset
+*     - a commit waits for a busy FEE and retries a failed write
+*     - a reset at every point of a write leaves the previous record
+*     - a damaged newest copy falls back to the other one
+*     - records of a newer schema, or of this schema with another length,
+*       are not used
+*     - a shorter record of an older schema is migrated over the defaults
+*     - a value out of limits in a valid record is put back to its default
+*     - without a usable FEE the defaults are loaded and commits refused
+*
+*   Build and run from this directory:
+*
+*     gcc -O2 -Wall -DPROFILE_ENABLE=0
+*         -I../../firmware/blinky/include
+*         -I../../firmware/blinky/drivers
+*         config_sim.c ../../firmware/blinky/drivers/config.c
+*         ../../firmware/blinky/drivers/print.c
+*         -o config_sim && ./config_sim
+*
+*   Exits with a non-zero status if any check fails.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "config.h"
+#include "port_fee.h"
+#include "print.h"
+
+/* Main function calls per FEE block write */
+#define SIM_FEE_CALLS       (40U)
+
+#define SIM_BLOCKS          (CONFIG_FIRST_BLOCK + CONFIG_NUM_COPIES)
+
+static uint8_t SimFlash[SIM_BLOCKS][CONFIG_BLOCK_SIZE];
+static uint8_t SimWritten[SIM_BLOCKS];
+static uint8_t SimFeeCopy[CONFIG_BLOCK_SIZE];
+static uint16_t SimFeeBlock;
+static uint32_t SimFeeBusy = 0U;
+static uint32_t SimFeeFail = 0U;
+static uint8_t SimFeeMissing = 0U;
+static uint32_t SimReads = 0U;
+static uint32_t SimReadBytes = 0U;
+
+static uint32_t SimFailures = 0U;
+
+/*******************************************************************************
+ ****************************   FIRMWARE STUBS   *******************************
+ ******************************************************************************/
+
+/* Defaults of the modules the store takes its defaults from */
+const MPPT_Params_TypeDef MPPT_DefaultParams =
+{
+  MPPT_Algorithm_PerturbObserve, 16U, 2U, -1, 496U, 1861U, 496U, 3U, 100U, 100U, 10000U
+};
+
+const GOVERNOR_Params_TypeDef GOVERNOR_DefaultParams =
+{
+  800U, 500U, 10U, GOVERNOR_Level_Min, GOVERNOR_Level_Max
+};
+
+const POLICY_Rule_TypeDef POLICY_DefaultRules[] =
+{
+  { "BAT_LOW",  POLICY_Signal_Soc,     TELEMETRY_Channel_BATBUS, POLICY_Compare_Below, 300, 50, 2U, 0U, POLICY_Action_Shed, 2U },
+  { "BAT_CRIT", POLICY_Signal_Voltage, TELEMETRY_Channel_BATBUS, POLICY_Compare_Below, 6200, 200, 2U, 1U, POLICY_Action_Survival, 0U }
+};
+
+const uint32_t POLICY_NumDefaultRules = sizeof(POLICY_DefaultRules) / sizeof(POLICY_DefaultRules[0]);
+
+const uint8_t POLICY_DefaultProfileDivider[POLICY_NUM_PROFILES] = { 1U, 5U, 10U };
+
+const uint8_t POLICY_DefaultOutputPriority[POLICY_NUM_OUTPUTS] =
+{
+  0U, 0U, 1U, 1U, 1U, 1U, 2U, 2U, 2U, 2U, 2U, 2U, 3U, 3U, 3U, 3U, 3U, 3U
+};
+
+PORT_FEE_Err_TypeDef PORT_FEE_Init(void)
+{
+  /* A write cut by the reset never lands */
+  SimFeeBusy = 0U;
+  return SimFeeMissing ? PORT_FEE_Err_Disabled : PORT_FEE_Err_NoError;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_WriteAsync(uint16_t block, uint8_t *data)
+{
+  if ( SimFeeBusy )
+  {
+    return PORT_FEE_Err_Busy;
+  }
+  if ( SimFeeFail )
+  {
+    SimFeeFail--;
+    return PORT_FEE_Err_Failed;
+  }
+  if ( block >= SIM_BLOCKS )
+  {
+    return PORT_FEE_Err_Failed;
+  }
+
+  SimFeeBlock = block;
+  memcpy(SimFeeCopy, data, CONFIG_BLOCK_SIZE);
+  SimFeeBusy = SIM_FEE_CALLS;
+
+  return PORT_FEE_Err_NoError;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_Read(uint16_t block,
+                                   uint16_t offset,
+                                   uint8_t *data,
+                                   uint16_t length)
+{
+  if ( SimFeeBusy )
+  {
+    return PORT_FEE_Err_Busy;
+  }
+  if ( block >= SIM_BLOCKS || !SimWritten[block] || offset + length > CONFIG_BLOCK_SIZE )
+  {
+    return PORT_FEE_Err_Invalid;
+  }
+
+  memcpy(data, &SimFlash[block][offset], length);
+  SimReads++;
+  SimReadBytes += length;
+
+  return PORT_FEE_Err_NoError;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_GetResult(void)
+{
+  return SimFeeBusy ? PORT_FEE_Err_Busy : PORT_FEE_Err_NoError;
+}
+
+uint8_t PORT_FEE_Busy(void)
+{
+  return SimFeeBusy ? 1U : 0U;
+}
+
+void PORT_FEE_MainFunction(void)
+{
+  if ( SimFeeBusy && --SimFeeBusy == 0U )
+  {
+    memcpy(SimFlash[SimFeeBlock], SimFeeCopy, CONFIG_BLOCK_SIZE);
+    SimWritten[SimFeeBlock] = 1U;
+  }
+}
+
+PORT_UART_Err_TypeDef PORT_UART_SendByte(PORT_UART_Reg_TypeDef *uart,
+                                         char data)
+{
+  (void)uart;
+  putchar(data);
+  return PORT_UART_Err_NoError;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_Send(PORT_UART_Reg_TypeDef *uart,
+                                     uint32_t length,
+                                     char *data)
+{
+  (void)uart;
+  fwrite(data, 1U, length, stdout);
+  return PORT_UART_Err_NoError;
+}
+
+/*******************************************************************************
+ *******************************   HELPERS   ***********************************
+ ******************************************************************************/
+
+static void SimCheck(int ok, const char *what)
+{
+  printf("  %-58s %s\n", what, ok ? "ok" : "FAILED");
+  if ( !ok )
+  {
+    SimFailures++;
+  }
+}
+
+/* Bitwise CRC-32, independent of the nibble table in config.c */
+static uint32_t SimCrc32(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  uint32_t i, bit;
+
+  for ( i = 0U; i < length; i++ )
+  {
+    crc ^= data[i];
+    for ( bit = 0U; bit < 8U; bit++ )
+    {
+      crc = (crc & 1U) ? (crc >> 1) ^ 0xEDB88320U : (crc >> 1);
+    }
+  }
+
+  return crc;
+}
+
+/* Rewrite the header of a stored copy and seal it with a valid CRC */
+static void SimSeal(uint8_t copy, uint16_t version, uint16_t length)
+{
+  uint8_t *b = SimFlash[CONFIG_FIRST_BLOCK + copy];
+  uint32_t crc;
+
+  b[2] = (uint8_t)version;
+  b[3] = (uint8_t)(version >> 8);
+  b[4] = (uint8_t)length;
+  b[5] = (uint8_t)(length >> 8);
+  crc = SimCrc32(SimCrc32(0xFFFFFFFFU, b, 12U), &b[CONFIG_HEADER_SIZE], length);
+  b[12] = (uint8_t)crc;
+  b[13] = (uint8_t)(crc >> 8);
+  b[14] = (uint8_t)(crc >> 16);
+  b[15] = (uint8_t)(crc >> 24);
+}
+
+static uint32_t SimSequence(uint8_t copy)
+{
+  const uint8_t *b = SimFlash[CONFIG_FIRST_BLOCK + copy];
+
+  return (uint32_t)b[8] | ((uint32_t)b[9] << 8) | ((uint32_t)b[10] << 16) | ((uint32_t)b[11] << 24);
+}
+
+/* Run the commit task until the commit is done */
+static uint32_t SimCommit(void)
+{
+  uint32_t runs = 0U;
+
+  if ( CONFIG_Commit() != CONFIG_Err_NoError )
+  {
+    return 0U;
+  }
+  while ( CONFIG_GetState()->busy && runs < 1000U )
+  {
+    CONFIG_Update();
+    runs++;
+  }
+
+  return runs;
+}
+
+static int32_t SimStaged(const char *name, uint32_t index)
+{
+  int32_t value = 0;
+
+  (void)CONFIG_GetStaged(name, index, &value);
+
+  return value;
+}
+
+/*******************************************************************************
+ *********************************   MAIN   ************************************
+ ******************************************************************************/
+
+int main(void)
+{
+  static uint8_t saved[SIM_BLOCKS][CONFIG_BLOCK_SIZE];
+  static uint8_t savedWritten[SIM_BLOCKS];
+  CONFIG_Data_TypeDef defaults;
+  CONFIG_Data_TypeDef expect;
+  const CONFIG_Data_TypeDef *cfg = CONFIG_Get();
+  const CONFIG_State_TypeDef *s = CONFIG_GetState();
+  CONFIG_Err_TypeDef err;
+  uint32_t length = CONFIG_HEADER_SIZE + sizeof(CONFIG_Data_TypeDef);
+  uint32_t cuts = 0U;
+  uint32_t lost = 0U;
+  uint32_t landed = 0U;
+  uint32_t cut, seq, runs;
+  uint8_t target;
+
+  printf("record %u bytes in blocks %u and %u of %u bytes\n",
+         (uint32_t)length, CONFIG_FIRST_BLOCK, CONFIG_FIRST_BLOCK + 1U, CONFIG_BLOCK_SIZE);
+
+  CONFIG_Defaults(&defaults);
+
+  printf("blank flash:\n");
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_Empty && s->source == CONFIG_Source_Defaults && s->valid == 0U,
+           "boots on the defaults");
+  SimCheck(!memcmp(cfg, &defaults, sizeof(defaults)), "defaults loaded");
+  SimCheck(CONFIG_GetRules()[1].threshold == 6200 && CONFIG_GetRules()[1].action == POLICY_Action_Survival,
+           "policy rules built from the defaults");
+
+  printf("commit and reload:\n");
+  SimCheck(CONFIG_Set("MPPT_STEP", 0U, 24) == CONFIG_Err_NoError
+        && CONFIG_Set("RSENSE", 28U, 10) == CONFIG_Err_NoError
+        && CONFIG_Set("MPPT_POLARITY", 0U, 1) == CONFIG_Err_NoError
+        && CONFIG_Set("RULE_THRESH", 1U, -5) == CONFIG_Err_NoError
+        && CONFIG_Set("PROFILE_DIV", 2U, 30) == CONFIG_Err_NoError, "fields staged");
+  SimCheck(CONFIG_Set("RSENSE", TELEMETRY_NUM_CHANNELS, 10) == CONFIG_Err_Invalid
+        && CONFIG_Set("PROFILE_DIV", 0U, 0) == CONFIG_Err_Invalid
+        && CONFIG_Set("GOV_MAX", 0U, GOVERNOR_NUM_LEVELS) == CONFIG_Err_Invalid
+        && CONFIG_Set("NOPE", 0U, 1) == CONFIG_Err_Invalid, "bad index, value and name refused");
+  SimCheck(cfg->mppt.step == defaults.mppt.step, "loaded copy unchanged by staging");
+  SimCheck(SimStaged("MPPT_POLARITY", 0U) == 1 && SimStaged("RULE_THRESH", 1U) == -5,
+           "staged values read back, signed fields sign extended");
+
+  runs = SimCommit();
+  SimCheck(runs > 0U && !s->busy && s->commits == 1U && s->errors == 0U && s->pending, "first commit");
+  SimCheck(s->copy == 0U && s->sequence == 1U && SimSequence(0U) == 1U, "written to copy 0 as sequence 1");
+
+  expect = defaults;
+  expect.mppt.step = 24U;
+  expect.senseResistor[28] = 10U;
+  expect.mppt.polarity = 1;
+  expect.threshold[1] = -5;
+  expect.profileDivider[2] = 30U;
+
+  SimReads = 0U;
+  SimReadBytes = 0U;
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_NoError && s->source == CONFIG_Source_Flash && s->version == CONFIG_VERSION,
+           "reloaded from flash");
+  SimCheck(!memcmp(cfg, &expect, sizeof(expect)), "values survive the reset");
+  SimCheck(CONFIG_GetRules()[1].threshold == -5, "policy rules take the stored limits");
+  printf("  load reads %u FEE pieces, %u bytes\n", SimReads, SimReadBytes);
+
+  printf("second commit, busy and failing FEE:\n");
+  SimCheck(CONFIG_Set("GOV_HOLD", 0U, 25) == CONFIG_Err_NoError, "field staged");
+  expect.governor.downHold = 25U;
+  SimFeeBusy = 500U;
+  SimFeeFail = 1U;
+  runs = SimCommit();
+  SimCheck(!s->busy && s->commits == 1U && s->errors == 1U, "waited for the FEE, retried the failed write");
+  SimCheck(s->copy == 1U && s->sequence == 2U && SimSequence(1U) == 2U && SimSequence(0U) == 1U,
+           "written to copy 1 as sequence 2, copy 0 kept");
+  SimCheck(CONFIG_Commit() == CONFIG_Err_NoError && CONFIG_Commit() == CONFIG_Err_Busy, "second commit refused while busy");
+  SimFeeFail = CONFIG_RETRIES;
+  runs = 0U;
+  while ( s->busy && runs++ < 1000U )
+  {
+    CONFIG_Update();
+  }
+  SimCheck(s->errors == 1U + CONFIG_RETRIES && s->sequence == 2U, "commit given up after the retries");
+  SimFeeFail = 0U;
+
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_NoError && s->copy == 1U && !memcmp(cfg, &expect, sizeof(expect)),
+           "newest copy loaded");
+
+  printf("reset during a commit:\n");
+  memcpy(saved, SimFlash, sizeof(saved));
+  memcpy(savedWritten, SimWritten, sizeof(savedWritten));
+  (void)CONFIG_Set("GOV_HOLD", 0U, 99);
+  target = (uint8_t)(s->copy ^ 1U);
+  for ( cut = 0U; cut <= length; cut++ )
+  {
+    /* Start the commit, then land only the first cut bytes of the write */
+    memcpy(SimFlash, saved, sizeof(saved));
+    memcpy(SimWritten, savedWritten, sizeof(savedWritten));
+    (void)CONFIG_Init();
+    (void)CONFIG_Set("GOV_HOLD", 0U, 99);
+    (void)CONFIG_Commit();
+    CONFIG_Update();
+    memcpy(SimFlash[CONFIG_FIRST_BLOCK + target], SimFeeCopy, cut);
+
+    err = CONFIG_Init();
+    cuts++;
+    seq = s->sequence;
+    /* Either the old record or, once every byte that differs has landed,
+     * the new one */
+    if ( err == CONFIG_Err_NoError && seq == 3U && cfg->governor.downHold == 99U )
+    {
+      landed++;
+    }
+    else if ( err != CONFIG_Err_NoError || seq != 2U || memcmp(cfg, &expect, sizeof(expect)) )
+    {
+      lost++;
+    }
+  }
+  printf("  %u cut points, new record from %u of them, %u lost both\n", cuts, landed, lost);
+  SimCheck(lost == 0U && landed > 0U && landed < cuts, "old record until the write completes, then the new one");
+  memcpy(SimFlash, saved, sizeof(saved));
+  memcpy(SimWritten, savedWritten, sizeof(savedWritten));
+
+  printf("damaged and foreign records:\n");
+  SimFlash[CONFIG_FIRST_BLOCK + 1U][CONFIG_HEADER_SIZE + 40U] ^= 0x04U;
+  err = CONFIG_Init();
+  expect.governor.downHold = defaults.governor.downHold;
+  SimCheck(err == CONFIG_Err_NoError && s->copy == 0U && s->valid == 0x01U && s->sequence == 1U
+        && !memcmp(cfg, &expect, sizeof(expect)), "bit flip in the newest copy, older copy loaded");
+  runs = SimCommit();
+  SimCheck(s->copy == 1U && s->sequence == 2U, "next commit repairs the damaged copy");
+  expect = *cfg;
+  memcpy(saved, SimFlash, sizeof(saved));
+
+  SimSeal(1U, CONFIG_VERSION + 1U, (uint16_t)sizeof(CONFIG_Data_TypeDef));
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_NoError && s->copy == 0U && s->valid == 0x03U && s->sequence == 2U,
+           "newer schema skipped, older copy loaded");
+  runs = SimCommit();
+  SimCheck(s->copy == 1U && s->sequence == 3U && SimSequence(0U) == 1U,
+           "commit overwrites the unusable copy, numbered after it");
+  memcpy(SimFlash, saved, sizeof(saved));
+
+  SimSeal(1U, CONFIG_VERSION, (uint16_t)(sizeof(CONFIG_Data_TypeDef) - 4U));
+  SimSeal(0U, CONFIG_VERSION, (uint16_t)(sizeof(CONFIG_Data_TypeDef) - 4U));
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_Empty && s->source == CONFIG_Source_Defaults && !memcmp(cfg, &defaults, sizeof(defaults)),
+           "this schema with another length not used");
+  memcpy(SimFlash, saved, sizeof(saved));
+
+  printf("schema migration and limits:\n");
+  memset(&SimFlash[CONFIG_FIRST_BLOCK + 1U][CONFIG_HEADER_SIZE + offsetof(CONFIG_Data_TypeDef, profileDivider)],
+         0xFF, sizeof(defaults.profileDivider));
+  SimSeal(1U, CONFIG_VERSION - 1U, (uint16_t)offsetof(CONFIG_Data_TypeDef, profileDivider));
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_NoError && s->source == CONFIG_Source_Migrated && s->version == CONFIG_VERSION - 1U,
+           "older, shorter record migrated");
+  SimCheck(cfg->mppt.step == 24U && !memcmp(cfg->profileDivider, defaults.profileDivider, sizeof(defaults.profileDivider)),
+           "its fields kept, added fields at their defaults");
+  memcpy(SimFlash, saved, sizeof(saved));
+
+  SimFlash[CONFIG_FIRST_BLOCK + 1U][CONFIG_HEADER_SIZE + offsetof(CONFIG_Data_TypeDef, outputPriority)] = 3U;
+  SimSeal(1U, 1U, (uint16_t)offsetof(CONFIG_Data_TypeDef, outputPriority));
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_NoError && s->source == CONFIG_Source_Migrated && cfg->mppt.step == 24U
+        && !memcmp(cfg->outputPriority, defaults.outputPriority, sizeof(defaults.outputPriority)),
+           "version 1 record takes the default output priorities");
+  memcpy(SimFlash, saved, sizeof(saved));
+
+  SimFlash[CONFIG_FIRST_BLOCK + 1U][CONFIG_HEADER_SIZE + offsetof(CONFIG_Data_TypeDef, profileDivider)] = 0U;
+  SimFlash[CONFIG_FIRST_BLOCK + 1U][CONFIG_HEADER_SIZE + offsetof(CONFIG_Data_TypeDef, chemistry)] = 7U;
+  SimSeal(1U, CONFIG_VERSION, (uint16_t)sizeof(CONFIG_Data_TypeDef));
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_NoError && s->copy == 1U && cfg->profileDivider[0] == defaults.profileDivider[0]
+        && cfg->chemistry == defaults.chemistry && cfg->mppt.step == 24U,
+           "values out of limits put back to their defaults");
+
+  printf("no flash:\n");
+  SimFeeMissing = 1U;
+  err = CONFIG_Init();
+  SimCheck(err == CONFIG_Err_Empty && !s->flash && !memcmp(cfg, &defaults, sizeof(defaults)),
+           "boots on the defaults");
+  SimCheck(CONFIG_Set("MPPT_STEP", 0U, 24) == CONFIG_Err_NoError && CONFIG_Commit() == CONFIG_Err_Flash
+        && !s->busy, "commit refused");
+
+  printf("\n");
+  CONFIG_PrintStats(PORT_UART_UART0);
+
+  printf("%s\n", SimFailures ? "FAIL" : "PASS");
+
+  return SimFailures ? 1 : 0;
+}
@@ -0,0 +1,793 @@
+/** @file flashlog_sim.c
+*   @brief Host simulation of the telemetry flash log
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*   Runs the firmware flashlog.c and print.c unmodified on a RAM backed
+*   PORT_FEE that completes a write after a number of main function calls,
+*   like the polled TI FEE does, and checks that the write buffer is left
+*   alone until then.
+*
+*   The telemetry is a synthetic LEO day at 1 Hz: 95 min orbits with 60 min
+*   of sunlight, four panels on a spinning body, the board rails, a battery
+*   bus that charges in the sun and discharges in eclipse, six switched
+*   outputs with a radio that transmits for 30 s every 10 min, twelve
+*   outputs off, four board temperatures following the orbit, INA226
+*   noise and the occasional failed channel. The log task runs every 100 ms,
+*   as on the target.
+*
+*   During the run the log is reset three times: after a flush, without a
+*   flush, and with the checkpoint of the head block damaged. At the end
+*   every block of the ring is decoded and compared with the telemetry that
+*   was logged, then a few time range queries are streamed through
+*   history.c, the KISS frames are decoded and checked against the
+*   telemetry, and the blocks each query read are checked against the
+*   blocks that overlap its range.
+*
+*   Build and run from this directory:
+*
+*     gcc -O2 -Wall -DPROFILE_ENABLE=0
+*         -I../../firmware/blinky/include
+*         -I../../firmware/blinky/drivers
+*         flashlog_sim.c ../../firmware/blinky/drivers/flashlog.c
+*         ../../firmware/blinky/drivers/history.c
+*         ../../firmware/blinky/drivers/kiss.c
+*         ../../firmware/blinky/drivers/print.c
+*         -lm -o flashlog_sim && ./flashlog_sim
+*
+*   Options:
+*     -d <hours>  Length of the run (default 24)
+*
+*   Exits with a non-zero status if a decoded value is off by more than
+*   the deadband plus half an LSB, a record is out of order or missing
+*   where no reset explains it, or the ring holds less than it should.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "flashlog.h"
+#include "history.h"
+#include "kiss.h"
+#include "port_fee.h"
+#include "governor.h"
+#include "telemetry.h"
+#include "print.h"
+
+#define SIM_PI              (3.14159265358979)
+
+/* 2026-10-19 00:00:00 in s since 2000 */
+#define SIM_EPOCH           (845683200ULL)
+
+#define SIM_ORBIT           (5700U)
+#define SIM_SUNLIT          (3600U)
+#define SIM_SPIN            (600U)
+
+/* INA226 noise after averaging */
+#define SIM_NOISE_V         (2.5e-3)
+#define SIM_NOISE_I         (0.6e-3)
+#define SIM_NOISE_T         (0.01)
+
+/* Main function calls per FEE block write */
+#define SIM_FEE_CALLS       (40U)
+
+/* FEE virtual sector, live data copied on every erase, and endurance */
+#define SIM_SECTOR_SIZE     (32768.0)
+#define SIM_LIVE_SIZE       ((double)(FLASHLOG_NUM_BLOCKS * (FLASHLOG_BLOCK_SIZE + 24U)))
+#define SIM_ERASE_CYCLES    (100000.0)
+
+/* Log task runs per 1 s sweep */
+#define SIM_UPDATES         (10U)
+
+static uint8_t SimFlash[FLASHLOG_FIRST_BLOCK + FLASHLOG_NUM_BLOCKS][FLASHLOG_BLOCK_SIZE];
+static uint8_t SimWritten[FLASHLOG_FIRST_BLOCK + FLASHLOG_NUM_BLOCKS];
+static uint8_t SimFeeCopy[FLASHLOG_BLOCK_SIZE];
+static uint8_t *SimFeeData;
+static uint16_t SimFeeBlock;
+static uint32_t SimFeeBusy = 0U;
+static uint32_t SimFeeWrites = 0U;
+static uint32_t SimBufferChanged = 0U;
+
+static TELEMETRY_Snapshot_TypeDef SimSnapshot;
+static TELEMETRY_Snapshot_TypeDef *SimRef;
+static uint8_t *SimDecoded;
+static uint64_t SimRandom = 0x9E3779B97F4A7C15ULL;
+
+/* UART output of a query, captured instead of printed */
+static uint8_t SimUart[1U << 20];
+static uint32_t SimUartLength;
+static uint8_t SimCapture = 0U;
+
+/*******************************************************************************
+ ****************************   FIRMWARE STUBS   *******************************
+ ******************************************************************************/
+
+PORT_FEE_Err_TypeDef PORT_FEE_Init(void)
+{
+  /* A write cut by the reset never lands */
+  SimFeeBusy = 0U;
+  return PORT_FEE_Err_NoError;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_WriteAsync(uint16_t block, uint8_t *data)
+{
+  if ( SimFeeBusy )
+  {
+    return PORT_FEE_Err_Busy;
+  }
+  if ( block < FLASHLOG_FIRST_BLOCK || block >= FLASHLOG_FIRST_BLOCK + FLASHLOG_NUM_BLOCKS )
+  {
+    return PORT_FEE_Err_Failed;
+  }
+
+  SimFeeBlock = block;
+  SimFeeData = data;
+  memcpy(SimFeeCopy, data, FLASHLOG_BLOCK_SIZE);
+  SimFeeBusy = SIM_FEE_CALLS;
+
+  return PORT_FEE_Err_NoError;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_Read(uint16_t block,
+                                   uint16_t offset,
+                                   uint8_t *data,
+                                   uint16_t length)
+{
+  if ( SimFeeBusy )
+  {
+    return PORT_FEE_Err_Busy;
+  }
+  if ( block >= FLASHLOG_FIRST_BLOCK + FLASHLOG_NUM_BLOCKS || !SimWritten[block]
+    || offset + length > FLASHLOG_BLOCK_SIZE )
+  {
+    return PORT_FEE_Err_Invalid;
+  }
+
+  memcpy(data, &SimFlash[block][offset], length);
+
+  return PORT_FEE_Err_NoError;
+}
+
+PORT_FEE_Err_TypeDef PORT_FEE_GetResult(void)
+{
+  return SimFeeBusy ? PORT_FEE_Err_Busy : PORT_FEE_Err_NoError;
+}
+
+uint8_t PORT_FEE_Busy(void)
+{
+  return SimFeeBusy ? 1U : 0U;
+}
+
+void PORT_FEE_MainFunction(void)
+{
+  if ( SimFeeBusy && --SimFeeBusy == 0U )
+  {
+    if ( memcmp(SimFeeData, SimFeeCopy, FLASHLOG_BLOCK_SIZE) )
+    {
+      SimBufferChanged++;
+    }
+    memcpy(SimFlash[SimFeeBlock], SimFeeCopy, FLASHLOG_BLOCK_SIZE);
+    SimWritten[SimFeeBlock] = 1U;
+    SimFeeWrites++;
+  }
+}
+
+GOVERNOR_Err_TypeDef GOVERNOR_Request(GOVERNOR_Client_TypeDef client,
+                                      GOVERNOR_Level_TypeDef level)
+{
+  (void)client;
+  (void)level;
+  return GOVERNOR_Err_NoError;
+}
+
+GOVERNOR_Err_TypeDef GOVERNOR_Release(GOVERNOR_Client_TypeDef client)
+{
+  (void)client;
+  return GOVERNOR_Err_NoError;
+}
+
+const TELEMETRY_Snapshot_TypeDef *TELEMETRY_GetSnapshot(void)
+{
+  return &SimSnapshot;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_SendByte(PORT_UART_Reg_TypeDef *uart,
+                                         char data)
+{
+  (void)uart;
+  putchar(data);
+  return PORT_UART_Err_NoError;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_Send(PORT_UART_Reg_TypeDef *uart,
+                                     uint32_t length,
+                                     char *data)
+{
+  (void)uart;
+  if ( SimCapture )
+  {
+    if ( SimUartLength + length <= sizeof(SimUart) )
+    {
+      memcpy(&SimUart[SimUartLength], data, length);
+    }
+    SimUartLength += length;
+    return PORT_UART_Err_NoError;
+  }
+  fwrite(data, 1U, length, stdout);
+  return PORT_UART_Err_NoError;
+}
+
+/*******************************************************************************
+ ******************************   TELEMETRY   **********************************
+ ******************************************************************************/
+
+static double SimUniform(void)
+{
+  SimRandom ^= SimRandom << 13;
+  SimRandom ^= SimRandom >> 7;
+  SimRandom ^= SimRandom << 17;
+  return (double)(SimRandom >> 11) / 9007199254740992.0;
+}
+
+static double SimGauss(void)
+{
+  double u1 = SimUniform();
+  double u2 = SimUniform();
+
+  if ( u1 < 1e-300 )
+  {
+    u1 = 1e-300;
+  }
+
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * SIM_PI * u2);
+}
+
+static void SimChannel(TELEMETRY_Snapshot_TypeDef *snap, uint32_t ch, double v, double i)
+{
+  snap->meas[ch].voltage = (int32_t)lrint((v + SIM_NOISE_V * SimGauss()) * 1e6);
+  snap->meas[ch].current = (int32_t)lrint((i + SIM_NOISE_I * SimGauss()) * 1e6);
+}
+
+/* Telemetry of second t of the run */
+static void SimSweep(uint32_t t, uint32_t sequence, TELEMETRY_Snapshot_TypeDef *snap)
+{
+  uint32_t phase = t % SIM_ORBIT;
+  uint8_t sun = (phase < SIM_SUNLIT) ? 1U : 0U;
+  double elevation = sun ? sin(SIM_PI * phase / SIM_SUNLIT) : 0.0;
+  double orbit = sin(2.0 * SIM_PI * phase / SIM_ORBIT);
+  double spin;
+  uint8_t radio = ((t % 600U) < 30U) ? 1U : 0U;
+  uint32_t i;
+
+  memset(snap, 0, sizeof(*snap));
+  snap->timestamp = t * 1000U + 5U;
+  snap->time = (SIM_EPOCH + t) * 1000000ULL;
+  snap->sequence = sequence;
+
+  for ( i = 0U; i < 4U; i++ )
+  {
+    spin = 0.5 + 0.5 * cos(2.0 * SIM_PI * t / SIM_SPIN + i * SIM_PI / 2.0);
+    SimChannel(snap, TELEMETRY_Channel_MPPT1 + i,
+               sun ? 15.5 + 0.8 * elevation * spin : 0.0,
+               sun ? 0.35 * elevation * spin : 0.0);
+  }
+
+  SimChannel(snap, TELEMETRY_Channel_EPS3V3, 3.30, 0.045);
+  SimChannel(snap, TELEMETRY_Channel_EPS1V2, 1.20, 0.080);
+  SimChannel(snap, TELEMETRY_Channel_PV3V3, sun ? 3.30 : 0.0, sun ? 0.005 : 0.0);
+  SimChannel(snap, TELEMETRY_Channel_3V3BUS, 3.31, 0.150 + (radio ? 0.800 : 0.0));
+  SimChannel(snap, TELEMETRY_Channel_1V2BUS, 1.21, 0.020);
+  SimChannel(snap, TELEMETRY_Channel_5V0BUS, 5.02, 0.220);
+  SimChannel(snap, TELEMETRY_Channel_BATBUS, 7.6 + 0.3 * orbit + (sun ? 0.1 : -0.1),
+             sun ? 0.6 * elevation - 0.45 : -0.45 - (radio ? 0.4 : 0.0));
+
+  for ( i = 0U; i < 6U; i++ )
+  {
+    SimChannel(snap, TELEMETRY_Channel_OUTPUT01 + i, (i & 1U) ? 5.0 : 3.3,
+               0.050 + 0.020 * i + ((i == 2U && radio) ? 0.800 : 0.0));
+  }
+  for ( i = 6U; i < 18U; i++ )
+  {
+    SimChannel(snap, TELEMETRY_Channel_OUTPUT01 + i, 0.0, 0.0);
+  }
+
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    snap->temp[i] = (int32_t)lrint((20.0 + 8.0 * orbit + 2.0 * i + SIM_NOISE_T * SimGauss()) * 1000.0);
+  }
+
+  /* A failed channel reads zero */
+  if ( SimUniform() < 0.001 )
+  {
+    i = (uint32_t)(SimUniform() * TELEMETRY_NUM_CHANNELS);
+    snap->errors |= 1UL << i;
+    snap->meas[i].voltage = 0;
+    snap->meas[i].current = 0;
+  }
+  if ( SimUniform() < 0.0005 )
+  {
+    i = (uint32_t)(SimUniform() * TELEMETRY_NUM_TEMPS);
+    snap->tempErrors |= 1UL << i;
+    snap->temp[i] = 0;
+  }
+}
+
+/*******************************************************************************
+ *******************************   CHECKS   ************************************
+ ******************************************************************************/
+
+static void SimRunTask(uint32_t runs)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < runs; i++ )
+  {
+    FLASHLOG_Update();
+  }
+}
+
+static uint32_t SimCompare(const TELEMETRY_Snapshot_TypeDef *got, const TELEMETRY_Snapshot_TypeDef *ref)
+{
+  const int32_t tolV = FLASHLOG_DEADBAND_VOLTAGE * FLASHLOG_LSB_VOLTAGE + FLASHLOG_LSB_VOLTAGE / 2;
+  const int32_t tolI = FLASHLOG_DEADBAND_CURRENT * FLASHLOG_LSB_CURRENT + FLASHLOG_LSB_CURRENT / 2;
+  const int32_t tolT = FLASHLOG_DEADBAND_TEMP * FLASHLOG_LSB_TEMP + FLASHLOG_LSB_TEMP / 2;
+  uint32_t bad = 0U;
+  uint32_t i;
+
+  if ( got->time != ref->time || got->sequence != ref->sequence
+    || got->errors != ref->errors || got->tempErrors != ref->tempErrors )
+  {
+    bad++;
+  }
+  for ( i = 0U; i < TELEMETRY_NUM_CHANNELS; i++ )
+  {
+    if ( abs(got->meas[i].voltage - ref->meas[i].voltage) > tolV
+      || abs(got->meas[i].current - ref->meas[i].current) > tolI )
+    {
+      bad++;
+    }
+  }
+  for ( i = 0U; i < TELEMETRY_NUM_TEMPS; i++ )
+  {
+    if ( abs(got->temp[i] - ref->temp[i]) > tolT )
+    {
+      bad++;
+    }
+  }
+
+  return bad;
+}
+
+/* Decode the whole ring, oldest first; returns the number of failures */
+static uint32_t SimVerify(uint32_t seconds, uint32_t *first, uint32_t *last, uint32_t *decoded)
+{
+  static uint8_t block[FLASHLOG_BLOCK_SIZE];
+  static FLASHLOG_Cursor_TypeDef cursor;
+  static TELEMETRY_Snapshot_TypeDef snap;
+  const FLASHLOG_State_TypeDef *s = FLASHLOG_GetState();
+  FLASHLOG_Err_TypeDef err;
+  uint32_t failures = 0U;
+  uint32_t mismatches = 0U;
+  int64_t prev = -1;
+  uint64_t t;
+  uint32_t r;
+
+  *decoded = 0U;
+  *first = 0U;
+  *last = 0U;
+  memset(SimDecoded, 0, seconds);
+
+  for ( r = s->tail; r <= s->head; r++ )
+  {
+    err = FLASHLOG_ReadBlock(r, block);
+    if ( err == FLASHLOG_Err_Invalid && r == s->head )
+    {
+      continue;
+    }
+    if ( err != FLASHLOG_Err_NoError || FLASHLOG_CursorInit(&cursor, block) != FLASHLOG_Err_NoError )
+    {
+      printf("  block %u: read error %d\n", r, err);
+      failures++;
+      continue;
+    }
+
+    while ( (err = FLASHLOG_CursorNext(&cursor, &snap)) == FLASHLOG_Err_NoError )
+    {
+      t = snap.time / 1000000ULL - SIM_EPOCH;
+      if ( t >= seconds || (int64_t)t <= prev )
+      {
+        printf("  block %u: record %u out of order\n", r, cursor.index);
+        failures++;
+        break;
+      }
+      if ( prev < 0 )
+      {
+        *first = (uint32_t)t;
+      }
+      prev = (int64_t)t;
+      SimDecoded[t] = 1U;
+      mismatches += SimCompare(&snap, &SimRef[t]) ? 1U : 0U;
+      (*decoded)++;
+    }
+    if ( err != FLASHLOG_Err_End )
+    {
+      printf("  block %u: decode error %d at record %u\n", r, err, cursor.index);
+      failures++;
+    }
+  }
+
+  *last = (uint32_t)prev;
+  if ( mismatches )
+  {
+    printf("  %u records off by more than the deadband\n", mismatches);
+    failures++;
+  }
+
+  return failures;
+}
+
+static uint32_t SimGet(const uint8_t *buf, uint8_t size)
+{
+  uint32_t val = 0U;
+
+  while ( size-- > 0U )
+  {
+    val = (val << 8) | *buf++;
+  }
+
+  return val;
+}
+
+/* Ring blocks whose records overlap [from, to] in s since SIM_EPOCH */
+static uint32_t SimOverlap(uint32_t from, uint32_t to)
+{
+  const FLASHLOG_State_TypeDef *s = FLASHLOG_GetState();
+  const FLASHLOG_Index_TypeDef *entry;
+  const FLASHLOG_Index_TypeDef *next;
+  uint64_t start = (SIM_EPOCH + from) * 1000000ULL;
+  uint64_t end = (SIM_EPOCH + to) * 1000000ULL;
+  uint32_t blocks = 0U;
+  uint32_t r, n;
+
+  for ( r = s->tail; r <= s->head; r++ )
+  {
+    entry = FLASHLOG_GetIndex(r);
+    if ( entry == 0 || entry->time * FLASHLOG_TIME_UNIT > end )
+    {
+      continue;
+    }
+
+    next = 0;
+    for ( n = r + 1U; n <= s->head && next == 0; n++ )
+    {
+      next = FLASHLOG_GetIndex(n);
+    }
+    if ( next == 0 || next->time * FLASHLOG_TIME_UNIT > start )
+    {
+      blocks++;
+    }
+  }
+
+  return blocks;
+}
+
+/* Stream a query through history.c, decode the KISS frames and check the
+ * points; from and to in s since SIM_EPOCH. Returns the number of failures */
+static uint32_t SimQuery(uint32_t seconds, uint8_t channel, HISTORY_Quantity_TypeDef quantity,
+                         uint32_t from, uint32_t to)
+{
+  static uint8_t frame[KISS_MAX_LENGTH + 3U];
+  const TELEMETRY_Snapshot_TypeDef *ref;
+  const HISTORY_State_TypeDef *state = HISTORY_GetState();
+  const char *names[] = { "VOLT", "CURR", "POWER", "TEMP" };
+  uint32_t expected = 0U;
+  uint32_t points = 0U;
+  uint32_t frames = 0U;
+  uint32_t failures = 0U;
+  uint32_t mismatches = 0U;
+  uint32_t overlap = SimOverlap(from, to);
+  uint32_t runs = 0U;
+  uint32_t n = 0U;
+  uint32_t pos, k, t;
+  uint8_t escaped = 0U;
+  uint8_t last = 0U;
+  int64_t prev = -1;
+  double v, i, tol, want;
+  int32_t value;
+
+  for ( t = from; t <= to && t < seconds; t++ )
+  {
+    ref = &SimRef[t];
+    if ( SimDecoded[t] && !((quantity == HISTORY_Quantity_Temp ? ref->tempErrors : ref->errors) & (1UL << channel)) )
+    {
+      expected++;
+    }
+  }
+
+  SimUartLength = 0U;
+  SimCapture = 1U;
+  if ( HISTORY_Start(PORT_UART_UART0, channel, quantity,
+                     (SIM_EPOCH + from) * 1000000ULL, (SIM_EPOCH + to) * 1000000ULL) != HISTORY_Err_NoError )
+  {
+    SimCapture = 0U;
+    printf("  query %u %s %u..%u s: start failed\n", channel, names[quantity], from, to);
+    return 1U;
+  }
+  while ( state->active && runs++ < 100000U )
+  {
+    HISTORY_Update();
+  }
+  SimCapture = 0U;
+
+  if ( SimUartLength > sizeof(SimUart) )
+  {
+    printf("  query %u %s %u..%u s: capture overflow\n", channel, names[quantity], from, to);
+    return 1U;
+  }
+
+  for ( pos = 0U; pos < SimUartLength; pos++ )
+  {
+    if ( SimUart[pos] == KISS_FEND )
+    {
+      if ( n == 0U )
+      {
+        continue;
+      }
+
+      /* Port and command, payload, CRC */
+      if ( n < 3U + HISTORY_HEADER_SIZE || frame[0] != (HISTORY_KISS_PORT << 4)
+        || KISS_Crc16(0xFFFFU, &frame[1], (uint16_t)(n - 3U)) != SimGet(&frame[n - 2U], 2U)
+        || frame[1] != HISTORY_TYPE_SERIES || frame[3] != channel || frame[4] != quantity
+        || SimGet(&frame[5], 2U) != frames
+        || n != 3U + HISTORY_HEADER_SIZE + frame[7] * HISTORY_POINT_SIZE || last )
+      {
+        printf("  query %u %s %u..%u s: bad frame %u\n", channel, names[quantity], from, to, frames);
+        failures++;
+        n = 0U;
+        continue;
+      }
+
+      for ( k = 0U; k < frame[7]; k++ )
+      {
+        const uint8_t *point = &frame[1U + HISTORY_HEADER_SIZE + k * HISTORY_POINT_SIZE];
+        uint64_t time = ((uint64_t)SimGet(point, 4U) << 32) | SimGet(point + 4U, 4U);
+
+        value = (int32_t)SimGet(point + 8U, 4U);
+        t = (uint32_t)(time / 1000000ULL - SIM_EPOCH);
+        if ( t < from || t > to || t >= seconds || (int64_t)t <= prev )
+        {
+          mismatches++;
+          continue;
+        }
+        prev = t;
+
+        ref = &SimRef[t];
+        v = ref->meas[channel].voltage;
+        i = ref->meas[channel].current;
+        switch ( quantity )
+        {
+          case HISTORY_Quantity_Voltage:
+            want = v;
+            tol = FLASHLOG_DEADBAND_VOLTAGE * FLASHLOG_LSB_VOLTAGE + FLASHLOG_LSB_VOLTAGE / 2;
+            break;
+          case HISTORY_Quantity_Current:
+            want = i;
+            tol = FLASHLOG_DEADBAND_CURRENT * FLASHLOG_LSB_CURRENT + FLASHLOG_LSB_CURRENT / 2;
+            break;
+          case HISTORY_Quantity_Power:
+            want = v * i / 1e6;
+            tol = (1.5 * FLASHLOG_LSB_VOLTAGE * fabs(i) + 1.5 * FLASHLOG_LSB_CURRENT * fabs(v)
+                   + 2.25 * FLASHLOG_LSB_VOLTAGE * FLASHLOG_LSB_CURRENT) / 1e6 + 1.0;
+            break;
+          default:
+            want = ref->temp[channel];
+            tol = FLASHLOG_DEADBAND_TEMP * FLASHLOG_LSB_TEMP + FLASHLOG_LSB_TEMP / 2;
+            break;
+        }
+        if ( fabs(value - want) > tol )
+        {
+          mismatches++;
+        }
+        points++;
+      }
+
+      last = (frame[2] & HISTORY_FLAG_LAST) ? 1U : 0U;
+      frames++;
+      n = 0U;
+    }
+    else if ( SimUart[pos] == KISS_FESC )
+    {
+      escaped = 1U;
+    }
+    else if ( n < sizeof(frame) )
+    {
+      frame[n++] = escaped ? ((SimUart[pos] == KISS_TFEND) ? KISS_FEND : KISS_FESC) : SimUart[pos];
+      escaped = 0U;
+    }
+  }
+
+  printf("  query %2u %-5s %6u..%6u s: %4u points in %3u frames, %5u bytes, %2u of %2u blocks read\n",
+         channel, names[quantity], from, to, points, frames, SimUartLength, state->blocks, overlap);
+
+  if ( !last || points != expected || points != state->points )
+  {
+    printf("    %u points expected, last frame %s\n", expected, last ? "seen" : "missing");
+    failures++;
+  }
+  if ( mismatches )
+  {
+    printf("    %u points off by more than the deadband\n", mismatches);
+    failures++;
+  }
+  if ( state->blocks > overlap )
+  {
+    printf("    read blocks outside the range\n");
+    failures++;
+  }
+
+  return failures;
+}
+
+/*******************************************************************************
+ *********************************   MAIN   ************************************
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+  uint32_t seconds = 24U * 3600U;
+  uint32_t resets[3];
+  uint32_t resumed[3] = { 0U, 0U, 0U };
+  uint32_t failures = 0U;
+  uint32_t sequence = 0U;
+  uint32_t first, last, decoded, missing;
+  uint32_t t, i, r;
+  double bytesPerRecord, written, erases;
+  int a;
+
+  for ( a = 1; a < argc; a++ )
+  {
+    if ( !strcmp(argv[a], "-d") && a + 1 < argc )
+    {
+      seconds = (uint32_t)(atof(argv[++a]) * 3600.0);
+    }
+    else
+    {
+      printf("usage: %s [-d hours]\n", argv[0]);
+      return 2;
+    }
+  }
+  if ( seconds < 4U * 3600U )
+  {
+    seconds = 4U * 3600U;
+  }
+
+  SimRef = calloc(seconds, sizeof(*SimRef));
+  SimDecoded = calloc(seconds, 1U);
+  if ( SimRef == 0 || SimDecoded == 0 )
+  {
+    printf("out of memory\n");
+    return 2;
+  }
+
+  /* Resets late in the run so the ring still holds them at the end */
+  resets[0] = seconds - 1100U;
+  resets[1] = seconds - 700U;
+  resets[2] = seconds - 300U;
+
+  printf("%u blocks of %u bytes, %u values per record, %.1f h at 1 Hz\n",
+         FLASHLOG_NUM_BLOCKS, FLASHLOG_BLOCK_SIZE, FLASHLOG_NUM_VALUES, seconds / 3600.0);
+
+  if ( FLASHLOG_Init() != FLASHLOG_Err_NoError )
+  {
+    printf("init failed\n");
+    return 1;
+  }
+
+  for ( t = 0U; t < seconds; t++ )
+  {
+    for ( r = 0U; r < 3U; r++ )
+    {
+      if ( t != resets[r] )
+      {
+        continue;
+      }
+
+      if ( r != 1U )
+      {
+        /* Planned reset: checkpoint and let the write land */
+        (void)FLASHLOG_Flush();
+        SimRunTask(SIM_UPDATES);
+      }
+      if ( r == 2U )
+      {
+        /* Damage the end of the head checkpoint */
+        i = FLASHLOG_FIRST_BLOCK + FLASHLOG_GetState()->head % FLASHLOG_NUM_BLOCKS;
+        SimFlash[i][FLASHLOG_HEADER_SIZE + SimFlash[i][22] + 256U * SimFlash[i][23] - 2U] = 0xFFU;
+      }
+
+      if ( FLASHLOG_Init() != FLASHLOG_Err_NoError )
+      {
+        printf("init after reset %u failed\n", r);
+        failures++;
+      }
+      resumed[r] = FLASHLOG_GetState()->resumed;
+      printf("reset %u at %u s: %u records of the head block resumed\n", r, t, resumed[r]);
+
+      /* Telemetry restarts its sequence with the processor */
+      sequence = 0U;
+    }
+
+    SimSweep(t, sequence++, &SimSnapshot);
+    SimRef[t] = SimSnapshot;
+    SimRunTask(SIM_UPDATES);
+  }
+
+  /* Let the last write land */
+  SimRunTask(SIM_UPDATES);
+
+  failures += SimVerify(seconds, &first, &last, &decoded);
+
+  /* A minute, a span over the resets, a whole block and the ring */
+  printf("range queries:\n");
+  failures += SimQuery(seconds, TELEMETRY_Channel_MPPT1, HISTORY_Quantity_Voltage, first + 600U, first + 659U);
+  failures += SimQuery(seconds, TELEMETRY_Channel_BATBUS, HISTORY_Quantity_Power, resets[0] - 120U, resets[2] + 120U);
+  failures += SimQuery(seconds, TELEMETRY_Channel_3V3BUS, HISTORY_Quantity_Current, first + 300U, first + 420U);
+  failures += SimQuery(seconds, TELEMETRY_Temp_TEMP2, HISTORY_Quantity_Temp, 0U, seconds - 1U);
+
+  missing = 0U;
+  for ( t = first; t <= last; t++ )
+  {
+    missing += SimDecoded[t] ? 0U : 1U;
+  }
+
+  bytesPerRecord = (double)FLASHLOG_GetState()->bytes / FLASHLOG_GetState()->records;
+  written = (double)SimFeeWrites * FLASHLOG_BLOCK_SIZE * 86400.0 / seconds;
+  erases = written / (SIM_SECTOR_SIZE - SIM_LIVE_SIZE);
+
+  printf("\n");
+  FLASHLOG_PrintStats(PORT_UART_UART0);
+  printf("\n%.2f bytes per record, %.1f values per byte\n",
+         bytesPerRecord, FLASHLOG_NUM_VALUES / bytesPerRecord);
+  printf("ring holds %u records, %u s to %u s, %.1f min\n",
+         decoded, first, last, (last - first + 1U) / 60.0);
+  printf("%u missing in that span\n", missing);
+  printf("flash writes %u, %.0f kB per day, about %.0f sector erases per day, %.0f years to %.0f cycles\n",
+         SimFeeWrites, written / 1024.0, erases, SIM_ERASE_CYCLES / erases / 365.0, SIM_ERASE_CYCLES);
+
+  if ( SimBufferChanged )
+  {
+    printf("write buffer changed during %u writes\n", SimBufferChanged);
+    failures++;
+  }
+  if ( last != seconds - 1U )
+  {
+    printf("last record %u, expected %u\n", last, seconds - 1U);
+    failures++;
+  }
+  if ( resumed[0] == 0U || resumed[2] == 0U )
+  {
+    printf("checkpoint not resumed\n");
+    failures++;
+  }
+
+  /* The unflushed reset loses up to a checkpoint interval, the damaged
+   * checkpoint its last record */
+  if ( missing > FLASHLOG_CHECKPOINT + 1U )
+  {
+    printf("records missing that no reset explains\n");
+    failures++;
+  }
+  if ( decoded < (FLASHLOG_NUM_BLOCKS - 1U) * (uint32_t)(FLASHLOG_PAYLOAD_SIZE / FLASHLOG_RECORD_MAX) )
+  {
+    printf("ring holds fewer records than its size allows\n");
+    failures++;
+  }
+
+  free(SimRef);
+  free(SimDecoded);
+
+  printf("%s\n", failures ? "FAIL" : "PASS");
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,885 @@
+/** @file idle_model.cpp
+*   @brief Host model of the scheduler and tickless idle manager
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*   Runs the firmware scheduler.c and idle.c unmodified against a simulated
+*   RTI, CPU sleep states and console, so the idle selection policy and the
+*   tick suspend/resume accounting can be checked without hardware. The RTI
+*   registers are C++ proxies so write-one-to-clear flags, set/clear enable
+*   registers and a free running counter that advances with simulated time
+*   behave like the real module; that is the only reason this is C++.
+*
+*   The LOW_POWER layer is replaced by a model with configurable oscillator
+*   start-up, PLL lock and LF LPO error. Power figures are placeholders to
+*   compare policies against each other, replace them with board
+*   measurements before quoting absolute numbers.
+*
+*   The idle policy scenarios run the two longest period tasks so the deep
+*   modes see long gaps; the flight scenarios run the task table of
+*   tasks.h, where the 5 and 10 ms tasks leave no gap long enough for
+*   them, and check that neither misses a deadline, that tickless idle
+*   keeps every release of the tick run and still reaches a deep mode.
+*
+*   Build and run from this directory:
+*
+*     g++ -O2 -Wall -Wno-unknown-pragmas -Wno-write-strings -Wno-sign-compare
+*         -I../../firmware/blinky/include
+*         -I../../firmware/blinky/drivers
+*         idle_model.cpp -o idle_model && ./idle_model
+*
+*   Exits with a non-zero status if a scenario misses a deadline, loses
+*   scheduler ticks, never wakes up, loses a console byte other than the
+*   one that wakes the core or, for the flight table, spends less than
+*   FLIGHT_DEEP_MIN percent of the time in DOZE or SNOOZE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#define PROFILE_ENABLE 0
+
+#include "rti.h"
+#include "sci.h"
+#include "sys_vim.h"
+#include "low_power_mode.h"
+#include "tasks.h"
+
+/*******************************************************************************
+ ****************************   SIMULATED TIME   *******************************
+ ******************************************************************************/
+
+enum SimState { SimRun = 0, SimWfi, SimDoze, SimSnooze, SimExit, SimNumStates };
+
+static const char * const SimStateNames[SimNumStates] =
+{
+  "RUN", "WFI", "DOZE", "SNOOZE", "EXIT"
+};
+
+/* Placeholder MCU power per state in mW, see file header */
+static const double SimPowerMw[SimNumStates] = { 180.0, 90.0, 15.0, 5.0, 40.0 };
+
+struct SimConfig
+{
+  double accessNs;      /* Cost of one RTI register access */
+  double isrNs;         /* Cost of the RTI tick interrupt */
+  double oscStartNs;    /* Oscillator start-up on wakeup from snooze */
+  double pllLockNs;     /* PLL lock after any deep mode */
+  double lpoHz;         /* Actual LF LPO frequency */
+  double uartPeriodNs;  /* Console byte interval, 0 for no traffic */
+};
+
+struct Sim
+{
+  SimConfig cfg;
+  double now;           /* ns */
+  double counterHz;     /* Counter 0 frequency */
+  double frac;          /* Fractional counter counts */
+  double cpuHz;
+  double cycles;
+  SimState state;
+  double stateNs[SimNumStates];
+  double energy;        /* mW ns */
+  uint32_t masked;
+  uint32_t intflag;
+  uint32_t intena;
+  uint32_t gctrl;
+  uint32_t frc;
+  uint32_t comp[4];
+  uint32_t udcp[4];
+  uint32_t cpuc;
+  double nextUart;
+  uint32_t uartPending;
+  uint32_t uartDelivered;
+  uint32_t uartLost;
+  uint32_t uartWakes;   /* Lost bytes that woke the core */
+  uint32_t sciFlr;
+  uint32_t sciGcr2;
+  uint32_t sciInt;
+  uint32_t wakeups;
+  bool stuck;
+};
+
+static Sim sim;
+
+static void SimAdvance(double ns);
+static void SimDeliver(void);
+
+/* Register proxies, every access costs cfg.accessNs */
+struct SimAccess
+{
+  static void Cost(void) { SimAdvance(sim.cfg.accessNs); }
+};
+
+struct SimFrc
+{
+  operator uint32_t() const { SimAccess::Cost(); return sim.frc; }
+  SimFrc &operator=(uint32_t v)
+  {
+    SimAccess::Cost();
+    if ( sim.gctrl & 1U ) { printf("model: FRC0 written while running\n"); exit(2); }
+    sim.frc = v;
+    return *this;
+  }
+};
+
+/* Prescaler, the fraction of a counter 0 count in RTICLK cycles */
+struct SimUc
+{
+  operator uint32_t() const
+  {
+    SimAccess::Cost();
+    return (uint32_t)(sim.frac * (sim.cpuc + 1U));
+  }
+  SimUc &operator=(uint32_t v)
+  {
+    SimAccess::Cost();
+    sim.frac = (double)v / (sim.cpuc + 1U);
+    return *this;
+  }
+};
+
+struct SimWord
+{
+  uint32_t *p;
+  operator uint32_t() const { SimAccess::Cost(); return *p; }
+  SimWord &operator=(uint32_t v) { SimAccess::Cost(); *p = v; return *this; }
+  SimWord &operator|=(uint32_t v) { SimAccess::Cost(); *p |= v; return *this; }
+  SimWord &operator&=(uint32_t v) { SimAccess::Cost(); *p &= v; return *this; }
+};
+
+struct SimFlag
+{
+  operator uint32_t() const { SimAccess::Cost(); return sim.intflag; }
+  SimFlag &operator=(uint32_t v) { SimAccess::Cost(); sim.intflag &= ~v; return *this; }
+};
+
+struct SimSetEna
+{
+  operator uint32_t() const { SimAccess::Cost(); return sim.intena; }
+  SimSetEna &operator=(uint32_t v) { SimAccess::Cost(); sim.intena |= v; return *this; }
+};
+
+struct SimClrEna
+{
+  operator uint32_t() const { SimAccess::Cost(); return sim.intena; }
+  SimClrEna &operator=(uint32_t v) { SimAccess::Cost(); sim.intena &= ~v; return *this; }
+};
+
+/* SCI flags clear on writing one, interrupt enables are set and cleared */
+struct SimSciFlr
+{
+  operator uint32_t() const { SimAccess::Cost(); return sim.sciFlr; }
+  SimSciFlr &operator=(uint32_t v) { SimAccess::Cost(); sim.sciFlr &= ~v; return *this; }
+};
+
+struct SimSciGcr2
+{
+  operator uint32_t() const { SimAccess::Cost(); return sim.sciGcr2; }
+  SimSciGcr2 &operator|=(uint32_t v) { SimAccess::Cost(); sim.sciGcr2 |= v; return *this; }
+  SimSciGcr2 &operator&=(uint32_t v) { SimAccess::Cost(); sim.sciGcr2 &= v; return *this; }
+};
+
+struct SimSciSetInt
+{
+  SimSciSetInt &operator=(uint32_t v) { SimAccess::Cost(); sim.sciInt |= v; return *this; }
+};
+
+struct SimSciClrInt
+{
+  SimSciClrInt &operator=(uint32_t v) { SimAccess::Cost(); sim.sciInt &= ~v; return *this; }
+};
+
+struct SimCnt
+{
+  SimFrc FRCx;
+  SimUc UCx;
+  SimWord CPUCx;
+};
+
+struct SimCmp
+{
+  SimWord COMPx;
+  SimWord UDCPx;
+};
+
+struct SimRti
+{
+  SimWord GCTRL;
+  SimCnt CNT[2];
+  SimCmp CMP[4];
+  SimFlag INTFLAG;
+  SimSetEna SETINTENA;
+  SimClrEna CLEARINTENA;
+
+  SimRti()
+  {
+    GCTRL.p = &sim.gctrl;
+    CNT[0].CPUCx.p = &sim.cpuc;
+    CNT[1].CPUCx.p = &sim.cpuc;     /* Counter 1 unused */
+    for ( int i = 0; i < 4; i++ )
+    {
+      CMP[i].COMPx.p = &sim.comp[i];
+      CMP[i].UDCPx.p = &sim.udcp[i];
+    }
+  }
+};
+
+/* Only the registers idle.c touches, the rest is never accessed */
+struct SimSci : sciBASE_t
+{
+  SimSciFlr FLR;
+  SimSciGcr2 GCR2;
+  SimSciSetInt SETINT;
+  SimSciClrInt CLEARINT;
+};
+
+static SimRti simRti;
+static SimSci simSci;
+
+#undef rtiREG1
+#define rtiREG1 (&simRti)
+#undef sciREG
+#define sciREG (&simSci)
+
+/*******************************************************************************
+ ***************************   TARGET INTRINSICS   *****************************
+ ******************************************************************************/
+
+static uint32_t _disable_IRQ(void)
+{
+  uint32_t old = sim.masked;
+  sim.masked = 1U;
+  return old;
+}
+
+static void _enable_IRQ(void)
+{
+  sim.masked = 0U;
+  SimDeliver();
+}
+
+static void _restore_interrupts(uint32_t old)
+{
+  sim.masked = old;
+  if ( old == 0U )
+  {
+    SimDeliver();
+  }
+}
+
+/*******************************************************************************
+ ***************************   FIRMWARE UNDER TEST   ***************************
+ ******************************************************************************/
+
+#include "print.c"
+#include "histogram.c"
+#include "scheduler.c"
+#include "idle.c"
+
+/*******************************************************************************
+ ******************************   SIMULATION   *********************************
+ ******************************************************************************/
+
+static void SimMatch(uint32_t n)
+{
+  for ( uint32_t c = 0U; c < 2U; c++ )
+  {
+    uint32_t d = sim.comp[c] - sim.frc;
+
+    while ( d != 0U && d <= n )
+    {
+      sim.intflag |= 1UL << c;
+      if ( sim.udcp[c] == 0U )
+      {
+        break;
+      }
+      sim.comp[c] += sim.udcp[c];
+      d = sim.comp[c] - sim.frc;
+    }
+  }
+}
+
+static void SimAdvance(double ns)
+{
+  if ( ns <= 0.0 )
+  {
+    return;
+  }
+
+  sim.now += ns;
+  sim.stateNs[sim.state] += ns;
+  sim.energy += ns * SimPowerMw[sim.state];
+  sim.cycles += ns * sim.cpuHz * 1e-9;
+
+  if ( sim.gctrl & 1U )
+  {
+    double counts = sim.frac + ns * sim.counterHz * 1e-9;
+    uint32_t n = (uint32_t)counts;
+
+    sim.frac = counts - n;
+    SimMatch(n);
+    sim.frc += n;
+  }
+
+  /* Console bytes arrive only while the SCI is clocked, the start bit of
+     one arriving in low power mode sets the wakeup flag */
+  while ( sim.cfg.uartPeriodNs > 0.0 && sim.nextUart <= sim.now )
+  {
+    if ( sim.state == SimDoze || sim.state == SimSnooze || sim.state == SimExit )
+    {
+      sim.uartLost++;
+      if ( (sim.sciGcr2 & IDLE_SCI_POWERDOWN) != 0U && (sim.sciInt & SCI_WAKE_INT) != 0U )
+      {
+        sim.sciFlr |= IDLE_SCI_WAKEUP;
+        sim.uartWakes++;
+      }
+    }
+    else
+    {
+      sim.uartPending++;
+    }
+    sim.nextUart += sim.cfg.uartPeriodNs;
+  }
+}
+
+/* Time until the next enabled compare match or console byte */
+static double SimNextEvent(bool uart)
+{
+  double next = 1e30;
+
+  if ( sim.gctrl & 1U )
+  {
+    for ( uint32_t c = 0U; c < 2U; c++ )
+    {
+      if ( sim.intena & (1UL << c) )
+      {
+        uint32_t d = sim.comp[c] - sim.frc;
+        double t = ((d == 0U ? 4294967296.0 : (double)d) - sim.frac)
+                 / sim.counterHz * 1e9;
+        if ( t < next ) next = t;
+      }
+    }
+  }
+
+  if ( uart && sim.cfg.uartPeriodNs > 0.0 && sim.nextUart - sim.now < next )
+  {
+    next = sim.nextUart - sim.now;
+  }
+
+  return (next < 1.0) ? 1.0 : next;
+}
+
+static bool SimPending(void)
+{
+  return (sim.intflag & sim.intena & 3U) != 0U || sim.uartPending != 0U
+      || (sim.sciFlr & sim.sciInt & SCI_WAKE_INT) != 0U;
+}
+
+static void SimDeliver(void)
+{
+  while ( sim.masked == 0U && SimPending() )
+  {
+    sim.masked = 1U;
+
+    if ( sim.intflag & sim.intena & rtiNOTIFICATION_COMPARE0 )
+    {
+      /* rtiCompare0Interrupt and rtiNotification in sys_main.c */
+      simRti.INTFLAG = rtiNOTIFICATION_COMPARE0;
+      SimAdvance(sim.cfg.isrNs);
+      SCHEDULER_Tick();
+    }
+    else if ( sim.intflag & sim.intena & rtiNOTIFICATION_COMPARE1 )
+    {
+      IDLE_WakeupInterrupt();
+    }
+    else if ( sim.sciFlr & sim.sciInt & SCI_WAKE_INT )
+    {
+      /* sciHighLevelInterrupt, reading the vector clears the flag */
+      sim.sciFlr &= ~(uint32_t)IDLE_SCI_WAKEUP;
+    }
+    else
+    {
+      /* PORT_UART_ISR in sys_main.c */
+      sim.uartPending--;
+      sim.uartDelivered++;
+      IDLE_Hold(IDLE_CONSOLE_HOLD);
+    }
+
+    sim.masked = 0U;
+  }
+}
+
+/* Sleep until an interrupt is pending, console bytes wake from WFI or the
+   SCI low power mode */
+static void SimSleep(SimState state)
+{
+  sim.state = state;
+  sim.wakeups++;
+
+  while ( !SimPending() )
+  {
+    double t = SimNextEvent(state == SimWfi
+                            || ((sim.sciGcr2 & IDLE_SCI_POWERDOWN) != 0U
+                                && (sim.sciInt & SCI_WAKE_INT) != 0U));
+
+    if ( t > 1e12 )
+    {
+      printf("model: no wakeup scheduled, stuck in %s\n", SimStateNames[state]);
+      sim.stuck = true;
+      exit(1);
+    }
+    SimAdvance(t);
+  }
+}
+
+/* Execute for a while with IRQ enabled, as a task does */
+static void SimBusy(double ns)
+{
+  double end = sim.now + ns;
+
+  while ( sim.now < end )
+  {
+    double t = SimNextEvent(true);
+    SimAdvance((end - sim.now < t) ? end - sim.now : t);
+    SimDeliver();
+  }
+}
+
+/*******************************************************************************
+ *****************************   HAL STUBS   ***********************************
+ ******************************************************************************/
+
+void rtiStartCounter(uint32 counter)
+{
+  SimAccess::Cost();
+  sim.gctrl |= 1UL << counter;
+}
+
+void rtiStopCounter(uint32 counter)
+{
+  SimAccess::Cost();
+  sim.gctrl &= ~(1UL << counter);
+}
+
+void rtiEnableNotification(uint32 notification)
+{
+  SimAccess::Cost();
+  sim.intflag &= ~notification;
+  sim.intena |= notification;
+}
+
+void rtiDisableNotification(uint32 notification)
+{
+  SimAccess::Cost();
+  sim.intena &= ~notification;
+}
+
+void _gotoCPUIdle_(void)
+{
+  SimSleep(SimWfi);
+  sim.state = SimRun;
+}
+
+uint32 _pmuGetCycleCount_(void)
+{
+  return (uint32)(uint64_t)sim.cycles;
+}
+
+void vimChannelMap(uint32 request, uint32 channel, t_isrFuncPTR handler)
+{
+  (void)request;
+  (void)channel;
+  (void)handler;
+}
+
+void vimEnableInterrupt(uint32 channel, systemInterrupt_t inttype)
+{
+  (void)channel;
+  (void)inttype;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_SendByte(PORT_UART_Reg_TypeDef *uart,
+                                         char data)
+{
+  (void)uart;
+  putchar(data);
+  return PORT_UART_Err_NoError;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_Send(PORT_UART_Reg_TypeDef *uart,
+                                     uint32_t length,
+                                     char *data)
+{
+  (void)uart;
+  fwrite(data, 1, length, stdout);
+  return PORT_UART_Err_NoError;
+}
+
+uint32_t AD5324_IsBusy(void)
+{
+  return 0U;
+}
+
+uint8_t PORT_CAN_IsBusy(void)
+{
+  return 0U;
+}
+
+/*******************************************************************************
+ ***************************   LOW_POWER MODEL   *******************************
+ ******************************************************************************/
+
+uint32_t LOW_POWER_RtiSourceHz(LOW_POWER_Mode_TypeDef mode)
+{
+  return (mode == LOW_POWER_Mode_Doze) ? LOW_POWER_OSC_HZ : LOW_POWER_LPO_LF_HZ;
+}
+
+void LOW_POWER_SelectRtiClock(LOW_POWER_Mode_TypeDef mode,
+                              LOW_POWER_Context_TypeDef *ctx)
+{
+  if ( sim.gctrl & 1U )
+  {
+    printf("model: RTI clock changed while counting\n");
+    exit(2);
+  }
+  ctx->rclksrc = 1U;
+  sim.counterHz = ((mode == LOW_POWER_Mode_Doze) ? 16e6 : sim.cfg.lpoHz)
+                / (sim.cpuc + 1U);
+}
+
+void LOW_POWER_RestoreRtiClock(const LOW_POWER_Context_TypeDef *ctx)
+{
+  (void)ctx;
+  if ( sim.gctrl & 1U )
+  {
+    printf("model: RTI clock changed while counting\n");
+    exit(2);
+  }
+  sim.counterHz = 80e6 / (sim.cpuc + 1U);
+}
+
+void LOW_POWER_Enter(LOW_POWER_Mode_TypeDef mode,
+                     LOW_POWER_Context_TypeDef *ctx)
+{
+  (void)ctx;
+  SimSleep((mode == LOW_POWER_Mode_Doze) ? SimDoze : SimSnooze);
+
+  /* The core runs once its wakeup clock, the oscillator, is up */
+  sim.state = SimExit;
+  sim.cpuHz = 16e6;
+  if ( mode == LOW_POWER_Mode_Snooze )
+  {
+    SimAdvance(sim.cfg.oscStartNs);
+  }
+}
+
+void LOW_POWER_RestoreClocks(const LOW_POWER_Context_TypeDef *ctx)
+{
+  (void)ctx;
+  SimAdvance(sim.cfg.pllLockNs);
+  sim.cpuHz = 160e6;
+  sim.state = SimRun;
+}
+
+/*******************************************************************************
+ ******************************   SCENARIOS   **********************************
+ ******************************************************************************/
+
+static void HousekeepingTask(void) { SimBusy(20e3); }
+static void TelemetryTask(void)    { SimBusy(12e6); }
+
+/* The two longest period tasks, which leave the gaps the idle policy
+   scenarios need */
+static const SCHEDULER_Task_TypeDef ModelTasks[] =
+{
+  { "HOUSEKEEPING", HousekeepingTask, SCHEDULER_MS(100),  0U,              1U, 0U                },
+  { "TELEMETRY",    TelemetryTask,    SCHEDULER_MS(1000), SCHEDULER_MS(5), 2U, SCHEDULER_MS(100) }
+};
+
+#define MODEL_NUM_TASKS (sizeof(ModelTasks) / sizeof(ModelTasks[0]))
+
+/* Interval at which an on demand task of the flight table releases itself
+   with no CAN traffic, like its module: CANPUB for the next frame due.
+   0 for tasks nothing releases here */
+static uint32_t FlightRearm(uint32_t task)
+{
+  switch ( task )
+  {
+    case TASKS_Id_CANPUB:
+      return SCHEDULER_MS(100);
+    default:
+      return 0U;
+  }
+}
+
+/* Every task of the flight table but the telemetry sweep a short one */
+static void FlightRun(uint32_t task)
+{
+  SimBusy((task == TASKS_Id_TELEMETRY) ? 12e6 : 20e3);
+
+  if ( FlightRearm(task) != 0U )
+  {
+    SCHEDULER_Release(task, FlightRearm(task));
+  }
+}
+
+/* The task table of sys_main.c from tasks.h */
+#define FLIGHT_TASK(name, run, period, offset, prio, deadline) \
+  static void run(void) { FlightRun(TASKS_Id_##name); }
+TASKS_TABLE(FLIGHT_TASK)
+
+static const SCHEDULER_Task_TypeDef FlightTasks[TASKS_NUM_TASKS] =
+{
+  TASKS_TABLE(TASKS_ENTRY)
+};
+
+#define FLIGHT_NUM_TASKS (TASKS_NUM_TASKS)
+
+/* Percent of the flight run tickless idle must spend in DOZE or SNOOZE */
+#define FLIGHT_DEEP_MIN (10.0)
+
+/* Flight table runs of the tick baseline, tickless idle must keep them */
+static uint32_t FlightRuns[FLIGHT_NUM_TASKS];
+
+struct Scenario
+{
+  const char *name;
+  double seconds;
+  bool tickless;          /* Install IDLE_Enter as idle hook */
+  bool userLock;          /* WRITE(IDLE,OFF) */
+  uint32_t lpoParamHz;    /* 0 calibrates at init */
+  double lpoHz;           /* Actual LF LPO */
+  double uartPeriodNs;
+  uint32_t bench;         /* Benchmark periods per mode, 0 for none */
+  bool expectDrift;       /* Miscalibrated LPO, drift is the point */
+  bool flight;            /* FlightTasks instead of ModelTasks */
+};
+
+static const Scenario Scenarios[] =
+{
+  { "tick WFI baseline",          60.0, false, false, 0U,     80e3, 0.0,   0U,  false, false },
+  { "tickless, WFI only",         60.0, true,  true,  0U,     80e3, 0.0,   0U,  false, false },
+  { "tickless, deep modes",       60.0, true,  false, 0U,     80e3, 0.0,   0U,  false, false },
+  { "deep modes, LPO 20% low",    60.0, true,  false, 0U,     64e3, 0.0,   0U,  false, false },
+  { "deep, LPO not calibrated",   60.0, true,  false, 80000U, 64e3, 0.0,   0U,  true,  false },
+  { "deep modes, console 0.5 s",  60.0, true,  false, 0U,     80e3, 500e6, 0U,  false, false },
+  { "deep modes, console 5 s",    60.0, true,  false, 0U,     80e3, 5e9,   0U,  false, false },
+  { "benchmark, 50 per mode",     30.0, true,  false, 0U,     80e3, 0.0,   50U, false, false },
+  { "flight tasks, tick WFI",     60.0, false, false, 0U,     80e3, 0.0,   0U,  false, true  },
+  { "flight tasks, tickless",     60.0, true,  false, 0U,     80e3, 0.0,   0U,  false, true  },
+};
+
+static int RunScenario(const Scenario *sc)
+{
+  const SCHEDULER_Task_TypeDef *tasks = sc->flight ? FlightTasks : ModelTasks;
+  uint32_t numTasks = sc->flight ? FLIGHT_NUM_TASKS : MODEL_NUM_TASKS;
+  IDLE_Params_TypeDef params = IDLE_DefaultParams;
+  int fail = 0;
+  double total;
+  int64_t drift;
+  uint32_t i;
+
+  sim = Sim();
+  sim.cfg.accessNs = 25.0;
+  sim.cfg.isrNs = 2e3;
+  sim.cfg.oscStartNs = 1.5e6;
+  sim.cfg.pllLockNs = 250e3;
+  sim.cfg.lpoHz = sc->lpoHz;
+  sim.cfg.uartPeriodNs = sc->uartPeriodNs;
+  sim.nextUart = (sc->uartPeriodNs > 0.0) ? 3.3e9 : 0.0;
+  sim.counterHz = 10e6;
+  sim.cpuHz = 160e6;
+  sim.cpuc = 7U;
+  sim.comp[0] = 10000U;
+  sim.udcp[0] = 10000U;
+  sim.sciFlr = IDLE_SCI_TX_EMPTY;
+
+  params.lpoHz = sc->lpoParamHz;
+
+  /* Scheduler before IDLE as in sys_main.c, so the boot console hold is
+     taken on the reset tick count of this run, not the one left by the
+     previous scenario */
+  SCHEDULER_Init(tasks, numTasks);
+  for ( i = 0U; sc->flight && i < numTasks; i++ )
+  {
+    if ( FlightRearm(i) != 0U )
+    {
+      SCHEDULER_Release(i, FlightRearm(i));
+    }
+  }
+  IDLE_Init(&params);
+  SCHEDULER_SetIdleHook(sc->tickless ? IDLE_Enter : 0);
+  SCHEDULER_Start();
+
+  if ( sc->userLock )
+  {
+    IDLE_Lock(IDLE_Lock_User);
+  }
+
+  /* Boot console hold expires, then measure from a clean slate */
+  while ( sim.now < 2.5e9 )
+  {
+    SCHEDULER_Dispatch();
+  }
+
+  for ( i = 0U; i < SimNumStates; i++ )
+  {
+    sim.stateNs[i] = 0.0;
+  }
+  sim.energy = 0.0;
+  sim.wakeups = 0U;
+  sim.uartLost = 0U;
+  sim.uartWakes = 0U;
+  sim.uartDelivered = 0U;
+  double start = sim.now;
+  uint32_t startTicks = SCHEDULER_GetTicks();
+  SCHEDULER_ResetStats();
+
+  if ( sc->bench != 0U )
+  {
+    IDLE_BenchStart(sc->bench);
+  }
+  else
+  {
+    IDLE_ResetStats();
+  }
+
+  while ( sim.now - start < sc->seconds * 1e9 &&
+          (sc->bench == 0U || IDLE_BenchRemaining() != 0U) )
+  {
+    SCHEDULER_Dispatch();
+  }
+
+  total = sim.now - start;
+  drift = (int64_t)(SCHEDULER_GetTicks() - startTicks) - (int64_t)(total / 1e6);
+
+  printf("\n== %s (%.1f s, LF LPO %.0f Hz, calibrated %u Hz)\n",
+         sc->name, total / 1e9, sc->lpoHz, (unsigned)IDLE_Params.lpoHz);
+
+  for ( i = 0U; i < SimNumStates; i++ )
+  {
+    printf("  %-7s %6.2f %%\n", SimStateNames[i], 100.0 * sim.stateNs[i] / total);
+  }
+
+  printf("  power   %6.2f mW average, %.1f wakeups/s\n",
+         sim.energy / total, sim.wakeups / (total / 1e9));
+  printf("  ticks   drift %lld against simulated time\n", (long long)drift);
+
+  if ( sc->uartPeriodNs > 0.0 )
+  {
+    printf("  console %u bytes received, %u lost while the SCI was off, %u woke the core\n",
+           sim.uartDelivered, sim.uartLost, sim.uartWakes);
+
+    /* Only the byte that wakes the board may be lost, the hold keeps the
+       clocks running for the rest */
+    if ( sim.uartLost != sim.uartWakes ||
+         (sc->uartPeriodNs < IDLE_CONSOLE_HOLD * 1e6 && sim.uartLost > 1U) )
+    {
+      printf("  FAIL: console bytes lost without waking the core\n");
+      fail = 1;
+    }
+  }
+
+  for ( i = 0U; i < numTasks; i++ )
+  {
+    const SCHEDULER_Stats_TypeDef *st = SCHEDULER_GetStats(i);
+    uint32_t period = (tasks[i].period != 0U || !sc->flight)
+                    ? tasks[i].period : FlightRearm(i);
+    uint32_t expect = (period != 0U) ? (uint32_t)(total / 1e6) / period : 0U;
+
+    printf("  %-12s runs %u/%u latency max %.1f us, misses %u, overruns %u\n",
+           tasks[i].name, st->runs, expect, st->latencyMax / 10.0,
+           st->deadlineMisses, st->overruns);
+
+    if ( sc->flight && !sc->tickless )
+    {
+      FlightRuns[i] = st->runs;
+    }
+    else if ( sc->flight )
+    {
+      expect = FlightRuns[i];
+    }
+
+    /* On demand tasks nothing releases here must stay put */
+    if ( st->deadlineMisses != 0U ||
+         (period == 0U && st->runs != 0U) ||
+         (!sc->expectDrift && st->runs + 1U < expect) )
+    {
+      printf("  FAIL: %s lost releases or missed deadlines\n", tasks[i].name);
+      fail = 1;
+    }
+  }
+
+  if ( sc->flight && !sc->tickless )
+  {
+    printf("  releases are the reference of the tickless run\n");
+  }
+  else if ( sc->flight )
+  {
+    double deep = 100.0 * (sim.stateNs[SimDoze] + sim.stateNs[SimSnooze]) / total;
+
+    if ( deep < FLIGHT_DEEP_MIN )
+    {
+      printf("  FAIL: %.1f %% in DOZE or SNOOZE, expected at least %.0f %%\n",
+             deep, FLIGHT_DEEP_MIN);
+      fail = 1;
+    }
+  }
+
+  if ( sc->expectDrift )
+  {
+    printf("  scheduler time drifts with an uncalibrated LPO, not checked\n");
+  }
+  else if ( drift > 1 || drift < -1 )
+  {
+    printf("  FAIL: scheduler time drifted %lld ticks\n", (long long)drift);
+    fail = 1;
+  }
+
+  for ( i = (uint32_t)IDLE_Mode_Wfi; i < IDLE_NUM_MODES; i++ )
+  {
+    if ( !sc->expectDrift && IDLE_GetStats((IDLE_Mode_TypeDef)i)->late != 0U )
+    {
+      printf("  FAIL: %s woke up after the release\n", IDLE_ModeNames[i]);
+      fail = 1;
+    }
+  }
+
+  fflush(stdout);
+  IDLE_PrintStats(PORT_UART_UART0);
+
+  if ( sc->bench != 0U )
+  {
+    IDLE_BenchPrint(PORT_UART_UART0);
+  }
+
+  return fail;
+}
+
+int main(void)
+{
+  static const uint32_t gaps[] = { 0U, 1U, 2U, 4U, 5U, 19U, 20U, 99U, 100000U };
+  int fail = 0;
+  uint32_t i;
+
+  printf("Idle selection with IDLE_DefaultParams (ticks to release: mode)\n");
+  for ( i = 0U; i < sizeof(gaps) / sizeof(gaps[0]); i++ )
+  {
+    printf("  %6u: %-6s  locked: %s\n", gaps[i],
+           IDLE_ModeNames[IDLE_SelectMode(&IDLE_DefaultParams, gaps[i], 0U)],
+           IDLE_ModeNames[IDLE_SelectMode(&IDLE_DefaultParams, gaps[i],
+                                          IDLE_DEEP_MASK)]);
+  }
+
+  for ( i = 0U; i < sizeof(Scenarios) / sizeof(Scenarios[0]); i++ )
+  {
+    fail |= RunScenario(&Scenarios[i]);
+  }
+
+  printf("\n%s\n", fail ? "FAIL" : "PASS");
+
+  return fail;
+}
@@ -0,0 +1,1076 @@
+/** @file mppt_sim.c
+*   @brief Host simulator of the MPPT controllers against measured XTJ curves
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*   Runs the firmware mppt.c, ina226.c and print.c unmodified, including the
+*   default MPPT_MeasureSensor, MPPT_SetDac and MPPT_CommitDac functions,
+*   against four simulated panels. TELEMETRY_GetSensor hands out INA226
+*   objects whose register access returns the quantised readings of the
+*   panel model. AD5324_Stage and AD5324_Commit model the DAC shadow: a
+*   commit moves the LTC3119 input setpoints of all changed panels at once
+*   and counts one burst.
+*
+*   ivsweep.c runs against the same panels: the RTI counter advances with
+*   every register access by the I2C time of a 100 kHz transfer, and the
+*   traced maximum power point is checked against the model, as is the
+*   clock governor held at its top level for the sweep and released after.
+*
+*   Panel: the 1 mA interpolated IV curve of one Spectrolab XTJ cell
+*   (AM0, 28 C), scaled for irradiance and temperature with the
+*   coefficients of spice_simulations/solar_cell_model.lib.
+*
+*   LTC3119: quasi-static, the input loop settles within a few ms and so
+*   well inside MPPT_PERIOD. The input is held at the MPPC setpoint, or at
+*   open circuit if the setpoint is above it, and the battery takes all the
+*   power offered. The DAC feeds the MPPC node through R95 (100k) next to
+*   R91 (220k) from VIN, so VIN = SIM_VREG_OFFSET - 2.2 * VDAC. The offset
+*   places the lab maximum power point (DAC 0.63 V, see LTC3119_mppt_iv_curves.py)
+*   on the datasheet Vmp.
+*
+*   INA226: bus voltage and shunt voltage registers with their LSB, 5 mOhm
+*   sense resistor and gaussian noise of a fraction of an LSB.
+*
+*   Reports per scenario and algorithm the tracking efficiency against the
+*   true maximum power point, the settling time after every disturbance and
+*   the oscillation once settled, next to the firmware's own figures. Where
+*   the light holds still, every panel is swept once ahead of the steady
+*   window, which the firmware measures its efficiency against.
+*
+*   Build and run from this directory:
+*
+*     gcc -O2 -Wall -I../../firmware/blinky/include
+*         -I../../firmware/blinky/drivers
+*         mppt_sim.c ../../firmware/blinky/drivers/mppt.c
+*         ../../firmware/blinky/drivers/ivsweep.c
+*         ../../firmware/blinky/drivers/ina226.c
+*         ../../firmware/blinky/drivers/print.c
+*         -lm -o mppt_sim && ./mppt_sim
+*
+*   Options:
+*     -c <file>   IV curve CSV (default ../solar_panel_iv_curve_data/interpolatedData.csv)
+*     -s <codes>  Tracking step (default MPPT_DefaultParams)
+*     -d <codes>  Dither step (default MPPT_DefaultParams)
+*     -t <file>   Write a per step trace of every run as CSV
+*
+*   Exits with a non-zero status if a run falls short of its efficiency
+*   limit, does not settle or the firmware reports errors, or if the
+*   firmware's own convergence time or tracking efficiency is outside the
+*   limits of the scenario.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "mppt.h"
+#include "ivsweep.h"
+#include "telemetry.h"
+#include "tca9548a.h"
+#include "ad5324.h"
+#include "ina226.h"
+#include "eps.h"
+#include "governor.h"
+
+#define SIM_CURVE_PATH      "../solar_panel_iv_curve_data/interpolatedData.csv"
+#define SIM_MAX_POINTS      (4096U)
+#define SIM_PANELS          (MPPT_NUM_CHANNELS)
+
+/* Reference conditions and coefficients of the XTJ cell model */
+#define SIM_REF_TEMP        (28.0)
+#define SIM_TK_VOC          (-0.0058)         /* V/C */
+#define SIM_TK_ISC          (0.0003 / 0.472)  /* 1/C, relative */
+#define SIM_NVT             (0.08)            /* V, three junctions */
+
+/* LTC3119 MPPC divider, VIN = offset - gain * VDAC */
+#define SIM_DAC_VREF        (MPPT_DAC_VREF_MV / 1000.0)
+#define SIM_VREG_GAIN       (220.0 / 100.0)
+#define SIM_VREG_OFFSET     (2.348 + SIM_VREG_GAIN * 0.63)
+
+/* INA226 */
+#define SIM_SENSE_OHM       (0.005)
+#define SIM_BUS_LSB         (1.25e-3)
+#define SIM_SHUNT_LSB       (2.5e-6)
+#define SIM_BUS_NOISE       (0.5)             /* LSB rms */
+#define SIM_SHUNT_NOISE     (1.0)             /* LSB rms */
+
+/* INA226 power-on configuration, I2C time of one register access at
+ * 100 kHz in us and RTI counts per us */
+#define SIM_INA226_CONFIG   (0x4127U)
+#define SIM_I2C_REG_US      (450U)
+#define SIM_COUNTS_PER_US   (SCHEDULER_FRC_HZ / 1000000U)
+
+/* A sweep must find this fraction of the maximum power */
+#define SIM_SWEEP_LIMIT     (0.97)
+
+/* Settled means within this fraction of the maximum power point ... */
+#define SIM_SETTLE_BAND     (0.98)
+/* ... for this many consecutive steps */
+#define SIM_SETTLE_HOLD     (10U)
+
+#define SIM_MAX_EVENTS      (4U)
+
+/*******************************************************************************
+ ******************************   PANEL MODEL   ********************************
+ ******************************************************************************/
+
+typedef struct
+{
+  double g;             /* Irradiance relative to AM0 */
+  double temp;          /* Cell temperature in C */
+  uint16_t code;        /* DAC code written by the firmware */
+  double v;             /* Operating point */
+  double i;
+  double vmpp;          /* True maximum power point */
+  double pmpp;
+} SimPanel;
+
+static double SimCurve[SIM_MAX_POINTS];   /* Volts at 1 mA steps */
+static uint32_t SimCurvePoints = 0U;
+static SimPanel SimPanels[SIM_PANELS];
+static INA226_TypeDef SimSensors[SIM_PANELS];
+static uint32_t SimDacWrites = 0U;
+static uint32_t SimDacBursts = 0U;
+static uint32_t SimDacSkipped = 0U;
+static uint16_t SimDacNext[SIM_PANELS];
+static uint32_t SimDacStaged = 0U;
+static uint16_t SimConfig[SIM_PANELS];
+static uint32_t SimCounter = 0U;
+static uint64_t SimRandom = 0x2545F4914F6CDD1DULL;
+
+static int SimLoadCurve(const char *path)
+{
+  FILE *f = fopen(path, "r");
+  char line[128];
+  double ma;
+  double v;
+
+  if ( f == 0 )
+  {
+    printf("cannot open %s\n", path);
+    return -1;
+  }
+
+  SimCurvePoints = 0U;
+  while ( fgets(line, sizeof(line), f) != 0 && SimCurvePoints < SIM_MAX_POINTS )
+  {
+    if ( sscanf(line, "%lf,%lf", &ma, &v) == 2 )
+    {
+      if ( (uint32_t)ma != SimCurvePoints )
+      {
+        printf("%s: expected 1 mA steps, got %g mA at row %u\n",
+               path, ma, SimCurvePoints);
+        fclose(f);
+        return -1;
+      }
+      SimCurve[SimCurvePoints++] = v;
+    }
+  }
+  fclose(f);
+
+  if ( SimCurvePoints < 2U )
+  {
+    printf("%s: no curve data\n", path);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* Reference curve, extrapolated past the last point */
+static double SimCurveAt(double ma)
+{
+  uint32_t n;
+  double f;
+
+  if ( ma <= 0.0 )
+  {
+    return SimCurve[0];
+  }
+
+  n = (uint32_t)ma;
+  if ( n >= SimCurvePoints - 1U )
+  {
+    n = SimCurvePoints - 2U;
+  }
+  f = ma - n;
+
+  return SimCurve[n] + f * (SimCurve[n + 1U] - SimCurve[n]);
+}
+
+static double SimCurrentScale(const SimPanel *p)
+{
+  return p->g * (1.0 + SIM_TK_ISC * (p->temp - SIM_REF_TEMP));
+}
+
+/* Panel voltage at a current in A */
+static double SimPanelV(const SimPanel *p, double i)
+{
+  return SimCurveAt(i * 1000.0 / SimCurrentScale(p))
+       + SIM_NVT * log(p->g)
+       + SIM_TK_VOC * (p->temp - SIM_REF_TEMP);
+}
+
+/* Largest current the model covers, well past short circuit */
+static double SimPanelImax(const SimPanel *p)
+{
+  return SimCurrentScale(p) * (SimCurvePoints + 50U) / 1000.0;
+}
+
+/* Panel current at a voltage, the curve falls monotonically with current */
+static double SimPanelI(const SimPanel *p, double v)
+{
+  double lo = 0.0;
+  double hi = SimPanelImax(p);
+  uint32_t n;
+
+  if ( v >= SimPanelV(p, 0.0) )
+  {
+    return 0.0;
+  }
+
+  for ( n = 0U; n < 60U; n++ )
+  {
+    double mid = 0.5 * (lo + hi);
+    if ( SimPanelV(p, mid) > v )
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return 0.5 * (lo + hi);
+}
+
+/* True maximum power point by golden section on P(I) */
+static void SimPanelMpp(SimPanel *p)
+{
+  const double r = 0.6180339887498949;
+  double a = 0.0;
+  double b = SimPanelImax(p);
+  double c = b - r * (b - a);
+  double d = a + r * (b - a);
+  double i;
+  uint32_t n;
+
+  for ( n = 0U; n < 80U; n++ )
+  {
+    if ( c * SimPanelV(p, c) > d * SimPanelV(p, d) )
+    {
+      b = d;
+    }
+    else
+    {
+      a = c;
+    }
+    c = b - r * (b - a);
+    d = a + r * (b - a);
+  }
+
+  i = 0.5 * (a + b);
+  p->vmpp = SimPanelV(p, i);
+  p->pmpp = p->vmpp * i;
+}
+
+/* Operating point the LTC3119 holds for the code in effect */
+static void SimPanelSolve(SimPanel *p)
+{
+  double vdac = p->code * SIM_DAC_VREF / 4096.0;
+  double vreg = SIM_VREG_OFFSET - SIM_VREG_GAIN * vdac;
+  double voc;
+
+  if ( p->g <= 1e-6 )
+  {
+    p->v = 0.0;
+    p->i = 0.0;
+    p->vmpp = 0.0;
+    p->pmpp = 0.0;
+    return;
+  }
+
+  voc = SimPanelV(p, 0.0);
+  p->v = (vreg > voc) ? voc : (vreg < 0.0 ? 0.0 : vreg);
+  p->i = SimPanelI(p, p->v);
+  SimPanelMpp(p);
+}
+
+static double SimGauss(void)
+{
+  double u1;
+  double u2;
+
+  /* xorshift64*, fixed seed so runs are repeatable */
+  SimRandom ^= SimRandom >> 12;
+  SimRandom ^= SimRandom << 25;
+  SimRandom ^= SimRandom >> 27;
+  u1 = ((SimRandom * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+  SimRandom ^= SimRandom >> 12;
+  SimRandom ^= SimRandom << 25;
+  SimRandom ^= SimRandom >> 27;
+  u2 = ((SimRandom * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+
+  if ( u1 < 1e-300 )
+  {
+    u1 = 1e-300;
+  }
+
+  return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+static uint16_t SimQuantise(double val, double lsb, double noise, int32_t lo, int32_t hi)
+{
+  double reg = floor(val / lsb + noise * SimGauss() + 0.5);
+
+  if ( reg < lo )
+  {
+    reg = lo;
+  }
+  if ( reg > hi )
+  {
+    reg = hi;
+  }
+
+  return (uint16_t)(int16_t)reg;
+}
+
+/*******************************************************************************
+ ****************************   FIRMWARE STUBS   *******************************
+ ******************************************************************************/
+
+static INA226_Err_TypeDef SimRegisterGet(INA226_TypeDef *const ina226,
+                                         INA226_Register_TypeDef reg,
+                                         uint16_t *val)
+{
+  const SimPanel *p = &SimPanels[ina226 - SimSensors];
+
+  SimCounter += SIM_I2C_REG_US * SIM_COUNTS_PER_US;
+
+  switch ( reg )
+  {
+    case INA226_RegConfig:
+      *val = SimConfig[ina226 - SimSensors];
+      break;
+    case INA226_RegBusV:
+      *val = SimQuantise(p->v, SIM_BUS_LSB, SIM_BUS_NOISE, 0, 0x7FFF);
+      break;
+    case INA226_RegShuntV:
+      *val = SimQuantise(p->i * SIM_SENSE_OHM, SIM_SHUNT_LSB, SIM_SHUNT_NOISE,
+                         -32768, 32767);
+      break;
+    default:
+      *val = 0U;
+      break;
+  }
+
+  return INA226_Err_NoError;
+}
+
+static INA226_Err_TypeDef SimRegisterSet(INA226_TypeDef *const ina226,
+                                         INA226_Register_TypeDef reg,
+                                         uint16_t val)
+{
+  SimCounter += SIM_I2C_REG_US * SIM_COUNTS_PER_US;
+
+  if ( reg == INA226_RegConfig )
+  {
+    SimConfig[ina226 - SimSensors] = val;
+  }
+
+  return INA226_Err_NoError;
+}
+
+uint32_t SCHEDULER_GetCounter(void)
+{
+  /* Busy waits poll, let time pass */
+  return SimCounter++;
+}
+
+/* Level the sweep holds the clock governor at */
+static GOVERNOR_Level_TypeDef SimClockFloor = GOVERNOR_Level_Min;
+
+GOVERNOR_Err_TypeDef GOVERNOR_Request(GOVERNOR_Client_TypeDef client,
+                                      GOVERNOR_Level_TypeDef level)
+{
+  if ( client == GOVERNOR_Client_Mppt )
+  {
+    SimClockFloor = level;
+  }
+
+  return GOVERNOR_Err_NoError;
+}
+
+GOVERNOR_Err_TypeDef GOVERNOR_Release(GOVERNOR_Client_TypeDef client)
+{
+  return GOVERNOR_Request(client, GOVERNOR_Level_Min);
+}
+
+INA226_TypeDef *TELEMETRY_GetSensor(TELEMETRY_Channel_TypeDef channel)
+{
+  if ( (uint32_t)channel >= SIM_PANELS )
+  {
+    return 0;
+  }
+
+  return &SimSensors[channel];
+}
+
+TCA9548A_Err_TypeDef TCA9548A_RegisterSet(PORT_I2C_Reg_TypeDef *i2c,
+                                          TCA9548A_Address_TypeDef addr,
+                                          uint8_t val)
+{
+  (void)i2c;
+  (void)addr;
+  (void)val;
+  return TCA9548A_Err_NoError;
+}
+
+AD5324_Err_TypeDef AD5324_Stage(AD5324_Channel_TypeDef channel,
+                                uint16_t val)
+{
+  if ( val > 0xFFF )
+  {
+    return AD5324_Err_ValTooLarge;
+  }
+
+  SimDacNext[channel] = val;
+  SimDacStaged |= 1U << channel;
+
+  return AD5324_Err_NoError;
+}
+
+AD5324_Err_TypeDef AD5324_Write(AD5324_Channel_TypeDef channel,
+                                AD5324_Update_TypeDef update,
+                                AD5324_Mode_TypeDef mode,
+                                uint16_t val)
+{
+  (void)update;
+  (void)mode;
+
+  if ( val > 0xFFF )
+  {
+    return AD5324_Err_ValTooLarge;
+  }
+
+  /* Quasi-static LTC3119, settled by the end of the dwell */
+  SimPanels[channel].code = val;
+  SimPanelSolve(&SimPanels[channel]);
+  SimDacWrites++;
+
+  return AD5324_Err_NoError;
+}
+
+AD5324_Err_TypeDef AD5324_Commit(AD5324_Mode_TypeDef mode,
+                                 AD5324_Trigger_TypeDef trigger)
+{
+  uint32_t sent = 0U;
+  uint32_t p;
+
+  (void)mode;
+  (void)trigger;
+
+  for ( p = 0U; p < SIM_PANELS; p++ )
+  {
+    if ( (SimDacStaged & (1U << p)) == 0U )
+    {
+      continue;
+    }
+
+    if ( SimPanels[p].code == SimDacNext[p] )
+    {
+      SimDacSkipped++;
+      continue;
+    }
+
+    SimPanels[p].code = SimDacNext[p];
+    sent++;
+  }
+
+  SimDacStaged = 0U;
+  SimDacWrites += sent;
+  SimDacBursts += (sent != 0U);
+
+  return AD5324_Err_NoError;
+}
+
+PORT_I2C_Err_TypeDef PORT_I2C_Send(PORT_I2C_Reg_TypeDef *i2c,
+                                   uint32_t addr,
+                                   uint32_t length,
+                                   uint8_t *data)
+{
+  (void)i2c;
+  (void)addr;
+  (void)length;
+  (void)data;
+  return PORT_I2C_Err_NACK;
+}
+
+PORT_I2C_Err_TypeDef PORT_I2C_Receive(PORT_I2C_Reg_TypeDef *i2c,
+                                      uint32_t addr,
+                                      uint32_t length,
+                                      uint8_t *data)
+{
+  (void)i2c;
+  (void)addr;
+  (void)length;
+  (void)data;
+  return PORT_I2C_Err_NACK;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_SendByte(PORT_UART_Reg_TypeDef *uart,
+                                         char data)
+{
+  (void)uart;
+  (void)data;
+  return PORT_UART_Err_NoError;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_Send(PORT_UART_Reg_TypeDef *uart,
+                                     uint32_t length,
+                                     char *data)
+{
+  (void)uart;
+  (void)length;
+  (void)data;
+  return PORT_UART_Err_NoError;
+}
+
+/*******************************************************************************
+ ******************************   SCENARIOS   **********************************
+ ******************************************************************************/
+
+typedef void (*SimEnv)(uint32_t panel, double t, double *g, double *temp);
+
+typedef struct
+{
+  const char *name;
+  SimEnv env;
+  double duration;                  /* s */
+  double oscStart;                  /* Start of the steady window, 0 for none */
+  double sweep;                     /* IV sweep of every panel, 0 for none */
+  double events[SIM_MAX_EVENTS];    /* Disturbances to time settling from */
+  uint32_t numEvents;
+  double minEff[2];                 /* Pass limits for PO and INC */
+  double maxFwConv;                 /* Longest firmware convergence time, s */
+  double minFwEff;                  /* Lowest firmware efficiency, with a sweep */
+} SimScenario;
+
+/* Four panels at different irradiance */
+static void EnvSteady(uint32_t panel, double t, double *g, double *temp)
+{
+  static const double level[SIM_PANELS] = { 1.0, 0.8, 0.5, 0.2 };
+  (void)t;
+  *g = level[panel];
+  *temp = SIM_REF_TEMP;
+}
+
+/* Shadow steps, alternating panels go dark and bright */
+static void EnvStep(uint32_t panel, double t, double *g, double *temp)
+{
+  int shaded = (t >= 10.0 && t < 20.0);
+  if ( panel & 1U )
+  {
+    *g = shaded ? 1.0 : 0.5;
+  }
+  else
+  {
+    *g = shaded ? 0.3 : 1.0;
+  }
+  *temp = SIM_REF_TEMP;
+}
+
+/* Panel heating from 80 C down to -20 C, then holding */
+static void EnvThermal(uint32_t panel, double t, double *g, double *temp)
+{
+  static const double level[SIM_PANELS] = { 1.0, 0.9, 0.7, 0.5 };
+  *g = level[panel];
+  *temp = (t < 60.0) ? 80.0 - 100.0 * t / 60.0 : -20.0;
+}
+
+/* Eclipse: ramp into darkness and out again while the panels cool */
+static void EnvEclipse(uint32_t panel, double t, double *g, double *temp)
+{
+  (void)panel;
+  if ( t < 20.0 )       *g = 1.0;
+  else if ( t < 28.0 )  *g = 1.0 - (t - 20.0) / 8.0;
+  else if ( t < 48.0 )  *g = 0.0;
+  else if ( t < 56.0 )  *g = (t - 48.0) / 8.0;
+  else                  *g = 1.0;
+  *temp = (t < 20.0) ? 60.0 : (t < 56.0 ? 60.0 - 60.0 * (t - 20.0) / 36.0 : 0.0);
+}
+
+/* Tumbling at one revolution in 30 s, faces 90 degrees apart */
+static void EnvTumble(uint32_t panel, double t, double *g, double *temp)
+{
+  double c = cos(6.283185307179586 * t / 30.0 - 1.5707963267948966 * panel);
+  *g = (c > 0.0) ? c : 0.0;
+  *temp = SIM_REF_TEMP;
+}
+
+static const SimScenario SimScenarios[] =
+{
+  { "steady",  EnvSteady,  30.0, 20.0, 10.0, { 0.0 },             1U, { 0.95, 0.95 },  3.0, 0.97 },
+  { "step",    EnvStep,    40.0, 30.0, 22.0, { 0.0, 10.0, 20.0 }, 3U, { 0.95, 0.95 },  3.0, 0.97 },
+  { "thermal", EnvThermal, 80.0, 70.0, 62.0, { 0.0 },             1U, { 0.96, 0.96 },  3.0, 0.97 },
+  { "eclipse", EnvEclipse, 80.0, 70.0, 60.0, { 0.0, 56.0 },       2U, { 0.95, 0.95 },  3.0, 0.97 },
+  { "tumble",  EnvTumble, 120.0,  0.0,  0.0, { 0.0 },             0U, { 0.93, 0.93 }, 30.0, 0.0  }
+};
+
+#define SIM_NUM_SCENARIOS (sizeof(SimScenarios) / sizeof(SimScenarios[0]))
+
+/*******************************************************************************
+ ********************************   RUNS   *************************************
+ ******************************************************************************/
+
+typedef struct
+{
+  double energy;                    /* J delivered */
+  double energyMpp;                 /* J available */
+  double settle[SIM_MAX_EVENTS];    /* s, negative if never */
+  uint32_t inBand;
+  double bandStart;
+  uint32_t event;
+  uint16_t codeMin;
+  uint16_t codeMax;
+  double vMin;
+  double vMax;
+  double pMin;
+  double pMax;
+  double pmppOsc;
+  double oscEnergy;                 /* J delivered in the steady window */
+  double oscEnergyMpp;              /* J available in the steady window */
+} SimTrack;
+
+static FILE *SimTrace = 0;
+static double SimWallTime = 0.0;
+static double SimSimTime = 0.0;
+
+static int RunScenario(const SimScenario *sc, MPPT_Params_TypeDef params,
+                       MPPT_Algorithm_TypeDef algorithm)
+{
+  const double dt = MPPT_PERIOD * SCHEDULER_TICK_US * 1e-6;
+  const uint32_t steps = (uint32_t)(sc->duration / dt + 0.5);
+  static const char * const names[] = { "PO", "INC" };
+  SimTrack tr[SIM_PANELS];
+  double settleMax = 0.0;
+  double energy = 0.0;
+  double energyMpp = 0.0;
+  uint32_t codePp = 0U;
+  double vPp = 0.0;
+  double ripple = 0.0;
+  double oscEnergy = 0.0;
+  double oscEnergyMpp = 0.0;
+  uint32_t fwConv = 0U;
+  uint32_t fwEff = 1000U;
+  uint32_t errors = 0U;
+  uint32_t before;
+  int swept = (sc->sweep == 0.0);
+  int settleFail = 0;
+  int fail = 0;
+  clock_t start;
+  uint32_t n;
+  uint32_t p;
+  uint32_t e;
+
+  memset(tr, 0, sizeof(tr));
+  for ( p = 0U; p < SIM_PANELS; p++ )
+  {
+    for ( e = 0U; e < SIM_MAX_EVENTS; e++ )
+    {
+      tr[p].settle[e] = -1.0;
+    }
+    tr[p].codeMin = 0xFFFFU;
+    tr[p].vMin = 1e9;
+    tr[p].pMin = 1e9;
+    tr[p].event = 0U;
+
+    INA226_Init(&SimSensors[p], PORT_I2C, EPS_MPPT1_I2CADDR, EPS_MPPT1_MUXCHAN,
+                EPS_MPPT1_SENSERESISTOR, SimRegisterGet, SimRegisterSet);
+    SimConfig[p] = SIM_INA226_CONFIG;
+    sc->env(p, 0.0, &SimPanels[p].g, &SimPanels[p].temp);
+  }
+
+  params.algorithm = algorithm;
+  MPPT_Init(&params, 0, 0, 0);
+  IVSWEEP_Init();
+
+  start = clock();
+
+  for ( n = 0U; n < steps; n++ )
+  {
+    double t = n * dt;
+
+    /* Sweeps take a few hundred ms of light that does not change, the
+     * panels are left out of the energy count meanwhile */
+    for ( p = 0U; !swept && t >= sc->sweep && p < SIM_PANELS; p++ )
+    {
+      if ( IVSWEEP_Start((MPPT_Channel_TypeDef)p, 0) != IVSWEEP_Err_NoError )
+      {
+        errors++;
+        continue;
+      }
+      while ( IVSWEEP_GetResult()->state == IVSWEEP_State_Running )
+      {
+        before = SimCounter;
+        IVSWEEP_Update();
+        SimCounter = before + IVSWEEP_PERIOD * SCHEDULER_TICK_US * SIM_COUNTS_PER_US;
+      }
+      if ( IVSWEEP_GetResult()->state != IVSWEEP_State_Done )
+      {
+        errors++;
+      }
+    }
+    swept = swept || t >= sc->sweep;
+
+    /* Conditions and operating point during the step, then the firmware
+     * measures it and moves the setpoint for the next one */
+    for ( p = 0U; p < SIM_PANELS; p++ )
+    {
+      sc->env(p, t, &SimPanels[p].g, &SimPanels[p].temp);
+      SimPanelSolve(&SimPanels[p]);
+    }
+
+    MPPT_Update();
+
+    for ( p = 0U; p < SIM_PANELS; p++ )
+    {
+      SimPanel *sp = &SimPanels[p];
+      SimTrack *st = &tr[p];
+      const MPPT_State_TypeDef *fw = MPPT_GetState((MPPT_Channel_TypeDef)p);
+      double pw = sp->v * sp->i;
+
+      st->energy += pw * dt;
+      st->energyMpp += sp->pmpp * dt;
+
+      /* Settling from each event, within the band for SIM_SETTLE_HOLD steps */
+      while ( st->event < sc->numEvents && st->event + 1U < sc->numEvents
+              && t >= sc->events[st->event + 1U] )
+      {
+        st->event++;
+        st->inBand = 0U;
+      }
+      if ( st->event < sc->numEvents && t >= sc->events[st->event]
+           && st->settle[st->event] < 0.0 && sp->pmpp > 0.0 )
+      {
+        if ( pw >= SIM_SETTLE_BAND * sp->pmpp )
+        {
+          if ( st->inBand++ == 0U )
+          {
+            st->bandStart = t;
+          }
+          if ( st->inBand >= SIM_SETTLE_HOLD )
+          {
+            st->settle[st->event] = st->bandStart - sc->events[st->event];
+          }
+        }
+        else
+        {
+          st->inBand = 0U;
+        }
+      }
+
+      if ( sc->oscStart > 0.0 && t >= sc->oscStart )
+      {
+        if ( fw->code < st->codeMin ) st->codeMin = fw->code;
+        if ( fw->code > st->codeMax ) st->codeMax = fw->code;
+        if ( sp->v < st->vMin ) st->vMin = sp->v;
+        if ( sp->v > st->vMax ) st->vMax = sp->v;
+        if ( pw < st->pMin ) st->pMin = pw;
+        if ( pw > st->pMax ) st->pMax = pw;
+        st->pmppOsc = sp->pmpp;
+        st->oscEnergy += pw * dt;
+        st->oscEnergyMpp += sp->pmpp * dt;
+      }
+
+      if ( SimTrace != 0 )
+      {
+        fprintf(SimTrace, "%s,%s,%u,%.3f,%.3f,%.1f,%u,%.4f,%.4f,%.4f,%.4f,%u\n",
+                sc->name, names[algorithm], p, t, sp->g, sp->temp, sp->code,
+                sp->v, sp->i, pw, sp->pmpp, fw->settled);
+      }
+    }
+  }
+
+  SimWallTime += (double)(clock() - start) / CLOCKS_PER_SEC;
+  SimSimTime += sc->duration;
+
+  for ( p = 0U; p < SIM_PANELS; p++ )
+  {
+    const MPPT_State_TypeDef *fw = MPPT_GetState((MPPT_Channel_TypeDef)p);
+
+    energy += tr[p].energy;
+    energyMpp += tr[p].energyMpp;
+    oscEnergy += tr[p].oscEnergy;
+    oscEnergyMpp += tr[p].oscEnergyMpp;
+    errors += fw->errors;
+
+    for ( e = 0U; e < sc->numEvents; e++ )
+    {
+      if ( tr[p].settle[e] < 0.0 )
+      {
+        settleFail = 1;
+      }
+      else if ( tr[p].settle[e] > settleMax )
+      {
+        settleMax = tr[p].settle[e];
+      }
+    }
+
+    if ( sc->oscStart > 0.0 )
+    {
+      if ( (uint32_t)(tr[p].codeMax - tr[p].codeMin) > codePp )
+      {
+        codePp = tr[p].codeMax - tr[p].codeMin;
+      }
+      if ( tr[p].vMax - tr[p].vMin > vPp )
+      {
+        vPp = tr[p].vMax - tr[p].vMin;
+      }
+      if ( tr[p].pmppOsc > 0.0 && (tr[p].pMax - tr[p].pMin) / tr[p].pmppOsc > ripple )
+      {
+        ripple = (tr[p].pMax - tr[p].pMin) / tr[p].pmppOsc;
+      }
+    }
+
+    if ( fw->convergeSteps > fwConv )
+    {
+      fwConv = fw->convergeSteps;
+    }
+    if ( fw->efficiency < fwEff )
+    {
+      fwEff = fw->efficiency;
+    }
+  }
+
+  fail = settleFail || errors != 0U
+         || (energyMpp > 0.0 && energy / energyMpp < sc->minEff[algorithm])
+         || fwConv * dt > sc->maxFwConv
+         || (sc->sweep > 0.0 && fwEff < sc->minFwEff * 1000.0);
+
+  printf("%-8s %-3s  EFF %6.2f %%", sc->name, names[algorithm],
+         energyMpp > 0.0 ? 100.0 * energy / energyMpp : 0.0);
+
+  if ( sc->numEvents == 0U )
+  {
+    printf("  SETTLE     -  ");
+  }
+  else if ( settleFail )
+  {
+    printf("  SETTLE  never ");
+  }
+  else
+  {
+    printf("  SETTLE %5.2f s", settleMax);
+  }
+
+  if ( sc->oscStart > 0.0 )
+  {
+    printf("  STEADY %6.2f %% OSC %3u codes %5.1f mV %5.2f %%",
+           oscEnergyMpp > 0.0 ? 100.0 * oscEnergy / oscEnergyMpp : 0.0,
+           codePp, vPp * 1000.0, ripple * 100.0);
+  }
+  else
+  {
+    printf("  STEADY      -   OSC     -                     ");
+  }
+
+  printf("  FW CONV %5.2f s", fwConv * dt);
+
+  if ( sc->sweep > 0.0 )
+  {
+    printf(" EFF %5.1f %%", fwEff / 10.0);
+  }
+  else
+  {
+    printf(" EFF     -  ");
+  }
+
+  printf("  %s\n", fail ? "FAIL" : "ok");
+
+  return fail;
+}
+
+/*******************************************************************************
+ ******************************   IV SWEEPS   **********************************
+ ******************************************************************************/
+
+typedef struct
+{
+  MPPT_Channel_TypeDef channel;
+  double g;
+  double temp;
+} SimSweep;
+
+static const SimSweep SimSweeps[] =
+{
+  { MPPT_Channel_1, 1.00,  28.0 },
+  { MPPT_Channel_2, 0.50,  28.0 },
+  { MPPT_Channel_3, 1.00,  80.0 },
+  { MPPT_Channel_4, 0.15, -20.0 },
+};
+
+#define SIM_NUM_SWEEPS (sizeof(SimSweeps) / sizeof(SimSweeps[0]))
+
+/* Trace one panel with the default ramp while the others keep tracking */
+static int RunSweep(const SimSweep *sw)
+{
+  const IVSWEEP_Result_TypeDef *r;
+  const IVSWEEP_Point_TypeDef *pt;
+  const MPPT_State_TypeDef *fw;
+  SimPanel *sp = &SimPanels[sw->channel];
+  uint32_t slices = 0U;
+  uint32_t sliceMax = 0U;
+  uint8_t held = 1U;
+  uint32_t before;
+  double found;
+  int fail = 0;
+  uint32_t p;
+
+  for ( p = 0U; p < SIM_PANELS; p++ )
+  {
+    INA226_Init(&SimSensors[p], PORT_I2C, EPS_MPPT1_I2CADDR, EPS_MPPT1_MUXCHAN,
+                EPS_MPPT1_SENSERESISTOR, SimRegisterGet, SimRegisterSet);
+    SimConfig[p] = SIM_INA226_CONFIG;
+    SimPanels[p].g = sw->g;
+    SimPanels[p].temp = sw->temp;
+  }
+
+  MPPT_Init(0, 0, 0, 0);
+  IVSWEEP_Init();
+
+  for ( p = 0U; p < 20U; p++ )
+  {
+    MPPT_Update();
+  }
+
+  if ( IVSWEEP_Start(sw->channel, 0) != IVSWEEP_Err_NoError )
+  {
+    printf("sweep    MPPT%u start failed  FAIL\n", (uint32_t)sw->channel + 1U);
+    return 1;
+  }
+
+  r = IVSWEEP_GetResult();
+
+  while ( r->state == IVSWEEP_State_Running && slices < 1000U )
+  {
+    held &= (SimClockFloor == GOVERNOR_Level_Max);
+    before = SimCounter;
+    IVSWEEP_Update();
+    slices++;
+
+    if ( SimCounter - before > sliceMax )
+    {
+      sliceMax = SimCounter - before;
+    }
+
+    /* The other panels keep tracking until the next release */
+    MPPT_Update();
+    SimCounter = before + IVSWEEP_PERIOD * SCHEDULER_TICK_US * SIM_COUNTS_PER_US;
+  }
+
+  SimPanelSolve(sp);
+  pt = IVSWEEP_GetPoints();
+  found = pt[r->mpp].voltage * 1e-6 * pt[r->mpp].current * 1e-6;
+  fw = MPPT_GetState(sw->channel);
+
+  if ( r->state != IVSWEEP_State_Done || r->points != r->total ||
+       found < SIM_SWEEP_LIMIT * sp->pmpp ||
+       SimConfig[sw->channel] != SIM_INA226_CONFIG ||
+       fw->enabled == 0U || fw->steps > 1U ||
+       !held || SimClockFloor != GOVERNOR_Level_Min )
+  {
+    fail = 1;
+  }
+
+  printf("sweep    MPPT%u g %.2f %5.1f C  %3u points  PMAX %6.1f mW at %5.3f V "
+         "(true %6.1f mW at %5.3f V, %5.1f %%)  TIME %5.1f ms  SLICE MAX %4.2f ms  %s\n",
+         (uint32_t)sw->channel + 1U, sw->g, sw->temp, r->points,
+         found * 1e3, pt[r->mpp].voltage * 1e-6, sp->pmpp * 1e3, sp->vmpp,
+         sp->pmpp > 0.0 ? 100.0 * found / sp->pmpp : 0.0,
+         r->duration / (SIM_COUNTS_PER_US * 1000.0),
+         sliceMax / (SIM_COUNTS_PER_US * 1000.0), fail ? "FAIL" : "ok");
+
+  return fail;
+}
+
+/*******************************************************************************
+ ********************************   MAIN   *************************************
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+  const char *curve = SIM_CURVE_PATH;
+  MPPT_Params_TypeDef params = MPPT_DefaultParams;
+  int failures = 0;
+  uint32_t s;
+  int a;
+
+  for ( a = 1; a < argc; a++ )
+  {
+    if ( !strcmp(argv[a], "-c") && a + 1 < argc )
+    {
+      curve = argv[++a];
+    }
+    else if ( !strcmp(argv[a], "-s") && a + 1 < argc )
+    {
+      params.step = (uint16_t)atoi(argv[++a]);
+    }
+    else if ( !strcmp(argv[a], "-d") && a + 1 < argc )
+    {
+      params.dither = (uint16_t)atoi(argv[++a]);
+    }
+    else if ( !strcmp(argv[a], "-t") && a + 1 < argc )
+    {
+      SimTrace = fopen(argv[++a], "w");
+      if ( SimTrace == 0 )
+      {
+        printf("cannot open %s\n", argv[a]);
+        return 2;
+      }
+      fprintf(SimTrace, "scenario,algorithm,panel,t,g,temp,code,v,i,p,pmpp,settled\n");
+    }
+    else
+    {
+      printf("usage: %s [-c curve.csv] [-s step] [-d dither] [-t trace.csv]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if ( SimLoadCurve(curve) != 0 )
+  {
+    return 2;
+  }
+
+  printf("XTJ curve %u points, step %u dither %u codes, period %u ms\n",
+         SimCurvePoints, params.step, params.dither,
+         (uint32_t)(MPPT_PERIOD * SCHEDULER_TICK_US / 1000U));
+
+  for ( s = 0U; s < SIM_NUM_SCENARIOS; s++ )
+  {
+    failures += RunScenario(&SimScenarios[s], params, MPPT_Algorithm_PerturbObserve);
+    failures += RunScenario(&SimScenarios[s], params, MPPT_Algorithm_IncCond);
+  }
+
+  for ( s = 0U; s < SIM_NUM_SWEEPS; s++ )
+  {
+    failures += RunSweep(&SimSweeps[s]);
+  }
+
+  printf("simulated %.0f s in %.2f s (%.0fx real time), "
+         "%u DAC bursts, %u words, %u unchanged skipped\n",
+         SimSimTime, SimWallTime,
+         SimWallTime > 0.0 ? SimSimTime / SimWallTime : 0.0,
+         SimDacBursts, SimDacWrites, SimDacSkipped);
+
+  if ( SimTrace != 0 )
+  {
+    fclose(SimTrace);
+  }
+
+  printf("%s\n", failures ? "FAIL" : "PASS");
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+/** @file print_benchmark.c
+*   @brief Host benchmark and conformance check for the PRINT formatters
+*   @date 19-Oct-2026
+*   @author Stefan Damkjar, Junqi Zhu
+*
+*   Builds the firmware print.c unmodified against stubbed UART functions,
+*   checks every PRINT_Format function byte for byte against a libc
+*   reference and compares throughput with sprintf.
+*
+*   Build and run from this directory:
+*
+*     gcc -O2 -Wall -I../../firmware/blinky/include
+*         -I../../firmware/blinky/drivers
+*         print_benchmark.c ../../firmware/blinky/drivers/print.c
+*         -o print_benchmark && ./print_benchmark
+*
+*   Exits with a non-zero status if any output differs from the reference.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include "print.h"
+
+#define BENCH_ITERATIONS (2000000U)
+
+/*******************************************************************************
+ *****************************   UART STUBS   **********************************
+ ******************************************************************************/
+
+PORT_UART_Err_TypeDef PORT_UART_SendByte(PORT_UART_Reg_TypeDef *uart,
+                                         char data)
+{
+  (void)uart;
+  (void)data;
+  return PORT_UART_Err_NoError;
+}
+
+PORT_UART_Err_TypeDef PORT_UART_Send(PORT_UART_Reg_TypeDef *uart,
+                                     uint32_t length,
+                                     char *data)
+{
+  (void)uart;
+  (void)length;
+  (void)data;
+  return PORT_UART_Err_NoError;
+}
+
+/*******************************************************************************
+ ***************************   REFERENCE MODELS   ******************************
+ ******************************************************************************/
+
+static uint32_t pow10u(uint8_t n)
+{
+  uint32_t p = 1U;
+  while ( n-- > 0U ) p *= 10U;
+  return p;
+}
+
+/* Fixed point reference built on integer sprintf so ties are decided the
+ * same way as the firmware (half away from zero) and not by binary double
+ * rounding. */
+static int refFixed(char *buf, int32_t val, uint8_t scale, uint8_t precision)
+{
+  uint64_t mag = (val < 0) ? (uint64_t)(-(int64_t)val) : (uint64_t)val;
+  uint8_t  fracDigits = precision < scale ? precision : scale;
+  int      len;
+
+  if ( precision < scale )
+  {
+    uint64_t div = pow10u(scale - precision);
+    mag = (mag + div / 2U) / div;
+  }
+
+  len = sprintf(buf, "%s%" PRIu64,
+                (val < 0 && mag != 0U) ? "-" : "",
+                mag / pow10u(fracDigits));
+
+  if ( precision > 0U )
+  {
+    buf[len++] = '.';
+    if ( fracDigits > 0U )
+    {
+      len += sprintf(&buf[len], "%0*" PRIu64,
+                     fracDigits, mag % pow10u(fracDigits));
+    }
+    len += sprintf(&buf[len], "%.*s", precision - fracDigits, "000000000");
+  }
+
+  return len;
+}
+
+static uint32_t failures = 0U;
+
+static void check(const char *what, const char *got, uint32_t gotLen,
+                  const char *want, int wantLen)
+{
+  if ( (int)gotLen != wantLen || memcmp(got, want, (size_t)wantLen + 1U) != 0 )
+  {
+    if ( failures < 20U )
+    {
+      printf("MISMATCH %s: got \"%s\" (%u) want \"%s\" (%d)\n",
+             what, got, gotLen, want, wantLen);
+    }
+    failures++;
+  }
+}
+
+/* xorshift32 so runs are reproducible */
+static uint32_t rng = 0x12345678U;
+static uint32_t nextRand(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static const int32_t edgeValues[] =
+{
+  0, 1, -1, 5, -5, 9, 10, 99, 100, 101, 499, 500, -500, 999, 1000,
+  1005, -1005, 123456789, 999999999, 1000000000, -1000000000,
+  2147483647, -2147483647 - 1
+};
+
+#define NUM_EDGE (sizeof(edgeValues) / sizeof(edgeValues[0]))
+
+static void conformance(void)
+{
+  char     got[PRINT_FORMAT_MAX_LENGTH];
+  char     want[64];
+  uint32_t i;
+  uint32_t len;
+  int      wantLen;
+  uint8_t  scale;
+  uint8_t  prec;
+  int32_t  v;
+
+  for ( i = 0U; i < NUM_EDGE + 200000U; i++ )
+  {
+    v = (i < NUM_EDGE) ? edgeValues[i] : (int32_t)nextRand();
+
+    /* Exercise small magnitudes as often as large ones */
+    if ( i >= NUM_EDGE && (i & 1U) ) v >>= (nextRand() % 31U);
+
+    len = PRINT_FormatInt(got, v);
+    wantLen = sprintf(want, "%" PRId32, v);
+    check("Int", got, len, want, wantLen);
+
+    len = PRINT_FormatUInt(got, (uint32_t)v);
+    wantLen = sprintf(want, "%" PRIu32, (uint32_t)v);
+    check("UInt", got, len, want, wantLen);
+
+    len = PRINT_FormatHex(got, (uint32_t)v, (uint8_t)(i % 9U));
+    wantLen = sprintf(want, "%0*" PRIX32, (int)((i % 9U) ? (i % 9U) : 1U),
+                      (uint32_t)v);
+    check("Hex", got, len, want, wantLen);
+
+    scale = (uint8_t)(nextRand() % 10U);
+    prec  = (uint8_t)(nextRand() % 10U);
+    len = PRINT_FormatFixed(got, v, scale, prec);
+    wantLen = refFixed(want, v, scale, prec);
+    check("Fixed", got, len, want, wantLen);
+
+    prec = (uint8_t)(nextRand() % 4U);
+    len = PRINT_FormatEng(got, v, PRINT_Unit_mV, prec);
+    wantLen = refFixed(want, v, 3U, prec);
+    wantLen += sprintf(&want[wantLen], " mV");
+    check("Eng", got, len, want, wantLen);
+  }
+
+  /* Known answers */
+  len = PRINT_FormatEng(got, 3300500, PRINT_Unit_mV, 1U);
+  check("Eng 3V3", got, len, "3300.5 mV", 9);
+  len = PRINT_FormatEng(got, -1250, PRINT_Unit_mA, 2U);
+  check("Eng -1.25mA", got, len, "-1.25 mA", 8);
+  len = PRINT_FormatEng(got, -4, PRINT_Unit_mW, 2U);
+  check("Eng -0", got, len, "0.00 mW", 7);
+  len = PRINT_FormatFixed(got, 125, 3U, 2U);
+  check("Fixed tie", got, len, "0.13", 4);
+  len = PRINT_FormatHex(got, 0x8020A05U, 8U);
+  check("Hex IDN", got, len, "08020A05", 8);
+}
+
+/*******************************************************************************
+ *****************************   BENCHMARK   ***********************************
+ ******************************************************************************/
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int32_t benchValues[1024];
+static volatile uint32_t sink;
+
+#define BENCH(label, expr)                                                   \
+  do {                                                                       \
+    char     b[64];                                                          \
+    uint32_t n;                                                              \
+    double   t0 = now();                                                     \
+    for ( n = 0U; n < BENCH_ITERATIONS; n++ )                                \
+    {                                                                        \
+      int32_t x = benchValues[n & 1023U];                                    \
+      sink += (uint32_t)(expr);                                              \
+      sink += (uint8_t)b[0];                                                 \
+    }                                                                        \
+    printf("  %-34s %8.1f ns/call\n", label,                                 \
+           (now() - t0) * 1e9 / BENCH_ITERATIONS);                           \
+  } while (0)
+
+static void benchmark(void)
+{
+  uint32_t i;
+
+  for ( i = 0U; i < 1024U; i++ )
+  {
+    benchValues[i] = (int32_t)nextRand() >> (nextRand() % 24U);
+  }
+
+  printf("Throughput (%u calls each):\n", BENCH_ITERATIONS);
+  BENCH("sprintf(\"%d\")", sprintf(b, "%" PRId32, x));
+  BENCH("PRINT_FormatInt", PRINT_FormatInt(b, x));
+  BENCH("sprintf(\"%08X\")", sprintf(b, "%08" PRIX32, (uint32_t)x));
+  BENCH("PRINT_FormatHex", PRINT_FormatHex(b, (uint32_t)x, 8U));
+  BENCH("sprintf(\"%.3f\", x/1e6)", sprintf(b, "%.3f", x / 1e6));
+  BENCH("PRINT_FormatFixed(6,3)", PRINT_FormatFixed(b, x, 6U, 3U));
+  BENCH("sprintf(\"%.1f mV\", x/1e3)", sprintf(b, "%.1f mV", x / 1e3));
+  BENCH("PRINT_FormatEng(mV,1)", PRINT_FormatEng(b, x, PRINT_Unit_mV, 1U));
+}
+
+int main(void)
+{
+  conformance();
+  printf("Conformance: %s (%u mismatches)\n",
+         failures ? "FAIL" : "PASS", failures);
+  benchmark();
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}